@@ -0,0 +1,34 @@
+/*-----------------------------------------------------------------------------
+    bench.h --  Helpers shared by the benchmark programs.
+
+               getSeconds reads the monotonic clock for timing, and
+               nextRandom steps a xorshift64 generator, so every benchmark
+               makes the same inputs from the same seed on each run.
+
+  -----------------------------------------------------------------------------*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+static inline double getSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// The seed must not be zero, which xorshift never leaves
+static inline uint64_t nextRandom(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,173 @@
+/*-----------------------------------------------------------------------------
+    bigbase.c --  Number base conversion benchmark.
+
+               Parses a random decimal integer of digits digits and times
+               bigBaseToString and bigBaseFromString between it and base
+               16, 8 and 2, in milliseconds: once with an empty cache of
+               powers, then best of three with the powers cached. Every
+               text must read back as the same number. The same
+               conversions of a number a tenth as long are then timed
+               digit by digit (bigBaseSplitThreshold at INT_MAX), and
+               must give the same text. A conversion in an arena must
+               give the same text again after the arena is reset.
+
+               Usage: bench_bigbase [digits]
+
+  -----------------------------------------------------------------------------*/
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//bigbase.h"
+#include "..//headers//memory.h"
+#include "bench.h"
+
+static const int BASES[] = { 16, 8, 2 };
+#define BASE_COUNT (sizeof(BASES) / sizeof(BASES[0]))
+
+/*
+ * timeConversions
+ *
+ * Converts value to text in base and back, best of runs runs each, in
+ * seconds. The text is left in text. Returns false if the text does not
+ * read back as value.
+ */
+static bool timeConversions(const _bigDecimal* value, int base, int runs, char* text, size_t textSize,
+    double* toSeconds, double* fromSeconds)
+{
+    _bigDecimal parsed;
+    bool isSame = true;
+
+    bigDecimalInit(&parsed);
+    *toSeconds = HUGE_VAL;
+    *fromSeconds = HUGE_VAL;
+    for (int run = 0; run < runs; run++) {
+        double start = getSeconds();
+        size_t length = bigBaseToString(value, text, textSize, base);
+        double middle = getSeconds();
+        int status = bigBaseFromString(&parsed, text, base);
+        double end = getSeconds();
+        *toSeconds = (middle - start < *toSeconds) ? middle - start : *toSeconds;
+        *fromSeconds = (end - middle < *fromSeconds) ? end - middle : *fromSeconds;
+        isSame = isSame && length > 0 && length < textSize && status == STATUS_SUCCESS &&
+                 bigDecimalCompare(&parsed, value) == 0;
+    }
+    bigDecimalFree(&parsed);
+    return isSame;
+}
+
+// A random integer of digits decimal digits, without a leading zero
+static int makeNumber(_bigDecimal* value, int digits, uint64_t* state)
+{
+    char* text = malloc((size_t)digits + 1);
+    if (text == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    for (int i = 0; i < digits; i++) {
+        text[i] = (char)('0' + nextRandom(state) % 10);
+    }
+    text[0] = (char)('1' + nextRandom(state) % 9);
+    text[digits] = '\0';
+    int status = bigDecimalFromString(value, text, '.', BIG_DECIMAL_EXACT);
+    free(text);
+    return status;
+}
+
+/*
+ * checkArenaReset
+ *
+ * Converts value to base 16 in an arena, as the engine does, resets the
+ * arena and fills it with other data, and converts again: the cached
+ * powers must not have lived in the arena. Returns false if the texts
+ * differ.
+ */
+static bool checkArenaReset(const _bigDecimal* value, char* text, char* again, size_t textSize)
+{
+    _memoryArena arena;
+
+    initMemoryArena(&arena, DEFAULT_ARENA_CHUNK_SIZE);
+    bigBaseFreeCache();
+    _memoryArena* previousArena = selectMemoryArena(&arena);
+    bigBaseToString(value, text, textSize, 16);
+    resetMemoryArena(&arena);
+    for (int i = 0; i < 64; i++) {
+        void* block = allocateMemoryFromHeap(HEAP_MAX_ARENA_BLOCK);
+        if (block != NULL) {
+            memset(block, 0x5A, HEAP_MAX_ARENA_BLOCK);
+        }
+    }
+    bigBaseToString(value, again, textSize, 16);
+    selectMemoryArena(previousArena);
+    freeMemoryArena(&arena);
+    return strcmp(text, again) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    int digits = (argc > 1) ? atoi(argv[1]) : 1000000;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    _bigDecimal value;
+    int failures = 0;
+
+    bigDecimalInit(&value);
+    if (digits < 10 || makeNumber(&value, digits, &state) != STATUS_SUCCESS) {
+        printf("cannot make a number of %d digits\n", digits);
+        return 1;
+    }
+    size_t textSize = bigBaseTextSize(&value, 2);
+    char* text = malloc(textSize);
+    char* splitText = malloc(textSize);
+    if (text == NULL || splitText == NULL) {
+        printf("cannot allocate %zu characters\n", textSize);
+        return 1;
+    }
+
+    printf("%d decimal digits, ms (first with the powers computed, then cached)\n", digits);
+    printf("%-6s %10s %10s %10s %10s\n", "base", "to first", "to", "from first", "from");
+    for (size_t k = 0; k < BASE_COUNT; k++) {
+        double toFirst, fromFirst, to, from;
+        bigBaseFreeCache();
+        bool isSame = timeConversions(&value, BASES[k], 1, text, textSize, &toFirst, &fromFirst);
+        isSame = timeConversions(&value, BASES[k], 3, text, textSize, &to, &from) && isSame;
+        printf("%-6d %10.1f %10.1f %10.1f %10.1f%s\n", BASES[k], toFirst * 1e3, to * 1e3, fromFirst * 1e3,
+            from * 1e3, isSame ? "" : "  does not read back");
+        failures += !isSame;
+    }
+
+    _bigDecimal arenaValue;
+    bigDecimalInit(&arenaValue);
+    makeNumber(&arenaValue, 1200, &state);
+    bool isKept = checkArenaReset(&arenaValue, text, splitText, textSize);
+    printf("\nbase 16 after an arena reset: %s\n", isKept ? "same text" : "text differs");
+    failures += !isKept;
+    bigDecimalFree(&arenaValue);
+
+    // The quadratic conversion takes too long for the full number
+    digits /= 10;
+    makeNumber(&value, digits, &state);
+    printf("\n%d decimal digits, ms (split in halves, then digit by digit)\n", digits);
+    printf("%-6s %10s %10s %8s %10s %10s %8s\n", "base", "to split", "to digit", "speedup", "from split",
+        "from digit", "speedup");
+    for (size_t k = 0; k < BASE_COUNT; k++) {
+        double splitTo, splitFrom, digitTo, digitFrom;
+        bool isSame = timeConversions(&value, BASES[k], 3, splitText, textSize, &splitTo, &splitFrom);
+        int threshold = bigBaseSplitThreshold;
+        bigBaseSplitThreshold = INT_MAX;
+        isSame = timeConversions(&value, BASES[k], 1, text, textSize, &digitTo, &digitFrom) && isSame;
+        bigBaseSplitThreshold = threshold;
+        isSame = isSame && strcmp(text, splitText) == 0;
+        printf("%-6d %10.2f %10.2f %7.1fx %10.2f %10.2f %7.1fx%s\n", BASES[k], splitTo * 1e3, digitTo * 1e3,
+            digitTo / splitTo, splitFrom * 1e3, digitFrom * 1e3, digitFrom / splitFrom,
+            isSame ? "" : "  results differ");
+        failures += !isSame;
+    }
+
+    bigDecimalFree(&value);
+    bigBaseFreeCache();
+    free(text);
+    free(splitText);
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
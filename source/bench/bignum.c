@@ -0,0 +1,152 @@
+/*-----------------------------------------------------------------------------
+    bignum.c --  Multiplication scaling benchmark for the arbitrary-precision
+                 decimal numbers.
+
+               Multiplies two random operands of growing size with the
+               default algorithm selection (schoolbook, Karatsuba,
+               Toom-Cook 3) and with schoolbook only, checks that both give
+               the same product and prints the time per multiply. The
+               "slope" column is the local exponent of the time growth,
+               log(t2/t1) / log(n2/n1): 2.0 is quadratic, Karatsuba tends to
+               1.58 and Toom-Cook 3 to 1.46.
+
+               A rounded 100,000-digit division and square root are timed
+               at the end.
+
+               Usage: bench_bignum [maxDigits]
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//bignum.h"
+#include "bench.h"
+
+#define SCHOOLBOOK_MAX_DIGITS 300000  // Beyond this schoolbook is too slow to time
+#define MIN_SAMPLE_SECONDS 0.2
+
+static void fillRandomLimbs(uint32_t* limbs, int length)
+{
+    for (int i = 0; i < length; i++) {
+        limbs[i] = (uint32_t)(((uint64_t)rand() * 65536u + (uint64_t)rand()) % BIG_LIMB_BASE);
+    }
+    limbs[length - 1] |= 1; // Keep the top limb non-zero
+}
+
+// Returns seconds per multiply, repeating until the sample is long enough
+static double timeMultiply(uint32_t* result, const uint32_t* a, const uint32_t* b, int length)
+{
+    long repetitions = 0;
+    double start = getSeconds();
+    double elapsed;
+
+    do {
+        bigLimbMultiply(result, a, length, b, length);
+        repetitions++;
+        elapsed = getSeconds() - start;
+    } while (elapsed < MIN_SAMPLE_SECONDS);
+    return elapsed / (double)repetitions;
+}
+
+static void timeRoundedOperations(int digits)
+{
+    _bigDecimal a, b, result;
+    char* text = malloc((size_t)digits + 2);
+    double start;
+
+    bigDecimalInit(&a);
+    bigDecimalInit(&b);
+    bigDecimalInit(&result);
+    for (int i = 0; i < digits; i++) {
+        text[i] = (char)('1' + rand() % 9);
+    }
+    text[digits] = '\0';
+    bigDecimalFromString(&a, text, '.', BIG_DECIMAL_EXACT);
+    text[digits / 2] = '\0';
+    bigDecimalFromString(&b, text, '.', BIG_DECIMAL_EXACT);
+
+    start = getSeconds();
+    bigDecimalDiv(&result, &a, &b, digits);
+    printf("div  %8d digits  %10.3f ms\n", digits, (getSeconds() - start) * 1e3);
+
+    start = getSeconds();
+    bigDecimalSqrt(&result, &a, digits);
+    printf("sqrt %8d digits  %10.3f ms\n", digits, (getSeconds() - start) * 1e3);
+
+    bigDecimalFree(&a);
+    bigDecimalFree(&b);
+    bigDecimalFree(&result);
+    free(text);
+}
+
+int main(int argc, char** argv)
+{
+    int maxDigits = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int defaultKaratsuba = bigMultiplyKaratsubaThreshold;
+    int defaultToom = bigMultiplyToomThreshold;
+    double previousFast = 0.0, previousSchool = 0.0;
+    int previousDigits = 0;
+
+    srand(12345);
+    printf("%9s %14s %7s %14s %7s %9s\n", "digits", "fast ms", "slope", "schoolbook ms", "slope", "speedup");
+
+    for (int digits = 32; digits <= maxDigits; digits = (digits < 100) ? digits * 3 : digits * 10 / 3) {
+        int length = (digits + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS;
+        uint32_t* a = malloc((size_t)length * sizeof(uint32_t));
+        uint32_t* b = malloc((size_t)length * sizeof(uint32_t));
+        uint32_t* fast = malloc((size_t)(2 * length) * sizeof(uint32_t));
+        uint32_t* school = malloc((size_t)(2 * length) * sizeof(uint32_t));
+        double fastTime, schoolTime = 0.0;
+
+        fillRandomLimbs(a, length);
+        fillRandomLimbs(b, length);
+
+        bigMultiplyKaratsubaThreshold = defaultKaratsuba;
+        bigMultiplyToomThreshold = defaultToom;
+        fastTime = timeMultiply(fast, a, b, length);
+
+        if (digits <= SCHOOLBOOK_MAX_DIGITS) {
+            bigMultiplyKaratsubaThreshold = length + 1;
+            bigMultiplyToomThreshold = length + 1;
+            schoolTime = timeMultiply(school, a, b, length);
+            if (memcmp(fast, school, (size_t)(2 * length) * sizeof(uint32_t)) != 0) {
+                printf("MISMATCH at %d digits\n", digits);
+                return 1;
+            }
+        }
+
+        printf("%9d %14.4f", digits, fastTime * 1e3);
+        if (previousDigits > 0) {
+            printf(" %7.2f", log(fastTime / previousFast) / log((double)digits / previousDigits));
+        }
+        else {
+            printf(" %7s", "-");
+        }
+        if (schoolTime > 0.0) {
+            printf(" %14.4f", schoolTime * 1e3);
+            if (previousSchool > 0.0) {
+                printf(" %7.2f", log(schoolTime / previousSchool) / log((double)digits / previousDigits));
+            }
+            else {
+                printf(" %7s", "-");
+            }
+            printf(" %8.2fx", schoolTime / fastTime);
+        }
+        printf("\n");
+
+        previousFast = fastTime;
+        previousSchool = schoolTime;
+        previousDigits = digits;
+        free(a);
+        free(b);
+        free(fast);
+        free(school);
+    }
+
+    bigMultiplyKaratsubaThreshold = defaultKaratsuba;
+    bigMultiplyToomThreshold = defaultToom;
+    timeRoundedOperations(100000);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*-----------------------------------------------------------------------------
+    bitwise.c --  Wide bit operation benchmark.
+
+               Fills a batch of count random integers of bits bits and
+               times every operation of bitwise.h on the whole batch with
+               the SIMD kernels (AVX2, or SSE2 and POPCNT) and with the
+               portable ones, best of three, in nanoseconds per integer.
+               The shifts and rotations go by a count that is no multiple
+               of 64, so every result word joins two source words. Both
+               kernel sets must give the same bits.
+
+               Usage: bench_bitwise [bits [count]]
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//bitwise.h"
+#include "bench.h"
+
+typedef enum {
+    TEST_AND,
+    TEST_NOT,
+    TEST_SHIFT_LEFT,
+    TEST_SHIFT_RIGHT_ARITHMETIC,
+    TEST_ROTATE_LEFT,
+    TEST_COUNT_ONES,
+    TEST_COUNT_LEADING_ZEROS,
+    TEST_COUNT_TRAILING_ZEROS,
+    TEST_REVERSE,
+    TEST_COUNT
+} _test;
+
+static const char* TEST_NAMES[TEST_COUNT] = {
+    "and", "not", "shift left", "shift right sign", "rotate left", "count ones", "leading zeros",
+    "trailing zeros", "reverse"
+};
+
+static void runTest(_test test, uint64_t* result, size_t* counts, const uint64_t* a, const uint64_t* b,
+    size_t bits, size_t count)
+{
+    size_t shift = bits / 3 + 5;
+
+    switch (test) {
+    case TEST_AND:                    bitwiseLogic(BITWISE_AND, result, a, b, bits, count); break;
+    case TEST_NOT:                    bitwiseLogic(BITWISE_NOT, result, a, NULL, bits, count); break;
+    case TEST_SHIFT_LEFT:             bitwiseShift(BITWISE_SHIFT_LEFT, result, a, shift, bits, count); break;
+    case TEST_SHIFT_RIGHT_ARITHMETIC: bitwiseShift(BITWISE_SHIFT_RIGHT_ARITHMETIC, result, a, shift, bits, count); break;
+    case TEST_ROTATE_LEFT:            bitwiseShift(BITWISE_ROTATE_LEFT, result, a, shift, bits, count); break;
+    case TEST_COUNT_ONES:             bitwiseCount(BITWISE_COUNT_ONES, counts, a, bits, count); break;
+    case TEST_COUNT_LEADING_ZEROS:    bitwiseCount(BITWISE_COUNT_LEADING_ZEROS, counts, a, bits, count); break;
+    case TEST_COUNT_TRAILING_ZEROS:   bitwiseCount(BITWISE_COUNT_TRAILING_ZEROS, counts, a, bits, count); break;
+    default:                          bitwiseReverse(result, a, bits, count); break;
+    }
+}
+
+/*
+ * timeTest
+ *
+ * Best of three runs of one operation on the batch, in seconds.
+ */
+static double timeTest(_test test, bool useSimd, uint64_t* result, size_t* counts, const uint64_t* a,
+    const uint64_t* b, size_t bits, size_t count)
+{
+    double best = HUGE_VAL;
+
+    bitwiseUseSimd = useSimd;
+    for (int run = 0; run < 3; run++) {
+        double start = getSeconds();
+        runTest(test, result, counts, a, b, bits, count);
+        double seconds = getSeconds() - start;
+        best = (seconds < best) ? seconds : best;
+    }
+    bitwiseUseSimd = true;
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t bits = (argc > 1) ? (size_t)atol(argv[1]) : 4096;
+    size_t count = (argc > 2) ? (size_t)atol(argv[2]) : 4096;
+    size_t words = BITWISE_WORDS(bits) * count;
+    uint64_t* a = malloc(words * sizeof(uint64_t));
+    uint64_t* b = malloc(words * sizeof(uint64_t));
+    uint64_t* simdResult = malloc(words * sizeof(uint64_t));
+    uint64_t* portableResult = malloc(words * sizeof(uint64_t));
+    size_t* simdCounts = malloc(count * sizeof(size_t));
+    size_t* portableCounts = malloc(count * sizeof(size_t));
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    int failures = 0;
+
+    if (bits == 0 || a == NULL || b == NULL || simdResult == NULL || portableResult == NULL || simdCounts == NULL ||
+        portableCounts == NULL) {
+        printf("cannot allocate %zu integers of %zu bits\n", count, bits);
+        return 1;
+    }
+
+    // Random integers with a random number of zero words at each end, so
+    // the zero counts have words to skip
+    memset(a, 0, words * sizeof(uint64_t));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t* value = a + i * BITWISE_WORDS(bits);
+        size_t from = (size_t)(nextRandom(&state) % bits), to = (size_t)(nextRandom(&state) % bits);
+        for (size_t bit = (from < to) ? from : to; bit <= ((from < to) ? to : from); bit++) {
+            value[bit / 64] |= (nextRandom(&state) & 1) << (bit % 64);
+        }
+    }
+    for (size_t i = 0; i < words; i++) {
+        b[i] = nextRandom(&state);
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t* value = b + i * BITWISE_WORDS(bits);
+        if (bits % 64 != 0) {  // The bits above the width are 0
+            value[bits / 64] &= (UINT64_C(1) << (bits % 64)) - 1;
+        }
+    }
+
+    printf("%zu integers of %zu bits, ns per integer\n", count, bits);
+    printf("%-18s %10s %10s %8s\n", "operation", "simd", "portable", "speedup");
+    for (int test = 0; test < TEST_COUNT; test++) {
+        double simd = timeTest(test, true, simdResult, simdCounts, a, b, bits, count);
+        double portable = timeTest(test, false, portableResult, portableCounts, a, b, bits, count);
+        bool isSame = (test >= TEST_COUNT_ONES && test <= TEST_COUNT_TRAILING_ZEROS)
+            ? memcmp(simdCounts, portableCounts, count * sizeof(size_t)) == 0
+            : memcmp(simdResult, portableResult, words * sizeof(uint64_t)) == 0;
+        printf("%-18s %10.1f %10.1f %7.2fx%s\n", TEST_NAMES[test], simd / (double)count * 1e9,
+            portable / (double)count * 1e9, portable / simd, isSame ? "" : "  results differ");
+        failures += !isSame;
+    }
+
+    free(a);
+    free(b);
+    free(simdResult);
+    free(portableResult);
+    free(simdCounts);
+    free(portableCounts);
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,181 @@
+/*-----------------------------------------------------------------------------
+    dataload.c --  Bulk data point loader benchmark.
+
+               Writes a CSV file of rows "index;timestamp;value" with a
+               heading and a malformed line every 10000 rows, using ',' as
+               the decimal separator, then loads the value column with
+               dataLoadFile on one thread and on every processor, with
+               the timestamp as the x of a regression, and prints rows/s
+               and MB/s. The points must be the same for both and equal
+               to strtod on the written text, and both fits must agree;
+               a strtod loop over the same file is timed for comparison.
+
+               Usage: bench_dataload [rows [file]]
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//dataload.h"
+#include "bench.h"
+
+#define MALFORMED_EVERY 10000
+
+/*
+ * writeData
+ *
+ * Writes the CSV file and keeps the values it should load, as strtod
+ * reads them.
+ */
+static double* writeData(const char* path, size_t rows, size_t* valueCount)
+{
+    FILE* file = fopen(path, "wb");
+    double* values = malloc(rows * sizeof(double));
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    char text[64];
+
+    if (file == NULL || values == NULL) {
+        printf("cannot write %s\n", path);
+        exit(1);
+    }
+    fprintf(file, "index;time;value\n");
+    *valueCount = 0;
+    for (size_t i = 0; i < rows; i++) {
+        if (i % MALFORMED_EVERY == MALFORMED_EVERY - 1) {
+            fprintf(file, "%zu;%zu;n/a\r\n", i, 1700000000 + i);
+            continue;
+        }
+        nextRandom(&state);
+
+        // Mostly short measurements, some with many digits or an exponent
+        switch (state & 7) {
+        case 0:
+            snprintf(text, sizeof(text), "%.17g", (double)(state >> 11) * 0x1p-53 * 1000.0);
+            break;
+        case 1:
+            snprintf(text, sizeof(text), "%.6e", (double)(state >> 20) * 1e-9 - 2000.0);
+            break;
+        default:
+            snprintf(text, sizeof(text), "%.3f", (double)(state >> 40) * 1e-3 - 8000.0);
+            break;
+        }
+        values[(*valueCount)++] = strtod(text, NULL);
+        for (char* c = text; *c != '\0'; c++) {
+            *c = (*c == '.') ? ',' : *c;
+        }
+        fprintf(file, "%zu;%zu;%s\n", i, 1700000000 + i, text);
+    }
+    fclose(file);
+    return values;
+}
+
+/*
+ * loadWithStrtod
+ *
+ * The third field of each line with strtod, as a naive loader would.
+ */
+static size_t loadWithStrtod(const char* path, double* checksum)
+{
+    FILE* file = fopen(path, "rb");
+    char line[256];
+    size_t count = 0;
+
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL) {
+        char* value = strchr(line, ';');
+        value = (value != NULL) ? strchr(value + 1, ';') : NULL;
+        if (value != NULL) {
+            char* comma = strchr(value, ',');
+            char* stop;
+            if (comma != NULL) {
+                *comma = '.';
+            }
+            double point = strtod(value + 1, &stop);
+            if (stop != value + 1) {
+                *checksum += point;
+                count++;
+            }
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    return count;
+}
+
+int main(int argc, char** argv)
+{
+    long rowCount = (argc > 1) ? atol(argv[1]) : 10000000;
+    const char* path = (argc > 2) ? argv[2] : "bench_dataload.csv";
+    _dataLoadOptions options = { ',', 2, 1, 1 };
+    _dataLoadReport report;
+    _statistics single, parallel;
+    size_t valueCount;
+    bool isLoaded = true;
+    int failures = 0;
+
+    // atol gives 0 for text that is no number, and no rows leave no points
+    if (rowCount < 1) {
+        printf("usage: bench_dataload [rows >= 1 [file]]\n");
+        return 1;
+    }
+    size_t rows = (size_t)rowCount;
+    double* values = writeData(path, rows, &valueCount);
+    statisticsInit(&single);
+    statisticsInit(&parallel);
+
+    for (int pass = 0; pass < 2; pass++) {
+        _statistics* statistics = (pass == 0) ? &single : &parallel;
+        options.threads = (pass == 0) ? 1 : 0;
+        if (dataLoadFile(statistics, path, &options, &report) != STATUS_SUCCESS) {
+            printf("cannot load %s\n", path);
+            isLoaded = false;
+            failures++;
+            break;
+        }
+        printf("%u thread%s: %zu rows, %zu skipped lines, %.3f s, %.1f M rows/s, %.0f MB/s\n", report.threads,
+            (report.threads == 1) ? " " : "s", report.rows, report.skippedLines, report.seconds,
+            (double)report.rows / report.seconds * 1e-6, (double)report.bytes / report.seconds * 1e-6);
+        if (report.rows != valueCount || report.skippedLines != rows - valueCount + 1) {
+            failures++;
+        }
+    }
+
+    // Only a full load has points to compare; points is NULL when empty
+    double singleFit[REGRESSION_COLUMNS], parallelFit[REGRESSION_COLUMNS];
+    if (isLoaded && valueCount > 0) {
+        if (single.count != valueCount || parallel.count != valueCount ||
+            memcmp(single.points, values, valueCount * sizeof(double)) != 0 ||
+            memcmp(parallel.points, values, valueCount * sizeof(double)) != 0) {
+            printf("loaded points differ from strtod\n");
+            failures++;
+        }
+        if (single.regression.count != valueCount || parallel.regression.count != valueCount ||
+            regressionGetCoefficients(&single.regression, singleFit) != STATUS_SUCCESS ||
+            regressionGetCoefficients(&parallel.regression, parallelFit) != STATUS_SUCCESS ||
+            fabs(singleFit[1] - parallelFit[1]) > 1e-9 * fabs(singleFit[1]) + 1e-15) {
+            printf("loaded regressions differ\n");
+            failures++;
+        }
+        else {
+            printf("fit: value = %.6g + %.6g timestamp\n", singleFit[0], singleFit[1]);
+        }
+    }
+
+    double checksum = 0.0;
+    double start = getSeconds();
+    size_t count = loadWithStrtod(path, &checksum);
+    double seconds = getSeconds() - start;
+    printf("fgets+strtod: %zu rows, %.3f s, %.1f M rows/s (checksum %g)\n", count, seconds,
+        (double)count / seconds * 1e-6, checksum);
+
+    printf("%d failures\n", failures);
+    statisticsFree(&single);
+    statisticsFree(&parallel);
+    free(values);
+    if (argc <= 2) {
+        remove(path);
+    }
+    return failures != 0;
+}
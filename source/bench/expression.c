@@ -0,0 +1,251 @@
+/*-----------------------------------------------------------------------------
+    expression.c --  Compiled expression benchmark.
+
+               Evaluates a few scientific-mode formulas two ways: by
+               replaying their keys through processKey(), as the keypad
+               does, and by compiling the formula text once with
+               expressionCompile and running expressionEvaluate. Before
+               timing, both results are formatted to the 13 display digits
+               and must agree.
+
+               A second run evaluates a formula with a variable over a
+               column of values through expressionEvaluateBatch.
+
+               A last run optimizes a corpus of formulas with
+               expressionOptimize and reports the instruction counts and
+               the evaluation time before and after. The optimized
+               results must have the same bits and status as the
+               unoptimized ones.
+
+               Usage: bench_expression [iterations]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//engine.h"
+#include "..//headers//expression.h"
+#include "..//headers//format.h"
+#include "..//headers//optimize.h"
+#include "bench.h"
+
+#define DISPLAY_DIGITS 13
+#define BATCH_ROWS 100000
+#define OPTIMIZER_ROWS 1024
+
+typedef struct {
+    const char* text;
+    const uint32_t* keys;
+    size_t keyCount;
+} _formula;
+
+// 2 * ( 3 + 4 ) x^y 2 - 30 sin =
+static const uint32_t POLYNOMIAL_KEYS[] = {
+    IDC_BUTTON_2, IDC_BUTTON_MUL, IDC_BUTTON_LPAR, IDC_BUTTON_3, IDC_BUTTON_ADD, IDC_BUTTON_4,
+    IDC_BUTTON_RPAR, IDC_BUTTON_XY, IDC_BUTTON_2, IDC_BUTTON_SUB, IDC_BUTTON_3, IDC_BUTTON_0,
+    IDC_BUTTON_SIN, IDC_BUTTON_EQ, IDC_BUTTON_CA
+};
+
+// 1 / ( 1 + 0.5 +/- exp ) =
+static const uint32_t LOGISTIC_KEYS[] = {
+    IDC_BUTTON_1, IDC_BUTTON_DIV, IDC_BUTTON_LPAR, IDC_BUTTON_1, IDC_BUTTON_ADD, IDC_BUTTON_0,
+    IDC_BUTTON_DOT, IDC_BUTTON_5, IDC_BUTTON_NEG, IDC_BUTTON_EXP, IDC_BUTTON_RPAR, IDC_BUTTON_EQ,
+    IDC_BUTTON_CA
+};
+
+// ( 3 x^y 2 + 4 x^y 2 ) sqrt * pi =
+static const uint32_t HYPOTENUSE_KEYS[] = {
+    IDC_BUTTON_LPAR, IDC_BUTTON_3, IDC_BUTTON_XY, IDC_BUTTON_2, IDC_BUTTON_ADD, IDC_BUTTON_4,
+    IDC_BUTTON_XY, IDC_BUTTON_2, IDC_BUTTON_RPAR, IDC_BUTTON_SQRT, IDC_BUTTON_MUL, IDC_BUTTON_PI,
+    IDC_BUTTON_EQ, IDC_BUTTON_CA
+};
+
+// ( 1.5 + 2.25 ) * ( ( 7 - 3 ) / 8 ) mod 3 - 45 tan =
+static const uint32_t NESTED_KEYS[] = {
+    IDC_BUTTON_LPAR, IDC_BUTTON_1, IDC_BUTTON_DOT, IDC_BUTTON_5, IDC_BUTTON_ADD, IDC_BUTTON_2,
+    IDC_BUTTON_DOT, IDC_BUTTON_2, IDC_BUTTON_5, IDC_BUTTON_RPAR, IDC_BUTTON_MUL, IDC_BUTTON_LPAR,
+    IDC_BUTTON_LPAR, IDC_BUTTON_7, IDC_BUTTON_SUB, IDC_BUTTON_3, IDC_BUTTON_RPAR, IDC_BUTTON_DIV,
+    IDC_BUTTON_8, IDC_BUTTON_RPAR, IDC_BUTTON_MOD, IDC_BUTTON_3, IDC_BUTTON_SUB, IDC_BUTTON_4,
+    IDC_BUTTON_5, IDC_BUTTON_TAN, IDC_BUTTON_EQ, IDC_BUTTON_CA
+};
+
+#define FORMULA(text, keys) { text, keys, sizeof(keys) / sizeof(keys[0]) }
+
+static const _formula FORMULAS[] = {
+    FORMULA("2*(3+4)^2 - sin(30)", POLYNOMIAL_KEYS),
+    FORMULA("1/(1 + exp(-0.5))", LOGISTIC_KEYS),
+    FORMULA("sqrt(3^2 + 4^2) * pi", HYPOTENUSE_KEYS),
+    FORMULA("(1.5 + 2.25) * ((7 - 3) / 8) mod 3 - tan(45)", NESTED_KEYS),
+};
+
+// Formulas for the optimizer, in the variable x
+static const char* const OPTIMIZER_FORMULAS[] = {
+    "sin(x)*sin(x) + cos(x)*cos(x)",
+    "sin(30) + x",
+    "2*pi*x + 2*pi",
+    "(x + 1)^2 + (x + 1)^3 + sqrt(x + 1)",
+    "exp(-x*x/2) / sqrt(2*pi) * (1 + x*x/2)",
+    "tan(45)*x - ln(10)*log(x + 1) + ln(10)",
+    "(1 + 0.05/12)^(12*x) - (1 + 0.05/12)^12",
+    "1/(1 + exp(-x)) * (1 - 1/(1 + exp(-x)))",
+    "1/0 + x",
+};
+
+/*
+ * timeEvaluations
+ *
+ * @return  Seconds per evaluation of expression over the inputs.
+ */
+static double timeEvaluations(_expression* expression, const double* inputs, long iterations, double* checksum)
+{
+    double result = 0.0;
+    double start = getSeconds();
+
+    for (long i = 0; i < iterations; i++) {
+        if (expressionEvaluate(expression, &inputs[i & (OPTIMIZER_ROWS - 1)], &result) == STATUS_SUCCESS) {
+            *checksum += result;
+        }
+    }
+    return (getSeconds() - start) / (double)iterations;
+}
+
+/*
+ * replayKeys
+ *
+ * Feeds the keys of a formula up to (not including) the final clear and
+ * returns the display text.
+ */
+static void replayKeys(_calcEngine* engine, const _formula* formula, char* display, size_t displaySize)
+{
+    for (size_t k = 0; k + 1 < formula->keyCount; k++) {
+        processKey(engine, formula->keys[k]);
+    }
+    getDisplayString(engine, display, displaySize);
+    processKey(engine, formula->keys[formula->keyCount - 1]);
+}
+
+int main(int argc, char** argv)
+{
+    long iterations = (argc > 1) ? atol(argv[1]) : 200000;
+    size_t formulaCount = sizeof(FORMULAS) / sizeof(FORMULAS[0]);
+    _calcEngine engine;
+    _expression expression;
+    char display[MAX_DISPLAY_DIGITS], text[MAX_DISPLAY_DIGITS];
+    double result = 0.0, checksum = 0.0;
+    int failures = 0;
+
+    initEngine(&engine);
+    engine.mode = SCIENTIFIC_MODE;
+    expressionInit(&expression);
+
+    printf("%-46s %10s %10s %10s %8s\n", "", "compile", "keys", "compiled", "speedup");
+    for (size_t f = 0; f < formulaCount; f++) {
+        const _formula* formula = &FORMULAS[f];
+
+        replayKeys(&engine, formula, display, sizeof(display));
+        if (expressionCompile(&expression, formula->text, &engine) != STATUS_SUCCESS ||
+            expressionEvaluate(&expression, NULL, &result) != STATUS_SUCCESS) {
+            printf("%s: failed to compile or evaluate\n", formula->text);
+            failures++;
+            continue;
+        }
+        formatDouble(text, sizeof(text), result, NUMBER_LAYOUT_AUTOMATIC, DISPLAY_DIGITS, engine.decimalSeparator);
+        if (strcmp(text, display) != 0) {
+            printf("%s: %s compiled, %s keyed\n", formula->text, text, display);
+            failures++;
+        }
+
+        double start = getSeconds();
+        for (long i = 0; i < iterations / 10; i++) {
+            expressionCompile(&expression, formula->text, &engine);
+        }
+        double compileSeconds = (getSeconds() - start) / (double)(iterations / 10);
+
+        start = getSeconds();
+        for (long i = 0; i < iterations; i++) {
+            for (size_t k = 0; k < formula->keyCount; k++) {
+                processKey(&engine, formula->keys[k]);
+            }
+        }
+        double keySeconds = (getSeconds() - start) / (double)iterations;
+
+        start = getSeconds();
+        for (long i = 0; i < iterations; i++) {
+            expressionEvaluate(&expression, NULL, &result);
+            checksum += result;
+        }
+        double evaluateSeconds = (getSeconds() - start) / (double)iterations;
+
+        printf("%-46s %7.1f ns %7.1f ns %7.1f ns %7.1fx\n", formula->text, compileSeconds * 1e9,
+            keySeconds * 1e9, evaluateSeconds * 1e9, keySeconds / evaluateSeconds);
+    }
+
+    // One formula over a column of inputs
+    static double inputs[BATCH_ROWS], outputs[BATCH_ROWS];
+    for (int i = 0; i < BATCH_ROWS; i++) {
+        inputs[i] = (double)i * 0.001;
+    }
+    const char* batchText = "x^2 + 3*x - sin(x) / (1 + x)";
+    if (expressionCompile(&expression, batchText, &engine) != STATUS_SUCCESS) {
+        printf("%s: failed to compile\n", batchText);
+        failures++;
+    }
+    else {
+        long rounds = iterations / 1000 + 1;
+        double start = getSeconds();
+        for (long r = 0; r < rounds; r++) {
+            expressionEvaluateBatch(&expression, inputs, BATCH_ROWS, outputs);
+            checksum += outputs[BATCH_ROWS - 1];
+        }
+        double seconds = (getSeconds() - start) / ((double)rounds * BATCH_ROWS);
+        printf("%-46s %21s %7.1f ns/row\n", batchText, "batch", seconds * 1e9);
+    }
+
+    // Instruction counts and timing before and after expressionOptimize
+    _expression optimized;
+    double optimizerInputs[OPTIMIZER_ROWS];
+    int totalBefore = 0, totalAfter = 0;
+
+    expressionInit(&optimized);
+    for (int i = 0; i < OPTIMIZER_ROWS; i++) {
+        optimizerInputs[i] = -5.0 + (double)i * 0.01;
+    }
+    printf("\n%-46s %6s %6s %10s %10s\n", "", "before", "after", "before", "after");
+    for (size_t f = 0; f < sizeof(OPTIMIZER_FORMULAS) / sizeof(OPTIMIZER_FORMULAS[0]); f++) {
+        const char* formula = OPTIMIZER_FORMULAS[f];
+        if (expressionCompile(&expression, formula, &engine) != STATUS_SUCCESS ||
+            expressionCompile(&optimized, formula, &engine) != STATUS_SUCCESS ||
+            expressionOptimize(&optimized) != STATUS_SUCCESS) {
+            printf("%s: failed to compile or optimize\n", formula);
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < OPTIMIZER_ROWS; i++) {
+            double plain = 0.0, reduced = 0.0;
+            int plainStatus = expressionEvaluate(&expression, &optimizerInputs[i], &plain);
+            int reducedStatus = expressionEvaluate(&optimized, &optimizerInputs[i], &reduced);
+            if (plainStatus != reducedStatus ||
+                (plainStatus == STATUS_SUCCESS && memcmp(&plain, &reduced, sizeof(double)) != 0)) {
+                printf("%s, x = %g: status %d, %.17g before; status %d, %.17g after\n", formula,
+                    optimizerInputs[i], plainStatus, plain, reducedStatus, reduced);
+                failures++;
+                break;
+            }
+        }
+
+        double beforeSeconds = timeEvaluations(&expression, optimizerInputs, iterations, &checksum);
+        double afterSeconds = timeEvaluations(&optimized, optimizerInputs, iterations, &checksum);
+        totalBefore += expression.codeLength;
+        totalAfter += optimized.codeLength;
+        printf("%-46s %6d %6d %7.1f ns %7.1f ns\n", formula, expression.codeLength, optimized.codeLength,
+            beforeSeconds * 1e9, afterSeconds * 1e9);
+    }
+    printf("%-46s %6d %6d\n", "total instructions", totalBefore, totalAfter);
+    expressionFree(&optimized);
+
+    printf("%d failures (checksum %g)\n", failures, checksum);
+    expressionFree(&expression);
+    freeEngine(&engine);
+    return failures != 0;
+}
@@ -0,0 +1,141 @@
+/*-----------------------------------------------------------------------------
+    extfloat.c --  Software 80-bit arithmetic benchmark.
+
+               Runs the batch API of the software extended-precision
+               kernel over arrays of random operands and reports
+               nanoseconds per operation. When the host long double is the
+               x87 80-bit format, the same operations are timed on
+               long double and every software result is checked bit for
+               bit against the hardware one.
+
+               Usage: bench_extfloat [rounds]
+
+  -----------------------------------------------------------------------------*/
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//extfloat.h"
+#include "bench.h"
+
+#define ARRAY_LENGTH 4096
+
+#if LDBL_MANT_DIG == 64
+#define HAS_X87_LONG_DOUBLE 1
+#else
+#define HAS_X87_LONG_DOUBLE 0
+#endif
+
+typedef enum { OPERATION_ADD, OPERATION_SUB, OPERATION_MUL, OPERATION_DIV, OPERATION_SQRT } _operation;
+
+static const char* OPERATION_NAMES[] = { "add", "sub", "mul", "div", "sqrt" };
+
+static _extendedFloat80 operandsA[ARRAY_LENGTH], operandsB[ARRAY_LENGTH], results[ARRAY_LENGTH];
+#if HAS_X87_LONG_DOUBLE
+static long double hardwareA[ARRAY_LENGTH], hardwareB[ARRAY_LENGTH], hardwareResults[ARRAY_LENGTH];
+#endif
+
+// Random normal values with exponents within +/-64 of 1.0
+static void fillOperands(void)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        _extendedFloat80* values[] = { &operandsA[i], &operandsB[i] };
+        for (int k = 0; k < 2; k++) {
+            uint64_t mantissa = nextRandom(&state) | 0x8000000000000000ull;
+            values[k]->exponent = (uint16_t)(EXTENDED_FLOAT_BIAS - 64 + nextRandom(&state) % 128);
+            values[k]->mantissaHigh = (uint32_t)(mantissa >> 32);
+            values[k]->mantissaLow = (uint32_t)mantissa;
+        }
+#if HAS_X87_LONG_DOUBLE
+        long double* hardware[] = { &hardwareA[i], &hardwareB[i] };
+        for (int k = 0; k < 2; k++) {
+            unsigned char bytes[sizeof(long double)] = { 0 };
+            uint64_t mantissa = ((uint64_t)values[k]->mantissaHigh << 32) | values[k]->mantissaLow;
+            memcpy(bytes, &mantissa, 8);
+            memcpy(bytes + 8, &values[k]->exponent, 2);
+            memcpy(hardware[k], bytes, sizeof(long double));
+        }
+#endif
+    }
+}
+
+static void runSoftware(_operation operation)
+{
+    switch (operation) {
+    case OPERATION_ADD:  extendedFloat80AddArray(results, operandsA, operandsB, ARRAY_LENGTH); break;
+    case OPERATION_SUB:  extendedFloat80SubArray(results, operandsA, operandsB, ARRAY_LENGTH); break;
+    case OPERATION_MUL:  extendedFloat80MulArray(results, operandsA, operandsB, ARRAY_LENGTH); break;
+    case OPERATION_DIV:  extendedFloat80DivArray(results, operandsA, operandsB, ARRAY_LENGTH); break;
+    case OPERATION_SQRT: extendedFloat80SqrtArray(results, operandsA, ARRAY_LENGTH); break;
+    }
+}
+
+#if HAS_X87_LONG_DOUBLE
+static void runHardware(_operation operation)
+{
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        switch (operation) {
+        case OPERATION_ADD:  hardwareResults[i] = hardwareA[i] + hardwareB[i]; break;
+        case OPERATION_SUB:  hardwareResults[i] = hardwareA[i] - hardwareB[i]; break;
+        case OPERATION_MUL:  hardwareResults[i] = hardwareA[i] * hardwareB[i]; break;
+        case OPERATION_DIV:  hardwareResults[i] = hardwareA[i] / hardwareB[i]; break;
+        case OPERATION_SQRT: hardwareResults[i] = sqrtl(hardwareA[i]); break;
+        }
+    }
+}
+
+static int countMismatches(void)
+{
+    int mismatches = 0;
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        unsigned char bytes[sizeof(long double)];
+        uint64_t mantissa;
+        uint16_t exponent;
+        memcpy(bytes, &hardwareResults[i], sizeof(long double));
+        memcpy(&mantissa, bytes, 8);
+        memcpy(&exponent, bytes + 8, 2);
+        if (exponent != results[i].exponent ||
+            mantissa != (((uint64_t)results[i].mantissaHigh << 32) | results[i].mantissaLow)) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    long rounds = (argc > 1) ? atol(argv[1]) : 2000;
+    int failures = 0;
+
+    fillOperands();
+    printf("%-5s %14s %14s %10s\n", "op", "software ns", "long double ns", "mismatches");
+
+    for (int operation = OPERATION_ADD; operation <= OPERATION_SQRT; operation++) {
+        double start = getSeconds();
+        for (long r = 0; r < rounds; r++) {
+            runSoftware((_operation)operation);
+        }
+        double softwareTime = (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH);
+        printf("%-5s %14.2f", OPERATION_NAMES[operation], softwareTime * 1e9);
+
+#if HAS_X87_LONG_DOUBLE
+        start = getSeconds();
+        for (long r = 0; r < rounds; r++) {
+            runHardware((_operation)operation);
+            __asm__ volatile("" : : "r"(hardwareResults) : "memory");
+        }
+        double hardwareTime = (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH);
+        int mismatches = countMismatches();
+        failures += mismatches;
+        printf(" %14.2f %10d\n", hardwareTime * 1e9, mismatches);
+#else
+        printf(" %14s %10s\n", "n/a", "n/a");
+#endif
+    }
+    return failures != 0;
+}
@@ -0,0 +1,194 @@
+/*-----------------------------------------------------------------------------
+    fixedint.c --  Fixed-width integer benchmark.
+
+               Times fixedIntCalculate for each word size from 8 to 512
+               bits over arrays of random operands, in nanoseconds per
+               operation, and the hexadecimal text of the display. For
+               64 bits (and 128 where the compiler has unsigned __int128)
+               the same operations run on the native type as well, and
+               every fixedIntCalculate result is checked bit for bit
+               against it.
+
+               Usage: bench_fixedint [rounds]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//engine.h"
+#include "..//headers//fixedint.h"
+#include "bench.h"
+
+#define ARRAY_LENGTH 4096
+
+#if defined(__SIZEOF_INT128__)
+#define HAS_INT128 1
+#else
+#define HAS_INT128 0
+#endif
+
+static const uint32_t OPERATORS[] = { IDC_BUTTON_ADD, IDC_BUTTON_MUL, IDC_BUTTON_DIV, IDC_BUTTON_XOR, IDC_BUTTON_LSH };
+static const char* OPERATOR_NAMES[] = { "add", "mul", "div", "xor", "lsh" };
+#define OPERATOR_COUNT (sizeof(OPERATORS) / sizeof(OPERATORS[0]))
+
+static _fixedInt operandsA[ARRAY_LENGTH], operandsB[ARRAY_LENGTH], results[ARRAY_LENGTH];
+static volatile uint64_t sink;
+
+// Random values of every length up to the word size; shift counts below it
+static void fillOperands(int bits, uint32_t operatorKey)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        _fixedInt* values[] = { &operandsA[i], &operandsB[i] };
+        for (int k = 0; k < 2; k++) {
+            int used = 1 + (int)(nextRandom(&state) % FIXED_INT_WORDS(bits));
+            fixedIntSet(values[k], 0, bits);
+            for (int w = 0; w < used; w++) {
+                values[k]->words[w] = nextRandom(&state);
+            }
+            fixedIntResize(values[k], bits);
+        }
+        if (operatorKey == IDC_BUTTON_LSH) {
+            fixedIntSet(&operandsB[i], (int64_t)(nextRandom(&state) % (uint64_t)bits), bits);
+        }
+        else if (fixedIntIsZero(&operandsB[i])) {
+            fixedIntSet(&operandsB[i], 1, bits);
+        }
+    }
+}
+
+static double timeOperator(uint32_t operatorKey, int rounds)
+{
+    double start = getSeconds();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < ARRAY_LENGTH; i++) {
+            fixedIntCalculate(operatorKey, &results[i], &operandsA[i], &operandsB[i]);
+        }
+    }
+    return (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH) * 1e9;
+}
+
+static double timeText(int rounds)
+{
+    char text[FIXED_INT_MAX_TEXT];
+    size_t length = 0;
+
+    double start = getSeconds();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < ARRAY_LENGTH; i++) {
+            length += fixedIntToString(&operandsA[i], text, sizeof(text), 16);
+        }
+    }
+    sink = length;
+    return (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH) * 1e9;
+}
+
+// The native result of one operator, signed division as in C
+static uint64_t nativeCalculate64(uint32_t operatorKey, uint64_t a, uint64_t b)
+{
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD: return a + b;
+    case IDC_BUTTON_MUL: return a * b;
+    case IDC_BUTTON_DIV: return ((int64_t)b == -1) ? 0 - a : (uint64_t)((int64_t)a / (int64_t)b);
+    case IDC_BUTTON_XOR: return a ^ b;
+    default:             return a << b;
+    }
+}
+
+#if HAS_INT128
+typedef unsigned __int128 _uint128;
+
+static _uint128 nativeCalculate128(uint32_t operatorKey, _uint128 a, _uint128 b)
+{
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD: return a + b;
+    case IDC_BUTTON_MUL: return a * b;
+    case IDC_BUTTON_DIV: return ((__int128)b == -1) ? 0 - a : (_uint128)((__int128)a / (__int128)b);
+    case IDC_BUTTON_XOR: return a ^ b;
+    default:             return a << (int)b;
+    }
+}
+#endif
+
+/*
+ * runNative
+ *
+ * Times the native type for 64 and 128 bits and checks the results of
+ * the last timeOperator run against it. Returns the number of mismatches;
+ * *nanoseconds is negative when there is no native type.
+ */
+static int runNative(int bits, uint32_t operatorKey, int rounds, double* nanoseconds)
+{
+    static uint64_t native64[ARRAY_LENGTH];
+    int failures = 0;
+
+    *nanoseconds = -1.0;
+    if (bits == 64) {
+        double start = getSeconds();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < ARRAY_LENGTH; i++) {
+                native64[i] = nativeCalculate64(operatorKey, operandsA[i].words[0], operandsB[i].words[0]);
+            }
+            sink = native64[round % ARRAY_LENGTH];
+        }
+        *nanoseconds = (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH) * 1e9;
+        for (int i = 0; i < ARRAY_LENGTH; i++) {
+            failures += (native64[i] != results[i].words[0]);
+        }
+    }
+#if HAS_INT128
+    else if (bits == 128) {
+        static _uint128 native128[ARRAY_LENGTH];
+        double start = getSeconds();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < ARRAY_LENGTH; i++) {
+                _uint128 a = ((_uint128)operandsA[i].words[1] << 64) | operandsA[i].words[0];
+                _uint128 b = ((_uint128)operandsB[i].words[1] << 64) | operandsB[i].words[0];
+                native128[i] = nativeCalculate128(operatorKey, a, b);
+            }
+            sink = (uint64_t)native128[round % ARRAY_LENGTH];
+        }
+        *nanoseconds = (getSeconds() - start) / ((double)rounds * ARRAY_LENGTH) * 1e9;
+        for (int i = 0; i < ARRAY_LENGTH; i++) {
+            failures += ((uint64_t)native128[i] != results[i].words[0] ||
+                         (uint64_t)(native128[i] >> 64) != results[i].words[1]);
+        }
+    }
+#endif
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    int failures = 0;
+
+    printf("%d rounds of %d operations, ns per operation (native in brackets)\n", rounds, ARRAY_LENGTH);
+    printf("%-6s", "bits");
+    for (size_t k = 0; k < OPERATOR_COUNT; k++) {
+        printf(" %16s", OPERATOR_NAMES[k]);
+    }
+    printf(" %10s\n", "hex text");
+
+    for (int bits = FIXED_INT_MIN_BITS; bits <= FIXED_INT_MAX_BITS; bits *= 2) {
+        printf("%-6d", bits);
+        for (size_t k = 0; k < OPERATOR_COUNT; k++) {
+            double native;
+            fillOperands(bits, OPERATORS[k]);
+            double nanoseconds = timeOperator(OPERATORS[k], rounds);
+            failures += runNative(bits, OPERATORS[k], rounds, &native);
+            if (native >= 0.0) {
+                printf(" %7.2f [%6.2f]", nanoseconds, native);
+            }
+            else {
+                printf(" %16.2f", nanoseconds);
+            }
+        }
+        printf(" %10.2f\n", timeText(rounds / 8 + 1));
+    }
+
+    printf("%d mismatches\n", failures);
+    return failures != 0;
+}
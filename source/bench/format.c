@@ -0,0 +1,223 @@
+/*-----------------------------------------------------------------------------
+    format.c --  Number formatting benchmark for formatDouble and
+                 formatExtendedFloat80.
+
+               Formats a corpus of calculator results (short typed values,
+               quotients with 17 significant digits, values with large and
+               small exponents) and reports nanoseconds per number next to
+               snprintf doing the same job: "%.17g" for round-trip text,
+               "%.13g" for the display and, when long double is the x87
+               80-bit format, "%.21Lg" for extended values.
+
+               Before timing, every value is checked: the shortest text
+               must read back to the same bits (strtod for doubles,
+               stringToExtendedFloat80 for extended values) and must be no
+               longer than the shortest "%.*e" that does, and the display
+               text must equal the "%.13g" text.
+
+               Usage: bench_format [rounds]
+
+  -----------------------------------------------------------------------------*/
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//format.h"
+#include "..//headers//operations.h"
+#include "bench.h"
+
+#define CORPUS_NUMBERS 20000
+#define DISPLAY_DIGITS 13
+#define TEXT_SIZE 64
+
+#if LDBL_MANT_DIG == 64
+#define HAS_X87_LONG_DOUBLE 1
+#else
+#define HAS_X87_LONG_DOUBLE 0
+#endif
+
+static double values[CORPUS_NUMBERS];
+static _extendedFloat80 extendedValues[CORPUS_NUMBERS];
+
+static void buildCorpus(void)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (int i = 0; i < CORPUS_NUMBERS; i++) {
+        uint64_t r = nextRandom(&state);
+        double fraction = (double)(r >> 11) * 0x1p-53;
+        switch (i % 4) {
+        case 0:  // Typed value
+            values[i] = (double)(r % 10000000) / 100.0;
+            break;
+        case 1:  // Quotient with a long expansion
+            values[i] = (double)(r % 100000) / (double)(3 + (r >> 40) % 997);
+            break;
+        case 2:  // Large and small magnitudes
+            values[i] = (fraction + 0.5) * ((r & 1) ? 1e250 : 1e-250);
+            break;
+        default: // Random bit patterns of finite doubles
+            memcpy(&values[i], &r, sizeof(double));
+            if (values[i] != values[i] || values[i] - values[i] != 0.0) {
+                values[i] = fraction;
+            }
+            break;
+        }
+
+        uint64_t mantissa = nextRandom(&state) | 0x8000000000000000ull;
+        uint32_t exponent = (i % 8 == 0) ? (uint32_t)(1 + nextRandom(&state) % 0x7FFD)
+                                         : (uint32_t)(EXTENDED_FLOAT_BIAS - 64 + nextRandom(&state) % 128);
+        extendedValues[i].exponent = (uint16_t)(exponent | ((i & 1) ? EXTENDED_FLOAT_SIGN : 0));
+        extendedValues[i].mantissaHigh = (uint32_t)(mantissa >> 32);
+        extendedValues[i].mantissaLow = (uint32_t)mantissa;
+    }
+}
+
+static int countSignificantDigits(const char* text)
+{
+    int count = 0;
+    bool isStarted = false;
+
+    for (; *text != '\0' && *text != 'e'; text++) {
+        isStarted = isStarted || (*text >= '1' && *text <= '9');
+        count += isStarted && *text >= '0' && *text <= '9';
+    }
+    return count;
+}
+
+static int checkFormatting(void)
+{
+    char text[TEXT_SIZE], reference[TEXT_SIZE];
+    int failures = 0;
+
+    for (int i = 0; i < CORPUS_NUMBERS; i++) {
+        double value = values[i];
+
+        formatDouble(text, sizeof(text), value, NUMBER_LAYOUT_SCIENTIFIC, FORMAT_SHORTEST, '.');
+        double parsed = strtod(text, NULL);
+        int precision = 1;
+        while (precision < 17) {
+            snprintf(reference, sizeof(reference), "%.*e", precision - 1, value);
+            if (strtod(reference, NULL) == value) {
+                break;
+            }
+            precision++;
+        }
+        if (memcmp(&parsed, &value, sizeof(double)) != 0 || countSignificantDigits(text) > precision) {
+            if (failures++ < 5) {
+                printf("shortest failed: %s (%.17g)\n", text, value);
+            }
+        }
+
+        formatDouble(text, sizeof(text), value, NUMBER_LAYOUT_AUTOMATIC, DISPLAY_DIGITS, '.');
+        snprintf(reference, sizeof(reference), "%.*g", DISPLAY_DIGITS, value);
+        if (strcmp(text, reference) != 0) {
+            if (failures++ < 5) {
+                printf("display failed: %s instead of %s\n", text, reference);
+            }
+        }
+
+        _extendedFloat80 extendedParsed;
+        formatExtendedFloat80(text, sizeof(text), &extendedValues[i], NUMBER_LAYOUT_SCIENTIFIC, FORMAT_SHORTEST, ',');
+        stringToExtendedFloat80(&extendedParsed, text, ',');
+        if (extendedParsed.exponent != extendedValues[i].exponent ||
+            extendedParsed.mantissaHigh != extendedValues[i].mantissaHigh ||
+            extendedParsed.mantissaLow != extendedValues[i].mantissaLow) {
+            if (failures++ < 5) {
+                printf("extended round trip failed: %s\n", text);
+            }
+        }
+    }
+    return failures;
+}
+
+#if HAS_X87_LONG_DOUBLE
+static long double toLongDouble(const _extendedFloat80* value)
+{
+    unsigned char bytes[sizeof(long double)] = { 0 };
+    uint64_t mantissa = ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+    long double result;
+
+    memcpy(bytes, &mantissa, 8);
+    memcpy(bytes + 8, &value->exponent, 2);
+    memcpy(&result, bytes, sizeof(long double));
+    return result;
+}
+#endif
+
+static void printTiming(const char* name, double seconds, double referenceSeconds, long rounds)
+{
+    double count = (double)rounds * CORPUS_NUMBERS;
+    printf("%-34s %9.1f ns %9.1f ns %7.2fx\n", name, seconds / count * 1e9, referenceSeconds / count * 1e9,
+        referenceSeconds / seconds);
+}
+
+int main(int argc, char** argv)
+{
+    long rounds = (argc > 1) ? atol(argv[1]) : 20;
+    char text[TEXT_SIZE];
+    size_t checksum = 0;
+    double start, elapsed, referenceElapsed;
+
+    buildCorpus();
+    int failures = checkFormatting();
+    printf("checked %d doubles and %d extended values, %d failures\n", CORPUS_NUMBERS, CORPUS_NUMBERS, failures);
+    printf("%-34s %12s %12s %8s\n", "", "FreeCalc", "snprintf", "speedup");
+
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += formatDouble(text, sizeof(text), values[i], NUMBER_LAYOUT_AUTOMATIC, FORMAT_SHORTEST, '.');
+        }
+    }
+    elapsed = getSeconds() - start;
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += (size_t)snprintf(text, sizeof(text), "%.17g", values[i]);
+        }
+    }
+    referenceElapsed = getSeconds() - start;
+    printTiming("double, shortest vs %.17g", elapsed, referenceElapsed, rounds);
+
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += formatDouble(text, sizeof(text), values[i], NUMBER_LAYOUT_AUTOMATIC, DISPLAY_DIGITS, '.');
+        }
+    }
+    elapsed = getSeconds() - start;
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += (size_t)snprintf(text, sizeof(text), "%.13g", values[i]);
+        }
+    }
+    referenceElapsed = getSeconds() - start;
+    printTiming("double, 13 digits vs %.13g", elapsed, referenceElapsed, rounds);
+
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += formatExtendedFloat80(text, sizeof(text), &extendedValues[i], NUMBER_LAYOUT_AUTOMATIC,
+                FORMAT_SHORTEST, '.');
+        }
+    }
+    elapsed = getSeconds() - start;
+#if HAS_X87_LONG_DOUBLE
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < CORPUS_NUMBERS; i++) {
+            checksum += (size_t)snprintf(text, sizeof(text), "%.21Lg", toLongDouble(&extendedValues[i]));
+        }
+    }
+    referenceElapsed = getSeconds() - start;
+    printTiming("extended, shortest vs %.21Lg", elapsed, referenceElapsed, rounds);
+#else
+    printf("%-34s %9.1f ns %12s\n", "extended, shortest", elapsed / ((double)rounds * CORPUS_NUMBERS) * 1e9, "n/a");
+#endif
+
+    printf("(checksum %zu)\n", checksum);
+    return failures != 0;
+}
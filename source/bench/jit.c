@@ -0,0 +1,168 @@
+/*-----------------------------------------------------------------------------
+    jit.c --  Native code benchmark for compiled expressions.
+
+               Compiles sweep formulas with expressionCompile and
+               jitCompile, then evaluates each one 10^8 times (by default)
+               over a table of input rows, once through the interpreter
+               (expressionEvaluate) and once through the native code
+               (jitEvaluate), and reports nanoseconds per evaluation.
+
+               Before timing, every row of every formula, plus a set of
+               formulas that fail (bitwise operands beyond 64 bits among
+               them), must give the same status and the same bits both
+               ways.
+
+               Usage: bench_jit [evaluations]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//jit.h"
+#include "bench.h"
+
+#define ROWS 4096        // Power of two: rows are picked with a mask
+#define VARIABLES 4      // s, k, r, t
+
+static const char* const SWEEP_FORMULAS[] = {
+    "((s*1.5 + k)*s - 2.25)/(k*k + 1) + sqrt(s*s + k*k)",
+    "(s - k*exp(-r*t)) / (1 + r)^t",
+    "s*cos(t*30) - k*sin(t*30) + log(s/k) mod 2",
+    "(s and 255) xor (k lsh 2) + not(t)",
+    "atan(s/k) + t",
+};
+
+static const char* const FAILING_FORMULAS[] = {
+    "s / (k - k)", "sqrt(-s)", "ln(k - k)", "1 lsh (s + 64)", "1 lsh (0/0)", "exp(s*1000)", "inv(t - t)",
+    "(k - k) mod (r - r)", "0/0 + s", "(s*1e30) and 1", "1 or exp(s*1000)", "(-s*1e19) xor k",
+    "(s*1e19) lsh 2", "not(s*1e300)", "(0 - 9223372036854775808) or k",
+};
+
+static double rows[ROWS * VARIABLES];
+
+/*
+ * compileFormula
+ *
+ * Compiles text with the variables s, k, r and t bound to columns 0-3
+ * of the rows, whatever order the formula uses them in.
+ */
+static bool compileFormula(_expression* expression, _jitCode* code, const char* text, _calcEngine* engine,
+    int* columns)
+{
+    static const char* const NAMES[VARIABLES] = { "s", "k", "r", "t" };
+
+    if (expressionCompile(expression, text, engine) != STATUS_SUCCESS) {
+        printf("%s: does not compile\n", text);
+        return false;
+    }
+    jitCompile(code, expression);
+    for (int v = 0; v < expression->variableCount; v++) {
+        columns[v] = 0;
+        for (int c = 0; c < VARIABLES; c++) {
+            if (strcmp(expression->variables[v].text, NAMES[c]) == 0) {
+                columns[v] = c;
+            }
+        }
+    }
+    return true;
+}
+
+static void gatherRow(double* values, const int* columns, int variableCount, int row)
+{
+    for (int v = 0; v < variableCount; v++) {
+        values[v] = rows[row * VARIABLES + columns[v]];
+    }
+}
+
+static int checkFormula(_expression* expression, const _jitCode* code, const int* columns, const char* text)
+{
+    double values[VARIABLES];
+    int failures = 0;
+
+    for (int i = 0; i < ROWS; i++) {
+        double interpreted = 0.0, native = 0.0;
+        gatherRow(values, columns, expression->variableCount, i);
+        int interpretedStatus = expressionEvaluate(expression, values, &interpreted);
+        int nativeStatus = jitEvaluate(code, expression, values, &native);
+        if (interpretedStatus != nativeStatus ||
+            (interpretedStatus == STATUS_SUCCESS && memcmp(&interpreted, &native, sizeof(double)) != 0)) {
+            if (failures++ < 3) {
+                printf("%s, row %d: status %d, %.17g interpreted; status %d, %.17g native\n", text, i,
+                    interpretedStatus, interpreted, nativeStatus, native);
+            }
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    long evaluations = (argc > 1) ? atol(argv[1]) : 100000000;
+    _calcEngine engine;
+    _expression expression;
+    _jitCode code;
+    int columns[VARIABLES];
+    double checksum = 0.0, result = 0.0;
+    int failures = 0;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    initEngine(&engine);
+    expressionInit(&expression);
+    jitInit(&code);
+    for (int i = 0; i < ROWS * VARIABLES; i++) {
+        nextRandom(&state);
+        rows[i] = 0.5 + (double)(state >> 11) * 0x1p-53 * 100.0;
+    }
+
+    for (size_t f = 0; f < sizeof(FAILING_FORMULAS) / sizeof(FAILING_FORMULAS[0]); f++) {
+        if (compileFormula(&expression, &code, FAILING_FORMULAS[f], &engine, columns)) {
+            failures += checkFormula(&expression, &code, columns, FAILING_FORMULAS[f]);
+        }
+    }
+
+    printf("%-52s %6s %12s %12s %8s\n", "", "native", "interpreter", "native", "speedup");
+    for (size_t f = 0; f < sizeof(SWEEP_FORMULAS) / sizeof(SWEEP_FORMULAS[0]); f++) {
+        const char* text = SWEEP_FORMULAS[f];
+        if (!compileFormula(&expression, &code, text, &engine, columns)) {
+            failures++;
+            continue;
+        }
+        failures += checkFormula(&expression, &code, columns, text);
+
+        // Gather the rows in the formula's variable order once
+        int variableCount = expression.variableCount;
+        double* inputs = malloc(sizeof(double) * ROWS * (size_t)(variableCount > 0 ? variableCount : 1));
+        if (inputs == NULL) {
+            return 1;
+        }
+        for (int i = 0; i < ROWS; i++) {
+            gatherRow(inputs + i * variableCount, columns, variableCount, i);
+        }
+
+        double start = getSeconds();
+        for (long i = 0; i < evaluations; i++) {
+            expressionEvaluate(&expression, inputs + (i & (ROWS - 1)) * variableCount, &result);
+            checksum += result;
+        }
+        double interpreterSeconds = getSeconds() - start;
+
+        start = getSeconds();
+        for (long i = 0; i < evaluations; i++) {
+            jitEvaluate(&code, &expression, inputs + (i & (ROWS - 1)) * variableCount, &result);
+            checksum += result;
+        }
+        double nativeSeconds = getSeconds() - start;
+
+        printf("%-52s %6s %9.2f ns %9.2f ns %7.2fx\n", text, (code.function != NULL) ? "yes" : "no",
+            interpreterSeconds / (double)evaluations * 1e9, nativeSeconds / (double)evaluations * 1e9,
+            interpreterSeconds / nativeSeconds);
+        free(inputs);
+    }
+
+    printf("%ld evaluations per formula, %d failures (checksum %g)\n", evaluations, failures, checksum);
+    jitFree(&code);
+    expressionFree(&expression);
+    freeEngine(&engine);
+    return failures != 0;
+}
@@ -0,0 +1,96 @@
+/*-----------------------------------------------------------------------------
+    keystrokes.c --  Keystroke throughput benchmark for the calculator
+                     engine.
+
+               Replays fixed key sequences through processKey() and
+               reports how many keys per second the engine handles with no
+               window, message loop or display in the path. The display
+               string is produced after every key that asks for a redraw,
+               as the Win32 front end would do.
+
+               In a build with HEAP_STATISTICS, the engine heap
+               allocations per million keys are printed too, with the
+               share served by the arena of the session.
+
+               Usage: bench_keystrokes [iterations]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "..//headers//engine.h"
+#include "..//headers//memory.h"
+#include "bench.h"
+
+typedef struct {
+    const char* name;
+    _calculatorMode mode;
+    const uint32_t* keys;
+    size_t keyCount;
+} _keySequence;
+
+// 123.45 + 678 * 9 = CE 2 sqrt 1/x - 0.5 = C
+static const uint32_t STANDARD_KEYS[] = {
+    IDC_BUTTON_1, IDC_BUTTON_2, IDC_BUTTON_3, IDC_BUTTON_DOT, IDC_BUTTON_4, IDC_BUTTON_5,
+    IDC_BUTTON_ADD, IDC_BUTTON_6, IDC_BUTTON_7, IDC_BUTTON_8, IDC_BUTTON_MUL, IDC_BUTTON_9,
+    IDC_BUTTON_EQ, IDC_BUTTON_CE, IDC_BUTTON_2, IDC_BUTTON_SQRT, IDC_BUTTON_INV,
+    IDC_BUTTON_SUB, IDC_BUTTON_0, IDC_BUTTON_DOT, IDC_BUTTON_5, IDC_BUTTON_EQ, IDC_BUTTON_CA
+};
+
+// 2 * ( 3 + 4 ) x^y 2 - sin 30 = hex AND F = dec C
+static const uint32_t SCIENTIFIC_KEYS[] = {
+    IDC_BUTTON_2, IDC_BUTTON_MUL, IDC_BUTTON_LPAR, IDC_BUTTON_3, IDC_BUTTON_ADD, IDC_BUTTON_4,
+    IDC_BUTTON_RPAR, IDC_BUTTON_XY, IDC_BUTTON_2, IDC_BUTTON_SUB, IDC_BUTTON_3, IDC_BUTTON_0,
+    IDC_BUTTON_SIN, IDC_BUTTON_EQ, IDC_RADIO_HEX, IDC_BUTTON_AND, IDC_BUTTON_F, IDC_BUTTON_EQ,
+    IDC_RADIO_DEC, IDC_BUTTON_CA
+};
+
+static void runSequence(const _keySequence* sequence, long iterations)
+{
+    _calcEngine engine;
+    char display[MAX_DISPLAY_DIGITS];
+    unsigned long checksum = 0;
+
+    _heapStatistics before, after;
+
+    initEngine(&engine);
+    engine.mode = sequence->mode;
+
+    bool isCounted = getHeapStatistics(&before);
+    double start = getSeconds();
+    for (long i = 0; i < iterations; i++) {
+        for (size_t k = 0; k < sequence->keyCount; k++) {
+            if (processKey(&engine, sequence->keys[k]) == KEY_RESULT_DISPLAY) {
+                getDisplayString(&engine, display, sizeof(display));
+                checksum += (unsigned char)display[0];
+            }
+        }
+    }
+    double elapsed = getSeconds() - start;
+    double keys = (double)iterations * (double)sequence->keyCount;
+    getHeapStatistics(&after);
+
+    printf("%-12s %12.0f keys  %8.3f s  %10.2f Mkeys/s  (checksum %lu)\n",
+        sequence->name, keys, elapsed, keys / elapsed / 1e6, checksum);
+    if (isCounted) {
+        double allocations = (double)(after.allocationCount - before.allocationCount);
+        double arenaAllocations = (double)(after.histogram[HEAP_HISTOGRAM_ARENA] - before.histogram[HEAP_HISTOGRAM_ARENA]);
+        printf("%-12s %12.0f allocations per million keys, %.0f of them from the arena\n",
+            "", allocations / keys * 1e6, arenaAllocations / keys * 1e6);
+    }
+    freeEngine(&engine);
+}
+
+int main(int argc, char** argv)
+{
+    long iterations = (argc > 1) ? atol(argv[1]) : 200000;
+    const _keySequence sequences[] = {
+        { "standard",   STANDARD_MODE,   STANDARD_KEYS,   sizeof(STANDARD_KEYS) / sizeof(STANDARD_KEYS[0]) },
+        { "scientific", SCIENTIFIC_MODE, SCIENTIFIC_KEYS, sizeof(SCIENTIFIC_KEYS) / sizeof(SCIENTIFIC_KEYS[0]) },
+    };
+
+    for (size_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        runSequence(&sequences[i], iterations);
+    }
+    return 0;
+}
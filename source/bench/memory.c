@@ -0,0 +1,331 @@
+/*-----------------------------------------------------------------------------
+    memory.c --  Engine heap benchmark.
+
+               Times three allocation patterns with the engine heap,
+               with the C library malloc and with a first-fit list heap
+               like the one the engine heap replaced (one address-ordered
+               list of free blocks, walked for the first that fits, split
+               on allocation and coalesced on free):
+
+               - lifo:   allocate and free one 64-byte block at a time.
+               - mixed:  keep LIVE_BLOCKS blocks of 16 bytes to 4 KB
+                         (sizes spread evenly over the powers of two) and
+                         replace a random one at each step.
+               - limbs:  grow an array from 4 bytes to 64 KB by doubling,
+                         like the limbs of a big number, then free it.
+
+               Every block is filled and checked before it is freed, and
+               engine heap blocks must be aligned as promised.
+
+               A last line times the temporaries of one evaluation: the
+               heap allocates and frees EVALUATION_BLOCKS blocks of 16
+               bytes to 1 KB, and an arena hands them out and is reset.
+
+               In a build with HEAP_STATISTICS, every block has been
+               given back at the end, and the counts must show it.
+
+               Usage: bench_memory [steps]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//memory.h"
+#include "bench.h"
+
+#define LIVE_BLOCKS 4096
+#define MAX_MIXED_SHIFT 12            // Largest mixed block is 4 KB
+#define MAX_LIMB_BYTES 0x10000
+#define LIST_REGION_SIZE 0x10000000   // 256 MB for the list heap
+#define LIST_HEADER_SIZE 16
+#define EVALUATION_BLOCKS 64
+
+typedef struct {
+    const char* name;
+    void* (*allocate)(size_t size);
+    void* (*reallocate)(void* memory, size_t size);
+    void (*release)(void* memory);
+    bool isAlignmentChecked;
+} _allocator;
+
+// A free block of the list heap; size counts the header
+typedef struct _listBlock {
+    size_t size;
+    struct _listBlock* next;
+} _listBlock;
+
+static char* listRegion;
+static _listBlock* listHead;
+static int failures;
+
+static void* listAllocate(size_t size)
+{
+    size = (size + LIST_HEADER_SIZE + 15) & ~(size_t)15;
+    for (_listBlock** link = &listHead; *link != NULL; link = &(*link)->next) {
+        _listBlock* block = *link;
+        if (block->size < size) {
+            continue;
+        }
+        if (block->size - size >= 2 * LIST_HEADER_SIZE) {
+            _listBlock* rest = (_listBlock*)((char*)block + size);
+            rest->size = block->size - size;
+            rest->next = block->next;
+            *link = rest;
+            block->size = size;
+        }
+        else {
+            *link = block->next;
+        }
+        return (char*)block + LIST_HEADER_SIZE;
+    }
+    return NULL;
+}
+
+static void listRelease(void* memory)
+{
+    if (memory == NULL) {
+        return;
+    }
+    _listBlock* block = (_listBlock*)((char*)memory - LIST_HEADER_SIZE);
+    _listBlock* previous = NULL;
+    _listBlock* next = listHead;
+    while (next != NULL && next < block) {
+        previous = next;
+        next = next->next;
+    }
+
+    block->next = next;
+    if (next != NULL && (char*)block + block->size == (char*)next) {
+        block->size += next->size;
+        block->next = next->next;
+    }
+    if (previous == NULL) {
+        listHead = block;
+    }
+    else if ((char*)previous + previous->size == (char*)block) {
+        previous->size += block->size;
+        previous->next = block->next;
+    }
+    else {
+        previous->next = block;
+    }
+}
+
+static void* listReallocate(void* memory, size_t size)
+{
+    if (memory == NULL) {
+        return listAllocate(size);
+    }
+    size_t oldSize = ((_listBlock*)((char*)memory - LIST_HEADER_SIZE))->size - LIST_HEADER_SIZE;
+    if (size <= oldSize) {
+        return memory;
+    }
+    void* block = listAllocate(size);
+    if (block != NULL) {
+        memcpy(block, memory, oldSize);
+        listRelease(memory);
+    }
+    return block;
+}
+
+static void resetListHeap(void)
+{
+    listHead = (_listBlock*)listRegion;
+    listHead->size = LIST_REGION_SIZE;
+    listHead->next = NULL;
+}
+
+// Marks a block with its size so that checkBlock finds corruption
+static void fillBlock(const _allocator* allocator, unsigned char* block, size_t size)
+{
+    if (block == NULL || (allocator->isAlignmentChecked &&
+        (uintptr_t)block % ((size >= HEAP_MAX_ALIGNMENT) ? HEAP_MAX_ALIGNMENT : HEAP_ALIGNMENT) != 0)) {
+        printf("%s: bad block %p of %zu bytes\n", allocator->name, (void*)block, size);
+        failures++;
+        exit(1);
+    }
+    block[0] = (unsigned char)size;
+    block[size - 1] = (unsigned char)(size >> 4);
+}
+
+static void checkBlock(unsigned char* block, size_t size)
+{
+    if (block[0] != (unsigned char)size || block[size - 1] != (unsigned char)(size >> 4)) {
+        failures++;
+    }
+}
+
+static double runLifo(const _allocator* allocator, long steps)
+{
+    double start = getSeconds();
+    for (long i = 0; i < steps; i++) {
+        unsigned char* block = allocator->allocate(64);
+        fillBlock(allocator, block, 64);
+        checkBlock(block, 64);
+        allocator->release(block);
+    }
+    return getSeconds() - start;
+}
+
+static double runMixed(const _allocator* allocator, long steps)
+{
+    static unsigned char* blocks[LIVE_BLOCKS];
+    static size_t sizes[LIVE_BLOCKS];
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (int i = 0; i < LIVE_BLOCKS; i++) {
+        sizes[i] = 16;
+        blocks[i] = allocator->allocate(sizes[i]);
+        fillBlock(allocator, blocks[i], sizes[i]);
+    }
+
+    double start = getSeconds();
+    for (long i = 0; i < steps; i++) {
+        uint64_t random = nextRandom(&state);
+        size_t slot = (size_t)(random % LIVE_BLOCKS);
+        int shift = 4 + (int)((random >> 32) % (MAX_MIXED_SHIFT - 3));
+        size_t size = ((size_t)1 << shift) - (size_t)((random >> 48) % ((size_t)1 << (shift - 1)));
+
+        checkBlock(blocks[slot], sizes[slot]);
+        allocator->release(blocks[slot]);
+        blocks[slot] = allocator->allocate(size);
+        sizes[slot] = size;
+        fillBlock(allocator, blocks[slot], size);
+    }
+    double seconds = getSeconds() - start;
+
+    for (int i = 0; i < LIVE_BLOCKS; i++) {
+        checkBlock(blocks[i], sizes[i]);
+        allocator->release(blocks[i]);
+    }
+    return seconds;
+}
+
+static double runLimbs(const _allocator* allocator, long steps)
+{
+    double start = getSeconds();
+    for (long i = 0; i < steps; i++) {
+        unsigned char* limbs = NULL;
+        for (size_t size = 4; size <= MAX_LIMB_BYTES; size *= 2) {
+            limbs = allocator->reallocate(limbs, size);
+            fillBlock(allocator, limbs, size);
+        }
+        checkBlock(limbs, MAX_LIMB_BYTES);
+        allocator->release(limbs);
+    }
+    return getSeconds() - start;
+}
+
+// Size of the i-th temporary of an evaluation, 16 bytes to 1 KB
+static size_t getEvaluationSize(long i)
+{
+    return (size_t)16 << (i % 7);
+}
+
+// Allocates and frees the temporaries of one evaluation, then resets arena if there is one
+static double runEvaluation(_memoryArena* arena, long steps)
+{
+    static unsigned char* blocks[EVALUATION_BLOCKS];
+    // Arena blocks only promise HEAP_ALIGNMENT
+    const _allocator heap = { (arena != NULL) ? "arena" : "heap", NULL, NULL, NULL, arena == NULL };
+
+    double start = getSeconds();
+    for (long i = 0; i < steps; i++) {
+        for (long b = 0; b < EVALUATION_BLOCKS; b++) {
+            blocks[b] = allocateMemoryFromHeap(getEvaluationSize(b));
+            fillBlock(&heap, blocks[b], getEvaluationSize(b));
+        }
+        for (long b = EVALUATION_BLOCKS - 1; b >= 0; b--) {
+            checkBlock(blocks[b], getEvaluationSize(b));
+            freeMemoryToHeap(blocks[b]);
+        }
+        if (arena != NULL) {
+            resetMemoryArena(arena);
+        }
+    }
+    return getSeconds() - start;
+}
+
+int main(int argc, char** argv)
+{
+    long steps = (argc > 1) ? atol(argv[1]) : 2000000;
+    _allocator allocators[] = {
+        { "list", listAllocate, listReallocate, listRelease, false },
+        { "malloc", malloc, realloc, free, false },
+        { "heap", allocateMemoryFromHeap, reallocateMemoryFromHeap, freeMemoryToHeap, true },
+    };
+    struct {
+        const char* name;
+        double (*run)(const _allocator* allocator, long steps);
+        long steps;
+    } patterns[] = {
+        { "lifo", runLifo, steps },
+        { "mixed", runMixed, steps },
+        { "limbs", runLimbs, steps / 16 },
+    };
+
+    listRegion = malloc(LIST_REGION_SIZE);
+    if (listRegion == NULL) {
+        printf("cannot allocate the list heap\n");
+        return 1;
+    }
+
+    printf("%-8s", "ns/op");
+    for (size_t a = 0; a < sizeof(allocators) / sizeof(allocators[0]); a++) {
+        printf("%12s", allocators[a].name);
+    }
+    printf("\n");
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+        printf("%-8s", patterns[p].name);
+        for (size_t a = 0; a < sizeof(allocators) / sizeof(allocators[0]); a++) {
+            resetListHeap();
+            patterns[p].run(&allocators[a], patterns[p].steps / 10 + 1);  // Warm up
+            double seconds = patterns[p].run(&allocators[a], patterns[p].steps);
+            printf("%12.1f", seconds / (double)patterns[p].steps * 1e9);
+        }
+        printf("\n");
+    }
+
+    // Requests beyond the cached classes go straight to the system
+    unsigned char* huge = allocateAlignedMemoryFromHeap(HEAP_MAX_LARGE_BLOCK + 1, HEAP_MAX_ALIGNMENT);
+    if (huge == NULL || (uintptr_t)huge % HEAP_MAX_ALIGNMENT != 0 ||
+        getHeapBlockSize(huge) < HEAP_MAX_LARGE_BLOCK + 1) {
+        failures++;
+    }
+    freeMemoryToHeap(huge);
+
+    // An evaluation: the same blocks from the heap, then from a selected arena
+    long evaluations = steps / EVALUATION_BLOCKS + 1;
+    _memoryArena arena;
+    initMemoryArena(&arena, DEFAULT_ARENA_CHUNK_SIZE);
+    double heapSeconds = runEvaluation(NULL, evaluations);
+    _memoryArena* previousArena = selectMemoryArena(&arena);
+    double arenaSeconds = runEvaluation(&arena, evaluations);
+    unsigned char* small = allocateMemoryFromHeap(HEAP_MAX_ARENA_BLOCK);
+    unsigned char* large = allocateMemoryFromHeap(HEAP_MAX_ARENA_BLOCK + 1);
+    if (!isArenaMemory(small) || getHeapBlockSize(small) < HEAP_MAX_ARENA_BLOCK || isArenaMemory(large)) {
+        failures++;
+    }
+    freeMemoryToHeap(large);
+    selectMemoryArena(previousArena);
+    freeMemoryArena(&arena);
+    printf("%-8s%12.1f heap, %.1f arena (ns per evaluation of %d blocks)\n", "eval",
+        heapSeconds / (double)evaluations * 1e9, arenaSeconds / (double)evaluations * 1e9, EVALUATION_BLOCKS);
+
+    _heapStatistics statistics;
+    if (getHeapStatistics(&statistics)) {
+        char text[2048];
+        if (formatHeapStatistics(&statistics, text, sizeof(text)) == 0 ||
+            statistics.allocationCount != statistics.freeCount || statistics.bytesInUse != 0) {
+            failures++;
+        }
+        printf("%s\n", text);
+    }
+
+    printf("%d failures\n", failures);
+    free(listRegion);
+    return failures != 0;
+}
@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------------
+    pages.c --  Huge page benchmark for the engine heap.
+
+               Runs each test with the heap in HEAP_PAGES_NORMAL,
+               HEAP_PAGES_TRANSPARENT and HEAP_PAGES_EXPLICIT mode
+               (explicit falls back to transparent without a huge page
+               pool, see /proc/sys/vm/nr_hugepages):
+
+               - touch:    first write to every page of one block of
+                           blockMB megabytes, which commits it.
+               - random:   dependent random reads over the same block,
+                           where every read misses the TLB with small
+                           pages.
+               - multiply: one product of two random numbers of
+                           multiplyDigits digits, limbs and scratch from
+                           the heap.
+
+               The "huge" column is the AnonHugePages of the process
+               after the touch, where Linux reports it.
+
+               At the end a cached 32 MB block is committed and released
+               with releaseHeapMemory, and the resident set before and
+               after is printed.
+
+               Usage: bench_pages [blockMB] [multiplyDigits]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//bignum.h"
+#include "..//headers//memory.h"
+#include "bench.h"
+
+#define RANDOM_READS 20000000L
+#define RELEASED_BLOCK_SIZE 0x2000000  // 32 MB, kept for reuse after a free
+
+// A value in kB from a "Name:  value kB" line of a /proc file, or -1
+static long readProcValue(const char* path, const char* name)
+{
+    char line[256];
+    long value = -1;
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, name, strlen(name)) == 0) {
+            value = atol(line + strlen(name));
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+static long getResidentKilobytes(void)
+{
+    return readProcValue("/proc/self/status", "VmRSS:");
+}
+
+static void fillRandomLimbs(uint32_t* limbs, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        limbs[i] = (uint32_t)(((uint64_t)rand() * 65536u + (uint64_t)rand()) % BIG_LIMB_BASE);
+    }
+    limbs[length - 1] |= 1;
+}
+
+static int runMode(const char* name, _heapPageMode mode, size_t blockSize, int multiplyDigits)
+{
+    setHeapPageMode(mode);
+
+    // Each slot holds the index of the next one to read, in one random cycle
+    size_t slots = blockSize / sizeof(uint64_t);
+    uint64_t* block = allocateMemoryFromHeap(blockSize);
+    if (block == NULL) {
+        printf("%-12s cannot allocate %zu MB\n", name, blockSize >> 20);
+        return 1;
+    }
+    double start = getSeconds();
+    for (size_t i = 0; i < slots; i++) {
+        block[i] = i;
+    }
+    double touchSeconds = getSeconds() - start;
+    long hugeKilobytes = readProcValue("/proc/self/smaps_rollup", "AnonHugePages:");
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = slots - 1; i > 0; i--) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        size_t j = (size_t)((state >> 33) % i);
+        uint64_t swap = block[i];
+        block[i] = block[j];
+        block[j] = swap;
+    }
+    start = getSeconds();
+    uint64_t index = 0;
+    for (long i = 0; i < RANDOM_READS; i++) {
+        index = block[index];
+    }
+    double randomSeconds = getSeconds() - start;
+    freeMemoryToHeap(block);
+
+    size_t length = ((size_t)multiplyDigits + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS;
+    uint32_t* a = allocateMemoryFromHeap(length * sizeof(uint32_t));
+    uint32_t* b = allocateMemoryFromHeap(length * sizeof(uint32_t));
+    uint32_t* product = allocateMemoryFromHeap(2 * length * sizeof(uint32_t));
+    if (a == NULL || b == NULL || product == NULL) {
+        printf("%-12s cannot allocate the operands\n", name);
+        return 1;
+    }
+    srand(12345);
+    fillRandomLimbs(a, length);
+    fillRandomLimbs(b, length);
+    bigLimbMultiply(product, a, (int)length, b, (int)length);  // Warm up the scratch blocks
+    start = getSeconds();
+    bigLimbMultiply(product, a, (int)length, b, (int)length);
+    double multiplySeconds = getSeconds() - start;
+    uint32_t checksum = product[length] ^ product[2 * length - 1];
+    freeMemoryToHeap(a);
+    freeMemoryToHeap(b);
+    freeMemoryToHeap(product);
+
+    printf("%-12s %10.1f %10.2f %12.1f %10ld   (index %llu, limb %u)\n", name, touchSeconds * 1e3,
+        randomSeconds / RANDOM_READS * 1e9, multiplySeconds * 1e3, (hugeKilobytes < 0) ? -1 : hugeKilobytes >> 10,
+        (unsigned long long)index, checksum);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    long blockMegabytes = (argc > 1) ? atol(argv[1]) : 512;
+    int multiplyDigits = (argc > 2) ? atoi(argv[2]) : BIG_DECIMAL_MAX_PRECISION;
+    int failures = 0;
+
+    // atol gives 0 for text that is no number; a block needs one page at least
+    if (blockMegabytes < 1 || multiplyDigits < 1) {
+        printf("usage: bench_pages [blockMB >= 1] [multiplyDigits >= 1]\n");
+        return 1;
+    }
+    size_t blockSize = (size_t)blockMegabytes << 20;
+
+    printf("%zu MB block, %ld random reads, %d-digit multiply\n", blockSize >> 20, RANDOM_READS, multiplyDigits);
+    printf("%-12s %10s %10s %12s %10s\n", "pages", "touch ms", "random ns", "multiply ms", "huge MB");
+    failures += runMode("normal", HEAP_PAGES_NORMAL, blockSize, multiplyDigits);
+    failures += runMode("transparent", HEAP_PAGES_TRANSPARENT, blockSize, multiplyDigits);
+    failures += runMode("explicit", HEAP_PAGES_EXPLICIT, blockSize, multiplyDigits);
+
+    unsigned char* cached = allocateMemoryFromHeap(RELEASED_BLOCK_SIZE);
+    if (cached == NULL) {
+        return 1;
+    }
+    memset(cached, 1, RELEASED_BLOCK_SIZE);
+    freeMemoryToHeap(cached);
+    long before = getResidentKilobytes();
+    size_t released = releaseHeapMemory();
+    long after = getResidentKilobytes();
+    printf("release      %zu MB advised away, resident %ld MB -> %ld MB\n", released >> 20, before >> 10, after >> 10);
+    if (before >= 0 && after >= before) {
+        failures++;
+    }
+
+    // The block is still cached, and committed again as it is touched
+    cached = allocateMemoryFromHeap(RELEASED_BLOCK_SIZE);
+    if (cached == NULL || cached[RELEASED_BLOCK_SIZE - 1] != 0) {
+        failures++;
+    }
+    freeMemoryToHeap(cached);
+
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,133 @@
+/*-----------------------------------------------------------------------------
+    parse.c --  Decimal parsing benchmark for stringToExtendedFloat80.
+
+               Builds a corpus of calculator-style numbers (typed entries,
+               pasted values with many digits, values with exponents),
+               parses it repeatedly and reports the throughput in MB/s and
+               numbers per second, next to the C library's strtold.
+
+               Before timing, random 80-bit values are formatted with the
+               _bigDecimal formatter (exactly and rounded to 21 significant
+               digits, the minimum that identifies a 64-bit mantissa),
+               parsed back and required to reproduce the same bits.
+
+               Usage: bench_parse [rounds]
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//bignum.h"
+#include "..//headers//operations.h"
+#include "bench.h"
+
+#define CORPUS_NUMBERS 100000
+#define ROUND_TRIP_VALUES 20000
+#define ROUND_TRIP_DIGITS 21
+
+static bool isSameValue(const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    return a->exponent == b->exponent && a->mantissaHigh == b->mantissaHigh && a->mantissaLow == b->mantissaLow;
+}
+
+// Formats random values and checks that parsing gives the same bits back
+static int checkRoundTrip(void)
+{
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    char text[20000];
+    int failures = 0;
+    _bigDecimal decimal;
+
+    bigDecimalInit(&decimal);
+    for (int i = 0; i < ROUND_TRIP_VALUES; i++) {
+        _extendedFloat80 value, parsed;
+        uint64_t mantissa = nextRandom(&state) | 0x8000000000000000ull;
+        uint32_t exponent = (i % 4 == 0) ? (uint32_t)(1 + nextRandom(&state) % 0x7FFD)
+                                         : (uint32_t)(EXTENDED_FLOAT_BIAS - 1000 + nextRandom(&state) % 2000);
+
+        value.exponent = (uint16_t)(exponent | ((i & 1) ? EXTENDED_FLOAT_SIGN : 0));
+        value.mantissaHigh = (uint32_t)(mantissa >> 32);
+        value.mantissaLow = (uint32_t)mantissa;
+
+        for (int rounded = 0; rounded < 2; rounded++) {
+            bigDecimalFromExtendedFloat80(&decimal, &value, rounded ? ROUND_TRIP_DIGITS : BIG_DECIMAL_EXACT);
+            bigDecimalToString(&decimal, text, sizeof(text), ',');
+            if (stringToExtendedFloat80(&parsed, text, ',') != STATUS_SUCCESS || !isSameValue(&value, &parsed)) {
+                if (failures++ < 5) {
+                    printf("round trip failed: %.60s\n", text);
+                }
+            }
+        }
+    }
+    bigDecimalFree(&decimal);
+    return failures;
+}
+
+// Writes the corpus as one buffer of NUL-terminated strings
+static char* buildCorpus(size_t* corpusSize)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    char* corpus = malloc((size_t)CORPUS_NUMBERS * 48);
+    size_t size = 0;
+
+    for (int i = 0; i < CORPUS_NUMBERS; i++) {
+        uint64_t r = nextRandom(&state);
+        int length;
+        switch (i % 4) {
+        case 0:  // Typed integer entry
+            length = sprintf(corpus + size, "%llu", (unsigned long long)(r % 10000000));
+            break;
+        case 1:  // Typed entry with a fraction
+            length = sprintf(corpus + size, "%llu.%llu", (unsigned long long)(r % 100000),
+                (unsigned long long)((r >> 20) % 1000000));
+            break;
+        case 2:  // Pasted value with 17 significant digits
+            length = sprintf(corpus + size, "%.17g", (double)(r >> 11) * 0x1p-53 * 1000.0);
+            break;
+        default: // Scientific notation
+            length = sprintf(corpus + size, "%.12e", (double)(r >> 11) * 0x1p-53 * 1e100);
+            break;
+        }
+        size += (size_t)length + 1;
+    }
+    *corpusSize = size;
+    return corpus;
+}
+
+int main(int argc, char** argv)
+{
+    long rounds = (argc > 1) ? atol(argv[1]) : 50;
+    size_t corpusSize;
+    char* corpus = buildCorpus(&corpusSize);
+    uint32_t checksum = 0;
+    long double hardwareChecksum = 0.0L;
+
+    int failures = checkRoundTrip();
+    printf("round trip: %d values, %d failures\n", 2 * ROUND_TRIP_VALUES, failures);
+
+    double start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (const char* p = corpus; p < corpus + corpusSize; p += strlen(p) + 1) {
+            _extendedFloat80 value;
+            stringToExtendedFloat80(&value, p, '.');
+            checksum += value.mantissaLow;
+        }
+    }
+    double elapsed = getSeconds() - start;
+    printf("stringToExtendedFloat80 %8.1f MB/s %8.2f Mnumbers/s (checksum %u)\n",
+        (double)corpusSize * rounds / elapsed / 1e6, (double)CORPUS_NUMBERS * rounds / elapsed / 1e6, checksum);
+
+    start = getSeconds();
+    for (long r = 0; r < rounds; r++) {
+        for (const char* p = corpus; p < corpus + corpusSize; p += strlen(p) + 1) {
+            hardwareChecksum += strtold(p, NULL);
+        }
+    }
+    elapsed = getSeconds() - start;
+    printf("strtold                 %8.1f MB/s %8.2f Mnumbers/s (checksum %Lg)\n",
+        (double)corpusSize * rounds / elapsed / 1e6, (double)CORPUS_NUMBERS * rounds / elapsed / 1e6, hardwareChecksum);
+
+    free(corpus);
+    return failures != 0;
+}
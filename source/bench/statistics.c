@@ -0,0 +1,355 @@
+/*-----------------------------------------------------------------------------
+    statistics.c --  Statistics box benchmark.
+
+               Adds growing numbers of data points to a _statistics,
+               reads Sum, Ave and s after every point, then removes them
+               one by one from the end (the CD key), and prints the time
+               per point for each size. The time per point stays flat as
+               the data set grows.
+
+               The data have a large mean and a small spread (10^9 plus
+               noise in [0, 1)), where the textbook formula
+               sqrt((sum(x^2) - n*mean^2) / (n - 1)) loses every digit to
+               cancellation. Their sample standard deviation is compared
+               with a two-pass computation in long double, for the
+               running sums and for the textbook formula.
+
+               Then fills the column with recomputePoints points (10^8 by
+               default, 800 MB) and times statisticsSummarize with the
+               SIMD kernel and with the portable one. Both must give the
+               same bits and agree with the running sums and the two-pass
+               reference. The SIMD kernel is then timed on 1 to 32
+               threads, which must all give the same bits as well.
+
+               The median and percentiles are timed the same way, with a
+               median query after every point, on skewed data (the
+               exponential of the noise). Their rank errors against a
+               sorted copy must stay under 1%.
+
+               The exact order statistics are timed on the same data: the
+               radix sort on one thread and on every processor against
+               qsort, an exact quantile and a 100-bin histogram of the
+               sorted points, and CE (removing the last point) followed
+               by an exact median. The sorted points must equal qsort's.
+
+               Usage: bench_statistics [maxPoints [recomputePoints]]
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "..//headers//radixsort.h"
+#include "..//headers//statistics.h"
+#include "bench.h"
+
+#define DATA_OFFSET 1e9
+
+/*
+ * getTwoPassDeviation
+ *
+ * Sample standard deviation of points in long double, with the mean
+ * subtracted before squaring.
+ */
+static double getTwoPassDeviation(const double* points, size_t count)
+{
+    long double sum = 0.0L, squares = 0.0L;
+
+    for (size_t i = 0; i < count; i++) {
+        sum += points[i];
+    }
+    long double mean = sum / (long double)count;
+    for (size_t i = 0; i < count; i++) {
+        long double deviation = (long double)points[i] - mean;
+        squares += deviation * deviation;
+    }
+    return (double)sqrtl(squares / (long double)(count - 1));
+}
+
+/*
+ * timeSummarize
+ *
+ * Best of three statisticsSummarize runs, in seconds.
+ */
+static double timeSummarize(const _statistics* statistics, bool useSimd, _statisticsSummary* summary)
+{
+    double best = HUGE_VAL;
+
+    statisticsUseSimd = useSimd;
+    for (int run = 0; run < 3; run++) {
+        double start = getSeconds();
+        statisticsSummarize(statistics, summary);
+        double seconds = getSeconds() - start;
+        best = (seconds < best) ? seconds : best;
+    }
+    statisticsUseSimd = true;
+    return best;
+}
+
+static int compareDoubles(const void* left, const void* right)
+{
+    double a = *(const double*)left, b = *(const double*)right;
+    return (a > b) - (a < b);
+}
+
+/*
+ * getRankError
+ *
+ * |rank of value among the sorted points - fraction|.
+ */
+static double getRankError(const double* sorted, size_t count, double value, double fraction)
+{
+    size_t low = 0, high = count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (sorted[middle] < value) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return fabs((double)low / (double)count - fraction);
+}
+
+/*
+ * benchQuantiles
+ *
+ * Adds points with a median query after each one, then compares p50,
+ * p90 and p99 with the sorted points.
+ *
+ * @return  The number of rank errors over 1%.
+ */
+static int benchQuantiles(_statistics* statistics, size_t maxPoints, uint64_t* state, double* checksum)
+{
+    static const double FRACTIONS[] = { 0.5, 0.9, 0.99 };
+    int failures = 0;
+
+    printf("\n%10s %12s %10s %10s %10s\n", "points", "add+median", "p50 error", "p90 error", "p99 error");
+    for (size_t count = 1000; count <= maxPoints; count *= 10) {
+        double result = 0.0;
+
+        statisticsClear(statistics);
+        double start = getSeconds();
+        for (size_t i = 0; i < count; i++) {
+            *state ^= *state << 13;
+            *state ^= *state >> 7;
+            *state ^= *state << 17;
+            statisticsAdd(statistics, exp(8.0 * (double)(*state >> 11) * 0x1p-53));
+            statisticsGetQuantile(statistics, 0.5, &result);
+            *checksum += result;
+        }
+        double seconds = (getSeconds() - start) / (double)count;
+
+        double* sorted = malloc(count * sizeof(double));
+        if (sorted == NULL) {
+            break;
+        }
+        memcpy(sorted, statistics->points, count * sizeof(double));
+        qsort(sorted, count, sizeof(double), compareDoubles);
+        printf("%10zu %9.1f ns", count, seconds * 1e9);
+        for (size_t i = 0; i < sizeof(FRACTIONS) / sizeof(FRACTIONS[0]); i++) {
+            statisticsGetQuantile(statistics, FRACTIONS[i], &result);
+            double error = getRankError(sorted, count, result, FRACTIONS[i]);
+            failures += (error > 0.01);
+            printf(" %10.2e", error);
+        }
+        printf("\n");
+        free(sorted);
+    }
+    return failures;
+}
+
+/*
+ * benchOrderStatistics
+ *
+ * Times sorting the points and the queries on the sorted points.
+ *
+ * @return  The number of sizes at which the sort differs from qsort.
+ */
+static int benchOrderStatistics(_statistics* statistics, size_t maxPoints, uint64_t* state, double* checksum)
+{
+    int failures = 0;
+
+    printf("\n%10s %12s %12s %12s %12s %12s %12s\n", "points", "qsort", "radix 1 thr", "radix all", "quantile",
+        "histogram", "CE+median");
+    for (size_t count = 100000; count <= maxPoints; count *= 10) {
+        size_t bins[100];
+        double result = 0.0;
+
+        statisticsClear(statistics);
+        for (size_t i = 0; i < count; i++) {
+            *state ^= *state << 13;
+            *state ^= *state >> 7;
+            *state ^= *state << 17;
+            statisticsAdd(statistics, exp(8.0 * (double)(*state >> 11) * 0x1p-53));
+        }
+        double* sorted = malloc(count * sizeof(double));
+        if (sorted == NULL) {
+            break;
+        }
+        memcpy(sorted, statistics->points, count * sizeof(double));
+        double start = getSeconds();
+        qsort(sorted, count, sizeof(double), compareDoubles);
+        double qsortSeconds = getSeconds() - start;
+
+        double sortSeconds[2];
+        for (int pass = 0; pass < 2; pass++) {
+            statisticsThreads = (pass == 0) ? 1 : 0;
+            statistics->sortedCount = 0;
+            start = getSeconds();
+            statisticsSortPoints(statistics);
+            sortSeconds[pass] = getSeconds() - start;
+        }
+        statisticsThreads = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (radixDoubleFromKey(statistics->sortedKeys[i]) != sorted[i]) {
+                failures++;
+                printf("sorted points differ from qsort at %zu\n", i);
+                break;
+            }
+        }
+
+        start = getSeconds();
+        for (size_t i = 0; i < count; i++) {
+            statisticsGetExactQuantile(statistics, (double)i / (double)count, &result);
+            *checksum += result;
+        }
+        double quantileSeconds = (getSeconds() - start) / (double)count;
+
+        start = getSeconds();
+        statisticsGetHistogram(statistics, sorted[0], sorted[count - 1], 100, bins);
+        double histogramSeconds = getSeconds() - start;
+        *checksum += (double)bins[50];
+
+        size_t removed = (count < 1000) ? count : 1000;
+        start = getSeconds();
+        for (size_t i = 0; i < removed; i++) {
+            statisticsRemove(statistics, statistics->count - 1);
+            statisticsGetExactQuantile(statistics, 0.5, &result);
+            *checksum += result;
+        }
+        double removeSeconds = (getSeconds() - start) / (double)removed;
+
+        printf("%10zu %10.1f ms %10.1f ms %10.1f ms %9.1f ns %9.2f ms %9.1f us\n", count, qsortSeconds * 1e3,
+            sortSeconds[0] * 1e3, sortSeconds[1] * 1e3, quantileSeconds * 1e9, histogramSeconds * 1e3,
+            removeSeconds * 1e6);
+        free(sorted);
+    }
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxPoints = (argc > 1) ? (size_t)atol(argv[1]) : 10000000;
+    size_t recomputePoints = (argc > 2) ? (size_t)atol(argv[2]) : 100000000;
+    _statistics statistics;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    double checksum = 0.0, result = 0.0;
+    int failures = 0;
+
+    statisticsInit(&statistics);
+    printf("%10s %12s %12s %14s %14s\n", "points", "add+query", "remove", "s error", "textbook error");
+    for (size_t count = 1000; count <= maxPoints; count *= 10) {
+        statisticsClear(&statistics);
+
+        double start = getSeconds();
+        for (size_t i = 0; i < count; i++) {
+            nextRandom(&state);
+            if (statisticsAdd(&statistics, DATA_OFFSET + (double)(state >> 11) * 0x1p-53) != STATUS_SUCCESS) {
+                printf("out of memory at %zu points\n", i);
+                return 1;
+            }
+            statisticsGetSum(&statistics, false, &result);
+            checksum += result;
+            statisticsGetMean(&statistics, false, &result);
+            checksum += result;
+            if (statisticsGetDeviation(&statistics, false, &result) == STATUS_SUCCESS) {
+                checksum += result;
+            }
+        }
+        double addSeconds = (getSeconds() - start) / (double)count;
+
+        // Accuracy of s against the two-pass reference, and of the textbook formula
+        double reference = getTwoPassDeviation(statistics.points, count);
+        double sum = 0.0, sumOfSquares = 0.0;
+        statisticsGetDeviation(&statistics, false, &result);
+        statisticsGetSum(&statistics, false, &sum);
+        statisticsGetSum(&statistics, true, &sumOfSquares);
+        double textbook = sqrt(fmax(0.0, (sumOfSquares - sum * sum / (double)count) / (double)(count - 1)));
+        double error = fabs(result - reference) / reference;
+        double textbookError = fabs(textbook - reference) / reference;
+        if (error > 1e-6) {
+            failures++;
+        }
+
+        start = getSeconds();
+        while (statistics.count > 0) {
+            statisticsRemove(&statistics, statistics.count - 1);
+            statisticsGetSum(&statistics, false, &result);
+            checksum += result;
+        }
+        double removeSeconds = (getSeconds() - start) / (double)count;
+
+        printf("%10zu %9.1f ns %9.1f ns %14.2e %14.2e\n", count, addSeconds * 1e9, removeSeconds * 1e9, error,
+            textbookError);
+    }
+
+    failures += benchQuantiles(&statistics, maxPoints, &state, &checksum);
+    failures += benchOrderStatistics(&statistics, maxPoints, &state, &checksum);
+
+    // Full recomputation from the column
+    statisticsClear(&statistics);
+    if (recomputePoints > 1 && statisticsReserve(&statistics, recomputePoints) == STATUS_SUCCESS) {
+        _statisticsSummary simd, portable;
+
+        for (size_t i = 0; i < recomputePoints; i++) {
+            nextRandom(&state);
+            statisticsAdd(&statistics, DATA_OFFSET + (double)(state >> 11) * 0x1p-53);
+        }
+        double simdSeconds = timeSummarize(&statistics, true, &simd);
+        double portableSeconds = timeSummarize(&statistics, false, &portable);
+
+        double reference = getTwoPassDeviation(statistics.points, recomputePoints);
+        double deviation = sqrt(simd.squaredDeviations / (double)(recomputePoints - 1));
+        double error = fabs(deviation - reference) / reference;
+        double sum = 0.0;
+        statisticsGetSum(&statistics, false, &sum);
+        double sumError = fabs(simd.sum - sum) / fabs(sum);
+        bool isIdentical = (memcmp(&simd, &portable, sizeof(simd)) == 0);
+        if (error > 1e-6 || sumError > 1e-12 || !isIdentical) {
+            failures++;
+        }
+
+        printf("\nsummarize %zu points: simd %.3f s (%.2f ns/point), portable %.3f s (%.2f ns/point)\n",
+            recomputePoints, simdSeconds, simdSeconds * 1e9 / (double)recomputePoints, portableSeconds,
+            portableSeconds * 1e9 / (double)recomputePoints);
+        printf("s error %.2e, sum error %.2e, kernels %s\n", error, sumError,
+            isIdentical ? "identical" : "DIFFER");
+        checksum += simd.minimum + simd.maximum;
+
+        printf("%8s %10s %10s\n", "threads", "seconds", "speedup");
+        double oneThread = 0.0;
+        for (unsigned threads = 1; threads <= 32; threads *= 2) {
+            _statisticsSummary threaded;
+            statisticsThreads = threads;
+            double seconds = timeSummarize(&statistics, true, &threaded);
+            oneThread = (threads == 1) ? seconds : oneThread;
+            bool isSame = (memcmp(&threaded, &simd, sizeof(simd)) == 0);
+            if (!isSame) {
+                failures++;
+            }
+            printf("%8u %10.3f %9.2fx%s\n", threads, seconds, oneThread / seconds, isSame ? "" : "  DIFFERENT BITS");
+        }
+        statisticsThreads = 0;
+    }
+    else if (recomputePoints > 1) {
+        printf("\nno memory for %zu points\n", recomputePoints);
+    }
+
+    printf("%d failures (checksum %g)\n", failures, checksum);
+    statisticsFree(&statistics);
+    return failures != 0;
+}
@@ -0,0 +1,835 @@
+/*-----------------------------------------------------------------------------
+    bigbase.c --  Conversion of _bigDecimal integers to and from text in
+                  the number bases (reconstructed code).
+
+               A _bigDecimal keeps base 10^9 limbs, while a digit of base
+               2, 8 or 16 is a slice of 1, 3 or 4 bits of the binary
+               number, so text in those bases goes through an array of
+               64-bit binary words. Both conversions divide and conquer:
+               the lower and upper parts of the number are converted on
+               their own and joined with one product,
+
+                   number = upper * B^half + lower
+
+               where B^half is the power of the source base at the cut.
+               The cut falls at the largest power of two limbs or words
+               below the length, so the same few powers serve every
+               number: (10^9)^(2^j) in binary words and (2^64)^(2^j) in
+               decimal words, each the square of the one before, kept
+               until bigBaseFreeCache. n digits then convert in about the
+               time of a few n-digit multiplications instead of the n^2
+               steps of converting digit by digit. Parts of up to
+               bigBaseSplitThreshold limbs or words are converted digit
+               by digit, which is faster at that size.
+
+               The products are Karatsuba multiplications on 64-bit
+               words, in base 2^64 towards binary and in base 10^18
+               (two limbs in a word) towards decimal, which takes a
+               fraction of the time of bigLimbMultiply on 32-bit limbs.
+
+               Base 10 text is the limbs themselves and takes no
+               conversion.
+
+               Key functions include:
+
+               - bigBaseToString: The integer part of a _bigDecimal as
+                                  text in a base.
+               - bigBaseFromString: Text in a base as an exact _bigDecimal.
+               - bigBaseTextSize: A buffer size that fits the text.
+               - bigBaseFreeCache: Returns the cached powers to the heap.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+#include ".//headers//bigbase.h"
+#include ".//headers//memory.h"
+#include ".//headers//wideint.h"
+
+#define DECIMAL_WORD_BASE 1000000000000000000ull  // 10^18: two limbs in a decimal word
+#define KARATSUBA_WORDS 32             // Word products with a shorter operand are schoolbook
+#define SMALL_SCRATCH_LIMBS 256        // Limbs of a schoolbook conversion kept on the stack
+#define MAX_LIMBS (INT_MAX / 64)       // Longest integer part; keeps the sizes below in int
+#define MAX_POWERS 32                  // Cached powers: (10^9)^(2^j) and (2^64)^(2^j), j < MAX_POWERS
+
+// 10^9 < 2^30, so n limbs fit in 30n bits; 2^64 < 10^19.27, so n binary
+// words fit in 2.1407n limbs and 1.0704n decimal words
+#define WORDS_FOR_LIMBS(limbs) ((int)(((int64_t)(limbs) * 30 + 63) / 64))
+#define LIMBS_FOR_WORDS(words) ((int)((int64_t)(words) * 2141 / 1000 + 1))
+#define DECIMAL_WORDS_FOR_WORDS(words) ((int)((int64_t)(words) * 1071 / 1000 + 1))
+
+int bigBaseSplitThreshold = 32;
+
+static const char DIGITS[] = "0123456789ABCDEF";
+
+static uint64_t* limbPowers[MAX_POWERS];  // (10^9)^(2^j) in binary words
+static int limbPowerLengths[MAX_POWERS];
+static uint64_t* wordPowers[MAX_POWERS];  // (2^64)^(2^j) in decimal words
+static int wordPowerLengths[MAX_POWERS];
+
+// Bits of a digit of base, or 0 when base is no power of two
+static int getDigitBits(int base)
+{
+    switch (base) {
+    case 2:  return 1;
+    case 8:  return 3;
+    case 16: return 4;
+    default: return 0;
+    }
+}
+
+// Value of a digit character, or 16 for anything else
+static int getDigitValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return 16;
+}
+
+// The largest level with 2^level < length, where the number is cut
+static int getSplitLevel(int length)
+{
+    int level = 0;
+
+    while ((2 << level) < length) {
+        level++;
+    }
+    return level;
+}
+
+static int trimLimbs(const uint32_t* a, int length)
+{
+    while (length > 0 && a[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+/*
+ * Word-array helpers. All arrays are little-endian magnitudes, in base
+ * 2^64 or, with isDecimal, in base 10^18.
+ */
+
+static int trimWords(const uint64_t* a, int length)
+{
+    while (length > 0 && a[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+// result = a + b with aLength >= bLength; returns the carry. result may alias a.
+static uint64_t addWords(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b, int bLength,
+    bool isDecimal)
+{
+    uint64_t carry = 0;
+
+    for (int i = 0; i < aLength; i++) {
+        uint64_t addend = (i < bLength) ? b[i] : 0;
+        uint64_t sum = a[i] + carry;
+        if (isDecimal) {
+            sum += addend;
+            carry = (sum >= DECIMAL_WORD_BASE);
+            result[i] = carry ? sum - DECIMAL_WORD_BASE : sum;
+        }
+        else {
+            carry = (sum < carry);
+            sum += addend;
+            carry += (sum < addend);
+            result[i] = sum;
+        }
+    }
+    return carry;
+}
+
+// Adds x into result at word offset; the sum must fit in resultLength words.
+static void addWordsAt(uint64_t* result, int resultLength, int offset, const uint64_t* x, int xLength,
+    bool isDecimal)
+{
+    uint64_t carry = addWords(result + offset, result + offset, xLength, x, xLength, isDecimal);
+
+    for (int i = offset + xLength; carry != 0 && i < resultLength; i++) {
+        result[i]++;
+        carry = isDecimal ? (result[i] == DECIMAL_WORD_BASE) : (result[i] == 0);
+        if (isDecimal && carry) {
+            result[i] = 0;
+        }
+    }
+}
+
+// Subtracts x from result at word offset; the difference must be >= 0.
+static void subWordsAt(uint64_t* result, int resultLength, int offset, const uint64_t* x, int xLength,
+    bool isDecimal)
+{
+    uint64_t borrow = 0;
+    int i = 0;
+
+    for (; i < xLength; i++) {
+        uint64_t word = result[offset + i];
+        uint64_t difference = word - x[i];
+        uint64_t nextBorrow = (word < x[i]) | (difference < borrow);
+        difference -= borrow;
+        result[offset + i] = (isDecimal && nextBorrow) ? difference + DECIMAL_WORD_BASE : difference;
+        borrow = nextBorrow;
+    }
+    for (i += offset; borrow != 0 && i < resultLength; i++) {
+        borrow = (result[i] == 0);
+        result[i] = (isDecimal && borrow) ? DECIMAL_WORD_BASE - 1 : result[i] - 1;
+    }
+}
+
+static void multiplyBinarySchoolbook(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b,
+    int bLength)
+{
+    memset(result, 0, (size_t)(aLength + bLength) * sizeof(uint64_t));
+
+    for (int i = 0; i < aLength; i++) {
+        uint64_t carry = 0;
+        if (a[i] == 0) {
+            continue;
+        }
+        for (int j = 0; j < bLength; j++) {
+            uint64_t high;
+            uint64_t low = multiply64(a[i], b[j], &high);
+            low += carry;
+            high += (low < carry);
+            low += result[i + j];
+            high += (low < result[i + j]);
+            result[i + j] = low;
+            carry = high;
+        }
+        result[i + bLength] = carry;
+    }
+}
+
+// Column by column: each column of products is summed in three words and
+// split at 10^18 once, so there is one division per result word
+static void multiplyDecimalSchoolbook(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b,
+    int bLength)
+{
+    uint64_t carryLow = 0;
+    uint64_t carryHigh = 0;
+
+    for (int k = 0; k < aLength + bLength - 1; k++) {
+        uint64_t sum0 = carryLow, sum1 = carryHigh, sum2 = 0, rest;
+        int first = (k < bLength) ? 0 : k - bLength + 1;
+        int last = (k < aLength) ? k : aLength - 1;
+        for (int i = first; i <= last; i++) {
+            uint64_t high;
+            uint64_t low = multiply64(a[i], b[k - i], &high);
+            sum0 += low;
+            high += (sum0 < low);
+            sum1 += high;
+            sum2 += (sum1 < high);
+        }
+        // sum2 is at most the number of products, far below 10^18
+        carryHigh = divide128(sum2, sum1, DECIMAL_WORD_BASE, &rest);
+        carryLow = divide128(rest, sum0, DECIMAL_WORD_BASE, &result[k]);
+    }
+    result[aLength + bLength - 1] = carryLow;
+}
+
+static int multiplyWords(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b, int bLength,
+    bool isDecimal);
+
+/*
+ * multiplyWordsKaratsuba
+ *
+ * The Karatsuba of bignum.c on words: a = a1*B^m + a0, b = b1*B^m + b0
+ * with m = ceil(aLength/2) and bLength >= m, and the middle coefficient
+ * (a0+a1)(b0+b1) - a0*b0 - a1*b1.
+ */
+static int multiplyWordsKaratsuba(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b, int bLength,
+    bool isDecimal)
+{
+    int m = (aLength + 1) / 2;
+    int a1Length = aLength - m;
+    int b1Length = bLength - m;
+    int resultLength = aLength + bLength;
+    int a0Length = trimWords(a, m);
+    int b0Length = trimWords(b, m);
+    int status = STATUS_SUCCESS;
+
+    uint64_t* scratch = allocateMemoryFromHeap((size_t)(4 * (m + 1)) * sizeof(uint64_t));
+    if (scratch == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint64_t* sumA = scratch;
+    uint64_t* sumB = scratch + (m + 1);
+    uint64_t* middle = scratch + 2 * (m + 1);
+
+    memset(result, 0, (size_t)resultLength * sizeof(uint64_t));
+
+    // z0 = a0*b0 and z2 = a1*b1 go straight to their final places
+    if (a0Length > 0 && b0Length > 0) {
+        status = multiplyWords(result, a, a0Length, b, b0Length, isDecimal);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = multiplyWords(result + 2 * m, a + m, a1Length, b + m, b1Length, isDecimal);
+    }
+
+    memcpy(sumA, a, (size_t)m * sizeof(uint64_t));
+    sumA[m] = addWords(sumA, sumA, m, a + m, a1Length, isDecimal);
+    memcpy(sumB, b, (size_t)m * sizeof(uint64_t));
+    sumB[m] = addWords(sumB, sumB, m, b + m, b1Length, isDecimal);
+
+    int sumALength = trimWords(sumA, m + 1);
+    int sumBLength = trimWords(sumB, m + 1);
+    int middleLength = sumALength + sumBLength;
+    if (status == STATUS_SUCCESS) {
+        status = multiplyWords(middle, sumA, sumALength, sumB, sumBLength, isDecimal);
+    }
+
+    if (status == STATUS_SUCCESS) {
+        // middle -= z0 + z2; both are still in result
+        int z0Length = trimWords(result, 2 * m);
+        int z2Length = trimWords(result + 2 * m, a1Length + b1Length);
+        subWordsAt(middle, middleLength, 0, result, z0Length, isDecimal);
+        subWordsAt(middle, middleLength, 0, result + 2 * m, z2Length, isDecimal);
+        addWordsAt(result, resultLength, m, middle, trimWords(middle, middleLength), isDecimal);
+    }
+    freeMemoryToHeap(scratch);
+    return status;
+}
+
+/*
+ * multiplyWords
+ *
+ * result[0..aLength+bLength) = a * b, like multiplyLimbs in bignum.c:
+ * schoolbook below KARATSUBA_WORDS, very unbalanced products cut into
+ * balanced pieces. result must not overlap the operands.
+ */
+static int multiplyWords(uint64_t* result, const uint64_t* a, int aLength, const uint64_t* b, int bLength,
+    bool isDecimal)
+{
+    if (aLength < bLength) {
+        const uint64_t* swapWords = a; a = b; b = swapWords;
+        int swapLength = aLength; aLength = bLength; bLength = swapLength;
+    }
+    if (bLength == 0) {
+        memset(result, 0, (size_t)aLength * sizeof(uint64_t));
+        return STATUS_SUCCESS;
+    }
+    if (bLength < KARATSUBA_WORDS) {
+        if (isDecimal) {
+            multiplyDecimalSchoolbook(result, a, aLength, b, bLength);
+        }
+        else {
+            multiplyBinarySchoolbook(result, a, aLength, b, bLength);
+        }
+        return STATUS_SUCCESS;
+    }
+    if (2 * bLength > aLength) {
+        return multiplyWordsKaratsuba(result, a, aLength, b, bLength, isDecimal);
+    }
+
+    // Unbalanced: multiply b by bLength-sized slices of a
+    int status = STATUS_SUCCESS;
+    uint64_t* piece = allocateMemoryFromHeap((size_t)(2 * bLength) * sizeof(uint64_t));
+    if (piece == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    memset(result, 0, (size_t)(aLength + bLength) * sizeof(uint64_t));
+    for (int offset = 0; offset < aLength && status == STATUS_SUCCESS; offset += bLength) {
+        int sliceLength = (aLength - offset < bLength) ? aLength - offset : bLength;
+        int trimmed = trimWords(a + offset, sliceLength);
+        if (trimmed == 0) {
+            continue;
+        }
+        status = multiplyWords(piece, a + offset, trimmed, b, bLength, isDecimal);
+        addWordsAt(result, aLength + bLength, offset, piece, trimWords(piece, trimmed + bLength), isDecimal);
+    }
+    freeMemoryToHeap(piece);
+    return status;
+}
+
+/*
+ * fillPowers
+ *
+ * The cached power powers[level], squaring up from the largest power in
+ * the cache; first is powers[0]. NULL if the heap runs out.
+ */
+static const uint64_t* fillPowers(uint64_t** powers, int* lengths, const uint64_t* first, int firstLength,
+    int level, bool isDecimal, int* length)
+{
+    if (powers[0] == NULL) {
+        powers[0] = allocateMemoryFromHeap((size_t)firstLength * sizeof(uint64_t));
+        if (powers[0] == NULL) {
+            return NULL;
+        }
+        memcpy(powers[0], first, (size_t)firstLength * sizeof(uint64_t));
+        lengths[0] = firstLength;
+    }
+    for (int j = 1; j <= level; j++) {
+        if (powers[j] == NULL) {
+            int squareLength = 2 * lengths[j - 1];
+            uint64_t* square = allocateMemoryFromHeap((size_t)squareLength * sizeof(uint64_t));
+            if (square == NULL ||
+                multiplyWords(square, powers[j - 1], lengths[j - 1], powers[j - 1], lengths[j - 1], isDecimal) !=
+                    STATUS_SUCCESS) {
+                freeMemoryToHeap(square);
+                return NULL;
+            }
+            powers[j] = square;
+            lengths[j] = trimWords(square, squareLength);
+        }
+    }
+    *length = lengths[level];
+    return powers[level];
+}
+
+/*
+ * getPower
+ *
+ * fillPowers with the arena of the thread deselected: the cache outlives
+ * the resets of the arena the engine converts in (see memory.h).
+ */
+static const uint64_t* getPower(uint64_t** powers, int* lengths, const uint64_t* first, int firstLength,
+    int level, bool isDecimal, int* length)
+{
+    _memoryArena* previousArena = selectMemoryArena(NULL);
+    const uint64_t* power = fillPowers(powers, lengths, first, firstLength, level, isDecimal, length);
+    selectMemoryArena(previousArena);
+    return power;
+}
+
+/*
+ * bigBaseFreeCache
+ *
+ * Returns the cached powers to the heap. The next conversion of a long
+ * number computes them again.
+ */
+void bigBaseFreeCache(void)
+{
+    for (int j = 0; j < MAX_POWERS; j++) {
+        freeMemoryToHeap(limbPowers[j]);
+        freeMemoryToHeap(wordPowers[j]);
+        limbPowers[j] = NULL;
+        wordPowers[j] = NULL;
+        limbPowerLengths[j] = 0;
+        wordPowerLengths[j] = 0;
+    }
+}
+
+/*
+ * Conversions between limbs and binary words.
+ */
+
+// words = limbs, two limbs (one multiply by 10^18) at a time from the top
+static void limbsToWordsSchoolbook(uint64_t* words, const uint32_t* limbs, int length)
+{
+    int used = 0;
+    int i = length - 1;
+
+    if (length % 2 != 0) {
+        words[0] = limbs[i--];
+        used = (words[0] != 0);
+    }
+    for (; i >= 1; i -= 2) {
+        uint64_t carry = (uint64_t)limbs[i] * BIG_LIMB_BASE + limbs[i - 1];
+        for (int w = 0; w < used; w++) {
+            uint64_t high;
+            uint64_t low = multiply64(words[w], DECIMAL_WORD_BASE, &high);
+            low += carry;
+            high += (low < carry);
+            words[w] = low;
+            carry = high;
+        }
+        if (carry != 0) {
+            words[used++] = carry;
+        }
+    }
+}
+
+// limbs = words, 32 bits (one multiply by 2^32) at a time from the top
+static void wordsToLimbsSchoolbook(uint32_t* limbs, const uint64_t* words, int length)
+{
+    int used = 0;
+
+    for (int i = length - 1; i >= 0; i--) {
+        for (int half = 1; half >= 0; half--) {
+            uint64_t carry = (uint32_t)(words[i] >> (32 * half));
+            for (int l = 0; l < used; l++) {
+                uint64_t t = ((uint64_t)limbs[l] << 32) + carry;
+                carry = t / BIG_LIMB_BASE;
+                limbs[l] = (uint32_t)(t - carry * BIG_LIMB_BASE);
+            }
+            while (carry != 0) {
+                limbs[used++] = (uint32_t)(carry % BIG_LIMB_BASE);
+                carry /= BIG_LIMB_BASE;
+            }
+        }
+    }
+}
+
+/*
+ * limbsToWords
+ *
+ * words[0..wordCount) = limbs[0..length), with wordCount at least
+ * WORDS_FOR_LIMBS(length): the lower 2^level limbs and the upper ones
+ * converted on their own, the upper ones multiplied by (10^9)^(2^level).
+ */
+static int limbsToWords(uint64_t* words, int wordCount, const uint32_t* limbs, int length)
+{
+    static const uint64_t LIMB_BASE[] = { BIG_LIMB_BASE };
+
+    memset(words, 0, (size_t)wordCount * sizeof(uint64_t));
+    length = trimLimbs(limbs, length);
+    if (length <= bigBaseSplitThreshold || length < 2) {
+        limbsToWordsSchoolbook(words, limbs, length);
+        return STATUS_SUCCESS;
+    }
+
+    int level = getSplitLevel(length);
+    int half = 1 << level;
+    int powerLength = 0;
+    const uint64_t* power = getPower(limbPowers, limbPowerLengths, LIMB_BASE, 1, level, false, &powerLength);
+    int highCount = WORDS_FOR_LIMBS(length - half);
+    uint64_t* scratch = (power != NULL) ? allocateMemoryFromHeap((size_t)(2 * highCount + powerLength) * sizeof(uint64_t))
+                                        : NULL;
+    if (scratch == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint64_t* high = scratch;
+    uint64_t* product = scratch + highCount;
+
+    int status = limbsToWords(words, WORDS_FOR_LIMBS(half), limbs, half);
+    if (status == STATUS_SUCCESS) {
+        status = limbsToWords(high, highCount, limbs + half, length - half);
+    }
+    if (status == STATUS_SUCCESS) {
+        int highLength = trimWords(high, highCount);
+        status = multiplyWords(product, high, highLength, power, powerLength, false);
+        addWordsAt(words, wordCount, 0, product, trimWords(product, highLength + powerLength), false);
+    }
+    freeMemoryToHeap(scratch);
+    return status;
+}
+
+/*
+ * wordsToDecimal
+ *
+ * decimal[0..decimalCount) = words[0..length) in decimal words, with
+ * decimalCount at least DECIMAL_WORDS_FOR_WORDS(length); limbsToWords
+ * the other way round, with powers of 2^64.
+ */
+static int wordsToDecimal(uint64_t* decimal, int decimalCount, const uint64_t* words, int length)
+{
+    static const uint64_t WORD_BASE[] = { 446744073709551616ull, 18u };  // 2^64
+
+    memset(decimal, 0, (size_t)decimalCount * sizeof(uint64_t));
+    length = trimWords(words, length);
+    if (length <= bigBaseSplitThreshold || length < 2) {
+        // Limb by limb, then two limbs to a word
+        uint32_t smallLimbs[SMALL_SCRATCH_LIMBS];
+        int limbCount = LIMBS_FOR_WORDS(length);
+        uint32_t* limbs = (limbCount <= SMALL_SCRATCH_LIMBS) ? smallLimbs
+                                                             : allocateMemoryFromHeap((size_t)limbCount * sizeof(uint32_t));
+        if (limbs == NULL) {
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        memset(limbs, 0, (size_t)limbCount * sizeof(uint32_t));
+        wordsToLimbsSchoolbook(limbs, words, length);
+        for (int i = 0; i < limbCount; i++) {
+            decimal[i / 2] += (i % 2 != 0) ? (uint64_t)limbs[i] * BIG_LIMB_BASE : limbs[i];
+        }
+        if (limbs != smallLimbs) {
+            freeMemoryToHeap(limbs);
+        }
+        return STATUS_SUCCESS;
+    }
+
+    int level = getSplitLevel(length);
+    int half = 1 << level;
+    int powerLength = 0;
+    const uint64_t* power = getPower(wordPowers, wordPowerLengths, WORD_BASE, 2, level, true, &powerLength);
+    int highCount = DECIMAL_WORDS_FOR_WORDS(length - half);
+    uint64_t* scratch = (power != NULL) ? allocateMemoryFromHeap((size_t)(2 * highCount + powerLength) * sizeof(uint64_t))
+                                        : NULL;
+    if (scratch == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint64_t* high = scratch;
+    uint64_t* product = scratch + highCount;
+
+    int status = wordsToDecimal(decimal, DECIMAL_WORDS_FOR_WORDS(half), words, half);
+    if (status == STATUS_SUCCESS) {
+        status = wordsToDecimal(high, highCount, words + half, length - half);
+    }
+    if (status == STATUS_SUCCESS) {
+        int highLength = trimWords(high, highCount);
+        status = multiplyWords(product, high, highLength, power, powerLength, true);
+        addWordsAt(decimal, decimalCount, 0, product, trimWords(product, highLength + powerLength), true);
+    }
+    freeMemoryToHeap(scratch);
+    return status;
+}
+
+/*
+ * wordsToLimbs
+ *
+ * limbs[0..limbCount) = words[0..length), with limbCount at least
+ * 2 * DECIMAL_WORDS_FOR_WORDS(length), through decimal words.
+ */
+static int wordsToLimbs(uint32_t* limbs, int limbCount, const uint64_t* words, int length)
+{
+    int decimalCount = DECIMAL_WORDS_FOR_WORDS(length);
+    uint64_t* decimal = allocateMemoryFromHeap((size_t)decimalCount * sizeof(uint64_t));
+
+    if (decimal == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    int status = wordsToDecimal(decimal, decimalCount, words, length);
+    memset(limbs, 0, (size_t)limbCount * sizeof(uint32_t));
+    for (int i = 0; i < decimalCount && status == STATUS_SUCCESS; i++) {
+        limbs[2 * i] = (uint32_t)(decimal[i] % BIG_LIMB_BASE);
+        limbs[2 * i + 1] = (uint32_t)(decimal[i] / BIG_LIMB_BASE);
+    }
+    freeMemoryToHeap(decimal);
+    return status;
+}
+
+/*
+ * getIntegerLimbs
+ *
+ * The limbs of the integer part of value and their number. A value with
+ * zero limbs below its limbs (a positive exponent) gets them in a copy,
+ * returned in *copy for the caller to free. NULL if the integer part has
+ * more than MAX_LIMBS limbs or the copy cannot be made.
+ */
+static const uint32_t* getIntegerLimbs(const _bigDecimal* value, int* length, uint32_t** copy)
+{
+    const uint32_t* limbs = BIG_DECIMAL_LIMBS(value);
+    int64_t integerLength = value->length + value->exponent;
+
+    *copy = NULL;
+    *length = 0;
+    if (integerLength > MAX_LIMBS) {
+        return NULL;
+    }
+    if (integerLength <= 0) {
+        return limbs;
+    }
+    if (value->exponent < 0) {
+        *length = (int)integerLength;
+        return limbs - value->exponent;
+    }
+    if (value->exponent > 0) {
+        *copy = allocateMemoryFromHeap((size_t)integerLength * sizeof(uint32_t));
+        if (*copy == NULL) {
+            return NULL;
+        }
+        memset(*copy, 0, (size_t)value->exponent * sizeof(uint32_t));
+        memcpy(*copy + value->exponent, limbs, (size_t)value->length * sizeof(uint32_t));
+        limbs = *copy;
+    }
+    *length = trimLimbs(limbs, (int)integerLength);
+    return limbs;
+}
+
+/*
+ * bigBaseTextSize
+ *
+ * A buffer size in bytes that holds the text of bigBaseToString for
+ * value in base, the sign and the NUL included; 0 for an unsupported
+ * base. The number itself is not converted, so the size may be some
+ * characters more than the text needs.
+ */
+size_t bigBaseTextSize(const _bigDecimal* value, int base)
+{
+    int64_t integerLength = (value->length > 0) ? value->length + value->exponent : 0;
+    int digitBits = getDigitBits(base);
+
+    if (integerLength < 0) {
+        integerLength = 0;
+    }
+    if (base == 10) {
+        return (size_t)integerLength * BIG_LIMB_DIGITS + 3;
+    }
+    if (digitBits == 0) {
+        return 0;
+    }
+    return (size_t)integerLength * 30 / (size_t)digitBits + 3;
+}
+
+/*
+ * bigBaseToString
+ *
+ * Writes the integer part of value (truncated towards zero) in base 2,
+ * 8, 10 or 16, with a '-' if it is negative and no leading zeros.
+ * Works like snprintf: returns the length the full text needs, writes
+ * at most bufferSize-1 characters and always terminates the buffer.
+ * An unsupported base, or a number the heap cannot convert, gives an
+ * empty text and 0.
+ */
+size_t bigBaseToString(const _bigDecimal* value, char* buffer, size_t bufferSize, int base)
+{
+    int digitBits = getDigitBits(base);
+    uint32_t* copy;
+    uint64_t* words = NULL;
+    int length;
+    size_t textLength = 0;
+
+#define PUT_CHAR(c) do { if (textLength + 1 < bufferSize) buffer[textLength] = (c); textLength++; } while (0)
+
+    const uint32_t* limbs = getIntegerLimbs(value, &length, &copy);
+    if ((digitBits == 0 && base != 10) || limbs == NULL) {
+        freeMemoryToHeap(copy);
+        if (bufferSize > 0) buffer[0] = '\0';
+        return 0;
+    }
+
+    if (length > 0 && value->sign < 0) {
+        PUT_CHAR('-');
+    }
+    if (length == 0) {
+        PUT_CHAR('0');
+    }
+    else if (base == 10) {
+        char top[BIG_LIMB_DIGITS + 1];
+        int topLength = 0;
+        for (uint32_t limb = limbs[length - 1]; limb != 0; limb /= 10) {
+            top[topLength++] = (char)('0' + limb % 10);
+        }
+        while (topLength > 0) {
+            PUT_CHAR(top[--topLength]);
+        }
+        for (int i = length - 2; i >= 0; i--) {
+            uint32_t divisor = BIG_LIMB_BASE / 10;
+            for (uint32_t limb = limbs[i]; divisor != 0; divisor /= 10) {
+                PUT_CHAR((char)('0' + limb / divisor));
+                limb %= divisor;
+            }
+        }
+    }
+    else {
+        int wordCount = WORDS_FOR_LIMBS(length);
+        words = allocateMemoryFromHeap((size_t)wordCount * sizeof(uint64_t));
+        if (words == NULL || limbsToWords(words, wordCount, limbs, length) != STATUS_SUCCESS) {
+            freeMemoryToHeap(words);
+            freeMemoryToHeap(copy);
+            if (bufferSize > 0) buffer[0] = '\0';
+            return 0;
+        }
+
+        // Each digit is the slice of digitBits bits at its position
+        wordCount = trimWords(words, wordCount);
+        int64_t bitCount = 64 * (int64_t)wordCount - countLeadingZeros64(words[wordCount - 1]);
+        for (int64_t digit = (bitCount + digitBits - 1) / digitBits - 1; digit >= 0; digit--) {
+            int64_t bit = digit * digitBits;
+            int64_t word = bit / 64;
+            uint64_t bits = words[word] >> (bit % 64);
+            if (bit % 64 + digitBits > 64 && word + 1 < wordCount) {
+                bits |= words[word + 1] << (64 - bit % 64);
+            }
+            PUT_CHAR(DIGITS[bits & ((UINT64_C(1) << digitBits) - 1)]);
+        }
+    }
+
+#undef PUT_CHAR
+
+    if (bufferSize > 0) {
+        buffer[(textLength < bufferSize) ? textLength : bufferSize - 1] = '\0';
+    }
+    freeMemoryToHeap(words);
+    freeMemoryToHeap(copy);
+    return textLength;
+}
+
+/*
+ * bigBaseFromString
+ *
+ * Parses an optional '-' and the digits of base that follow, like
+ * fixedIntFromString, into the exact integer: parsing stops at the first
+ * character that is no digit of base, and no digits are 0.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT for an unsupported
+ *          base, STATUS_OVERFLOW for more digits than a _bigDecimal
+ *          can hold or STATUS_INSUFFICIENT_MEMORY. result is unchanged
+ *          on failure.
+ */
+int bigBaseFromString(_bigDecimal* result, const char* text, int base)
+{
+    int digitBits = getDigitBits(base);
+    int sign = (*text == '-') ? -1 : 1;
+    int64_t digitCount = 0;
+    int status;
+
+    if (digitBits == 0 && base != 10) {
+        return STATUS_INVALID_INPUT;
+    }
+    text += (sign < 0);
+    while (*text == '0') {
+        text++;
+    }
+    while (getDigitValue(text[digitCount]) < base) {
+        digitCount++;
+    }
+    if (digitCount == 0) {
+        bigDecimalSetZero(result);
+        return STATUS_SUCCESS;
+    }
+    if (digitCount > (int64_t)MAX_LIMBS * BIG_LIMB_DIGITS) {
+        return STATUS_OVERFLOW;
+    }
+
+    if (base == 10) {
+        // The limbs from the last digit up, as in bigDecimalFromString
+        int limbCount = (int)((digitCount + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS);
+        uint32_t* limbs = allocateMemoryFromHeap((size_t)limbCount * sizeof(uint32_t));
+        if (limbs == NULL) {
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        for (int i = 0; i < limbCount; i++) {
+            int64_t end = digitCount - (int64_t)i * BIG_LIMB_DIGITS;
+            int64_t start = (end > BIG_LIMB_DIGITS) ? end - BIG_LIMB_DIGITS : 0;
+            uint32_t limb = 0;
+            for (int64_t d = start; d < end; d++) {
+                limb = limb * 10 + (uint32_t)(text[d] - '0');
+            }
+            limbs[i] = limb;
+        }
+        status = bigDecimalFromLimbs(result, limbs, limbCount, 0, sign);
+        freeMemoryToHeap(limbs);
+        return status;
+    }
+
+    // Each digit fills the slice of digitBits bits at its position
+    int wordCount = (int)((digitCount * digitBits + 63) / 64);
+    int limbCount = 2 * DECIMAL_WORDS_FOR_WORDS(wordCount);
+    uint64_t* words = allocateMemoryFromHeap((size_t)wordCount * sizeof(uint64_t));
+    uint32_t* limbs = allocateMemoryFromHeap((size_t)limbCount * sizeof(uint32_t));
+    if (words == NULL || limbs == NULL) {
+        freeMemoryToHeap(words);
+        freeMemoryToHeap(limbs);
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    memset(words, 0, (size_t)wordCount * sizeof(uint64_t));
+    for (int64_t digit = 0; digit < digitCount; digit++) {
+        uint64_t bits = (uint64_t)getDigitValue(text[digitCount - 1 - digit]);
+        int64_t bit = digit * digitBits;
+        int64_t word = bit / 64;
+        words[word] |= bits << (bit % 64);
+        if (bit % 64 + digitBits > 64) {
+            words[word + 1] |= bits >> (64 - bit % 64);
+        }
+    }
+    status = wordsToLimbs(limbs, limbCount, words, wordCount);
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalFromLimbs(result, limbs, trimLimbs(limbs, limbCount), 0, sign);
+    }
+    freeMemoryToHeap(words);
+    freeMemoryToHeap(limbs);
+    return status;
+}
@@ -0,0 +1,1545 @@
+/*-----------------------------------------------------------------------------
+    bignum.c --  Arbitrary-precision decimal arithmetic for the calculator
+                 engine (reconstructed code).
+
+               This module implements _bigDecimal, a sign/limbs/exponent
+               decimal floating-point number whose limbs hold 9 decimal
+               digits each. Results are rounded half-to-even to a
+               caller-supplied number of significant digits, so the engine
+               can offer anything from 32 to BIG_DECIMAL_MAX_PRECISION
+               digits.
+
+               Key functions include:
+
+               - bigDecimalFromString / bigDecimalToString: Conversions
+                                              from and to display text.
+               - bigDecimalAdd / Sub / Mul / Div / Sqrt: Rounded arithmetic.
+               - bigLimbMultiply: Limb product. Schoolbook below
+                                  bigMultiplyKaratsubaThreshold limbs,
+                                  Karatsuba below bigMultiplyToomThreshold
+                                  and Toom-Cook 3 above it.
+
+               Division uses Knuth's algorithm D on base 10^9 limbs and
+               square root uses Newton's iteration with doubling precision.
+               Limbs and scratch arrays come from the engine heap
+               (memory.c), except those of small values: up to
+               BIG_DECIMAL_INLINE_LIMBS limbs are kept in the _bigDecimal
+               itself, and the scratch of a small division and the
+               digits of a small number being printed are on the stack.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//bignum.h"
+#include ".//headers//format.h"
+#include ".//headers//memory.h"
+
+#define SMALL_SCRATCH_LIMBS (4 * BIG_DECIMAL_INLINE_LIMBS)  // Scratch kept on the stack
+
+int bigMultiplyKaratsubaThreshold = 40;
+int bigMultiplyToomThreshold = 160;
+
+static const uint32_t POWERS_OF_TEN[BIG_LIMB_DIGITS + 1] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+/*
+ * Limb-array helpers. All arrays are little-endian base 10^9 magnitudes.
+ */
+
+static int countLimbDigits(uint32_t limb)
+{
+    int digits = 1;
+    while (digits < BIG_LIMB_DIGITS && limb >= POWERS_OF_TEN[digits]) {
+        digits++;
+    }
+    return digits;
+}
+
+static int trimLimbs(const uint32_t* a, int length)
+{
+    while (length > 0 && a[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+static int compareLimbs(const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    if (aLength != bLength) {
+        return (aLength > bLength) ? 1 : -1;
+    }
+    for (int i = aLength - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// result[0..aLength) = a + b with aLength >= bLength; returns the carry.
+// result may alias a or b.
+static uint32_t addLimbs(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    uint32_t carry = 0;
+    int i = 0;
+
+    for (; i < bLength; i++) {
+        uint32_t sum = a[i] + b[i] + carry;
+        carry = (sum >= BIG_LIMB_BASE);
+        result[i] = carry ? sum - BIG_LIMB_BASE : sum;
+    }
+    for (; i < aLength; i++) {
+        uint32_t sum = a[i] + carry;
+        carry = (sum >= BIG_LIMB_BASE);
+        result[i] = carry ? sum - BIG_LIMB_BASE : sum;
+    }
+    return carry;
+}
+
+// result[0..aLength) = a - b with a >= b; result may alias a or b.
+static void subLimbs(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    uint32_t borrow = 0;
+    int i = 0;
+
+    for (; i < bLength; i++) {
+        uint32_t subtrahend = b[i] + borrow;
+        borrow = (a[i] < subtrahend);
+        result[i] = borrow ? a[i] + BIG_LIMB_BASE - subtrahend : a[i] - subtrahend;
+    }
+    for (; i < aLength; i++) {
+        uint32_t limb = a[i];
+        result[i] = (limb < borrow) ? BIG_LIMB_BASE - 1 : limb - borrow;
+        borrow = (limb < borrow);
+    }
+}
+
+// Adds x into result at limb offset; the sum must fit in resultLength limbs.
+static void addLimbsAt(uint32_t* result, int resultLength, int offset, const uint32_t* x, int xLength)
+{
+    uint32_t carry = addLimbs(result + offset, result + offset, xLength, x, xLength);
+    for (int i = offset + xLength; carry != 0 && i < resultLength; i++) {
+        uint32_t sum = result[i] + carry;
+        carry = (sum >= BIG_LIMB_BASE);
+        result[i] = carry ? sum - BIG_LIMB_BASE : sum;
+    }
+}
+
+// Subtracts x from result at limb offset; the difference must be >= 0.
+static void subLimbsAt(uint32_t* result, int resultLength, int offset, const uint32_t* x, int xLength)
+{
+    uint32_t borrow = 0;
+    int i = 0;
+
+    for (; i < xLength; i++) {
+        uint32_t subtrahend = x[i] + borrow;
+        uint32_t limb = result[offset + i];
+        borrow = (limb < subtrahend);
+        result[offset + i] = borrow ? limb + BIG_LIMB_BASE - subtrahend : limb - subtrahend;
+    }
+    for (i += offset; borrow != 0 && i < resultLength; i++) {
+        borrow = (result[i] == 0);
+        result[i] = borrow ? BIG_LIMB_BASE - 1 : result[i] - 1;
+    }
+}
+
+static void multiplySchoolbook(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    memset(result, 0, (size_t)(aLength + bLength) * sizeof(uint32_t));
+
+    for (int i = 0; i < aLength; i++) {
+        uint64_t multiplier = a[i];
+        uint64_t carry = 0;
+        if (multiplier == 0) {
+            continue;
+        }
+        for (int j = 0; j < bLength; j++) {
+            uint64_t t = result[i + j] + multiplier * b[j] + carry;
+            carry = t / BIG_LIMB_BASE;
+            result[i + j] = (uint32_t)(t - carry * BIG_LIMB_BASE);
+        }
+        result[i + bLength] = (uint32_t)carry;
+    }
+}
+
+static void multiplyLimbs(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength);
+
+/*
+ * multiplyKaratsuba
+ *
+ * a = a1*B^m + a0, b = b1*B^m + b0 with m = ceil(aLength/2) and
+ * bLength > m. Three half-size products instead of four:
+ * (a0+a1)(b0+b1) - a0*b0 - a1*b1 is the middle coefficient.
+ */
+static void multiplyKaratsuba(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    int m = (aLength + 1) / 2;
+    int a1Length = aLength - m;
+    int b1Length = bLength - m;
+    int resultLength = aLength + bLength;
+    int a0Length = trimLimbs(a, m);
+    int b0Length = trimLimbs(b, m);
+
+    uint32_t* scratch = allocateMemoryFromHeap((size_t)(4 * (m + 1)) * sizeof(uint32_t));
+    uint32_t* sumA = scratch;
+    uint32_t* sumB = scratch + (m + 1);
+    uint32_t* middle = scratch + 2 * (m + 1);
+
+    memset(result, 0, (size_t)resultLength * sizeof(uint32_t));
+
+    // z0 = a0*b0 and z2 = a1*b1 go straight to their final places
+    if (a0Length > 0 && b0Length > 0) {
+        multiplyLimbs(result, a, a0Length, b, b0Length);
+    }
+    multiplyLimbs(result + 2 * m, a + m, a1Length, b + m, b1Length);
+
+    memcpy(sumA, a, (size_t)m * sizeof(uint32_t));
+    sumA[m] = addLimbs(sumA, sumA, m, a + m, a1Length);
+    memcpy(sumB, b, (size_t)m * sizeof(uint32_t));
+    sumB[m] = addLimbs(sumB, sumB, m, b + m, b1Length);
+
+    int sumALength = trimLimbs(sumA, m + 1);
+    int sumBLength = trimLimbs(sumB, m + 1);
+    int middleLength = sumALength + sumBLength;
+    multiplyLimbs(middle, sumA, sumALength, sumB, sumBLength);
+
+    // middle -= z0 + z2; both are still in result
+    int z0Length = trimLimbs(result, 2 * m);
+    int z2Length = trimLimbs(result + 2 * m, a1Length + b1Length);
+    subLimbsAt(middle, middleLength, 0, result, z0Length);
+    subLimbsAt(middle, middleLength, 0, result + 2 * m, z2Length);
+
+    addLimbsAt(result, resultLength, m, middle, trimLimbs(middle, middleLength));
+    freeMemoryToHeap(scratch);
+}
+
+/*
+ * Signed limb vectors for the Toom-Cook 3 evaluation and interpolation.
+ */
+typedef struct {
+    uint32_t* limbs;
+    int length;
+    int sign;
+} _signedLimbs;
+
+// result = x + ySign*y; result may alias x or y
+static void addSignedLimbs(_signedLimbs* result, const _signedLimbs* x, const _signedLimbs* y, int ySign)
+{
+    int sign = y->sign * ySign;
+
+    if (x->sign == sign) {
+        const _signedLimbs* longer = (x->length >= y->length) ? x : y;
+        const _signedLimbs* shorter = (x->length >= y->length) ? y : x;
+        uint32_t carry = addLimbs(result->limbs, longer->limbs, longer->length, shorter->limbs, shorter->length);
+        result->length = longer->length;
+        if (carry != 0) {
+            result->limbs[result->length++] = carry;
+        }
+        result->sign = sign;
+    }
+    else if (compareLimbs(x->limbs, x->length, y->limbs, y->length) >= 0) {
+        subLimbs(result->limbs, x->limbs, x->length, y->limbs, y->length);
+        result->length = trimLimbs(result->limbs, x->length);
+        result->sign = x->sign;
+    }
+    else {
+        subLimbs(result->limbs, y->limbs, y->length, x->limbs, x->length);
+        result->length = trimLimbs(result->limbs, y->length);
+        result->sign = sign;
+    }
+    if (result->length == 0) {
+        result->sign = 1;
+    }
+}
+
+// Exact division by a small divisor (2 or 3 in the interpolation)
+static void divideSignedLimbs(_signedLimbs* value, uint32_t divisor)
+{
+    uint64_t remainder = 0;
+    for (int i = value->length - 1; i >= 0; i--) {
+        uint64_t current = remainder * BIG_LIMB_BASE + value->limbs[i];
+        value->limbs[i] = (uint32_t)(current / divisor);
+        remainder = current % divisor;
+    }
+    value->length = trimLimbs(value->limbs, value->length);
+}
+
+static void multiplySignedLimbs(_signedLimbs* result, const _signedLimbs* x, const _signedLimbs* y)
+{
+    if (x->length == 0 || y->length == 0) {
+        result->length = 0;
+        result->sign = 1;
+        return;
+    }
+    multiplyLimbs(result->limbs, x->limbs, x->length, y->limbs, y->length);
+    result->length = trimLimbs(result->limbs, x->length + y->length);
+    result->sign = x->sign * y->sign;
+}
+
+/*
+ * multiplyToom3
+ *
+ * Splits both operands in three parts of k limbs, evaluates at
+ * 0, 1, -1, -2 and infinity, multiplies the five pairs recursively and
+ * interpolates with Bodrato's sequence. Requires bLength > 2k.
+ */
+static void multiplyToom3(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    int k = (aLength + 2) / 3;
+    int resultLength = aLength + bLength;
+    int evaluationSize = k + 2;
+    int productSize = 2 * k + 6;
+
+    uint32_t* scratch = allocateMemoryFromHeap((size_t)(6 * evaluationSize + 5 * productSize) * sizeof(uint32_t));
+    uint32_t* next = scratch;
+    _signedLimbs p1, pm1, pm2, q1, qm1, qm2, r0, r1, rm1, rm2, rinf;
+    _signedLimbs* evaluations[] = { &p1, &pm1, &pm2, &q1, &qm1, &qm2 };
+    _signedLimbs* products[] = { &r0, &r1, &rm1, &rm2, &rinf };
+
+    for (int i = 0; i < 6; i++) {
+        evaluations[i]->limbs = next;
+        next += evaluationSize;
+    }
+    for (int i = 0; i < 5; i++) {
+        products[i]->limbs = next;
+        next += productSize;
+    }
+
+    const uint32_t* parts[2][3] = { { a, a + k, a + 2 * k }, { b, b + k, b + 2 * k } };
+    int lengths[2][3] = {
+        { trimLimbs(a, k), trimLimbs(a + k, k), trimLimbs(a + 2 * k, aLength - 2 * k) },
+        { trimLimbs(b, k), trimLimbs(b + k, k), trimLimbs(b + 2 * k, bLength - 2 * k) }
+    };
+
+    for (int side = 0; side < 2; side++) {
+        _signedLimbs part0 = { (uint32_t*)parts[side][0], lengths[side][0], 1 };
+        _signedLimbs part1 = { (uint32_t*)parts[side][1], lengths[side][1], 1 };
+        _signedLimbs part2 = { (uint32_t*)parts[side][2], lengths[side][2], 1 };
+        _signedLimbs* v1 = evaluations[side * 3];
+        _signedLimbs* vm1 = evaluations[side * 3 + 1];
+        _signedLimbs* vm2 = evaluations[side * 3 + 2];
+
+        // t = p0 + p2; v(1) = t + p1; v(-1) = t - p1
+        addSignedLimbs(vm2, &part0, &part2, 1);
+        addSignedLimbs(v1, vm2, &part1, 1);
+        addSignedLimbs(vm1, vm2, &part1, -1);
+        // v(-2) = 2*(v(-1) + p2) - p0
+        addSignedLimbs(vm2, vm1, &part2, 1);
+        addSignedLimbs(vm2, vm2, vm2, 1);
+        addSignedLimbs(vm2, vm2, &part0, -1);
+    }
+
+    _signedLimbs a0 = { (uint32_t*)a, lengths[0][0], 1 }, b0 = { (uint32_t*)b, lengths[1][0], 1 };
+    _signedLimbs a2 = { (uint32_t*)(a + 2 * k), lengths[0][2], 1 }, b2 = { (uint32_t*)(b + 2 * k), lengths[1][2], 1 };
+    multiplySignedLimbs(&r0, &a0, &b0);
+    multiplySignedLimbs(&r1, &p1, &q1);
+    multiplySignedLimbs(&rm1, &pm1, &qm1);
+    multiplySignedLimbs(&rm2, &pm2, &qm2);
+    multiplySignedLimbs(&rinf, &a2, &b2);
+
+    // Interpolation; rm2 becomes r3, r1 becomes c1, rm1 becomes c2
+    addSignedLimbs(&rm2, &rm2, &r1, -1);      // r3 = (r(-2) - r(1)) / 3
+    divideSignedLimbs(&rm2, 3);
+    addSignedLimbs(&r1, &r1, &rm1, -1);       // c1 = (r(1) - r(-1)) / 2
+    divideSignedLimbs(&r1, 2);
+    addSignedLimbs(&rm1, &rm1, &r0, -1);      // c2 = r(-1) - r(0)
+    addSignedLimbs(&rm2, &rm1, &rm2, -1);     // r3 = (c2 - r3) / 2 + 2 r(inf)
+    divideSignedLimbs(&rm2, 2);
+    addSignedLimbs(&rm2, &rm2, &rinf, 1);
+    addSignedLimbs(&rm2, &rm2, &rinf, 1);
+    addSignedLimbs(&rm1, &rm1, &r1, 1);       // c2 = c2 + c1 - r(inf)
+    addSignedLimbs(&rm1, &rm1, &rinf, -1);
+    addSignedLimbs(&r1, &r1, &rm2, -1);       // c1 = c1 - r3
+
+    memset(result, 0, (size_t)resultLength * sizeof(uint32_t));
+    memcpy(result, r0.limbs, (size_t)r0.length * sizeof(uint32_t));
+    addLimbsAt(result, resultLength, k, r1.limbs, r1.length);
+    addLimbsAt(result, resultLength, 2 * k, rm1.limbs, rm1.length);
+    addLimbsAt(result, resultLength, 3 * k, rm2.limbs, rm2.length);
+    addLimbsAt(result, resultLength, 4 * k, rinf.limbs, rinf.length);
+    freeMemoryToHeap(scratch);
+}
+
+/*
+ * multiplyLimbs
+ *
+ * result[0..aLength+bLength) = a * b. Picks the algorithm by the length
+ * of the shorter operand and cuts very unbalanced products into
+ * balanced pieces.
+ */
+static void multiplyLimbs(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    if (aLength < bLength) {
+        const uint32_t* swapLimbs = a; a = b; b = swapLimbs;
+        int swapLength = aLength; aLength = bLength; bLength = swapLength;
+    }
+    if (bLength == 0) {
+        memset(result, 0, (size_t)aLength * sizeof(uint32_t));
+        return;
+    }
+    if (bLength < bigMultiplyKaratsubaThreshold) {
+        multiplySchoolbook(result, a, aLength, b, bLength);
+        return;
+    }
+
+    if (2 * bLength <= aLength) {
+        // Unbalanced: multiply b by bLength-sized slices of a
+        uint32_t* piece = allocateMemoryFromHeap((size_t)(2 * bLength) * sizeof(uint32_t));
+        memset(result, 0, (size_t)(aLength + bLength) * sizeof(uint32_t));
+        for (int offset = 0; offset < aLength; offset += bLength) {
+            int sliceLength = (aLength - offset < bLength) ? aLength - offset : bLength;
+            int trimmed = trimLimbs(a + offset, sliceLength);
+            if (trimmed == 0) {
+                continue;
+            }
+            multiplyLimbs(piece, a + offset, trimmed, b, bLength);
+            addLimbsAt(result, aLength + bLength, offset, piece, trimLimbs(piece, trimmed + bLength));
+        }
+        freeMemoryToHeap(piece);
+        return;
+    }
+
+    if (bLength >= bigMultiplyToomThreshold && 3 * bLength > 2 * (aLength + 2)) {
+        multiplyToom3(result, a, aLength, b, bLength);
+    }
+    else {
+        multiplyKaratsuba(result, a, aLength, b, bLength);
+    }
+}
+
+/*
+ * bigLimbMultiply
+ *
+ * Public entry point of the limb multiply, mainly for benchmarks.
+ * result must have room for aLength + bLength limbs and must not overlap
+ * the operands.
+ */
+void bigLimbMultiply(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength)
+{
+    multiplyLimbs(result, a, aLength, b, bLength);
+}
+
+/*
+ * divideLimbs
+ *
+ * Knuth's algorithm D: quotient[0..uLength-vLength] = u / v.
+ * u and v are trimmed, uLength >= vLength >= 1. Returns true if the
+ * remainder is non-zero.
+ */
+static bool divideLimbs(uint32_t* quotient, const uint32_t* u, int uLength, const uint32_t* v, int vLength)
+{
+    if (vLength == 1) {
+        uint64_t remainder = 0;
+        for (int i = uLength - 1; i >= 0; i--) {
+            uint64_t current = remainder * BIG_LIMB_BASE + u[i];
+            quotient[i] = (uint32_t)(current / v[0]);
+            remainder = current % v[0];
+        }
+        return remainder != 0;
+    }
+
+    uint32_t smallScratch[SMALL_SCRATCH_LIMBS];
+    int scratchLength = uLength + 1 + vLength;
+    uint32_t* scratch = (scratchLength <= SMALL_SCRATCH_LIMBS) ? smallScratch
+                                                              : allocateMemoryFromHeap((size_t)scratchLength * sizeof(uint32_t));
+    uint32_t* un = scratch;
+    uint32_t* vn = scratch + uLength + 1;
+    uint64_t factor = BIG_LIMB_BASE / ((uint64_t)v[vLength - 1] + 1);
+    uint64_t carry = 0;
+
+    // Normalize so the top limb of the divisor is at least BASE/2
+    for (int i = 0; i < uLength; i++) {
+        uint64_t t = u[i] * factor + carry;
+        carry = t / BIG_LIMB_BASE;
+        un[i] = (uint32_t)(t - carry * BIG_LIMB_BASE);
+    }
+    un[uLength] = (uint32_t)carry;
+    carry = 0;
+    for (int i = 0; i < vLength; i++) {
+        uint64_t t = v[i] * factor + carry;
+        carry = t / BIG_LIMB_BASE;
+        vn[i] = (uint32_t)(t - carry * BIG_LIMB_BASE);
+    }
+
+    uint64_t vTop = vn[vLength - 1];
+    uint64_t vNext = vn[vLength - 2];
+
+    for (int j = uLength - vLength; j >= 0; j--) {
+        uint64_t numerator = (uint64_t)un[j + vLength] * BIG_LIMB_BASE + un[j + vLength - 1];
+        uint64_t qhat = numerator / vTop;
+        uint64_t rhat = numerator % vTop;
+
+        while (qhat >= BIG_LIMB_BASE || qhat * vNext > rhat * BIG_LIMB_BASE + un[j + vLength - 2]) {
+            qhat--;
+            rhat += vTop;
+            if (rhat >= BIG_LIMB_BASE) {
+                break;
+            }
+        }
+
+        // un[j..j+vLength] -= qhat * vn
+        int64_t borrow = 0;
+        carry = 0;
+        for (int i = 0; i < vLength; i++) {
+            uint64_t product = qhat * vn[i] + carry;
+            carry = product / BIG_LIMB_BASE;
+            int64_t t = (int64_t)un[i + j] - (int64_t)(product - carry * BIG_LIMB_BASE) + borrow;
+            borrow = (t < 0) ? -1 : 0;
+            un[i + j] = (uint32_t)((t < 0) ? t + BIG_LIMB_BASE : t);
+        }
+        int64_t top = (int64_t)un[j + vLength] - (int64_t)carry + borrow;
+
+        if (top < 0) {
+            // qhat was one too large: add the divisor back
+            qhat--;
+            uint32_t addCarry = addLimbs(un + j, un + j, vLength, vn, vLength);
+            top += addCarry;
+        }
+        un[j + vLength] = (uint32_t)top;
+        quotient[j] = (uint32_t)qhat;
+    }
+
+    bool hasRemainder = trimLimbs(un, vLength) != 0;
+    if (scratch != smallScratch) {
+        freeMemoryToHeap(scratch);
+    }
+    return hasRemainder;
+}
+
+/*
+ * _bigDecimal storage management.
+ */
+
+void bigDecimalInit(_bigDecimal* value)
+{
+    value->limbs = NULL;
+    value->length = 0;
+    value->capacity = 0;
+    value->exponent = 0;
+    value->sign = 1;
+}
+
+void bigDecimalFree(_bigDecimal* value)
+{
+    freeMemoryToHeap(value->limbs);
+    bigDecimalInit(value);
+}
+
+// Makes room for capacity limbs, moving inline limbs to the heap when they no longer fit
+static int reserveLimbs(_bigDecimal* value, int capacity)
+{
+    if (value->limbs == NULL) {
+        if (capacity <= BIG_DECIMAL_INLINE_LIMBS) {
+            return STATUS_SUCCESS;
+        }
+        uint32_t* limbs = allocateMemoryFromHeap((size_t)capacity * sizeof(uint32_t));
+        if (limbs == NULL) {
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        memcpy(limbs, value->inlineLimbs, (size_t)value->length * sizeof(uint32_t));
+        value->limbs = limbs;
+        value->capacity = capacity;
+        return STATUS_SUCCESS;
+    }
+    if (capacity <= value->capacity) {
+        return STATUS_SUCCESS;
+    }
+    uint32_t* limbs = reallocateMemoryFromHeap(value->limbs, (size_t)capacity * sizeof(uint32_t));
+    if (limbs == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    value->limbs = limbs;
+    value->capacity = capacity;
+    return STATUS_SUCCESS;
+}
+
+// Hands the limbs of source to result, freeing result's old buffer; inline limbs are copied
+static void moveBigDecimal(_bigDecimal* result, _bigDecimal* source)
+{
+    freeMemoryToHeap(result->limbs);
+    *result = *source;
+    bigDecimalInit(source);
+}
+
+// Strips zero limbs at both ends so limbs[0] and limbs[length-1] are non-zero
+static void normalizeBigDecimal(_bigDecimal* value)
+{
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(value);
+    int low = 0;
+
+    value->length = trimLimbs(limbs, value->length);
+    if (value->length == 0) {
+        value->exponent = 0;
+        value->sign = 1;
+        return;
+    }
+    while (limbs[low] == 0) {
+        low++;
+    }
+    if (low > 0) {
+        memmove(limbs, limbs + low, (size_t)(value->length - low) * sizeof(uint32_t));
+        value->length -= low;
+        value->exponent += low;
+    }
+}
+
+void bigDecimalSetZero(_bigDecimal* result)
+{
+    result->length = 0;
+    result->exponent = 0;
+    result->sign = 1;
+}
+
+int bigDecimalCopy(_bigDecimal* result, const _bigDecimal* value)
+{
+    if (result == value) {
+        return STATUS_SUCCESS;
+    }
+    if (reserveLimbs(result, value->length) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    if (value->length > 0) {
+        memcpy(BIG_DECIMAL_LIMBS(result), BIG_DECIMAL_LIMBS(value), (size_t)value->length * sizeof(uint32_t));
+    }
+    result->length = value->length;
+    result->exponent = value->exponent;
+    result->sign = value->sign;
+    return STATUS_SUCCESS;
+}
+
+static int setMagnitude(_bigDecimal* result, uint64_t magnitude, int sign)
+{
+    if (reserveLimbs(result, 3) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(result);
+    result->sign = sign;
+    result->exponent = 0;
+    result->length = 0;
+    while (magnitude != 0) {
+        limbs[result->length++] = (uint32_t)(magnitude % BIG_LIMB_BASE);
+        magnitude /= BIG_LIMB_BASE;
+    }
+    normalizeBigDecimal(result);
+    return STATUS_SUCCESS;
+}
+
+int bigDecimalSetInt(_bigDecimal* result, int64_t value)
+{
+    return setMagnitude(result, (value < 0) ? 0 - (uint64_t)value : (uint64_t)value, (value < 0) ? -1 : 1);
+}
+
+/*
+ * bigDecimalFromLimbs
+ *
+ * result = sign * limbs * (10^9)^exponent, for code that builds the
+ * limbs of a value itself. The limbs are copied.
+ */
+int bigDecimalFromLimbs(_bigDecimal* result, const uint32_t* limbs, int length, int64_t exponent, int sign)
+{
+    if (reserveLimbs(result, length) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    if (length > 0) {
+        memcpy(BIG_DECIMAL_LIMBS(result), limbs, (size_t)length * sizeof(uint32_t));
+    }
+    result->length = length;
+    result->exponent = exponent;
+    result->sign = sign;
+    normalizeBigDecimal(result);
+    return STATUS_SUCCESS;
+}
+
+bool bigDecimalIsZero(const _bigDecimal* value)
+{
+    return value->length == 0;
+}
+
+void bigDecimalNegate(_bigDecimal* value)
+{
+    if (value->length != 0) {
+        value->sign = -value->sign;
+    }
+}
+
+/*
+ * bigDecimalDigitCount
+ *
+ * Number of decimal digits in the limbs, from the leading digit down to
+ * the last non-zero limb.
+ */
+int bigDecimalDigitCount(const _bigDecimal* value)
+{
+    if (value->length == 0) {
+        return 0;
+    }
+    return (value->length - 1) * BIG_LIMB_DIGITS + countLimbDigits(BIG_DECIMAL_LIMBS(value)[value->length - 1]);
+}
+
+/*
+ * bigDecimalDigitExponent
+ *
+ * floor(log10(|value|)), the power of ten of the leading digit.
+ */
+int64_t bigDecimalDigitExponent(const _bigDecimal* value)
+{
+    if (value->length == 0) {
+        return 0;
+    }
+    return (value->exponent + value->length - 1) * BIG_LIMB_DIGITS +
+        countLimbDigits(BIG_DECIMAL_LIMBS(value)[value->length - 1]) - 1;
+}
+
+/*
+ * bigDecimalRound
+ *
+ * Rounds value half-to-even to `precision` significant digits. The limb
+ * alignment is kept: discarded digits are zeroed and whole zero limbs are
+ * then dropped into the exponent.
+ */
+int bigDecimalRound(_bigDecimal* value, int precision)
+{
+    normalizeBigDecimal(value);
+    if (precision <= BIG_DECIMAL_EXACT || value->length == 0) {
+        return STATUS_SUCCESS;
+    }
+
+    int digits = bigDecimalDigitCount(value);
+    if (digits <= precision) {
+        return STATUS_SUCCESS;
+    }
+
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(value);
+    int excess = digits - precision;
+    int limbIndex = excess / BIG_LIMB_DIGITS;
+    int digitIndex = excess % BIG_LIMB_DIGITS;
+    uint32_t unit = POWERS_OF_TEN[digitIndex];
+    uint32_t roundDigit;
+    bool hasSticky = false;
+
+    for (int i = 0; i < limbIndex - (digitIndex == 0); i++) {
+        if (limbs[i] != 0) {
+            hasSticky = true;
+            break;
+        }
+    }
+    if (digitIndex > 0) {
+        uint32_t half = POWERS_OF_TEN[digitIndex - 1];
+        uint32_t discarded = limbs[limbIndex] % unit;
+        roundDigit = discarded / half;
+        hasSticky = hasSticky || (discarded % half) != 0;
+    }
+    else {
+        uint32_t below = limbs[limbIndex - 1];
+        roundDigit = below / (BIG_LIMB_BASE / 10);
+        hasSticky = hasSticky || (below % (BIG_LIMB_BASE / 10)) != 0;
+    }
+
+    bool isOdd = ((limbs[limbIndex] / unit) & 1) != 0;
+    bool roundUp = roundDigit > 5 || (roundDigit == 5 && (hasSticky || isOdd));
+
+    limbs[limbIndex] -= limbs[limbIndex] % unit;
+    if (limbIndex > 0) {
+        memmove(limbs, limbs + limbIndex, (size_t)(value->length - limbIndex) * sizeof(uint32_t));
+        value->length -= limbIndex;
+        value->exponent += limbIndex;
+    }
+
+    if (roundUp) {
+        uint32_t increment = unit;
+        uint32_t carry = addLimbs(limbs, limbs, value->length, &increment, 1);
+        if (carry != 0) {
+            if (reserveLimbs(value, value->length + 1) != STATUS_SUCCESS) {
+                return STATUS_INSUFFICIENT_MEMORY;
+            }
+            BIG_DECIMAL_LIMBS(value)[value->length++] = carry;
+        }
+    }
+    normalizeBigDecimal(value);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * compareMagnitudes
+ *
+ * Compares |a| and |b| for normalized, non-zero values.
+ */
+static int compareMagnitudes(const _bigDecimal* a, const _bigDecimal* b)
+{
+    int64_t aTop = a->exponent + a->length;
+    int64_t bTop = b->exponent + b->length;
+
+    if (aTop != bTop) {
+        return (aTop > bTop) ? 1 : -1;
+    }
+    const uint32_t* aLimbs = BIG_DECIMAL_LIMBS(a);
+    const uint32_t* bLimbs = BIG_DECIMAL_LIMBS(b);
+    for (int i = 1; i <= a->length || i <= b->length; i++) {
+        uint32_t aLimb = (i <= a->length) ? aLimbs[a->length - i] : 0;
+        uint32_t bLimb = (i <= b->length) ? bLimbs[b->length - i] : 0;
+        if (aLimb != bLimb) {
+            return (aLimb > bLimb) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * bigDecimalCompare
+ *
+ * Returns -1, 0 or 1 as a is less than, equal to or greater than b.
+ */
+int bigDecimalCompare(const _bigDecimal* a, const _bigDecimal* b)
+{
+    if (a->length == 0 || b->length == 0) {
+        int aSign = (a->length == 0) ? 0 : a->sign;
+        int bSign = (b->length == 0) ? 0 : b->sign;
+        return (aSign > bSign) - (aSign < bSign);
+    }
+    if (a->sign != b->sign) {
+        return (a->sign > b->sign) ? 1 : -1;
+    }
+    return compareMagnitudes(a, b) * a->sign;
+}
+
+/*
+ * addSingleLimbs
+ *
+ * addSigned for two one-limb operands with the same exponent, such as
+ * integers as typed: the sum needs at most two limbs, which are inline.
+ */
+static int addSingleLimbs(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int bSign, int precision)
+{
+    uint32_t x = BIG_DECIMAL_LIMBS(a)[0];
+    uint32_t y = BIG_DECIMAL_LIMBS(b)[0];
+    int aSign = a->sign;
+    int ySign = b->sign * bSign;
+    int64_t exponent = a->exponent;
+
+    if (reserveLimbs(result, 2) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(result);
+    if (aSign == ySign) {
+        uint32_t sum = x + y;  // Below 2 * 10^9
+        limbs[0] = sum % BIG_LIMB_BASE;
+        limbs[1] = sum / BIG_LIMB_BASE;
+        result->length = 2;
+        result->sign = aSign;
+    }
+    else {
+        limbs[0] = (x >= y) ? x - y : y - x;
+        result->length = 1;
+        result->sign = (x >= y) ? aSign : ySign;
+    }
+    result->exponent = exponent;
+    return bigDecimalRound(result, precision);
+}
+
+/*
+ * addSigned
+ *
+ * result = a + bSign * b, rounded to precision.
+ */
+static int addSigned(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int bSign, int precision)
+{
+    _bigDecimal sum;
+    int status;
+
+    if (b->length == 0) {
+        status = bigDecimalCopy(result, a);
+        return (status == STATUS_SUCCESS) ? bigDecimalRound(result, precision) : status;
+    }
+    if (a->length == 0) {
+        status = bigDecimalCopy(result, b);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+        result->sign = b->sign * bSign;
+        return bigDecimalRound(result, precision);
+    }
+    if (a->length == 1 && b->length == 1 && a->exponent == b->exponent) {
+        return addSingleLimbs(result, a, b, bSign, precision);
+    }
+
+    // An operand entirely below the rounding position only matters as a
+    // sticky bit: replace it by one unit far below the other operand.
+    uint32_t stickyLimb = 1;
+    _bigDecimal sticky = { .limbs = &stickyLimb, .length = 1, .capacity = 1, .exponent = 0, .sign = 1 };
+    int64_t aTop = a->exponent + a->length;
+    int64_t bTop = b->exponent + b->length;
+    if (precision > BIG_DECIMAL_EXACT) {
+        int64_t gap = precision / BIG_LIMB_DIGITS + 3;
+        if (aTop - bTop > gap) {
+            sticky.exponent = aTop - gap;
+            sticky.sign = b->sign;
+            b = &sticky;
+            bTop = b->exponent + 1;
+        }
+        else if (bTop - aTop > gap) {
+            sticky.exponent = bTop - gap;
+            sticky.sign = a->sign;
+            a = &sticky;
+            aTop = a->exponent + 1;
+        }
+    }
+
+    int64_t exponent = (a->exponent < b->exponent) ? a->exponent : b->exponent;
+    int length = (int)(((aTop > bTop) ? aTop : bTop) - exponent) + 1;
+    int aOffset = (int)(a->exponent - exponent);
+    int bOffset = (int)(b->exponent - exponent);
+    int resultSign;
+
+    bigDecimalInit(&sum);
+    if (reserveLimbs(&sum, length) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint32_t* sumLimbs = BIG_DECIMAL_LIMBS(&sum);
+    const uint32_t* aLimbs = BIG_DECIMAL_LIMBS(a);
+    const uint32_t* bLimbs = BIG_DECIMAL_LIMBS(b);
+    memset(sumLimbs, 0, (size_t)length * sizeof(uint32_t));
+
+    if (a->sign == b->sign * bSign) {
+        memcpy(sumLimbs + aOffset, aLimbs, (size_t)a->length * sizeof(uint32_t));
+        addLimbsAt(sumLimbs, length, bOffset, bLimbs, b->length);
+        resultSign = a->sign;
+    }
+    else if (compareMagnitudes(a, b) >= 0) {
+        memcpy(sumLimbs + aOffset, aLimbs, (size_t)a->length * sizeof(uint32_t));
+        subLimbsAt(sumLimbs, length, bOffset, bLimbs, b->length);
+        resultSign = a->sign;
+    }
+    else {
+        memcpy(sumLimbs + bOffset, bLimbs, (size_t)b->length * sizeof(uint32_t));
+        subLimbsAt(sumLimbs, length, aOffset, aLimbs, a->length);
+        resultSign = b->sign * bSign;
+    }
+
+    sum.length = length;
+    sum.exponent = exponent;
+    sum.sign = resultSign;
+    status = bigDecimalRound(&sum, precision);
+    moveBigDecimal(result, &sum);
+    return status;
+}
+
+int bigDecimalAdd(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision)
+{
+    return addSigned(result, a, b, 1, precision);
+}
+
+int bigDecimalSub(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision)
+{
+    return addSigned(result, a, b, -1, precision);
+}
+
+int bigDecimalMul(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision)
+{
+    _bigDecimal product;
+
+    if (a->length == 0 || b->length == 0) {
+        bigDecimalSetZero(result);
+        return STATUS_SUCCESS;
+    }
+    if (a->length == 1 && b->length == 1) {
+        // One 64-bit product, written straight into result, which may be a or b
+        uint64_t limbProduct = (uint64_t)BIG_DECIMAL_LIMBS(a)[0] * BIG_DECIMAL_LIMBS(b)[0];
+        int64_t exponent = a->exponent + b->exponent;
+        int sign = a->sign * b->sign;
+        if (reserveLimbs(result, 2) != STATUS_SUCCESS) {
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        uint32_t* limbs = BIG_DECIMAL_LIMBS(result);
+        limbs[0] = (uint32_t)(limbProduct % BIG_LIMB_BASE);
+        limbs[1] = (uint32_t)(limbProduct / BIG_LIMB_BASE);
+        result->length = 2;
+        result->exponent = exponent;
+        result->sign = sign;
+        return bigDecimalRound(result, precision);
+    }
+
+    bigDecimalInit(&product);
+    if (reserveLimbs(&product, a->length + b->length) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    multiplyLimbs(BIG_DECIMAL_LIMBS(&product), BIG_DECIMAL_LIMBS(a), a->length, BIG_DECIMAL_LIMBS(b), b->length);
+    product.length = a->length + b->length;
+    product.exponent = a->exponent + b->exponent;
+    product.sign = a->sign * b->sign;
+
+    int status = bigDecimalRound(&product, precision);
+    moveBigDecimal(result, &product);
+    return status;
+}
+
+/*
+ * bigDecimalDiv
+ *
+ * result = a / b rounded to precision digits (BIG_DECIMAL_EXACT selects
+ * BIG_DECIMAL_DEFAULT_PRECISION). The quotient is computed with at least
+ * two spare limbs; a non-zero remainder is kept as a sticky unit limb so
+ * the final rounding is correct.
+ */
+int bigDecimalDiv(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision)
+{
+    _bigDecimal quotient;
+
+    if (b->length == 0) {
+        return STATUS_DIVISION_BY_ZERO;
+    }
+    if (a->length == 0) {
+        bigDecimalSetZero(result);
+        return STATUS_SUCCESS;
+    }
+    if (precision <= BIG_DECIMAL_EXACT) {
+        precision = BIG_DECIMAL_DEFAULT_PRECISION;
+    }
+
+    int quotientLimbs = (precision + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS + 2;
+    int shift = quotientLimbs + b->length - a->length;
+    if (shift < 0) {
+        shift = 0;
+    }
+    int numeratorLength = a->length + shift;
+    int quotientLength = numeratorLength - b->length + 1;
+
+    uint32_t smallNumerator[SMALL_SCRATCH_LIMBS];
+    uint32_t* numerator = (numeratorLength <= SMALL_SCRATCH_LIMBS) ? smallNumerator
+                                                                   : allocateMemoryFromHeap((size_t)numeratorLength * sizeof(uint32_t));
+    bigDecimalInit(&quotient);
+    if (numerator == NULL || reserveLimbs(&quotient, quotientLength + 1) != STATUS_SUCCESS) {
+        if (numerator != smallNumerator) {
+            freeMemoryToHeap(numerator);
+        }
+        bigDecimalFree(&quotient);
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    memset(numerator, 0, (size_t)shift * sizeof(uint32_t));
+    memcpy(numerator + shift, BIG_DECIMAL_LIMBS(a), (size_t)a->length * sizeof(uint32_t));
+
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(&quotient);
+    bool hasRemainder = divideLimbs(limbs + 1, numerator, numeratorLength, BIG_DECIMAL_LIMBS(b), b->length);
+    if (numerator != smallNumerator) {
+        freeMemoryToHeap(numerator);
+    }
+
+    limbs[0] = hasRemainder ? 1 : 0;
+    quotient.length = quotientLength + 1;
+    quotient.exponent = a->exponent - b->exponent - shift - 1;
+    quotient.sign = a->sign * b->sign;
+
+    int status = bigDecimalRound(&quotient, precision);
+    moveBigDecimal(result, &quotient);
+    return status;
+}
+
+/*
+ * bigDecimalSqrt
+ *
+ * Newton's iteration x' = (x + a/x) / 2 starting from a double estimate,
+ * doubling the working precision each step and finishing with two
+ * iterations at the target precision plus guard digits.
+ */
+int bigDecimalSqrt(_bigDecimal* result, const _bigDecimal* a, int precision)
+{
+    char estimateText[64];
+    _bigDecimal x, quotient;
+    uint32_t halfLimb = BIG_LIMB_BASE / 2;
+    int status = STATUS_SUCCESS;
+
+    if (a->length == 0) {
+        bigDecimalSetZero(result);
+        return STATUS_SUCCESS;
+    }
+    if (a->sign < 0) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (precision <= BIG_DECIMAL_EXACT) {
+        precision = BIG_DECIMAL_DEFAULT_PRECISION;
+    }
+
+    // Estimate from a double: a = scaled * (10^9)^(2*limbShift) with
+    // scaled in [10^-9, 10^9), so sqrt(a) = sqrt(scaled) * (10^9)^limbShift
+    int64_t top = a->exponent + a->length;
+    int64_t limbShift = (top >= 0) ? top / 2 : -((-top + 1) / 2);
+    _bigDecimal scaled = *a;
+    scaled.exponent -= 2 * limbShift;
+    snprintf(estimateText, sizeof(estimateText), "%.17g", sqrt(bigDecimalToDouble(&scaled)));
+
+    _bigDecimal half = { .limbs = &halfLimb, .length = 1, .capacity = 1, .exponent = -1, .sign = 1 };
+    bigDecimalInit(&x);
+    bigDecimalInit(&quotient);
+    status = bigDecimalFromString(&x, estimateText, '.', 17);
+    x.exponent += limbShift;
+
+    int target = precision + BIG_LIMB_DIGITS;
+    int working = 16;
+    int finalIterations = 2;
+    while (status == STATUS_SUCCESS && finalIterations > 0) {
+        working = (2 * working < target) ? 2 * working : target;
+        status = bigDecimalDiv(&quotient, a, &x, working);
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalAdd(&x, &x, &quotient, working);
+        }
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalMul(&x, &x, &half, working);
+        }
+        if (working == target) {
+            finalIterations--;
+        }
+    }
+
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalRound(&x, precision);
+        moveBigDecimal(result, &x);
+    }
+    bigDecimalFree(&x);
+    bigDecimalFree(&quotient);
+    return status;
+}
+
+/*
+ * bigDecimalFromString
+ *
+ * Parses [-]digits[.digits][e[-]digits]. Both '.' and decimalSeparator
+ * are accepted as the decimal point; leading and trailing blanks are
+ * ignored. Returns STATUS_INVALID_INPUT if the text is not a number.
+ */
+int bigDecimalFromString(_bigDecimal* result, const char* str, char decimalSeparator, int precision)
+{
+    const char* p = str;
+    int sign = 1;
+
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p == '-' || *p == '+') {
+        sign = (*p == '-') ? -1 : 1;
+        p++;
+    }
+
+    const char* digitsStart = p;
+    int digitCount = 0;
+    int fractionalDigits = 0;
+    bool hasPoint = false;
+    for (;; p++) {
+        if (*p >= '0' && *p <= '9') {
+            digitCount++;
+            fractionalDigits += hasPoint;
+        }
+        else if ((*p == '.' || *p == decimalSeparator) && !hasPoint) {
+            hasPoint = true;
+        }
+        else {
+            break;
+        }
+    }
+    const char* digitsEnd = p;
+    if (digitCount == 0) {
+        return STATUS_INVALID_INPUT;
+    }
+
+    int64_t exponent10 = 0;
+    if (*p == 'e' || *p == 'E') {
+        int exponentSign = 1;
+        p++;
+        if (*p == '-' || *p == '+') {
+            exponentSign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+        if (*p < '0' || *p > '9') {
+            return STATUS_INVALID_INPUT;
+        }
+        while (*p >= '0' && *p <= '9') {
+            if (exponent10 < 1000000000000LL) {
+                exponent10 = exponent10 * 10 + (*p - '0');
+            }
+            p++;
+        }
+        exponent10 *= exponentSign;
+    }
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p != '\0') {
+        return STATUS_INVALID_INPUT;
+    }
+    exponent10 -= fractionalDigits;
+
+    // value = digits * 10^exponent10 = digits * 10^padding * (10^9)^limbExponent
+    int64_t limbExponent = (exponent10 >= 0) ? exponent10 / BIG_LIMB_DIGITS
+                                             : -((-exponent10 + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS);
+    int padding = (int)(exponent10 - limbExponent * BIG_LIMB_DIGITS);
+    int totalDigits = digitCount + padding;
+    int length = (totalDigits + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS;
+
+    if (reserveLimbs(result, length) != STATUS_SUCCESS) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    uint32_t* limbs = BIG_DECIMAL_LIMBS(result);
+    memset(limbs, 0, (size_t)length * sizeof(uint32_t));
+
+    // Fill limbs from the least significant digit (the padding zeros) up
+    int position = padding;
+    for (const char* q = digitsEnd - 1; q >= digitsStart; q--) {
+        if (*q < '0' || *q > '9') {
+            continue;
+        }
+        limbs[position / BIG_LIMB_DIGITS] += (uint32_t)(*q - '0') * POWERS_OF_TEN[position % BIG_LIMB_DIGITS];
+        position++;
+    }
+
+    result->length = length;
+    result->exponent = limbExponent;
+    result->sign = sign;
+    return bigDecimalRound(result, precision);
+}
+
+/*
+ * bigDecimalFromDouble
+ *
+ * Converts through the shortest decimal text that reads back as the same
+ * double, so 0.1 becomes 0.1 rather than its exact binary expansion.
+ */
+int bigDecimalFromDouble(_bigDecimal* result, double value)
+{
+    char text[40];
+
+    if (!isfinite(value)) {
+        return STATUS_OVERFLOW;
+    }
+    formatDouble(text, sizeof(text), value, NUMBER_LAYOUT_SCIENTIFIC, FORMAT_SHORTEST, '.');
+    return bigDecimalFromString(result, text, '.', BIG_DECIMAL_EXACT);
+}
+
+/*
+ * multiplyByPower
+ *
+ * result *= base^exponent (exponent >= 0) by binary powering, rounding
+ * intermediate results to precision.
+ */
+static int multiplyByPower(_bigDecimal* result, uint32_t base, int64_t exponent, int precision)
+{
+    _bigDecimal power;
+    int status;
+
+    bigDecimalInit(&power);
+    status = setMagnitude(&power, base, 1);
+    while (status == STATUS_SUCCESS && exponent > 0) {
+        if (exponent & 1) {
+            status = bigDecimalMul(result, result, &power, precision);
+        }
+        exponent >>= 1;
+        if (status == STATUS_SUCCESS && exponent > 0) {
+            status = bigDecimalMul(&power, &power, &power, precision);
+        }
+    }
+    bigDecimalFree(&power);
+    return status;
+}
+
+/*
+ * scaleByPowerOfTwo
+ *
+ * result *= 2^exponent. Negative powers are applied as 5^n / 10^n, where
+ * the division by 10^n is a shift of the limb exponent, so the scaling is
+ * exact when precision is BIG_DECIMAL_EXACT.
+ */
+static int scaleByPowerOfTwo(_bigDecimal* result, int64_t exponent, int precision)
+{
+    int status = STATUS_SUCCESS;
+
+    if (exponent > 0) {
+        status = multiplyByPower(result, 2, exponent, precision);
+    }
+    else if (exponent < 0) {
+        int64_t n = -exponent;
+        int64_t limbShift = (n + BIG_LIMB_DIGITS - 1) / BIG_LIMB_DIGITS;
+        int padding = (int)(limbShift * BIG_LIMB_DIGITS - n);
+
+        status = multiplyByPower(result, 5, n, precision);
+        if (status == STATUS_SUCCESS && padding > 0) {
+            status = multiplyByPower(result, 10, padding, precision);
+        }
+        result->exponent -= limbShift;
+    }
+    return status;
+}
+
+/*
+ * bigDecimalFromExtendedFloat80
+ *
+ * Converts an 80-bit extended value: mantissa * 2^(exponent - 16383 - 63).
+ * Negative powers of two are applied as 5^n / 10^n so the conversion is
+ * exact whenever precision is BIG_DECIMAL_EXACT.
+ */
+int bigDecimalFromExtendedFloat80(_bigDecimal* result, const _extendedFloat80* value, int precision)
+{
+    uint64_t mantissa = ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+    int sign = (value->exponent & 0x8000) ? -1 : 1;
+    int64_t binaryExponent = (int64_t)(value->exponent & 0x7FFF) - 16383 - 63;
+    int status;
+
+    if ((value->exponent & 0x7FFF) == 0x7FFF) {
+        return STATUS_OVERFLOW;
+    }
+    if (mantissa == 0) {
+        bigDecimalSetZero(result);
+        return STATUS_SUCCESS;
+    }
+    if ((value->exponent & 0x7FFF) == 0) {
+        binaryExponent++; // Denormals use the minimum exponent
+    }
+
+    // Strip trailing zero bits to keep the powers small
+    while ((mantissa & 1) == 0) {
+        mantissa >>= 1;
+        binaryExponent++;
+    }
+
+    // Scale with guard digits so only the final rounding is visible
+    status = setMagnitude(result, mantissa, 1);
+    if (status == STATUS_SUCCESS) {
+        int working = (precision > BIG_DECIMAL_EXACT) ? precision + 2 * BIG_LIMB_DIGITS : BIG_DECIMAL_EXACT;
+        status = scaleByPowerOfTwo(result, binaryExponent, working);
+    }
+
+    result->sign = sign;
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalRound(result, precision);
+    }
+    return status;
+}
+
+/*
+ * bigDecimalToBinary
+ *
+ * Correctly rounded decimal to binary conversion: finds the mantissa and
+ * exponent with |value| ~= mantissa * 2^exponent, where mantissa is rounded
+ * half-to-even to 64 significant bits (bit 63 set), or to a multiple of
+ * 2^minimumExponent when the value is too small for that (denormals). The
+ * work is done exactly, so this is the slow path of the string parsers.
+ *
+ * @param value            The value to convert; its sign is ignored.
+ * @param minimumExponent  Smallest exponent that may be returned.
+ * @param mantissa         Receives the mantissa (0 when value is zero).
+ * @param exponent         Receives the binary exponent.
+ * @return                 STATUS_SUCCESS or STATUS_INSUFFICIENT_MEMORY.
+ */
+int bigDecimalToBinary(const _bigDecimal* value, int64_t minimumExponent, uint64_t* mantissa, int64_t* exponent)
+{
+    _bigDecimal work, bound, half;
+    uint32_t halfLimb = BIG_LIMB_BASE / 2;
+    int status;
+
+    *mantissa = 0;
+    *exponent = minimumExponent;
+    if (value->length == 0) {
+        return STATUS_SUCCESS;
+    }
+
+    // Estimate floor(log2|value|) from the leading limbs
+    _bigDecimal scaled = *value;
+    int64_t top = value->exponent + value->length;
+    scaled.sign = 1;
+    scaled.exponent -= top;
+    double log2Value = log2(bigDecimalToDouble(&scaled)) + (double)top * BIG_LIMB_DIGITS * 3.321928094887362;
+    int64_t binaryExponent = (int64_t)floor(log2Value) - 63;
+    if (binaryExponent < minimumExponent) {
+        binaryExponent = minimumExponent;
+    }
+
+    half = (_bigDecimal){ .limbs = &halfLimb, .length = 1, .capacity = 1, .exponent = -1, .sign = 1 };
+    bigDecimalInit(&work);
+    bigDecimalInit(&bound);
+    status = bigDecimalCopy(&work, value);
+    work.sign = 1;
+    if (status == STATUS_SUCCESS) {
+        status = scaleByPowerOfTwo(&work, -binaryExponent, BIG_DECIMAL_EXACT);
+    }
+
+    // Correct the estimate until 2^63 <= work < 2^64 (or the exponent floor)
+    while (status == STATUS_SUCCESS) {
+        status = setMagnitude(&bound, 1ull << 63, 1);
+        if (status == STATUS_SUCCESS && bigDecimalCompare(&work, &bound) < 0 && binaryExponent > minimumExponent) {
+            status = bigDecimalAdd(&work, &work, &work, BIG_DECIMAL_EXACT);
+            binaryExponent--;
+            continue;
+        }
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalAdd(&bound, &bound, &bound, BIG_DECIMAL_EXACT);
+        }
+        if (status == STATUS_SUCCESS && bigDecimalCompare(&work, &bound) >= 0) {
+            status = bigDecimalMul(&work, &work, &half, BIG_DECIMAL_EXACT);
+            binaryExponent++;
+            continue;
+        }
+        break;
+    }
+
+    if (status == STATUS_SUCCESS) {
+        // Split work (< 2^64 < 10^27) into its integer and fraction limbs
+        uint64_t integer = 0;
+        uint32_t fractionTop = 0;
+        bool hasSticky = false;
+        const uint32_t* workLimbs = BIG_DECIMAL_LIMBS(&work);
+
+        for (int i = work.length - 1; i >= 0; i--) {
+            int64_t position = work.exponent + i;
+            if (position >= 0) {
+                uint64_t limbValue = workLimbs[i];
+                for (int64_t k = 0; k < position; k++) {
+                    limbValue *= BIG_LIMB_BASE;
+                }
+                integer += limbValue;
+            }
+            else if (position == -1) {
+                fractionTop = workLimbs[i];
+            }
+            else if (workLimbs[i] != 0) {
+                hasSticky = true;
+            }
+        }
+
+        if (fractionTop > halfLimb || (fractionTop == halfLimb && (hasSticky || (integer & 1)))) {
+            integer++;
+            if (integer == 0) {
+                integer = 1ull << 63;
+                binaryExponent++;
+            }
+        }
+        *mantissa = integer;
+        *exponent = binaryExponent;
+    }
+
+    bigDecimalFree(&work);
+    bigDecimalFree(&bound);
+    return status;
+}
+
+/*
+ * bigDecimalToDouble
+ *
+ * Converts through the leading 27 digits, which is always enough for a
+ * correctly rounded double. Values outside the double range become
+ * +/-HUGE_VAL or 0.
+ */
+double bigDecimalToDouble(const _bigDecimal* value)
+{
+    char text[64];
+    int count = 0;
+    int used = 0;
+
+    if (value->length == 0) {
+        return 0.0;
+    }
+    if (value->sign < 0) {
+        text[count++] = '-';
+    }
+    for (int i = value->length - 1; i >= 0 && used < 3; i--, used++) {
+        count += snprintf(text + count, sizeof(text) - count, (used == 0) ? "%u" : "%09u", BIG_DECIMAL_LIMBS(value)[i]);
+    }
+    int64_t exponent10 = (value->exponent + value->length - used) * BIG_LIMB_DIGITS;
+    snprintf(text + count, sizeof(text) - count, "e%lld", (long long)exponent10);
+    return strtod(text, NULL);
+}
+
+/*
+ * bigDecimalToString
+ *
+ * Writes the value with all its significant digits, in plain notation
+ * when the decimal exponent is between -7 and 20 (or the value has no
+ * trailing zeros before the point) and in d.ddde+N notation otherwise.
+ * Works like snprintf: returns the length the full text needs, writes at
+ * most bufferSize-1 characters and always terminates the buffer.
+ */
+size_t bigDecimalToString(const _bigDecimal* value, char* buffer, size_t bufferSize, char decimalSeparator)
+{
+    size_t length = 0;
+
+#define PUT_CHAR(c) do { if (length + 1 < bufferSize) buffer[length] = (c); length++; } while (0)
+
+    if (value->length == 0) {
+        PUT_CHAR('0');
+        if (bufferSize > 0) buffer[(length < bufferSize) ? length : bufferSize - 1] = '\0';
+        return length;
+    }
+
+    // The digits of a value with inline limbs fit on the stack
+    char inlineDigits[BIG_DECIMAL_INLINE_LIMBS * BIG_LIMB_DIGITS + 1];
+    const uint32_t* limbs = BIG_DECIMAL_LIMBS(value);
+    int digitCount = bigDecimalDigitCount(value);
+    char* digits = ((size_t)digitCount < sizeof(inlineDigits)) ? inlineDigits
+                                                               : allocateMemoryFromHeap((size_t)digitCount + 1);
+    if (digits == NULL) {
+        if (bufferSize > 0) buffer[0] = '\0';
+        return 0;
+    }
+    int written = snprintf(digits, (size_t)digitCount + 1, "%u", limbs[value->length - 1]);
+    for (int i = value->length - 2; i >= 0; i--) {
+        written += snprintf(digits + written, (size_t)digitCount + 1 - written, "%09u", limbs[i]);
+    }
+
+    // digits * 10^power; drop the trailing zeros of the last limb
+    int64_t power = value->exponent * BIG_LIMB_DIGITS;
+    while (digitCount > 1 && digits[digitCount - 1] == '0') {
+        digitCount--;
+        power++;
+    }
+    int64_t adjusted = digitCount - 1 + power;
+
+    if (value->sign < 0) {
+        PUT_CHAR('-');
+    }
+    if (adjusted >= -7 && (adjusted < 21 || power <= 0)) {
+        if (adjusted < 0) {
+            PUT_CHAR('0');
+            PUT_CHAR(decimalSeparator);
+            for (int64_t i = -1; i > adjusted; i--) {
+                PUT_CHAR('0');
+            }
+            for (int i = 0; i < digitCount; i++) {
+                PUT_CHAR(digits[i]);
+            }
+        }
+        else {
+            for (int64_t i = 0; i <= adjusted || i < digitCount; i++) {
+                if (i == adjusted + 1) {
+                    PUT_CHAR(decimalSeparator);
+                }
+                PUT_CHAR((i < digitCount) ? digits[i] : '0');
+            }
+        }
+    }
+    else {
+        char exponentText[24];
+        PUT_CHAR(digits[0]);
+        if (digitCount > 1) {
+            PUT_CHAR(decimalSeparator);
+            for (int i = 1; i < digitCount; i++) {
+                PUT_CHAR(digits[i]);
+            }
+        }
+        snprintf(exponentText, sizeof(exponentText), "e%+lld", (long long)adjusted);
+        for (const char* e = exponentText; *e != '\0'; e++) {
+            PUT_CHAR(*e);
+        }
+    }
+
+#undef PUT_CHAR
+
+    if (bufferSize > 0) {
+        buffer[(length < bufferSize) ? length : bufferSize - 1] = '\0';
+    }
+    if (digits != inlineDigits) {
+        freeMemoryToHeap(digits);
+    }
+    return length;
+}
@@ -0,0 +1,622 @@
+/*-----------------------------------------------------------------------------
+    bitwise.c --  Bit operations on integers of any width (reconstructed
+                  code).
+
+               And, Or, Xor, Not, the shifts and rotations, the counts of
+               set bits and of leading and trailing zeros, and the
+               reversal of the bit order, on integers of thousands of bits
+               and on batches of them (see bitwise.h). The programmer
+               mode uses them for its word sizes; bitmask and hash tables
+               can pass a whole batch in one call.
+
+               Every operation is a few kernels that work on whole words
+               (a shift by s bits is one pass that joins the two source
+               words each result word straddles), in three sets:
+
+               - AVX2: four words per instruction, the set bits counted
+                 with a nibble lookup in VPSHUFB and summed with VPSADBW,
+                 the zero words skipped four at a time before LZCNT or
+                 TZCNT finds the first one that is not, and the bits
+                 reversed with nibble lookups and byte shuffles.
+               - SSE: two words per SSE2 instruction, and POPCNT.
+               - Portable C, for other processors and compilers.
+
+               The widest set the processor has is chosen at each call,
+               as in statistics.c; they all give the same bits.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <string.h>
+#include ".//headers//bitwise.h"
+#include ".//headers//wideint.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define BITWISE_X86 1   // SSE2 is part of every x86-64 processor; the rest is checked
+#endif
+
+#define AVX2_MIN_COUNT_WORDS 16  // Shorter integers count their bits with POPCNT alone
+
+bool bitwiseUseSimd = true;
+
+typedef struct {
+    void (*logic)(_bitwiseLogic operation, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t words);
+    void (*shiftUp)(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged);
+    void (*shiftDown)(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged);
+    size_t (*countOnes)(const uint64_t* a, size_t words);
+    size_t (*countLeadingZeros)(const uint64_t* a, size_t words);
+    size_t (*countTrailingZeros)(const uint64_t* a, size_t words);
+    void (*reverse)(uint64_t* r, const uint64_t* a, size_t words);
+} _bitwiseKernels;
+
+/*
+ * logicPortable
+ *
+ * r = a op b over words words; r may be a or b.
+ */
+static void logicPortable(_bitwiseLogic operation, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t words)
+{
+    switch (operation) {
+    case BITWISE_AND:
+        for (size_t i = 0; i < words; i++) {
+            r[i] = a[i] & b[i];
+        }
+        break;
+    case BITWISE_OR:
+        for (size_t i = 0; i < words; i++) {
+            r[i] = a[i] | b[i];
+        }
+        break;
+    case BITWISE_XOR:
+        for (size_t i = 0; i < words; i++) {
+            r[i] = a[i] ^ b[i];
+        }
+        break;
+    default:
+        for (size_t i = 0; i < words; i++) {
+            r[i] = ~a[i];
+        }
+        break;
+    }
+}
+
+/*
+ * shiftUpRange
+ *
+ * Words from to to-1 of a << (wordShift * 64 + bitShift), or'ed into r
+ * if isMerged.
+ */
+static void shiftUpRange(uint64_t* r, const uint64_t* a, size_t from, size_t to, size_t wordShift,
+    unsigned bitShift, bool isMerged)
+{
+    for (size_t i = from; i < to; i++) {
+        uint64_t word = 0;
+        if (i >= wordShift) {
+            word = a[i - wordShift] << bitShift;
+            if (bitShift != 0 && i > wordShift) {
+                word |= a[i - wordShift - 1] >> (64 - bitShift);
+            }
+        }
+        r[i] = isMerged ? r[i] | word : word;
+    }
+}
+
+/*
+ * shiftDownRange
+ *
+ * Words from to to-1 of a >> (wordShift * 64 + bitShift), or'ed into r
+ * if isMerged. Word i reads only words i and up, so r may be a.
+ */
+static void shiftDownRange(uint64_t* r, const uint64_t* a, size_t from, size_t to, size_t words, size_t wordShift,
+    unsigned bitShift, bool isMerged)
+{
+    for (size_t i = from; i < to; i++) {
+        uint64_t word = 0;
+        if (i + wordShift < words) {
+            word = a[i + wordShift] >> bitShift;
+            if (bitShift != 0 && i + wordShift + 1 < words) {
+                word |= a[i + wordShift + 1] << (64 - bitShift);
+            }
+        }
+        r[i] = isMerged ? r[i] | word : word;
+    }
+}
+
+static void shiftUpPortable(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    shiftUpRange(r, a, 0, words, shift / 64, (unsigned)(shift % 64), isMerged);
+}
+
+static void shiftDownPortable(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    shiftDownRange(r, a, 0, words, words, shift / 64, (unsigned)(shift % 64), isMerged);
+}
+
+static size_t countOnesPortable(const uint64_t* a, size_t words)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < words; i++) {
+        count += (size_t)countBits64(a[i]);
+    }
+    return count;
+}
+
+// Leading zeros of all words * 64 bits
+static size_t countLeadingZerosPortable(const uint64_t* a, size_t words)
+{
+    for (size_t i = words; i-- > 0;) {
+        if (a[i] != 0) {
+            return (words - 1 - i) * 64 + (size_t)countLeadingZeros64(a[i]);
+        }
+    }
+    return words * 64;
+}
+
+static size_t countTrailingZerosPortable(const uint64_t* a, size_t words)
+{
+    for (size_t i = 0; i < words; i++) {
+        if (a[i] != 0) {
+            return i * 64 + (size_t)countTrailingZeros64(a[i]);
+        }
+    }
+    return words * 64;
+}
+
+// All words * 64 bits in reverse order; r must not overlap a
+static void reversePortable(uint64_t* r, const uint64_t* a, size_t words)
+{
+    for (size_t i = 0; i < words; i++) {
+        r[i] = reverseBits64(a[words - 1 - i]);
+    }
+}
+
+static const _bitwiseKernels PORTABLE_KERNELS = {
+    logicPortable, shiftUpPortable, shiftDownPortable, countOnesPortable, countLeadingZerosPortable,
+    countTrailingZerosPortable, reversePortable
+};
+
+#if BITWISE_X86
+/*
+ * logicSse
+ *
+ * logicPortable two words at a time.
+ */
+static void logicSse(_bitwiseLogic operation, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t words)
+{
+    __m128i ones = _mm_set1_epi32(-1);
+    size_t i;
+
+    for (i = 0; i + 2 <= words; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = (operation == BITWISE_NOT) ? ones : _mm_loadu_si128((const __m128i*)(b + i));
+        switch (operation) {
+        case BITWISE_AND: x = _mm_and_si128(x, y); break;
+        case BITWISE_OR:  x = _mm_or_si128(x, y);  break;
+        default:          x = _mm_xor_si128(x, y); break;  // Not is Xor with ones
+        }
+        _mm_storeu_si128((__m128i*)(r + i), x);
+    }
+    logicPortable(operation, r + i, a + i, (operation == BITWISE_NOT) ? NULL : b + i, words - i);
+}
+
+/*
+ * shiftUpSse
+ *
+ * Each pair of result words joins the two pairs of source words below
+ * it. A shift by 64 bits or more gives 0 in SSE2, so whole-word shifts
+ * need no special case.
+ */
+static void shiftUpSse(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    size_t wordShift = shift / 64;
+    unsigned bitShift = (unsigned)(shift % 64);
+    __m128i count = _mm_cvtsi32_si128((int)bitShift);
+    __m128i inverse = _mm_cvtsi32_si128(64 - (int)bitShift);
+    size_t i = (wordShift + 1 < words) ? wordShift + 1 : words;
+
+    shiftUpRange(r, a, 0, i, wordShift, bitShift, isMerged);
+    for (; i + 2 <= words; i += 2) {
+        __m128i high = _mm_loadu_si128((const __m128i*)(a + i - wordShift));
+        __m128i low = _mm_loadu_si128((const __m128i*)(a + i - wordShift - 1));
+        __m128i word = _mm_or_si128(_mm_sll_epi64(high, count), _mm_srl_epi64(low, inverse));
+        if (isMerged) {
+            word = _mm_or_si128(word, _mm_loadu_si128((const __m128i*)(r + i)));
+        }
+        _mm_storeu_si128((__m128i*)(r + i), word);
+    }
+    shiftUpRange(r, a, i, words, wordShift, bitShift, isMerged);
+}
+
+static void shiftDownSse(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    size_t wordShift = shift / 64;
+    unsigned bitShift = (unsigned)(shift % 64);
+    __m128i count = _mm_cvtsi32_si128((int)bitShift);
+    __m128i inverse = _mm_cvtsi32_si128(64 - (int)bitShift);
+    size_t end = (words > wordShift + 1) ? words - wordShift - 1 : 0;  // Words with both sources
+    size_t i;
+
+    for (i = 0; i + 2 <= end; i += 2) {
+        __m128i low = _mm_loadu_si128((const __m128i*)(a + i + wordShift));
+        __m128i high = _mm_loadu_si128((const __m128i*)(a + i + wordShift + 1));
+        __m128i word = _mm_or_si128(_mm_srl_epi64(low, count), _mm_sll_epi64(high, inverse));
+        if (isMerged) {
+            word = _mm_or_si128(word, _mm_loadu_si128((const __m128i*)(r + i)));
+        }
+        _mm_storeu_si128((__m128i*)(r + i), word);
+    }
+    shiftDownRange(r, a, i, words, words, wordShift, bitShift, isMerged);
+}
+
+__attribute__((target("popcnt")))
+static size_t countOnesPopcnt(const uint64_t* a, size_t words)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < words; i++) {
+        count += (size_t)__builtin_popcountll(a[i]);
+    }
+    return count;
+}
+
+static const _bitwiseKernels SSE_KERNELS = {
+    logicSse, shiftUpSse, shiftDownSse, countOnesPopcnt, countLeadingZerosPortable, countTrailingZerosPortable,
+    reversePortable
+};
+
+/*
+ * logicAvx2
+ *
+ * logicPortable four words at a time.
+ */
+__attribute__((target("avx2")))
+static void logicAvx2(_bitwiseLogic operation, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t words)
+{
+    __m256i ones = _mm256_set1_epi32(-1);
+    size_t i;
+
+    for (i = 0; i + 4 <= words; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = (operation == BITWISE_NOT) ? ones : _mm256_loadu_si256((const __m256i*)(b + i));
+        switch (operation) {
+        case BITWISE_AND: x = _mm256_and_si256(x, y); break;
+        case BITWISE_OR:  x = _mm256_or_si256(x, y);  break;
+        default:          x = _mm256_xor_si256(x, y); break;
+        }
+        _mm256_storeu_si256((__m256i*)(r + i), x);
+    }
+    logicPortable(operation, r + i, a + i, (operation == BITWISE_NOT) ? NULL : b + i, words - i);
+}
+
+/*
+ * shiftUpAvx2
+ *
+ * shiftUpSse four words at a time.
+ */
+__attribute__((target("avx2")))
+static void shiftUpAvx2(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    size_t wordShift = shift / 64;
+    unsigned bitShift = (unsigned)(shift % 64);
+    __m128i count = _mm_cvtsi32_si128((int)bitShift);
+    __m128i inverse = _mm_cvtsi32_si128(64 - (int)bitShift);
+    size_t i = (wordShift + 1 < words) ? wordShift + 1 : words;
+
+    shiftUpRange(r, a, 0, i, wordShift, bitShift, isMerged);
+    for (; i + 4 <= words; i += 4) {
+        __m256i high = _mm256_loadu_si256((const __m256i*)(a + i - wordShift));
+        __m256i low = _mm256_loadu_si256((const __m256i*)(a + i - wordShift - 1));
+        __m256i word = _mm256_or_si256(_mm256_sll_epi64(high, count), _mm256_srl_epi64(low, inverse));
+        if (isMerged) {
+            word = _mm256_or_si256(word, _mm256_loadu_si256((const __m256i*)(r + i)));
+        }
+        _mm256_storeu_si256((__m256i*)(r + i), word);
+    }
+    shiftUpRange(r, a, i, words, wordShift, bitShift, isMerged);
+}
+
+__attribute__((target("avx2")))
+static void shiftDownAvx2(uint64_t* r, const uint64_t* a, size_t shift, size_t words, bool isMerged)
+{
+    size_t wordShift = shift / 64;
+    unsigned bitShift = (unsigned)(shift % 64);
+    __m128i count = _mm_cvtsi32_si128((int)bitShift);
+    __m128i inverse = _mm_cvtsi32_si128(64 - (int)bitShift);
+    size_t end = (words > wordShift + 1) ? words - wordShift - 1 : 0;
+    size_t i;
+
+    for (i = 0; i + 4 <= end; i += 4) {
+        __m256i low = _mm256_loadu_si256((const __m256i*)(a + i + wordShift));
+        __m256i high = _mm256_loadu_si256((const __m256i*)(a + i + wordShift + 1));
+        __m256i word = _mm256_or_si256(_mm256_srl_epi64(low, count), _mm256_sll_epi64(high, inverse));
+        if (isMerged) {
+            word = _mm256_or_si256(word, _mm256_loadu_si256((const __m256i*)(r + i)));
+        }
+        _mm256_storeu_si256((__m256i*)(r + i), word);
+    }
+    shiftDownRange(r, a, i, words, words, wordShift, bitShift, isMerged);
+}
+
+/*
+ * countOnesAvx2
+ *
+ * Looks up the set bits of each nibble in a 16-entry table (VPSHUFB),
+ * adds the two nibbles of every byte and sums the bytes of each word
+ * (VPSADBW) into four 64-bit counters.
+ */
+__attribute__((target("avx2,popcnt")))
+static size_t countOnesAvx2(const uint64_t* a, size_t words)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i counts = _mm256_setzero_si256();
+    uint64_t lanes[4];
+    size_t i;
+
+    if (words < AVX2_MIN_COUNT_WORDS) {
+        return countOnesPopcnt(a, words);
+    }
+    for (i = 0; i + 4 <= words; i += 4) {
+        __m256i word = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(word, nibble));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(word, 4), nibble));
+        counts = _mm256_add_epi64(counts, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, counts);
+    return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + countOnesPopcnt(a + i, words - i);
+}
+
+// Mask of the words of a vector that are 0
+__attribute__((target("avx2")))
+static inline unsigned getZeroWords(__m256i word)
+{
+    return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(word, _mm256_setzero_si256())));
+}
+
+/*
+ * countLeadingZerosAvx2
+ *
+ * Skips the zero words at the top four at a time; in the first vector
+ * that is not all 0, LZCNT of the mask of its zero words finds the top
+ * word that is not, without a branch per word. A top word that is not 0
+ * is the common case, and needs no vector.
+ */
+__attribute__((target("avx2,lzcnt")))
+static size_t countLeadingZerosAvx2(const uint64_t* a, size_t words)
+{
+    size_t i = words;
+
+    if (i > 0 && a[i - 1] != 0) {
+        return (size_t)_lzcnt_u64(a[i - 1]);
+    }
+    for (; i >= 4; i -= 4) {
+        unsigned zeros = getZeroWords(_mm256_loadu_si256((const __m256i*)(a + i - 4)));
+        if (zeros != 0xF) {
+            size_t top = i - 4 + 31 - _lzcnt_u32(~zeros & 0xF);
+            return (words - 1 - top) * 64 + (size_t)_lzcnt_u64(a[top]);
+        }
+    }
+    while (i > 0 && a[i - 1] == 0) {
+        i--;
+    }
+    return (i == 0) ? words * 64 : (words - i) * 64 + (size_t)_lzcnt_u64(a[i - 1]);
+}
+
+__attribute__((target("avx2,bmi")))
+static size_t countTrailingZerosAvx2(const uint64_t* a, size_t words)
+{
+    size_t i = 0;
+
+    if (words > 0 && a[0] != 0) {
+        return (size_t)_tzcnt_u64(a[0]);
+    }
+    for (; i + 4 <= words; i += 4) {
+        unsigned zeros = getZeroWords(_mm256_loadu_si256((const __m256i*)(a + i)));
+        if (zeros != 0xF) {
+            size_t bottom = i + _tzcnt_u32(~zeros);
+            return bottom * 64 + (size_t)_tzcnt_u64(a[bottom]);
+        }
+    }
+    while (i < words && a[i] == 0) {
+        i++;
+    }
+    return (i == words) ? words * 64 : i * 64 + (size_t)_tzcnt_u64(a[i]);
+}
+
+/*
+ * reverseAvx2
+ *
+ * Reverses the bits of every byte with two nibble lookups, the bytes of
+ * every word with a shuffle, and the four words with a permutation.
+ */
+__attribute__((target("avx2")))
+static void reverseAvx2(uint64_t* r, const uint64_t* a, size_t words)
+{
+    const __m256i table = _mm256_setr_epi8(0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15,
+                                           0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15);
+    const __m256i bytes = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t i;
+
+    for (i = 0; i + 4 <= words; i += 4) {
+        __m256i word = _mm256_loadu_si256((const __m256i*)(a + words - 4 - i));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(word, nibble));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(word, 4), nibble));
+        word = _mm256_or_si256(_mm256_slli_epi16(low, 4), high);
+        word = _mm256_shuffle_epi8(word, bytes);
+        _mm256_storeu_si256((__m256i*)(r + i), _mm256_permute4x64_epi64(word, 0x1B));
+    }
+    for (; i < words; i++) {
+        r[i] = reverseBits64(a[words - 1 - i]);
+    }
+}
+
+static const _bitwiseKernels AVX2_KERNELS = {
+    logicAvx2, shiftUpAvx2, shiftDownAvx2, countOnesAvx2, countLeadingZerosAvx2, countTrailingZerosAvx2,
+    reverseAvx2
+};
+#endif
+
+/*
+ * getKernels
+ *
+ * The widest kernel set the processor supports. Every AVX2 processor has
+ * POPCNT, LZCNT and TZCNT too, but they are checked all the same.
+ */
+static const _bitwiseKernels* getKernels(void)
+{
+#if BITWISE_X86
+    if (bitwiseUseSimd && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") &&
+        __builtin_cpu_supports("lzcnt") && __builtin_cpu_supports("bmi")) {
+        return &AVX2_KERNELS;
+    }
+    if (bitwiseUseSimd && __builtin_cpu_supports("popcnt")) {
+        return &SSE_KERNELS;
+    }
+#endif
+    return &PORTABLE_KERNELS;
+}
+
+// Clears the bits above the width in the top word of a value
+static void clearUnusedBits(uint64_t* value, size_t bits)
+{
+    if (bits % 64 != 0) {
+        value[bits / 64] &= (UINT64_C(1) << (bits % 64)) - 1;
+    }
+}
+
+// Sets bits from to to-1
+static void setBitRange(uint64_t* value, size_t from, size_t to)
+{
+    for (size_t bit = from; bit < to;) {
+        size_t word = bit / 64;
+        size_t end = (to < (word + 1) * 64) ? to : (word + 1) * 64;
+        uint64_t mask = (end - bit == 64) ? UINT64_MAX : ((UINT64_C(1) << (end - bit)) - 1) << (bit % 64);
+        value[word] |= mask;
+        bit = end;
+    }
+}
+
+/*
+ * bitwiseLogic
+ *
+ * result = a op b for each of count integers of bits bits; BITWISE_NOT
+ * reads a alone. result may be a or b.
+ */
+void bitwiseLogic(_bitwiseLogic operation, uint64_t* result, const uint64_t* a, const uint64_t* b, size_t bits,
+    size_t count)
+{
+    size_t words = BITWISE_WORDS(bits);
+
+    // The integers of a batch are one run of words, done in a single pass
+    getKernels()->logic(operation, result, a, b, words * count);
+    if (operation == BITWISE_NOT && bits % 64 != 0) {
+        for (size_t i = 0; i < count; i++) {
+            clearUnusedBits(result + i * words, bits);
+        }
+    }
+}
+
+/*
+ * bitwiseShift
+ *
+ * Shifts or rotates each of count integers of bits bits by shift bits.
+ * A shift by bits or more gives 0, or -1 for a negative integer shifted
+ * right arithmetically; a rotation by shift is one by shift % bits.
+ * result must not overlap a.
+ */
+void bitwiseShift(_bitwiseShift operation, uint64_t* result, const uint64_t* a, size_t shift, size_t bits,
+    size_t count)
+{
+    const _bitwiseKernels* kernels = getKernels();
+    size_t words = BITWISE_WORDS(bits);
+
+    if (bits == 0) {
+        return;
+    }
+    if (operation == BITWISE_ROTATE_RIGHT) {
+        operation = BITWISE_ROTATE_LEFT;
+        shift = bits - shift % bits;
+    }
+    if (operation == BITWISE_ROTATE_LEFT) {
+        shift %= bits;
+    }
+
+    for (size_t i = 0; i < count; i++, result += words, a += words) {
+        bool isNegative = ((a[(bits - 1) / 64] >> ((bits - 1) % 64)) & 1) != 0;
+
+        if (shift >= bits) {
+            memset(result, 0, words * sizeof(uint64_t));
+        }
+        else if (operation == BITWISE_SHIFT_LEFT || operation == BITWISE_ROTATE_LEFT) {
+            kernels->shiftUp(result, a, shift, words, false);
+            clearUnusedBits(result, bits);
+        }
+        else {
+            kernels->shiftDown(result, a, shift, words, false);
+        }
+
+        // The bits shifted out at the top come back at the bottom
+        if (operation == BITWISE_ROTATE_LEFT && shift != 0) {
+            kernels->shiftDown(result, a, bits - shift, words, true);
+        }
+        if (operation == BITWISE_SHIFT_RIGHT_ARITHMETIC && isNegative) {
+            setBitRange(result, (shift < bits) ? bits - shift : 0, bits);
+        }
+    }
+}
+
+/*
+ * bitwiseCount
+ *
+ * Stores in counts[i] the set bits, leading zeros or trailing zeros of
+ * integer i of count integers of bits bits. An integer of 0 has bits
+ * leading and trailing zeros.
+ */
+void bitwiseCount(_bitwiseCount operation, size_t* counts, const uint64_t* a, size_t bits, size_t count)
+{
+    const _bitwiseKernels* kernels = getKernels();
+    size_t words = BITWISE_WORDS(bits);
+
+    for (size_t i = 0; i < count; i++, a += words) {
+        switch (operation) {
+        case BITWISE_COUNT_ONES:
+            counts[i] = kernels->countOnes(a, words);
+            break;
+        case BITWISE_COUNT_LEADING_ZEROS:
+            counts[i] = kernels->countLeadingZeros(a, words) - (words * 64 - bits);
+            break;
+        default: {
+            size_t zeros = kernels->countTrailingZeros(a, words);
+            counts[i] = (zeros < bits) ? zeros : bits;
+            break;
+        }
+        }
+    }
+}
+
+/*
+ * bitwiseReverse
+ *
+ * Reverses the order of the bits of each of count integers of bits bits:
+ * bit 0 becomes bit bits-1. result must not overlap a.
+ */
+void bitwiseReverse(uint64_t* result, const uint64_t* a, size_t bits, size_t count)
+{
+    const _bitwiseKernels* kernels = getKernels();
+    size_t words = BITWISE_WORDS(bits);
+
+    for (size_t i = 0; i < count; i++, result += words, a += words) {
+        kernels->reverse(result, a, words);
+        if (bits % 64 != 0) {
+            // The unused top bits were reversed to the bottom
+            kernels->shiftDown(result, result, words * 64 - bits, words, false);
+        }
+    }
+}
@@ -0,0 +1,660 @@
+/*-----------------------------------------------------------------------------
+    dataload.c --  Bulk loader of statistics data points (reconstructed
+                   code).
+
+               The LOAD key of the statistics box reads numbers one at a
+               time through valueFromString, which is fine for a clipboard
+               but not for measurement files of several gigabytes. This
+               module parses such files at memory speed:
+
+               - The text is cut into one chunk per thread, each boundary
+                 moved to the next line break, and the chunks are parsed
+                 in parallel with C11 threads (one thread where the
+                 compiler has no <threads.h>). Each thread collects its
+                 points in a buffer of its own, and a quantile sketch of
+                 them (and the regression rows of the line, when x
+                 columns are wanted); the buffers are appended to the
+                 _statistics in text order with statisticsAppend, which
+                 merges the sketches, and the regressions are merged
+                 after them.
+               - Lines are found with memchr, which the C library already
+                 vectorizes.
+               - Digits are read eight at a time as one 64-bit word: a
+                 SWAR test checks that all eight bytes are digits, and
+                 three multiplications combine them. The first 19
+                 significant digits go into an integer mantissa.
+               - Mantissas up to 2^53 with a decimal exponent of at most
+                 22 convert exactly with one multiplication or division by
+                 a power of ten, which is correctly rounded. Other numbers
+                 are handed to strtod, which also rounds correctly.
+
+               Key functions include:
+
+               - dataLoadText: Parse text already in memory.
+               - dataLoadFile: Map a file (mmap where there is one) and
+                               parse it.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // madvise under a strict -std=c11
+#endif
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include ".//headers//dataload.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define DATA_LOAD_THREADS 1
+#else
+#define DATA_LOAD_THREADS 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DATA_LOAD_MMAP 1
+#else
+#define DATA_LOAD_MMAP 0
+#endif
+
+// Eight digits per word needs the first character in the low byte
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define DATA_LOAD_SWAR 1
+#else
+#define DATA_LOAD_SWAR 0
+#endif
+
+#define MIN_CHUNK_BYTES (1u << 20)   // Smaller texts are not worth another thread
+#define MAX_LOAD_THREADS 64
+#define MAX_MANTISSA_DIGITS 19       // Significant digits that fit a uint64_t
+#define MAX_EXACT_POWER 22           // 10^22 is the largest power of ten that is a double
+#define MAX_NUMBER_LENGTH 128        // Longest number handed to strtod
+#define MAX_EXPONENT 100000          // Exponents are clamped here; the result is 0 or inf anyway
+#define MAX_SCANNED_LINES 100        // Lines dataLoadCountColumns looks at for one of numbers
+
+static const double POWERS_OF_TEN[MAX_EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// One chunk of the text and the points parsed from it
+typedef struct {
+    const char* begin;
+    const char* end;
+    const _dataLoadOptions* options;
+    double* points;
+    size_t count;
+    size_t capacity;
+    size_t rows;
+    size_t skippedLines;
+    _quantileSketch quantiles;
+    bool isSketched;               // quantiles holds every point of the chunk
+    _regression regression;        // Rows of the points, indexed from the first of the chunk
+    int status;
+} _loadChunk;
+
+// Digits of a number, read into an integer mantissa
+typedef struct {
+    uint64_t mantissa;
+    int significant;   // Digits of mantissa from the first nonzero one
+    bool isTruncated;  // A nonzero digit did not fit in mantissa
+} _digitScan;
+
+/*
+ * getSeconds
+ */
+static double getSeconds(void)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/*
+ * isDelimiter
+ *
+ * Whether c ends a field. A comma that is the decimal separator does not.
+ */
+static bool isDelimiter(char c, char decimalSeparator)
+{
+    return (c == ',' || c == ';' || c == '\t') && c != decimalSeparator;
+}
+
+#if DATA_LOAD_SWAR
+/*
+ * isEightDigits
+ *
+ * Whether every byte of word is '0'..'9': the high nibbles must all be 3,
+ * and adding 6 must not carry into them.
+ */
+static bool isEightDigits(uint64_t word)
+{
+    return ((word & 0xF0F0F0F0F0F0F0F0ull) |
+               (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+/*
+ * parseEightDigits
+ *
+ * Value of eight digits, the first in the low byte: pairs, then groups of
+ * four, then all eight are combined in three multiplications.
+ */
+static uint32_t parseEightDigits(uint64_t word)
+{
+    word -= 0x3030303030303030ull;
+    word = (word * 10) + (word >> 8);
+    word = (((word & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+               (((word >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return (uint32_t)word;
+}
+#endif
+
+/*
+ * scanDigits
+ *
+ * Reads a run of digits into scan. Digits past the 19th significant one
+ * are not kept.
+ *
+ * @param kept  Receives the number of digits appended to the mantissa.
+ * @return      The character after the digits.
+ */
+static const char* scanDigits(const char* p, const char* end, _digitScan* scan, int* kept)
+{
+    *kept = 0;
+
+#if DATA_LOAD_SWAR
+    while (end - p >= 8 && scan->significant + 8 <= MAX_MANTISSA_DIGITS) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        if (!isEightDigits(word)) {
+            break;
+        }
+        bool wasZero = (scan->mantissa == 0);
+        scan->mantissa = scan->mantissa * 100000000u + parseEightDigits(word);
+        if (wasZero) {
+            for (uint64_t rest = scan->mantissa; rest != 0; rest /= 10) {
+                scan->significant++;
+            }
+        }
+        else {
+            scan->significant += 8;
+        }
+        *kept += 8;
+        p += 8;
+    }
+#endif
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (scan->significant < MAX_MANTISSA_DIGITS) {
+            scan->mantissa = scan->mantissa * 10 + (uint64_t)(*p - '0');
+            scan->significant += (scan->mantissa != 0);
+            (*kept)++;
+        }
+        else if (*p != '0') {
+            scan->isTruncated = true;
+        }
+    }
+    return p;
+}
+
+/*
+ * convertSlowly
+ *
+ * strtod on a copy of the number with '.' as the decimal point.
+ */
+static bool convertSlowly(const char* start, const char* end, char decimalSeparator, double* result)
+{
+    char buffer[MAX_NUMBER_LENGTH];
+    size_t length = (size_t)(end - start);
+    char* stop;
+
+    if (length >= sizeof(buffer)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = (start[i] == decimalSeparator) ? '.' : start[i];
+    }
+    buffer[length] = '\0';
+    *result = strtod(buffer, &stop);
+    return stop == buffer + length;
+}
+
+/*
+ * parseNumber
+ *
+ * Parses [+-]digits[.digits][(e|E)[+-]digits] at p, with at least one
+ * digit before the exponent.
+ *
+ * @return  The character after the number, or NULL if there is none or
+ *          it is not finite.
+ */
+static const char* parseNumber(const char* p, const char* end, char decimalSeparator, double* result)
+{
+    const char* start = p;
+    _digitScan scan = { 0, 0, false };
+    bool isNegative = false;
+    int integerKept, fractionKept = 0;
+    long exponent = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        isNegative = (*p == '-');
+        p++;
+    }
+
+    const char* digits = p;
+    p = scanDigits(p, end, &scan, &integerKept);
+    long integerDigits = (long)(p - digits);
+    long fractionDigits = 0;
+    if (p < end && (*p == '.' || *p == decimalSeparator)) {
+        const char* fraction = ++p;
+        p = scanDigits(p, end, &scan, &fractionKept);
+        fractionDigits = (long)(p - fraction);
+    }
+    if (integerDigits + fractionDigits == 0) {
+        return NULL;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        bool isNegativeExponent = false;
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) {
+            isNegativeExponent = (*p == '-');
+            p++;
+        }
+        if (p == end || *p < '0' || *p > '9') {
+            return NULL;
+        }
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (exponent < MAX_EXPONENT) {
+                exponent = exponent * 10 + (*p - '0');
+            }
+        }
+        if (isNegativeExponent) {
+            exponent = -exponent;
+        }
+    }
+
+    // Integer digits that were not kept scale the mantissa up, kept fraction digits down
+    exponent += (integerDigits - integerKept) - fractionKept;
+    if (scan.mantissa == 0 && !scan.isTruncated) {
+        *result = isNegative ? -0.0 : 0.0;
+        return p;
+    }
+    if (!scan.isTruncated && scan.mantissa <= (1ull << 53) && exponent >= -MAX_EXACT_POWER &&
+        exponent <= MAX_EXACT_POWER) {
+        double value = (double)scan.mantissa;
+        value = (exponent < 0) ? value / POWERS_OF_TEN[-exponent] : value * POWERS_OF_TEN[exponent];
+        *result = isNegative ? -value : value;
+        return p;
+    }
+    if (!convertSlowly(start, p, decimalSeparator, result) || !isfinite(*result)) {
+        return NULL;
+    }
+    return p;
+}
+
+/*
+ * addChunkPoint
+ */
+static bool addChunkPoint(_loadChunk* chunk, double point)
+{
+    if (chunk->count == chunk->capacity) {
+        size_t capacity = (chunk->capacity == 0) ? 1024 : 2 * chunk->capacity;
+        double* points = realloc(chunk->points, capacity * sizeof(double));
+        if (points == NULL) {
+            chunk->status = STATUS_INSUFFICIENT_MEMORY;
+            return false;
+        }
+        chunk->points = points;
+        chunk->capacity = capacity;
+    }
+    chunk->points[chunk->count++] = point;
+    return true;
+}
+
+/*
+ * parseLine
+ *
+ * Adds the wanted fields of one line to chunk, or counts the line as
+ * skipped if one of them is not a number. Blank lines are ignored.
+ */
+static void parseLine(_loadChunk* chunk, const char* p, const char* end)
+{
+    char decimalSeparator = chunk->options->decimalSeparator;
+    int column = chunk->options->column;
+    int regressors = chunk->options->regressors;
+    size_t firstPoint = chunk->count;
+    bool isFound = false, isValid = true;
+    double x[MAX_REGRESSION_VARIABLES];
+
+    while (end > p && (end[-1] == '\r' || end[-1] == ' ')) {
+        end--;
+    }
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    if (p == end) {
+        return;
+    }
+
+    for (int field = 0; isValid; field++) {
+        while (p < end && *p == ' ') {
+            p++;
+        }
+        if (column == DATA_LOAD_ALL_COLUMNS || (field >= column - regressors && field <= column)) {
+            double point;
+            const char* next = parseNumber(p, end, decimalSeparator, &point);
+            if (next == NULL || (next < end && *next != ' ' && !isDelimiter(*next, decimalSeparator))) {
+                isValid = false;
+                break;
+            }
+            if (field < column) {
+                x[field - (column - regressors)] = point;
+            }
+            else {
+                if (!addChunkPoint(chunk, point)) {
+                    return;
+                }
+                isFound = true;
+                if (regressors > 0) {
+                    int status = regressionAdd(&chunk->regression, x, (size_t)regressors, point, chunk->count - 1);
+                    if (status == STATUS_INSUFFICIENT_MEMORY) {
+                        chunk->status = status;
+                        return;
+                    }
+                    isValid = (status == STATUS_SUCCESS);
+                }
+                if (column != DATA_LOAD_ALL_COLUMNS) {
+                    break;
+                }
+            }
+            p = next;
+        }
+        else {
+            while (p < end && *p != ' ' && !isDelimiter(*p, decimalSeparator)) {
+                p++;
+            }
+        }
+
+        while (p < end && *p == ' ') {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+        if (isDelimiter(*p, decimalSeparator)) {
+            p++;
+        }
+    }
+
+    if (isValid && isFound) {
+        chunk->rows++;
+    }
+    else {
+        chunk->count = firstPoint;
+        chunk->skippedLines++;
+    }
+}
+
+/*
+ * parseChunk
+ *
+ * Thread function: parses the lines of one chunk.
+ */
+static int parseChunk(void* argument)
+{
+    _loadChunk* chunk = argument;
+    const char* p = chunk->begin;
+
+    while (p < chunk->end && chunk->status == STATUS_SUCCESS) {
+        const char* lineEnd = memchr(p, '\n', (size_t)(chunk->end - p));
+        if (lineEnd == NULL) {
+            lineEnd = chunk->end;
+        }
+        parseLine(chunk, p, lineEnd);
+        p = lineEnd + 1;
+    }
+    if (chunk->status == STATUS_SUCCESS) {
+        chunk->isSketched = (quantileSketchAddPoints(&chunk->quantiles, chunk->points, chunk->count) == STATUS_SUCCESS);
+    }
+    return 0;
+}
+
+/*
+ * dataLoadText
+ *
+ * Appends the numbers of text to statistics, as described in dataload.h.
+ * The points of each chunk are appended together; if memory runs out,
+ * the chunks before the failing one stay loaded.
+ *
+ * @param text     The text; it need not be NUL-terminated.
+ * @param options  Decimal separator, column, thread count and x columns.
+ * @param report   Receives the counts and the time of the load.
+ * @return         STATUS_SUCCESS, STATUS_INVALID_INPUT if the x columns
+ *                 do not fit before the column or differ in number from
+ *                 the regression rows already there, or
+ *                 STATUS_INSUFFICIENT_MEMORY.
+ */
+int dataLoadText(_statistics* statistics, const char* text, size_t length, const _dataLoadOptions* options,
+    _dataLoadReport* report)
+{
+    _loadChunk chunks[MAX_LOAD_THREADS];
+    double start = getSeconds();
+    unsigned threads = (options->threads == 0) ? statisticsGetThreadCount() : options->threads;
+    int status = STATUS_SUCCESS;
+
+    memset(report, 0, sizeof(*report));
+    if (options->regressors < 0 || options->regressors > MAX_REGRESSION_VARIABLES ||
+        (options->regressors > 0 && (options->column < options->regressors ||
+        (statistics->regression.count > 0 && statistics->regression.variables != (size_t)options->regressors)))) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (threads > MAX_LOAD_THREADS) {
+        threads = MAX_LOAD_THREADS;
+    }
+    if (threads > length / MIN_CHUNK_BYTES + 1) {
+        threads = (unsigned)(length / MIN_CHUNK_BYTES + 1);
+    }
+#if !DATA_LOAD_THREADS
+    threads = 1;
+#endif
+
+    // Chunk boundaries, each moved past the next line break
+    const char* end = text + length;
+    const char* begin = text;
+    for (unsigned i = 0; i < threads; i++) {
+        const char* chunkEnd = (i + 1 == threads) ? end : text + (length / threads) * (i + 1);
+        if (chunkEnd < begin) {
+            chunkEnd = begin;
+        }
+        if (chunkEnd < end) {
+            const char* lineEnd = memchr(chunkEnd, '\n', (size_t)(end - chunkEnd));
+            chunkEnd = (lineEnd == NULL) ? end : lineEnd + 1;
+        }
+        chunks[i] = (_loadChunk){ .begin = begin, .end = chunkEnd, .options = options, .status = STATUS_SUCCESS };
+        quantileSketchInit(&chunks[i].quantiles, statistics->quantiles.compression);
+        begin = chunkEnd;
+    }
+
+#if DATA_LOAD_THREADS
+    thrd_t workers[MAX_LOAD_THREADS];
+    bool isStarted[MAX_LOAD_THREADS] = { false };
+    for (unsigned i = 1; i < threads; i++) {
+        isStarted[i] = (thrd_create(&workers[i], parseChunk, &chunks[i]) == thrd_success);
+    }
+    parseChunk(&chunks[0]);
+    for (unsigned i = 1; i < threads; i++) {
+        if (isStarted[i]) {
+            thrd_join(workers[i], NULL);
+        }
+        else {
+            parseChunk(&chunks[i]);
+        }
+    }
+#else
+    parseChunk(&chunks[0]);
+#endif
+
+    for (unsigned i = 0; i < threads; i++) {
+        if (status == STATUS_SUCCESS) {
+            status = chunks[i].status;
+        }
+        if (status == STATUS_SUCCESS) {
+            size_t firstPoint = statistics->count;
+            status = statisticsAppend(statistics, chunks[i].points, chunks[i].count,
+                chunks[i].isSketched ? &chunks[i].quantiles : NULL);
+            if (status == STATUS_SUCCESS) {
+                status = regressionMerge(&statistics->regression, &chunks[i].regression, firstPoint);
+            }
+        }
+        if (status == STATUS_SUCCESS) {
+            report->rows += chunks[i].rows;
+            report->points += chunks[i].count;
+            report->skippedLines += chunks[i].skippedLines;
+        }
+        free(chunks[i].points);
+        quantileSketchFree(&chunks[i].quantiles);
+        regressionFree(&chunks[i].regression);
+    }
+
+    report->bytes = length;
+    report->threads = threads;
+    report->seconds = getSeconds() - start;
+    return status;
+}
+
+/*
+ * dataLoadCountColumns
+ *
+ * Number of fields of the first line of text that is all numbers, among
+ * the first MAX_SCANNED_LINES lines, or 0 if there is none. A file of
+ * measurements with a heading gives its number of columns.
+ */
+int dataLoadCountColumns(const char* text, size_t length, char decimalSeparator)
+{
+    const char* end = text + length;
+    const char* p = text;
+
+    for (int line = 0; line < MAX_SCANNED_LINES && p < end; line++) {
+        const char* lineEnd = memchr(p, '\n', (size_t)(end - p));
+        lineEnd = (lineEnd == NULL) ? end : lineEnd;
+        int columns = 0;
+
+        while (p < lineEnd) {
+            double point;
+            while (p < lineEnd && (*p == ' ' || *p == '\r')) {
+                p++;
+            }
+            if (p == lineEnd) {
+                break;
+            }
+            const char* next = parseNumber(p, lineEnd, decimalSeparator, &point);
+            if (next == NULL) {
+                columns = 0;
+                break;
+            }
+            columns++;
+            p = next;
+            while (p < lineEnd && (*p == ' ' || *p == '\r')) {
+                p++;
+            }
+            if (p < lineEnd && isDelimiter(*p, decimalSeparator)) {
+                p++;
+            }
+            else if (p == next && p < lineEnd) {
+                columns = 0;  // Text after the number
+                break;
+            }
+        }
+        if (columns > 0) {
+            return columns;
+        }
+        p = lineEnd + 1;
+    }
+    return 0;
+}
+
+/*
+ * dataLoadFile
+ *
+ * dataLoadText on the contents of a file, mapped into memory where the
+ * system has mmap and read into a buffer elsewhere.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if the file cannot be
+ *          read, or STATUS_INSUFFICIENT_MEMORY.
+ */
+int dataLoadFile(_statistics* statistics, const char* path, const _dataLoadOptions* options,
+    _dataLoadReport* report)
+{
+    int status;
+
+#if DATA_LOAD_MMAP
+    struct stat fileStatus;
+    int file = open(path, O_RDONLY);
+
+    if (file < 0) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (fstat(file, &fileStatus) != 0 || (uintmax_t)fileStatus.st_size > SIZE_MAX) {
+        close(file);
+        return STATUS_INVALID_INPUT;
+    }
+
+    size_t length = (size_t)fileStatus.st_size;
+    if (length == 0) {
+        close(file);
+        return dataLoadText(statistics, "", 0, options, report);
+    }
+    void* text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (text == MAP_FAILED) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    madvise(text, length, MADV_SEQUENTIAL);
+    status = dataLoadText(statistics, text, length, options, report);
+    munmap(text, length);
+#else
+    FILE* file = fopen(path, "rb");
+    char* text = NULL;
+    size_t length = 0, capacity = 0, read;
+
+    if (file == NULL) {
+        return STATUS_INVALID_INPUT;
+    }
+    status = STATUS_SUCCESS;
+    do {
+        if (length == capacity) {
+            capacity = (capacity == 0) ? MIN_CHUNK_BYTES : 2 * capacity;
+            char* grown = realloc(text, capacity);
+            if (grown == NULL) {
+                status = STATUS_INSUFFICIENT_MEMORY;
+                break;
+            }
+            text = grown;
+        }
+        read = fread(text + length, 1, capacity - length, file);
+        length += read;
+    } while (read > 0);
+    if (status == STATUS_SUCCESS && ferror(file)) {
+        status = STATUS_INVALID_INPUT;
+    }
+    fclose(file);
+    if (status == STATUS_SUCCESS) {
+        status = dataLoadText(statistics, text, length, options, report);
+    }
+    free(text);
+#endif
+    return status;
+}
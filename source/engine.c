@@ -0,0 +1,1051 @@
+/*-----------------------------------------------------------------------------
+    engine.c --  Platform-neutral calculator engine for the Windows
+                 Calculator (reconstructed code).
+
+               This module turns key IDs into calculator state changes. It
+               holds the logic that used to live in processButtonClick:
+               digit entry, the operator pipeline with its precedence rules,
+               the parenthesis stack, memory keys, number base and angle
+               mode switches. It never touches a window, so the Win32 front
+               end only has to beep, report errors or redraw depending on
+               what processKey() returns.
+
+               Results, the pending left operand, the parenthesis stack and
+               the memory register are _calcValue operands in the type the
+               current base and mode compute in (see getValueType); text is
+               produced only by getDisplayString.
+
+               While a key is processed or the display is formatted, the
+               limbs and scratch space of big numbers come from the arena
+               of the session, and freeing them costs nothing. When '=',
+               CE or C completes, the values that stay are copied out of
+               the arena and the whole arena is reset at once (see
+               finishEvaluation).
+
+               Key functions include:
+
+               - initEngine / resetEngine / freeEngine: Set up, clear or
+                                              release a session.
+               - processKey: Feeds one key ID through the engine.
+               - getDisplayString / getDisplaySize: Produce the text for
+                                              the display and the buffer
+                                              size it needs.
+               - pushOperator / popOperator / getTopOperator: Operator
+                                              stack used for precedence and
+                                              parentheses.
+
+               This module must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//bigbase.h"
+#include ".//headers//engine.h"
+#include ".//headers//format.h"
+#include ".//headers//input.h"
+#include ".//headers//operations.h"
+#include ".//headers//value.h"
+
+// Pi and 2*pi to 64 significant digits, twice the default _bigDecimal precision
+#define PI_TEXT     "3.14159265358979323846264338327950288419716939937510582097494459"
+#define TWO_PI_TEXT "6.28318530717958647692528676655900576839433879875021164194892919"
+
+#define MAX_EVALUATION_CHUNKS 8  // Arena chunks an evaluation may fill before it is reset anyway
+
+/*
+ * initEngine
+ *
+ * Puts a calculator session into its power-on state: standard mode,
+ * decimal base, 64-bit words, degrees, empty memory, no data points and
+ * no pending operation. The session must later be released with freeEngine.
+ *
+ * @param engine  The session to initialize.
+ */
+void initEngine(_calcEngine* engine)
+{
+    memset(engine, 0, sizeof(*engine));
+    initMemoryArena(&engine->arena, DEFAULT_ARENA_CHUNK_SIZE);
+    engine->angleMode = IDC_RADIO_DEG;
+    engine->currentPrecisionLevel = MAX_STANDARD_PRECISION;
+    engine->decimalSeparator = DEFAULT_DECIMAL_SEPARATOR;
+    engine->mode = STANDARD_MODE;
+    engine->numberBase = 10;
+    engine->precisionDigits = BIG_DECIMAL_DEFAULT_PRECISION;
+    engine->wordBits = FIXED_INT_DEFAULT_BITS;
+    resetEngine(engine);
+}
+
+/*
+ * setEnginePrecision
+ *
+ * Selects the number of significant digits used by the arbitrary-precision
+ * operations, clamped to BIG_DECIMAL_MIN_PRECISION..BIG_DECIMAL_MAX_PRECISION.
+ * When the precision drops, the pages of the large blocks the heap keeps
+ * for reuse go back to the system.
+ *
+ * @param engine  The session to change.
+ * @param digits  Requested precision in decimal digits.
+ * @return        The precision actually selected.
+ */
+int setEnginePrecision(_calcEngine* engine, int digits)
+{
+    if (digits < BIG_DECIMAL_MIN_PRECISION) {
+        digits = BIG_DECIMAL_MIN_PRECISION;
+    }
+    else if (digits > BIG_DECIMAL_MAX_PRECISION) {
+        digits = BIG_DECIMAL_MAX_PRECISION;
+    }
+    if (digits < engine->precisionDigits) {
+        releaseHeapMemory();
+    }
+    engine->precisionDigits = digits;
+    return digits;
+}
+
+/*
+ * freeEngine
+ *
+ * Releases the memory held by the values of a session. The session has to
+ * be initialized again before it is used.
+ *
+ * @param engine  The session to release.
+ */
+void freeEngine(_calcEngine* engine)
+{
+    resetEngine(engine);
+    valueFree(&engine->currentValue);
+    valueFree(&engine->memoryRegister);
+    statisticsFree(&engine->statistics);
+    freeMemoryArena(&engine->arena);
+}
+
+/*
+ * clearOperatorStack
+ *
+ * Drops every pending operator together with its operand.
+ */
+static void clearOperatorStack(_calcEngine* engine)
+{
+    while (engine->operatorStackPointer > 0) {
+        popOperator(engine, NULL);
+    }
+}
+
+/*
+ * resetEngine
+ *
+ * Implements "C" (clear all): drops the entry, the pending operator, the
+ * parenthesis stack and any error. Mode, base, angle mode, memory and the
+ * decimal separator are kept.
+ *
+ * @param engine  The session to reset.
+ */
+void resetEngine(_calcEngine* engine)
+{
+    clearEngineEntry(engine);
+    engine->currentOperator = 0;
+    engine->errorCodeBase = STATUS_SUCCESS;
+    engine->errorState = ERROR_STATE_INACTIVE;
+    engine->hasOperatorPending = false;
+    engine->isInputModeActive = false;
+    engine->isInverseMode = false;
+    engine->keyPressed = 0;
+    valueFree(&engine->lastValue);
+    clearOperatorStack(engine);
+}
+
+/*
+ * clearEngineEntry
+ *
+ * Empties the value being typed ("CE") and sets the displayed result to
+ * 0, without touching the pending operation.
+ *
+ * @param engine  The session whose entry is cleared.
+ */
+void clearEngineEntry(_calcEngine* engine)
+{
+    engine->accumulatedValue[0] = '\0';
+    valueFree(&engine->currentValue);
+    engine->currentSign = 1;
+    engine->currentValueHighPart = 0;
+}
+
+/*
+ * pushOperator
+ *
+ * Pushes an operator together with its left operand, which is moved onto
+ * the stack (*operand becomes 0); a NULL operand pushes 0. Returns false
+ * when the stack already holds MAX_OPERATOR_STACK entries.
+ */
+bool pushOperator(_calcEngine* engine, uint32_t operatorKey, _calcValue* operand)
+{
+    if (engine->operatorStackPointer >= MAX_OPERATOR_STACK) {
+        return false;
+    }
+    _calcValue* slot = &engine->operandStack[engine->operatorStackPointer];
+    engine->operatorStack[engine->operatorStackPointer] = operatorKey;
+    if (operand != NULL) {
+        valueMove(slot, operand);
+    }
+    else {
+        valueFree(slot);
+    }
+    engine->operatorStackPointer++;
+    return true;
+}
+
+/*
+ * popOperator
+ *
+ * Pops the top operator. Its left operand is moved into *operand, or
+ * released if operand is NULL. Returns 0 if the stack is empty.
+ */
+uint32_t popOperator(_calcEngine* engine, _calcValue* operand)
+{
+    if (engine->operatorStackPointer == 0) {
+        return 0;
+    }
+    engine->operatorStackPointer--;
+    _calcValue* slot = &engine->operandStack[engine->operatorStackPointer];
+    if (operand != NULL) {
+        valueMove(operand, slot);
+    }
+    else {
+        valueFree(slot);
+    }
+    return engine->operatorStack[engine->operatorStackPointer];
+}
+
+/*
+ * getTopOperator
+ *
+ * Returns the operator on top of the stack without popping it, or 0 if
+ * the stack is empty.
+ */
+uint32_t getTopOperator(const _calcEngine* engine)
+{
+    if (engine->operatorStackPointer == 0) {
+        return 0;
+    }
+    return engine->operatorStack[engine->operatorStackPointer - 1];
+}
+
+/*
+ * getOperatorPrecedence
+ *
+ * Binding strength of the binary operators in scientific mode, from the
+ * key table (input.c): or xor < and < lsh rsh rol ror < + - < * / mod <
+ * x^y; 0 for other keys. Standard mode evaluates strictly left to right
+ * and never consults it. The expression compiler (expression.c) uses the same
+ * values, so typed formulas group exactly like keyed ones.
+ */
+int getOperatorPrecedence(uint32_t operatorKey)
+{
+    return getKeyInfo(operatorKey)->precedence;
+}
+
+/*
+ * getValueType
+ *
+ * The representation values are computed in: fixed-width integers of
+ * wordBits bits in the non-decimal bases, _bigDecimal at precisionDigits
+ * in standard mode (whose operators all have a decimal implementation),
+ * double in scientific mode and _extendedFloat80 in scientific notation.
+ */
+static _valueType getValueType(const _calcEngine* engine)
+{
+    if (engine->numberBase != 10) {
+        return VALUE_TYPE_FIXED;
+    }
+    switch (engine->mode) {
+    case STANDARD_MODE:       return VALUE_TYPE_BIG;
+    case SCIENTIFIC_NOTATION: return VALUE_TYPE_EXTENDED;
+    default:                  return VALUE_TYPE_DOUBLE;
+    }
+}
+
+/*
+ * getValuePrecision
+ *
+ * The precision argument of valueConvert for getValueType: the word size
+ * in the non-decimal bases, the significant digits otherwise.
+ */
+static int getValuePrecision(const _calcEngine* engine)
+{
+    return (engine->numberBase != 10) ? engine->wordBits : engine->precisionDigits;
+}
+
+/*
+ * isWideValue
+ *
+ * True if value is a _bigDecimal whose integer part does not fit a word
+ * of wordBits bits, as a signed or as an unsigned number, so converting
+ * it to VALUE_TYPE_FIXED would lose digits. The non-decimal bases keep
+ * such a result whole until it is next used (see convertSwitchedValue).
+ */
+static bool isWideValue(const _calcEngine* engine, const _calcValue* value)
+{
+    char text[FIXED_INT_MAX_TEXT + 8];
+
+    if (value->type != VALUE_TYPE_BIG) {
+        return false;
+    }
+    // 30103 / 100000 rounds log10(2) up: past that exponent the value
+    // is at least 10^(digitExponent) > 2^wordBits, below it the binary
+    // text has at most wordBits + 4 digits
+    if (bigDecimalDigitExponent(&value->big) > (int64_t)engine->wordBits * 30103 / 100000) {
+        return true;
+    }
+    size_t length = bigBaseToString(&value->big, text, sizeof(text), 2);
+    if (text[0] != '-') {
+        return length > (size_t)engine->wordBits;
+    }
+    // The most negative word is -2^(wordBits-1), a 1 and wordBits-1 zeros
+    size_t bits = length - 1;
+    return bits > (size_t)engine->wordBits ||
+           (bits == (size_t)engine->wordBits && strspn(text + 2, "0") != bits - 1);
+}
+
+/*
+ * checkStatus
+ *
+ * Puts the engine into the error state unless status is STATUS_SUCCESS.
+ * Returns true on success.
+ */
+static bool checkStatus(_calcEngine* engine, int status)
+{
+    if (status != STATUS_SUCCESS) {
+        engine->errorState = ERROR_STATE_ACTIVE;
+        engine->errorCodeBase = (uint32_t)status;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * getEntryValue
+ *
+ * Stores the displayed value in *value, in the type of the current base
+ * and mode. Values being typed are parsed from the entry, in the current
+ * number base and with the user's decimal separator; results are copied.
+ */
+static int getEntryValue(const _calcEngine* engine, _calcValue* value)
+{
+    _valueType type = getValueType(engine);
+
+    if (engine->isInputModeActive) {
+        return valueFromString(value, type, engine->accumulatedValue, engine->numberBase,
+            engine->decimalSeparator, getValuePrecision(engine));
+    }
+    int status = valueCopy(value, &engine->currentValue);
+    return (status == STATUS_SUCCESS) ? valueConvert(value, type, getValuePrecision(engine)) : status;
+}
+
+/*
+ * getSwitchedValue
+ *
+ * getEntryValue for a switch of number base or word size, called before
+ * the switch: a result wider than the word is copied whole instead of
+ * being cut to the old word size.
+ */
+static int getSwitchedValue(const _calcEngine* engine, _calcValue* value)
+{
+    if (!engine->isInputModeActive && isWideValue(engine, &engine->currentValue)) {
+        return valueCopy(value, &engine->currentValue);
+    }
+    return getEntryValue(engine, value);
+}
+
+/*
+ * convertSwitchedValue
+ *
+ * Converts the value of getSwitchedValue to the type of the new base and
+ * word size. In the non-decimal bases a result wider than the word stays
+ * a _bigDecimal, which getDisplayString shows whole; the next
+ * calculation that uses it wraps it to the word (see getEntryValue).
+ */
+static int convertSwitchedValue(const _calcEngine* engine, _calcValue* value)
+{
+    if (engine->numberBase != 10 && isWideValue(engine, value)) {
+        return STATUS_SUCCESS;
+    }
+    return valueConvert(value, getValueType(engine), getValuePrecision(engine));
+}
+
+/*
+ * setEntryValue
+ *
+ * Moves a calculation result into the displayed value (*value becomes 0)
+ * and ends input mode, so the next digit starts a new number.
+ */
+static void setEntryValue(_calcEngine* engine, _calcValue* value)
+{
+    valueMove(&engine->currentValue, value);
+    engine->currentSign = 1;
+    engine->currentValueHighPart = 0;
+    engine->isInputModeActive = false;
+}
+
+/*
+ * setEngineDataPoint
+ *
+ * Makes data point index of the statistics box the displayed value (the
+ * RET key), converted to the current base and mode.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if there is no such
+ *          point, or the conversion's status code with the display
+ *          unchanged.
+ */
+int setEngineDataPoint(_calcEngine* engine, size_t index)
+{
+    _calcValue value;
+
+    if (index >= engine->statistics.count) {
+        return STATUS_INVALID_INPUT;
+    }
+    valueInit(&value);
+    valueSetDouble(&value, engine->statistics.points[index]);
+    int status = valueConvert(&value, getValueType(engine), getValuePrecision(engine));
+    if (status == STATUS_SUCCESS) {
+        setEntryValue(engine, &value);
+    }
+    valueFree(&value);
+    return status;
+}
+
+/*
+ * setEngineValue
+ *
+ * Makes text the displayed value, as if it were the result of a
+ * calculation.
+ * The text is in the current number base and may use '.' or the user's
+ * decimal separator.
+ *
+ * @return  STATUS_SUCCESS, or the parser's status code with the display
+ *          unchanged.
+ */
+int setEngineValue(_calcEngine* engine, const char* text)
+{
+    _calcValue value;
+
+    valueInit(&value);
+    int status = valueFromString(&value, getValueType(engine), text, engine->numberBase,
+        engine->decimalSeparator, getValuePrecision(engine));
+    if (status == STATUS_SUCCESS) {
+        setEntryValue(engine, &value);
+    }
+    valueFree(&value);
+    return status;
+}
+
+/*
+ * setEngineWordSize
+ *
+ * Selects the word size of the non-decimal bases: 8, 16, 32, 64, 128, 256
+ * or 512 bits. In those bases the displayed value is cut to the new size
+ * (or sign-extended) at once, unless it is a result wider than the word
+ * (see convertSwitchedValue); other values follow when they are next
+ * used.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INVALID_INPUT for another size.
+ */
+int setEngineWordSize(_calcEngine* engine, int bits)
+{
+    _calcValue value;
+
+    if (!fixedIntIsValidWidth(bits)) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (engine->numberBase == 10) {
+        engine->wordBits = bits;
+        return STATUS_SUCCESS;
+    }
+    valueInit(&value);
+    int status = getSwitchedValue(engine, &value);
+    engine->wordBits = bits;
+    if (status == STATUS_SUCCESS) {
+        status = convertSwitchedValue(engine, &value);
+    }
+    if (status == STATUS_SUCCESS) {
+        setEntryValue(engine, &value);
+    }
+    valueFree(&value);
+    return status;
+}
+
+/*
+ * evaluatePendingOperators
+ *
+ * Folds the pending operator and the operator stack into *value.
+ *
+ * In scientific mode evaluation stops as soon as nextOperator binds more
+ * tightly than the pending operator; the caller then pushes the pending
+ * operator. Evaluation always stops at a left parenthesis unless
+ * nextOperator is '=', which closes every open parenthesis.
+ *
+ * @return  false if a calculation failed (see engine->errorCodeBase).
+ */
+static bool evaluatePendingOperators(_calcEngine* engine, _calcValue* value, uint32_t nextOperator)
+{
+    for (;;) {
+        if (engine->hasOperatorPending) {
+            if (engine->mode != STANDARD_MODE &&
+                getOperatorPrecedence(nextOperator) > getOperatorPrecedence(engine->currentOperator)) {
+                break;
+            }
+            if (performValueCalculation(engine, engine->currentOperator, value, &engine->lastValue,
+                    value) != STATUS_SUCCESS) {
+                return false;
+            }
+            engine->hasOperatorPending = false;
+        }
+
+        if (engine->operatorStackPointer == 0) {
+            break;
+        }
+        if (getTopOperator(engine) == IDC_BUTTON_LPAR) {
+            if (nextOperator != IDC_BUTTON_EQ) {
+                break;
+            }
+            popOperator(engine, NULL);
+            continue;
+        }
+
+        engine->currentOperator = popOperator(engine, &engine->lastValue);
+        engine->hasOperatorPending = (engine->currentOperator != 0);
+    }
+    return true;
+}
+
+/*
+ * processDigitKey
+ *
+ * Appends a digit to the value being typed, starting a new number if the
+ * previous key finished one.
+ */
+static int processDigitKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    int digit = convertKeyToDigit(keyPressed);
+
+    if (digit >= engine->numberBase) {
+        return KEY_RESULT_BEEP;
+    }
+    if (!engine->isInputModeActive) {
+        engine->isInputModeActive = true;
+        clearEngineEntry(engine);
+    }
+    if (engine->numberBase != 10 && isValueOverflow(engine, digit)) {
+        return KEY_RESULT_BEEP;
+    }
+    if (!appendDigit(engine, digit)) {
+        return KEY_RESULT_BEEP;
+    }
+    return KEY_RESULT_DISPLAY;
+}
+
+/*
+ * processOperatorKey
+ *
+ * Unary operators are applied to the displayed value at once. Binary
+ * operators and '=' evaluate whatever is pending and become the new
+ * pending operator.
+ */
+static int processOperatorKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    bool isUnary = isUnaryOperatorKey(keyPressed);
+    _calcValue value;
+    int result = KEY_RESULT_DISPLAY;
+
+    // Two binary operators in a row: the second one replaces the first
+    if (!isUnary && keyPressed != IDC_BUTTON_EQ && engine->hasOperatorPending && !engine->isInputModeActive &&
+        engine->keyPressed == engine->currentOperator) {
+        engine->currentOperator = keyPressed;
+        return KEY_RESULT_NONE;
+    }
+
+    valueInit(&value);
+    if (!checkStatus(engine, getEntryValue(engine, &value))) {
+        result = KEY_RESULT_ERROR;
+    }
+    else if (isUnary) {
+        _calcValue zero;
+        valueInit(&zero);
+        if (performValueCalculation(engine, keyPressed, &value, engine->hasOperatorPending ? &engine->lastValue : &zero,
+                &value) == STATUS_SUCCESS) {
+            setEntryValue(engine, &value);
+        }
+        else {
+            result = KEY_RESULT_ERROR;
+        }
+    }
+    else if (!evaluatePendingOperators(engine, &value, keyPressed)) {
+        result = KEY_RESULT_ERROR;
+    }
+    else if (keyPressed == IDC_BUTTON_EQ) {
+        setEntryValue(engine, &value);
+        engine->hasOperatorPending = false;
+        clearOperatorStack(engine);
+    }
+    else if (engine->hasOperatorPending &&
+             !pushOperator(engine, engine->currentOperator, &engine->lastValue)) {
+        setEntryValue(engine, &value);
+        result = KEY_RESULT_BEEP;
+    }
+    else {
+        int status = valueCopy(&engine->lastValue, &value);
+        setEntryValue(engine, &value);
+        engine->currentOperator = keyPressed;
+        engine->hasOperatorPending = true;
+        if (!checkStatus(engine, status)) {
+            result = KEY_RESULT_ERROR;
+        }
+    }
+
+    valueFree(&value);
+    return result;
+}
+
+/*
+ * processParenthesisKey
+ *
+ * '(' saves the pending operation and starts a sub-expression; ')'
+ * evaluates the sub-expression and restores the saved operation.
+ */
+static int processParenthesisKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    if (keyPressed == IDC_BUTTON_LPAR) {
+        if (engine->operatorStackPointer + 2 > MAX_OPERATOR_STACK) {
+            return KEY_RESULT_BEEP;
+        }
+        pushOperator(engine, engine->hasOperatorPending ? engine->currentOperator : 0, &engine->lastValue);
+        pushOperator(engine, IDC_BUTTON_LPAR, NULL);
+        engine->hasOperatorPending = false;
+        engine->isInputModeActive = false;
+        return KEY_RESULT_NONE;
+    }
+
+    // Unmatched closing parenthesis
+    bool hasOpenParenthesis = false;
+    for (int i = 0; i < engine->operatorStackPointer; i++) {
+        if (engine->operatorStack[i] == IDC_BUTTON_LPAR) {
+            hasOpenParenthesis = true;
+            break;
+        }
+    }
+    if (!hasOpenParenthesis) {
+        return KEY_RESULT_BEEP;
+    }
+
+    _calcValue value;
+    valueInit(&value);
+    if (!checkStatus(engine, getEntryValue(engine, &value)) ||
+        !evaluatePendingOperators(engine, &value, IDC_BUTTON_RPAR)) {
+        valueFree(&value);
+        return KEY_RESULT_ERROR;
+    }
+    popOperator(engine, NULL); // Remove the left parenthesis
+    engine->currentOperator = popOperator(engine, &engine->lastValue);
+    engine->hasOperatorPending = (engine->currentOperator != 0);
+    setEntryValue(engine, &value);
+    return KEY_RESULT_DISPLAY;
+}
+
+/*
+ * processStatisticsKey
+ *
+ * Sum, Ave and s show a statistic of the data points; with Inv they show
+ * the sum of squares, the mean of squares and the population deviation.
+ * The running sums make each O(1).
+ */
+static int processStatisticsKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    const _statistics* statistics = &engine->statistics;
+    _calcValue value;
+    double result = 0.0;
+    int status;
+
+    switch (keyPressed) {
+    case IDC_BUTTON_SUM: status = statisticsGetSum(statistics, engine->isInverseMode, &result);       break;
+    case IDC_BUTTON_AVE: status = statisticsGetMean(statistics, engine->isInverseMode, &result);      break;
+    default:             status = statisticsGetDeviation(statistics, engine->isInverseMode, &result); break;
+    }
+
+    valueInit(&value);
+    if (status == STATUS_SUCCESS) {
+        valueSetDouble(&value, result);
+        status = valueConvert(&value, getValueType(engine), getValuePrecision(engine));
+    }
+    if (checkStatus(engine, status)) {
+        setEntryValue(engine, &value);
+    }
+    valueFree(&value);
+    return KEY_RESULT_DISPLAY;
+}
+
+/*
+ * processSpecialKey
+ *
+ * Clear keys, backspace, sign change, memory keys, statistics keys,
+ * constants and the base/word size/angle radio buttons.
+ */
+static int processSpecialKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    _calcValue value;
+    size_t length;
+    int status;
+
+    switch (keyPressed) {
+    case IDC_BUTTON_CE:
+        engine->errorState = ERROR_STATE_INACTIVE;
+        engine->errorCodeBase = STATUS_SUCCESS;
+        engine->isInputModeActive = true;
+        clearEngineEntry(engine);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_CA:
+        resetEngine(engine);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_BACK:
+        length = strlen(engine->accumulatedValue);
+        if (!engine->isInputModeActive || length == 0) {
+            return KEY_RESULT_BEEP;
+        }
+        if (hasDecimalSeparator(engine, engine->accumulatedValue) &&
+            engine->accumulatedValue[length - 1] != engine->decimalSeparator) {
+            engine->currentValueHighPart--;
+        }
+        engine->accumulatedValue[length - 1] = '\0';
+        if (strcmp(engine->accumulatedValue, "-") == 0) {
+            clearEngineEntry(engine);
+        }
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_NEG:
+        if (engine->isInputModeActive) {
+            length = strlen(engine->accumulatedValue);
+            if (engine->accumulatedValue[0] == '-') {
+                memmove(engine->accumulatedValue, engine->accumulatedValue + 1, length);
+            }
+            else if (length + 1 < MAX_DISPLAY_DIGITS) {
+                memmove(engine->accumulatedValue + 1, engine->accumulatedValue, length + 1);
+                engine->accumulatedValue[0] = '-';
+            }
+            engine->currentSign = -engine->currentSign;
+            return KEY_RESULT_DISPLAY;
+        }
+        valueInit(&value);
+        status = getEntryValue(engine, &value);
+        if (checkStatus(engine, status) &&
+            performValueCalculation(engine, IDC_BUTTON_NEG, &value, &value, &value) == STATUS_SUCCESS) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_DOT:
+        if (!engine->isInputModeActive) {
+            engine->isInputModeActive = true;
+            clearEngineEntry(engine);
+        }
+        return appendDecimalSeparator(engine) ? KEY_RESULT_DISPLAY : KEY_RESULT_BEEP;
+
+    case IDC_BUTTON_MC:
+        valueFree(&engine->memoryRegister);
+        return KEY_RESULT_NONE;
+
+    case IDC_BUTTON_MR:
+        valueInit(&value);
+        if (checkStatus(engine, valueCopy(&value, &engine->memoryRegister))) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_MS:
+    case IDC_BUTTON_MPLUS:
+    case IDC_BUTTON_MSUB:
+        valueInit(&value);
+        status = getEntryValue(engine, &value);
+        if (status == STATUS_SUCCESS) {
+            if (keyPressed == IDC_BUTTON_MS) {
+                status = valueCopy(&engine->memoryRegister, &value);
+            }
+            else {
+                status = performValueCalculation(engine, (keyPressed == IDC_BUTTON_MPLUS) ? IDC_BUTTON_ADD : IDC_BUTTON_SUB,
+                    &engine->memoryRegister, &engine->memoryRegister, &value);
+            }
+        }
+        if (checkStatus(engine, status)) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_NONE;
+
+    case IDC_BUTTON_DAT:
+        // Inv Dat enters an x value for the regression row of the next point
+        valueInit(&value);
+        status = getEntryValue(engine, &value);
+        if (status == STATUS_SUCCESS) {
+            status = engine->isInverseMode ? statisticsAddRegressor(&engine->statistics, valueToDouble(&value))
+                                           : statisticsAdd(&engine->statistics, valueToDouble(&value));
+        }
+        if (checkStatus(engine, status)) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_SUM:
+    case IDC_BUTTON_AVE:
+    case IDC_BUTTON_DEV:
+        return processStatisticsKey(engine, keyPressed);
+
+    case IDC_BUTTON_PI:
+        valueInit(&value);
+        status = valueFromString(&value, getValueType(engine), engine->isInverseMode ? TWO_PI_TEXT : PI_TEXT, 10, '.',
+            getValuePrecision(engine));
+        if (checkStatus(engine, status)) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_RADIO_DEG:
+    case IDC_RADIO_RAD:
+    case IDC_RADIO_GRAD:
+        engine->angleMode = keyPressed;
+        return KEY_RESULT_NONE;
+
+    case IDC_RADIO_HEX:
+    case IDC_RADIO_DEC:
+    case IDC_RADIO_OCT:
+    case IDC_RADIO_BIN:
+        valueInit(&value);
+        status = getSwitchedValue(engine, &value);
+        switch (keyPressed) {
+        case IDC_RADIO_HEX: engine->numberBase = 16; break;
+        case IDC_RADIO_OCT: engine->numberBase = 8;  break;
+        case IDC_RADIO_BIN: engine->numberBase = 2;  break;
+        default:            engine->numberBase = 10; break;
+        }
+        if (status == STATUS_SUCCESS) {
+            status = convertSwitchedValue(engine, &value);
+        }
+        if (checkStatus(engine, status)) {
+            setEntryValue(engine, &value);
+        }
+        valueFree(&value);
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_RADIO_BITS8:
+    case IDC_RADIO_BITS16:
+    case IDC_RADIO_BITS32:
+    case IDC_RADIO_BITS64:
+    case IDC_RADIO_BITS128:
+    case IDC_RADIO_BITS256:
+    case IDC_RADIO_BITS512:
+        checkStatus(engine, setEngineWordSize(engine, FIXED_INT_MIN_BITS << (keyPressed - IDC_RADIO_BITS8)));
+        return KEY_RESULT_DISPLAY;
+
+    case IDC_BUTTON_INV_TOGGLE:
+        engine->isInverseMode = !engine->isInverseMode;
+        return KEY_RESULT_NONE;
+
+    default:
+        return KEY_RESULT_NONE;
+    }
+}
+
+/*
+ * keepValue
+ *
+ * Copies the limbs of a value out of the arena, so that it survives a
+ * reset of the arena. The arena must not be selected.
+ */
+static bool keepValue(_calcValue* value)
+{
+    if (value->type != VALUE_TYPE_BIG || !isArenaMemory(value->big.limbs)) {
+        return true;
+    }
+    _bigDecimal copy;
+    bigDecimalInit(&copy);
+    if (bigDecimalCopy(&copy, &value->big) != STATUS_SUCCESS) {
+        return false;
+    }
+    value->big = copy;
+    return true;
+}
+
+/*
+ * finishEvaluation
+ *
+ * Ends the use of the arena by an evaluation: the displayed value, the
+ * pending operands and the memory register are copied out, and every
+ * temporary goes at once. If a copy fails, the arena is kept as it is.
+ */
+static void finishEvaluation(_calcEngine* engine)
+{
+    bool isKept = keepValue(&engine->currentValue) && keepValue(&engine->lastValue) &&
+        keepValue(&engine->memoryRegister);
+
+    for (int i = 0; isKept && i < MAX_OPERATOR_STACK; i++) {
+        isKept = keepValue(&engine->operandStack[i]);
+    }
+    if (isKept) {
+        resetMemoryArena(&engine->arena);
+    }
+}
+
+/*
+ * processKey
+ *
+ * Feeds one key ID through the engine. This is the platform-neutral part
+ * of processButtonClick: the caller decides how to beep, report errors and
+ * redraw from the returned KEY_RESULT_* code.
+ *
+ * @param engine      The calculator session.
+ * @param keyPressed  An IDC_BUTTON_* or IDC_RADIO_* ID.
+ * @return            KEY_RESULT_NONE, KEY_RESULT_DISPLAY, KEY_RESULT_BEEP
+ *                    or KEY_RESULT_ERROR.
+ */
+int processKey(_calcEngine* engine, uint32_t keyPressed)
+{
+    int result;
+
+    // Handle error state
+    if (engine->errorState != ERROR_STATE_INACTIVE && !isClearKey(keyPressed)) {
+        return KEY_RESULT_BEEP;
+    }
+
+    // Inv Lsh shifts right, as on the Windows calculator
+    if (keyPressed == IDC_BUTTON_LSH && engine->isInverseMode) {
+        keyPressed = IDC_BUTTON_RSH;
+    }
+
+    _memoryArena* previousArena = selectMemoryArena(&engine->arena);
+    if (isNumericInput(engine, keyPressed)) {
+        result = processDigitKey(engine, keyPressed);
+    }
+    else if (keyPressed == IDC_BUTTON_LPAR || keyPressed == IDC_BUTTON_RPAR) {
+        result = processParenthesisKey(engine, keyPressed);
+    }
+    else if (isOperatorKey(engine, keyPressed)) {
+        result = processOperatorKey(engine, keyPressed);
+    }
+    else {
+        result = processSpecialKey(engine, keyPressed);
+    }
+
+    selectMemoryArena(previousArena);
+
+    // A long chain of operators without '=' must not grow the arena for ever
+    if (keyPressed == IDC_BUTTON_EQ || keyPressed == IDC_BUTTON_CE || keyPressed == IDC_BUTTON_CA ||
+        engine->arena.used > MAX_EVALUATION_CHUNKS * engine->arena.chunkSize) {
+        finishEvaluation(engine);
+    }
+
+    if (!isSpecialFunctionKey(engine, keyPressed)) {
+        engine->keyPressed = keyPressed;
+    }
+    if (engine->errorState != ERROR_STATE_INACTIVE) {
+        return KEY_RESULT_ERROR;
+    }
+    return result;
+}
+
+/*
+ * getDisplaySize
+ *
+ * The buffer size getDisplayString needs, the NUL included:
+ * MAX_DISPLAY_DIGITS, or more for a result wider than the word in a
+ * non-decimal base, whose every digit is shown.
+ */
+size_t getDisplaySize(_calcEngine* engine)
+{
+    size_t size = MAX_DISPLAY_DIGITS;
+
+    if (engine->numberBase != 10 && !engine->isInputModeActive) {
+        _memoryArena* previousArena = selectMemoryArena(&engine->arena);
+        if (isWideValue(engine, &engine->currentValue)) {
+            size_t textSize = bigBaseTextSize(&engine->currentValue.big, engine->numberBase);
+            size = (textSize > size) ? textSize : size;
+        }
+        selectMemoryArena(previousArena);
+    }
+    return size;
+}
+
+/*
+ * getDisplayString
+ *
+ * Produces the text the display should show. Values being typed are shown
+ * as typed; results are formatted for the current base and mode.
+ *
+ * @param engine      The calculator session.
+ * @param buffer      Receives the display text.
+ * @param bufferSize  Size of buffer; getDisplaySize is always enough.
+ * @return            STATUS_SUCCESS, the status code of a recalled value
+ *                    that cannot be converted to the current base (a NaN
+ *                    or an infinity), or STATUS_INSUFFICIENT_MEMORY.
+ */
+int getDisplayString(_calcEngine* engine, char* buffer, size_t bufferSize)
+{
+    char displayBuffer[MAX_DISPLAY_DIGITS];
+
+    if (engine->isInputModeActive) {
+        const char* entry = (engine->accumulatedValue[0] != '\0') ? engine->accumulatedValue : "0";
+        if (engine->numberBase == 10 && !hasDecimalSeparator(engine, entry)) {
+            snprintf(buffer, bufferSize, "%s%c", entry, engine->decimalSeparator);
+        }
+        else {
+            snprintf(buffer, bufferSize, "%s", entry);
+        }
+        return STATUS_SUCCESS;
+    }
+
+    _memoryArena* previousArena = selectMemoryArena(&engine->arena);
+    int status = STATUS_SUCCESS;
+
+    if (engine->numberBase == 10) {
+        if ((engine->mode == SCIENTIFIC_NOTATION) && (engine->currentValueHighPart == 0)) {
+            formatValue(displayBuffer, sizeof(displayBuffer), &engine->currentValue, NUMBER_LAYOUT_SCIENTIFIC,
+                MAX_DECIMAL_DIGITS, engine->decimalSeparator);
+        }
+        else {
+            formatValue(displayBuffer, sizeof(displayBuffer), &engine->currentValue, NUMBER_LAYOUT_AUTOMATIC,
+                MAX_DECIMAL_DIGITS, '.');
+            formatFloatAutomatically(displayBuffer, displayBuffer, engine->decimalSeparator);
+        }
+    }
+    else if (isWideValue(engine, &engine->currentValue)) {
+        // Shown whole, as '-' and the magnitude rather than a bit pattern
+        if (bigBaseToString(&engine->currentValue.big, buffer, bufferSize, engine->numberBase) == 0) {
+            status = STATUS_INSUFFICIENT_MEMORY;
+        }
+        selectMemoryArena(previousArena);
+        return status;
+    }
+    else {
+        // A recalled value may still be of another type or word size
+        _calcValue value;
+        valueInit(&value);
+        status = valueCopy(&value, &engine->currentValue);
+        if (status == STATUS_SUCCESS) {
+            status = valueConvert(&value, VALUE_TYPE_FIXED, engine->wordBits);
+        }
+        if (status == STATUS_SUCCESS) {
+            fixedIntToString(&value.fixed, displayBuffer, sizeof(displayBuffer), engine->numberBase);
+        }
+        valueFree(&value);
+    }
+    selectMemoryArena(previousArena);
+
+    if (status == STATUS_SUCCESS) {
+        snprintf(buffer, bufferSize, "%s", displayBuffer);
+    }
+    return status;
+}
@@ -0,0 +1,961 @@
+/*-----------------------------------------------------------------------------
+    expression.c --  Expression compiler and bytecode machine for the
+                     calculator engine (reconstructed code).
+
+               The keypad evaluates a formula one key at a time through the
+               engine's operator stack, which is the right model for a
+               display that shows every intermediate result but the wrong
+               one for evaluating the same formula many times. This module
+               compiles the whole formula once and then runs it as often as
+               needed.
+
+               The compiler is a shunting-yard parser. Operators waiting
+               for their right operand go on a pending stack that grows on
+               the heap, so nesting depth is bounded only by memory and no
+               C recursion is involved. Binary operators are ranked by the
+               engine's own getOperatorPrecedence.
+
+               The compiler also works out the deepest the evaluation stack
+               can get, so the stack is allocated once per compile and
+               expressionEvaluate never allocates. Where the compiler is
+               GCC or Clang, the evaluator jumps straight from one
+               instruction's handler to the next through a table of label
+               addresses ("threaded" dispatch); elsewhere it falls back to
+               a switch in a loop.
+
+               Key functions include:
+
+               - expressionCompile: Text to instructions.
+               - expressionEvaluate: Runs the instructions for one set of
+                                     variable values.
+               - expressionEvaluateBatch: The same over many rows.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//expression.h"
+#include ".//headers//wideint.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EXPRESSION_THREADED_DISPATCH 1
+#else
+#define EXPRESSION_THREADED_DISPATCH 0
+#endif
+
+#define PENDING_PARENTHESIS EXPRESSION_OPCODE_COUNT  // Marks a '(' on the pending stack
+#define FUNCTION_PRECEDENCE 0                        // Functions wait for their ')'
+#define PREFIX_PRECEDENCE 7                          // Prefix minus binds tighter than ^
+#define MAX_NUMBER_LENGTH 64                         // Longest number in the text
+
+typedef struct {
+    const char* name;
+    uint32_t operatorKey;        // The IDC_BUTTON_* key of the same operator
+    _expressionOpcode opcode;
+} _operatorName;
+
+// Binary operators, spelled as symbols or words
+static const _operatorName BINARY_OPERATORS[] = {
+    { "+",   IDC_BUTTON_ADD, EXPRESSION_OP_ADD },
+    { "-",   IDC_BUTTON_SUB, EXPRESSION_OP_SUB },
+    { "*",   IDC_BUTTON_MUL, EXPRESSION_OP_MUL },
+    { "/",   IDC_BUTTON_DIV, EXPRESSION_OP_DIV },
+    { "^",   IDC_BUTTON_XY,  EXPRESSION_OP_POW },
+    { "mod", IDC_BUTTON_MOD, EXPRESSION_OP_MOD },
+    { "and", IDC_BUTTON_AND, EXPRESSION_OP_AND },
+    { "or",  IDC_BUTTON_OR,  EXPRESSION_OP_OR  },
+    { "xor", IDC_BUTTON_XOR, EXPRESSION_OP_XOR },
+    { "lsh", IDC_BUTTON_LSH, EXPRESSION_OP_LSH },
+};
+
+static const _operatorName FUNCTIONS[] = {
+    { "sqrt", IDC_BUTTON_SQRT, EXPRESSION_OP_SQRT },
+    { "sqr",  IDC_BUTTON_SQR,  EXPRESSION_OP_SQR  },
+    { "cube", IDC_BUTTON_CUBE, EXPRESSION_OP_CUBE },
+    { "inv",  IDC_BUTTON_INV,  EXPRESSION_OP_INV  },
+    { "sin",  IDC_BUTTON_SIN,  EXPRESSION_OP_SIN  },
+    { "cos",  IDC_BUTTON_COS,  EXPRESSION_OP_COS  },
+    { "tan",  IDC_BUTTON_TAN,  EXPRESSION_OP_TAN  },
+    { "asin", IDC_BUTTON_ASIN, EXPRESSION_OP_ASIN },
+    { "acos", IDC_BUTTON_ACOS, EXPRESSION_OP_ACOS },
+    { "atan", IDC_BUTTON_ATAN, EXPRESSION_OP_ATAN },
+    { "log",  IDC_BUTTON_LOG,  EXPRESSION_OP_LOG  },
+    { "ln",   IDC_BUTTON_LN,   EXPRESSION_OP_LN   },
+    { "exp",  IDC_BUTTON_EXP,  EXPRESSION_OP_EXP  },
+    { "fact", IDC_BUTTON_FACT, EXPRESSION_OP_FACT },
+    { "int",  IDC_BUTTON_INT,  EXPRESSION_OP_INT  },
+    { "not",  IDC_BUTTON_NOT,  EXPRESSION_OP_NOT  },
+};
+
+// An operator waiting on the compiler's pending stack
+typedef struct {
+    uint8_t opcode;       // _expressionOpcode or PENDING_PARENTHESIS
+    uint8_t precedence;
+} _pendingOperator;
+
+typedef struct {
+    _expression* expression;
+    uint32_t angleMode;
+    int numberBase;       // 2, 8, 10 or 16
+    _pendingOperator* pending;
+    int pendingCount;
+    int pendingCapacity;
+    int depth;            // Stack depth after the instructions emitted so far
+    int maxDepth;
+} _compiler;
+
+/*
+ * expressionInit
+ *
+ * Makes expression empty. Zero-filled memory is in the same state.
+ */
+void expressionInit(_expression* expression)
+{
+    memset(expression, 0, sizeof(*expression));
+}
+
+/*
+ * expressionFree
+ *
+ * Releases everything the expression owns and leaves it empty.
+ */
+void expressionFree(_expression* expression)
+{
+    free(expression->code);
+    free(expression->constants);
+    free(expression->variables);
+    free(expression->stack);
+    expressionInit(expression);
+}
+
+/*
+ * reserveItems
+ *
+ * Grows a heap array so it can hold at least count items of itemSize
+ * bytes, doubling its capacity to keep appends amortized O(1).
+ */
+static int reserveItems(void** items, int* capacity, int count, size_t itemSize)
+{
+    if (count <= *capacity) {
+        return STATUS_SUCCESS;
+    }
+    int newCapacity = (*capacity < 8) ? 8 : *capacity;
+    while (newCapacity < count) {
+        newCapacity *= 2;
+    }
+    void* newItems = realloc(*items, (size_t)newCapacity * itemSize);
+    if (newItems == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    *items = newItems;
+    *capacity = newCapacity;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * expressionGetOperandCount
+ *
+ * How many values an instruction takes off the stack: 0 for the ones that
+ * push a value, 2 for binary operators and 1 for the rest, which work on
+ * the top of the stack in place.
+ */
+int expressionGetOperandCount(_expressionOpcode opcode)
+{
+    if (opcode == EXPRESSION_OP_CONSTANT || opcode == EXPRESSION_OP_VARIABLE || opcode == EXPRESSION_OP_LOAD) {
+        return 0;
+    }
+    return (opcode >= EXPRESSION_OP_ADD && opcode <= EXPRESSION_OP_LSH) ? 2 : 1;
+}
+
+/*
+ * emitInstruction
+ *
+ * Appends one instruction and tracks how deep the stack gets.
+ */
+static int emitInstruction(_compiler* compiler, _expressionOpcode opcode, uint32_t operand)
+{
+    _expression* expression = compiler->expression;
+    int status = reserveItems((void**)&expression->code, &expression->codeCapacity,
+        expression->codeLength + 1, sizeof(uint32_t));
+
+    if (status == STATUS_SUCCESS) {
+        expression->code[expression->codeLength++] = (operand << EXPRESSION_OPERAND_SHIFT) | (uint32_t)opcode;
+        int operandCount = expressionGetOperandCount(opcode);
+        if (operandCount == 0) {
+            compiler->depth++;
+        }
+        else if (operandCount == 2) {
+            compiler->depth--;
+        }
+        if (compiler->depth > compiler->maxDepth) {
+            compiler->maxDepth = compiler->depth;
+        }
+    }
+    return status;
+}
+
+/*
+ * emitConstant
+ *
+ * Pushes a number.
+ */
+static int emitConstant(_compiler* compiler, double value)
+{
+    _expression* expression = compiler->expression;
+
+    if (expression->constantCount > EXPRESSION_MAX_OPERAND) {
+        return STATUS_INVALID_INPUT;
+    }
+    int status = reserveItems((void**)&expression->constants, &expression->constantCapacity,
+        expression->constantCount + 1, sizeof(double));
+    if (status == STATUS_SUCCESS) {
+        expression->constants[expression->constantCount] = value;
+        status = emitInstruction(compiler, EXPRESSION_OP_CONSTANT, (uint32_t)expression->constantCount++);
+    }
+    return status;
+}
+
+/*
+ * emitVariable
+ *
+ * Pushes a variable, adding its name in lower case when it is used for
+ * the first time, so X and x are the same variable.
+ */
+static int emitVariable(_compiler* compiler, const char* name, size_t length)
+{
+    _expression* expression = compiler->expression;
+    char folded[EXPRESSION_MAX_NAME_LENGTH + 1];
+    int index;
+    int status = STATUS_SUCCESS;
+
+    if (length > EXPRESSION_MAX_NAME_LENGTH) {
+        return STATUS_INVALID_INPUT;
+    }
+    for (size_t k = 0; k < length; k++) {
+        folded[k] = (char)tolower((unsigned char)name[k]);
+    }
+    folded[length] = '\0';
+    name = folded;
+    for (index = 0; index < expression->variableCount; index++) {
+        if (strcmp(expression->variables[index].text, name) == 0) {
+            break;
+        }
+    }
+    if (index == expression->variableCount) {
+        if (index > EXPRESSION_MAX_OPERAND) {
+            return STATUS_INVALID_INPUT;
+        }
+        status = reserveItems((void**)&expression->variables, &expression->variableCapacity,
+            index + 1, sizeof(_expressionName));
+        if (status == STATUS_SUCCESS) {
+            memcpy(expression->variables[index].text, name, length);
+            expression->variables[index].text[length] = '\0';
+            expression->variableCount++;
+        }
+    }
+    return (status == STATUS_SUCCESS) ? emitInstruction(compiler, EXPRESSION_OP_VARIABLE, (uint32_t)index) : status;
+}
+
+/*
+ * isFractional
+ *
+ * Whether an operator can turn integer operands into a fraction.
+ */
+static bool isFractional(_expressionOpcode opcode)
+{
+    switch (opcode) {
+    case EXPRESSION_OP_ADD:
+    case EXPRESSION_OP_SUB:
+    case EXPRESSION_OP_MUL:
+    case EXPRESSION_OP_MOD:
+    case EXPRESSION_OP_AND:
+    case EXPRESSION_OP_OR:
+    case EXPRESSION_OP_XOR:
+    case EXPRESSION_OP_LSH:
+    case EXPRESSION_OP_NEG:
+    case EXPRESSION_OP_NOT:
+    case EXPRESSION_OP_SQR:
+    case EXPRESSION_OP_CUBE:
+    case EXPRESSION_OP_INT:
+        return false;
+    default:
+        return true;
+    }
+}
+
+/*
+ * emitOperator
+ *
+ * Emits an operator taken off the pending stack. Trigonometric functions
+ * get the angle mode conversion around them, with the same factors
+ * performAdvancedCalculation uses. In the integer bases a result that
+ * can have a fraction is truncated.
+ */
+static int emitOperator(_compiler* compiler, _expressionOpcode opcode)
+{
+    double toRadians = 1.0;
+    int status = STATUS_SUCCESS;
+
+    if (compiler->angleMode == IDC_RADIO_DEG) {
+        toRadians = M_PI / 180.0;
+    }
+    else if (compiler->angleMode == IDC_RADIO_GRAD) {
+        toRadians = M_PI / 200.0;
+    }
+    bool isForwardTrig = opcode == EXPRESSION_OP_SIN || opcode == EXPRESSION_OP_COS || opcode == EXPRESSION_OP_TAN;
+    bool isInverseTrig = opcode == EXPRESSION_OP_ASIN || opcode == EXPRESSION_OP_ACOS || opcode == EXPRESSION_OP_ATAN;
+
+    if (isForwardTrig && toRadians != 1.0) {
+        status = emitConstant(compiler, toRadians);
+        if (status == STATUS_SUCCESS) {
+            status = emitInstruction(compiler, EXPRESSION_OP_MUL, 0);
+        }
+    }
+    if (status == STATUS_SUCCESS) {
+        status = emitInstruction(compiler, opcode, 0);
+    }
+    if (status == STATUS_SUCCESS && isInverseTrig && toRadians != 1.0) {
+        status = emitConstant(compiler, (compiler->angleMode == IDC_RADIO_DEG) ? 180.0 / M_PI : 200.0 / M_PI);
+        if (status == STATUS_SUCCESS) {
+            status = emitInstruction(compiler, EXPRESSION_OP_MUL, 0);
+        }
+    }
+    if (status == STATUS_SUCCESS && compiler->numberBase != 10 && isFractional(opcode)) {
+        status = emitInstruction(compiler, EXPRESSION_OP_INT, 0);
+    }
+    return status;
+}
+
+/*
+ * pushPending
+ */
+static int pushPending(_compiler* compiler, uint8_t opcode, uint8_t precedence)
+{
+    int status = reserveItems((void**)&compiler->pending, &compiler->pendingCapacity,
+        compiler->pendingCount + 1, sizeof(_pendingOperator));
+
+    if (status == STATUS_SUCCESS) {
+        compiler->pending[compiler->pendingCount].opcode = opcode;
+        compiler->pending[compiler->pendingCount].precedence = precedence;
+        compiler->pendingCount++;
+    }
+    return status;
+}
+
+/*
+ * pushBinaryOperator
+ *
+ * Emits the pending operators that bind at least as tightly, then makes
+ * this one pending. Equal precedence is evaluated left to right, as the
+ * keypad does.
+ */
+static int pushBinaryOperator(_compiler* compiler, const _operatorName* binaryOperator)
+{
+    int precedence = getOperatorPrecedence(binaryOperator->operatorKey);
+    int status = STATUS_SUCCESS;
+
+    while (status == STATUS_SUCCESS && compiler->pendingCount > 0) {
+        const _pendingOperator* top = &compiler->pending[compiler->pendingCount - 1];
+        if (top->opcode == PENDING_PARENTHESIS || top->precedence < precedence) {
+            break;
+        }
+        compiler->pendingCount--;
+        status = emitOperator(compiler, (_expressionOpcode)top->opcode);
+    }
+    return (status == STATUS_SUCCESS) ? pushPending(compiler, binaryOperator->opcode, (uint8_t)precedence) : status;
+}
+
+/*
+ * closeParenthesis
+ *
+ * Emits everything pending since the matching '(' and, when the
+ * parenthesis held a function argument, the function itself.
+ */
+static int closeParenthesis(_compiler* compiler)
+{
+    int status = STATUS_SUCCESS;
+
+    while (compiler->pendingCount > 0 && compiler->pending[compiler->pendingCount - 1].opcode != PENDING_PARENTHESIS) {
+        status = emitOperator(compiler, (_expressionOpcode)compiler->pending[--compiler->pendingCount].opcode);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+    if (compiler->pendingCount == 0) {
+        return STATUS_INVALID_INPUT;  // No matching '('
+    }
+    compiler->pendingCount--;
+    if (compiler->pendingCount > 0) {
+        const _pendingOperator* top = &compiler->pending[compiler->pendingCount - 1];
+        if (top->opcode != PENDING_PARENTHESIS && top->precedence == FUNCTION_PRECEDENCE) {
+            compiler->pendingCount--;
+            status = emitOperator(compiler, (_expressionOpcode)top->opcode);
+        }
+    }
+    return status;
+}
+
+/*
+ * findOperatorName
+ *
+ * Looks a case-insensitive name up in one of the operator tables.
+ */
+static const _operatorName* findOperatorName(const _operatorName* table, size_t tableSize, const char* name,
+    size_t length)
+{
+    for (size_t i = 0; i < tableSize; i++) {
+        size_t k = 0;
+        while (k < length && table[i].name[k] != '\0' &&
+               tolower((unsigned char)name[k]) == table[i].name[k]) {
+            k++;
+        }
+        if (k == length && table[i].name[k] == '\0') {
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * isNumberStart
+ */
+static bool isNumberStart(const char* cursor, int numberBase, char decimalSeparator)
+{
+    if (isdigit((unsigned char)cursor[0])) {
+        return true;
+    }
+    return numberBase == 10 && (cursor[0] == '.' || cursor[0] == decimalSeparator) &&
+           isdigit((unsigned char)cursor[1]);
+}
+
+/*
+ * getDigitValue
+ *
+ * The value of a digit or letter in bases up to 16, or 16 for any other
+ * character.
+ */
+static int getDigitValue(char c)
+{
+    if (isdigit((unsigned char)c)) {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : 16;
+}
+
+/*
+ * compileNumber
+ *
+ * Reads a number at *cursor and pushes it as a constant. In base 10 it
+ * may have '.' or decimalSeparator as the decimal point and an exponent;
+ * in the other bases it is an integer in that base.
+ */
+static int compileNumber(_compiler* compiler, const char** cursor, char decimalSeparator)
+{
+    char buffer[MAX_NUMBER_LENGTH];
+    const char* text = *cursor;
+    size_t length = 0;
+    bool hasPoint = false;
+
+    if (compiler->numberBase != 10) {
+        while (getDigitValue(*text) < compiler->numberBase && length < sizeof(buffer) - 1) {
+            buffer[length++] = *text++;
+        }
+        if (length >= sizeof(buffer) - 1 || isalnum((unsigned char)*text)) {
+            return STATUS_INVALID_INPUT;  // Too long, or a digit the base does not have
+        }
+        buffer[length] = '\0';
+        *cursor = text;
+        return emitConstant(compiler, (double)strtoll(buffer, NULL, compiler->numberBase));
+    }
+
+    while (length < sizeof(buffer) - 1) {
+        char c = *text;
+        if (c == '.' || c == decimalSeparator) {
+            if (hasPoint) {
+                break;
+            }
+            hasPoint = true;
+            c = '.';
+        }
+        else if ((c == 'e' || c == 'E') &&
+                 (isdigit((unsigned char)text[1]) ||
+                  ((text[1] == '+' || text[1] == '-') && isdigit((unsigned char)text[2])))) {
+            buffer[length++] = *text++;
+            c = *text;
+            if (c == '+' || c == '-') {
+                buffer[length++] = *text++;
+            }
+            while (isdigit((unsigned char)*text) && length < sizeof(buffer) - 1) {
+                buffer[length++] = *text++;
+            }
+            break;
+        }
+        else if (!isdigit((unsigned char)c)) {
+            break;
+        }
+        buffer[length++] = c;
+        text++;
+    }
+    if (length >= sizeof(buffer) - 1) {
+        return STATUS_INVALID_INPUT;
+    }
+    buffer[length] = '\0';
+    *cursor = text;
+    return emitConstant(compiler, strtod(buffer, NULL));
+}
+
+/*
+ * compileName
+ *
+ * Handles a name at *cursor: a word operator, a function (which must be
+ * followed by its parenthesized argument), pi or a variable.
+ */
+static int compileName(_compiler* compiler, const char** cursor, bool* isOperandExpected)
+{
+    const char* name = *cursor;
+    const char* text = name;
+    const _operatorName* entry;
+
+    while (isalnum((unsigned char)*text) || *text == '_') {
+        text++;
+    }
+    size_t length = (size_t)(text - name);
+    *cursor = text;
+
+    entry = findOperatorName(BINARY_OPERATORS, sizeof(BINARY_OPERATORS) / sizeof(BINARY_OPERATORS[0]), name, length);
+    if (entry != NULL) {
+        if (*isOperandExpected) {
+            return STATUS_INVALID_INPUT;
+        }
+        *isOperandExpected = true;
+        return pushBinaryOperator(compiler, entry);
+    }
+    if (!*isOperandExpected) {
+        return STATUS_INVALID_INPUT;  // Two operands in a row
+    }
+
+    entry = findOperatorName(FUNCTIONS, sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]), name, length);
+    if (entry != NULL) {
+        while (isspace((unsigned char)*text)) {
+            text++;
+        }
+        if (*text != '(') {
+            return STATUS_INVALID_INPUT;
+        }
+        *cursor = text + 1;
+        int status = pushPending(compiler, entry->opcode, FUNCTION_PRECEDENCE);
+        return (status == STATUS_SUCCESS) ? pushPending(compiler, PENDING_PARENTHESIS, 0) : status;
+    }
+
+    *isOperandExpected = false;
+    if (length == 2 && tolower((unsigned char)name[0]) == 'p' && tolower((unsigned char)name[1]) == 'i') {
+        int status = emitConstant(compiler, M_PI);
+        if (status == STATUS_SUCCESS && compiler->numberBase != 10) {
+            status = emitInstruction(compiler, EXPRESSION_OP_INT, 0);  // The keypad's pi is 3 there
+        }
+        return status;
+    }
+    return emitVariable(compiler, name, length);
+}
+
+/*
+ * expressionCompile
+ *
+ * Compiles infix text (see expression.h for the grammar) into expression,
+ * replacing what it held before. Trigonometric functions are compiled for
+ * the engine's current angle mode, numbers are read in its number base
+ * and may use its decimal separator.
+ *
+ * @param expression  Receives the instructions, constants and variables.
+ * @param text        The NUL-terminated formula.
+ * @param engine      Supplies angleMode, numberBase and decimalSeparator.
+ * @return            STATUS_SUCCESS, STATUS_INVALID_INPUT (errorPosition
+ *                    then holds the offset of the offending text) or
+ *                    STATUS_INSUFFICIENT_MEMORY. A failed expression
+ *                    evaluates to STATUS_INVALID_INPUT.
+ */
+int expressionCompile(_expression* expression, const char* text, const _calcEngine* engine)
+{
+    _compiler compiler = { 0 };
+    const char* cursor = text;
+    const char* position = text;
+    bool isOperandExpected = true;
+    int status = STATUS_SUCCESS;
+
+    expression->codeLength = 0;
+    expression->constantCount = 0;
+    expression->variableCount = 0;
+    expression->temporaryCount = 0;
+    expression->errorPosition = 0;
+    compiler.expression = expression;
+    compiler.angleMode = engine->angleMode;
+    compiler.numberBase = engine->numberBase;
+
+    while (status == STATUS_SUCCESS) {
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        position = cursor;
+        if (*cursor == '\0') {
+            break;
+        }
+
+        if (isNumberStart(cursor, engine->numberBase, engine->decimalSeparator)) {
+            if (!isOperandExpected) {
+                status = STATUS_INVALID_INPUT;
+                break;
+            }
+            status = compileNumber(&compiler, &cursor, engine->decimalSeparator);
+            isOperandExpected = false;
+        }
+        else if (isalpha((unsigned char)*cursor) || *cursor == '_') {
+            status = compileName(&compiler, &cursor, &isOperandExpected);
+        }
+        else if (*cursor == '(') {
+            status = isOperandExpected ? pushPending(&compiler, PENDING_PARENTHESIS, 0) : STATUS_INVALID_INPUT;
+            cursor++;
+        }
+        else if (*cursor == ')') {
+            status = isOperandExpected ? STATUS_INVALID_INPUT : closeParenthesis(&compiler);
+            cursor++;
+        }
+        else if (isOperandExpected && (*cursor == '-' || *cursor == '+')) {
+            if (*cursor == '-') {
+                status = pushPending(&compiler, EXPRESSION_OP_NEG, PREFIX_PRECEDENCE);
+            }
+            cursor++;
+        }
+        else {
+            const _operatorName* entry = findOperatorName(BINARY_OPERATORS,
+                sizeof(BINARY_OPERATORS) / sizeof(BINARY_OPERATORS[0]), cursor, 1);
+            status = (entry == NULL || isOperandExpected) ? STATUS_INVALID_INPUT : pushBinaryOperator(&compiler, entry);
+            isOperandExpected = true;
+            cursor++;
+        }
+    }
+
+    // The text must end with an operand and every '(' must be closed
+    if (status == STATUS_SUCCESS && isOperandExpected) {
+        status = STATUS_INVALID_INPUT;
+    }
+    while (status == STATUS_SUCCESS && compiler.pendingCount > 0) {
+        uint8_t opcode = compiler.pending[--compiler.pendingCount].opcode;
+        status = (opcode == PENDING_PARENTHESIS) ? STATUS_INVALID_INPUT
+                                                 : emitOperator(&compiler, (_expressionOpcode)opcode);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = emitInstruction(&compiler, EXPRESSION_OP_RETURN, 0);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = reserveItems((void**)&expression->stack, &expression->stackCapacity, compiler.maxDepth,
+            sizeof(double));
+        expression->stackSize = compiler.maxDepth;
+    }
+
+    free(compiler.pending);
+    if (status != STATUS_SUCCESS) {
+        expression->codeLength = 0;
+        expression->errorPosition = (size_t)(position - text);
+    }
+    return status;
+}
+
+/*
+ * expressionFindVariable
+ *
+ * Looks name up in any case; the names in variables are lower case.
+ *
+ * @return  The index of the named variable in the rows passed to
+ *          expressionEvaluate, or -1 if the formula does not use it.
+ */
+int expressionFindVariable(const _expression* expression, const char* name)
+{
+    for (int i = 0; i < expression->variableCount; i++) {
+        const char* text = expression->variables[i].text;
+        size_t k = 0;
+        while (text[k] != '\0' && tolower((unsigned char)name[k]) == text[k]) {
+            k++;
+        }
+        if (text[k] == '\0' && name[k] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#if EXPRESSION_THREADED_DISPATCH
+#define VM_CASE(name) label_##name:
+#define VM_NEXT() goto *dispatchTable[EXPRESSION_OPCODE(instruction = *pc++)]
+#else
+#define VM_CASE(name) case EXPRESSION_OP_##name:
+#define VM_NEXT() continue
+#endif
+
+/*
+ * expressionEvaluate
+ *
+ * Runs a compiled expression. Operators follow performAdvancedCalculation:
+ * the same domain checks fail with the same STATUS_* codes, and bitwise
+ * operators work on integer parts, failing with STATUS_INVALID_INPUT for
+ * operands beyond 64 bits. NaN and infinity are checked once, on
+ * the result, so an intermediate overflow that a later operator brings
+ * back into range (1/exp(1000)) is not an error here.
+ *
+ * @param expression  A successfully compiled expression.
+ * @param variables   One value per variable, in the order of
+ *                    expression->variables; may be NULL if there are none.
+ * @param result      Receives the value; unchanged on failure.
+ * @return            STATUS_SUCCESS or one of the STATUS_* error codes.
+ */
+int expressionEvaluate(_expression* expression, const double* variables, double* result)
+{
+    const uint32_t* pc = expression->code;
+    const double* constants = expression->constants;
+    double* top = expression->stack;  // Next free slot
+    double* temporaries = expression->stack + expression->stackSize;
+    uint32_t instruction;
+    double value;
+
+    if (expression->codeLength == 0) {
+        return STATUS_INVALID_INPUT;
+    }
+
+#if EXPRESSION_THREADED_DISPATCH
+    static const void* const dispatchTable[EXPRESSION_OPCODE_COUNT] = {
+        [EXPRESSION_OP_RETURN] = &&label_RETURN, [EXPRESSION_OP_CONSTANT] = &&label_CONSTANT,
+        [EXPRESSION_OP_VARIABLE] = &&label_VARIABLE, [EXPRESSION_OP_LOAD] = &&label_LOAD,
+        [EXPRESSION_OP_STORE] = &&label_STORE, [EXPRESSION_OP_ADD] = &&label_ADD,
+        [EXPRESSION_OP_SUB] = &&label_SUB, [EXPRESSION_OP_MUL] = &&label_MUL,
+        [EXPRESSION_OP_DIV] = &&label_DIV, [EXPRESSION_OP_MOD] = &&label_MOD,
+        [EXPRESSION_OP_POW] = &&label_POW, [EXPRESSION_OP_AND] = &&label_AND,
+        [EXPRESSION_OP_OR] = &&label_OR, [EXPRESSION_OP_XOR] = &&label_XOR,
+        [EXPRESSION_OP_LSH] = &&label_LSH, [EXPRESSION_OP_NEG] = &&label_NEG,
+        [EXPRESSION_OP_NOT] = &&label_NOT, [EXPRESSION_OP_SQRT] = &&label_SQRT,
+        [EXPRESSION_OP_SQR] = &&label_SQR, [EXPRESSION_OP_CUBE] = &&label_CUBE,
+        [EXPRESSION_OP_INV] = &&label_INV, [EXPRESSION_OP_SIN] = &&label_SIN,
+        [EXPRESSION_OP_COS] = &&label_COS, [EXPRESSION_OP_TAN] = &&label_TAN,
+        [EXPRESSION_OP_ASIN] = &&label_ASIN, [EXPRESSION_OP_ACOS] = &&label_ACOS,
+        [EXPRESSION_OP_ATAN] = &&label_ATAN, [EXPRESSION_OP_LOG] = &&label_LOG,
+        [EXPRESSION_OP_LN] = &&label_LN, [EXPRESSION_OP_EXP] = &&label_EXP,
+        [EXPRESSION_OP_FACT] = &&label_FACT, [EXPRESSION_OP_INT] = &&label_INT,
+    };
+
+    VM_NEXT();
+    {
+#else
+    for (;;) {
+        instruction = *pc++;
+        switch (EXPRESSION_OPCODE(instruction)) {
+#endif
+        VM_CASE(CONSTANT)
+            *top++ = constants[EXPRESSION_OPERAND(instruction)];
+            VM_NEXT();
+        VM_CASE(VARIABLE)
+            *top++ = variables[EXPRESSION_OPERAND(instruction)];
+            VM_NEXT();
+        VM_CASE(LOAD)
+            *top++ = temporaries[EXPRESSION_OPERAND(instruction)];
+            VM_NEXT();
+        VM_CASE(STORE)
+            temporaries[EXPRESSION_OPERAND(instruction)] = top[-1];
+            VM_NEXT();
+
+        VM_CASE(ADD)
+            top--;
+            top[-1] += top[0];
+            VM_NEXT();
+        VM_CASE(SUB)
+            top--;
+            top[-1] -= top[0];
+            VM_NEXT();
+        VM_CASE(MUL)
+            top--;
+            top[-1] *= top[0];
+            VM_NEXT();
+        VM_CASE(DIV)
+            top--;
+            if (top[0] == 0.0) {
+                return STATUS_DIVISION_BY_ZERO;
+            }
+            top[-1] /= top[0];
+            VM_NEXT();
+        VM_CASE(MOD)
+            top--;
+            if (top[0] == 0.0) {
+                return STATUS_DIVISION_BY_ZERO;
+            }
+            top[-1] = fmod(top[-1], top[0]);
+            VM_NEXT();
+        VM_CASE(POW)
+            top--;
+            top[-1] = pow(top[-1], top[0]);
+            VM_NEXT();
+        VM_CASE(AND)
+            top--;
+            if (!isInt64Range(top[-1]) || !isInt64Range(top[0])) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = (double)((int64_t)top[-1] & (int64_t)top[0]);
+            VM_NEXT();
+        VM_CASE(OR)
+            top--;
+            if (!isInt64Range(top[-1]) || !isInt64Range(top[0])) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = (double)((int64_t)top[-1] | (int64_t)top[0]);
+            VM_NEXT();
+        VM_CASE(XOR)
+            top--;
+            if (!isInt64Range(top[-1]) || !isInt64Range(top[0])) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = (double)((int64_t)top[-1] ^ (int64_t)top[0]);
+            VM_NEXT();
+        VM_CASE(LSH)
+            top--;
+            if (!(top[0] >= 0.0 && top[0] < 64.0) || !isInt64Range(top[-1])) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = (double)(int64_t)((uint64_t)(int64_t)top[-1] << (int)top[0]);
+            VM_NEXT();
+
+        VM_CASE(NEG)
+            top[-1] = -top[-1];
+            VM_NEXT();
+        VM_CASE(NOT)
+            if (!isInt64Range(top[-1])) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = (double)(~(int64_t)top[-1]);
+            VM_NEXT();
+        VM_CASE(SQRT)
+            if (top[-1] < 0.0) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = sqrt(top[-1]);
+            VM_NEXT();
+        VM_CASE(SQR)
+            top[-1] *= top[-1];
+            VM_NEXT();
+        VM_CASE(CUBE)
+            top[-1] = top[-1] * top[-1] * top[-1];
+            VM_NEXT();
+        VM_CASE(INV)
+            if (top[-1] == 0.0) {
+                return STATUS_DIVISION_BY_ZERO;
+            }
+            top[-1] = 1.0 / top[-1];
+            VM_NEXT();
+        VM_CASE(SIN)
+            top[-1] = sin(top[-1]);
+            VM_NEXT();
+        VM_CASE(COS)
+            top[-1] = cos(top[-1]);
+            VM_NEXT();
+        VM_CASE(TAN)
+            top[-1] = tan(top[-1]);
+            VM_NEXT();
+        VM_CASE(ASIN)
+            if (top[-1] < -1.0 || top[-1] > 1.0) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = asin(top[-1]);
+            VM_NEXT();
+        VM_CASE(ACOS)
+            if (top[-1] < -1.0 || top[-1] > 1.0) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = acos(top[-1]);
+            VM_NEXT();
+        VM_CASE(ATAN)
+            top[-1] = atan(top[-1]);
+            VM_NEXT();
+        VM_CASE(LOG)
+            if (top[-1] <= 0.0) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = log10(top[-1]);
+            VM_NEXT();
+        VM_CASE(LN)
+            if (top[-1] <= 0.0) {
+                return STATUS_INVALID_INPUT;
+            }
+            top[-1] = log(top[-1]);
+            VM_NEXT();
+        VM_CASE(EXP)
+            top[-1] = exp(top[-1]);
+            VM_NEXT();
+        VM_CASE(FACT)
+            if (top[-1] < 0.0 && top[-1] == floor(top[-1])) {
+                return STATUS_UNDEFINED_RESULT;
+            }
+            top[-1] = tgamma(top[-1] + 1.0);
+            VM_NEXT();
+        VM_CASE(INT)
+            top[-1] = trunc(top[-1]);
+            VM_NEXT();
+
+        VM_CASE(RETURN)
+            value = top[-1];
+            if (isnan(value)) {
+                return STATUS_UNDEFINED_RESULT;
+            }
+            if (isinf(value)) {
+                return STATUS_OVERFLOW;
+            }
+            *result = value;
+            return STATUS_SUCCESS;
+#if EXPRESSION_THREADED_DISPATCH
+    }
+#else
+        default:
+            return STATUS_INVALID_INPUT;
+        }
+    }
+#endif
+}
+
+#undef VM_CASE
+#undef VM_NEXT
+
+/*
+ * expressionEvaluateBatch
+ *
+ * Evaluates the expression once per row of variables. Rows that fail get
+ * a NaN result.
+ *
+ * @param expression  A successfully compiled expression.
+ * @param variables   count rows of expression->variableCount values, one
+ *                    row after the other; may be NULL if there are no
+ *                    variables.
+ * @param count       Number of rows.
+ * @param results     Receives count values.
+ * @return            STATUS_SUCCESS, or the status of the first row that
+ *                    failed.
+ */
+int expressionEvaluateBatch(_expression* expression, const double* variables, size_t count, double* results)
+{
+    int firstStatus = STATUS_SUCCESS;
+
+    for (size_t i = 0; i < count; i++) {
+        const double* row = (variables != NULL) ? variables + i * (size_t)expression->variableCount : NULL;
+        int status = expressionEvaluate(expression, row, &results[i]);
+        if (status != STATUS_SUCCESS) {
+            results[i] = NAN;
+            if (firstStatus == STATUS_SUCCESS) {
+                firstStatus = status;
+            }
+        }
+    }
+    return firstStatus;
+}
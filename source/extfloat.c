@@ -0,0 +1,900 @@
+/*-----------------------------------------------------------------------------
+    extfloat.c --  Software 80-bit extended precision arithmetic for the
+                   calculator engine (reconstructed code).
+
+               This module gives SCIENTIFIC_NOTATION mode its 64-bit
+               mantissa on platforms whose long double is not the x87
+               format (x64 MSVC, ARM). Values are unpacked into a sign, an
+               unbiased exponent and a normalized 64-bit mantissa, computed
+               on 128-bit intermediates held as two 64-bit limbs, and
+               rounded once when packed.
+
+               Key functions include:
+
+               - extendedFloat80Add / Sub / Mul / Div / Sqrt: Correctly
+                                              rounded arithmetic.
+               - extendedFloat80Compare: Ordered comparison with NaN
+                                         detection.
+               - extendedFloat80FromDouble / ToDouble,
+                 extendedFloat80FromBigDecimal: Conversions.
+               - extendedFloat80FromString: Correctly rounded decimal
+                                            parsing (exact powers of ten,
+                                            then Eisel-Lemire, then an
+                                            exact _bigDecimal fallback).
+               - extendedFloat80AddArray etc.: Batch versions for arrays.
+
+               The 64x64->128 multiply, 128/64 divide and leading-zero
+               count come from wideint.h.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <string.h>
+#include ".//headers//bignum.h"
+#include ".//headers//extfloat.h"
+#include ".//headers//powers.h"
+#include ".//headers//wideint.h"
+
+#define MANTISSA_TOP 0x8000000000000000ull
+#define QUIET_NAN_MANTISSA 0xC000000000000000ull
+
+#define MAX_EXACT_POWER_OF_TEN 27       // 10^27 = 5^27 * 2^27 and 5^27 < 2^64
+#define MAX_PARSED_DIGITS 19            // Digits that always fit in a uint64_t
+#define MAX_DECIMAL_EXPONENT 4933       // 10^4933 is above the largest value
+#define MIN_DECIMAL_EXPONENT (-4952)    // 10^-4952 rounds to zero
+
+typedef enum {
+    CLASS_ZERO,
+    CLASS_FINITE,
+    CLASS_INFINITY,
+    CLASS_NAN
+} _extendedClass;
+
+// An unpacked value: mantissa * 2^(exponent - 63), mantissa bit 63 set
+typedef struct {
+    _extendedClass type;
+    int sign;
+    int32_t exponent;
+    uint64_t mantissa;
+} _unpackedExtended;
+
+/*
+ * 128-bit helpers.
+ */
+
+// Shifts (high:low) right, ORing every bit shifted out into bit 0 of low
+static inline void shiftRightSticky(uint64_t* high, uint64_t* low, int shift)
+{
+    if (shift == 0) {
+        return;
+    }
+    if (shift < 64) {
+        uint64_t sticky = (*low << (64 - shift)) != 0;
+        *low = (*low >> shift) | (*high << (64 - shift)) | sticky;
+        *high >>= shift;
+    }
+    else if (shift < 128) {
+        uint64_t sticky = (*low != 0) || (shift > 64 && (*high << (128 - shift)) != 0);
+        *low = ((shift == 64) ? *high : *high >> (shift - 64)) | sticky;
+        *high = 0;
+    }
+    else {
+        *low = (*high | *low) != 0;
+        *high = 0;
+    }
+}
+
+/*
+ * Packing and unpacking.
+ */
+
+static inline uint64_t getMantissa(const _extendedFloat80* value)
+{
+    return ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+}
+
+static inline void setExtended(_extendedFloat80* result, int sign, uint32_t biasedExponent, uint64_t mantissa)
+{
+    result->exponent = (uint16_t)(biasedExponent | (sign ? EXTENDED_FLOAT_SIGN : 0));
+    result->mantissaHigh = (uint32_t)(mantissa >> 32);
+    result->mantissaLow = (uint32_t)mantissa;
+}
+
+static inline void unpackExtended(_unpackedExtended* unpacked, const _extendedFloat80* value)
+{
+    uint32_t biasedExponent = value->exponent & EXTENDED_FLOAT_MAX_EXPONENT;
+    uint64_t mantissa = getMantissa(value);
+
+    unpacked->sign = (value->exponent & EXTENDED_FLOAT_SIGN) != 0;
+    unpacked->exponent = 0;
+    unpacked->mantissa = mantissa;
+    if (biasedExponent == EXTENDED_FLOAT_MAX_EXPONENT) {
+        unpacked->type = ((mantissa << 1) == 0) ? CLASS_INFINITY : CLASS_NAN;
+        return;
+    }
+    if (mantissa == 0) {
+        unpacked->type = CLASS_ZERO;
+        return;
+    }
+
+    // Denormals (and unnormals) are normalized here; denormals use the
+    // minimum exponent 1 - bias.
+    int shift = countLeadingZeros64(mantissa);
+    unpacked->type = CLASS_FINITE;
+    unpacked->mantissa = mantissa << shift;
+    unpacked->exponent = (int32_t)((biasedExponent == 0) ? 1 : biasedExponent) - EXTENDED_FLOAT_BIAS - shift;
+}
+
+/*
+ * packExtended
+ *
+ * Rounds (high.low) * 2^(exponent - 63) to nearest-even and stores it.
+ * high must have bit 63 set; low holds the fraction bits below the
+ * mantissa, with any lost bits ORed into bit 0.
+ */
+static int packExtended(_extendedFloat80* result, int sign, int32_t exponent, uint64_t high, uint64_t low)
+{
+    int32_t biasedExponent = exponent + EXTENDED_FLOAT_BIAS;
+    bool isTiny = false;
+
+    if (biasedExponent >= EXTENDED_FLOAT_MAX_EXPONENT) {
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_OVERFLOW;
+    }
+    if (biasedExponent <= 0) {
+        // Gradual underflow: denormals keep the minimum exponent
+        int shift = 1 - biasedExponent;
+        shiftRightSticky(&high, &low, (shift > 128) ? 128 : shift);
+        biasedExponent = 0;
+        isTiny = true;
+    }
+
+    bool isInexact = low != 0;
+    if (low > MANTISSA_TOP || (low == MANTISSA_TOP && (high & 1))) {
+        high++;
+        if (high == 0) {
+            high = MANTISSA_TOP;
+            biasedExponent++;
+            if (biasedExponent >= EXTENDED_FLOAT_MAX_EXPONENT) {
+                setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+                return STATUS_OVERFLOW;
+            }
+        }
+        else if (biasedExponent == 0 && (high & MANTISSA_TOP)) {
+            biasedExponent = 1; // Rounded up from denormal to normal
+        }
+    }
+
+    setExtended(result, sign, (uint32_t)biasedExponent, high);
+    return (isTiny && isInexact) ? STATUS_UNDERFLOW : STATUS_SUCCESS;
+}
+
+static int setNaN(_extendedFloat80* result, const _unpackedExtended* a, const _unpackedExtended* b)
+{
+    // Propagate an operand NaN (quieted), otherwise produce the default NaN
+    if (a->type == CLASS_NAN) {
+        setExtended(result, a->sign, EXTENDED_FLOAT_MAX_EXPONENT, a->mantissa | QUIET_NAN_MANTISSA);
+    }
+    else if (b != NULL && b->type == CLASS_NAN) {
+        setExtended(result, b->sign, EXTENDED_FLOAT_MAX_EXPONENT, b->mantissa | QUIET_NAN_MANTISSA);
+    }
+    else {
+        setExtended(result, 1, EXTENDED_FLOAT_MAX_EXPONENT, QUIET_NAN_MANTISSA);
+    }
+    return STATUS_UNDEFINED_RESULT;
+}
+
+static int setFromUnpacked(_extendedFloat80* result, const _unpackedExtended* value, int sign)
+{
+    switch (value->type) {
+    case CLASS_ZERO:
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    case CLASS_INFINITY:
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_SUCCESS;
+    default:
+        return packExtended(result, sign, value->exponent, value->mantissa, 0);
+    }
+}
+
+/*
+ * addUnpacked
+ *
+ * a + b for two unpacked operands; the caller flips b's sign to subtract.
+ */
+static int addUnpacked(_extendedFloat80* result, const _unpackedExtended* a, const _unpackedExtended* b)
+{
+    if (a->type == CLASS_NAN || b->type == CLASS_NAN) {
+        return setNaN(result, a, b);
+    }
+    if (a->type == CLASS_INFINITY) {
+        if (b->type == CLASS_INFINITY && a->sign != b->sign) {
+            return setNaN(result, a, b);
+        }
+        return setFromUnpacked(result, a, a->sign);
+    }
+    if (b->type == CLASS_INFINITY) {
+        return setFromUnpacked(result, b, b->sign);
+    }
+    if (a->type == CLASS_ZERO) {
+        return setFromUnpacked(result, b, (b->type == CLASS_ZERO) ? (a->sign & b->sign) : b->sign);
+    }
+    if (b->type == CLASS_ZERO) {
+        return setFromUnpacked(result, a, a->sign);
+    }
+
+    // Make a the operand with the larger magnitude
+    if (b->exponent > a->exponent || (b->exponent == a->exponent && b->mantissa > a->mantissa)) {
+        const _unpackedExtended* swap = a;
+        a = b;
+        b = swap;
+    }
+
+    int32_t exponent = a->exponent;
+    uint64_t high = a->mantissa;
+    uint64_t bHigh = b->mantissa;
+    uint64_t bLow = 0;
+    int32_t difference = a->exponent - b->exponent;
+    shiftRightSticky(&bHigh, &bLow, (difference > 128) ? 128 : (int)difference);
+
+    if (a->sign == b->sign) {
+        uint64_t low = bLow;
+        high += bHigh;
+        if (high < bHigh) {
+            // Carry out of bit 63: renormalize
+            low = (low >> 1) | (high << 63) | (low & 1);
+            high = (high >> 1) | MANTISSA_TOP;
+            exponent++;
+        }
+        return packExtended(result, a->sign, exponent, high, low);
+    }
+
+    uint64_t low = 0 - bLow;
+    high = high - bHigh - (bLow != 0);
+    if (high == 0 && low == 0) {
+        setExtended(result, 0, 0, 0); // x - x is +0 when rounding to nearest
+        return STATUS_SUCCESS;
+    }
+
+    int shift = (high != 0) ? countLeadingZeros64(high) : 64 + countLeadingZeros64(low);
+    if (shift >= 64) {
+        high = low << (shift - 64);
+        low = 0;
+    }
+    else if (shift > 0) {
+        high = (high << shift) | (low >> (64 - shift));
+        low <<= shift;
+    }
+    return packExtended(result, a->sign, exponent - shift, high, low);
+}
+
+/*
+ * extendedFloat80Add
+ *
+ * result = a + b, correctly rounded.
+ *
+ * @return  STATUS_SUCCESS or a STATUS_* code describing the result.
+ */
+int extendedFloat80Add(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    _unpackedExtended x, y;
+    unpackExtended(&x, a);
+    unpackExtended(&y, b);
+    return addUnpacked(result, &x, &y);
+}
+
+/*
+ * extendedFloat80Sub
+ *
+ * result = a - b, correctly rounded.
+ */
+int extendedFloat80Sub(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    _unpackedExtended x, y;
+    unpackExtended(&x, a);
+    unpackExtended(&y, b);
+    if (y.type != CLASS_NAN) {
+        y.sign ^= 1;
+    }
+    return addUnpacked(result, &x, &y);
+}
+
+/*
+ * extendedFloat80Mul
+ *
+ * result = a * b. The 128-bit mantissa product is rounded once.
+ */
+int extendedFloat80Mul(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    _unpackedExtended x, y;
+    unpackExtended(&x, a);
+    unpackExtended(&y, b);
+    int sign = x.sign ^ y.sign;
+
+    if (x.type == CLASS_NAN || y.type == CLASS_NAN) {
+        return setNaN(result, &x, &y);
+    }
+    if (x.type == CLASS_INFINITY || y.type == CLASS_INFINITY) {
+        if (x.type == CLASS_ZERO || y.type == CLASS_ZERO) {
+            return setNaN(result, &x, &y);
+        }
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_SUCCESS;
+    }
+    if (x.type == CLASS_ZERO || y.type == CLASS_ZERO) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    }
+
+    uint64_t high;
+    uint64_t low = multiply64(x.mantissa, y.mantissa, &high);
+    int32_t exponent = x.exponent + y.exponent;
+
+    if (high & MANTISSA_TOP) {
+        exponent++;
+    }
+    else {
+        high = (high << 1) | (low >> 63);
+        low <<= 1;
+    }
+    return packExtended(result, sign, exponent, high, low);
+}
+
+/*
+ * extendedFloat80Div
+ *
+ * result = a / b. Two 128/64 divisions give 128 quotient bits; the final
+ * remainder becomes the sticky bit.
+ */
+int extendedFloat80Div(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    _unpackedExtended x, y;
+    unpackExtended(&x, a);
+    unpackExtended(&y, b);
+    int sign = x.sign ^ y.sign;
+
+    if (x.type == CLASS_NAN || y.type == CLASS_NAN) {
+        return setNaN(result, &x, &y);
+    }
+    if (x.type == CLASS_INFINITY) {
+        if (y.type == CLASS_INFINITY) {
+            return setNaN(result, &x, &y);
+        }
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_SUCCESS;
+    }
+    if (y.type == CLASS_INFINITY) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    }
+    if (y.type == CLASS_ZERO) {
+        if (x.type == CLASS_ZERO) {
+            return setNaN(result, &x, &y);
+        }
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_DIVISION_BY_ZERO;
+    }
+    if (x.type == CLASS_ZERO) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    }
+
+    uint64_t numerator = x.mantissa;
+    uint64_t remainder;
+    bool hasTopBit = numerator >= y.mantissa;
+    if (hasTopBit) {
+        numerator -= y.mantissa;
+    }
+    uint64_t high = divide128(numerator, 0, y.mantissa, &remainder);
+    uint64_t low = divide128(remainder, 0, y.mantissa, &remainder);
+    low |= (remainder != 0);
+
+    int32_t exponent = x.exponent - y.exponent;
+    if (hasTopBit) {
+        // The quotient is 2^64 + high:low; drop one bit into the sticky
+        low = (low >> 1) | (high << 63) | (low & 1);
+        high = (high >> 1) | MANTISSA_TOP;
+    }
+    else {
+        exponent--;
+    }
+    return packExtended(result, sign, exponent, high, low);
+}
+
+/*
+ * extendedFloat80Sqrt
+ *
+ * result = sqrt(a). The mantissa is widened to a 128-bit radicand with an
+ * even exponent and its integer square root is found with a double
+ * estimate, one Newton step and a final correction. A square root is
+ * never exactly halfway between two mantissas, so comparing the
+ * remainder with the root decides the rounding.
+ */
+int extendedFloat80Sqrt(_extendedFloat80* result, const _extendedFloat80* a)
+{
+    _unpackedExtended x;
+    unpackExtended(&x, a);
+
+    if (x.type == CLASS_NAN) {
+        return setNaN(result, &x, NULL);
+    }
+    if (x.type == CLASS_ZERO) {
+        setExtended(result, x.sign, 0, 0); // sqrt(-0) is -0
+        return STATUS_SUCCESS;
+    }
+    if (x.sign) {
+        return setNaN(result, &x, NULL);
+    }
+    if (x.type == CLASS_INFINITY) {
+        setExtended(result, 0, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_SUCCESS;
+    }
+
+    // Radicand R = mantissa * 2^64 (odd exponent) or * 2^63 (even exponent)
+    uint64_t radicandHigh, radicandLow;
+    if (x.exponent & 1) {
+        radicandHigh = x.mantissa;
+        radicandLow = 0;
+    }
+    else {
+        radicandHigh = x.mantissa >> 1;
+        radicandLow = x.mantissa << 63;
+    }
+
+    double estimate = sqrt(ldexp((double)radicandHigh, 64) + (double)radicandLow);
+    uint64_t root = (estimate >= 18446744073709551615.0) ? UINT64_MAX : (uint64_t)estimate;
+    uint64_t remainder, squareHigh, squareLow;
+
+    // One Newton step brings the 53-bit estimate within one unit
+    if (root != 0 && radicandHigh < root) {
+        uint64_t quotient = divide128(radicandHigh, radicandLow, root, &remainder);
+        uint64_t sum = root + quotient;
+        root = (sum >> 1) | ((uint64_t)(sum < root) << 63);
+    }
+
+    // Correct to floor(sqrt(R))
+    for (;;) {
+        squareLow = multiply64(root, root, &squareHigh);
+        if (squareHigh > radicandHigh || (squareHigh == radicandHigh && squareLow > radicandLow)) {
+            root--;
+            continue;
+        }
+        if (root == UINT64_MAX) {
+            break;
+        }
+        uint64_t nextHigh;
+        uint64_t nextLow = multiply64(root + 1, root + 1, &nextHigh);
+        if (nextHigh < radicandHigh || (nextHigh == radicandHigh && nextLow <= radicandLow)) {
+            root++;
+            continue;
+        }
+        break;
+    }
+
+    // remainder = R - root^2 (fits in 65 bits); round up when remainder > root
+    uint64_t differenceLow = radicandLow - squareLow;
+    uint64_t differenceHigh = radicandHigh - squareHigh - (radicandLow < squareLow);
+    uint64_t low = 0;
+    if (differenceHigh != 0 || differenceLow > root) {
+        low = MANTISSA_TOP | 1;
+    }
+    else if (differenceLow != 0) {
+        low = 1;
+    }
+    return packExtended(result, 0, x.exponent >> 1, root, low);
+}
+
+/*
+ * extendedFloat80Compare
+ *
+ * Returns -1, 0 or 1 as a is less than, equal to or greater than b, or
+ * EXTENDED_FLOAT_UNORDERED if either is a NaN. +0 and -0 compare equal.
+ */
+int extendedFloat80Compare(const _extendedFloat80* a, const _extendedFloat80* b)
+{
+    _unpackedExtended x, y;
+    unpackExtended(&x, a);
+    unpackExtended(&y, b);
+
+    if (x.type == CLASS_NAN || y.type == CLASS_NAN) {
+        return EXTENDED_FLOAT_UNORDERED;
+    }
+    if (x.type == CLASS_ZERO && y.type == CLASS_ZERO) {
+        return 0;
+    }
+    if (x.type == CLASS_ZERO || y.type == CLASS_ZERO || x.sign != y.sign) {
+        // Different signs, or one side is zero
+        int xSign = (x.type == CLASS_ZERO) ? 0 : (x.sign ? -1 : 1);
+        int ySign = (y.type == CLASS_ZERO) ? 0 : (y.sign ? -1 : 1);
+        return (xSign > ySign) ? 1 : -1;
+    }
+
+    int magnitude;
+    if (x.type == CLASS_INFINITY || y.type == CLASS_INFINITY) {
+        magnitude = (x.type == y.type) ? 0 : (x.type == CLASS_INFINITY ? 1 : -1);
+    }
+    else if (x.exponent != y.exponent) {
+        magnitude = (x.exponent > y.exponent) ? 1 : -1;
+    }
+    else {
+        magnitude = (x.mantissa > y.mantissa) - (x.mantissa < y.mantissa);
+    }
+    return x.sign ? -magnitude : magnitude;
+}
+
+/*
+ * extendedFloat80FromDouble
+ *
+ * Exact conversion; double denormals become normal extended values.
+ */
+int extendedFloat80FromDouble(_extendedFloat80* result, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int sign = (int)(bits >> 63);
+    uint32_t exponent = (uint32_t)(bits >> 52) & 0x7FF;
+    uint64_t fraction = bits & 0xFFFFFFFFFFFFFull;
+
+    if (exponent == 0x7FF) {
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP | (fraction << 11));
+        return (fraction != 0) ? STATUS_UNDEFINED_RESULT : STATUS_SUCCESS;
+    }
+    if (exponent == 0) {
+        if (fraction == 0) {
+            setExtended(result, sign, 0, 0);
+            return STATUS_SUCCESS;
+        }
+        int shift = countLeadingZeros64(fraction);
+        setExtended(result, sign, (uint32_t)(EXTENDED_FLOAT_BIAS - 1022 - 1 - (shift - 12)), fraction << shift);
+        return STATUS_SUCCESS;
+    }
+    setExtended(result, sign, exponent - 1023 + EXTENDED_FLOAT_BIAS, MANTISSA_TOP | (fraction << 11));
+    return STATUS_SUCCESS;
+}
+
+/*
+ * extendedFloat80ToDouble
+ *
+ * Rounds to the nearest double (ties to even), producing double denormals,
+ * zero or infinity when the value is outside the double range.
+ */
+double extendedFloat80ToDouble(const _extendedFloat80* value)
+{
+    _unpackedExtended x;
+    uint64_t bits;
+    double result;
+
+    unpackExtended(&x, value);
+    bits = (uint64_t)x.sign << 63;
+
+    if (x.type == CLASS_NAN) {
+        bits |= 0x7FF8000000000000ull | (x.mantissa << 1 >> 12);
+    }
+    else if (x.type == CLASS_INFINITY || (x.type == CLASS_FINITE && x.exponent > 1023)) {
+        bits |= 0x7FF0000000000000ull;
+    }
+    else if (x.type == CLASS_FINITE) {
+        // Keep 53 bits (fewer for double denormals) and round the rest
+        int shift = 11 + ((x.exponent < -1022) ? -1022 - x.exponent : 0);
+        uint64_t kept, roundBits;
+        if (shift >= 64) {
+            kept = 0;
+            roundBits = (shift == 64) ? x.mantissa : 1; // Far below half of the smallest denormal
+        }
+        else {
+            kept = x.mantissa >> shift;
+            roundBits = x.mantissa << (64 - shift);
+        }
+        if (roundBits > MANTISSA_TOP || (roundBits == MANTISSA_TOP && (kept & 1))) {
+            kept++;
+        }
+        // kept carries the implicit bit into the exponent field, which also
+        // handles denormals rounding up to normal and 2^1024 overflow
+        uint64_t biased = (x.exponent < -1022) ? 0 : (uint64_t)(x.exponent + 1022);
+        bits |= (biased << 52) + kept;
+    }
+
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/*
+ * powerOfTenExtended
+ *
+ * Exact 10^power for 0 <= power <= MAX_EXACT_POWER_OF_TEN.
+ */
+static void powerOfTenExtended(_extendedFloat80* result, int power)
+{
+    uint64_t fivePower = 1;
+    for (int i = 0; i < power; i++) {
+        fivePower *= 5;
+    }
+    int shift = countLeadingZeros64(fivePower);
+    setExtended(result, 0, (uint32_t)(power - shift + 63 + EXTENDED_FLOAT_BIAS), fivePower << shift);
+}
+
+/*
+ * computeEiselLemire
+ *
+ * Approximates digits * 10^power with the 128-bit truncated power of five
+ * from powers.c. The upper 128 bits of the 192-bit product are within two
+ * units of their last bit from the true value, so the rounding of the
+ * 64-bit mantissa is known unless the bits below it are within that
+ * distance of one half. Returns false in that case (or when power is
+ * outside the table) and the caller falls back to exact arithmetic.
+ *
+ * On success value = mantissa * 2^(exponent - 63), mantissa bit 63 set.
+ */
+static bool computeEiselLemire(uint64_t digits, int64_t power, uint64_t* mantissa, int32_t* exponent)
+{
+    if (power < POWERS_OF_FIVE_MIN_EXPONENT || power > POWERS_OF_FIVE_MAX_EXPONENT) {
+        return false;
+    }
+
+    const uint64_t* fivePower = POWERS_OF_FIVE_128[power - POWERS_OF_FIVE_MIN_EXPONENT];
+    int shift = countLeadingZeros64(digits);
+    uint64_t w = digits << shift;
+    uint64_t firstHigh, secondHigh;
+    uint64_t firstLow = multiply64(w, fivePower[0], &firstHigh);
+    uint64_t low = multiply64(w, fivePower[1], &secondHigh);
+    uint64_t middle = firstLow + secondHigh;
+    uint64_t high = firstHigh + (middle < secondHigh);
+    uint64_t errorUnits = 2;
+    bool isExact = power >= 0 && power <= POWERS_OF_FIVE_EXACT_LIMIT;
+    int32_t binaryExponent = (int32_t)(64 + FLOOR_LOG2_POW5(power) + power - shift);
+
+    if ((high & MANTISSA_TOP) == 0) {
+        high = (high << 1) | (middle >> 63);
+        middle = (middle << 1) | (low >> 63);
+        low <<= 1;
+        binaryExponent--;
+        errorUnits = 4;
+    }
+
+    bool roundUp;
+    if (isExact) {
+        roundUp = middle > MANTISSA_TOP || (middle == MANTISSA_TOP && (low != 0 || (high & 1)));
+    }
+    else if (middle > MANTISSA_TOP) {
+        roundUp = true;
+    }
+    else if (middle < MANTISSA_TOP - errorUnits) {
+        roundUp = false;
+    }
+    else {
+        return false;
+    }
+
+    if (roundUp && ++high == 0) {
+        high = MANTISSA_TOP;
+        binaryExponent++;
+    }
+    *mantissa = high;
+    *exponent = binaryExponent;
+    return true;
+}
+
+/*
+ * extendedFloat80FromString
+ *
+ * Parses [+|-]digits[.digits][e[+|-]digits] into the nearest 80-bit value
+ * (ties to even). Both '.' and decimalSeparator are accepted as the
+ * decimal point, so the same function serves the typed entry and pasted
+ * text; leading and trailing blanks are ignored.
+ *
+ * The first 19 significant digits are gathered into a 64-bit integer w and
+ * the value is w * 10^q:
+ *
+ * 1. If no digits were dropped and |q| <= 27, 10^|q| is exact and one
+ *    correctly rounded multiply or divide gives the result.
+ * 2. Otherwise Eisel-Lemire decides the rounding from a 128-bit product
+ *    (for truncated input, w and w + 1 must agree).
+ * 3. The rare undecided cases are converted exactly with _bigDecimal.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if the text is not a
+ *          number, STATUS_OVERFLOW (result is infinity) or
+ *          STATUS_UNDERFLOW (result is denormal or zero).
+ */
+int extendedFloat80FromString(_extendedFloat80* result, const char* text, char decimalSeparator)
+{
+    const char* p = text;
+    int sign = 0;
+    uint64_t digits = 0;
+    int digitCount = 0;
+    int64_t power = 0;
+    bool hasDigits = false;
+    bool hasPoint = false;
+    bool isTruncated = false;
+
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p == '-' || *p == '+') {
+        sign = (*p == '-');
+        p++;
+    }
+
+    for (;; p++) {
+        unsigned digit = (unsigned)(*p - '0');
+        if (digit <= 9) {
+            hasDigits = true;
+            if (digits == 0 && digit == 0) {
+                power -= hasPoint;      // Leading zero
+            }
+            else if (digitCount < MAX_PARSED_DIGITS) {
+                digits = digits * 10 + digit;
+                digitCount++;
+                power -= hasPoint;
+            }
+            else {
+                isTruncated |= (digit != 0);
+                power += !hasPoint;
+            }
+        }
+        else if ((*p == '.' || *p == decimalSeparator) && !hasPoint) {
+            hasPoint = true;
+        }
+        else {
+            break;
+        }
+    }
+    if (!hasDigits) {
+        return STATUS_INVALID_INPUT;
+    }
+
+    if (*p == 'e' || *p == 'E') {
+        int exponentSign = 1;
+        int64_t exponentValue = 0;
+        p++;
+        if (*p == '-' || *p == '+') {
+            exponentSign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+        if ((unsigned)(*p - '0') > 9) {
+            return STATUS_INVALID_INPUT;
+        }
+        while ((unsigned)(*p - '0') <= 9) {
+            if (exponentValue < 100000000) {
+                exponentValue = exponentValue * 10 + (*p - '0');
+            }
+            p++;
+        }
+        power += exponentSign * exponentValue;
+    }
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p != '\0') {
+        return STATUS_INVALID_INPUT;
+    }
+
+    if (digits == 0) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    }
+    if (power + digitCount - 1 >= MAX_DECIMAL_EXPONENT) {
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_OVERFLOW;
+    }
+    if (power + digitCount < MIN_DECIMAL_EXPONENT) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_UNDERFLOW;
+    }
+
+    // 1. Exact operands, one rounding
+    if (!isTruncated && power >= -MAX_EXACT_POWER_OF_TEN && power <= MAX_EXACT_POWER_OF_TEN) {
+        _extendedFloat80 value, scale;
+        int shift = countLeadingZeros64(digits);
+        setExtended(&value, sign, (uint32_t)(63 - shift + EXTENDED_FLOAT_BIAS), digits << shift);
+        if (power == 0) {
+            *result = value;
+            return STATUS_SUCCESS;
+        }
+        powerOfTenExtended(&scale, (int)((power < 0) ? -power : power));
+        return (power > 0) ? extendedFloat80Mul(result, &value, &scale)
+                           : extendedFloat80Div(result, &value, &scale);
+    }
+
+    // 2. Eisel-Lemire
+    uint64_t mantissa, upperMantissa;
+    int32_t exponent, upperExponent;
+    if (computeEiselLemire(digits, power, &mantissa, &exponent) &&
+        (!isTruncated || (computeEiselLemire(digits + 1, power, &upperMantissa, &upperExponent) &&
+                          upperMantissa == mantissa && upperExponent == exponent))) {
+        return packExtended(result, sign, exponent, mantissa, 0);
+    }
+
+    // 3. Exact conversion
+    _bigDecimal exact;
+    int status;
+
+    bigDecimalInit(&exact);
+    status = bigDecimalFromString(&exact, text, decimalSeparator, BIG_DECIMAL_EXACT);
+    if (status == STATUS_SUCCESS) {
+        status = extendedFloat80FromBigDecimal(result, &exact);
+    }
+    bigDecimalFree(&exact);
+    return status;
+}
+
+/*
+ * extendedFloat80FromBigDecimal
+ *
+ * Correctly rounded conversion of a _bigDecimal, done exactly with
+ * bigDecimalToBinary. Returns the same codes as extendedFloat80FromString.
+ */
+int extendedFloat80FromBigDecimal(_extendedFloat80* result, const _bigDecimal* value)
+{
+    int sign = (value->sign < 0);
+    uint64_t mantissa;
+    int64_t binaryExponent;
+
+    if (bigDecimalIsZero(value)) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_SUCCESS;
+    }
+
+    int64_t decimalExponent = bigDecimalDigitExponent(value);
+    if (decimalExponent >= MAX_DECIMAL_EXPONENT) {
+        setExtended(result, sign, EXTENDED_FLOAT_MAX_EXPONENT, MANTISSA_TOP);
+        return STATUS_OVERFLOW;
+    }
+    if (decimalExponent + 1 < MIN_DECIMAL_EXPONENT) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_UNDERFLOW;
+    }
+
+    int status = bigDecimalToBinary(value, 1 - EXTENDED_FLOAT_BIAS - 63, &mantissa, &binaryExponent);
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+    if (mantissa == 0) {
+        setExtended(result, sign, 0, 0);
+        return STATUS_UNDERFLOW;
+    }
+    if ((mantissa & MANTISSA_TOP) == 0) {
+        setExtended(result, sign, 0, mantissa);  // Denormal
+        return STATUS_UNDERFLOW;
+    }
+    return packExtended(result, sign, (int32_t)(binaryExponent + 63), mantissa, 0);
+}
+
+/*
+ * Batch operations.
+ */
+
+#define DEFINE_EXTENDED_ARRAY_OPERATION(name, operation)                        \
+    int name(_extendedFloat80* result, const _extendedFloat80* a,              \
+        const _extendedFloat80* b, size_t count)                               \
+    {                                                                          \
+        int status = STATUS_SUCCESS;                                           \
+        for (size_t i = 0; i < count; i++) {                                   \
+            int elementStatus = operation(&result[i], &a[i], &b[i]);           \
+            if (status == STATUS_SUCCESS) {                                    \
+                status = elementStatus;                                        \
+            }                                                                  \
+        }                                                                      \
+        return status;                                                         \
+    }
+
+DEFINE_EXTENDED_ARRAY_OPERATION(extendedFloat80AddArray, extendedFloat80Add)
+DEFINE_EXTENDED_ARRAY_OPERATION(extendedFloat80SubArray, extendedFloat80Sub)
+DEFINE_EXTENDED_ARRAY_OPERATION(extendedFloat80MulArray, extendedFloat80Mul)
+DEFINE_EXTENDED_ARRAY_OPERATION(extendedFloat80DivArray, extendedFloat80Div)
+
+int extendedFloat80SqrtArray(_extendedFloat80* result, const _extendedFloat80* a, size_t count)
+{
+    int status = STATUS_SUCCESS;
+    for (size_t i = 0; i < count; i++) {
+        int elementStatus = extendedFloat80Sqrt(&result[i], &a[i]);
+        if (status == STATUS_SUCCESS) {
+            status = elementStatus;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,753 @@
+/*-----------------------------------------------------------------------------
+    fixedint.c --  Fixed-width integers of the programmer mode
+                   (reconstructed code).
+
+               The non-decimal bases compute in two's complement integers
+               of the word size the user selects, from 8 to 512 bits.
+               Values are at most eight 64-bit words kept in the
+               _fixedInt itself, and every operation wraps at the word
+               size, so nothing here allocates.
+
+               The operators run in kernels that take the number of
+               words as a parameter and are always inlined.
+               fixedIntCalculate calls them once for each word count it
+               supports (1, 2, 4 and 8, see FIXED_INT_WORD_COUNTS), so
+               the compiler sees a constant and unrolls every word loop:
+               a 128-bit add is two add-with-carry instructions and a
+               256-bit multiply ten 64x64->128 products, with no loop
+               left. Word sizes below 64 bits use the 1-word kernels and
+               mask the result.
+
+               Key functions include:
+
+               - fixedIntCalculate: +, -, *, /, Mod, And, Or, Xor, Not,
+                                    Lsh, +/-, x^2 and x^3, and through
+                                    bitwise.c Rsh, Rol, Ror, the bit
+                                    counts and the bit reversal.
+               - fixedIntFromString / fixedIntToString: Text in base 2,
+                                    8, 10 or 16.
+               - fixedIntFromBinary / fixedIntFromDouble / fixedIntToDouble
+                 / fixedIntToInt: Conversions for the other value types.
+               - fixedIntResize: Changes the word size, sign-extending.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <string.h>
+#include ".//headers//bitwise.h"
+#include ".//headers//engine.h"
+#include ".//headers//fixedint.h"
+#include ".//headers//wideint.h"
+
+#define POWER_OF_TEN_19 10000000000000000000ull  // Largest power of 10 in a word
+#define TWO_TO_64 18446744073709551616.0
+
+// Word counts fixedIntCalculate has a specialised copy of the kernels for
+#define FIXED_INT_WORD_COUNTS(X) X(1) X(2) X(4) X(8)
+
+// A kernel is inlined into each specialisation, and its word loops are
+// unrolled there once the word count is a constant
+#if defined(_MSC_VER) && !defined(__clang__)
+#define FIXED_INT_KERNEL static __forceinline
+#define FIXED_INT_UNROLL
+#elif defined(__clang__)
+#define FIXED_INT_KERNEL static inline __attribute__((always_inline))
+#define FIXED_INT_UNROLL _Pragma("unroll")
+#else
+#define FIXED_INT_KERNEL static inline __attribute__((always_inline))
+#define FIXED_INT_UNROLL _Pragma("GCC unroll 8")
+#endif
+
+_Static_assert(FIXED_INT_MAX_WORDS == 8, "FIXED_INT_WORD_COUNTS must end at FIXED_INT_MAX_WORDS");
+
+// r = a + b
+FIXED_INT_KERNEL void addWords(uint64_t* r, const uint64_t* a, const uint64_t* b, int words)
+{
+    uint64_t carry = 0;
+
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        uint64_t sum = a[i] + carry;
+        carry = (sum < carry);
+        sum += b[i];
+        carry += (sum < b[i]);
+        r[i] = sum;
+    }
+}
+
+// r = a - b
+FIXED_INT_KERNEL void subtractWords(uint64_t* r, const uint64_t* a, const uint64_t* b, int words)
+{
+    uint64_t borrow = 0;
+
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        uint64_t difference = a[i] - b[i];
+        uint64_t nextBorrow = (a[i] < b[i]);
+        nextBorrow |= (difference < borrow);
+        r[i] = difference - borrow;
+        borrow = nextBorrow;
+    }
+}
+
+// r = -a
+FIXED_INT_KERNEL void negateWords(uint64_t* r, const uint64_t* a, int words)
+{
+    uint64_t borrow = 0;
+
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        uint64_t word = a[i];
+        r[i] = 0 - word - borrow;
+        borrow |= (word != 0);
+    }
+}
+
+// r = the low words of a * b; r must not overlap a or b
+FIXED_INT_KERNEL void multiplyWords(uint64_t* r, const uint64_t* a, const uint64_t* b, int words)
+{
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        r[i] = 0;
+    }
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        uint64_t carry = 0;
+        FIXED_INT_UNROLL
+        for (int j = 0; j < words - i; j++) {
+            uint64_t high;
+            uint64_t low = multiply64(a[i], b[j], &high);
+            low += carry;
+            high += (low < carry);
+            r[i + j] += low;
+            high += (r[i + j] < low);
+            carry = high;
+        }
+    }
+}
+
+// r = a << count for count below words * 64; r may be a
+FIXED_INT_KERNEL void shiftLeftWords(uint64_t* r, const uint64_t* a, int count, int words)
+{
+    int wordShift = count / 64;
+    int bitShift = count % 64;
+
+    FIXED_INT_UNROLL
+    for (int i = words - 1; i >= 0; i--) {
+        uint64_t word = (i >= wordShift) ? a[i - wordShift] << bitShift : 0;
+        if (bitShift != 0 && i > wordShift) {
+            word |= a[i - wordShift - 1] >> (64 - bitShift);
+        }
+        r[i] = word;
+    }
+}
+
+// Unsigned comparison: -1, 0 or 1
+FIXED_INT_KERNEL int compareWords(const uint64_t* a, const uint64_t* b, int words)
+{
+    FIXED_INT_UNROLL
+    for (int i = words - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+FIXED_INT_KERNEL bool isZeroWords(const uint64_t* a, int words)
+{
+    uint64_t bits = 0;
+
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        bits |= a[i];
+    }
+    return bits == 0;
+}
+
+FIXED_INT_KERNEL bool isNegativeWords(const uint64_t* a, int bits)
+{
+    return ((a[(bits - 1) / 64] >> ((bits - 1) % 64)) & 1) != 0;
+}
+
+// Clears the bits above a word size below 64
+FIXED_INT_KERNEL void truncateWords(uint64_t* r, int bits)
+{
+    if (bits < 64) {
+        r[0] &= (UINT64_C(1) << bits) - 1;
+    }
+}
+
+/*
+ * divideWords
+ *
+ * Unsigned quotient and remainder of a / b, b not 0. A divisor of one
+ * word divides a word at a time; longer ones go bit by bit from the top
+ * bit of a.
+ */
+FIXED_INT_KERNEL void divideWords(uint64_t* quotient, uint64_t* remainder, const uint64_t* a, const uint64_t* b,
+    int words)
+{
+    FIXED_INT_UNROLL
+    for (int i = 0; i < words; i++) {
+        quotient[i] = 0;
+        remainder[i] = 0;
+    }
+
+    if (isZeroWords(b + 1, words - 1)) {
+        uint64_t rest = 0;
+        FIXED_INT_UNROLL
+        for (int i = words - 1; i >= 0; i--) {
+            quotient[i] = divide128(rest, a[i], b[0], &rest);
+        }
+        remainder[0] = rest;
+        return;
+    }
+
+    int top = words - 1;
+    while (top >= 0 && a[top] == 0) {
+        top--;
+    }
+    if (top < 0) {
+        return;
+    }
+    for (int bit = top * 64 + 63 - countLeadingZeros64(a[top]); bit >= 0; bit--) {
+        uint64_t carry = remainder[words - 1] >> 63;
+        shiftLeftWords(remainder, remainder, 1, words);
+        remainder[0] |= (a[bit / 64] >> (bit % 64)) & 1;
+        if (carry != 0 || compareWords(remainder, b, words) >= 0) {
+            subtractWords(remainder, remainder, b, words);
+            quotient[bit / 64] |= UINT64_C(1) << (bit % 64);
+        }
+    }
+}
+
+/*
+ * divideSigned
+ *
+ * Signed / and Mod: the quotient is truncated towards zero and the
+ * remainder has the sign of a, as in C. The most negative value divided
+ * by -1 wraps to itself.
+ */
+FIXED_INT_KERNEL int divideSigned(uint32_t operatorKey, uint64_t* r, const uint64_t* a, const uint64_t* b, int bits,
+    int words)
+{
+    uint64_t magnitudeA[FIXED_INT_MAX_WORDS], magnitudeB[FIXED_INT_MAX_WORDS];
+    uint64_t quotient[FIXED_INT_MAX_WORDS], remainder[FIXED_INT_MAX_WORDS];
+    bool isNegativeA = isNegativeWords(a, bits);
+    bool isNegativeB = isNegativeWords(b, bits);
+
+    if (isZeroWords(b, words)) {
+        return STATUS_DIVISION_BY_ZERO;
+    }
+    if (isNegativeA) {
+        negateWords(magnitudeA, a, words);
+        truncateWords(magnitudeA, bits);
+        a = magnitudeA;
+    }
+    if (isNegativeB) {
+        negateWords(magnitudeB, b, words);
+        truncateWords(magnitudeB, bits);
+        b = magnitudeB;
+    }
+    divideWords(quotient, remainder, a, b, words);
+
+    if (operatorKey == IDC_BUTTON_DIV) {
+        if (isNegativeA != isNegativeB) {
+            negateWords(r, quotient, words);
+        }
+        else {
+            memcpy(r, quotient, (size_t)words * sizeof(uint64_t));
+        }
+    }
+    else if (isNegativeA) {
+        negateWords(r, remainder, words);
+    }
+    else {
+        memcpy(r, remainder, (size_t)words * sizeof(uint64_t));
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * calculateWords
+ *
+ * One operator on operands of bits bits in words words; r must not
+ * overlap a or b. The unary operators use b.
+ */
+FIXED_INT_KERNEL int calculateWords(uint32_t operatorKey, uint64_t* r, const uint64_t* a, const uint64_t* b, int bits,
+    int words)
+{
+    uint64_t square[FIXED_INT_MAX_WORDS];
+    size_t count;
+    int status = STATUS_SUCCESS;
+
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD:  addWords(r, a, b, words); break;
+    case IDC_BUTTON_SUB:  subtractWords(r, a, b, words); break;
+    case IDC_BUTTON_MUL:  multiplyWords(r, a, b, words); break;
+    case IDC_BUTTON_SQR:  multiplyWords(r, b, b, words); break;
+    case IDC_BUTTON_NEG:  negateWords(r, b, words); break;
+
+    case IDC_BUTTON_CUBE:
+        multiplyWords(square, b, b, words);
+        multiplyWords(r, square, b, words);
+        break;
+
+    case IDC_BUTTON_DIV:
+    case IDC_BUTTON_MOD:
+        status = divideSigned(operatorKey, r, a, b, bits, words);
+        break;
+
+    case IDC_BUTTON_AND:
+        FIXED_INT_UNROLL
+        for (int i = 0; i < words; i++) {
+            r[i] = a[i] & b[i];
+        }
+        break;
+
+    case IDC_BUTTON_OR:
+        FIXED_INT_UNROLL
+        for (int i = 0; i < words; i++) {
+            r[i] = a[i] | b[i];
+        }
+        break;
+
+    case IDC_BUTTON_XOR:
+        FIXED_INT_UNROLL
+        for (int i = 0; i < words; i++) {
+            r[i] = a[i] ^ b[i];
+        }
+        break;
+
+    case IDC_BUTTON_NOT:
+        FIXED_INT_UNROLL
+        for (int i = 0; i < words; i++) {
+            r[i] = ~b[i];
+        }
+        break;
+
+    case IDC_BUTTON_LSH:
+    case IDC_BUTTON_RSH:
+    case IDC_BUTTON_ROL:
+    case IDC_BUTTON_ROR:
+        if (!isZeroWords(b + 1, words - 1) || b[0] >= (uint64_t)bits) {
+            return STATUS_INVALID_INPUT;  // Negative counts are huge here
+        }
+        if (operatorKey == IDC_BUTTON_LSH) {
+            shiftLeftWords(r, a, (int)b[0], words);
+        }
+        else {
+            bitwiseShift((operatorKey == IDC_BUTTON_RSH) ? BITWISE_SHIFT_RIGHT_ARITHMETIC :
+                (operatorKey == IDC_BUTTON_ROL) ? BITWISE_ROTATE_LEFT : BITWISE_ROTATE_RIGHT,
+                r, a, (size_t)b[0], (size_t)bits, 1);
+        }
+        break;
+
+    case IDC_BUTTON_POPCNT:
+    case IDC_BUTTON_CLZ:
+    case IDC_BUTTON_CTZ:
+        FIXED_INT_UNROLL
+        for (int i = 0; i < words; i++) {
+            r[i] = 0;
+        }
+        bitwiseCount((operatorKey == IDC_BUTTON_POPCNT) ? BITWISE_COUNT_ONES :
+            (operatorKey == IDC_BUTTON_CLZ) ? BITWISE_COUNT_LEADING_ZEROS : BITWISE_COUNT_TRAILING_ZEROS,
+            &count, b, (size_t)bits, 1);
+        r[0] = count;
+        break;
+
+    case IDC_BUTTON_BITREV:
+        bitwiseReverse(r, b, (size_t)bits, 1);
+        break;
+
+    case IDC_BUTTON_INT:
+    case IDC_BUTTON_EQ:
+        memcpy(r, b, (size_t)words * sizeof(uint64_t));
+        break;
+
+    default:
+        return STATUS_UNDEFINED_RESULT;
+    }
+    truncateWords(r, bits);
+    return status;
+}
+
+/*
+ * fixedIntCalculate
+ *
+ * Applies one calculator operator to two values of the same word size,
+ * wrapping at that size: +, -, *, /, Mod, And, Or, Xor, Lsh, Rsh, Rol,
+ * Ror, and on b alone Not, +/-, x^2, x^3, Int, the counts of set bits
+ * and of leading and trailing zeros, and the bit reversal. / and Mod are
+ * signed, and so is Rsh, which copies the sign bit.
+ *
+ * @param operatorKey  The IDC_BUTTON_* ID of the operator.
+ * @param result       Receives the result. May alias either operand.
+ * @param a            Left operand.
+ * @param b            Right operand, or the only operand of a unary
+ *                     operator.
+ * @return             STATUS_SUCCESS, STATUS_DIVISION_BY_ZERO,
+ *                     STATUS_INVALID_INPUT for a shift or rotation
+ *                     count outside 0..bits-1, or STATUS_UNDEFINED_RESULT for an
+ *                     operator without an integer implementation.
+ */
+int fixedIntCalculate(uint32_t operatorKey, _fixedInt* result, const _fixedInt* a, const _fixedInt* b)
+{
+    uint64_t words[FIXED_INT_MAX_WORDS];
+    int bits = b->bits;
+    int status;
+
+#define CALCULATE_WORDS(count) \
+    case count: status = calculateWords(operatorKey, words, a->words, b->words, bits, count); break;
+
+    switch (FIXED_INT_WORDS(bits)) {
+    FIXED_INT_WORD_COUNTS(CALCULATE_WORDS)
+    default: return STATUS_INVALID_INPUT;
+    }
+
+#undef CALCULATE_WORDS
+
+    if (status == STATUS_SUCCESS) {
+        memcpy(result->words, words, (size_t)FIXED_INT_WORDS(bits) * sizeof(uint64_t));
+        result->bits = bits;
+    }
+    return status;
+}
+
+/*
+ * fixedIntIsValidWidth
+ *
+ * True for the word sizes 8, 16, 32, 64, 128, 256 and 512.
+ */
+bool fixedIntIsValidWidth(int bits)
+{
+    return bits >= FIXED_INT_MIN_BITS && bits <= FIXED_INT_MAX_BITS && (bits & (bits - 1)) == 0;
+}
+
+// Bits per digit of base 2, 8 or 16; 0 for other bases
+static int getDigitBits(int base)
+{
+    switch (base) {
+    case 2:  return 1;
+    case 8:  return 3;
+    case 16: return 4;
+    default: return 0;
+    }
+}
+
+/*
+ * fixedIntDigitCount
+ *
+ * Digits of the largest unsigned value of bits bits in base 2, 8, 10
+ * or 16; the entry of a number takes no more than this.
+ */
+int fixedIntDigitCount(int bits, int base)
+{
+    int digitBits = getDigitBits(base);
+
+    if (digitBits == 0) {
+        return (int)((int64_t)bits * 30103 / 100000) + 1;  // log10(2) = 0.30103
+    }
+    return (bits + digitBits - 1) / digitBits;
+}
+
+/*
+ * fixedIntSet
+ *
+ * The value of bits bits that value wraps to.
+ */
+void fixedIntSet(_fixedInt* result, int64_t value, int bits)
+{
+    uint64_t fill = (value < 0) ? UINT64_MAX : 0;
+
+    result->words[0] = (uint64_t)value;
+    for (int i = 1; i < FIXED_INT_MAX_WORDS; i++) {
+        result->words[i] = fill;
+    }
+    result->bits = bits;
+    truncateWords(result->words, bits);
+}
+
+/*
+ * fixedIntResize
+ *
+ * Changes the word size: a narrower value keeps its low bits, a wider
+ * one is sign-extended.
+ */
+void fixedIntResize(_fixedInt* value, int bits)
+{
+    bool isNegative = fixedIntIsNegative(value);
+    uint64_t fill = isNegative ? UINT64_MAX : 0;
+
+    if (value->bits < 64 && isNegative) {
+        value->words[0] |= UINT64_MAX << value->bits;
+    }
+    for (int i = FIXED_INT_WORDS(value->bits); i < FIXED_INT_WORDS(bits); i++) {
+        value->words[i] = fill;
+    }
+    value->bits = bits;
+    truncateWords(value->words, bits);
+}
+
+void fixedIntNegate(_fixedInt* value)
+{
+    negateWords(value->words, value->words, FIXED_INT_WORDS(value->bits));
+    truncateWords(value->words, value->bits);
+}
+
+/*
+ * fixedIntMultiplyAdd
+ *
+ * value = value * multiplier + addend, wrapping at the word size.
+ *
+ * @return  true if the exact result, read as unsigned, did not fit.
+ */
+bool fixedIntMultiplyAdd(_fixedInt* value, uint32_t multiplier, uint32_t addend)
+{
+    int words = FIXED_INT_WORDS(value->bits);
+    uint64_t carry = addend;
+
+    for (int i = 0; i < words; i++) {
+        uint64_t high;
+        uint64_t low = multiply64(value->words[i], multiplier, &high);
+        low += carry;
+        high += (low < carry);
+        value->words[i] = low;
+        carry = high;
+    }
+    if (value->bits < 64) {
+        carry |= value->words[0] >> value->bits;
+        truncateWords(value->words, value->bits);
+    }
+    return carry != 0;
+}
+
+bool fixedIntIsNegative(const _fixedInt* value)
+{
+    return isNegativeWords(value->words, value->bits);
+}
+
+bool fixedIntIsZero(const _fixedInt* value)
+{
+    for (int i = 0; i < FIXED_INT_WORDS(value->bits); i++) {
+        if (value->words[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * fixedIntFromBinary
+ *
+ * The value of bits bits that mantissa * 2^exponent, truncated towards
+ * zero and negated if isNegative, wraps to.
+ */
+void fixedIntFromBinary(_fixedInt* result, uint64_t mantissa, int64_t exponent, bool isNegative, int bits)
+{
+    int words = FIXED_INT_WORDS(bits);
+
+    fixedIntSet(result, 0, bits);
+    if (exponent < 0) {
+        mantissa = (exponent > -64) ? mantissa >> -exponent : 0;
+        exponent = 0;
+    }
+    if (exponent < (int64_t)words * 64) {
+        int word = (int)(exponent / 64);
+        int shift = (int)(exponent % 64);
+        result->words[word] = mantissa << shift;
+        if (shift != 0 && word + 1 < words) {
+            result->words[word + 1] = mantissa >> (64 - shift);
+        }
+    }
+    truncateWords(result->words, bits);
+    if (isNegative) {
+        fixedIntNegate(result);
+    }
+}
+
+/*
+ * fixedIntFromDouble
+ *
+ * The value of bits bits that value, truncated towards zero, wraps to.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT for a NaN or
+ *          STATUS_OVERFLOW for an infinity.
+ */
+int fixedIntFromDouble(_fixedInt* result, double value, int bits)
+{
+    int exponent;
+
+    if (isnan(value)) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (isinf(value)) {
+        return STATUS_OVERFLOW;
+    }
+    double fraction = frexp(fabs(value), &exponent);
+    fixedIntFromBinary(result, (uint64_t)ldexp(fraction, 64), (int64_t)exponent - 64, value < 0.0, bits);
+    return STATUS_SUCCESS;
+}
+
+// Value of a digit character, or 16 for anything else
+static int getDigitValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return 16;
+}
+
+/*
+ * fixedIntFromString
+ *
+ * Parses an optional '-' and the digits of base that follow, like
+ * strtoll; the value wraps at the word size. Parsing stops at the first
+ * character that is no digit of base, so "3.14" in base 10 is 3.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INVALID_INPUT for an unsupported
+ *          word size or base.
+ */
+int fixedIntFromString(_fixedInt* result, const char* text, int base, int bits)
+{
+    bool isNegative = (*text == '-');
+
+    if (!fixedIntIsValidWidth(bits) || base < 2 || base > 16) {
+        return STATUS_INVALID_INPUT;
+    }
+    fixedIntSet(result, 0, bits);
+    for (text += isNegative; getDigitValue(*text) < base; text++) {
+        fixedIntMultiplyAdd(result, (uint32_t)base, (uint32_t)getDigitValue(*text));
+    }
+    if (isNegative) {
+        fixedIntNegate(result);
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * fixedIntToInt
+ *
+ * The signed value, if it fits an int64_t.
+ */
+bool fixedIntToInt(const _fixedInt* value, int64_t* result)
+{
+    uint64_t low = value->words[0];
+    bool isNegative = fixedIntIsNegative(value);
+    uint64_t fill = isNegative ? UINT64_MAX : 0;
+
+    if (value->bits < 64) {
+        *result = (int64_t)(isNegative ? low | (UINT64_MAX << value->bits) : low);
+        return true;
+    }
+    if ((low >> 63) != (fill >> 63)) {
+        return false;
+    }
+    for (int i = 1; i < FIXED_INT_WORDS(value->bits); i++) {
+        if (value->words[i] != fill) {
+            return false;
+        }
+    }
+    *result = (int64_t)low;
+    return true;
+}
+
+/*
+ * fixedIntToDouble
+ *
+ * The signed value as a double. Values wider than 64 bits may be off by
+ * one unit in the last place.
+ */
+double fixedIntToDouble(const _fixedInt* value)
+{
+    _fixedInt magnitude = *value;
+    bool isNegative = fixedIntIsNegative(value);
+    double result = 0.0;
+
+    if (isNegative) {
+        fixedIntNegate(&magnitude);
+    }
+    for (int i = FIXED_INT_WORDS(value->bits) - 1; i >= 0; i--) {
+        result = result * TWO_TO_64 + (double)magnitude.words[i];
+    }
+    return isNegative ? -result : result;
+}
+
+/*
+ * fixedIntToString
+ *
+ * Writes the value in base 2, 8 or 16 as its bit pattern (a negative
+ * value shows its two's complement), or in base 10 as a signed number.
+ * Hexadecimal digits are upper case. Works like snprintf: returns the
+ * length the full text needs, writes at most bufferSize-1 characters and
+ * always terminates the buffer.
+ */
+size_t fixedIntToString(const _fixedInt* value, char* buffer, size_t bufferSize, int base)
+{
+    static const char DIGITS[] = "0123456789ABCDEF";
+    char text[FIXED_INT_MAX_TEXT];
+    size_t length = 0;
+    int words = FIXED_INT_WORDS(value->bits);
+    int digitBits = getDigitBits(base);
+
+    if (digitBits != 0) {
+        bool isLeadingZero = true;
+        for (int digit = fixedIntDigitCount(value->bits, base) - 1; digit >= 0; digit--) {
+            int bit = digit * digitBits;
+            int word = bit / 64;
+            uint64_t bits = value->words[word] >> (bit % 64);
+            if (bit % 64 + digitBits > 64 && word + 1 < words) {
+                bits |= value->words[word + 1] << (64 - bit % 64);
+            }
+            bits &= (UINT64_C(1) << digitBits) - 1;
+            if (bits != 0 || digit == 0 || !isLeadingZero) {
+                text[length++] = DIGITS[bits];
+                isLeadingZero = false;
+            }
+        }
+    }
+    else {
+        // Nineteen digits at a time from the bottom, then reversed
+        _fixedInt magnitude = *value;
+        bool isNegative = fixedIntIsNegative(value);
+        if (isNegative) {
+            fixedIntNegate(&magnitude);
+        }
+        do {
+            uint64_t rest = 0;
+            for (int i = words - 1; i >= 0; i--) {
+                magnitude.words[i] = divide128(rest, magnitude.words[i], POWER_OF_TEN_19, &rest);
+            }
+            bool isLast = fixedIntIsZero(&magnitude);
+            for (int i = 0; i < 19 && (rest != 0 || !isLast || i == 0); i++) {
+                text[length++] = (char)('0' + rest % 10);
+                rest /= 10;
+            }
+        } while (!fixedIntIsZero(&magnitude));
+        if (isNegative) {
+            text[length++] = '-';
+        }
+        for (size_t i = 0; i < length / 2; i++) {
+            char c = text[i];
+            text[i] = text[length - 1 - i];
+            text[length - 1 - i] = c;
+        }
+    }
+
+    if (bufferSize > 0) {
+        size_t copied = (length < bufferSize) ? length : bufferSize - 1;
+        memcpy(buffer, text, copied);
+        buffer[copied] = '\0';
+    }
+    return length;
+}
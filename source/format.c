@@ -0,0 +1,987 @@
+/*-----------------------------------------------------------------------------
+    format.c --  Binary-to-decimal formatting of double and _extendedFloat80
+                 values for the display (reconstructed code).
+
+               Digits come from Grisu run on 128-bit significands. The
+               value, and for the shortest digits the two boundaries
+               halfway to its neighbours, are multiplied by a power of ten
+               from powers.c chosen so that the product has a 32-bit
+               integer part, and the digits are cut off the product. Each
+               scaled value is within a few units of its last bit of the
+               true one, which leaves more than 60 bits of margin for the
+               53-bit double and the 64-bit extended mantissa, so one code
+               path serves both:
+
+               - generateShortestDigits (Grisu3): digits are produced until
+                 they fall inside the rounding interval, then the last
+                 digit is moved towards the value. The shortest, closest
+                 digits are returned, or the value is rejected when the
+                 scaling error could change the result.
+               - generateCountedDigits: exactly n digits, rounded from the
+                 scaled remainder unless it is too close to one half to
+                 decide.
+
+               Beyond the range of the table (about 1e+-300) the power of
+               ten is chained from several entries with a wider error
+               bound. Rejected values are converted exactly with
+               _bigDecimal; this is a tiny fraction of the inputs.
+
+               _bigDecimal values already hold decimal digits and are only
+               rounded (formatBigDecimal).
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include ".//headers//bignum.h"
+#include ".//headers//extfloat.h"
+#include ".//headers//format.h"
+#include ".//headers//powers.h"
+#include ".//headers//wideint.h"
+
+#define DOUBLE_FRACTION_BITS 52
+#define DOUBLE_EXPONENT_MASK 0x7FF
+#define DOUBLE_EXPONENT_OFFSET 1075     // value = mantissa * 2^(exponent - 1075)
+#define EXTENDED_EXPONENT_OFFSET (EXTENDED_FLOAT_BIAS + 63)
+#define EXTENDED_INTEGER_BIT 0x8000000000000000ull
+
+#define MIN_TARGET_EXPONENT (-124)      // Scaled fractions times 10 still fit in 128 bits
+#define MAX_TARGET_EXPONENT (-96)       // Scaled integer parts fit in 32 bits
+#define MAX_SHORTEST_DIGITS 21          // Enough to identify any 64-bit mantissa
+
+#define AUTOMATIC_MIN_EXPONENT (-4)     // "%g" switches to scientific below 1e-4
+#define SHORTEST_FIXED_DIGITS 21        // ... and from 1e21 when formatting FORMAT_SHORTEST
+
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} _uint128;
+
+// A finite binary value: mantissa * 2^exponent
+typedef struct {
+    uint64_t mantissa;
+    int32_t exponent;
+    bool isLowerGapSmaller;  // Power-of-two mantissa: the predecessor is half an ulp closer
+} _binaryValue;
+
+// Decimal digits without trailing zeros: d.ddd * 10^exponent
+typedef struct {
+    char digits[FORMAT_MAX_DIGITS + 1];
+    int count;
+    int exponent;
+} _decimalDigits;
+
+// snprintf-style output: counts every character, stores what fits
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t length;
+} _textWriter;
+
+/*
+ * 128-bit helpers.
+ */
+
+static inline _uint128 make128(uint64_t high, uint64_t low)
+{
+    _uint128 result = { high, low };
+    return result;
+}
+
+static inline bool isLess128(_uint128 a, _uint128 b)
+{
+    return a.high < b.high || (a.high == b.high && a.low < b.low);
+}
+
+static inline _uint128 add128(_uint128 a, _uint128 b)
+{
+    uint64_t low = a.low + b.low;
+    return make128(a.high + b.high + (low < a.low), low);
+}
+
+static inline _uint128 sub128(_uint128 a, _uint128 b)
+{
+    return make128(a.high - b.high - (a.low < b.low), a.low - b.low);
+}
+
+// 0 <= shift < 128
+static inline _uint128 shiftLeft128(_uint128 a, int shift)
+{
+    if (shift == 0) {
+        return a;
+    }
+    if (shift < 64) {
+        return make128((a.high << shift) | (a.low >> (64 - shift)), a.low << shift);
+    }
+    return make128(a.low << (shift - 64), 0);
+}
+
+// a >> shift for 64 < shift < 128 when the result fits in 32 bits
+static inline uint32_t integerPart128(_uint128 a, int shift)
+{
+    return (uint32_t)(a.high >> (shift - 64));
+}
+
+// a mod 2^shift for 64 < shift < 128
+static inline _uint128 fractionPart128(_uint128 a, int shift)
+{
+    return make128(a.high & ((1ull << (shift - 64)) - 1), a.low);
+}
+
+// Low 128 bits of a * factor
+static inline _uint128 multiplySmall128(_uint128 a, uint32_t factor)
+{
+    uint64_t carry;
+    uint64_t low = multiply64(a.low, factor, &carry);
+    return make128(a.high * factor + carry, low);
+}
+
+// floor(a * b / 2^128)
+static inline _uint128 multiplyHigh128(_uint128 a, _uint128 b)
+{
+    uint64_t highHigh, highLow, lowHigh, lowLow;
+    uint64_t highHighLow = multiply64(a.high, b.high, &highHigh);
+    uint64_t highLowLow = multiply64(a.high, b.low, &highLow);
+    uint64_t lowHighLow = multiply64(a.low, b.high, &lowHigh);
+    multiply64(a.low, b.low, &lowLow);
+
+    uint64_t middle = highLowLow + lowHighLow;
+    uint64_t carry = middle < lowHighLow;
+    middle += lowLow;
+    carry += middle < lowLow;
+
+    uint64_t low = highHighLow + highLow;
+    uint64_t high = highHigh + (low < highLow);
+    low += lowHigh;
+    high += low < lowHigh;
+    low += carry;
+    high += low < carry;
+    return make128(high, low);
+}
+
+// 10^q = 5^q * 2^q for q in the table: significand in [2^127, 2^128) and binary exponent
+static void loadPowerOfTen(int q, _uint128* significand, int* binaryExponent)
+{
+    const uint64_t* entry = POWERS_OF_FIVE_128[q - POWERS_OF_FIVE_MIN_EXPONENT];
+    *significand = make128(entry[0], entry[1]);
+    *binaryExponent = FLOOR_LOG2_POW5(q) + q - 127;
+}
+
+static int clampToTable(int q)
+{
+    if (q < POWERS_OF_FIVE_MIN_EXPONENT) {
+        return POWERS_OF_FIVE_MIN_EXPONENT;
+    }
+    return (q > POWERS_OF_FIVE_MAX_EXPONENT) ? POWERS_OF_FIVE_MAX_EXPONENT : q;
+}
+
+/*
+ * findCachedPower
+ *
+ * Picks the power of ten q that takes a normalized 128-bit significand
+ * with binary exponent `exponent` into [MIN_TARGET_EXPONENT,
+ * MAX_TARGET_EXPONENT] once the product is cut back to 128 bits.
+ *
+ * Powers outside the table (the far 80-bit range) are built by chaining
+ * table entries. *error receives the bound, in units of the last bit, on
+ * how far a significand scaled by the result is below the true product:
+ * 2 for a table entry, growing with every chained multiply but staying far
+ * below the 60-bit margin. Returns false if the chained power lands just
+ * outside the target range.
+ */
+static bool findCachedPower(int32_t exponent, int* power, _uint128* significand, int* scaledExponent,
+    uint64_t* error)
+{
+    // Scaled exponent is exponent + floor(q * log2(10)) + 1; 78913 / 2^18 ~ log10(2).
+    // FLOOR_LOG2_POW5 can be one off beyond the table, so aim one inside the range.
+    int q = (int)(((int64_t)(MIN_TARGET_EXPONENT - exponent) * 78913) >> 18);
+    int scaled = exponent + FLOOR_LOG2_POW5(q) + q + 1;
+
+    while (scaled < MIN_TARGET_EXPONENT + 1) {
+        q++;
+        scaled = exponent + FLOOR_LOG2_POW5(q) + q + 1;
+    }
+    while (scaled > MAX_TARGET_EXPONENT) {
+        q--;
+        scaled = exponent + FLOOR_LOG2_POW5(q) + q + 1;
+    }
+
+    int step = clampToTable(q);
+    int remaining = q - step;
+    int binaryExponent;
+    uint64_t powerError = 1;  // Table entries are truncated
+
+    loadPowerOfTen(step, significand, &binaryExponent);
+    while (remaining != 0) {
+        _uint128 factor;
+        int factorExponent;
+
+        step = clampToTable(remaining);
+        remaining -= step;
+        loadPowerOfTen(step, &factor, &factorExponent);
+        *significand = multiplyHigh128(*significand, factor);
+        binaryExponent += factorExponent + 128;
+        if ((significand->high >> 63) == 0) {
+            *significand = shiftLeft128(*significand, 1);
+            binaryExponent--;
+        }
+        powerError = 2 * powerError + 5;
+    }
+
+    *power = q;
+    *scaledExponent = exponent + binaryExponent + 128;
+    *error = powerError + 1;  // Plus the truncation of the scaled product
+    return *scaledExponent >= MIN_TARGET_EXPONENT && *scaledExponent <= MAX_TARGET_EXPONENT;
+}
+
+static void trimTrailingZeros(_decimalDigits* result)
+{
+    while (result->count > 1 && result->digits[result->count - 1] == '0') {
+        result->count--;
+    }
+}
+
+/*
+ * roundWeed
+ *
+ * Grisu3 final step. All quantities are at the scale of the generated
+ * digits: distance = tooHigh - w, rest = tooHigh - candidate and tenKappa
+ * is one unit of the last digit. Moves the last digit down while the
+ * candidate gets closer to w, then accepts the candidate only if it is
+ * inside the safe interval and no w within `unit` has a closer one.
+ */
+static bool roundWeed(char* digits, int count, _uint128 distance, _uint128 unsafeInterval,
+    _uint128 rest, _uint128 tenKappa, _uint128 unit)
+{
+    _uint128 smallDistance = sub128(distance, unit);
+    _uint128 bigDistance = add128(distance, unit);
+
+    while (isLess128(rest, smallDistance) &&
+           !isLess128(sub128(unsafeInterval, rest), tenKappa) &&
+           (isLess128(add128(rest, tenKappa), smallDistance) ||
+            !isLess128(sub128(smallDistance, rest), sub128(add128(rest, tenKappa), smallDistance)))) {
+        digits[count - 1]--;
+        rest = add128(rest, tenKappa);
+    }
+
+    // Would a w at the far end of the error range round to the next candidate?
+    if (isLess128(rest, bigDistance) &&
+        !isLess128(sub128(unsafeInterval, rest), tenKappa) &&
+        (isLess128(add128(rest, tenKappa), bigDistance) ||
+         isLess128(sub128(add128(rest, tenKappa), bigDistance), sub128(bigDistance, rest)))) {
+        return false;
+    }
+
+    // Safe interval: [tooLow + 2 * unit, tooHigh - 2 * unit], kept conservative
+    return !isLess128(rest, multiplySmall128(unit, 2)) &&
+           !isLess128(unsafeInterval, add128(rest, multiplySmall128(unit, 4)));
+}
+
+/*
+ * generateShortestDigits
+ *
+ * Grisu3: the shortest digits that lie strictly inside the rounding
+ * interval of value, closest to value among those of that length.
+ * Returns false when the result cannot be guaranteed.
+ */
+static bool generateShortestDigits(_decimalDigits* result, const _binaryValue* value)
+{
+    uint64_t mantissa = value->mantissa;
+    int shift = countLeadingZeros64(mantissa);
+    int32_t exponent = value->exponent - 64 - shift;  // Of the three normalized significands
+    _uint128 cachedPower;
+    uint64_t scalingError;
+    int power, scaledExponent;
+
+    if (!findCachedPower(exponent, &power, &cachedPower, &scaledExponent, &scalingError)) {
+        return false;
+    }
+
+    // w = m, boundaries (2m + 1) / 2 and (2m - 1) / 2 or (4m - 1) / 4, all shifted to bit 127
+    _uint128 one = make128(0, 1);
+    _uint128 w = shiftLeft128(make128(0, mantissa), 64 + shift);
+    _uint128 plus = shiftLeft128(make128(mantissa >> 63, (mantissa << 1) | 1), 63 + shift);
+    _uint128 minus = value->isLowerGapSmaller
+        ? shiftLeft128(sub128(make128(mantissa >> 62, mantissa << 2), one), 62 + shift)
+        : shiftLeft128(sub128(make128(mantissa >> 63, mantissa << 1), one), 63 + shift);
+
+    _uint128 unit = make128(0, scalingError);
+    _uint128 scaledW = multiplyHigh128(w, cachedPower);
+    _uint128 scaledPlus = multiplyHigh128(plus, cachedPower);
+    _uint128 tooLow = sub128(multiplyHigh128(minus, cachedPower), unit);
+    if (scaledPlus.high == UINT64_MAX && scaledPlus.low > UINT64_MAX - scalingError) {
+        return false;
+    }
+    _uint128 tooHigh = add128(scaledPlus, unit);
+    _uint128 unsafeInterval = sub128(tooHigh, tooLow);
+    _uint128 distance = sub128(tooHigh, scaledW);
+
+    int fractionBits = -scaledExponent;
+    uint32_t integrals = integerPart128(tooHigh, fractionBits);
+    _uint128 fractionals = fractionPart128(tooHigh, fractionBits);
+    uint32_t divisor = 1;
+    int kappa = 1;
+    int count = 0;
+
+    while (integrals / divisor >= 10) {
+        divisor *= 10;
+        kappa++;
+    }
+
+    while (kappa > 0) {
+        result->digits[count++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        kappa--;
+        _uint128 rest = add128(shiftLeft128(make128(0, integrals), fractionBits), fractionals);
+        if (isLess128(rest, unsafeInterval)) {
+            bool isAccepted = roundWeed(result->digits, count, distance, unsafeInterval, rest,
+                shiftLeft128(make128(0, divisor), fractionBits), unit);
+            result->count = count;
+            result->exponent = count - 1 + kappa - power;
+            trimTrailingZeros(result);
+            return isAccepted;
+        }
+        divisor /= 10;
+    }
+
+    while (count < MAX_SHORTEST_DIGITS) {
+        fractionals = multiplySmall128(fractionals, 10);
+        unit = multiplySmall128(unit, 10);
+        unsafeInterval = multiplySmall128(unsafeInterval, 10);
+        distance = multiplySmall128(distance, 10);
+        result->digits[count++] = (char)('0' + integerPart128(fractionals, fractionBits));
+        fractionals = fractionPart128(fractionals, fractionBits);
+        kappa--;
+        if (isLess128(fractionals, unsafeInterval)) {
+            bool isAccepted = roundWeed(result->digits, count, distance, unsafeInterval, fractionals,
+                shiftLeft128(one, fractionBits), unit);
+            result->count = count;
+            result->exponent = count - 1 + kappa - power;
+            trimTrailingZeros(result);
+            return isAccepted;
+        }
+    }
+    return false;
+}
+
+/*
+ * roundCounted
+ *
+ * Rounds the `count` digits generated so far using the scaled remainder
+ * rest (one last-digit unit is tenKappa). The true remainder is within
+ * unit of rest; if that range straddles one half, returns false.
+ */
+static bool roundCounted(_decimalDigits* result, int count, _uint128 rest, _uint128 tenKappa, _uint128 unit)
+{
+    if (!isLess128(unit, tenKappa) || !isLess128(unit, sub128(tenKappa, unit))) {
+        return false;
+    }
+
+    // 2 * (rest + unit) <= tenKappa: round down
+    if (isLess128(rest, sub128(tenKappa, rest)) &&
+        !isLess128(sub128(tenKappa, multiplySmall128(rest, 2)), multiplySmall128(unit, 2))) {
+        return true;
+    }
+
+    // 2 * (rest - unit) >= tenKappa: round up
+    if (isLess128(unit, rest) && !isLess128(sub128(rest, unit), sub128(tenKappa, sub128(rest, unit)))) {
+        int i = count - 1;
+        while (i > 0 && result->digits[i] == '9') {
+            result->digits[i--] = '0';
+        }
+        if (result->digits[i] == '9') {
+            result->digits[0] = '1';
+            result->exponent++;
+        }
+        else {
+            result->digits[i]++;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*
+ * generateCountedDigits
+ *
+ * Grisu with a fixed number of digits: value rounded to `requested`
+ * significant digits. Returns false when the result cannot be guaranteed
+ * (including exact ties, which the exact path rounds half-to-even).
+ */
+static bool generateCountedDigits(_decimalDigits* result, const _binaryValue* value, int requested)
+{
+    int shift = countLeadingZeros64(value->mantissa);
+    _uint128 cachedPower;
+    uint64_t scalingError;
+    int power, scaledExponent;
+
+    if (!findCachedPower(value->exponent - 64 - shift, &power, &cachedPower, &scaledExponent, &scalingError)) {
+        return false;
+    }
+
+    _uint128 w = multiplyHigh128(shiftLeft128(make128(0, value->mantissa), 64 + shift), cachedPower);
+    _uint128 error = make128(0, scalingError);
+    int fractionBits = -scaledExponent;
+    uint32_t integrals = integerPart128(w, fractionBits);
+    _uint128 fractionals = fractionPart128(w, fractionBits);
+    uint32_t divisor = 1;
+    int kappa = 1;
+    int count = 0;
+    bool isDecided;
+
+    while (integrals / divisor >= 10) {
+        divisor *= 10;
+        kappa++;
+    }
+
+    while (kappa > 0) {
+        result->digits[count++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        kappa--;
+        if (count == requested) {
+            break;
+        }
+        divisor /= 10;
+    }
+
+    if (count == requested) {
+        _uint128 rest = add128(shiftLeft128(make128(0, integrals), fractionBits), fractionals);
+        _uint128 tenKappa = shiftLeft128(make128(0, divisor), fractionBits);
+        result->exponent = count - 1 + kappa - power;
+        isDecided = roundCounted(result, count, rest, tenKappa, error);
+    }
+    else {
+        while (count < requested && isLess128(error, fractionals)) {
+            fractionals = multiplySmall128(fractionals, 10);
+            error = multiplySmall128(error, 10);
+            result->digits[count++] = (char)('0' + integerPart128(fractionals, fractionBits));
+            fractionals = fractionPart128(fractionals, fractionBits);
+            kappa--;
+        }
+        if (count != requested) {
+            return false;
+        }
+        result->exponent = count - 1 + kappa - power;
+        isDecided = roundCounted(result, count, fractionals, shiftLeft128(make128(0, 1), fractionBits), error);
+    }
+
+    result->count = count;
+    trimTrailingZeros(result);
+    return isDecided;
+}
+
+/*
+ * Exact conversion with _bigDecimal.
+ */
+
+// Packs mantissa * 2^exponent (exponent >= the 80-bit denormal exponent)
+static void setExtendedValue(_extendedFloat80* result, uint64_t mantissa, int32_t exponent)
+{
+    int shift = countLeadingZeros64(mantissa);
+    int32_t biasedExponent = exponent - shift + EXTENDED_EXPONENT_OFFSET;
+
+    if (biasedExponent < 1) {
+        shift += biasedExponent - 1;  // Denormal: mantissa * 2^(1 - EXTENDED_EXPONENT_OFFSET)
+        biasedExponent = 0;
+    }
+    mantissa <<= shift;
+    result->exponent = (uint16_t)biasedExponent;
+    result->mantissaHigh = (uint32_t)(mantissa >> 32);
+    result->mantissaLow = (uint32_t)mantissa;
+}
+
+// Leading significant digits of a non-zero _bigDecimal
+static void setDigitsFromBigDecimal(_decimalDigits* result, const _bigDecimal* value, int maxCount)
+{
+    int count = 0;
+
+    for (int i = value->length - 1; i >= 0 && count < maxCount; i--) {
+        char limb[BIG_LIMB_DIGITS + 1];
+        int length = snprintf(limb, sizeof(limb), (i == value->length - 1) ? "%u" : "%09u", BIG_DECIMAL_LIMBS(value)[i]);
+        for (int k = 0; k < length && count < maxCount; k++) {
+            result->digits[count++] = limb[k];
+        }
+    }
+    result->count = count;
+    result->exponent = (int)bigDecimalDigitExponent(value);
+    trimTrailingZeros(result);
+}
+
+// The leading `count` significant digits of a non-zero _bigDecimal, rounded half-to-even
+static void setRoundedDigitsFromBigDecimal(_decimalDigits* result, const _bigDecimal* value, int count)
+{
+    int position = 0;
+    int roundingDigit = 0;
+    bool isSticky = false;
+
+    for (int i = value->length - 1; i >= 0; i--) {
+        char limb[BIG_LIMB_DIGITS + 1];
+        int length = snprintf(limb, sizeof(limb), (i == value->length - 1) ? "%u" : "%09u", BIG_DECIMAL_LIMBS(value)[i]);
+        for (int k = 0; k < length; k++, position++) {
+            if (position < count) {
+                result->digits[position] = limb[k];
+            }
+            else if (position == count) {
+                roundingDigit = limb[k] - '0';
+            }
+            else {
+                isSticky = isSticky || limb[k] != '0';
+            }
+        }
+        if (position > count && i > 0) {
+            isSticky = true;  // Limbs are normalized: every lower limb is non-zero
+            break;
+        }
+    }
+    result->count = (position < count) ? position : count;
+    result->exponent = (int)bigDecimalDigitExponent(value);
+
+    if (roundingDigit > 5 || (roundingDigit == 5 && (isSticky || (result->digits[count - 1] - '0') % 2 != 0))) {
+        int i = count - 1;
+        while (i >= 0 && result->digits[i] == '9') {
+            result->digits[i--] = '0';
+        }
+        if (i < 0) {
+            result->digits[0] = '1';
+            result->count = 1;
+            result->exponent++;
+        }
+        else {
+            result->digits[i]++;
+        }
+    }
+    trimTrailingZeros(result);
+}
+
+static bool isInsideInterval(const _bigDecimal* candidate, const _bigDecimal* low, const _bigDecimal* high,
+    bool isInclusive)
+{
+    int lowOrder = bigDecimalCompare(candidate, low);
+    int highOrder = bigDecimalCompare(candidate, high);
+    return (lowOrder > 0 || (isInclusive && lowOrder == 0)) && (highOrder < 0 || (isInclusive && highOrder == 0));
+}
+
+// Exact value, rounding interval and scratch space of exactShortestDigits
+typedef struct {
+    _bigDecimal exact;
+    _bigDecimal low;
+    _bigDecimal high;
+    _bigDecimal down;
+    _bigDecimal up;
+    bool isInclusive;         // Even mantissa: ties round to the value itself
+    _decimalDigits leading;   // Leading digits of exact
+} _exactInterval;
+
+/*
+ * findCandidate
+ *
+ * The value truncated to `length` digits and the next number of that
+ * length are the only candidates of that length that can lie in the
+ * rounding interval. Sets *isFound and, if one of them does, stores the
+ * one closer to the value (the even one on a tie) in result.
+ */
+static int findCandidate(_exactInterval* interval, int length, _decimalDigits* result, bool* isFound)
+{
+    const _decimalDigits* leading = &interval->leading;
+    char downDigits[MAX_SHORTEST_DIGITS + 1], upDigits[MAX_SHORTEST_DIGITS + 1];
+    char text[MAX_SHORTEST_DIGITS + 16];
+    int upExponent = leading->exponent;
+    int status;
+    int i;
+
+    for (i = 0; i < length; i++) {
+        downDigits[i] = (i < leading->count) ? leading->digits[i] : '0';
+    }
+    memcpy(upDigits, downDigits, (size_t)length);
+    for (i = length - 1; i >= 0 && upDigits[i] == '9'; i--) {
+        upDigits[i] = '0';
+    }
+    if (i >= 0) {
+        upDigits[i]++;
+    }
+    else {
+        upDigits[0] = '1';
+        upExponent++;
+    }
+
+    snprintf(text, sizeof(text), "%.*se%d", length, downDigits, leading->exponent - length + 1);
+    status = bigDecimalFromString(&interval->down, text, '.', BIG_DECIMAL_EXACT);
+    if (status == STATUS_SUCCESS) {
+        snprintf(text, sizeof(text), "%.*se%d", length, upDigits, upExponent - length + 1);
+        status = bigDecimalFromString(&interval->up, text, '.', BIG_DECIMAL_EXACT);
+    }
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    bool isDownInside = isInsideInterval(&interval->down, &interval->low, &interval->high, interval->isInclusive);
+    bool isUpInside = isInsideInterval(&interval->up, &interval->low, &interval->high, interval->isInclusive);
+    bool isUpChosen = !isDownInside;
+
+    *isFound = isDownInside || isUpInside;
+    if (!*isFound) {
+        return STATUS_SUCCESS;
+    }
+    if (isDownInside && isUpInside) {
+        // Distances to the value; down and up are reused as scratch
+        status = bigDecimalSub(&interval->down, &interval->exact, &interval->down, BIG_DECIMAL_EXACT);
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalSub(&interval->up, &interval->up, &interval->exact, BIG_DECIMAL_EXACT);
+        }
+        int order = bigDecimalCompare(&interval->up, &interval->down);
+        isUpChosen = order < 0 || (order == 0 && ((downDigits[length - 1] - '0') & 1));
+    }
+
+    memcpy(result->digits, isUpChosen ? upDigits : downDigits, (size_t)length);
+    result->count = length;
+    result->exponent = isUpChosen ? upExponent : leading->exponent;
+    trimTrailingZeros(result);
+    return status;
+}
+
+/*
+ * exactShortestDigits
+ *
+ * Exact counterpart of generateShortestDigits. The rounding interval is
+ * [value - gap below, value + gap above], closed when the mantissa is
+ * even. A length that has a candidate inside implies one at every longer
+ * length, so the shortest length is found by bisection.
+ */
+static int exactShortestDigits(_decimalDigits* result, const _binaryValue* value)
+{
+    uint32_t halfLimb = BIG_LIMB_BASE / 2;
+    _bigDecimal half = { .limbs = &halfLimb, .length = 1, .capacity = 1, .exponent = -1, .sign = 1 };
+    _bigDecimal gap;
+    _exactInterval interval;
+    _extendedFloat80 magnitude, lastBit;
+    int status;
+
+    bigDecimalInit(&gap);
+    bigDecimalInit(&interval.exact);
+    bigDecimalInit(&interval.low);
+    bigDecimalInit(&interval.high);
+    bigDecimalInit(&interval.down);
+    bigDecimalInit(&interval.up);
+    interval.isInclusive = (value->mantissa & 1) == 0;
+
+    setExtendedValue(&magnitude, value->mantissa, value->exponent);
+    setExtendedValue(&lastBit, 1, value->exponent);
+    status = bigDecimalFromExtendedFloat80(&interval.exact, &magnitude, BIG_DECIMAL_EXACT);
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalFromExtendedFloat80(&gap, &lastBit, BIG_DECIMAL_EXACT);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalMul(&gap, &gap, &half, BIG_DECIMAL_EXACT);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalAdd(&interval.high, &interval.exact, &gap, BIG_DECIMAL_EXACT);
+    }
+    if (status == STATUS_SUCCESS && value->isLowerGapSmaller) {
+        status = bigDecimalMul(&gap, &gap, &half, BIG_DECIMAL_EXACT);
+    }
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalSub(&interval.low, &interval.exact, &gap, BIG_DECIMAL_EXACT);
+    }
+
+    // MAX_SHORTEST_DIGITS always has a candidate
+    int shortest = 1, longest = MAX_SHORTEST_DIGITS;
+    if (status == STATUS_SUCCESS) {
+        setDigitsFromBigDecimal(&interval.leading, &interval.exact, MAX_SHORTEST_DIGITS);
+    }
+    while (status == STATUS_SUCCESS && shortest < longest) {
+        int middle = (shortest + longest) / 2;
+        bool isFound = false;
+        status = findCandidate(&interval, middle, result, &isFound);
+        if (isFound) {
+            longest = middle;
+        }
+        else {
+            shortest = middle + 1;
+        }
+    }
+    if (status == STATUS_SUCCESS) {
+        bool isFound = false;
+        status = findCandidate(&interval, shortest, result, &isFound);
+    }
+
+    bigDecimalFree(&gap);
+    bigDecimalFree(&interval.exact);
+    bigDecimalFree(&interval.low);
+    bigDecimalFree(&interval.high);
+    bigDecimalFree(&interval.down);
+    bigDecimalFree(&interval.up);
+    return status;
+}
+
+// The value rounded half-to-even to `requested` significant digits
+static int exactCountedDigits(_decimalDigits* result, const _binaryValue* value, int requested)
+{
+    _bigDecimal exact;
+    _extendedFloat80 magnitude;
+    int status;
+
+    bigDecimalInit(&exact);
+    setExtendedValue(&magnitude, value->mantissa, value->exponent);
+    status = bigDecimalFromExtendedFloat80(&exact, &magnitude, BIG_DECIMAL_EXACT);
+    if (status == STATUS_SUCCESS) {
+        status = bigDecimalRound(&exact, requested);
+    }
+    if (status == STATUS_SUCCESS) {
+        setDigitsFromBigDecimal(result, &exact, requested);
+    }
+    bigDecimalFree(&exact);
+    return status;
+}
+
+/*
+ * Layout.
+ */
+
+static inline void putChar(_textWriter* writer, char c)
+{
+    if (writer->length + 1 < writer->size) {
+        writer->buffer[writer->length] = c;
+    }
+    writer->length++;
+}
+
+static void putRepeated(_textWriter* writer, char c, int count)
+{
+    for (int i = 0; i < count; i++) {
+        putChar(writer, c);
+    }
+}
+
+static void putDigits(_textWriter* writer, const char* digits, int count)
+{
+    for (int i = 0; i < count; i++) {
+        putChar(writer, digits[i]);
+    }
+}
+
+// e+NN with at least two exponent digits, as printf writes it
+static void putExponent(_textWriter* writer, int exponent)
+{
+    char reversed[12];
+    int length = 0;
+    unsigned magnitude = (exponent < 0) ? 0u - (unsigned)exponent : (unsigned)exponent;
+
+    putChar(writer, 'e');
+    putChar(writer, (exponent < 0) ? '-' : '+');
+    do {
+        reversed[length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (length < 2) {
+        reversed[length++] = '0';
+    }
+    while (length > 0) {
+        putChar(writer, reversed[--length]);
+    }
+}
+
+// Writes the digits with `integerDigits` of them before the separator
+static void putMantissa(_textWriter* writer, const _decimalDigits* digits, int integerDigits, char decimalSeparator)
+{
+    if (integerDigits <= 0) {
+        putChar(writer, '0');
+        putChar(writer, decimalSeparator);
+        putRepeated(writer, '0', -integerDigits);
+        putDigits(writer, digits->digits, digits->count);
+    }
+    else if (digits->count <= integerDigits) {
+        putDigits(writer, digits->digits, digits->count);
+        putRepeated(writer, '0', integerDigits - digits->count);
+    }
+    else {
+        putDigits(writer, digits->digits, integerDigits);
+        putChar(writer, decimalSeparator);
+        putDigits(writer, digits->digits + integerDigits, digits->count - integerDigits);
+    }
+}
+
+static size_t finishText(_textWriter* writer)
+{
+    if (writer->size > 0) {
+        writer->buffer[(writer->length < writer->size) ? writer->length : writer->size - 1] = '\0';
+    }
+    return writer->length;
+}
+
+static size_t writeLayout(char* buffer, size_t bufferSize, bool isNegative, const _decimalDigits* digits,
+    _numberLayout layout, int significantDigits, char decimalSeparator)
+{
+    _textWriter writer = { buffer, bufferSize, 0 };
+    int exponent = digits->exponent;
+
+    if (layout == NUMBER_LAYOUT_AUTOMATIC) {
+        int limit = (significantDigits > FORMAT_SHORTEST) ? significantDigits : SHORTEST_FIXED_DIGITS;
+        layout = (exponent >= AUTOMATIC_MIN_EXPONENT && exponent < limit) ? NUMBER_LAYOUT_FIXED
+                                                                          : NUMBER_LAYOUT_SCIENTIFIC;
+    }
+    if (isNegative) {
+        putChar(&writer, '-');
+    }
+
+    if (layout == NUMBER_LAYOUT_FIXED) {
+        putMantissa(&writer, digits, exponent + 1, decimalSeparator);
+    }
+    else {
+        int integerDigits = 1;
+        if (layout == NUMBER_LAYOUT_ENGINEERING) {
+            integerDigits += ((exponent % 3) + 3) % 3;
+        }
+        putMantissa(&writer, digits, integerDigits, decimalSeparator);
+        putExponent(&writer, exponent - integerDigits + 1);
+    }
+    return finishText(&writer);
+}
+
+static size_t writeSpecial(char* buffer, size_t bufferSize, bool isNegative, bool isNaN)
+{
+    _textWriter writer = { buffer, bufferSize, 0 };
+
+    if (isNaN) {
+        putDigits(&writer, "nan", 3);
+    }
+    else {
+        if (isNegative) {
+            putChar(&writer, '-');
+        }
+        putDigits(&writer, "inf", 3);
+    }
+    return finishText(&writer);
+}
+
+static void setZeroDigits(_decimalDigits* digits)
+{
+    digits->digits[0] = '0';
+    digits->count = 1;
+    digits->exponent = 0;
+}
+
+static size_t formatBinaryValue(char* buffer, size_t bufferSize, bool isNegative, const _binaryValue* value,
+    _numberLayout layout, int significantDigits, char decimalSeparator)
+{
+    _decimalDigits digits;
+    int status = STATUS_SUCCESS;
+
+    if (significantDigits > FORMAT_MAX_DIGITS) {
+        significantDigits = FORMAT_MAX_DIGITS;
+    }
+
+    if (value->mantissa == 0) {
+        setZeroDigits(&digits);
+        isNegative = false;
+    }
+    else if (significantDigits <= FORMAT_SHORTEST) {
+        if (!generateShortestDigits(&digits, value)) {
+            status = exactShortestDigits(&digits, value);
+        }
+    }
+    else if (!generateCountedDigits(&digits, value, significantDigits)) {
+        status = exactCountedDigits(&digits, value, significantDigits);
+    }
+
+    if (status != STATUS_SUCCESS) {
+        _textWriter writer = { buffer, bufferSize, 0 };
+        return finishText(&writer);
+    }
+    return writeLayout(buffer, bufferSize, isNegative, &digits, layout, significantDigits, decimalSeparator);
+}
+
+/*
+ * formatDouble
+ *
+ * Writes value in the given layout. significantDigits is FORMAT_SHORTEST
+ * for the shortest text that reads back as the same double, or the
+ * number of significant digits to round to (half-to-even on exact ties,
+ * as printf does). NaN and infinities are written as "nan", "inf" and
+ * "-inf"; zero is written without a sign.
+ *
+ * NUMBER_LAYOUT_AUTOMATIC uses the fixed layout when the decimal exponent
+ * is at least -4 and below significantDigits (21 for FORMAT_SHORTEST),
+ * and the scientific layout otherwise.
+ *
+ * @return  Length of the full text, as snprintf; 0 with an empty buffer
+ *          if the exact conversion ran out of memory.
+ */
+size_t formatDouble(char* buffer, size_t bufferSize, double value, _numberLayout layout,
+    int significantDigits, char decimalSeparator)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool isNegative = (bits >> 63) != 0;
+    uint32_t biasedExponent = (uint32_t)(bits >> DOUBLE_FRACTION_BITS) & DOUBLE_EXPONENT_MASK;
+    uint64_t fraction = bits & ((1ull << DOUBLE_FRACTION_BITS) - 1);
+    _binaryValue binary;
+
+    if (biasedExponent == DOUBLE_EXPONENT_MASK) {
+        return writeSpecial(buffer, bufferSize, isNegative, fraction != 0);
+    }
+    if (biasedExponent == 0) {
+        binary.mantissa = fraction;
+        binary.exponent = 1 - DOUBLE_EXPONENT_OFFSET;
+    }
+    else {
+        binary.mantissa = fraction | (1ull << DOUBLE_FRACTION_BITS);
+        binary.exponent = (int32_t)biasedExponent - DOUBLE_EXPONENT_OFFSET;
+    }
+    binary.isLowerGapSmaller = fraction == 0 && biasedExponent > 1;
+    return formatBinaryValue(buffer, bufferSize, isNegative, &binary, layout, significantDigits, decimalSeparator);
+}
+
+/*
+ * formatExtendedFloat80
+ *
+ * formatDouble for an 80-bit value. FORMAT_SHORTEST gives at most 21
+ * digits, which extendedFloat80FromString reads back to the same bits.
+ */
+size_t formatExtendedFloat80(char* buffer, size_t bufferSize, const _extendedFloat80* value,
+    _numberLayout layout, int significantDigits, char decimalSeparator)
+{
+    bool isNegative = (value->exponent & EXTENDED_FLOAT_SIGN) != 0;
+    uint32_t biasedExponent = value->exponent & EXTENDED_FLOAT_MAX_EXPONENT;
+    uint64_t mantissa = ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+    _binaryValue binary;
+
+    if (biasedExponent == EXTENDED_FLOAT_MAX_EXPONENT) {
+        return writeSpecial(buffer, bufferSize, isNegative, (mantissa << 1) != 0);
+    }
+    binary.mantissa = mantissa;
+    binary.exponent = (int32_t)((biasedExponent == 0) ? 1 : biasedExponent) - EXTENDED_EXPONENT_OFFSET;
+    binary.isLowerGapSmaller = mantissa == EXTENDED_INTEGER_BIT && biasedExponent > 1;
+    return formatBinaryValue(buffer, bufferSize, isNegative, &binary, layout, significantDigits, decimalSeparator);
+}
+
+/*
+ * formatBigDecimal
+ *
+ * formatDouble for a _bigDecimal. FORMAT_SHORTEST writes every digit of
+ * the value up to FORMAT_MAX_DIGITS; longer values, like any value with
+ * more than significantDigits digits, are rounded half-to-even.
+ */
+size_t formatBigDecimal(char* buffer, size_t bufferSize, const _bigDecimal* value, _numberLayout layout,
+    int significantDigits, char decimalSeparator)
+{
+    _decimalDigits digits;
+    int count = (significantDigits > FORMAT_SHORTEST) ? significantDigits : FORMAT_MAX_DIGITS;
+
+    if (count > FORMAT_MAX_DIGITS) {
+        count = FORMAT_MAX_DIGITS;
+    }
+    if (significantDigits > FORMAT_MAX_DIGITS) {
+        significantDigits = FORMAT_MAX_DIGITS;
+    }
+
+    if (bigDecimalIsZero(value)) {
+        setZeroDigits(&digits);
+        return writeLayout(buffer, bufferSize, false, &digits, layout, significantDigits, decimalSeparator);
+    }
+    setRoundedDigitsFromBigDecimal(&digits, value, count);
+    return writeLayout(buffer, bufferSize, value->sign < 0, &digits, layout, significantDigits, decimalSeparator);
+}
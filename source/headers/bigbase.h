@@ -0,0 +1,39 @@
+/*-----------------------------------------------------------------------------
+    bigbase.h --  Header file for the conversion of _bigDecimal integers to
+                  and from text in the number bases (reconstructed code).
+
+                  Only the integer part of a value is converted, and a
+                  negative value is written as '-' and its magnitude, not
+                  as a bit pattern: unlike a _fixedInt, a _bigDecimal has
+                  no word size to wrap at. Bases 2, 8, 10 and 16 are
+                  supported, with any number of digits up to what the
+                  heap holds; hexadecimal digits are upper case. The
+                  engine writes a decimal result wider than the word
+                  this way when it is switched to another base (see
+                  getDisplayString in engine.c).
+
+                  The conversions keep powers of 2^64 and 10^9 from one
+                  call to the next (see bigbase.c), so they must not run
+                  on two threads at once.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef BIGBASE_H
+#define BIGBASE_H
+
+#pragma once
+
+#include <stddef.h>
+#include "..//headers//bignum.h"
+
+// Limbs or words at which a conversion stops splitting the number in
+// halves and goes digit by digit. Exposed so benchmarks can time the
+// quadratic conversion.
+extern int bigBaseSplitThreshold;
+
+size_t bigBaseTextSize(const _bigDecimal* value, int base);
+size_t bigBaseToString(const _bigDecimal* value, char* buffer, size_t bufferSize, int base);
+int bigBaseFromString(_bigDecimal* result, const char* text, int base);
+void bigBaseFreeCache(void);
+
+#endif // BIGBASE_H
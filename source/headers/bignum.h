@@ -0,0 +1,96 @@
+/*-----------------------------------------------------------------------------
+    bignum.h --  Header file for the arbitrary-precision decimal numbers of
+                 the calculator engine (reconstructed code).
+
+                 A _bigDecimal is a sign, a little-endian array of base 10^9
+                 limbs and a limb exponent:
+
+                     value = sign * limbs * (10^9)^exponent
+
+                 Every arithmetic function takes a precision in significant
+                 decimal digits and rounds its result half-to-even to that
+                 many digits. A precision of 0 (BIG_DECIMAL_EXACT) keeps
+                 every digit, which is only meaningful for add, subtract
+                 and multiply.
+
+                 Up to BIG_DECIMAL_INLINE_LIMBS limbs live in the value
+                 itself, so numbers as typed and results at the default
+                 precision take no memory from the heap; a value that
+                 grows beyond them moves its limbs to the heap. Read the
+                 limbs with BIG_DECIMAL_LIMBS, never through the limbs
+                 member. A _bigDecimal may be copied as a struct to make
+                 a read-only view, or to move it.
+
+                 Limb products are computed with schoolbook multiplication
+                 for short operands, Karatsuba for medium ones and Toom-Cook
+                 3 for long ones.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BIG_LIMB_BASE 1000000000u     // Each limb holds 9 decimal digits
+#define BIG_LIMB_DIGITS 9
+
+#define BIG_DECIMAL_EXACT 0           // Precision value that disables rounding
+#define BIG_DECIMAL_MIN_PRECISION 32  // Smallest user-selectable precision (digits)
+#define BIG_DECIMAL_MAX_PRECISION 1000000 // Largest user-selectable precision (digits)
+#define BIG_DECIMAL_DEFAULT_PRECISION 32
+#define BIG_DECIMAL_INLINE_LIMBS 8     // Limbs kept in the value; the struct fills a cache line
+
+typedef struct {
+    uint32_t* limbs;   // Limbs on the heap or borrowed; NULL while they are inlineLimbs
+    int32_t length;    // Limbs in use; 0 means the value is zero
+    int32_t capacity;  // Limbs allocated at limbs
+    int64_t exponent;  // Power of 10^9 applied to the limbs
+    int sign;          // 1 or -1
+    uint32_t inlineLimbs[BIG_DECIMAL_INLINE_LIMBS];
+} _bigDecimal;
+
+// Base 10^9 digits of a _bigDecimal, least significant first
+#define BIG_DECIMAL_LIMBS(value) (((value)->limbs != NULL) ? (value)->limbs : (value)->inlineLimbs)
+
+// engine.h embeds _bigDecimal in _calcValue, so it is included after the type
+#include "..//headers//engine.h"
+
+// Operand sizes (in limbs) at which the multiply switches algorithm.
+// Exposed so benchmarks can force a particular algorithm.
+extern int bigMultiplyKaratsubaThreshold;
+extern int bigMultiplyToomThreshold;
+
+void bigDecimalInit(_bigDecimal* value);
+void bigDecimalFree(_bigDecimal* value);
+int bigDecimalCopy(_bigDecimal* result, const _bigDecimal* value);
+void bigDecimalSetZero(_bigDecimal* result);
+int bigDecimalSetInt(_bigDecimal* result, int64_t value);
+int bigDecimalFromDouble(_bigDecimal* result, double value);
+int bigDecimalFromLimbs(_bigDecimal* result, const uint32_t* limbs, int length, int64_t exponent, int sign);
+int bigDecimalFromExtendedFloat80(_bigDecimal* result, const _extendedFloat80* value, int precision);
+int bigDecimalFromString(_bigDecimal* result, const char* str, char decimalSeparator, int precision);
+int bigDecimalToBinary(const _bigDecimal* value, int64_t minimumExponent, uint64_t* mantissa, int64_t* exponent);
+double bigDecimalToDouble(const _bigDecimal* value);
+size_t bigDecimalToString(const _bigDecimal* value, char* buffer, size_t bufferSize, char decimalSeparator);
+
+bool bigDecimalIsZero(const _bigDecimal* value);
+int bigDecimalCompare(const _bigDecimal* a, const _bigDecimal* b);
+int64_t bigDecimalDigitExponent(const _bigDecimal* value);
+int bigDecimalDigitCount(const _bigDecimal* value);
+void bigDecimalNegate(_bigDecimal* value);
+int bigDecimalRound(_bigDecimal* value, int precision);
+
+int bigDecimalAdd(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision);
+int bigDecimalSub(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision);
+int bigDecimalMul(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision);
+int bigDecimalDiv(_bigDecimal* result, const _bigDecimal* a, const _bigDecimal* b, int precision);
+int bigDecimalSqrt(_bigDecimal* result, const _bigDecimal* a, int precision);
+
+void bigLimbMultiply(uint32_t* result, const uint32_t* a, int aLength, const uint32_t* b, int bLength);
+
+#endif // BIGNUM_H
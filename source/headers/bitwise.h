@@ -0,0 +1,64 @@
+/*-----------------------------------------------------------------------------
+    bitwise.h --  Header file for the bit operations on integers of any
+                  width (reconstructed code).
+
+                  An integer of bits bits is BITWISE_WORDS(bits) 64-bit
+                  words, least significant first, whose bits above the
+                  width in the top word are 0; every function keeps them
+                  0. A batch is count such integers one after the other,
+                  and each function applies its operation to every one of
+                  them, so one call does a whole table of masks or hashes.
+
+                  The operations run in AVX2 lanes and with the POPCNT,
+                  LZCNT and TZCNT instructions when the processor has
+                  them, and in portable code otherwise; all kernels give
+                  the same bits.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef BITWISE_H
+#define BITWISE_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BITWISE_WORDS(bits) (((size_t)(bits) + 63) / 64)
+
+typedef enum {
+    BITWISE_AND,
+    BITWISE_OR,
+    BITWISE_XOR,
+    BITWISE_NOT               // Of a alone; b is not read
+} _bitwiseLogic;
+
+// A shift by the width or more leaves 0 (the sign for
+// BITWISE_SHIFT_RIGHT_ARITHMETIC); rotations go round modulo the width.
+typedef enum {
+    BITWISE_SHIFT_LEFT,
+    BITWISE_SHIFT_RIGHT,
+    BITWISE_SHIFT_RIGHT_ARITHMETIC,  // Copies the top bit of the width
+    BITWISE_ROTATE_LEFT,
+    BITWISE_ROTATE_RIGHT
+} _bitwiseShift;
+
+typedef enum {
+    BITWISE_COUNT_ONES,
+    BITWISE_COUNT_LEADING_ZEROS,   // Below the top bit of the width
+    BITWISE_COUNT_TRAILING_ZEROS   // The width for 0
+} _bitwiseCount;
+
+// Whether the AVX2 and bit count kernels may be used when the processor
+// has them. Exposed so benchmarks can time the portable kernels.
+extern bool bitwiseUseSimd;
+
+void bitwiseLogic(_bitwiseLogic operation, uint64_t* result, const uint64_t* a, const uint64_t* b, size_t bits,
+    size_t count);
+void bitwiseShift(_bitwiseShift operation, uint64_t* result, const uint64_t* a, size_t shift, size_t bits,
+    size_t count);
+void bitwiseCount(_bitwiseCount operation, size_t* counts, const uint64_t* a, size_t bits, size_t count);
+void bitwiseReverse(uint64_t* result, const uint64_t* a, size_t bits, size_t count);
+
+#endif // BITWISE_H
@@ -0,0 +1,60 @@
+/*-----------------------------------------------------------------------------
+    dataload.h --  Header file for the bulk loader of statistics data
+                   points (reconstructed code).
+
+                   dataLoadText parses CSV or plain text, one row per
+                   line, and appends its numbers to a _statistics. The text
+                   is cut into chunks at line boundaries that are parsed
+                   on separate threads and appended in their order in the
+                   text, so the points are the same for any number of
+                   threads. dataLoadFile maps a file and loads it the same
+                   way; the Win32 front end maps files itself and calls
+                   dataLoadText.
+
+                   Fields are separated by commas, semicolons, tabs or
+                   blanks; a comma that is the decimal separator is part of
+                   the number. Numbers are decimal, with the decimal
+                   separator or '.' as the decimal point and an optional
+                   exponent. A line whose wanted fields do not all parse
+                   (a heading, say) is skipped and counted; empty lines are
+                   ignored.
+
+                   With regressors set, the fields just before the loaded
+                   column are the x values of its point, and each row goes
+                   to the regression of the _statistics as well.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef DATALOAD_H
+#define DATALOAD_H
+
+#pragma once
+
+#include <stddef.h>
+#include "..//headers//statistics.h"
+
+#define DATA_LOAD_ALL_COLUMNS -1  // Every field of a row is a data point
+
+typedef struct {
+    char decimalSeparator;
+    int column;                   // Field loaded from each row (from 0), or DATA_LOAD_ALL_COLUMNS
+    unsigned threads;             // Parsing threads; 0 for statisticsGetThreadCount
+    int regressors;               // Fields before column that are x values for the regression; 0 for none
+} _dataLoadOptions;
+
+typedef struct {
+    size_t rows;                  // Lines that gave data points
+    size_t points;                // Data points appended
+    size_t skippedLines;          // Malformed lines
+    size_t bytes;                 // Length of the text
+    unsigned threads;             // Parsing threads used
+    double seconds;               // Wall time of the load
+} _dataLoadReport;
+
+int dataLoadText(_statistics* statistics, const char* text, size_t length, const _dataLoadOptions* options,
+    _dataLoadReport* report);
+int dataLoadCountColumns(const char* text, size_t length, char decimalSeparator);
+int dataLoadFile(_statistics* statistics, const char* path, const _dataLoadOptions* options,
+    _dataLoadReport* report);
+
+#endif // DATALOAD_H
@@ -0,0 +1,154 @@
+/*-----------------------------------------------------------------------------
+    engine.h --  Header file for the platform-neutral calculator engine
+                 (reconstructed code).
+
+                 The engine owns everything needed to turn a stream of key
+                 IDs into results: the entry buffer, the pending operator,
+                 the parenthesis stack, memory and error state. It has no
+                 dependency on <windows.h>, so it builds as a static library
+                 on any platform and can be driven without a message loop.
+
+                 Key elements include:
+
+                 - Limits and status codes shared with the Win32 front end.
+                 - _extendedFloat80: The 80-bit extended precision type.
+                 - _calcValue: A typed operand or result (integer, double,
+                               extended, _bigDecimal or fixed-width).
+                 - _calcEngine: One calculator session.
+                 - processKey: Feeds a single key ID through the engine.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "..//headers//fixedint.h"
+#include "..//headers//keys.h"
+#include "..//headers//memory.h"
+
+#define ERROR_STATE_ACTIVE 1
+#define ERROR_STATE_INACTIVE 0
+
+// Calculation result codes
+#define STATUS_SUCCESS                0  // Calculation completed successfully
+#define STATUS_DIVISION_BY_ZERO       1  // Cannot divide by zero
+#define STATUS_CLIPBOARD_ERROR        2  // Cannot open Clipboard
+#define STATUS_INSUFFICIENT_MEMORY    3  // Insufficient memory for data
+#define STATUS_INVALID_INPUT          4  // Invalid input for function
+#define STATUS_OVERFLOW               5  // Result is too large for display
+#define STATUS_UNDERFLOW              6  // Result is too small for display
+#define STATUS_UNDEFINED_RESULT       7  // Result of function is undefined
+
+// What the front end has to do after processKey() returns
+#define KEY_RESULT_NONE     0  // Nothing visible changed
+#define KEY_RESULT_DISPLAY  1  // The display must be refreshed
+#define KEY_RESULT_BEEP     2  // The key was rejected
+#define KEY_RESULT_ERROR    3  // The calculation failed, see errorCodeBase
+
+//Maximum number of digits the calculator can handle. The non-decimal
+//bases take as many as the word size needs (see fixedIntDigitCount).
+#define MAX_DECIMAL_DIGITS 13      // Decimal mode.
+#define MAX_FRACTIONAL_DIGITS 28   // Fractional part.
+
+#define MAX_DISPLAY_DIGITS FIXED_INT_MAX_TEXT  // Display text, up to 512 binary digits and the NUL.
+#define MAX_STANDARD_PRECISION 12  // Maximum precision for standard mode (32 bits)
+
+#define MAX_OPERATOR_STACK 25 //Max level of parenthesis identiations
+
+//Assumes English locale
+#define DEFAULT_DECIMAL_SEPARATOR '.'
+
+
+// Structure to represent an 80-bit extended precision floating-point number
+typedef struct {
+    uint16_t exponent;      // 15 bits: exponent + sign
+    uint32_t mantissaLow;   // 32 bits: lower part of mantissa
+    uint32_t mantissaHigh;  // 32 bits: upper part of mantissa
+} _extendedFloat80;
+
+// _calcValue holds a _bigDecimal; bignum.h defines it before including this file
+#include "..//headers//bignum.h"
+#include "..//headers//statistics.h"
+
+// Representation of a _calcValue. The engine picks one per number base and
+// mode (see getValueType in engine.c); zero-filled memory is integer 0.
+typedef enum {
+    VALUE_TYPE_INTEGER = 0,  // int64_t: exact small integers (valueSetInteger)
+    VALUE_TYPE_DOUBLE,       // double: scientific mode
+    VALUE_TYPE_EXTENDED,     // _extendedFloat80: scientific notation
+    VALUE_TYPE_BIG,          // _bigDecimal at precisionDigits: standard mode
+    VALUE_TYPE_FIXED         // _fixedInt of wordBits bits: non-decimal number bases
+} _valueType;
+
+// An operand or result. VALUE_TYPE_BIG values own their limbs and must be
+// released with valueFree (see value.h).
+typedef struct {
+    _valueType type;
+    union {
+        int64_t integer;
+        double real;
+        _extendedFloat80 extended;
+        _bigDecimal big;
+        _fixedInt fixed;
+    };
+} _calcValue;
+
+
+typedef enum {
+    STANDARD_MODE = 0,
+    SCIENTIFIC_MODE = 1,
+    SCIENTIFIC_NOTATION = 2,
+} _calculatorMode;
+
+typedef struct {
+    char accumulatedValue[MAX_DISPLAY_DIGITS];  // Digits being typed (input mode only)
+    uint32_t angleMode;                         // IDC_RADIO_DEG, IDC_RADIO_RAD or IDC_RADIO_GRAD
+    int currentSign;                            // Positive / negative sign of the current input.
+    uint32_t currentOperator;                   // Current operation (ADDITION, SUBTRACTION, MULTIPLICATION...)
+    int currentPrecisionLevel;                  // Initialize to max standard precision
+    uint32_t currentValueHighPart;              // Number of fractional digits typed so far
+    _calcValue currentValue;                    // Displayed result when input mode is off
+    char decimalSeparator;                      // Character used as decimal separator
+    int errorState;                             // Current error state of the calculator
+    uint32_t errorCodeBase;                     // Status code of the last failed calculation
+    bool hasOperatorPending;                    // Flag indicating if an operator is pending
+    bool isInputModeActive;                     // Flag indicating if input mode is active
+    bool isInverseMode;                         // Flag to indicate inverse mode
+    uint32_t keyPressed;                        // Stores the last key handled by the engine
+    _calcValue lastValue;                       // Previous value before the last operation
+    _calculatorMode mode;                       // Current mode of the calculator (Standard or Scientific)
+    _calcValue memoryRegister;                  // Memory storage for calculator operations
+    int numberBase;                             // Current number base (2 for binary, 8 for octal, 10 for decimal, 16 for hexadecimal)
+    uint32_t operatorStack[MAX_OPERATOR_STACK]; // Pending operators (for the parentheses)
+    _calcValue operandStack[MAX_OPERATOR_STACK]; // Left operands that belong to operatorStack
+    int operatorStackPointer;                   // Index into the operator stack
+    int precisionDigits;                        // Significant digits of _bigDecimal results
+    _extendedFloat80 scientificNumber;          // 80-bit extended precision floating-point number
+    _statistics statistics;                     // Data points of the statistics box
+    _memoryArena arena;                         // Temporaries of the evaluation in progress
+    int wordBits;                               // Word size of the non-decimal bases (8 to 512)
+} _calcEngine;
+
+
+void clearEngineEntry(_calcEngine* engine);
+void freeEngine(_calcEngine* engine);
+size_t getDisplaySize(_calcEngine* engine);
+int getDisplayString(_calcEngine* engine, char* buffer, size_t bufferSize);
+int getOperatorPrecedence(uint32_t operatorKey);
+uint32_t getTopOperator(const _calcEngine* engine);
+void initEngine(_calcEngine* engine);
+uint32_t popOperator(_calcEngine* engine, _calcValue* operand);
+int processKey(_calcEngine* engine, uint32_t keyPressed);
+bool pushOperator(_calcEngine* engine, uint32_t operatorKey, _calcValue* operand);
+void resetEngine(_calcEngine* engine);
+int setEngineDataPoint(_calcEngine* engine, size_t index);
+int setEnginePrecision(_calcEngine* engine, int digits);
+int setEngineValue(_calcEngine* engine, const char* text);
+int setEngineWordSize(_calcEngine* engine, int bits);
+
+#endif // ENGINE_H
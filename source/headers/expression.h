@@ -0,0 +1,130 @@
+/*-----------------------------------------------------------------------------
+    expression.h --  Header file for the expression compiler and the
+                     bytecode machine that evaluates compiled formulas
+                     (reconstructed code).
+
+                     expressionCompile turns infix text such as
+                     "2*(x+4)^2 - sin(30)" into an _expression: a flat list
+                     of 32-bit instructions for a stack machine, the
+                     constants they refer to and the names of the
+                     variables. The text is compiled once; every
+                     expressionEvaluate after that only runs the
+                     instructions, in double precision and without
+                     allocating.
+
+                     Grammar (names are case-insensitive):
+
+                     - Numbers: 12, 0.5, 1e-3 ('.' or the engine's decimal
+                                separator).
+                     - Binary operators, grouped like the scientific
+                       keypad (getOperatorPrecedence), all left to right:
+                       or xor < and < lsh < + - < * / mod < ^
+                     - Prefix minus, which binds tighter than any binary
+                       operator: -2^2 is (-2)^2, as keyed.
+                     - Functions: sqrt sqr cube inv sin cos tan asin acos
+                       atan log ln exp fact int not, each followed by a
+                       parenthesized argument.
+                     - pi, and any other name is a variable.
+
+                     Parentheses may nest to any depth.
+
+                     In the binary, octal and hexadecimal bases numbers are
+                     integers in that base (a hexadecimal number starts
+                     with a digit: 0FF, not FF), and every result that can
+                     have a fraction is truncated, as the keypad's integer
+                     arithmetic does.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "..//headers//engine.h"
+
+#define EXPRESSION_MAX_NAME_LENGTH 15      // Longest variable name
+#define EXPRESSION_OPCODE_MASK 0xFFu       // Instruction bits holding the opcode
+#define EXPRESSION_OPERAND_SHIFT 8         // The operand sits above the opcode
+#define EXPRESSION_MAX_OPERAND 0xFFFFFF    // Largest constant or variable index
+
+#define EXPRESSION_OPCODE(instruction)  ((_expressionOpcode)((instruction) & EXPRESSION_OPCODE_MASK))
+#define EXPRESSION_OPERAND(instruction) ((uint32_t)(instruction) >> EXPRESSION_OPERAND_SHIFT)
+
+// Instructions of the stack machine. Binary operators pop b, then a, and
+// push a op b; unary operators replace the top of the stack. Trigonometric
+// instructions work in radians: the compiler emits the angle mode factor
+// as a separate multiplication. LOAD and STORE only appear after
+// expressionOptimize, for values used more than once.
+typedef enum {
+    EXPRESSION_OP_RETURN = 0,  // The result is on top of the stack
+    EXPRESSION_OP_CONSTANT,    // Push constants[operand]
+    EXPRESSION_OP_VARIABLE,    // Push variables[operand]
+    EXPRESSION_OP_LOAD,        // Push temporaries[operand]
+    EXPRESSION_OP_STORE,       // Copy the top of the stack to temporaries[operand]
+    EXPRESSION_OP_ADD,
+    EXPRESSION_OP_SUB,
+    EXPRESSION_OP_MUL,
+    EXPRESSION_OP_DIV,
+    EXPRESSION_OP_MOD,
+    EXPRESSION_OP_POW,
+    EXPRESSION_OP_AND,
+    EXPRESSION_OP_OR,
+    EXPRESSION_OP_XOR,
+    EXPRESSION_OP_LSH,
+    EXPRESSION_OP_NEG,
+    EXPRESSION_OP_NOT,
+    EXPRESSION_OP_SQRT,
+    EXPRESSION_OP_SQR,
+    EXPRESSION_OP_CUBE,
+    EXPRESSION_OP_INV,
+    EXPRESSION_OP_SIN,
+    EXPRESSION_OP_COS,
+    EXPRESSION_OP_TAN,
+    EXPRESSION_OP_ASIN,
+    EXPRESSION_OP_ACOS,
+    EXPRESSION_OP_ATAN,
+    EXPRESSION_OP_LOG,
+    EXPRESSION_OP_LN,
+    EXPRESSION_OP_EXP,
+    EXPRESSION_OP_FACT,
+    EXPRESSION_OP_INT,
+    EXPRESSION_OPCODE_COUNT
+} _expressionOpcode;
+
+typedef struct {
+    char text[EXPRESSION_MAX_NAME_LENGTH + 1];
+} _expressionName;
+
+// A compiled formula. Start with expressionInit and release with
+// expressionFree. The evaluation stack belongs to the expression, so one
+// _expression must not be evaluated by two threads at once.
+typedef struct {
+    uint32_t* code;               // Instructions, ending with EXPRESSION_OP_RETURN
+    int codeLength;
+    int codeCapacity;
+    double* constants;            // Values of the EXPRESSION_OP_CONSTANT operands
+    int constantCount;
+    int constantCapacity;
+    _expressionName* variables;   // Variable names in lower case, in order of first use
+    int variableCount;
+    int variableCapacity;
+    double* stack;                // Evaluation stack, then the temporaries
+    int stackSize;                // Deepest the evaluation stack gets
+    int temporaryCount;
+    int stackCapacity;            // Doubles allocated at stack
+    size_t errorPosition;         // Offset of the offending text after a failed compile
+} _expression;
+
+void expressionInit(_expression* expression);
+void expressionFree(_expression* expression);
+int expressionCompile(_expression* expression, const char* text, const _calcEngine* engine);
+int expressionFindVariable(const _expression* expression, const char* name);
+int expressionGetOperandCount(_expressionOpcode opcode);
+int expressionEvaluate(_expression* expression, const double* variables, double* result);
+int expressionEvaluateBatch(_expression* expression, const double* variables, size_t count,
+    double* results);
+
+#endif // EXPRESSION_H
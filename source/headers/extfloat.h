@@ -0,0 +1,64 @@
+/*-----------------------------------------------------------------------------
+    extfloat.h --  Header file for the software 80-bit extended precision
+                   arithmetic of the calculator engine (reconstructed code).
+
+                   _extendedFloat80 uses the x87 layout: a sign bit and a
+                   15-bit exponent biased by 16383 in `exponent`, and a
+                   64-bit mantissa with an explicit integer bit split over
+                   mantissaHigh/mantissaLow. An exponent of 0x7FFF encodes
+                   infinity (mantissa 0x8000000000000000) and NaN; an
+                   exponent of 0 encodes zero and denormals.
+
+                   All operations round to nearest, ties to even, exactly as
+                   an x87 FPU set to 64-bit precision does, and return one
+                   of the STATUS_* codes:
+
+                   - STATUS_SUCCESS: The result is a finite number or an
+                                     infinity produced from an infinity.
+                   - STATUS_OVERFLOW: A finite computation overflowed to
+                                      infinity.
+                   - STATUS_UNDERFLOW: The result is denormal or zero and
+                                       inexact.
+                   - STATUS_DIVISION_BY_ZERO: Finite non-zero / zero.
+                   - STATUS_UNDEFINED_RESULT: The result is a NaN.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef EXTFLOAT_H
+#define EXTFLOAT_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "..//headers//bignum.h"
+#include "..//headers//engine.h"
+
+#define EXTENDED_FLOAT_BIAS 16383
+#define EXTENDED_FLOAT_MAX_EXPONENT 0x7FFF
+#define EXTENDED_FLOAT_SIGN 0x8000
+
+// extendedFloat80Compare result when either operand is a NaN
+#define EXTENDED_FLOAT_UNORDERED 2
+
+int extendedFloat80Add(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b);
+int extendedFloat80Sub(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b);
+int extendedFloat80Mul(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b);
+int extendedFloat80Div(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b);
+int extendedFloat80Sqrt(_extendedFloat80* result, const _extendedFloat80* a);
+int extendedFloat80Compare(const _extendedFloat80* a, const _extendedFloat80* b);
+
+int extendedFloat80FromBigDecimal(_extendedFloat80* result, const _bigDecimal* value);
+int extendedFloat80FromDouble(_extendedFloat80* result, double value);
+int extendedFloat80FromString(_extendedFloat80* result, const char* text, char decimalSeparator);
+double extendedFloat80ToDouble(const _extendedFloat80* value);
+
+// Batch versions: result[i] = a[i] op b[i] for i < count. result may alias
+// a or b. Every element is computed; the first failing status is returned.
+int extendedFloat80AddArray(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b, size_t count);
+int extendedFloat80SubArray(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b, size_t count);
+int extendedFloat80MulArray(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b, size_t count);
+int extendedFloat80DivArray(_extendedFloat80* result, const _extendedFloat80* a, const _extendedFloat80* b, size_t count);
+int extendedFloat80SqrtArray(_extendedFloat80* result, const _extendedFloat80* a, size_t count);
+
+#endif // EXTFLOAT_H
@@ -0,0 +1,63 @@
+/*-----------------------------------------------------------------------------
+    fixedint.h --  Header file for the fixed-width integers of the
+                   programmer mode (reconstructed code).
+
+                   A _fixedInt is a two's complement integer of one of the
+                   word sizes 8, 16, 32, 64, 128, 256 or 512 bits, kept as
+                   little-endian 64-bit words inside the value, so no
+                   operation allocates. Arithmetic wraps at the word size
+                   the way a processor register does. Division, the
+                   remainder, the decimal form and the conversions to
+                   other types read the value as signed; bases 2, 8 and
+                   16 show its bit pattern.
+
+                   Words at and above FIXED_INT_WORDS(bits) are not used,
+                   and the bits above the word size in the top word are
+                   always 0. Functions that can fail return one of the
+                   STATUS_* codes.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef FIXEDINT_H
+#define FIXEDINT_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FIXED_INT_MIN_BITS 8
+#define FIXED_INT_MAX_BITS 512
+#define FIXED_INT_DEFAULT_BITS 64
+#define FIXED_INT_MAX_WORDS (FIXED_INT_MAX_BITS / 64)
+#define FIXED_INT_WORDS(bits) (((bits) + 63) / 64)
+
+// Longest text of a value: every bit in base 2, a sign and the NUL
+#define FIXED_INT_MAX_TEXT (FIXED_INT_MAX_BITS + 2)
+
+typedef struct {
+    uint64_t words[FIXED_INT_MAX_WORDS];  // Least significant first
+    int bits;                             // Word size
+} _fixedInt;
+
+bool fixedIntIsValidWidth(int bits);
+int fixedIntDigitCount(int bits, int base);
+
+void fixedIntSet(_fixedInt* result, int64_t value, int bits);
+void fixedIntResize(_fixedInt* value, int bits);
+void fixedIntNegate(_fixedInt* value);
+bool fixedIntMultiplyAdd(_fixedInt* value, uint32_t multiplier, uint32_t addend);
+bool fixedIntIsNegative(const _fixedInt* value);
+bool fixedIntIsZero(const _fixedInt* value);
+
+void fixedIntFromBinary(_fixedInt* result, uint64_t mantissa, int64_t exponent, bool isNegative, int bits);
+int fixedIntFromDouble(_fixedInt* result, double value, int bits);
+int fixedIntFromString(_fixedInt* result, const char* text, int base, int bits);
+bool fixedIntToInt(const _fixedInt* value, int64_t* result);
+double fixedIntToDouble(const _fixedInt* value);
+size_t fixedIntToString(const _fixedInt* value, char* buffer, size_t bufferSize, int base);
+
+int fixedIntCalculate(uint32_t operatorKey, _fixedInt* result, const _fixedInt* a, const _fixedInt* b);
+
+#endif // FIXEDINT_H
@@ -0,0 +1,44 @@
+/*-----------------------------------------------------------------------------
+    format.h --  Header file for the binary-to-decimal number formatter of
+                 the calculator engine (reconstructed code).
+
+                 formatDouble, formatExtendedFloat80 and formatBigDecimal
+                 write a value in one of the _numberLayout layouts, either
+                 with the shortest digits that read back to the same bits
+                 (FORMAT_SHORTEST) or correctly rounded to a number of
+                 significant digits.
+                 Trailing zeros of the digits are never written, and the
+                 decimal point is the caller's decimalSeparator.
+
+                 All three work like snprintf: they return the length
+                 the full text needs, write at most bufferSize-1 characters
+                 and always terminate the buffer.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#pragma once
+
+#include <stddef.h>
+#include "..//headers//engine.h"
+
+#define FORMAT_SHORTEST 0      // significantDigits value asking for round-trip digits
+#define FORMAT_MAX_DIGITS 40   // Larger significantDigits values are clamped to this
+
+typedef enum {
+    NUMBER_LAYOUT_AUTOMATIC,   // Fixed for exponents in [-4, digits), scientific otherwise ("%g")
+    NUMBER_LAYOUT_FIXED,       // 1234.5, 0.00012
+    NUMBER_LAYOUT_SCIENTIFIC,  // 1.2345e+03
+    NUMBER_LAYOUT_ENGINEERING  // 1.2345e+03, 123.4e-06: exponent is a multiple of 3
+} _numberLayout;
+
+size_t formatDouble(char* buffer, size_t bufferSize, double value, _numberLayout layout,
+    int significantDigits, char decimalSeparator);
+size_t formatExtendedFloat80(char* buffer, size_t bufferSize, const _extendedFloat80* value,
+    _numberLayout layout, int significantDigits, char decimalSeparator);
+size_t formatBigDecimal(char* buffer, size_t bufferSize, const _bigDecimal* value, _numberLayout layout,
+    int significantDigits, char decimalSeparator);
+
+#endif // FORMAT_H
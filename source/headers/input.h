@@ -13,26 +13,49 @@
 
 #pragma once
 
-#undef UNICODE
-#undef _UNICODE
-
-#include <windows.h>
-#include ".//headers//main.h"
-#include "operations.h"
+#include "..//headers//engine.h"
+#include "..//headers//operations.h"
 #include <float.h>
 #include <math.h>
 #include <limits.h>
 
-
-extern const short int MAX_DIGITS_FOR_BASE[];
-
-BOOL appendDigit(char* accumulatedValue, int digit);
-int convertKeyToDigit(DWORD keyCode);
-BOOL isClearKey(DWORD keyPressed);
-BOOL isNumericInput(DWORD keyPressed);
-BOOL isPreviousKeyOperator();
-BOOL isOperatorKey(DWORD keyPressed);
-BOOL isSpecialFunctionKey(DWORD keyPressed);
-BOOL updateInputMode(DWORD keyPressed);
+// Classes of a key (_keyInfo.classes)
+#define KEY_CLASS_DIGIT       0x01  // 0-9 and A-F
+#define KEY_CLASS_BINARY      0x02  // Operator between two values
+#define KEY_CLASS_UNARY       0x04  // Operator applied to the displayed value at once
+#define KEY_CLASS_EQUALS      0x08  // '='
+#define KEY_CLASS_CLEAR       0x10  // CE and C
+#define KEY_CLASS_SPECIAL     0x20  // Not remembered as the previous key
+#define KEY_CLASS_ENDS_INPUT  0x40  // Ends the entry of a number
+
+// Modes a key works in (_keyInfo.modes), one bit per _calculatorMode
+#define KEY_MODES_ALL         ((1u << STANDARD_MODE) | (1u << SCIENTIFIC_MODE) | (1u << SCIENTIFIC_NOTATION))
+#define KEY_MODES_SCIENTIFIC  (1u << SCIENTIFIC_MODE)
+
+#define KEY_TABLE_SIZE (IDC_BUTTON_EXP_ENTRY + 1)  // Key IDs are below this
+
+// What the engine needs to know about a key ID. IDs that are no key have
+// an all-zero entry.
+typedef struct {
+    uint8_t classes;     // KEY_CLASS_* bits
+    int8_t digit;        // Value of a KEY_CLASS_DIGIT key
+    uint8_t precedence;  // Of a KEY_CLASS_BINARY key in scientific mode
+    uint8_t modes;       // KEY_MODES_* the classes apply in
+} _keyInfo;
+
+
+bool appendDecimalSeparator(_calcEngine* engine);
+bool appendDigit(_calcEngine* engine, int digit);
+int convertKeyToDigit(uint32_t keyCode);
+const _keyInfo* getKeyInfo(uint32_t keyCode);
+bool hasDecimalSeparator(const _calcEngine* engine, const char* str);
+bool isClearKey(uint32_t keyPressed);
+bool isNumericInput(const _calcEngine* engine, uint32_t keyPressed);
+bool isPreviousKeyOperator(const _calcEngine* engine);
+bool isOperatorKey(const _calcEngine* engine, uint32_t keyPressed);
+bool isSpecialFunctionKey(const _calcEngine* engine, uint32_t keyPressed);
+bool isUnaryOperatorKey(uint32_t keyPressed);
+bool isValueOverflow(_calcEngine* engine, int digit);
+bool updateInputMode(_calcEngine* engine, uint32_t keyPressed);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*-----------------------------------------------------------------------------
+    jit.h --  Header file for the native code generator for compiled
+              expressions (reconstructed code).
+
+              jitCompile translates the instructions of an _expression
+              into x86-64 machine code in a buffer of its own, so sweeps
+              that evaluate one formula millions of times skip the
+              interpreter's dispatch. It is optional: on other processors
+              and systems, or when the formula uses an instruction it does
+              not translate, jitCompile returns STATUS_UNDEFINED_RESULT and
+              jitEvaluate runs the interpreter instead. Either way the
+              results and STATUS_* codes are those of expressionEvaluate.
+
+              A _jitCode belongs to the compile of the expression it was
+              made from; call jitCompile again after expressionCompile.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef JIT_H
+#define JIT_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "..//headers//expression.h"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define JIT_AVAILABLE 1
+#else
+#define JIT_AVAILABLE 0
+#endif
+
+// Generated code: returns a STATUS_* code and writes *result on success
+typedef int (*_jitFunction)(const double* variables, const double* constants, double* result);
+
+typedef struct {
+    _jitFunction function;  // NULL when the expression runs on the interpreter
+    void* buffer;           // Executable pages holding function
+    size_t bufferSize;
+} _jitCode;
+
+void jitInit(_jitCode* code);
+void jitFree(_jitCode* code);
+int jitCompile(_jitCode* code, const _expression* expression);
+int jitEvaluate(const _jitCode* code, _expression* expression, const double* variables, double* result);
+int jitEvaluateBatch(const _jitCode* code, _expression* expression, const double* variables, size_t count,
+    double* results);
+
+#endif // JIT_H
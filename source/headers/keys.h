@@ -0,0 +1,170 @@
+/*-----------------------------------------------------------------------------
+    keys.h --  Button and key identifiers of the Windows Calculator
+               (reconstructed code).
+
+               These IDs are shared by the Win32 front end (main.c) and the
+               platform-neutral calculator engine, so this header must not
+               depend on <windows.h>.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef KEYS_H
+#define KEYS_H
+
+#pragma once
+
+//Calculator buttons - standard mode
+// Standard Calculator Button IDs
+#define IDC_BUTTON_MC     0x80  // Memory Clear
+#define IDC_BUTTON_MR     0x81  // Memory Recall
+#define IDC_BUTTON_MS     0x82  // Memory Store
+#define IDC_BUTTON_MPLUS  0x83  // Memory Add
+
+#define IDC_BUTTON_BACK   0x84  // Backspace
+#define IDC_BUTTON_CE     0x85  // Clear Entry
+#define IDC_BUTTON_CA     0x86  // Clear All
+
+#define IDC_BUTTON_7      0x87  // Digit 7
+#define IDC_BUTTON_8      0x88  // Digit 8
+#define IDC_BUTTON_9      0x89  // Digit 9
+#define IDC_BUTTON_DIV    0x8A  // Division
+
+#define IDC_BUTTON_4      0x8B  // Digit 4
+#define IDC_BUTTON_5      0x8C  // Digit 5
+#define IDC_BUTTON_6      0x8D  // Digit 6
+#define IDC_BUTTON_MUL    0x8E  // Multiplication
+
+#define IDC_BUTTON_1      0x8F  // Digit 1
+#define IDC_BUTTON_2      0x90  // Digit 2
+#define IDC_BUTTON_3      0x91  // Digit 3
+#define IDC_BUTTON_SUB    0x92  // Subtraction
+
+#define IDC_BUTTON_0      0x93  // Digit 0
+#define IDC_BUTTON_DOT    0x94  // Decimal point
+#define IDC_BUTTON_EQ     0x95  // Equals
+#define IDC_BUTTON_ADD    0x96  // Addition
+
+#define IDC_BUTTON_SQRT   0x97  // Square root
+#define IDC_BUTTON_PERC   0x98  // Percentage
+#define IDC_BUTTON_INV    0x99  // Reciprocal (1/x)
+#define IDC_BUTTON_NEG    0x9A  // Negate (+/-)
+
+// Scientific Calculator Additional Button IDs
+#define IDC_BUTTON_SIN    0x9C  // Sine
+#define IDC_BUTTON_COS    0x9D  // Cosine
+#define IDC_BUTTON_TAN    0x9E  // Tangent
+
+#define IDC_BUTTON_ASIN   0x9F  // Arc sine
+#define IDC_BUTTON_ACOS   0xA0  // Arc cosine
+#define IDC_BUTTON_ATAN   0xA1  // Arc tangent
+
+#define IDC_BUTTON_LOG    0xA2  // Logarithm (base 10)
+#define IDC_BUTTON_LN     0xA3  // Natural logarithm
+
+#define IDC_BUTTON_EXP    0xA4  // Exponential (e^x)
+#define IDC_BUTTON_XY     0xA5  // x to the power of y
+
+#define IDC_BUTTON_PI     0xA6  // Pi constant
+
+#define IDC_BUTTON_LPAR   0xA7  // Left parenthesis
+#define IDC_BUTTON_RPAR   0xA8  // Right parenthesis
+
+#define IDC_BUTTON_SQR    0xA9  // x squared
+#define IDC_BUTTON_CUBE   0xAA  // x cubed
+#define IDC_BUTTON_FACT   0xAB  // Factorial
+
+#define IDC_BUTTON_MSUB   0xAC  // Memory Subtract
+#define IDC_BUTTON_MOD    0xAD  // Modulo
+
+#define IDC_RADIO_DEG     0xAE  // Degrees
+#define IDC_RADIO_RAD     0xAF  // Radians
+#define IDC_RADIO_GRAD    0xB0  // Gradians
+
+#define IDC_RADIO_HEX     0xB1  // Hexadecimal
+#define IDC_RADIO_DEC     0xB2  // Decimal
+#define IDC_RADIO_OCT     0xB3  // Octal
+#define IDC_RADIO_BIN     0xB4  // Binary
+
+// Word size of the non-decimal bases; consecutive, each twice the last
+#define IDC_RADIO_BITS8   0xC7  // Byte
+#define IDC_RADIO_BITS16  0xC8  // Word
+#define IDC_RADIO_BITS32  0xC9  // Dword
+#define IDC_RADIO_BITS64  0xCA  // Qword
+#define IDC_RADIO_BITS128 0xCB  // 128 bits
+#define IDC_RADIO_BITS256 0xCC  // 256 bits
+#define IDC_RADIO_BITS512 0xCD  // 512 bits
+
+#define IDC_BUTTON_AND    0xB8  // Bitwise AND
+#define IDC_BUTTON_OR     0xB9  // Bitwise OR
+#define IDC_BUTTON_XOR    0xBA  // Bitwise XOR
+#define IDC_BUTTON_NOT    0xBB  // Bitwise NOT
+#define IDC_BUTTON_LSH    0xBC  // Left shift
+
+// Bit operators without a button of their own: Inv Lsh is Rsh
+#define IDC_BUTTON_RSH    0xCE  // Right shift, copying the sign bit
+#define IDC_BUTTON_ROL    0xCF  // Rotate left
+#define IDC_BUTTON_ROR    0xD0  // Rotate right
+#define IDC_BUTTON_POPCNT 0xD1  // Number of set bits
+#define IDC_BUTTON_CLZ    0xD2  // Number of leading zero bits
+#define IDC_BUTTON_CTZ    0xD3  // Number of trailing zero bits
+#define IDC_BUTTON_BITREV 0xD4  // Bits in reverse order
+
+#define IDC_BUTTON_INT    0xC0  // Integer Part 
+#define IDC_BUTTON_F_E    0xC1  // Fractional Part
+#define IDC_BUTTON_DMS    0xC2  // Degrees, Minutes, Seconds
+#define IDC_BUTTON_SUM    0xC3  // Summation
+#define IDC_BUTTON_AVE    0xC4  // Average
+#define IDC_BUTTON_DEV    0xC5  // Standard deviation (s)
+#define IDC_BUTTON_DAT    0xC6  // Add the displayed value to the statistics
+
+#define IDC_BUTTON_STA 0x8C     // Statistics button in scientific mode
+
+// Buttons within the statistics window
+#define IDC_BUTTON_STAT_RED  0x75    // RET (Retrieve) button
+#define IDC_BUTTON_STAT_LOAD 0x76    // LOAD button
+#define IDC_BUTTON_STAT_CE   0x77    // C (Clear Entry) button
+#define IDC_BUTTON_STAT_CAD  0x78    // CAD (Clear All Data) button
+#define IDC_STATISTICS_QUANTILES 0x79  // Median and percentiles line, added at run time
+#define IDC_STATISTICS_REGRESSION 0x7a // Least-squares fit line, added at run time
+
+// Hexadecimal digits
+#define IDC_BUTTON_A      0xB5  // Hexadecimal digit A
+#define IDC_BUTTON_B      0xB6  // Hexadecimal digit B
+#define IDC_BUTTON_C      0xB7  // Hexadecimal digit C
+#define IDC_BUTTON_D      0xBD  // Hexadecimal digit D
+#define IDC_BUTTON_E      0xBE  // Hexadecimal digit E
+#define IDC_BUTTON_F      0xBF  // Hexadecimal digit F
+
+
+// Other constants
+#define IDC_BUTTON_DECIMAL 0x55
+#define IDC_BUTTON_RPAREN  0x29
+#define IDC_BUTTON_EXP_ENTRY 0x12D // Exp (exponent entry) key
+#define IDC_BUTTON_INV_TOGGLE 0x7D // Inv checkbox (inverse functions)
+
+// Keypad layouts, row by row. main.c builds BUTTON_ID_MAP_STANDARD and
+// BUTTON_ID_MAP_SCIENTIFIC from these lists, and input.c checks at compile
+// time that its key table has every button, in the mode of its keypad.
+#define STANDARD_KEYPAD(X) \
+    X(IDC_BUTTON_MC)    X(IDC_BUTTON_7)  X(IDC_BUTTON_8)   X(IDC_BUTTON_9)   X(IDC_BUTTON_DIV) X(IDC_BUTTON_SQRT) \
+    X(IDC_BUTTON_MR)    X(IDC_BUTTON_4)  X(IDC_BUTTON_5)   X(IDC_BUTTON_6)   X(IDC_BUTTON_MUL) X(IDC_BUTTON_PERC) \
+    X(IDC_BUTTON_MS)    X(IDC_BUTTON_1)  X(IDC_BUTTON_2)   X(IDC_BUTTON_3)   X(IDC_BUTTON_SUB) X(IDC_BUTTON_INV)  \
+    X(IDC_BUTTON_MPLUS) X(IDC_BUTTON_0)  X(IDC_BUTTON_NEG) X(IDC_BUTTON_DOT) X(IDC_BUTTON_ADD) X(IDC_BUTTON_EQ)   \
+    X(IDC_BUTTON_BACK)  X(IDC_BUTTON_CE) X(IDC_BUTTON_CA)
+
+#define SCIENTIFIC_KEYPAD(X) \
+    X(IDC_BUTTON_MC)    X(IDC_BUTTON_7)   X(IDC_BUTTON_8)    X(IDC_BUTTON_9)    X(IDC_BUTTON_DIV)  X(IDC_BUTTON_MOD) X(IDC_BUTTON_AND) \
+    X(IDC_BUTTON_MR)    X(IDC_BUTTON_4)   X(IDC_BUTTON_5)    X(IDC_BUTTON_6)    X(IDC_BUTTON_MUL)  X(IDC_BUTTON_OR)  X(IDC_BUTTON_XOR) \
+    X(IDC_BUTTON_MS)    X(IDC_BUTTON_1)   X(IDC_BUTTON_2)    X(IDC_BUTTON_3)    X(IDC_BUTTON_SUB)  X(IDC_BUTTON_LSH) X(IDC_BUTTON_NOT) \
+    X(IDC_BUTTON_MPLUS) X(IDC_BUTTON_0)   X(IDC_BUTTON_NEG)  X(IDC_BUTTON_DOT)  X(IDC_BUTTON_ADD)  X(IDC_BUTTON_EQ)  X(IDC_BUTTON_INT) \
+    X(IDC_BUTTON_STA)   X(IDC_BUTTON_F_E) X(IDC_BUTTON_LPAR) X(IDC_BUTTON_RPAR) X(IDC_BUTTON_MSUB) X(IDC_BUTTON_PI)  \
+    X(IDC_BUTTON_A)     X(IDC_BUTTON_B)   X(IDC_BUTTON_C)    X(IDC_BUTTON_D)    X(IDC_BUTTON_E)    X(IDC_BUTTON_F)   \
+    X(IDC_BUTTON_AVE)   X(IDC_BUTTON_DMS) X(IDC_BUTTON_EXP)  X(IDC_BUTTON_LN)   X(IDC_BUTTON_SIN)  X(IDC_BUTTON_XY)  \
+    X(IDC_BUTTON_LOG)   X(IDC_BUTTON_SQR) X(IDC_BUTTON_CUBE) X(IDC_BUTTON_FACT) \
+    X(IDC_BUTTON_SUM)   X(IDC_BUTTON_SIN) X(IDC_BUTTON_COS)  X(IDC_BUTTON_TAN)  X(IDC_BUTTON_ASIN) X(IDC_BUTTON_ACOS) X(IDC_BUTTON_ATAN)
+
+// Display controls
+#define IDC_EDIT_RESULT   0x9B  // Result display
+#define IDC_EDIT_EXPR     0xBE  // Expression display
+
+#endif // KEYS_H
@@ -32,12 +32,18 @@
 
 #include <windows.h>
 #include <windowsx.h>
+#include <shellapi.h>
 #include <winnt.h>
+#include <ctype.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include ".//headers//input.h"
-#include ".//headers//operations.h"
+#include "..//headers//dataload.h"
+#include "..//headers//engine.h"
+#include "..//headers//input.h"
+#include "..//headers//operations.h"
+#include "..//headers//value.h"
 
 typedef unsigned short ushort;
 typedef unsigned int uint;
@@ -66,6 +72,11 @@ extern int VERTICAL_OFFSET; // Vertical istance between button elements
 
 #define HIGH_CONTRAST_MODE_FLAG 0x40c064 // Flag that checks for high contrast mode flag.
 
+#define MAX_LISTED_POINTS 32767       // Data points shown in the statistics list box; a loaded file may have millions
+#define QUANTILE_DIGITS 6             // Significant digits of the median and percentiles in the statistics box
+#define MAX_EXACT_QUANTILE_POINTS 16777216 // Larger data sets show quantiles from the sketch (the sort would take 128 MB)
+#define REGRESSION_DIGITS 6           // Significant digits of the fit in the statistics box
+
 #define MAX_COMMAND_ID    0x79        // Maximum command ID (121 in decimal) for calculator buttons (main.c)
                                       // Used to validate input in WM_COMMAND processing
                                       // Allows treating WM_COMMAND and WM_CHAR messages similarly
@@ -101,9 +112,6 @@ extern int VERTICAL_OFFSET; // Vertical istance between button elements
 #define BUTTON_HORIZONTAL_SPACING 2
 #define BUTTON_VERTICAL_SPACING 2
 
-#define ERROR_STATE_ACTIVE 1
-#define ERROR_STATE_INACTIVE 0
-
 //Calculation status codes
 #define STATUS_READY    0  // Ready to do a calculation
 #define STATUS_WORKING  1  // Working on a calculation
@@ -113,35 +121,8 @@ extern int VERTICAL_OFFSET; // Vertical istance between button elements
 #define EXTENDED_MEMORY_SIZE 0x40000 // Memory allocation size for higher precision (256 KB) 
 
 
-// Calculation result codes
-#define STATUS_SUCCESS                0  // Calculation completed successfully
-#define STATUS_DIVISION_BY_ZERO       1  // Cannot divide by zero
-#define STATUS_CLIPBOARD_ERROR        2  // Cannot open Clipboard
-#define STATUS_INSUFFICIENT_MEMORY    3  // Insufficient memory for data
-#define STATUS_INVALID_INPUT          4  // Invalid input for function
-#define STATUS_OVERFLOW               5  // Result is too large for display
-#define STATUS_UNDERFLOW              6  // Result is too small for display
-#define STATUS_UNDEFINED_RESULT       7  // Result of function is undefined
-
-//Maximum number of digits the calculator can handle.
-#define MAX_BINARY_DIGITS 32
-#define MAX_OCTAL_DIGITS 11
-#define MAX_HEXADECIMAL_DIGITS 8
-
-#define MAX_DECIMAL_DIGITS 13      // Decimal mode. For hex mode, this is 8.
-#define MAX_FRACTIONAL_DIGITS 28   // Fractional part.
-
-#define MAX_DISPLAY_DIGITS 35      // Maximum number of digits the calculator can display.
-#define MAX_STANDARD_PRECISION 12  // Maximum precision for standard mode (32 bits)
-
 #define IDM_VIEW_STANDARD               0x9C4E  // Command to switch to standard calculator view
 
-//Integer masks
-#define INTEGER_PART_MASK_BINARY 0xFFFFFFFF // Mask for binary (32 bits)
-#define INTEGER_PART_MASK_OCTAL  0x1FFFFFFF // Mask for octal (29 bits - to fit in 32 bits)
-#define INTEGER_PART_MASK_DECIMAL 0xFFFFFFFF // Mask for decimal (32 bits)
-#define INTEGER_PART_MASK_HEX    0xFFFFFFF  // Mask for hexadecimal (28 bits)
-
 
 static const char* STATUS_MESSAGE_TABLE[] = {
     "Success",
@@ -161,116 +142,6 @@ static const char* STATUS_MESSAGE_TABLE[] = {
 #define STREAM_PIPE 0x08
 #define STREAM_VALID 0x81
 
-//Calculator buttons - standard mode
-// Standard Calculator Button IDs
-#define IDC_BUTTON_MC     0x80  // Memory Clear
-#define IDC_BUTTON_MR     0x81  // Memory Recall
-#define IDC_BUTTON_MS     0x82  // Memory Store
-#define IDC_BUTTON_MPLUS  0x83  // Memory Add
-
-#define IDC_BUTTON_BACK   0x84  // Backspace
-#define IDC_BUTTON_CE     0x85  // Clear Entry
-#define IDC_BUTTON_CA     0x86  // Clear All
-
-#define IDC_BUTTON_7      0x87  // Digit 7
-#define IDC_BUTTON_8      0x88  // Digit 8
-#define IDC_BUTTON_9      0x89  // Digit 9
-#define IDC_BUTTON_DIV    0x8A  // Division
-
-#define IDC_BUTTON_4      0x8B  // Digit 4
-#define IDC_BUTTON_5      0x8C  // Digit 5
-#define IDC_BUTTON_6      0x8D  // Digit 6
-#define IDC_BUTTON_MUL    0x8E  // Multiplication
-
-#define IDC_BUTTON_1      0x8F  // Digit 1
-#define IDC_BUTTON_2      0x90  // Digit 2
-#define IDC_BUTTON_3      0x91  // Digit 3
-#define IDC_BUTTON_SUB    0x92  // Subtraction
-
-#define IDC_BUTTON_0      0x93  // Digit 0
-#define IDC_BUTTON_DOT    0x94  // Decimal point
-#define IDC_BUTTON_EQ     0x95  // Equals
-#define IDC_BUTTON_ADD    0x96  // Addition
-
-#define IDC_BUTTON_SQRT   0x97  // Square root
-#define IDC_BUTTON_PERC   0x98  // Percentage
-#define IDC_BUTTON_INV    0x99  // Reciprocal (1/x)
-#define IDC_BUTTON_NEG    0x9A  // Negate (+/-)
-
-// Scientific Calculator Additional Button IDs
-#define IDC_BUTTON_SIN    0x9C  // Sine
-#define IDC_BUTTON_COS    0x9D  // Cosine
-#define IDC_BUTTON_TAN    0x9E  // Tangent
-
-#define IDC_BUTTON_ASIN   0x9F  // Arc sine
-#define IDC_BUTTON_ACOS   0xA0  // Arc cosine
-#define IDC_BUTTON_ATAN   0xA1  // Arc tangent
-
-#define IDC_BUTTON_LOG    0xA2  // Logarithm (base 10)
-#define IDC_BUTTON_LN     0xA3  // Natural logarithm
-
-#define IDC_BUTTON_EXP    0xA4  // Exponential (e^x)
-#define IDC_BUTTON_XY     0xA5  // x to the power of y
-
-#define IDC_BUTTON_PI     0xA6  // Pi constant
-
-#define IDC_BUTTON_LPAR   0xA7  // Left parenthesis
-#define IDC_BUTTON_RPAR   0xA8  // Right parenthesis
-
-#define IDC_BUTTON_SQR    0xA9  // x squared
-#define IDC_BUTTON_CUBE   0xAA  // x cubed
-#define IDC_BUTTON_FACT   0xAB  // Factorial
-
-#define IDC_BUTTON_MSUB   0xAC  // Memory Subtract
-#define IDC_BUTTON_MOD    0xAD  // Modulo
-
-#define IDC_RADIO_DEG     0xAE  // Degrees
-#define IDC_RADIO_RAD     0xAF  // Radians
-#define IDC_RADIO_GRAD    0xB0  // Gradians
-
-#define IDC_RADIO_HEX     0xB1  // Hexadecimal
-#define IDC_RADIO_DEC     0xB2  // Decimal
-#define IDC_RADIO_OCT     0xB3  // Octal
-#define IDC_RADIO_BIN     0xB4  // Binary
-
-#define IDC_BUTTON_AND    0xB8  // Bitwise AND
-#define IDC_BUTTON_OR     0xB9  // Bitwise OR
-#define IDC_BUTTON_XOR    0xBA  // Bitwise XOR
-#define IDC_BUTTON_NOT    0xBB  // Bitwise NOT
-#define IDC_BUTTON_LSH    0xBC  // Left shift
-
-#define IDC_BUTTON_INT    0xC0  // Integer Part 
-#define IDC_BUTTON_F_E    0xC1  // Fractional Part
-#define IDC_BUTTON_DMS    0xC2  // Degrees, Minutes, Seconds
-#define IDC_BUTTON_SUM    0xC3  // Summation
-#define IDC_BUTTON_AVE    0xC4  // Average
-
-#define IDC_BUTTON_STA 0x8C     // Statistics button in scientific mode
-
-// Buttons within the statistics window
-#define IDC_BUTTON_STAT_RED  0x75    // RET (Retrieve) button
-#define IDC_BUTTON_STAT_LOAD 0x76    // LOAD button
-#define IDC_BUTTON_STAT_CE   0x77    // C (Clear Entry) button
-#define IDC_BUTTON_STAT_CAD  0x78    // CAD (Clear All Data) button
-
-// Hexadecimal digits
-#define IDC_BUTTON_A      0xB5  // Hexadecimal digit A
-#define IDC_BUTTON_B      0xB6  // Hexadecimal digit B
-#define IDC_BUTTON_C      0xB7  // Hexadecimal digit C
-#define IDC_BUTTON_D      0xBD  // Hexadecimal digit D
-#define IDC_BUTTON_E      0xBE  // Hexadecimal digit E
-#define IDC_BUTTON_F      0xBF  // Hexadecimal digit F
-
-
-// Other constants
-#define IDC_BUTTON_DECIMAL 0x55
-#define IDC_BUTTON_RPAREN  0x29
-#define IDC_BUTTON_EXP     0x12D
-#define IDC_BUTTON_INV     0x7D
-
-// Display controls
-#define IDC_EDIT_RESULT   0x9B  // Result display
-#define IDC_EDIT_EXPR     0xBE  // Expression display
 
 //Codepages potentially supported by the calculator.
 #define NUM_SUPPORTED_CODEPAGES 6 
@@ -278,24 +149,6 @@ static const char* STATUS_MESSAGE_TABLE[] = {
 // Display control
 #define IDC_EDIT_RESULT  0x9B
 
-//Assumes English locale
-#define DEFAULT_DECIMAL_SEPARATOR '.'
-
-
-// Structure to represent an 80-bit extended precision floating-point number
-typedef struct {
-    unsigned short exponent;      // 15 bits: exponent + sign 
-    unsigned int mantissaLow;    // 32 bits: lower part of mantissa
-    unsigned int mantissaHigh;   // 32 bits: upper part of mantissa
-} _extendedFloat80;
-
-
-typedef enum {
-    STANDARD_MODE = 0,
-    SCIENTIFIC_MODE = 1,
-    SCIENTIFIC_NOTATION = 2,
-} _calculatorMode;
-
 typedef enum {
     STATE_UP = 0x66,
     STATE_DOWN = 0x65
@@ -340,46 +193,27 @@ typedef struct {
 #define CHAR_LEADBYTE 8    // Lead byte in a double-byte character set (DBCS)
 #define CHAR_HEXDIGIT 0x10 // Valid character for hexadecimal input (0-9, A-F)
 
-#define MAX_OPERATOR_STACK 25 //Max level of parenthesis identiations
-
 //Runtime errors
 #define MEM_ALLOC_ERROR 8
 #define STRING_COPY_ERROR 9
 
 typedef struct {
-    char accumulatedValue[MAX_DISPLAY_DIGITS];  // Current value or result of the last operation
+    _calcEngine engine;                         // Platform-neutral calculator state (entry, operators, memory)
     _applicationPath appPath;                   // Calculator application path
     HINSTANCE appInstance;                      // Handle to the current instance of the application
     int buttonHorizontalSpacing;                // Horizontal spacing between calculator buttons
     const char* className;                      // Name of the window class for the calculator
     _codePageInfo codepageInfo;                 // Information about the active code page.
-    int currentSign;                            // Positive / negative sign of the current input.
-    DWORD currentOperator;                      // Current operation (ADDITION, SUBTRACTION, MULTIPLICATION...)
-    int currentPrecisionLevel;                  // Initialize to max standard precision
-    DWORD currentValueHighPart;                 // High part of the current value (for high precision)
     DWORD currentBackgroundColor;               // Current background color of the calculator
-    char decimalSeparator;                      // Character used as decimal separator
     char decimalSeparatorBuffer[2];             // Buffer for storing decimal separator
     DWORD defaultPrecisionValue;                // Default precision for calculations
-    int errorState;                             // Current error state of the calculator
-    DWORD errorCodeBase;                        // Base value for error codes
-    BOOL hasOperatorPending;                    // Flag indicating if an operator is pending
     BOOL isHighContrastMode;                    // Flag indicating if high contrast mode is active
-    BOOL isInputModeActive;                     // Flag indicating if input mode is active
-    BOOL isInverseMode;                         // Flag to indicate inverse mode 
     BOOL isScientificModeActive;                // Flag indicating if scientific mode is active
     char helpFilePath[MAX_PATH];                // Path to the calculator's help file
-    DWORD keyPressed;                           // Stores the currently pressed key
-    DWORD lastValue;                            // Previous value before the last operation
-    _calculatorMode mode;                       // Current mode of the calculator (Standard or Scientific)
     const char* modeText[2];                    // Text representations of calculator modes
-    DWORD memoryRegister[2];                    // Memory storage for calculator operations
-    int numberBase;                             // Current number base (2 for binary, 8 for octal, 10 for decimal, 16 for hexadecimal)
-    int operatorStackPointer;                   // Index into the operator stack
     HWND statisticsWindow;                      // Handle to the statistics window
     BOOL statisticsWindowOpen;                  // Flag to track if the statistics window is open
     const char* registryKey;                    // Registry key for storing calculator settings
-    _extendedFloat80 scientificNumber;          // 80-bit extended precision floating-point number
     HWND scientificWindowHandle;                // Handle to the scientific calculator window
     HWND windowHandle;                          // Handle to the main calculator window
     
@@ -416,16 +250,24 @@ void initStandardStreams(void);
 void initEnvironmentVariables(void);
 void handleCalculationError(int errorCode);
 BOOL handleContextHelp(HWND hwnd, HINSTANCE hInstance, UINT param);
+void parseAndStoreDataPoints(const char* text);
+void loadDataFile(HWND windowHandle, const char* path, BOOL isRegression);
+void applyQuantileAccuracy(void);
+void updateQuantileDisplay(HWND windowHandle);
+void updateRegressionDisplay(HWND windowHandle);
+void performStatisticalCalculation(DWORD keyPressed);
 void processButtonClick(DWORD currentKeyPressed);
 void refreshInterface(void);
 ATOM registerCalcClass(HINSTANCE appInstance);
 void resetCalculatorState(void);
 void toggleScientificMode(void);
+void toggleStatisticsWindow(UINT buttonID);
 BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam);
 BOOL CALLBACK scientificDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 int WINAPI WinMain(HINSTANCE appInstance, HINSTANCE unused, LPSTR commandLine, int windowMode);
 void updateButtonState(uint buttonID, int state);
 void updateDecimalSeparator();
 void updateDisplay(void);
+void updateStatisticsDisplay(HWND windowHandle);
 
 #endif // MAIN_H
\ No newline at end of file
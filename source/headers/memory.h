@@ -1,18 +1,125 @@
+/*-----------------------------------------------------------------------------
+    memory.h --  Header file for the engine heap (reconstructed code).
+
+                 The engine heap serves engine temporaries and big-number
+                 limbs from power-of-two size classes. Each class keeps a
+                 free list per thread, so an allocation pops a block and a
+                 free pushes one back, in constant time and without a
+                 lock. Blocks are HEAP_ALIGNMENT-aligned, or up to
+                 HEAP_MAX_ALIGNMENT-aligned on request for SIMD code.
+
+                 Memory comes from the system in HEAP_CHUNK_SIZE-aligned
+                 chunks (mmap where there is one). Blocks of up to
+                 HEAP_MAX_SMALL_BLOCK bytes are cut from chunks of one
+                 class; a larger block has a mapping of its own and is
+                 kept for reuse after it is freed, and a block beyond
+                 HEAP_MAX_LARGE_BLOCK goes back to the system at once.
+
+                 Any thread may free a block that another allocated.
+
+                 Where the system has huge pages, a chunk of at least
+                 HEAP_HUGE_PAGE_SIZE bytes is aligned to one, so that the
+                 limbs of a number with millions of digits take few TLB
+                 entries (see setHeapPageMode). Pages are committed as
+                 they are first touched, and releaseHeapMemory hands the
+                 pages of the blocks kept for reuse back to the system
+                 while keeping their address ranges.
+
+                 A _memoryArena hands out memory by bumping a pointer
+                 through chunks of a chosen size and takes all of it back
+                 at once in resetMemoryArena, keeping the chunks for the
+                 next round. While a thread has selected an arena, the
+                 heap serves its requests of up to HEAP_MAX_ARENA_BLOCK
+                 bytes from the arena; freeing such a block does nothing, and
+                 reallocating it moves it. Whatever must outlive a reset
+                 has to be copied out with the arena deselected first
+                 (see isArenaMemory).
+
+                 With HEAP_STATISTICS, every allocation and free is
+                 counted by the thread that makes it, and
+                 getHeapStatistics reports the counts of the calling
+                 thread together with those of the threads that ended.
+                 HEAP_STATISTICS defaults to 0 where NDEBUG is defined;
+                 the counting code is then left out, and the functions
+                 below report nothing.
+
+ -------------------------------------------------------------------------------*/
+
 #ifndef MEMORY_H
+#define MEMORY_H
+
 #pragma once
 
-#include "..//headers//main.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-typedef struct memoryBlock {
-    struct memoryBlock* nextBlock;    // Pointer to the next memory block in the list
-    DWORD flags_and_size;            // Flags indicating the block's state and its size
-} memoryBlock, * PmemoryBlock; // Correct the pointer type to 'PmemoryBlock'
+#ifndef HEAP_STATISTICS
+#ifdef NDEBUG
+#define HEAP_STATISTICS 0
+#else
+#define HEAP_STATISTICS 1
+#endif
+#endif
 
-extern memoryBlock* memoryBlockListHead; //Corrected typo
+#define HEAP_ALIGNMENT 16                 // Alignment of every block
+#define HEAP_MAX_ALIGNMENT 64             // Largest alignment on request (a cache line)
+#define HEAP_CHUNK_SIZE 0x10000           // Alignment and granularity of system memory (64 KB)
+#define HEAP_MAX_SMALL_BLOCK 0x1000       // Largest block cut from a shared chunk (4 KB)
+#define HEAP_MAX_LARGE_BLOCK 0x4000000    // Largest block kept for reuse (64 MB)
+#define HEAP_MAX_ARENA_BLOCK 0x4000       // Largest block served from an arena (16 KB)
+#define DEFAULT_ARENA_CHUNK_SIZE 0x10000  // Chunk size of a new arena (64 KB)
+#define HEAP_HUGE_PAGE_SIZE 0x200000      // Huge page, and smallest chunk put on huge pages (2 MB)
+#define HEAP_SIZE_CLASSES 23              // Classes of 16 bytes to HEAP_MAX_LARGE_BLOCK
+#define HEAP_HISTOGRAM_HUGE HEAP_SIZE_CLASSES          // Histogram entry of blocks beyond the classes
+#define HEAP_HISTOGRAM_ARENA (HEAP_SIZE_CLASSES + 1)   // Histogram entry of arena blocks
+#define HEAP_HISTOGRAM_SIZE (HEAP_SIZE_CLASSES + 2)
 
-DWORD allocateAdditionalMemory(DWORD requestedSize);
-DWORD allocateMemoryFromHeap(DWORD requestedSize);
+typedef enum {
+    HEAP_PAGES_NORMAL = 0,      // System pages only
+    HEAP_PAGES_TRANSPARENT,     // Large chunks aligned and advised for transparent huge pages
+    HEAP_PAGES_EXPLICIT         // Large chunks from the reserved huge page pool, else transparent
+} _heapPageMode;
 
+typedef struct {
+    char* next;            // Next free byte of the current chunk
+    char* end;             // End of the free space of the current chunk
+    void* chunks;          // Chunks in use, the current one first
+    void* lastChunk;       // Chunk in use longest
+    void* spareChunks;     // Chunks freed by the last reset
+    size_t chunkSize;      // Bytes per new chunk
+    size_t used;           // Bytes handed out since the last reset
+    size_t blockCount;     // Blocks handed out since the last reset
+} _memoryArena;
 
-#define MEMORY_H
-#endif
\ No newline at end of file
+typedef struct {
+    uint64_t allocationCount;                  // Blocks handed out
+    uint64_t freeCount;                        // Blocks given back, arena blocks at a reset
+    int64_t bytesInUse;                        // Bytes of the blocks handed out and not given back
+    int64_t peakBytesInUse;                    // Most bytesInUse one thread has seen
+    int64_t systemBytes;                       // Bytes taken from the system and not returned
+    uint64_t histogram[HEAP_HISTOGRAM_SIZE];   // Allocations per class (16 << index bytes), huge and arena
+} _heapStatistics;
+
+void* allocateMemoryFromHeap(size_t requestedSize);
+void* allocateAlignedMemoryFromHeap(size_t requestedSize, size_t alignment);
+void* reallocateMemoryFromHeap(void* memory, size_t requestedSize);
+void freeMemoryToHeap(void* memory);
+size_t getHeapBlockSize(const void* memory);
+void setHeapPageMode(_heapPageMode mode);
+size_t releaseHeapMemory(void);
+
+void initMemoryArena(_memoryArena* arena, size_t chunkSize);
+void freeMemoryArena(_memoryArena* arena);
+void resetMemoryArena(_memoryArena* arena);
+void setMemoryArenaChunkSize(_memoryArena* arena, size_t chunkSize);
+void* allocateMemoryFromArena(_memoryArena* arena, size_t requestedSize);
+_memoryArena* selectMemoryArena(_memoryArena* arena);
+bool isArenaMemory(const void* memory);
+
+bool getHeapStatistics(_heapStatistics* statistics);
+double getHeapFragmentation(const _heapStatistics* statistics);
+size_t formatHeapStatistics(const _heapStatistics* statistics, char* buffer, size_t bufferSize);
+bool installHeapStatisticsDump(const char* path);
+
+#endif // MEMORY_H
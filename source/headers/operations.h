@@ -15,7 +15,10 @@
 
 #pragma once
 
-#include "..//headers//main.h"
+#include <stdint.h>
+#include "..//headers//bignum.h"
+#include "..//headers//engine.h"
+#include "..//headers//extfloat.h"
 
 
  // Maximum allocation size from the heap, likely related to limitations of 
@@ -30,11 +33,21 @@
 #define ALIGNMENT_MASK_UNSIGNED 0xFFFFFFFCU
 
 
-void intToExtendedFloat80(LONGLONG value);
-BOOL isValueOverflow(int digit);
-BOOL isValueOverflowExtended(void);
-void shiftMultiWordInteger(DWORD* highWord, int shiftAmount);
-void stringToExtendedFloat80(const char* str);
+void formatFloatAutomatically(char* destination, const char* source, char decimalSeparator);
+void formatNumberForDisplay(char* destination, const char* source, int precision);
+void formatScientificNotation(char* destination, const char* source, char decimalSeparator);
+void intToBaseString(uint32_t value, char* buffer, int base);
+void intToExtendedFloat80(_extendedFloat80* result, int64_t value);
+bool isValueOverflowExtended(_extendedFloat80* value, int numberBase);
+double performAdvancedCalculation(_calcEngine* engine, uint32_t operatorKey, double operand1, double operand2);
+int performBigCalculation(const _calcEngine* engine, uint32_t operatorKey, _bigDecimal* result,
+    const _bigDecimal* operand1, const _bigDecimal* operand2);
+int performExtendedCalculation(uint32_t operatorKey, _extendedFloat80* result,
+    const _extendedFloat80* operand1, const _extendedFloat80* operand2);
+int performValueCalculation(_calcEngine* engine, uint32_t operatorKey, _calcValue* result,
+    const _calcValue* operand1, const _calcValue* operand2);
+void shiftMultiWordInteger(_extendedFloat80* value, int shiftAmount);
+int stringToExtendedFloat80(_extendedFloat80* result, const char* str, char decimalSeparator);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+/*-----------------------------------------------------------------------------
+    optimize.h --  Header file for the optimizer of compiled expressions
+                   (reconstructed code).
+
+                   expressionOptimize rewrites the instructions of an
+                   _expression so that constant parts (pi, the angle mode
+                   factors, constant function arguments) are computed once
+                   at optimization time and repeated subexpressions once
+                   per evaluation. Results and STATUS_* codes do not
+                   change: folding uses the evaluator itself, and an
+                   operator that would fail is left for evaluation time.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#pragma once
+
+#include "..//headers//expression.h"
+
+int expressionOptimize(_expression* expression);
+
+#endif // OPTIMIZE_H
@@ -0,0 +1,25 @@
+/*-----------------------------------------------------------------------------
+    powers.h --  Header file for the table of 128-bit powers of five used by
+                 the fast decimal-to-binary conversion (reconstructed code).
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef POWERS_H
+#define POWERS_H
+
+#pragma once
+
+#include <stdint.h>
+
+#define POWERS_OF_FIVE_MIN_EXPONENT (-342)
+#define POWERS_OF_FIVE_MAX_EXPONENT 308
+#define POWERS_OF_FIVE_COUNT (POWERS_OF_FIVE_MAX_EXPONENT - POWERS_OF_FIVE_MIN_EXPONENT + 1)
+#define POWERS_OF_FIVE_EXACT_LIMIT 55   // 5^q fits in 128 bits for q <= 55
+
+// floor(q * log2(5)) for |q| < 643 from a 16-bit fixed-point log2(5);
+// for larger |q| (up to 2^15) it can be one too high
+#define FLOOR_LOG2_POW5(q) (((q) * 152170) >> 16)
+
+extern const uint64_t POWERS_OF_FIVE_128[POWERS_OF_FIVE_COUNT][2];
+
+#endif // POWERS_H
@@ -0,0 +1,61 @@
+/*-----------------------------------------------------------------------------
+    quantile.h --  Header file for the quantile sketch of the statistics
+                   box (reconstructed code).
+
+                   A _quantileSketch is a merging t-digest: the points are
+                   kept as at most about compression + 1 weighted
+                   centroids, small near the minimum and maximum and large
+                   in the middle, so the median and the tail percentiles
+                   come out with a rank error of roughly 1/compression
+                   or better, whatever the number of points. New points
+                   are buffered and merged in when the buffer fills, so
+                   the memory is fixed by the compression; a query reads
+                   the centroids and the buffer and never rescans the
+                   data.
+
+                   Sketches of different parts of a data set merge into a
+                   sketch of the whole, which is how bulk loads build
+                   theirs in parallel. Functions that can fail return one
+                   of the STATUS_* codes.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DEFAULT_QUANTILE_COMPRESSION 100.0
+#define MIN_QUANTILE_COMPRESSION 20.0
+#define MAX_QUANTILE_COMPRESSION 5000.0
+
+typedef struct {
+    double mean;
+    double weight;
+} _centroid;
+
+typedef struct {
+    double compression;          // Accuracy knob; 0 until the first point (then the default)
+    _centroid* centroids;        // Merged centroids in order of mean, then buffered points
+    _centroid* scratch;          // capacity more, for sorting and merging
+    size_t mergedCount;
+    size_t sortedCount;          // Buffered points in order of mean, from mergedCount
+    size_t count;                // Merged centroids and buffered points
+    size_t capacity;
+    double totalWeight;
+    double minimum;
+    double maximum;
+} _quantileSketch;
+
+void quantileSketchInit(_quantileSketch* sketch, double compression);
+void quantileSketchFree(_quantileSketch* sketch);
+void quantileSketchClear(_quantileSketch* sketch);
+int quantileSketchAdd(_quantileSketch* sketch, double point);
+int quantileSketchAddPoints(_quantileSketch* sketch, const double* points, size_t count);
+int quantileSketchMerge(_quantileSketch* sketch, const _quantileSketch* other);
+int quantileSketchGetQuantile(_quantileSketch* sketch, double fraction, double* result);
+
+#endif // QUANTILE_H
@@ -0,0 +1,43 @@
+/*-----------------------------------------------------------------------------
+    radixsort.h --  Header file for the radix sort of statistics data
+                    points (reconstructed code).
+
+                    Doubles are sorted as 64-bit keys whose unsigned order
+                    is the numeric order: the sign bit of a positive
+                    double is set, and every bit of a negative one is
+                    flipped. radixSortKeys sorts such keys with a stable
+                    least-significant-digit radix sort, on several
+                    threads for large counts. Functions that can fail
+                    return one of the STATUS_* codes.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Sort key of a double: -0.0 sorts just below +0.0, NaNs beyond the infinities
+static inline uint64_t radixKeyFromDouble(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | 0x8000000000000000ull;
+}
+
+// The double of a sort key
+static inline double radixDoubleFromKey(uint64_t key)
+{
+    uint64_t bits = (key >> 63) ? key & 0x7FFFFFFFFFFFFFFFull : ~key;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int radixSortKeys(uint64_t* keys, size_t count, unsigned threads);
+
+#endif // RADIXSORT_H
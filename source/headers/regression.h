@@ -0,0 +1,57 @@
+/*-----------------------------------------------------------------------------
+    regression.h --  Header file for the least-squares regression of the
+                     statistics box (reconstructed code).
+
+                     A _regression keeps rows of one to
+                     MAX_REGRESSION_VARIABLES x values and a y value,
+                     together with their means and the matrix of their
+                     co-moments (sums of products of deviations from the
+                     means). Adding or removing a row updates them in
+                     O(k^2) for k variables, so the fit, r and r^2 are
+                     available at once whatever the number of rows. The
+                     coefficients solve the normal equations and are kept
+                     until the rows change.
+
+                     Each row carries the index of the statistics point that
+                     holds its y, so the statistics box can remove the row
+                     with the point. Regressions of different parts of a
+                     data set merge into one of the whole, which is how
+                     bulk loads build theirs in parallel. Functions that
+                     can fail return one of the STATUS_* codes.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define MAX_REGRESSION_VARIABLES 8
+#define REGRESSION_COLUMNS (MAX_REGRESSION_VARIABLES + 1)  // The x values, then y
+
+typedef struct {
+    size_t variables;                 // x values per row; 0 until the first row
+    size_t count;
+    size_t capacity;                  // Rows allocated
+    double* rows;                     // count rows of variables x values and then y
+    size_t* pointIndices;             // Index of the statistics point holding the y of each row, ascending
+    double means[REGRESSION_COLUMNS];
+    double comoments[REGRESSION_COLUMNS][REGRESSION_COLUMNS];  // Sums of (a - mean a) * (b - mean b)
+    double coefficients[REGRESSION_COLUMNS];                   // Intercept, then one slope per variable
+    bool isSolved;                    // coefficients are those of the current rows
+} _regression;
+
+void regressionInit(_regression* regression);
+void regressionFree(_regression* regression);
+void regressionClear(_regression* regression);
+int regressionAdd(_regression* regression, const double* x, size_t variables, double y, size_t pointIndex);
+void regressionRemovePoint(_regression* regression, size_t pointIndex);
+int regressionMerge(_regression* regression, const _regression* other, size_t pointOffset);
+int regressionGetCoefficients(_regression* regression, double* coefficients);
+int regressionGetDetermination(_regression* regression, double* result);
+int regressionGetCorrelation(_regression* regression, double* result);
+
+#endif // REGRESSION_H
@@ -0,0 +1,117 @@
+/*-----------------------------------------------------------------------------
+    statistics.h --  Header file for the data points of the statistics box
+                     (reconstructed code).
+
+                     A _statistics keeps the data points in order of entry
+                     together with running sums, so adding, removing and
+                     clearing a point are O(1) and Sum, Ave and s are
+                     available at once whatever the number of points.
+
+                     The sum and the sum of squares are Neumaier
+                     (compensated) sums; the standard deviation comes from
+                     Welford's running mean and sum of squared deviations,
+                     which does not cancel catastrophically the way
+                     sum(x^2) - n*mean^2 does. Functions that can fail
+                     return one of the STATUS_* codes.
+
+                     The points form one cache-aligned column of doubles.
+                     statisticsSummarize recomputes everything (including
+                     the minimum and maximum, which running sums cannot
+                     keep under removal) from the column with AVX2 or NEON
+                     kernels, summing in a fixed tree of blocks that
+                     threads share without changing the result.
+
+                     Medians and percentiles come from a quantile sketch
+                     kept next to the running sums. A sketch cannot forget
+                     a point, so removing one marks it stale and the next
+                     quantile query rebuilds it from the column.
+
+                     Exact order statistics and histograms come from the
+                     points in order, sorted by radix sort at the first
+                     such query and kept. Points added later are sorted in
+                     at the next one, and removing a point takes it out of
+                     the sorted copy, so the copy is never sorted again
+                     from scratch.
+
+                     A point may carry x values, entered with
+                     statisticsAddRegressor before it, which make it the y
+                     of a row of a least-squares regression (see
+                     regression.h) kept with the points.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "..//headers//quantile.h"
+#include "..//headers//regression.h"
+
+typedef struct {
+    double* points;                   // Data points in order of entry, from a cache line
+    void* pointStorage;               // Allocation holding points
+    size_t count;
+    size_t capacity;                  // Points allocated
+    double mean;                      // Welford running mean
+    double squaredDeviations;         // Welford sum of (x - mean)^2
+    double sum;                       // Neumaier sum of the points
+    double sumCompensation;           // Rounding errors of sum
+    double sumOfSquares;              // Neumaier sum of the squared points
+    double sumOfSquaresCompensation;  // Rounding errors of sumOfSquares
+    _quantileSketch quantiles;        // Median and percentiles
+    size_t sketchedCount;             // quantiles holds points[0 .. sketchedCount); the rest wait for a query
+    bool isQuantilesStale;            // A point was removed; rebuild quantiles before use
+    uint64_t* sortedKeys;             // Sort keys of points[0 .. sortedCount) in ascending order
+    size_t sortedCount;
+    size_t sortedCapacity;            // Keys allocated
+    _regression regression;           // Rows of the points entered with x values
+    double regressors[MAX_REGRESSION_VARIABLES];  // x values for the next point
+    size_t regressorCount;
+} _statistics;
+
+// Statistics recomputed from the points by statisticsSummarize
+typedef struct {
+    size_t count;
+    double sum;
+    double sumOfSquares;
+    double mean;
+    double squaredDeviations;         // Sum of (x - mean)^2
+    double minimum;
+    double maximum;
+} _statisticsSummary;
+
+// engine.h embeds _statistics in _calcEngine, so it is included after the type
+#include "..//headers//engine.h"
+
+// Whether statisticsSummarize may use the AVX2 or NEON kernel when the
+// processor has it. Exposed so benchmarks can time the portable kernel.
+extern bool statisticsUseSimd;
+
+// Threads for statisticsSummarize and bulk loads; 0 for one per processor
+extern unsigned statisticsThreads;
+
+void statisticsInit(_statistics* statistics);
+void statisticsFree(_statistics* statistics);
+void statisticsClear(_statistics* statistics);
+int statisticsAdd(_statistics* statistics, double point);
+int statisticsAddRegressor(_statistics* statistics, double x);
+int statisticsAppend(_statistics* statistics, const double* points, size_t count, const _quantileSketch* sketch);
+int statisticsRemove(_statistics* statistics, size_t index);
+int statisticsReserve(_statistics* statistics, size_t capacity);
+int statisticsSummarize(const _statistics* statistics, _statisticsSummary* summary);
+unsigned statisticsGetThreadCount(void);
+void statisticsSetQuantileCompression(_statistics* statistics, double compression);
+int statisticsGetQuantile(_statistics* statistics, double fraction, double* result);
+int statisticsSortPoints(_statistics* statistics);
+int statisticsGetExactQuantile(_statistics* statistics, double fraction, double* result);
+int statisticsGetHistogram(_statistics* statistics, double minimum, double maximum, size_t binCount,
+    size_t* counts);
+int statisticsGetSum(const _statistics* statistics, bool isSquared, double* result);
+int statisticsGetMean(const _statistics* statistics, bool isSquared, double* result);
+int statisticsGetDeviation(const _statistics* statistics, bool isPopulation, double* result);
+
+#endif // STATISTICS_H
@@ -0,0 +1,45 @@
+/*-----------------------------------------------------------------------------
+    value.h --  Header file for the typed operands of the calculator engine
+                (reconstructed code).
+
+                A _calcValue (defined in engine.h) carries a number through
+                the operator pipeline in the representation its mode
+                computes in, so results are converted to text only when
+                they are displayed. Functions that can fail return one of
+                the STATUS_* codes.
+
+                Every _calcValue must start as valueInit (or zero-filled
+                memory) and be released with valueFree, which leaves it as
+                integer 0 again.
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef VALUE_H
+#define VALUE_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "..//headers//engine.h"
+#include "..//headers//format.h"
+
+void valueInit(_calcValue* value);
+void valueFree(_calcValue* value);
+int valueCopy(_calcValue* result, const _calcValue* value);
+void valueMove(_calcValue* result, _calcValue* value);
+
+void valueSetInteger(_calcValue* result, int64_t integer);
+void valueSetDouble(_calcValue* result, double real);
+void valueSetExtended(_calcValue* result, const _extendedFloat80* extended);
+void valueSetFixed(_calcValue* result, const _fixedInt* fixed);
+
+int valueConvert(_calcValue* value, _valueType type, int precision);
+int valueFromString(_calcValue* result, _valueType type, const char* text, int numberBase,
+    char decimalSeparator, int precision);
+double valueToDouble(const _calcValue* value);
+bool valueIsZero(const _calcValue* value);
+size_t formatValue(char* buffer, size_t bufferSize, const _calcValue* value, _numberLayout layout,
+    int significantDigits, char decimalSeparator);
+
+#endif // VALUE_H
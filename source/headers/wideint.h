@@ -0,0 +1,161 @@
+/*-----------------------------------------------------------------------------
+    wideint.h --  64-bit limb primitives shared by the software floating
+                  point and the number formatter (reconstructed code).
+
+                  The 64x64->128 multiply, 128/64 divide and the bit
+                  counts come from the compiler: GCC/Clang builtins and
+                  unsigned __int128, or the MSVC x64 intrinsics. 32-bit
+                  MSVC has neither, and uses the portable C versions
+                  (WIDEINT_PORTABLE, which a build may also define to
+                  test them).
+
+ -------------------------------------------------------------------------------*/
+
+#ifndef WIDEINT_H
+#define WIDEINT_H
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#if !defined(_M_X64) && !defined(WIDEINT_PORTABLE)
+#define WIDEINT_PORTABLE 1
+#endif
+#endif
+
+// Number of leading zero bits; value must not be 0
+static inline int countLeadingZeros64(uint64_t value)
+{
+#if defined(WIDEINT_PORTABLE)
+    int count = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if ((value >> (64 - step)) == 0) {
+            count += step;
+            value <<= step;
+        }
+    }
+    return count;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+// Number of trailing zero bits; value must not be 0
+static inline int countTrailingZeros64(uint64_t value)
+{
+#if defined(WIDEINT_PORTABLE)
+    int count = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if ((value << (64 - step)) == 0) {
+            count += step;
+            value >>= step;
+        }
+    }
+    return count;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Number of set bits. MSVC has no popcount that runs on every x64
+// processor, so it counts in parallel within the word.
+static inline int countBits64(uint64_t value)
+{
+#if defined(WIDEINT_PORTABLE) || (defined(_MSC_VER) && !defined(__clang__))
+    value -= (value >> 1) & 0x5555555555555555ull;
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((value * 0x0101010101010101ull) >> 56);
+#else
+    return __builtin_popcountll(value);
+#endif
+}
+
+// The bits in reverse order: bit 0 becomes bit 63
+static inline uint64_t reverseBits64(uint64_t value)
+{
+    value = ((value >> 1) & 0x5555555555555555ull) | ((value & 0x5555555555555555ull) << 1);
+    value = ((value >> 2) & 0x3333333333333333ull) | ((value & 0x3333333333333333ull) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((value & 0x0F0F0F0F0F0F0F0Full) << 4);
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+// Returns the low half of a * b and stores the high half in *high
+static inline uint64_t multiply64(uint64_t a, uint64_t b, uint64_t* high)
+{
+#if defined(WIDEINT_PORTABLE)
+    // Four 32x32 products; the middle sum cannot carry out of 64 bits
+    uint64_t aLow = (uint32_t)a, aHigh = a >> 32, bLow = (uint32_t)b, bHigh = b >> 32;
+    uint64_t low = aLow * bLow;
+    uint64_t middle = aHigh * bLow + (low >> 32);
+    uint64_t cross = aLow * bHigh + (uint32_t)middle;
+    *high = aHigh * bHigh + (middle >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t)low;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    return _umul128(a, b, high);
+#else
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#endif
+}
+
+// (high:low) / divisor with high < divisor; stores the remainder
+static inline uint64_t divide128(uint64_t high, uint64_t low, uint64_t divisor, uint64_t* remainder)
+{
+#if defined(WIDEINT_PORTABLE)
+    // Two 96/64 digit steps on the normalized divisor (divlu in Hacker's Delight)
+    int shift = countLeadingZeros64(divisor);
+    divisor <<= shift;
+    high = (shift == 0) ? high : (high << shift) | (low >> (64 - shift));
+    low <<= shift;
+    uint64_t divisorHigh = divisor >> 32, divisorLow = (uint32_t)divisor;
+    uint64_t digits[2] = { low >> 32, (uint32_t)low };
+    uint64_t quotient = 0;
+    for (int k = 0; k < 2; k++) {
+        uint64_t digit = high / divisorHigh;
+        uint64_t rest = high - digit * divisorHigh;
+        while ((digit >> 32) != 0 || digit * divisorLow > ((rest << 32) | digits[k])) {
+            digit--;
+            rest += divisorHigh;
+            if ((rest >> 32) != 0) {
+                break;
+            }
+        }
+        high = (high << 32) + digits[k] - digit * divisor;
+        quotient = (quotient << 32) | digit;
+    }
+    *remainder = high >> shift;
+    return quotient;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    return _udiv128(high, low, divisor, remainder);
+#else
+    unsigned __int128 numerator = ((unsigned __int128)high << 64) | low;
+    *remainder = (uint64_t)(numerator % divisor);
+    return (uint64_t)(numerator / divisor);
+#endif
+}
+
+// True if value converts to int64_t: a NaN, an infinity or a value of
+// 2^63 or more in magnitude would make the cast undefined behaviour
+static inline bool isInt64Range(double value)
+{
+    return value >= -0x1p63 && value < 0x1p63;
+}
+
+#endif // WIDEINT_H
@@ -13,6 +13,7 @@
                 - appendDigit: Appends a digit to the accumulated value,
                                 handling different number bases.
                 - convertKeyToDigit: Maps button IDs to numeric digit values.
+                - getKeyInfo: Looks a key ID up in the key table.
                 - isClearKey: Determines if a key is a clear (CE or C) key.
                 - isNumericInput:  Identifies numeric input keys (0-9, A-F).
                 - isOperatorKey:  Identifies operator keys (+, -, *, /, etc.).
@@ -22,15 +23,136 @@
                 - updateInputMode: Activates/deactivates input mode based on
                                     the key pressed.
 
+                The classifiers are answered from one table indexed by key
+                ID (KEY_TABLE), which holds each key's classes, digit
+                value, operator precedence and the modes it works in. The
+                table is checked at compile time against the keypad
+                layouts of keys.h.
+
+                This module is part of the platform-neutral engine library
+                and must not include <windows.h>.
+
 -------------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
 #include ".//headers//input.h"
-#include ".//headers//main.h"
 
-extern _calculatorState calcState;
+// Every key the engine classifies, and every keypad button:
+// X(id, classes, digit, precedence, modes)
+#define KEYS(X) \
+    X(IDC_BUTTON_0,    KEY_CLASS_DIGIT, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_1,    KEY_CLASS_DIGIT, 1, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_2,    KEY_CLASS_DIGIT, 2, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_3,    KEY_CLASS_DIGIT, 3, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_4,    KEY_CLASS_DIGIT, 4, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_5,    KEY_CLASS_DIGIT, 5, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_6,    KEY_CLASS_DIGIT, 6, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_7,    KEY_CLASS_DIGIT, 7, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_8,    KEY_CLASS_DIGIT, 8, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_9,    KEY_CLASS_DIGIT, 9, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_A,    KEY_CLASS_DIGIT, 10, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_B,    KEY_CLASS_DIGIT, 11, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_C,    KEY_CLASS_DIGIT, 12, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_D,    KEY_CLASS_DIGIT, 13, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_E,    KEY_CLASS_DIGIT, 14, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_F,    KEY_CLASS_DIGIT, 15, 0, KEY_MODES_SCIENTIFIC) \
+    \
+    X(IDC_BUTTON_ADD,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 4, KEY_MODES_ALL) \
+    X(IDC_BUTTON_SUB,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 4, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MUL,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 5, KEY_MODES_ALL) \
+    X(IDC_BUTTON_DIV,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 5, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MOD,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 5, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_XY,   KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 6, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_AND,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 2, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_OR,   KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 1, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_XOR,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 1, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_LSH,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 3, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_RSH,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 3, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_ROL,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 3, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_ROR,  KEY_CLASS_BINARY | KEY_CLASS_ENDS_INPUT, 0, 3, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_EQ,   KEY_CLASS_EQUALS | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    \
+    X(IDC_BUTTON_SQRT, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_PERC, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_INV,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_SIN,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_COS,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_TAN,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_ASIN, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_ACOS, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_ATAN, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_LOG,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_LN,   KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_EXP,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_SQR,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_CUBE, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_FACT, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_NOT,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_POPCNT, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_CLZ,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_CTZ,  KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_BITREV, KEY_CLASS_UNARY | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    \
+    X(IDC_BUTTON_CE,   KEY_CLASS_CLEAR, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_CA,   KEY_CLASS_CLEAR, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_INV_TOGGLE, KEY_CLASS_SPECIAL, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MC,   KEY_CLASS_SPECIAL, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_STAT_RED,  KEY_CLASS_SPECIAL | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_STAT_LOAD, KEY_CLASS_SPECIAL | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_STAT_CE,   KEY_CLASS_SPECIAL | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_STAT_CAD,  KEY_CLASS_SPECIAL | KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_RPAREN,    KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_EXP_ENTRY, KEY_CLASS_ENDS_INPUT, 0, 0, KEY_MODES_ALL) \
+    \
+    X(IDC_BUTTON_MR,   0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MS,   0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MPLUS, 0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_BACK, 0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_DOT,  0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_NEG,  0, 0, 0, KEY_MODES_ALL) \
+    X(IDC_BUTTON_MSUB, 0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_PI,   0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_LPAR, 0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_RPAR, 0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_INT,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_F_E,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_DMS,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_SUM,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_AVE,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_DEV,  0, 0, 0, KEY_MODES_SCIENTIFIC) \
+    X(IDC_BUTTON_DAT,  0, 0, 0, KEY_MODES_SCIENTIFIC)
+
+#define KEY_TABLE_ENTRY(id, classes, digit, precedence, modes) [id] = { (classes), (digit), (precedence), (modes) },
+
+static const _keyInfo KEY_TABLE[KEY_TABLE_SIZE] = { KEYS(KEY_TABLE_ENTRY) };
+
+// Compile-time check of the keypad layouts: every button must be in KEYS
+// (an unknown button does not compile) and work in its keypad's mode.
+#define KEY_MODES_ENTRY(id, classes, digit, precedence, modes) KEY_MODES_OF_##id = (modes),
+
+enum {
+    KEYS(KEY_MODES_ENTRY)
+    KEY_MODES_OF_IDC_BUTTON_STA = KEY_MODES_OF_IDC_BUTTON_5  // STA shares the ID of 5
+};
+
+#define CHECK_STANDARD_BUTTON(id) \
+    _Static_assert(KEY_MODES_OF_##id & (1u << STANDARD_MODE), #id " does not work in standard mode");
+#define CHECK_SCIENTIFIC_BUTTON(id) \
+    _Static_assert(KEY_MODES_OF_##id & (1u << SCIENTIFIC_MODE), #id " does not work in scientific mode");
+
+STANDARD_KEYPAD(CHECK_STANDARD_BUTTON)
+SCIENTIFIC_KEYPAD(CHECK_SCIENTIFIC_BUTTON)
 
-#ifndef LONGLONG_MAX
-#define LONGLONG_MAX 0x7FFFFFFFFFFFFFFFLL
-#endif
+/*
+ * hasKeyClass
+ *
+ * True if key has one of the classes in the engine's current mode.
+ */
+static bool hasKeyClass(const _calcEngine* engine, uint32_t keyCode, unsigned classes)
+{
+    const _keyInfo* info = getKeyInfo(keyCode);
+    return (info->classes & classes) != 0 && (info->modes & (1u << engine->mode)) != 0;
+}
 
 /*
  * appendDigit
@@ -47,86 +169,105 @@ extern _calculatorState calcState;
  * - Octal: '0' through '7'
  * - Binary: '0' and '1'
  *
- * The function handles leading zeros, maximum digit limits for each base,
- * and placement of the decimal separator for floating-point numbers.
+ * The function handles leading zeros, maximum digit limits for each base
+ * (in bases 2, 8 and 16 those of the word size), and placement of the
+ * decimal separator for floating-point numbers.
  *
- * @param accumulatedValue Pointer to the byte array representing the calculator's internal state
+ * @param engine        The calculator session whose accumulatedValue receives the digit
  * @param digit         The digit to be appended (0-15, depending on the current base)
- * @return              1 if the digit was successfully appended, 0 otherwise
+ * @return              true if the digit was successfully appended, false otherwise
  */
-
-
-BOOL appendDigit(char* accumulatedValue, int digit)
+bool appendDigit(_calcEngine* engine, int digit)
 {
-    int integerDigits = strlen(accumulatedValue);
+    char* accumulatedValue = engine->accumulatedValue;
+    int length = (int)strlen(accumulatedValue);
+    int integerDigits = length - (accumulatedValue[0] == '-');
     char digitChar;
 
     // Handle digits 0-9 and A-F for hexadecimal
-    if (digit < 10) {
+    if (digit < 0) {
+        return false;
+    }
+    else if (digit < 10) {
         digitChar = digit + '0';
     }
     else if (digit < 16) {
         digitChar = digit - 10 + 'A';
     }
     else {
-        return FALSE;  // Invalid digit for any supported base
+        return false;  // Invalid digit for any supported base
     }
 
     // Check if the digit is valid for the current base
-    if (digit >= calcState.numberBase) {
-        return FALSE;
+    if (digit >= engine->numberBase) {
+        return false;
     }
 
-    if (!hasDecimalSeparator(accumulatedValue)) {
+    if (!hasDecimalSeparator(engine, accumulatedValue)) {
         // Integer part
         if (digit == 0 && integerDigits == 0) {
-            return TRUE;  // Ignore leading zeros
+            return true;  // Ignore leading zeros
         }
 
-        switch (calcState.numberBase) {
+        switch (engine->numberBase) {
         case 2:  // Binary
-            if (integerDigits >= MAX_BINARY_DIGITS) return FALSE;
-            break;
         case 8:  // Octal
-            if (integerDigits >= MAX_OCTAL_DIGITS) return FALSE;
+        case 16: // Hexadecimal
+            if (integerDigits >= fixedIntDigitCount(engine->wordBits, engine->numberBase)) return false;
             break;
         case 10: // Decimal
-            if (integerDigits >= MAX_DECIMAL_DIGITS) return FALSE;
-            break;
-        case 16: // Hexadecimal
-            if (integerDigits >= MAX_HEXADECIMAL_DIGITS) return FALSE;
+            if (integerDigits >= MAX_DECIMAL_DIGITS) return false;
             break;
         default:
-            return FALSE; // Invalid base
-        }
-
-        accumulatedValue[integerDigits] = digitChar;
-        accumulatedValue[integerDigits + 1] = '\0';
-
-        if (hasDecimalSeparator(accumulatedValue)) {
-            accumulatedValue[integerDigits + 1] = calcState.decimalSeparator;
-            accumulatedValue[integerDigits + 2] = '\0';
+            return false; // Invalid base
         }
     }
     else {
         // Decimal part (only for base 10)
-        if (calcState.numberBase != 10) {
-            return FALSE;
+        if (engine->numberBase != 10) {
+            return false;
         }
-        int decimalDigits = calcState.currentValueHighPart;
-        if (decimalDigits >= MAX_DECIMAL_DIGITS) {
-            return FALSE;
+        if (engine->currentValueHighPart >= MAX_DECIMAL_DIGITS) {
+            return false;
         }
-        calcState.currentValueHighPart = decimalDigits * 10 + digit;
+        engine->currentValueHighPart++;
+    }
 
-        // Shift existing decimal digits
-        int insertPos = integerDigits + decimalDigits + 1;
-        memmove(&accumulatedValue[insertPos + 1], &accumulatedValue[insertPos], strlen(&accumulatedValue[insertPos]) + 1);
-        accumulatedValue[insertPos] = digitChar;
+    if (length + 1 >= MAX_DISPLAY_DIGITS) {
+        return false;
     }
+    accumulatedValue[length] = digitChar;
+    accumulatedValue[length + 1] = '\0';
+    return true;
+}
 
-    DecimalToFloat(&calcState);
-    return TRUE;
+/*
+ * appendDecimalSeparator
+ *
+ * Appends the decimal separator to the value being entered. An empty entry
+ * becomes "0." so the display never starts with a bare separator. Only
+ * decimal entries can have a fractional part.
+ *
+ * @param engine   The calculator session
+ * @return         true if the separator was appended, false otherwise
+ */
+bool appendDecimalSeparator(_calcEngine* engine)
+{
+    char* accumulatedValue = engine->accumulatedValue;
+    size_t length = strlen(accumulatedValue);
+
+    if (engine->numberBase != 10 || hasDecimalSeparator(engine, accumulatedValue)) {
+        return false;
+    }
+    if (length + 3 > MAX_DISPLAY_DIGITS) {
+        return false;
+    }
+    if (length == 0 || (length == 1 && accumulatedValue[0] == '-')) {
+        accumulatedValue[length++] = '0';
+    }
+    accumulatedValue[length] = engine->decimalSeparator;
+    accumulatedValue[length + 1] = '\0';
+    return true;
 }
 
 /*
@@ -136,10 +277,6 @@ BOOL appendDigit(char* accumulatedValue, int digit)
  * to its corresponding digit value. It supports digits 0-9 for decimal
  * input and A-F for hexadecimal input.
  *
- * The function uses a switch statement to map each key code (assumed
- * to be predefined constants like IDC_BUTTON_0, IDC_BUTTON_1, etc.)
- * to its corresponding integer value.
- *
  * For decimal digits (0-9), the function returns the digit's value.
  * For hexadecimal digits (A-F), it returns values 10-15 respectively.
  *
@@ -149,319 +286,166 @@ BOOL appendDigit(char* accumulatedValue, int digit)
  * @param keyCode   The key code of the pressed calculator button
  * @return          The corresponding digit value (0-15) or -1 for invalid input
  */
-int convertKeyToDigit(DWORD keyCode)
+int convertKeyToDigit(uint32_t keyCode)
 {
-    switch (keyCode)
-    {
-        case IDC_BUTTON_0:
-            return 0;
-        case IDC_BUTTON_1:
-            return 1;
-        case IDC_BUTTON_2:
-            return 2;
-        case IDC_BUTTON_3:
-            return 3;
-        case IDC_BUTTON_4:
-            return 4;
-        case IDC_BUTTON_5:
-            return 5;
-        case IDC_BUTTON_6:
-            return 6;
-        case IDC_BUTTON_7:
-            return 7;
-        case IDC_BUTTON_8:
-            return 8;
-        case IDC_BUTTON_9:
-            return 9;
-        case IDC_BUTTON_A:
-            return 10;
-        case IDC_BUTTON_B:
-            return 11;
-        case IDC_BUTTON_C:
-            return 12;
-        case IDC_BUTTON_D:
-            return 13;
-        case IDC_BUTTON_E:
-            return 14;
-        case IDC_BUTTON_F:
-            return 15;
-        default:
-            return -1; // Invalid key
+    const _keyInfo* info = getKeyInfo(keyCode);
+    return (info->classes & KEY_CLASS_DIGIT) ? info->digit : -1;
+}
+
+/*
+ * getKeyInfo
+ *
+ * Returns the KEY_TABLE entry of a key ID. IDs beyond the table get the
+ * all-zero entry of ID 0, which is no key.
+ */
+const _keyInfo* getKeyInfo(uint32_t keyCode)
+{
+    return &KEY_TABLE[(keyCode < KEY_TABLE_SIZE) ? keyCode : 0];
+}
+
+/*
+ * hasDecimalSeparator
+ *
+ * Returns true if the string contains the engine's decimal separator.
+ */
+bool hasDecimalSeparator(const _calcEngine* engine, const char* str) {
+    if (str == NULL) {
+        return false;
     }
+
+    while (*str != '\0') {
+        if (*str == engine->decimalSeparator) {
+            return true;
+        }
+        str++;
+    }
+
+    return false;
 }
 
 /*
- * isClearKey(DWORD keyPressed)
+ * isClearKey(uint32_t keyPressed)
  *
  * This function determines whether the pressed key is a clear key (CE or C).
  * It is used to identify when the user wants to clear the current entry or reset
  * the entire calculator state.
  *
  * @param keyPressed The ID of the button that was pressed
- * @return BOOL TRUE if the pressed key is a clear key, FALSE otherwise
+ * @return bool true if the pressed key is a clear key, false otherwise
  */
-BOOL isClearKey(DWORD keyPressed)
+bool isClearKey(uint32_t keyPressed)
 {
-    return (keyPressed == IDC_BUTTON_CE || keyPressed == IDC_BUTTON_C);
+    return (getKeyInfo(keyPressed)->classes & KEY_CLASS_CLEAR) != 0;
 }
 
 /*
- * isNumericInput(DWORD keyPressed)
+ * isNumericInput(const _calcEngine* engine, uint32_t keyPressed)
  *
  * This function determines whether the pressed key represents a numeric input.
  * It is used to identify when the user is entering numbers into the calculator.
+ * The digits 0-9 are numeric in every mode, the hexadecimal digits A-F only
+ * in scientific mode.
  *
- * The function performs the following tasks:
- * 1. Checks if the keyPressed value is within the range of numeric button IDs (0-9)
- * 2. Checks if the keyPressed value is a hexadecimal digit (A-F) for scientific mode
- * 3. Returns TRUE if the key is a valid numeric input, FALSE otherwise
- *
+ * @param engine     The calculator session
  * @param keyPressed The ID of the button that was pressed
- * @return BOOL TRUE if the pressed key is a numeric input, FALSE otherwise
+ * @return bool true if the pressed key is a numeric input, false otherwise
  */
-BOOL isNumericInput(DWORD keyPressed)
+bool isNumericInput(const _calcEngine* engine, uint32_t keyPressed)
 {
-    // Check for digits 0-9
-    if (keyPressed >= IDC_BUTTON_0 && keyPressed <= IDC_BUTTON_9) {
-        return TRUE;
-    }
-    
-    // Check for hexadecimal digits A-F (only in scientific mode)
-    if (calcState.mode == SCIENTIFIC_MODE && 
-        keyPressed >= IDC_BUTTON_A && keyPressed <= IDC_BUTTON_F) {
-        return TRUE;
-    }
-    
-    return FALSE;
+    return hasKeyClass(engine, keyPressed, KEY_CLASS_DIGIT);
 }
 
 /*
- * isOperatorKey(DWORD keyPressed)
+ * isOperatorKey(const _calcEngine* engine, uint32_t keyPressed)
  *
  * This function determines whether the pressed key represents an arithmetic operator.
  * It is used to identify when the user is entering an arithmetic operation.
  *
- * The function performs the following tasks:
- * 1. Checks if the keyPressed value matches any of the basic arithmetic operator button IDs
- * 2. Checks for additional operators in scientific mode
- * 3. Returns TRUE if the key is an operator, FALSE otherwise
+ * Operators are the binary operators, the unary operators and '='. Those of
+ * the scientific keypad (sin, x^y, mod, the bitwise operators, ...) only
+ * count in scientific mode.
  *
+ * @param engine     The calculator session
  * @param keyPressed The ID of the button that was pressed
- * @return BOOL TRUE if the pressed key is an operator, FALSE otherwise
+ * @return bool true if the pressed key is an operator, false otherwise
  */
-BOOL isOperatorKey(DWORD keyPressed)
+bool isOperatorKey(const _calcEngine* engine, uint32_t keyPressed)
 {
-    // Check for basic arithmetic operators
-    switch (keyPressed)
-    {
-        case IDC_BUTTON_DIV:  // 0x8A
-        case IDC_BUTTON_MUL:  // 0x8E
-        case IDC_BUTTON_SUB:  // 0x92
-        case IDC_BUTTON_ADD:  // 0x96
-        case IDC_BUTTON_EQ:  // 0x97
-            return TRUE;
-    }
-
-    // Check for additional operators
-    switch (keyPressed)
-    {
-        case IDC_BUTTON_SQRT: // 0x98
-        case IDC_BUTTON_PERC: // 0x99
-        case IDC_BUTTON_INV:  // 0x9A
-            return TRUE;
-
-        // Operators available only in scientific mode
-        case IDC_BUTTON_SIN:  // 0x9C
-        case IDC_BUTTON_COS:  // 0x9D
-        case IDC_BUTTON_TAN:  // 0x9E
-        case IDC_BUTTON_ASIN: // 0x9F
-        case IDC_BUTTON_ACOS: // 0xA0
-        case IDC_BUTTON_ATAN: // 0xA1
-        case IDC_BUTTON_LOG:  // 0xA2
-        case IDC_BUTTON_LN:   // 0xA3
-        case IDC_BUTTON_EXP:  // 0xA4
-        case IDC_BUTTON_XY:   // 0xA5
-        case IDC_BUTTON_SQR:  // 0xA9
-        case IDC_BUTTON_CUBE: // 0xAA
-        case IDC_BUTTON_FACT: // 0xAB
-        case IDC_BUTTON_MOD:  // 0xAD
-            return (calcState.mode == SCIENTIFIC_MODE);
-
-        // Bitwise operators (assuming they're only in scientific mode)
-        case IDC_BUTTON_AND:  // 0xB8
-        case IDC_BUTTON_OR:   // 0xB9
-        case IDC_BUTTON_XOR:  // 0xBA
-        case IDC_BUTTON_NOT:  // 0xBB
-        case IDC_BUTTON_LSH:  // 0xBC
-            return (calcState.mode == SCIENTIFIC_MODE);
-
-        default:
-            return FALSE;
-    }
+    return hasKeyClass(engine, keyPressed, KEY_CLASS_BINARY | KEY_CLASS_UNARY | KEY_CLASS_EQUALS);
 }
 
-BOOL isValueOverflow(int digit) {
-    switch (calcState.mode) {
-        case STANDARD_MODE:
-            // 32-bit integer overflow check
-            if (calcState.accumulatedValue > (LONG_MAX - digit) / (LONG)calcState.numberBase) {
-                return true;
-            }
-            break;
-
-        case SCIENTIFIC_MODE:
-            // 64-bit integer overflow check 
-            if (calcState.accumulatedValue > (LONGLONG_MAX - digit) / (LONGLONG)calcState.numberBase) {
-                return true;
-            }
-
-            // Convert accumulatedValue string to a double for overflow check
-            double accumulatedDouble = strtod(calcState.accumulatedValue, NULL);
-
-            // Also check for floating-point overflow
-            if (!isfinite(accumulatedDouble * calcState.numberBase + digit)) { 
-                return true;
-            }
-            break;
-
-        case SCIENTIFIC_NOTATION:
-            // Convert the accumulated value (string) to ExtendedFloat80
-            stringToExtendedFloat80(calcState.accumulatedValue);
+/*
+ * isUnaryOperatorKey(uint32_t keyPressed)
+ *
+ * Returns true for operators that act on the displayed value alone (sqrt,
+ * 1/x, sin, n!, ...). They are applied as soon as they are pressed instead
+ * of waiting for a second operand.
+ *
+ * @param keyPressed The ID of the button that was pressed
+ * @return bool true if the key is a unary operator, false otherwise
+ */
+bool isUnaryOperatorKey(uint32_t keyPressed)
+{
+    return (getKeyInfo(keyPressed)->classes & KEY_CLASS_UNARY) != 0;
+}
 
-            // Check for overflow using the updated function 
-            if (isValueOverflowExtended()) {
-                return true;
-            }
-            break;
+/*
+ * isValueOverflow(_calcEngine* engine, int digit)
+ *
+ * Checks whether appending `digit` to the non-decimal value being entered
+ * would overflow the word size, the digits read as an unsigned number
+ * (a leading minus sign then takes the two's complement).
+ *
+ * @param engine  The calculator session
+ * @param digit   The digit about to be appended
+ * @return bool   true if the value would overflow, false otherwise
+ */
+bool isValueOverflow(_calcEngine* engine, int digit) {
+    const char* digits = engine->accumulatedValue + (engine->accumulatedValue[0] == '-');
+    _fixedInt value;
 
-        default:
-            // Unknown mode, assume overflow for safety
-            return true;
+    if (fixedIntFromString(&value, digits, engine->numberBase, engine->wordBits) != STATUS_SUCCESS) {
+        return true;
     }
-
-    return false;
+    return fixedIntMultiplyAdd(&value, (uint32_t)engine->numberBase, (uint32_t)digit);
 }
 
 /*
  * isPreviousKeyOperator()
  *
  * This function determines whether the previously pressed key was an operator
- * in the calculator application. It checks for various types of operator keys
- * and considers the current calculator mode.
- *
- * The function performs the following checks:
- * 1. Checks if the key is within the range of basic operator keys
- * 2. Checks for additional operator keys that are always considered operators
- * 3. In scientific mode, checks for scientific operator keys
- *
- * Operator keys include:
- * - Basic arithmetic operators (add, subtract, multiply, divide)
- * - Special operators like square root, percentage, and inverse
- * - In scientific mode: trigonometric functions, logarithms, etc.
+ * in the calculator application: a binary or unary operator that works in
+ * the current mode. '=' does not count.
  *
  * This function is crucial for proper input handling and determining how to
  * process subsequent key presses based on whether the previous key was an operator.
  *
- * @param state    Pointer to the current calculator state
- * @return         TRUE if the previous key was an operator, FALSE otherwise
+ * @param engine   Pointer to the current calculator state
+ * @return         true if the previous key was an operator, false otherwise
  */
-BOOL isPreviousKeyOperator()
+bool isPreviousKeyOperator(const _calcEngine* engine)
 {
-
-    // Define the range of operator key codes
-    const int MIN_OPERATOR_KEY = 0x56;  // Assuming 0x56 is the lowest operator key code
-    const int MAX_OPERATOR_KEY = 0x5F;  // Assuming 0x5F is the highest operator key code
-
-    // Check if the key is within the basic operator key range
- // Check if the previous key pressed falls within the operator range
-    if (calcState.keyPressed >= MIN_OPERATOR_KEY && calcState.keyPressed <= MAX_OPERATOR_KEY) {
-        return TRUE;
-    }
-
-    // Check for additional operators
-    switch (calcState.keyPressed)
-    {
-        case IDC_BUTTON_SQRT:
-        case IDC_BUTTON_PERC:
-        case IDC_BUTTON_INV:
-            return TRUE;
-
-        // Operators available only in scientific mode
-        case IDC_BUTTON_SIN:
-        case IDC_BUTTON_COS:
-        case IDC_BUTTON_TAN:
-        case IDC_BUTTON_ASIN:
-        case IDC_BUTTON_ACOS:
-        case IDC_BUTTON_ATAN:
-        case IDC_BUTTON_LOG:
-        case IDC_BUTTON_LN:
-        case IDC_BUTTON_EXP:
-        case IDC_BUTTON_AND:
-        case IDC_BUTTON_OR:
-        case IDC_BUTTON_XOR:
-        case IDC_BUTTON_NOT:
-        case IDC_BUTTON_LSH:
-            return (calcState.mode == SCIENTIFIC_MODE);
-
-        default:
-            return FALSE;
-    }
+    return hasKeyClass(engine, engine->keyPressed, KEY_CLASS_BINARY | KEY_CLASS_UNARY);
 }
 
 /*
  * isSpecialFunctionKey()
  *
  * This function determines whether a given key press represents a special function
- * in the calculator application. It checks for both standard special keys and
- * mode-specific special keys.
- *
- * The function performs the following checks:
- * 1. Checks if the key is within a predefined range of special function keys
- * 2. Checks for specific individual keys that are always considered special
- * 3. In scientific mode, checks for additional keys that become special functions
- *
- * Special keys include:
- * - Toggle scientific mode (0x54)
- * - Memory-related functions (0x6d, 0x70)
- * - Backspace or clear entry (0x53)
- * - A range of keys from 0x7d to 0x81
- * - In scientific mode, additional keys from 0x74 to 0x78
+ * in the calculator application: a key that changes neither the displayed
+ * value nor the pending operation, so it is not remembered as the previous
+ * key (engine->keyPressed).
  *
- * This function is crucial for proper input handling and determining when to
- * trigger special calculator functions instead of standard numeric input.
+ * Special keys are the Inv checkbox, MC and, in scientific mode, the buttons
+ * of the statistics window.
  *
+ * @param engine       The calculator session
  * @param keyPressed   The key code of the pressed key
  * @return             true if the key is a special function key, false otherwise
  */
-BOOL isSpecialFunctionKey(DWORD keyPressed) {
-    // Define special function key ranges and individual keys
-    const DWORD SPECIAL_KEY_START = 0x7d;
-    const DWORD SPECIAL_KEY_END = 0x81;
-
-    // Check if the key is within the special function key range
-    if (keyPressed >= SPECIAL_KEY_START && keyPressed <= SPECIAL_KEY_END) {
-        return true;
-    }
-
-    // Check for individual special function keys
-    switch (keyPressed) {
-    case 0x54:  // Likely the toggle scientific mode key
-    case 0x6d:  // Possibly memory-related function
-    case 0x70:  // Possibly another memory-related function
-    case 0x53:  // Possibly backspace or clear entry
-        return true;
-    }
-
-    // Check for keys that might be special based on current mode
-    if (calcState.mode == SCIENTIFIC_MODE) {
-        // Additional keys that are special in scientific mode
-        if (keyPressed >= 0x74 && keyPressed <= 0x78) {
-            return true;
-        }
-    }
-
-    // If none of the above conditions are met, it's not a special function key
-    return false;
+bool isSpecialFunctionKey(const _calcEngine* engine, uint32_t keyPressed)
+{
+    return hasKeyClass(engine, keyPressed, KEY_CLASS_SPECIAL);
 }
 
 
@@ -470,40 +454,34 @@ BOOL isSpecialFunctionKey(DWORD keyPressed) {
  *
  * This function manages the calculator's input mode based on the key pressed.
  * It determines whether to activate or deactivate the input mode, which affects
- * how subsequent key presses are interpreted.
- * Key codes and their functions:
- * // 0x55: Decimal point
- * // 0x29: Right parenthesis or equals sign
- * // 0x56-0x73: Various operation keys
- * // 0x75-0x7c: Function keys
- * // 0x12d: Unknown function, possibly clear or cancel
+ * how subsequent key presses are interpreted. A digit or the decimal point
+ * starts the entry of a number; the operators, ')', the Exp key and the
+ * statistics buttons (KEY_CLASS_ENDS_INPUT) end it.
  *
  * Input mode activation allows the calculator to start a new calculation or continue
  * the current one, while deactivation typically occurs when an operation is completed
  * or a function is applied. This function works in conjunction with other mode-related
  * functions like toggleScientificMode and updateToggleButton to maintain the calculator's state.
  *
+ * @param engine       The calculator session
  * @param keyPressed   The key code of the pressed key
- * @return             TRUE if the input mode was changed, FALSE otherwise
+ * @return             true if the input mode was changed, false otherwise
  */
-BOOL updateInputMode(DWORD keyPressed) {
-    if (!calcState.isInputModeActive) {
+bool updateInputMode(_calcEngine* engine, uint32_t keyPressed) {
+    if (!engine->isInputModeActive) {
         // Check if the key is a valid input to activate input mode
-        if (isNumericInput(keyPressed) || keyPressed == 0x55) {
-            calcState.isInputModeActive = TRUE;
-            InitcalcState(&calcState);
-            return TRUE;
+        if (isNumericInput(engine, keyPressed) || keyPressed == IDC_BUTTON_DOT) {
+            engine->isInputModeActive = true;
+            clearEngineEntry(engine);
+            return true;
         }
     }
     else {
         // Check if the key should deactivate input mode
-        if (isOperatorKey(keyPressed) || keyPressed == 0x29 ||
-            (keyPressed >= 0x56 && keyPressed < 0x74) ||
-            (keyPressed > 0x74 && keyPressed < 0x7d) ||
-            keyPressed == 0x12d) {
-            calcState.isInputModeActive = FALSE;
-            return TRUE;
+        if (hasKeyClass(engine, keyPressed, KEY_CLASS_ENDS_INPUT)) {
+            engine->isInputModeActive = false;
+            return true;
         }
     }
-    return FALSE;
+    return false;
 }
\ No newline at end of file
@@ -0,0 +1,693 @@
+/*-----------------------------------------------------------------------------
+    jit.c --  Native code generator for compiled expressions
+              (reconstructed code).
+
+               Translates the stack machine instructions of an _expression
+               into x86-64 SSE2 code for the System V calling convention.
+               The top of the evaluation stack lives in xmm0 and the values
+               below it (then the temporaries of an optimized expression)
+               in a frame on the native stack, which keeps every
+               operator to a few instructions and makes xmm0 the argument
+               and result register of the libm calls used for pow, fmod,
+               sin, cos, tan, exp, log10 and log. Domain checks jump to
+               small stubs that return the same STATUS_* codes as the
+               interpreter.
+
+               The code is assembled into an ordinary heap buffer first,
+               then copied to pages from mmap that are made executable
+               and read-only before use, so no page is ever writable and
+               executable at once.
+
+               The instructions translated are the keypad's arithmetic,
+               power, root, reciprocal, trigonometric, logarithmic, modulo
+               and bitwise operators. asin, acos, atan, fact and int are
+               left to the interpreter.
+
+               Key functions include:
+
+               - jitCompile: _expression to native code.
+               - jitEvaluate / jitEvaluateBatch: Run the native code, or
+                                          the interpreter if there is none.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS under a strict -std=c11
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//jit.h"
+
+#if JIT_AVAILABLE
+#include <sys/mman.h>
+#include <unistd.h>
+
+// General purpose registers, numbered as in the instruction encoding
+#define REGISTER_RAX 0
+#define REGISTER_RCX 1
+#define REGISTER_RBX 3
+#define REGISTER_RSP 4
+#define REGISTER_R12 12
+#define REGISTER_R13 13
+
+#define REGISTER_XMM0 0
+#define REGISTER_XMM1 1
+#define REGISTER_XMM2 2
+
+// Register holding each argument of the generated function
+#define REGISTER_VARIABLES REGISTER_RBX
+#define REGISTER_CONSTANTS REGISTER_R12
+#define REGISTER_RESULT    REGISTER_R13
+
+// Mandatory prefixes and opcodes (after 0F) of the SSE2 instructions used
+#define SSE_SCALAR_DOUBLE 0xF2   // movsd, addsd, cvttsd2si, ...
+#define SSE_PACKED_DOUBLE 0x66   // movapd, xorpd, ucomisd, movq
+#define SSE_CONVERT_FROM_INTEGER 0x2A
+#define SSE_CONVERT_TRUNCATE     0x2C
+#define SSE_COMPARE_UNORDERED    0x2E
+#define SSE_LOAD                 0x10
+#define SSE_STORE                0x11
+#define SSE_MOVE_REGISTER        0x28
+#define SSE_SQRT                 0x51
+#define SSE_ADD                  0x58
+#define SSE_MUL                  0x59
+#define SSE_SUB                  0x5C
+#define SSE_DIV                  0x5E
+#define SSE_XOR                  0x57
+#define SSE_MOVE_TO_XMM          0x6E
+#define SSE_MOVE_FROM_XMM        0x7E
+
+// Condition codes of jcc after ucomisd
+#define CONDITION_ABOVE          0x7
+#define CONDITION_ABOVE_OR_EQUAL 0x3
+#define CONDITION_EQUAL          0x4
+#define CONDITION_PARITY         0xA
+
+#define SIGN_BIT_PATTERN     0x8000000000000000ull
+#define INFINITY_PATTERN     0x7FF0000000000000ull
+#define JIT_ERROR_STATUSES   4  // Statuses that have an error stub
+
+static const int ERROR_STATUSES[JIT_ERROR_STATUSES] = {
+    STATUS_DIVISION_BY_ZERO, STATUS_INVALID_INPUT, STATUS_OVERFLOW, STATUS_UNDEFINED_RESULT
+};
+
+// A jump to an error stub whose displacement is filled in at the end
+typedef struct {
+    size_t offset;     // Offset of the 32-bit displacement
+    int stub;          // Index into ERROR_STATUSES
+} _jitFixup;
+
+typedef struct {
+    uint8_t* bytes;
+    size_t length;
+    size_t capacity;
+    _jitFixup* fixups;
+    int fixupCount;
+    int fixupCapacity;
+    int depth;         // Values on the evaluation stack; the top one is in xmm0
+    int temporaryBase; // Frame slot of the first temporary (after the stack)
+    size_t exitOffset; // Start of the epilogue, where the error stubs jump to
+    int status;        // STATUS_INSUFFICIENT_MEMORY once an allocation failed
+} _assembler;
+
+static void emitByte(_assembler* assembler, uint8_t byte)
+{
+    if (assembler->length == assembler->capacity) {
+        size_t capacity = (assembler->capacity < 256) ? 256 : assembler->capacity * 2;
+        uint8_t* bytes = realloc(assembler->bytes, capacity);
+        if (bytes == NULL) {
+            assembler->status = STATUS_INSUFFICIENT_MEMORY;
+            return;
+        }
+        assembler->bytes = bytes;
+        assembler->capacity = capacity;
+    }
+    assembler->bytes[assembler->length++] = byte;
+}
+
+static void emitBytes(_assembler* assembler, const uint8_t* bytes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        emitByte(assembler, bytes[i]);
+    }
+}
+
+static void emit32(_assembler* assembler, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        emitByte(assembler, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void emit64(_assembler* assembler, uint64_t value)
+{
+    emit32(assembler, (uint32_t)value);
+    emit32(assembler, (uint32_t)(value >> 32));
+}
+
+/*
+ * emitSseMemory
+ *
+ * An SSE2 instruction with a [base + displacement] operand. reg is an
+ * xmm register, or a general purpose one for cvttsd2si; only registers
+ * 0-7 are used there.
+ */
+static void emitSseMemory(_assembler* assembler, uint8_t prefix, bool isWide, uint8_t opcode, int reg, int base,
+    int32_t displacement)
+{
+    emitByte(assembler, prefix);
+    if (isWide || base >= 8) {
+        emitByte(assembler, (uint8_t)(0x40 | (isWide ? 0x08 : 0) | (base >= 8 ? 0x01 : 0)));  // REX
+    }
+    emitByte(assembler, 0x0F);
+    emitByte(assembler, opcode);
+    emitByte(assembler, (uint8_t)(0x80 | (reg << 3) | (base & 7)));  // ModRM: [base + disp32]
+    if ((base & 7) == REGISTER_RSP) {
+        emitByte(assembler, 0x24);  // SIB: rsp and r12 can only be a base through it
+    }
+    emit32(assembler, (uint32_t)displacement);
+}
+
+/*
+ * emitSseRegister
+ *
+ * An SSE2 instruction between two registers numbered 0-7.
+ */
+static void emitSseRegister(_assembler* assembler, uint8_t prefix, bool isWide, uint8_t opcode, int reg, int rm)
+{
+    emitByte(assembler, prefix);
+    if (isWide) {
+        emitByte(assembler, 0x48);  // REX.W
+    }
+    emitByte(assembler, 0x0F);
+    emitByte(assembler, opcode);
+    emitByte(assembler, (uint8_t)(0xC0 | (reg << 3) | rm));
+}
+
+/*
+ * emitLoadConstantBits
+ *
+ * xmm = the double with the given bit pattern, through rax.
+ */
+static void emitLoadConstantBits(_assembler* assembler, int xmm, uint64_t bits)
+{
+    if (bits == 0) {
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_XOR, xmm, xmm);
+        return;
+    }
+    emitByte(assembler, 0x48);  // mov rax, imm64
+    emitByte(assembler, 0xB8);
+    emit64(assembler, bits);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, true, SSE_MOVE_TO_XMM, xmm, REGISTER_RAX);
+}
+
+static void emitLoadConstant(_assembler* assembler, int xmm, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    emitLoadConstantBits(assembler, xmm, bits);
+}
+
+/*
+ * emitErrorJump
+ *
+ * jcc to the stub returning ERROR_STATUSES[stub].
+ */
+static void emitErrorJump(_assembler* assembler, int condition, int stub)
+{
+    if (assembler->fixupCount == assembler->fixupCapacity) {
+        int capacity = (assembler->fixupCapacity < 16) ? 16 : assembler->fixupCapacity * 2;
+        _jitFixup* fixups = realloc(assembler->fixups, (size_t)capacity * sizeof(_jitFixup));
+        if (fixups == NULL) {
+            assembler->status = STATUS_INSUFFICIENT_MEMORY;
+            return;
+        }
+        assembler->fixups = fixups;
+        assembler->fixupCapacity = capacity;
+    }
+    emitByte(assembler, 0x0F);
+    emitByte(assembler, (uint8_t)(0x80 | condition));
+    assembler->fixups[assembler->fixupCount].offset = assembler->length;
+    assembler->fixups[assembler->fixupCount].stub = stub;
+    assembler->fixupCount++;
+    emit32(assembler, 0);
+}
+
+/*
+ * emitCall
+ *
+ * Calls a libm function; its arguments are already in xmm0 (and xmm1).
+ * The frame keeps rsp 16-byte aligned, as the ABI requires.
+ */
+static void emitCall(_assembler* assembler, uint64_t address)
+{
+    emitByte(assembler, 0x48);  // mov rax, imm64
+    emitByte(assembler, 0xB8);
+    emit64(assembler, address);
+    emitByte(assembler, 0xFF);  // call rax
+    emitByte(assembler, 0xD0);
+}
+
+static uint64_t getUnaryAddress(double (*function)(double))
+{
+    return (uint64_t)(uintptr_t)function;
+}
+
+static uint64_t getBinaryAddress(double (*function)(double, double))
+{
+    return (uint64_t)(uintptr_t)function;
+}
+
+// Displacement of the stack slot holding the value at the given depth
+static int32_t getSlot(int index)
+{
+    return (int32_t)(8 * index);
+}
+
+/*
+ * emitZeroCheck
+ *
+ * Fails with STATUS_DIVISION_BY_ZERO when xmm0 is 0 (but not NaN).
+ */
+static void emitZeroCheck(_assembler* assembler)
+{
+    emitLoadConstantBits(assembler, REGISTER_XMM1, 0);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_COMPARE_UNORDERED, REGISTER_XMM0, REGISTER_XMM1);
+    emitByte(assembler, 0x70 | CONDITION_PARITY);  // jp over the 6-byte je below
+    emitByte(assembler, 6);
+    emitErrorJump(assembler, CONDITION_EQUAL, 0);
+}
+
+/*
+ * emitDomainCheck
+ *
+ * Fails with STATUS_INVALID_INPUT when xmm0 < 0, or xmm0 <= 0 if
+ * isZeroInvalid. NaN passes, as in the interpreter.
+ */
+static void emitDomainCheck(_assembler* assembler, bool isZeroInvalid)
+{
+    emitLoadConstantBits(assembler, REGISTER_XMM1, 0);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_COMPARE_UNORDERED, REGISTER_XMM1, REGISTER_XMM0);
+    emitErrorJump(assembler, isZeroInvalid ? CONDITION_ABOVE_OR_EQUAL : CONDITION_ABOVE, 1);
+}
+
+/*
+ * emitSwapIntoArguments
+ *
+ * Moves the operands of a binary libm call into place: xmm0 = the left
+ * operand from its slot, xmm1 = the right operand from xmm0.
+ */
+static void emitSwapIntoArguments(_assembler* assembler, int32_t leftSlot)
+{
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_MOVE_REGISTER, REGISTER_XMM1, REGISTER_XMM0);
+    emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_LOAD, REGISTER_XMM0, REGISTER_RSP, leftSlot);
+}
+
+/*
+ * emitReversedOperation
+ *
+ * xmm0 = left (from its slot) op xmm0, for subsd and divsd.
+ */
+static void emitReversedOperation(_assembler* assembler, uint8_t opcode, int32_t leftSlot)
+{
+    emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_LOAD, REGISTER_XMM1, REGISTER_RSP, leftSlot);
+    emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, opcode, REGISTER_XMM1, REGISTER_XMM0);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_MOVE_REGISTER, REGISTER_XMM0, REGISTER_XMM1);
+}
+
+/*
+ * emitInt64Check
+ *
+ * Fails with STATUS_INVALID_INPUT unless -2^63 <= xmm < 2^63, NaN
+ * failing too, as isInt64Range does in the interpreter. cvttsd2si would
+ * turn anything else into INT64_MIN and go on. Uses xmm2.
+ */
+static void emitInt64Check(_assembler* assembler, int xmm)
+{
+    emitLoadConstant(assembler, REGISTER_XMM2, 0x1p63);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_COMPARE_UNORDERED, xmm, REGISTER_XMM2);
+    emitErrorJump(assembler, CONDITION_PARITY, 1);
+    emitErrorJump(assembler, CONDITION_ABOVE_OR_EQUAL, 1);
+    emitLoadConstant(assembler, REGISTER_XMM2, -0x1p63);
+    emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_COMPARE_UNORDERED, REGISTER_XMM2, xmm);
+    emitErrorJump(assembler, CONDITION_ABOVE, 1);
+}
+
+/*
+ * emitBitwise
+ *
+ * xmm0 = (double)((int64_t)left op (int64_t)xmm0); operation is the
+ * opcode byte of "op rax, rcx".
+ */
+static void emitBitwise(_assembler* assembler, const uint8_t* operation, size_t operationLength, int32_t leftSlot)
+{
+    emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_LOAD, REGISTER_XMM1, REGISTER_RSP, leftSlot);
+    emitInt64Check(assembler, REGISTER_XMM1);
+    emitInt64Check(assembler, REGISTER_XMM0);
+    emitSseRegister(assembler, SSE_SCALAR_DOUBLE, true, SSE_CONVERT_TRUNCATE, REGISTER_RCX, REGISTER_XMM0);
+    emitSseRegister(assembler, SSE_SCALAR_DOUBLE, true, SSE_CONVERT_TRUNCATE, REGISTER_RAX, REGISTER_XMM1);
+    emitBytes(assembler, operation, operationLength);
+    emitSseRegister(assembler, SSE_SCALAR_DOUBLE, true, SSE_CONVERT_FROM_INTEGER, REGISTER_XMM0, REGISTER_RAX);
+}
+
+/*
+ * emitInstruction
+ *
+ * Translates one stack machine instruction.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_UNDEFINED_RESULT for an instruction
+ *          that is left to the interpreter.
+ */
+static int emitInstruction(_assembler* assembler, uint32_t instruction, int32_t frameSize)
+{
+    static const uint8_t andRaxRcx[] = { 0x48, 0x21, 0xC8 };
+    static const uint8_t orRaxRcx[] = { 0x48, 0x09, 0xC8 };
+    static const uint8_t xorRaxRcx[] = { 0x48, 0x31, 0xC8 };
+    static const uint8_t shlRaxCl[] = { 0x48, 0xD3, 0xE0 };
+    static const uint8_t notRax[] = { 0x48, 0xF7, 0xD0 };
+    _expressionOpcode opcode = EXPRESSION_OPCODE(instruction);
+    int32_t operand = (int32_t)EXPRESSION_OPERAND(instruction);
+    int32_t leftSlot = getSlot(assembler->depth - 2);
+
+    switch (opcode) {
+    case EXPRESSION_OP_CONSTANT:
+    case EXPRESSION_OP_VARIABLE:
+    case EXPRESSION_OP_LOAD:
+        if (assembler->depth > 0) {
+            emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_STORE, REGISTER_XMM0, REGISTER_RSP,
+                getSlot(assembler->depth - 1));
+        }
+        if (opcode == EXPRESSION_OP_LOAD) {
+            emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_LOAD, REGISTER_XMM0, REGISTER_RSP,
+                getSlot(assembler->temporaryBase + operand));
+        }
+        else {
+            emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_LOAD, REGISTER_XMM0,
+                (opcode == EXPRESSION_OP_CONSTANT) ? REGISTER_CONSTANTS : REGISTER_VARIABLES, 8 * operand);
+        }
+        assembler->depth++;
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_STORE:
+        emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_STORE, REGISTER_XMM0, REGISTER_RSP,
+            getSlot(assembler->temporaryBase + operand));
+        return STATUS_SUCCESS;
+
+    case EXPRESSION_OP_ADD:
+        emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_ADD, REGISTER_XMM0, REGISTER_RSP, leftSlot);
+        break;
+    case EXPRESSION_OP_MUL:
+        emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_MUL, REGISTER_XMM0, REGISTER_RSP, leftSlot);
+        break;
+    case EXPRESSION_OP_SUB:
+        emitReversedOperation(assembler, SSE_SUB, leftSlot);
+        break;
+    case EXPRESSION_OP_DIV:
+        emitZeroCheck(assembler);
+        emitReversedOperation(assembler, SSE_DIV, leftSlot);
+        break;
+    case EXPRESSION_OP_MOD:
+        emitZeroCheck(assembler);
+        emitSwapIntoArguments(assembler, leftSlot);
+        emitCall(assembler, getBinaryAddress(fmod));
+        break;
+    case EXPRESSION_OP_POW:
+        emitSwapIntoArguments(assembler, leftSlot);
+        emitCall(assembler, getBinaryAddress(pow));
+        break;
+    case EXPRESSION_OP_AND:
+        emitBitwise(assembler, andRaxRcx, sizeof(andRaxRcx), leftSlot);
+        break;
+    case EXPRESSION_OP_OR:
+        emitBitwise(assembler, orRaxRcx, sizeof(orRaxRcx), leftSlot);
+        break;
+    case EXPRESSION_OP_XOR:
+        emitBitwise(assembler, xorRaxRcx, sizeof(xorRaxRcx), leftSlot);
+        break;
+    case EXPRESSION_OP_LSH:
+        // Shift counts outside [0, 64), and NaN, are invalid
+        emitDomainCheck(assembler, false);
+        emitLoadConstant(assembler, REGISTER_XMM1, 64.0);
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_COMPARE_UNORDERED, REGISTER_XMM0, REGISTER_XMM1);
+        emitErrorJump(assembler, CONDITION_PARITY, 1);
+        emitErrorJump(assembler, CONDITION_ABOVE_OR_EQUAL, 1);
+        emitBitwise(assembler, shlRaxCl, sizeof(shlRaxCl), leftSlot);
+        break;
+
+    case EXPRESSION_OP_NEG:
+        emitLoadConstantBits(assembler, REGISTER_XMM1, SIGN_BIT_PATTERN);
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_XOR, REGISTER_XMM0, REGISTER_XMM1);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_NOT:
+        emitInt64Check(assembler, REGISTER_XMM0);
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, true, SSE_CONVERT_TRUNCATE, REGISTER_RAX, REGISTER_XMM0);
+        emitBytes(assembler, notRax, sizeof(notRax));
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, true, SSE_CONVERT_FROM_INTEGER, REGISTER_XMM0, REGISTER_RAX);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_SQRT:
+        emitDomainCheck(assembler, false);
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, SSE_SQRT, REGISTER_XMM0, REGISTER_XMM0);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_SQR:
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, SSE_MUL, REGISTER_XMM0, REGISTER_XMM0);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_CUBE:
+        // (x * x) * x, in the interpreter's order
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_MOVE_REGISTER, REGISTER_XMM1, REGISTER_XMM0);
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, SSE_MUL, REGISTER_XMM0, REGISTER_XMM0);
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, SSE_MUL, REGISTER_XMM0, REGISTER_XMM1);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_INV:
+        emitZeroCheck(assembler);
+        emitLoadConstant(assembler, REGISTER_XMM1, 1.0);
+        emitSseRegister(assembler, SSE_SCALAR_DOUBLE, false, SSE_DIV, REGISTER_XMM1, REGISTER_XMM0);
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, false, SSE_MOVE_REGISTER, REGISTER_XMM0, REGISTER_XMM1);
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_SIN:
+        emitCall(assembler, getUnaryAddress(sin));
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_COS:
+        emitCall(assembler, getUnaryAddress(cos));
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_TAN:
+        emitCall(assembler, getUnaryAddress(tan));
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_EXP:
+        emitCall(assembler, getUnaryAddress(exp));
+        return STATUS_SUCCESS;
+    case EXPRESSION_OP_LOG:
+    case EXPRESSION_OP_LN:
+        emitDomainCheck(assembler, true);
+        emitCall(assembler, getUnaryAddress((opcode == EXPRESSION_OP_LOG) ? log10 : log));
+        return STATUS_SUCCESS;
+
+    case EXPRESSION_OP_RETURN: {
+        // NaN and infinity are checked on the result only, as in the interpreter
+        static const uint8_t clearSignRax[] = { 0x48, 0x0F, 0xBA, 0xF0, 0x3F };  // btr rax, 63
+        static const uint8_t cmpRaxRcx[] = { 0x48, 0x39, 0xC8 };
+        static const uint8_t clearEax[] = { 0x31, 0xC0 };
+        static const uint8_t restoreRegisters[] = { 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3 };  // pop r13, r12, rbx; ret
+
+        emitSseRegister(assembler, SSE_PACKED_DOUBLE, true, SSE_MOVE_FROM_XMM, REGISTER_XMM0, REGISTER_RAX);
+        emitBytes(assembler, clearSignRax, sizeof(clearSignRax));
+        emitByte(assembler, 0x48);  // mov rcx, imm64
+        emitByte(assembler, 0xB9);
+        emit64(assembler, INFINITY_PATTERN);
+        emitBytes(assembler, cmpRaxRcx, sizeof(cmpRaxRcx));
+        emitErrorJump(assembler, CONDITION_EQUAL, 2);
+        emitErrorJump(assembler, CONDITION_ABOVE, 3);
+        emitSseMemory(assembler, SSE_SCALAR_DOUBLE, false, SSE_STORE, REGISTER_XMM0, REGISTER_RESULT, 0);
+        emitBytes(assembler, clearEax, sizeof(clearEax));
+        assembler->exitOffset = assembler->length;
+        emitByte(assembler, 0x48);  // add rsp, frameSize
+        emitByte(assembler, 0x81);
+        emitByte(assembler, 0xC4);
+        emit32(assembler, (uint32_t)frameSize);
+        emitBytes(assembler, restoreRegisters, sizeof(restoreRegisters));
+        return STATUS_SUCCESS;
+    }
+
+    default:
+        return STATUS_UNDEFINED_RESULT;
+    }
+
+    assembler->depth--;  // Binary operators
+    return STATUS_SUCCESS;
+}
+
+/*
+ * assembleExpression
+ *
+ * Produces the machine code of the whole function in assembler->bytes:
+ * prologue, one translation per instruction and one stub per error
+ * status.
+ */
+static int assembleExpression(_assembler* assembler, const _expression* expression)
+{
+    // push rbx, r12, r13 (leaves rsp 16-byte aligned), then copy the arguments
+    static const uint8_t prologue[] = { 0x53, 0x41, 0x54, 0x41, 0x55 };
+    static const uint8_t copyArguments[] = { 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5 };
+    size_t slotCount = (size_t)expression->stackSize + (size_t)expression->temporaryCount;
+    int32_t frameSize = (int32_t)((8 * slotCount + 15) & ~(size_t)15);
+    size_t stubOffsets[JIT_ERROR_STATUSES];
+    int status = STATUS_SUCCESS;
+
+    assembler->temporaryBase = expression->stackSize;
+    emitBytes(assembler, prologue, sizeof(prologue));
+    emitByte(assembler, 0x48);  // sub rsp, frameSize
+    emitByte(assembler, 0x81);
+    emitByte(assembler, 0xEC);
+    emit32(assembler, (uint32_t)frameSize);
+    emitBytes(assembler, copyArguments, sizeof(copyArguments));
+
+    for (int i = 0; i < expression->codeLength && status == STATUS_SUCCESS; i++) {
+        status = emitInstruction(assembler, expression->code[i], frameSize);
+    }
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    // Error stubs: mov eax, status; jmp to the epilogue
+    for (int s = 0; s < JIT_ERROR_STATUSES; s++) {
+        stubOffsets[s] = assembler->length;
+        emitByte(assembler, 0xB8);
+        emit32(assembler, (uint32_t)ERROR_STATUSES[s]);
+        emitByte(assembler, 0xE9);
+        emit32(assembler, (uint32_t)(int32_t)((int64_t)assembler->exitOffset - (int64_t)(assembler->length + 4)));
+    }
+    if (assembler->status != STATUS_SUCCESS) {
+        return assembler->status;
+    }
+    for (int f = 0; f < assembler->fixupCount; f++) {
+        const _jitFixup* fixup = &assembler->fixups[f];
+        int32_t displacement = (int32_t)((int64_t)stubOffsets[fixup->stub] - (int64_t)(fixup->offset + 4));
+        memcpy(assembler->bytes + fixup->offset, &displacement, sizeof(displacement));
+    }
+    return STATUS_SUCCESS;
+}
+#endif // JIT_AVAILABLE
+
+/*
+ * jitInit
+ */
+void jitInit(_jitCode* code)
+{
+    code->function = NULL;
+    code->buffer = NULL;
+    code->bufferSize = 0;
+}
+
+/*
+ * jitFree
+ *
+ * Releases the executable pages; the expression then runs on the
+ * interpreter.
+ */
+void jitFree(_jitCode* code)
+{
+#if JIT_AVAILABLE
+    if (code->buffer != NULL) {
+        munmap(code->buffer, code->bufferSize);
+    }
+#endif
+    jitInit(code);
+}
+
+/*
+ * jitCompile
+ *
+ * Translates a successfully compiled expression into native code,
+ * replacing what code held before.
+ *
+ * @param code        Receives the native function.
+ * @param expression  The expression; it must not be recompiled while
+ *                    code is in use.
+ * @return            STATUS_SUCCESS, STATUS_UNDEFINED_RESULT when the
+ *                    processor, the system or one of the instructions is
+ *                    not supported (code then leaves evaluation to the
+ *                    interpreter), STATUS_INVALID_INPUT for an expression
+ *                    that did not compile, or STATUS_INSUFFICIENT_MEMORY.
+ */
+int jitCompile(_jitCode* code, const _expression* expression)
+{
+    jitFree(code);
+    if (expression->codeLength == 0) {
+        return STATUS_INVALID_INPUT;
+    }
+
+#if JIT_AVAILABLE
+    _assembler assembler = { 0 };
+    int status = assembleExpression(&assembler, expression);
+
+    if (status == STATUS_SUCCESS) {
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t bufferSize = (assembler.length + pageSize - 1) / pageSize * pageSize;
+        void* buffer = mmap(NULL, bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (buffer == MAP_FAILED) {
+            status = STATUS_INSUFFICIENT_MEMORY;
+        }
+        else {
+            memcpy(buffer, assembler.bytes, assembler.length);
+            if (mprotect(buffer, bufferSize, PROT_READ | PROT_EXEC) != 0) {
+                munmap(buffer, bufferSize);
+                status = STATUS_INSUFFICIENT_MEMORY;
+            }
+            else {
+                code->buffer = buffer;
+                code->bufferSize = bufferSize;
+                // Object to function pointer conversion, as with dlsym
+                memcpy(&code->function, &buffer, sizeof(buffer));
+            }
+        }
+    }
+    free(assembler.bytes);
+    free(assembler.fixups);
+    return status;
+#else
+    return STATUS_UNDEFINED_RESULT;
+#endif
+}
+
+/*
+ * jitEvaluate
+ *
+ * expressionEvaluate through the native code when there is any.
+ */
+int jitEvaluate(const _jitCode* code, _expression* expression, const double* variables, double* result)
+{
+    if (code->function != NULL) {
+        return code->function(variables, expression->constants, result);
+    }
+    return expressionEvaluate(expression, variables, result);
+}
+
+/*
+ * jitEvaluateBatch
+ *
+ * expressionEvaluateBatch through the native code when there is any.
+ */
+int jitEvaluateBatch(const _jitCode* code, _expression* expression, const double* variables, size_t count,
+    double* results)
+{
+    int firstStatus = STATUS_SUCCESS;
+
+    if (code->function == NULL) {
+        return expressionEvaluateBatch(expression, variables, count, results);
+    }
+    for (size_t i = 0; i < count; i++) {
+        const double* row = (variables != NULL) ? variables + i * (size_t)expression->variableCount : NULL;
+        int status = code->function(row, expression->constants, &results[i]);
+        if (status != STATUS_SUCCESS) {
+            results[i] = NAN;
+            if (firstStatus == STATUS_SUCCESS) {
+                firstStatus = status;
+            }
+        }
+    }
+    return firstStatus;
+}
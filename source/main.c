@@ -67,7 +67,6 @@ CharRange charRangeTable[NUM_SUPPORTED_CODEPAGES * 6];  // 6 ranges per code pag
 
 BYTE charTypeFlags[256] = { 0 }; // Initialize all elements to 0
 BOOL isCustomCodePage = FALSE;  // Initially set to FALSE (system-determined)
-DWORD operatorStack[MAX_OPERATOR_STACK]; // Global operator stack variable (for the parentheses)
 
 //Stores if a button is visible or not by turning on turning the highest bit of that button on or off.
 //To toggle them, XOR the button code against the mask 0x8000.
@@ -209,23 +208,11 @@ CharRange charRangeTable[NUM_SUPPORTED_CODEPAGES * 6] = {
     { 0,    0,    0 }
 };
 
-DWORD BUTTON_ID_MAP_STANDARD[] = {
-    IDC_BUTTON_MC,  IDC_BUTTON_7,  IDC_BUTTON_8,  IDC_BUTTON_9,  IDC_BUTTON_DIV, IDC_BUTTON_SQRT,
-    IDC_BUTTON_MR,  IDC_BUTTON_4,  IDC_BUTTON_5,  IDC_BUTTON_6,  IDC_BUTTON_MUL, IDC_BUTTON_PERC,
-    IDC_BUTTON_MS,  IDC_BUTTON_1,  IDC_BUTTON_2,  IDC_BUTTON_3,  IDC_BUTTON_SUB, IDC_BUTTON_INV,
-    IDC_BUTTON_MPLUS, IDC_BUTTON_0, IDC_BUTTON_NEG, IDC_BUTTON_DOT, IDC_BUTTON_ADD, IDC_BUTTON_EQ,
-    IDC_BUTTON_BACK, IDC_BUTTON_CE, IDC_BUTTON_CA
-};
+#define BUTTON_ID(id) id,
 
-DWORD BUTTON_ID_MAP_SCIENTIFIC[] = {
-    IDC_BUTTON_MC, IDC_BUTTON_7,  IDC_BUTTON_8,  IDC_BUTTON_9,  IDC_BUTTON_DIV, IDC_BUTTON_MOD,   IDC_BUTTON_AND,
-    IDC_BUTTON_MR, IDC_BUTTON_4,  IDC_BUTTON_5,  IDC_BUTTON_6,  IDC_BUTTON_MUL, IDC_BUTTON_OR,    IDC_BUTTON_XOR,
-    IDC_BUTTON_MS, IDC_BUTTON_1,  IDC_BUTTON_2,  IDC_BUTTON_3,  IDC_BUTTON_SUB, IDC_BUTTON_LSH,   IDC_BUTTON_NOT,
-    IDC_BUTTON_MPLUS, IDC_BUTTON_0, IDC_BUTTON_NEG, IDC_BUTTON_DOT, IDC_BUTTON_ADD, IDC_BUTTON_EQ,  IDC_BUTTON_INT,
-    IDC_BUTTON_STA, IDC_BUTTON_F_E,IDC_BUTTON_LPAR,IDC_BUTTON_RPAR,IDC_BUTTON_MSUB, IDC_BUTTON_PI, IDC_BUTTON_A, IDC_BUTTON_B, IDC_BUTTON_C, IDC_BUTTON_D, IDC_BUTTON_E, IDC_BUTTON_F,
-    IDC_BUTTON_AVE, IDC_BUTTON_DMS,IDC_BUTTON_EXP, IDC_BUTTON_LN,   IDC_BUTTON_SIN,  IDC_BUTTON_XY,   IDC_BUTTON_LOG, IDC_BUTTON_SQR, IDC_BUTTON_CUBE,IDC_BUTTON_FACT,
-    IDC_BUTTON_SUM, IDC_BUTTON_SIN,IDC_BUTTON_COS, IDC_BUTTON_TAN,  IDC_BUTTON_ASIN, IDC_BUTTON_ACOS, IDC_BUTTON_ATAN
-};
+DWORD BUTTON_ID_MAP_STANDARD[] = { STANDARD_KEYPAD(BUTTON_ID) };
+
+DWORD BUTTON_ID_MAP_SCIENTIFIC[] = { SCIENTIFIC_KEYPAD(BUTTON_ID) };
 
 
 uint currentAllocationSize = INITIAL_MEMORY_SIZE; // Current allocated memory size
@@ -246,14 +233,24 @@ uint currentAllocationSize = INITIAL_MEMORY_SIZE; // Current allocated memory si
  *      memory to handle the higher precision calculations required in scientific mode.
  *    - Otherwise, `currentAllocationSize` is set to `INITIAL_MEMORY_SIZE`, which is
  *      presumably a smaller amount of memory suitable for standard mode calculations.
+ *    - The engine arena, which holds the temporaries of each evaluation, grows in
+ *      chunks of `currentAllocationSize` bytes (rounded up to HEAP_CHUNK_SIZE).
+ *    - When the size drops, the pages of the large blocks the engine heap keeps
+ *      for reuse are handed back to the system (see releaseHeapMemory).
  */
 void adjustMemoryAllocation(void) {
-    if (isScientificMode() && calcState.currentPrecisionLevel < MAX_STANDARD_PRECISION) {
+    uint previousAllocationSize = currentAllocationSize;
+
+    if (isScientificMode() && calcState.engine.currentPrecisionLevel < MAX_STANDARD_PRECISION) {
         currentAllocationSize = EXTENDED_MEMORY_SIZE;
     }
     else {
         currentAllocationSize = INITIAL_MEMORY_SIZE;
     }
+    setMemoryArenaChunkSize(&calcState.engine.arena, currentAllocationSize);
+    if (currentAllocationSize < previousAllocationSize) {
+        releaseHeapMemory();
+    }
 }
 
 
@@ -282,8 +279,9 @@ void adjustMemoryAllocation(void) {
  *
  *     - WM_ACTIVATE: Shows or hides the scientific mode window when the
  *                     main window is activated or deactivated.
- *     - WM_DESTROY: Performs cleanup tasks, including closing the help window,
- *                    and posts the WM_QUIT message to end the application.
+ *     - WM_DESTROY: Performs cleanup tasks, including closing the help window
+ *                    and releasing the engine's values, and posts the WM_QUIT
+ *                    message to end the application.
  *     - WM_SYSCOLORCHANGE:  Handles system color changes, potentially updating
  *                             the calculator's color scheme.
  *     - WM_PAINT:  Redraws the calculator interface, including buttons and
@@ -331,6 +329,7 @@ LRESULT CALLBACK calcWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 
     case WM_DESTROY:
         WinHelp(calcState.windowHandle, calcState.helpFilePath, HELP_QUIT, 0);
+        freeEngine(&calcState.engine);
         PostQuitMessage(0);
         return 0;
 
@@ -345,26 +344,14 @@ LRESULT CALLBACK calcWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 
     case WM_PAINT:
         refreshInterface();
-        if (calcState.errorState == 0)
+        if (calcState.engine.errorState == 0)
         {
-            if (calcState.keyPressed < KEY_RANGE_START || calcState.keyPressed > KEY_RANGE_END)
-            {
-                updateDisplay();
-            }
-            else {
-                DWORD tempHighPart = calcState.currentValueHighPart;
-                char tempAccumulated[MAX_DISPLAY_DIGITS]; // Temporary string buffer
-                strncpy_s(tempAccumulated, sizeof(tempAccumulated), calcState.accumulatedValue, _TRUNCATE); // Store original string
-                calcState.currentValueHighPart = calcState.defaultPrecisionValue;
-                snprintf(calcState.accumulatedValue, MAX_DISPLAY_DIGITS, "%u", calcState.lastValue);  // Copy DWORD to array as a string 
-                updateDisplay();
-                strncpy_s(calcState.accumulatedValue, sizeof(calcState.accumulatedValue), tempAccumulated, _TRUNCATE); // Restore original string
-                calcState.currentValueHighPart = tempHighPart;
-            }
+            // The engine keeps the value to show: the entry in accumulatedValue, a result in currentValue
+            updateDisplay();
         }
         else
         {
-            handleCalculationError(calcState.errorCodeBase);
+            handleCalculationError(calcState.engine.errorCodeBase);
         }
         break;
 
@@ -409,7 +396,7 @@ LRESULT CALLBACK calcWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
             for (int i = 0; i < 0x3d; i++)
             {
                 if ((windowStateTable[i] >> 8 & 0xff) == cmdID &&
-                    (windowStateTable[i] & 3) != calcState.mode)
+                    (windowStateTable[i] & 3) != calcState.engine.mode)
                 {
                     updateButtonState(cmdID, 100);
                     break;
@@ -612,6 +599,20 @@ DWORD configureCodePageSettings(int requestedCodepage)
 }
 
 
+/*
+ * applyQuantileAccuracy
+ *
+ * Reads the accuracy of the median and percentiles of the statistics box
+ * from QuantileAccuracy in the [SciCalc] section of WIN.INI. Larger
+ * values are more accurate and take more memory; the rank error is about
+ * 1 / QuantileAccuracy.
+ */
+void applyQuantileAccuracy(void)
+{
+    UINT accuracy = GetProfileIntA(calcState.registryKey, "QuantileAccuracy", (int)DEFAULT_QUANTILE_COMPRESSION);
+    statisticsSetQuantileCompression(&calcState.engine.statistics, (double)accuracy);
+}
+
 /*
  * initCalcState()
  *
@@ -641,26 +642,25 @@ void initCalcState(void)
     // Set default help file path
     strcpy_s(calcState.helpFilePath, MAX_PATH, "calc.hlp");
 
-    // Initialize numeric values
-    memset(calcState.accumulatedValue, 0, sizeof(calcState.accumulatedValue));
+    // Initialize numeric values (entry, operators, memory, mode and base)
+    initEngine(&calcState.engine);
+    adjustMemoryAllocation();
     calcState.appInstance = NULL;
-    calcState.currentPrecisionLevel = MAX_STANDARD_PRECISION;
+
+    // The engine library cannot ask Windows for the processor count
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    statisticsThreads = systemInfo.dwNumberOfProcessors;
+    applyQuantileAccuracy();
+
+    // FREECALC_HEAP_STATISTICS names a file for the heap statistics of builds that count them
+    char heapStatisticsPath[MAX_PATH];
+    DWORD pathLength = GetEnvironmentVariableA("FREECALC_HEAP_STATISTICS", heapStatisticsPath, MAX_PATH);
+    if (pathLength > 0 && pathLength < MAX_PATH) {
+        installHeapStatisticsDump(heapStatisticsPath);
+    }
     calcState.codepageInfo.currentCodepage = GetACP(); //Gets system codepage
-    calcState.currentValueHighPart = 0;
     calcState.defaultPrecisionValue = 0;
-    calcState.decimalSeparator = DEFAULT_DECIMAL_SEPARATOR;
-    calcState.errorCodeBase = 0;
-    calcState.errorState = 0;
-    calcState.hasOperatorPending = FALSE;
-    calcState.keyPressed = INVALID_BUTTON;
-    calcState.lastValue = 0;
-    calcState.mode = STANDARD_MODE;
-    calcState.memoryRegister[0] = 0;
-    calcState.memoryRegister[1] = 0;
-    calcState.numberBase = 10;
-    calcState.scientificNumber.exponent = 0;
-    calcState.scientificNumber.mantissaLow = 0;
-    calcState.scientificNumber.mantissaHigh = 0;
     calcState.statisticsWindowOpen = FALSE;
     calcState.windowHandle = NULL;
 
@@ -711,7 +711,7 @@ void initApplicationPath(void)
     tokenizeString(appPathBuffer, (char**)0x0, (char*)0x0, &componentCount, &pathDataSize);
 
     // Allocate memory for path components and string data
-    pathComponents = (char**)allocateMemoryFromHeap(componentCount * 4 + pathDataSize);
+    pathComponents = (char**)allocateMemoryFromHeap(componentCount * sizeof(char*) + pathDataSize);
     if (pathComponents == (char**)0x0) {
         showRunTimeError(MEM_ALLOC_ERROR); 
         return;
@@ -790,13 +790,13 @@ void initColors(int forceUpdate) {
     int standardModeWidth = 0, standardModeHeight = 0;
     int scientificModeWidth = 0, scientificModeHeight = 0;
     static int cxChar, cyChar;
-    const char* currentModeText = calcState.modeText[calcState.mode];
+    const char* currentModeText = calcState.modeText[calcState.engine.mode];
     int modeTextID;
     int totalWidth; //Total width of the calculator 
     int BUTTON_BASE_SIZE = 0;
 
     // Determine background color based on calculator display mode
-    if (calcState.mode == SCIENTIFIC_MODE) {
+    if (calcState.engine.mode == SCIENTIFIC_MODE) {
         GetProfileStringA(calcState.registryKey, "background", "8421504", backgroundColorString, sizeof(backgroundColorString));
         calcState.isHighContrastMode = FALSE;
     }
@@ -808,17 +808,17 @@ void initColors(int forceUpdate) {
     backgroundColor = (backgroundColorString[0] == '-') ? GetSysColor(COLOR_BTNFACE) : parseSignedInteger(backgroundColorString);
 
     // Check if background color has changed
-    previousDecimalSeparator = calcState.decimalSeparator;
+    previousDecimalSeparator = calcState.engine.decimalSeparator;
     backgroundColorChanged = (backgroundColor != calcState.currentBackgroundColor);
     if (backgroundColorChanged) {
         calcState.currentBackgroundColor = backgroundColor;
     }
 
     // Get decimal separator from system settings
-    GetProfileStringA(CALCULATOR_APP_NAME, "sDecimal", DEFAULT_DECIMAL_SEPARATOR, &calcState.decimalSeparator, sizeof(calcState.decimalSeparator));
+    GetProfileStringA(CALCULATOR_APP_NAME, "sDecimal", DEFAULT_DECIMAL_SEPARATOR, &calcState.engine.decimalSeparator, sizeof(calcState.engine.decimalSeparator));
 
     // Update interface if necessary
-    if ((previousDecimalSeparator != calcState.decimalSeparator) || backgroundColorChanged || forceUpdate) {
+    if ((previousDecimalSeparator != calcState.engine.decimalSeparator) || backgroundColorChanged || forceUpdate) {
         SetDecimalSeparator(&calcState);
 
         hDC = GetDC(calcWindows.main);
@@ -842,7 +842,7 @@ void initColors(int forceUpdate) {
             InvalidateRect(calcWindows.main, NULL, TRUE);
 
             // Set dimensions based on calculator mode
-            if (calcState.mode == STANDARD_MODE) {
+            if (calcState.engine.mode == STANDARD_MODE) {
                 windowRect.left = 0;
                 windowRect.top = 0;
                 windowRect.bottom = 0;
@@ -915,8 +915,8 @@ void initColors(int forceUpdate) {
             // Update menu to reflect current mode
             menuHandle = GetMenu(calcWindows.main);
             menuHandle = GetSubMenu(menuHandle, 1);
-            CheckMenuItem(menuHandle, calcState.mode, MF_BYCOMMAND | MF_CHECKED);
-            CheckMenuItem(menuHandle, 1 - calcState.mode, MF_BYCOMMAND | MF_UNCHECKED);
+            CheckMenuItem(menuHandle, calcState.engine.mode, MF_BYCOMMAND | MF_CHECKED);
+            CheckMenuItem(menuHandle, 1 - calcState.engine.mode, MF_BYCOMMAND | MF_UNCHECKED);
 
             // Fill window background with new color
             SetRect(&windowRect, 0, 0, standardModeWidth, standardModeHeight);
@@ -933,21 +933,21 @@ void initColors(int forceUpdate) {
             do {
                 hChildWindow = GetDlgItem(calcWindows.main, *pWindowState & 0x7fff);
                 if (hChildWindow != NULL) {
-                    ShowWindow(hChildWindow, (*pWindowState >> 15) == calcState.mode);
+                    ShowWindow(hChildWindow, (*pWindowState >> 15) == calcState.engine.mode);
                 }
                 pWindowState++;
             } while (pWindowState < &windowStateTable[15]);
 
             // Set up scientific mode if necessary
-            if (calcState.mode != SCIENTIFIC_MODE) {
+            if (calcState.engine.mode != SCIENTIFIC_MODE) {
                 // setupCalculatorMode(123);  // Uncomment and implement this function if needed
             }
 
-            if ((calcState.memoryRegister[1] & 0x7fffffff | calcState.memoryRegister[0]) == 0) {
-                currentModeText = calcState.modeText[calcState.mode];
+            if (valueIsZero(&calcState.engine.memoryRegister)) {
+                currentModeText = calcState.modeText[calcState.engine.mode];
             }
 
-            modeTextID = (calcState.mode == STANDARD_MODE) ? IDC_TEXT_STANDARD_MODE : IDC_TEXT_SCIENTIFIC_MODE;
+            modeTextID = (calcState.engine.mode == STANDARD_MODE) ? IDC_TEXT_STANDARD_MODE : IDC_TEXT_SCIENTIFIC_MODE;
 
             SetDlgItemTextA(calcWindows.main, modeTextID, currentModeText);
         }
@@ -992,7 +992,7 @@ void initEnvironmentVariables(void)
     }
 
     // Allocate memory for environment variable pointers and string data
-    size_t totalSize = (envVarCount + 1) * sizeof(int) + strlen(envString) + 1;
+    size_t totalSize = (envVarCount + 1) * sizeof(char*) + strlen(envString) + 1;
     char** envVarArray = (char**)allocateMemoryFromHeap(totalSize);
     if (envVarArray == NULL) {
         showRunTimeError(MEM_ALLOC_ERROR);  
@@ -1172,7 +1172,7 @@ DWORD getCalculatorButton(ushort mouseX, ushort mouseY)
     // Define the main button area based on the current mode
     int topEdge, bottomEdge, leftEdge, rightEdge;
 
-    if (calcState.mode == SCIENTIFIC_MODE) {
+    if (calcState.engine.mode == SCIENTIFIC_MODE) {
         topEdge = VERTICAL_MARGIN;
         bottomEdge = topEdge + SCIENTIFIC_CALC_ROWS * (BUTTON_BASE_SIZE + BUTTON_VERTICAL_SPACING) - BUTTON_VERTICAL_SPACING;
         leftEdge = HORIZONTAL_MARGIN;
@@ -1192,7 +1192,7 @@ DWORD getCalculatorButton(ushort mouseX, ushort mouseY)
             // Find the column of the clicked button
             int column = 0;
             BOOL buttonFound = FALSE;
-            int buttonsPerRow = (calcState.mode == SCIENTIFIC_MODE) ? SCIENTIFIC_CALC_COLS : STANDARD_CALC_COLS;
+            int buttonsPerRow = (calcState.engine.mode == SCIENTIFIC_MODE) ? SCIENTIFIC_CALC_COLS : STANDARD_CALC_COLS;
 
             // Calculate the height of a button row 
             int buttonRowHeight = (BUTTON_ROW_HEIGHT_FACTOR * BUTTON_BASE_SIZE + 7) >> 3;
@@ -1210,7 +1210,7 @@ DWORD getCalculatorButton(ushort mouseX, ushort mouseY)
                 int row = 0;
                 BOOL rowFound = FALSE;
 
-                while (row < (calcState.mode == SCIENTIFIC_MODE ? SCIENTIFIC_CALC_ROWS : STANDARD_CALC_ROWS) && !rowFound) {
+                while (row < (calcState.engine.mode == SCIENTIFIC_MODE ? SCIENTIFIC_CALC_ROWS : STANDARD_CALC_ROWS) && !rowFound) {
    
                     if (mouseX >= horizontalPosition + verticalPosition &&
                         mouseX <= horizontalPosition + verticalPosition + BUTTON_BASE_SIZE) {
@@ -1225,7 +1225,7 @@ DWORD getCalculatorButton(ushort mouseX, ushort mouseY)
                     int buttonIndex = buttonsPerRow * (row - 1) + column - 1;
 
                     // Use the correct BUTTON_ID_MAP based on the mode
-                    if (calcState.mode == SCIENTIFIC_MODE) {
+                    if (calcState.engine.mode == SCIENTIFIC_MODE) {
                         if (buttonIndex < sizeof(BUTTON_ID_MAP_SCIENTIFIC) / sizeof(DWORD)) {
                             return BUTTON_ID_MAP_SCIENTIFIC[buttonIndex];
                         }
@@ -1244,8 +1244,8 @@ DWORD getCalculatorButton(ushort mouseX, ushort mouseY)
         GetClientRect(calcState.windowHandle, &clientRect);
 
         for (int i = 0; i < 3; i++) {
-            if (mouseX <= clientRect.right - horizontalPosition - (calcState.mode == 0 ? 1 : 0) - 10 &&
-                mouseX > clientRect.right - horizontalPosition - rowIndex - (calcState.mode == 0 ? 1 : 0) - 10) {
+            if (mouseX <= clientRect.right - horizontalPosition - (calcState.engine.mode == 0 ? 1 : 0) - 10 &&
+                mouseX > clientRect.right - horizontalPosition - rowIndex - (calcState.engine.mode == 0 ? 1 : 0) - 10) {
                 return i + SPECIAL_BUTTON_OFFSET;
             }
             horizontalPosition += buttonWidth;
@@ -1327,7 +1327,7 @@ void refreshInterface(void)
     SystemParametersInfo(SPI_GETHIGHCONTRAST, 0, &isHighContrastMode, 0);
 
     // Determine calculator dimensions based on mode
-    if (calcState.mode == SCIENTIFIC_MODE) {
+    if (calcState.engine.mode == SCIENTIFIC_MODE) {
         calcRows = SCIENTIFIC_CALC_ROWS;
         calcCols = SCIENTIFIC_CALC_COLS;
     }
@@ -1353,7 +1353,7 @@ void refreshInterface(void)
     DrawEdge(hdc, &edgeRect, EDGE_SUNKEN, BF_RECT);
 
     // Set up button dimensions
-    buttonWidth = BUTTON_BASE_SIZE + (calcState.mode == SCIENTIFIC_MODE ? SCIENTIFIC_BUTTON_EXTRA_WIDTH : 0);
+    buttonWidth = BUTTON_BASE_SIZE + (calcState.engine.mode == SCIENTIFIC_MODE ? SCIENTIFIC_BUTTON_EXTRA_WIDTH : 0);
     buttonHeight = BUTTON_BASE_SIZE;
     buttonSpacing = 4;
 
@@ -1362,7 +1362,7 @@ void refreshInterface(void)
     buttonIndex = 0;
     for (row = 0; row < calcRows; row++) {
         for (col = 0; col < calcCols; col++) {
-            if (isButtonVisible(buttonIndex, calcState.mode)) {
+            if (isButtonVisible(buttonIndex, calcState.engine.mode)) {
                 int x = col * (buttonWidth + buttonSpacing) + HORIZONTAL_MARGIN;
                 int y = row * (buttonHeight + buttonSpacing) + VERTICAL_MARGIN;
 
@@ -1439,40 +1439,18 @@ BOOL handleContextHelp(HWND hwnd, HINSTANCE hInstance, UINT message)
 }
 
 
-BOOL hasDecimalSeparator(const char* str) {
-    if (str == NULL) {
-        return FALSE;
-    }
-
-    while (*str != '\0') {
-        if (*str == calcState.decimalSeparator) {
-            return TRUE;
-        }
-        str++;
-    }
-
-    return FALSE;
-}
-
 /*
  * processButtonClick()
  *
  * This function handles the processing of button clicks in the calculator application.
- * It manages input mode, performs calculations, and updates the calculator state based on user input.
+ * Statistics keys are routed to the statistics window; every other key is passed to
+ * the platform-neutral engine (processKey in engine.c), which does the digit entry,
+ * operator precedence, parentheses and calculations.
  *
- * The function performs the following tasks:
- * 1. Checks if the pressed key is a special function key
- * 2. Handles error states and input mode activation
- * 3. Processes numeric input and operator input
- * 4. Manages calculator state reset for certain key combinations
- * 5. Performs calculations and updates the calculator state
- * 6. Handles special cases (scientific mode, parentheses, etc.)
- * 7. Updates the display after processing
- *
- * This function is central to the calculator's operation, interpreting user input
- * and managing the flow of calculations. It works in conjunction with other functions
- * like updateInputMode, appendDigit, and performAdvancedCalculation to provide
- * a complete calculation experience.
+ * The function then performs the Win32 side of the result:
+ * 1. Redraws the display when the engine asks for it
+ * 2. Beeps when the engine rejected the key
+ * 3. Reports calculation errors with handleCalculationError
  *
  * @param currentKeyPressed    The key code of the button that was pressed
  *
@@ -1480,182 +1458,42 @@ BOOL hasDecimalSeparator(const char* str) {
  */
 void processButtonClick(DWORD currentKeyPressed)
 {
-    BOOL isLastInputComplete;
-    BOOL isValidInput;
-    double calculationResult;
-    int currentOperatorPrecedence, newOperatorPrecedence, stackPointer;
-    char tempBuffer[MAX_DISPLAY_DIGITS]; // Temporary buffer for calculations
-
-    // Handle special function keys
-    if (!isSpecialFunctionKey(currentKeyPressed)) {
-        calcState.keyPressed = currentKeyPressed;
-    }
-
-    // Handle error state
-    if (calcState.errorState != 0 && !isClearKey(currentKeyPressed)) {
-        MessageBeep(0);
-        return;
-    }
-
-    // Handle input mode activation
-    if (!calcState.isInputModeActive) {
-        isValidInput = isNumericInput(currentKeyPressed) || currentKeyPressed == IDC_BUTTON_DOT;
-        if (isValidInput) {
-            calcState.isInputModeActive = TRUE;
-            initCalcState();
-        }
-    }
-    else if (isOperatorKey(currentKeyPressed) || currentKeyPressed == IDC_BUTTON_EXP) {
-        calcState.isInputModeActive = FALSE;
-    }
-
-    // Reset calculator state for certain key combinations
-    if (isNumericInput(currentKeyPressed) &&
-        (isPreviousKeyOperator() || calcState.keyPressed == IDC_BUTTON_RPAR || currentKeyPressed == IDC_BUTTON_EXP)) {
-        resetCalculatorState();
-    }
-
-    // Process numeric input
-    if (isNumericInput(currentKeyPressed)) {
-        int digit = convertKeyToDigit(currentKeyPressed);
-        if (digit < calcState.numberBase) {
-            if (calcState.numberBase == 10) {
-                if (!appendDigit(calcState.accumulatedValue, digit)) { // Pass the string
-                    MessageBeep(0);
-                    return;
-                }
-            }
-            else {
-                if (isValueOverflow(calcState.accumulatedValue, calcState.numberBase, digit, calcState.mode)) {
-                    handleCalculationError(STATUS_OVERFLOW);
-                    return;
-                }
-                // Convert accumulatedValue to an integer, perform the calculation,
-                // then convert back to a string.
-                LONGLONG accumulatedInt = strtol(calcState.accumulatedValue, NULL, calcState.numberBase);
-                accumulatedInt = calcState.numberBase * accumulatedInt + digit * calcState.currentSign;
-
-                // Use ltoa_s instead of _ltoa
-                errno_t conversionResult = _ltoa_s(accumulatedInt, calcState.accumulatedValue,
-                    sizeof(calcState.accumulatedValue), calcState.numberBase);
-
-                if (conversionResult != 0) {
-                    // Handle conversion error
-                    showRunTimeError(11); // Assuming 11 is the error code for conversion failure
-                    return;
-                }
-            }
-        }
-        else {
-            MessageBeep(0);
-        }
-        updateDisplay();
-        return;
-    }
-
     // Handle statistical functions
     if (currentKeyPressed >= IDC_BUTTON_STAT_RED && currentKeyPressed <= IDC_BUTTON_STAT_CAD) {
         if (calcState.statisticsWindowOpen) {
             performStatisticalCalculation(currentKeyPressed);
-            if (calcState.errorState == 0) {
+            if (calcState.engine.errorState == 0) {
                 updateDisplay();
             }
         }
         else {
             MessageBeep(0);
         }
-        calcState.isInverseMode = FALSE;
-        updateToggleButton(IDC_BUTTON_INV, FALSE);
+        calcState.engine.isInverseMode = FALSE;
+        updateToggleButton(IDC_BUTTON_INV_TOGGLE, FALSE);
         return;
     }
 
-    // Handle parentheses
-    if (currentKeyPressed == IDC_BUTTON_LPAR) {
-        pushOperator(IDC_BUTTON_LPAR, 0); // Push left parenthesis onto the stack
-    }
-    else if (currentKeyPressed == IDC_BUTTON_RPAR) {
-        // Evaluate expressions until we find a left parenthesis
-        while (calcState.operatorStackPointer > 0 && getTopOperator() != IDC_BUTTON_LPAR) {
-            if (calcState.operatorStackPointer > 0) {
-                uint operator = popOperator();
-                double operand2 = popOperand();
-                double operand1 = popOperand();
-                double result = performAdvancedCalculation(operator, operand1, operand2);
-                pushOperand(result);
-            }
-        }
-        if (calcState.operatorStackPointer > 0 && getTopOperator() == IDC_BUTTON_LPAR) {
-            popOperator(); // Remove the left parenthesis
+    // Everything else is handled by the platform-neutral engine
+    switch (processKey(&calcState.engine, currentKeyPressed)) {
+    case KEY_RESULT_DISPLAY:
+        if (currentKeyPressed == IDC_BUTTON_DAT && calcState.statisticsWindowOpen) {
+            updateStatisticsDisplay(calcState.statisticsWindow);
         }
-        else {
-            MessageBeep(0); // Error: Unmatched closing parenthesis
-            return;
-        }
-    }
-
-    // Process operator input
-    if (isOperatorKey(currentKeyPressed)) {
-        if (calcState.hasOperatorPending) {
-            do {
-                stackPointer = calcState.operatorStackPointer;
-                newOperatorPrecedence = getOperatorPrecedence(currentKeyPressed);
-                currentOperatorPrecedence = getOperatorPrecedence(calcState.currentOperator); // Use currentOperator from calcState
-
-                if (newOperatorPrecedence > currentOperatorPrecedence && calcState.mode == STANDARD_MODE) {
-                    if (calcState.operatorStackPointer < MAX_OPERATOR_STACK) {
-                        pushOperator(calcState.currentOperator, calcState.lastValue);
-                    }
-                    else {
-                        calcState.operatorStackPointer = MAX_OPERATOR_STACK - 1;
-                        MessageBeep(0);
-                    }
-                    isLastInputComplete = TRUE;
-                    calcState.lastValue = atof(calcState.accumulatedValue); // Convert accumulatedValue to double
-                    calcState.currentOperator = currentKeyPressed;
-                    strcpy_s(calcState.accumulatedValue, MAX_DISPLAY_DIGITS, "0"); // Clear accumulatedValue
-                    calcState.hasOperatorPending = TRUE;
-                    calcState.currentSign = 1;
-                    return;
-                }
-
-                calculationResult = performAdvancedCalculation(calcState.currentOperator, calcState.lastValue, atof(calcState.accumulatedValue));
-                sprintf_s(tempBuffer, MAX_DISPLAY_DIGITS, "%f", calculationResult); // Convert result to string
-                strcpy_s(calcState.accumulatedValue, MAX_DISPLAY_DIGITS, tempBuffer); // Store result in accumulatedValue
+        updateDisplay();
+        break;
 
-                if (calcState.operatorStackPointer == 0 || getTopOperator() == 0) {
-                    break;
-                }
+    case KEY_RESULT_BEEP:
+        MessageBeep(0);
+        break;
 
-                calcState.operatorStackPointer--;
-                calcState.currentOperator = popOperator();
-                calcState.lastValue = popOperand();
-            } while (TRUE);
-        }
+    case KEY_RESULT_ERROR:
+        handleCalculationError(calcState.engine.errorCodeBase);
+        break;
 
-        if (calcState.errorState == 0) {
-            updateDisplay();
-            isLastInputComplete = TRUE;
-            calcState.lastValue = atof(calcState.accumulatedValue); // Convert accumulatedValue to double
-            calcState.currentSign = 1;
-            calcState.hasOperatorPending = TRUE;
-            strcpy_s(calcState.accumulatedValue, MAX_DISPLAY_DIGITS, "0"); // Clear accumulatedValue
-            calcState.currentOperator = currentKeyPressed;
-        }
-        else {
-            isLastInputComplete = TRUE;
-            calcState.lastValue = atof(calcState.accumulatedValue); // Convert accumulatedValue to double
-            calcState.currentOperator = currentKeyPressed;
-            strcpy_s(calcState.accumulatedValue, MAX_DISPLAY_DIGITS, "0"); // Clear accumulatedValue
-            calcState.hasOperatorPending = TRUE;
-            calcState.currentSign = 1;
-        }
-        return;
+    default:
+        break;
     }
-
-    // Handle special cases
-    handleSpecialCases(currentKeyPressed);
-
-    updateDisplay();
 }
 
 /*
@@ -1743,25 +1581,22 @@ BOOL CALLBACK scientificDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARA
         case IDC_BUTTON_SQR:
         case IDC_BUTTON_CUBE:
         case IDC_BUTTON_FACT:
-            // Handle scientific function buttons
-            ProcessScientificFunction(LOWORD(wParam));
-            updateDisplay();
-            break;
-
         case IDC_RADIO_DEG:
         case IDC_RADIO_RAD:
         case IDC_RADIO_GRAD:
-            // Handle angle mode selection
-            SetAngleMode(LOWORD(wParam));
-            break;
-
         case IDC_RADIO_HEX:
         case IDC_RADIO_DEC:
         case IDC_RADIO_OCT:
         case IDC_RADIO_BIN:
-            // Handle number base selection
-            SetNumberBase(LOWORD(wParam));
-            updateDisplay();
+        case IDC_RADIO_BITS8:
+        case IDC_RADIO_BITS16:
+        case IDC_RADIO_BITS32:
+        case IDC_RADIO_BITS64:
+        case IDC_RADIO_BITS128:
+        case IDC_RADIO_BITS256:
+        case IDC_RADIO_BITS512:
+            // Scientific functions, angle mode, number base and word size are engine keys
+            processButtonClick(LOWORD(wParam));
             break;
 
         case IDCANCEL:
@@ -1804,25 +1639,10 @@ BOOL CALLBACK scientificDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARA
  */
 void resetCalculatorState(void)
 {
-    // Reset numeric values
-    memset(calcState.accumulatedValue, 0, sizeof(calcState.accumulatedValue));
-    calcState.currentValueHighPart = 0;
-    calcState.lastValue = 0;
-    calcState.memoryRegister[0] = 0;
-    calcState.memoryRegister[1] = 0;
-
-    // Clear error state
-    calcState.errorState = 0;
-    calcState.errorCodeBase = 0;
-
-    // Reset to standard mode and decimal base
-    calcState.mode = STANDARD_MODE;
-    calcState.numberBase = 10;
-
-    // Reset key pressed and pending operations
-    calcState.keyPressed = INVALID_BUTTON;
-    calcState.hasOperatorPending = FALSE;
-    calcState.isInputModeActive = FALSE;
+    // Reset numeric values, error state, mode, base and pending operations
+    freeEngine(&calcState.engine);
+    initEngine(&calcState.engine);
+    adjustMemoryAllocation();
 
     // Reset UI-related fields
     calcState.currentBackgroundColor = GetSysColor(COLOR_WINDOW);
@@ -1830,7 +1650,6 @@ void resetCalculatorState(void)
     calcState.buttonHorizontalSpacing = BUTTON_BASE_SIZE;
 
     // Reset decimal separator
-    calcState.decimalSeparator = '.';
     calcState.decimalSeparatorBuffer[0] = '.';
     calcState.decimalSeparatorBuffer[1] = '\0';
 
@@ -1840,6 +1659,7 @@ void resetCalculatorState(void)
     calcState.modeText[STANDARD_MODE] = "Standard";
     calcState.modeText[SCIENTIFIC_MODE] = "Scientific";
     strcpy_s(calcState.helpFilePath, MAX_PATH, "calc.hlp");
+    applyQuantileAccuracy();
 
     // Reset default precision
     calcState.defaultPrecisionValue = 0;
@@ -1908,7 +1728,7 @@ void toggleScientificMode(void)
  *
  * Remarks:
  *     - The function first locates the button in the windowStateTable to determine its
- *       visibility and position based on the current calculator mode (calcState.mode).
+ *       visibility and position based on the current calculator mode (calcState.engine.mode).
  *     - If the button is visible in the current mode, the function calculates the button's
  *       position and dimensions on the screen, taking into account the button spacing,
  *       margins, and the current mode's layout.
@@ -1945,11 +1765,11 @@ void updateButtonState(uint buttonId, int state)
     for (int i = 0; i < sizeof(windowStateTable) / sizeof(windowStateTable[0]); i++)
     {
         if ((windowStateTable[i] & 0x7FFF) == buttonId &&
-            ((windowStateTable[i] >> 15) != calcState.mode))
+            ((windowStateTable[i] >> 15) != calcState.engine.mode))
         {
             break;
         }
-        if ((windowStateTable[i] >> 15) != calcState.mode) {
+        if ((windowStateTable[i] >> 15) != calcState.engine.mode) {
             visibleButtonCount++;
         }
         buttonIndex++;
@@ -1966,7 +1786,7 @@ void updateButtonState(uint buttonId, int state)
     int buttonX, buttonY, buttonWidth, buttonHeight;
     int buttonsPerRow;
 
-    if (calcState.mode == STANDARD_MODE) {
+    if (calcState.engine.mode == STANDARD_MODE) {
         buttonsPerRow = STANDARD_CALC_COLS;
         totalButtons = (sizeof(BUTTON_ID_MAP_STANDARD) / sizeof(DWORD));
     }
@@ -1977,7 +1797,7 @@ void updateButtonState(uint buttonId, int state)
 
     // Determine button dimensions
     buttonWidth = BUTTON_BASE_SIZE +
-        (calcState.mode == SCIENTIFIC_MODE ? SCIENTIFIC_BUTTON_EXTRA_WIDTH : 0);
+        (calcState.engine.mode == SCIENTIFIC_MODE ? SCIENTIFIC_BUTTON_EXTRA_WIDTH : 0);
     buttonHeight = BUTTON_BASE_SIZE;
 
     if (visibleButtonCount < totalButtons - 3)
@@ -2000,7 +1820,7 @@ void updateButtonState(uint buttonId, int state)
             HORIZONTAL_MARGIN - 8; // Adjusted for visual consistency 
 
         if (visibleButtonCount == 0x53) { // Special case for a specific button 
-            buttonX -= (calcState.mode == STANDARD_MODE ? 2 : 1);
+            buttonX -= (calcState.engine.mode == STANDARD_MODE ? 2 : 1);
         }
 
         buttonY = VERTICAL_MARGIN;
@@ -2058,14 +1878,14 @@ void updateDecimalSeparator()
 
     separatorPosition = calcState.decimalSeparatorBuffer[0];
     if (separatorPosition == 0) {
-        if (calcState.currentValueHighPart == 0) {
+        if (calcState.engine.currentValueHighPart == 0) {
             separatorPosition = 2;
         }
         else {
-            separatorPosition = calcState.currentValueHighPart + 1;
+            separatorPosition = calcState.engine.currentValueHighPart + 1;
         }
     }
-    calcState.decimalSeparator = calcState.decimalSeparatorBuffer[0];
+    calcState.engine.decimalSeparator = calcState.decimalSeparatorBuffer[0];
     calcState.decimalSeparatorBuffer[1] = '\0';
 }
 
@@ -2085,88 +1905,382 @@ void updateDecimalSeparator()
  *     None.
  *
  * Remarks:
- *     - This function checks the calcState.isInputModeActive flag to determine if the
+ *     - The text itself comes from getDisplayString() in engine.c, which
+ *       returns an error status when a recalled value cannot be shown in a
+ *       non-decimal base (a NaN or an infinity); the error is then reported instead.
+ *     - This function checks the calcState.engine.isInputModeActive flag to determine if the
  *       calculator is currently accepting numeric input or if it should display
  *       the result of a calculation or function.
- *     - If in input mode (calcState.isInputModeActive is TRUE), the function displays
- *       the current contents of calcState.accumulatedValue directly, assuming it's in the
+ *     - If in input mode (calcState.engine.isInputModeActive is TRUE), the function displays
+ *       the current contents of calcState.engine.accumulatedValue directly, assuming it's in the
  *       correct format for the selected number base.
- *     - If not in input mode (calcState.isInputModeActive is FALSE), the function formats the
- *       calculated result (calcState.accumulatedValue and calcState.currentValueHighPart)
+ *     - If not in input mode (calcState.engine.isInputModeActive is FALSE), the function formats the
+ *       calculated result (calcState.engine.currentValue and calcState.engine.currentValueHighPart)
  *       according to the current numberBase:
  *         - Decimal (base 10):
- *           - Uses formatNumberForDisplay() to format the number.
- *           - If scientific notation is enabled (calcState.mode == SCIENTIFIC_NOTATION)
- *             and the number has no fractional part, it calls formatScientificNotation()
- *             to display the result in scientific notation.
- *           - Otherwise, it calls formatFloatAutomatically() for normal decimal display.
+ *           - Uses formatValue() to round the number to MAX_DECIMAL_DIGITS digits.
+ *           - If scientific notation is enabled (calcState.engine.mode == SCIENTIFIC_NOTATION)
+ *             and the number has no fractional part, it uses the scientific layout
+ *             with the user's decimal separator.
+ *           - Otherwise, it uses the "%g" layout and formatFloatAutomatically().
  *         - Non-Decimal Bases (2, 8, 16):
- *           - Calls processFloatingPointForDisplay() to convert the floating-point result
- *             to a displayable string in the selected base.
- *           - Checks for potential overflow and displays an error message if necessary.
- *           - Uses intToBaseString() to convert the integer part of the result to the
- *             selected number base.
- *           - Converts the resulting string to uppercase using CharUpperA() for
- *             hexadecimal digits.
+ *           - Uses fixedIntToString() to write the bit pattern of the result at the
+ *             selected word size (8 to 512 bits), hexadecimal digits in upper case.
+ *           - A decimal result wider than the word, just switched to the base, is
+ *             written whole by bigBaseToString() instead, as '-' and its magnitude;
+ *             getDisplaySize() tells how large a buffer that takes.
  *     - The final formatted string is displayed in the calculator's display control
- *       using SetDlgItemTextA(). The control ID is determined based on calcState.mode
+ *       using SetDlgItemTextA(). The control ID is determined based on calcState.engine.mode
  *       and the appropriate constants (IDC_TEXT_STANDARD_MODE,
  *       IDC_TEXT_SCIENTIFIC_MODE).
  */
 void updateDisplay(void)
 {
     char displayBuffer[MAX_DISPLAY_DIGITS];
-    char* displayString;
+    size_t displaySize = getDisplaySize(&calcState.engine);
+    char* display = (displaySize > sizeof(displayBuffer)) ? allocateMemoryFromHeap(displaySize) : displayBuffer;
 
-    if (calcState.isInputModeActive == 0) {
-        if (calcState.numberBase == 10) {
-            formatNumberForDisplay(displayBuffer, calcState.accumulatedValue, MAX_DECIMAL_DIGITS);
-            if ((calcState.mode == SCIENTIFIC_NOTATION) && (calcState.currentValueHighPart == 0)) {
-                formatScientificNotation(displayBuffer, displayBuffer);
-            }
-            else {
-                formatFloatAutomatically(displayBuffer, displayBuffer);
-            }
-            displayString = displayBuffer;
+    if (display == NULL) {
+        handleCalculationError(STATUS_INSUFFICIENT_MEMORY);
+        return;
+    }
+    int status = getDisplayString(&calcState.engine, display, displaySize);
+    if (status != STATUS_SUCCESS) {
+        handleCalculationError(status);
+    }
+    else {
+        SetDlgItemTextA(calcState.windowHandle,
+            (uint)calcState.engine.mode * 2 + IDC_TEXT_STANDARD_MODE, display);
+    }
+    if (display != displayBuffer) {
+        freeMemoryToHeap(display);
+    }
+}
+
+
+/*
+ * toggleStatisticsWindow
+ *
+ * This function toggles the visibility of the statistics window. If the statistics
+ * window is currently closed, it creates and shows the window. If the window
+ * is open, it closes the window. The function also updates the
+ * calcState.statisticsWindowOpen flag to reflect the window's state.
+ *
+ * The function handles potential errors during dialog creation and displays
+ * an error message if necessary.
+ *
+ * @param buttonID  The resource ID of the dialog template for the statistics window.
+ */
+void toggleStatisticsWindow(UINT buttonID) {
+    if (calcState.statisticsWindowOpen) {
+        // Close the statistics window
+        DestroyWindow(calcState.statisticsWindow);
+        calcState.statisticsWindow = NULL;
+        calcState.statisticsWindowOpen = FALSE;
+    }
+    else {
+        // Create and show the statistics window
+        calcState.statisticsWindow = CreateDialogParamA(
+            calcState.appInstance,
+            MAKEINTRESOURCE(buttonID),
+            calcState.windowHandle,
+            statisticsWindowProc,
+            0);
+
+        if (calcState.statisticsWindow != NULL) {
+            ShowWindow(calcState.statisticsWindow, SW_SHOW);
+            calcState.statisticsWindowOpen = TRUE;
         }
         else {
-            processFloatingPointForDisplay(calcState.accumulatedValue, calcState.currentValueHighPart);
-            double value = atof(calcState.accumulatedValue);
-            if (fabs(value) > MAX_INT) {
-                handleCalculationError((uint)(value < 0.0) * 2 + 3);
+            // Handle error creating the statistics window 
+            DWORD errorCode = GetLastError();
+            TCHAR errorMessage[100];
+            wsprintf(errorMessage, TEXT("Error creating statistics window: %d"), errorCode);
+            MessageBox(calcState.windowHandle, errorMessage, calcState.className, MB_OK | MB_ICONERROR);
+        }
+    }
+}
+
+/*
+ * parseAndStoreDataPoints
+ *
+ * Adds the numbers of a text (the clipboard, for the LOAD key) to the
+ * statistics, in the current number base. Numbers are separated by white
+ * space; anything that does not parse is skipped.
+ *
+ * @param text  The text to read, NUL-terminated.
+ */
+void parseAndStoreDataPoints(const char* text)
+{
+    char number[MAX_DISPLAY_DIGITS];
+    _calcValue value;
+
+    while (*text != '\0') {
+        size_t length = 0;
+
+        while (*text != '\0' && isspace((unsigned char)*text)) {
+            text++;
+        }
+        while (text[length] != '\0' && !isspace((unsigned char)text[length])) {
+            length++;
+        }
+        if (length > 0 && length < sizeof(number)) {
+            memcpy(number, text, length);
+            number[length] = '\0';
+            valueInit(&value);
+            if (valueFromString(&value, VALUE_TYPE_DOUBLE, number, calcState.engine.numberBase,
+                    calcState.engine.decimalSeparator, calcState.engine.precisionDigits) == STATUS_SUCCESS &&
+                statisticsAdd(&calcState.engine.statistics, valueToDouble(&value)) == STATUS_INSUFFICIENT_MEMORY) {
+                valueFree(&value);
+                handleCalculationError(STATUS_INSUFFICIENT_MEMORY);
                 return;
             }
+            valueFree(&value);
+        }
+        text += length;
+    }
+}
 
-            DWORD integerPartMask;
+/*
+ * loadDataFile
+ *
+ * Maps a file into memory and appends the numbers of every column to the
+ * statistics with dataLoadText, on all processors. Reports the rows, the
+ * skipped lines and the rows per second when done.
+ *
+ * With isRegression (Inv LOAD), each row is x values and then y instead:
+ * the last column is loaded as the data points, and the columns before it
+ * (up to MAX_REGRESSION_VARIABLES) are their x values for the regression.
+ *
+ * @param windowHandle  Handle to the statistics window dialog box.
+ * @param path          The file to load.
+ * @param isRegression  Whether the rows are x values and y.
+ */
+void loadDataFile(HWND windowHandle, const char* path, BOOL isRegression)
+{
+    _dataLoadOptions options = { calcState.engine.decimalSeparator, DATA_LOAD_ALL_COLUMNS, 0, 0 };
+    _dataLoadReport report;
+    LARGE_INTEGER fileSize;
+    char message[256];
+    int status = STATUS_INVALID_INPUT;
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        MessageBoxA(windowHandle, "Cannot open the data file", "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    if (GetFileSizeEx(file, &fileSize) && (ULONGLONG)fileSize.QuadPart <= (ULONGLONG)SIZE_MAX) {
+        HCURSOR cursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
 
-            switch (calcState.numberBase) {
-            case 2:  integerPartMask = INTEGER_PART_MASK_BINARY; break;
-            case 8:  integerPartMask = INTEGER_PART_MASK_OCTAL; break;
-            case 10: integerPartMask = INTEGER_PART_MASK_DECIMAL; break;
-            case 16: integerPartMask = INTEGER_PART_MASK_HEX; break;
-            default: integerPartMask = 0xFFFFFFFF;
+        if (fileSize.QuadPart == 0) {
+            status = dataLoadText(&calcState.engine.statistics, "", 0, &options, &report);
+        }
+        else {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            const char* text = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+            if (text != NULL && isRegression) {
+                int columns = dataLoadCountColumns(text, (size_t)fileSize.QuadPart, options.decimalSeparator);
+                if (columns >= 2) {
+                    options.column = (columns > MAX_REGRESSION_VARIABLES + 1) ? MAX_REGRESSION_VARIABLES : columns - 1;
+                    options.regressors = options.column;
+                }
+            }
+            if (text != NULL) {
+                status = dataLoadText(&calcState.engine.statistics, text, (size_t)fileSize.QuadPart, &options,
+                    &report);
+                UnmapViewOfFile(text);
+            }
+            else {
+                status = STATUS_INSUFFICIENT_MEMORY;
             }
+            if (mapping != NULL) {
+                CloseHandle(mapping);
+            }
+        }
+        SetCursor(cursor);
+    }
+    CloseHandle(file);
+
+    updateStatisticsDisplay(windowHandle);
+    if (status != STATUS_SUCCESS) {
+        handleCalculationError(status);
+        return;
+    }
+    snprintf(message, sizeof(message),
+        "%zu rows (%zu data points) loaded in %.2f s, %.0f rows/s.\n%zu malformed lines skipped.", report.rows,
+        report.points, report.seconds, (report.seconds > 0.0) ? (double)report.rows / report.seconds : 0.0,
+        report.skippedLines);
+    MessageBoxA(windowHandle, message, "Statistics", MB_OK | MB_ICONINFORMATION);
+}
 
-            intToBaseString((uint)__ftol(value) & integerPartMask, displayBuffer, calcState.numberBase);
-            CharUpperA(displayBuffer);
-            displayString = displayBuffer;
+/*
+ * performStatisticalCalculation
+ *
+ * Routes a statistics key pressed in the main window (RET, LOAD, CD,
+ * CAD) to the open statistics window, as if it had been clicked there.
+ *
+ * @param keyPressed  IDC_BUTTON_STAT_RED .. IDC_BUTTON_STAT_CAD.
+ */
+void performStatisticalCalculation(DWORD keyPressed)
+{
+    SendMessage(calcState.statisticsWindow, WM_COMMAND, MAKEWPARAM(keyPressed, BN_CLICKED), 0);
+}
+
+/*
+ * updateQuantileDisplay
+ *
+ * Shows the count, quartiles and 99th percentile of the data points on
+ * the line below the list box. Up to MAX_EXACT_QUANTILE_POINTS points,
+ * the values are exact: the engine keeps the points sorted, so a new or
+ * removed point costs a binary search and a move. Beyond that, or if
+ * there is no memory for the sorted copy, they come from the quantile
+ * sketch and the line says so.
+ *
+ * @param windowHandle  Handle to the statistics window dialog box.
+ */
+void updateQuantileDisplay(HWND windowHandle)
+{
+    static const double FRACTIONS[] = { 0.25, 0.5, 0.75, 0.99 };
+    _statistics* statistics = &calcState.engine.statistics;
+    char quantiles[sizeof(FRACTIONS) / sizeof(FRACTIONS[0])][MAX_DISPLAY_DIGITS];
+    char text[5 * MAX_DISPLAY_DIGITS + 48];
+    BOOL isExact = (statistics->count <= MAX_EXACT_QUANTILE_POINTS &&
+        statisticsSortPoints(statistics) == STATUS_SUCCESS);
+
+    if (statistics->count == 0) {
+        SetDlgItemTextA(windowHandle, IDC_STATISTICS_QUANTILES, "n=0");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(FRACTIONS) / sizeof(FRACTIONS[0]); i++) {
+        double quantile;
+        int status = isExact ? statisticsGetExactQuantile(statistics, FRACTIONS[i], &quantile)
+                             : statisticsGetQuantile(statistics, FRACTIONS[i], &quantile);
+        if (status == STATUS_SUCCESS) {
+            formatDouble(quantiles[i], sizeof(quantiles[i]), quantile, NUMBER_LAYOUT_AUTOMATIC, QUANTILE_DIGITS,
+                calcState.engine.decimalSeparator);
+        }
+        else {
+            strcpy_s(quantiles[i], sizeof(quantiles[i]), "-");
         }
     }
+    snprintf(text, sizeof(text), "n=%zu  Q1 %s  Med %s  Q3 %s  p99 %s%s", statistics->count, quantiles[0],
+        quantiles[1], quantiles[2], quantiles[3], isExact ? "" : "  (est.)");
+    SetDlgItemTextA(windowHandle, IDC_STATISTICS_QUANTILES, text);
+}
+
+/*
+ * updateRegressionDisplay
+ *
+ * Shows the least-squares fit of the points entered with x values (Inv
+ * Dat before Dat, or Inv LOAD) on the last line: the line and r and r^2
+ * for one x, the intercept, the slopes and R^2 for several. The engine
+ * keeps the fit up to date as points come and go, so this is O(1).
+ *
+ * @param windowHandle  Handle to the statistics window dialog box.
+ */
+void updateRegressionDisplay(HWND windowHandle)
+{
+    _statistics* statistics = &calcState.engine.statistics;
+    _regression* regression = &statistics->regression;
+    double coefficients[REGRESSION_COLUMNS];
+    char numbers[REGRESSION_COLUMNS + 1][MAX_DISPLAY_DIGITS];
+    char text[(REGRESSION_COLUMNS + 1) * (MAX_DISPLAY_DIGITS + 8) + 32];
+    double correlation, determination;
+
+    if (regression->count == 0) {
+        if (statistics->regressorCount > 0) {
+            snprintf(text, sizeof(text), "x%zu entered; Dat enters y", statistics->regressorCount);
+        }
+        else {
+            text[0] = '\0';
+        }
+        SetDlgItemTextA(windowHandle, IDC_STATISTICS_REGRESSION, text);
+        return;
+    }
+    if (regressionGetCoefficients(regression, coefficients) != STATUS_SUCCESS) {
+        snprintf(text, sizeof(text), "Fit of %zu rows: undefined", regression->count);
+        SetDlgItemTextA(windowHandle, IDC_STATISTICS_REGRESSION, text);
+        return;
+    }
+
+    for (size_t i = 0; i <= regression->variables; i++) {
+        formatDouble(numbers[i], sizeof(numbers[i]), coefficients[i], NUMBER_LAYOUT_AUTOMATIC, REGRESSION_DIGITS,
+            calcState.engine.decimalSeparator);
+    }
+    if (regression->variables == 1) {
+        char rText[MAX_DISPLAY_DIGITS] = "-", rSquaredText[MAX_DISPLAY_DIGITS] = "-";
+        if (regressionGetCorrelation(regression, &correlation) == STATUS_SUCCESS) {
+            formatDouble(rText, sizeof(rText), correlation, NUMBER_LAYOUT_AUTOMATIC, REGRESSION_DIGITS,
+                calcState.engine.decimalSeparator);
+            formatDouble(rSquaredText, sizeof(rSquaredText), correlation * correlation, NUMBER_LAYOUT_AUTOMATIC,
+                REGRESSION_DIGITS, calcState.engine.decimalSeparator);
+        }
+        snprintf(text, sizeof(text), "y = %s + %s x  r %s  r^2 %s", numbers[0], numbers[1], rText, rSquaredText);
+    }
     else {
-        displayString = (calcState.numberBase == 10) ? calcState.accumulatedValue : displayBuffer;
+        size_t length = (size_t)snprintf(text, sizeof(text), "y = %s", numbers[0]);
+        for (size_t i = 1; i <= regression->variables && length < sizeof(text); i++) {
+            length += (size_t)snprintf(text + length, sizeof(text) - length, " + %s x%zu", numbers[i], i);
+        }
+        if (length < sizeof(text) && regressionGetDetermination(regression, &determination) == STATUS_SUCCESS) {
+            formatDouble(numbers[0], sizeof(numbers[0]), determination, NUMBER_LAYOUT_AUTOMATIC, REGRESSION_DIGITS,
+                calcState.engine.decimalSeparator);
+            snprintf(text + length, sizeof(text) - length, "  R^2 %s", numbers[0]);
+        }
     }
-    SetDlgItemTextA(calcState.windowHandle,
-        (uint)calcState.mode * 2 + IDC_TEXT_STANDARD_MODE, displayString);
+    SetDlgItemTextA(windowHandle, IDC_STATISTICS_REGRESSION, text);
 }
 
+/*
+ * updateStatisticsDisplay
+ *
+ * Brings the list box of the statistics window in line with the data
+ * points in calcState.engine.statistics, which the list box only shows.
+ * Points are only ever appended or removed from the end, so the update
+ * adds or deletes just the strings that changed. Only the first
+ * MAX_LISTED_POINTS points are listed.
+ *
+ * @param windowHandle  Handle to the statistics window dialog box.
+ */
+void updateStatisticsDisplay(HWND windowHandle)
+{
+    const _statistics* statistics = &calcState.engine.statistics;
+    HWND listBox = GetDlgItem(windowHandle, IDC_BUTTON_STA);
+    char text[MAX_DISPLAY_DIGITS];
+
+    if (listBox == NULL) {
+        return;
+    }
+    updateQuantileDisplay(windowHandle);
+    updateRegressionDisplay(windowHandle);
+    if (statistics->count == 0) {
+        SendMessage(listBox, LB_RESETCONTENT, 0, 0);
+        return;
+    }
+
+    LRESULT items = SendMessage(listBox, LB_GETCOUNT, 0, 0);
+    size_t shown = (items > 0) ? (size_t)items : 0;
+    size_t listed = (statistics->count < MAX_LISTED_POINTS) ? statistics->count : MAX_LISTED_POINTS;
+
+    while (shown > listed) {
+        SendMessage(listBox, LB_DELETESTRING, --shown, 0);
+    }
+    for (; shown < listed; shown++) {
+        formatDouble(text, sizeof(text), statistics->points[shown], NUMBER_LAYOUT_AUTOMATIC, MAX_DECIMAL_DIGITS,
+            calcState.engine.decimalSeparator);
+        SendMessage(listBox, LB_ADDSTRING, 0, (LPARAM)text);
+    }
+}
 
 /*
  * statisticsWindowProc
  *
  * This is the dialog box procedure for the statistics window. It handles
  * messages for the window, including button clicks, closing the window,
- * and potentially other events. It interacts with the main calculator
- * state (`calcState`) and the statistics data structure.
+ * and potentially other events. The data points belong to the engine
+ * (calcState.engine.statistics); the list box only shows them and is
+ * refreshed with updateStatisticsDisplay after every change.
  *
  * @param window        Handle to the statistics window dialog box.
  * @param message     The message identifier.
@@ -2177,12 +2291,29 @@ void updateDisplay(void)
 BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam) {
     static HWND hwndStatisticsDisplay;
     static int  selectedIndex = -1;
-    static char selectedDataPointStr[MAX_DISPLAY_DIGITS] = { 0 };
-    static int dataPointCount = 0;
+    _statistics* statistics = &calcState.engine.statistics;
 
     switch (message) {
     case WM_INITDIALOG: {
         hwndStatisticsDisplay = GetDlgItem(windowHandle, IDC_BUTTON_STA);
+        SendMessage(hwndStatisticsDisplay, LB_RESETCONTENT, 0, 0);
+
+        // The dialog template has no room for the quantiles and the fit, so the window grows by two lines
+        RECT clientRect, windowRect;
+        int lineHeight = HIWORD(GetDialogBaseUnits()) + 4;
+        GetClientRect(windowHandle, &clientRect);
+        GetWindowRect(windowHandle, &windowRect);
+        SetWindowPos(windowHandle, NULL, 0, 0, windowRect.right - windowRect.left,
+            windowRect.bottom - windowRect.top + 2 * lineHeight, SWP_NOMOVE | SWP_NOZORDER);
+        HWND quantileLine = CreateWindowA("STATIC", "", WS_CHILD | WS_VISIBLE | SS_LEFT, 4, clientRect.bottom,
+            clientRect.right - 8, lineHeight, windowHandle, (HMENU)IDC_STATISTICS_QUANTILES, calcState.appInstance,
+            NULL);
+        SendMessage(quantileLine, WM_SETFONT, SendMessage(windowHandle, WM_GETFONT, 0, 0), TRUE);
+        HWND regressionLine = CreateWindowA("STATIC", "", WS_CHILD | WS_VISIBLE | SS_LEFT, 4,
+            clientRect.bottom + lineHeight, clientRect.right - 8, lineHeight, windowHandle,
+            (HMENU)IDC_STATISTICS_REGRESSION, calcState.appInstance, NULL);
+        SendMessage(regressionLine, WM_SETFONT, SendMessage(windowHandle, WM_GETFONT, 0, 0), TRUE);
+
         updateStatisticsDisplay(windowHandle);
         return TRUE;
     }
@@ -2191,8 +2322,7 @@ BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wPara
         switch (LOWORD(wParam)) {
         case IDC_BUTTON_STAT_RED: {
             if (selectedIndex != -1) {
-                errno_t err = strcpy_s(calcState.accumulatedValue, sizeof(calcState.accumulatedValue), selectedDataPointStr);
-                if (err == 0) {
+                if (setEngineDataPoint(&calcState.engine, (size_t)selectedIndex) == STATUS_SUCCESS) {
                     updateDisplay();
                 }
                 else {
@@ -2206,8 +2336,16 @@ BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wPara
         }
 
         case IDC_BUTTON_STAT_LOAD: {
+            // A file copied in Explorer is loaded whole; otherwise the clipboard text is read
             if (OpenClipboard(windowHandle)) {
-                HANDLE clipboardData = GetClipboardData(CF_TEXT);
+                HANDLE clipboardData = GetClipboardData(CF_HDROP);
+                char path[MAX_PATH];
+                if (clipboardData != NULL && DragQueryFileA((HDROP)clipboardData, 0, path, sizeof(path)) > 0) {
+                    CloseClipboard();
+                    loadDataFile(windowHandle, path, calcState.engine.isInverseMode);
+                    break;
+                }
+                clipboardData = GetClipboardData(CF_TEXT);
                 if (clipboardData != NULL) {
                     char* clipboardText = (char*)GlobalLock(clipboardData);
                     if (clipboardText) {
@@ -2222,16 +2360,18 @@ BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wPara
         }
 
         case IDC_BUTTON_STAT_CE:
-            if (dataPointCount > 0) {
-                dataPointCount--;
-                SendMessage(hwndStatisticsDisplay, LB_DELETESTRING, dataPointCount, 0);
+            if (statistics->count > 0) {
+                statisticsRemove(statistics, statistics->count - 1);
+                if (selectedIndex >= (int)statistics->count) {
+                    selectedIndex = -1;
+                }
                 updateStatisticsDisplay(windowHandle);
             }
             break;
 
         case IDC_BUTTON_STAT_CAD:
-            dataPointCount = 0;
-            SendMessage(hwndStatisticsDisplay, LB_RESETCONTENT, 0, 0);
+            statisticsClear(statistics);
+            selectedIndex = -1;
             updateStatisticsDisplay(windowHandle);
             break;
         }
@@ -2248,12 +2388,7 @@ BOOL CALLBACK statisticsWindowProc(HWND windowHandle, UINT message, WPARAM wPara
         int yPos = GET_Y_LPARAM(lParam);
 
         selectedIndex = SendMessage(hwndStatisticsDisplay, LB_ITEMFROMPOINT, 0, MAKELONG(xPos, yPos));
-        if (selectedIndex != LB_ERR && selectedIndex < dataPointCount) {
-            if (SendMessage(hwndStatisticsDisplay, LB_GETTEXT, selectedIndex, (LPARAM)selectedDataPointStr) == LB_ERR) {
-                selectedIndex = -1;
-            }
-        }
-        else {
+        if (selectedIndex == LB_ERR || selectedIndex >= (int)statistics->count) {
             selectedIndex = -1;
         }
         break;
@@ -1,128 +1,1120 @@
-#include "..//headers//memory.h"
+/*-----------------------------------------------------------------------------
+    memory.c --  Segregated free-list heap of the calculator engine
+                 (reconstructed code).
+
+               The first heap kept all blocks in one list, walked it for
+               the first block that fit and split it, with 32-bit
+               offsets for addresses. This one keeps a free list per
+               power-of-two size class, so nothing is ever searched:
+
+               - Class c holds blocks of 16 << c bytes. A request goes to
+                 the smallest class that holds it, found with a bit scan.
+               - All system memory is taken in chunks aligned to
+                 HEAP_CHUNK_SIZE, whose first CHUNK_HEADER_SIZE bytes
+                 describe the chunk. Masking the address of a block finds
+                 its chunk, and so its class: blocks carry no header.
+               - A small class cuts its blocks in turn from chunks of its
+                 own, each block at a multiple of its size from the chunk
+                 start, so blocks of 64 bytes or more start on a cache
+                 line. Freed small blocks are kept for reuse.
+               - A large block is a chunk of its own, after the header. A
+                 few of each class are kept for reuse after a free; the
+                 rest, and all huge blocks, go back to the system.
+               - The free lists belong to the thread, which needs no
+                 lock. When a thread ends, its lists go to a shared
+                 depot, from which the next thread short of a class
+                 takes them.
+               - An arena chunk has a header in each of its 64 KB
+                 segments, so masking works there too, and the header
+                 marks its blocks as arena memory that a free leaves
+                 alone. Each arena block is preceded by its size, for
+                 reallocation.
+               - A chunk of HEAP_HUGE_PAGE_SIZE bytes or more is aligned
+                 to a huge page and advised for transparent huge pages,
+                 or mapped from the huge page pool on request, so that
+                 big limb arrays miss the TLB less. releaseHeapMemory
+                 advises the pages of cached large blocks away but keeps
+                 the mappings, header page included.
+               - With HEAP_STATISTICS, the counters live next to the free
+                 lists of the thread, so counting takes no lock either.
+                 An ending thread adds its counters to those of the
+                 depot. installHeapStatisticsDump writes them as JSON at
+                 exit, and on SIGUSR1 where there are POSIX signals.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS under a strict -std=c11
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//memory.h"
+#include ".//headers//wideint.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define HEAP_THREADS 1
+#define THREAD_LOCAL _Thread_local
+#else
+#define HEAP_THREADS 0
+#define THREAD_LOCAL
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define HEAP_MMAP 1
+#else
+#define HEAP_MMAP 0
+#endif
+
+#if HEAP_MMAP && defined(MADV_HUGEPAGE) && defined(MAP_HUGETLB)
+#define HEAP_HUGE_PAGES 1
+#else
+#define HEAP_HUGE_PAGES 0
+#endif
+
+#if HEAP_STATISTICS && (defined(__unix__) || defined(__APPLE__))
+#include <fcntl.h>
+#include <signal.h>
+#define HEAP_DUMP_SIGNAL SIGUSR1
+#endif
+
+#define MIN_CLASS_SHIFT 4              // Class 0 holds HEAP_ALIGNMENT bytes
+#define SMALL_CLASSES 9                // Classes cut from shared chunks
+#define HEAP_CLASSES 23                // Classes kept for reuse
+#define HUGE_CLASS HEAP_CLASSES        // Class of a block beyond HEAP_MAX_LARGE_BLOCK
+#define ARENA_CLASS (HEAP_CLASSES + 1) // Class of the segments of an arena chunk
+#define ARENA_BLOCK_PREFIX HEAP_ALIGNMENT  // Holds the size of an arena block
+#define CHUNK_HEADER_SIZE 64
+#define MAX_CACHED_LARGE_BYTES 0x1000000  // Freed large blocks kept per class and thread (16 MB)
+#define MAX_DUMP_PATH 512
+#define MAX_DUMP_TEXT 2048
+
+_Static_assert(HEAP_ALIGNMENT == 1 << MIN_CLASS_SHIFT, "class 0 must hold HEAP_ALIGNMENT bytes");
+_Static_assert(HEAP_MAX_SMALL_BLOCK == HEAP_ALIGNMENT << (SMALL_CLASSES - 1), "HEAP_MAX_SMALL_BLOCK");
+_Static_assert(HEAP_MAX_LARGE_BLOCK == HEAP_ALIGNMENT << (HEAP_CLASSES - 1), "HEAP_MAX_LARGE_BLOCK");
+_Static_assert(HEAP_MAX_ALIGNMENT <= CHUNK_HEADER_SIZE, "large blocks follow the chunk header");
+_Static_assert(HEAP_MAX_ARENA_BLOCK + ARENA_BLOCK_PREFIX <= HEAP_CHUNK_SIZE - CHUNK_HEADER_SIZE,
+    "an arena block must fit a segment");
+_Static_assert(HEAP_CLASSES == HEAP_SIZE_CLASSES && HUGE_CLASS == HEAP_HISTOGRAM_HUGE &&
+    ARENA_CLASS == HEAP_HISTOGRAM_ARENA, "histogram entries follow the classes");
+
+// At the start of every chunk
+typedef struct {
+    void* allocation;   // What the system returned, when that is not the chunk
+    size_t size;        // Bytes from the start of the chunk
+    int sizeClass;
+    void* nextChunk;    // Next chunk of an arena
+    size_t pageSize;    // Page size of a mapping from the huge page pool, else 0
+} _heapChunk;
+
+_Static_assert(sizeof(_heapChunk) <= CHUNK_HEADER_SIZE, "the header must fit CHUNK_HEADER_SIZE");
+
+typedef struct _heapBlock {
+    struct _heapBlock* next;
+} _heapBlock;
+
+typedef struct {
+    _heapBlock* head;
+    _heapBlock* tail;   // Last block, while head is not NULL
+    size_t count;
+} _heapList;
+
+// Counts of one thread; allocation and free update different fields, so they do not wait on each other
+typedef struct {
+    uint64_t histogram[HEAP_HISTOGRAM_SIZE];
+    uint64_t freeCount;
+    int64_t allocatedBytes;
+    int64_t freedBytes;
+    int64_t peakBytesInUse;
+    int64_t systemBytes;
+} _heapCounters;
+
+typedef struct {
+    _heapList lists[HEAP_CLASSES];
+    char* next[SMALL_CLASSES];     // Next block to cut from the current chunk of each small class
+    char* end[SMALL_CLASSES];
+    bool isRegistered;             // The depot gets the lists when the thread ends
+#if HEAP_STATISTICS
+    _heapCounters counters;        // Counts of the thread
+#endif
+} _heapCache;
+
+static THREAD_LOCAL _heapCache threadCache;
+static THREAD_LOCAL _memoryArena* currentArena;  // Serves the small requests of the thread
+
+#if HEAP_THREADS
+static _heapList depot[HEAP_CLASSES];
+static mtx_t depotLock;
+static tss_t cacheKey;
+static once_flag depotOnce = ONCE_FLAG_INIT;
+static bool isDepotReady;
+#if HEAP_STATISTICS
+static _heapCounters depotCounters;  // Counts of the threads that ended
+#endif
+#endif
+
+#if HEAP_STATISTICS
+static char dumpPath[MAX_DUMP_PATH];
+#endif
+
+static _heapPageMode heapPageMode = HEAP_PAGES_TRANSPARENT;
+
+static size_t getClassSize(int sizeClass)
+{
+    return (size_t)1 << (sizeClass + MIN_CLASS_SHIFT);
+}
+
+// Smallest class that holds size bytes; size must not exceed HEAP_MAX_LARGE_BLOCK
+static int getSizeClass(size_t size)
+{
+    if (size <= HEAP_ALIGNMENT) {
+        return 0;
+    }
+    return 64 - countLeadingZeros64((uint64_t)(size - 1)) - MIN_CLASS_SHIFT;
+}
+
+static _heapChunk* getChunk(const void* memory)
+{
+    return (_heapChunk*)((uintptr_t)memory & ~(uintptr_t)(HEAP_CHUNK_SIZE - 1));
+}
+
+static void countAllocation(_heapCache* cache, int histogramEntry, size_t size)
+{
+#if HEAP_STATISTICS
+    _heapCounters* counters = &cache->counters;
+    counters->histogram[histogramEntry]++;
+    counters->allocatedBytes += (int64_t)size;
+    int64_t bytesInUse = counters->allocatedBytes - counters->freedBytes;
+    if (bytesInUse > counters->peakBytesInUse) {
+        counters->peakBytesInUse = bytesInUse;
+    }
+#else
+    (void)cache;
+    (void)histogramEntry;
+    (void)size;
+#endif
+}
+
+static void countFree(_heapCache* cache, size_t blockCount, size_t size)
+{
+#if HEAP_STATISTICS
+    cache->counters.freeCount += blockCount;
+    cache->counters.freedBytes += (int64_t)size;
+#else
+    (void)cache;
+    (void)blockCount;
+    (void)size;
+#endif
+}
+
+static void countSystemMemory(int64_t size)
+{
+#if HEAP_STATISTICS
+    threadCache.counters.systemBytes += size;
+#else
+    (void)size;
+#endif
+}
+
+#if HEAP_STATISTICS
+// Adds the counts of one thread to a total; the peak is the larger one
+static void addHeapCounters(_heapCounters* total, const _heapCounters* counters)
+{
+    total->freeCount += counters->freeCount;
+    total->allocatedBytes += counters->allocatedBytes;
+    total->freedBytes += counters->freedBytes;
+    total->systemBytes += counters->systemBytes;
+    if (counters->peakBytesInUse > total->peakBytesInUse) {
+        total->peakBytesInUse = counters->peakBytesInUse;
+    }
+    for (int i = 0; i < HEAP_HISTOGRAM_SIZE; i++) {
+        total->histogram[i] += counters->histogram[i];
+    }
+}
+#endif
+
+// Maps size bytes aligned to alignment; the pages are committed as they are first touched
+static _heapChunk* mapAlignedChunk(size_t size, size_t alignment)
+{
+    // One alignment more than needed leaves room to align the start
+    size_t reserved = size + alignment;
+#if HEAP_MMAP
+    char* memory = mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+#else
+    char* memory = malloc(reserved);
+    if (memory == NULL) {
+        return NULL;
+    }
+#endif
+    uintptr_t address = ((uintptr_t)memory + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    _heapChunk* chunk = (_heapChunk*)address;
+#if HEAP_MMAP
+    size_t head = (size_t)((char*)chunk - memory);
+    if (head > 0) {
+        munmap(memory, head);
+    }
+    munmap((char*)chunk + size, reserved - head - size);
+    chunk->allocation = chunk;
+#else
+    chunk->allocation = memory;
+#endif
+    chunk->pageSize = 0;
+    return chunk;
+}
+
+#if HEAP_HUGE_PAGES
+// Maps a chunk from the reserved huge page pool, rounding size up to whole huge pages
+static _heapChunk* mapHugeTlbChunk(size_t* size)
+{
+    size_t hugeSize = (*size + HEAP_HUGE_PAGE_SIZE - 1) & ~(size_t)(HEAP_HUGE_PAGE_SIZE - 1);
+    _heapChunk* chunk = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (chunk == MAP_FAILED) {
+        return NULL;
+    }
+    chunk->allocation = chunk;
+    chunk->pageSize = HEAP_HUGE_PAGE_SIZE;
+    *size = hugeSize;
+    return chunk;
+}
+#endif
 
 /*
- * allocateAdditionalMemory()
+ * allocateAdditionalMemory
  *
- * Purpose:
- *     Expands the calculator's custom heap when there is not enough contiguous
- *     space to accommodate a new memory allocation request. It attempts to
- *     reserve a new region of virtual memory and commit a portion of it
- *     to the heap.
+ * Takes a chunk of at least size bytes from the system, aligned to
+ * HEAP_CHUNK_SIZE, and writes its header. The pages are committed as
+ * they are first touched where the system maps memory. Unless the page
+ * mode is HEAP_PAGES_NORMAL, a chunk of HEAP_HUGE_PAGE_SIZE bytes or
+ * more is aligned to a huge page and advised to use them, or comes from
+ * the huge page pool in HEAP_PAGES_EXPLICIT mode while the pool lasts.
  *
- * Parameters:
- *     requestedSize: The size in bytes of the memory block that could not
- *                    be allocated from the existing heap. This value is used
- *                    to determine how much additional memory to allocate.
+ * @return  The chunk, or NULL.
+ */
+static _heapChunk* allocateAdditionalMemory(size_t size, int sizeClass)
+{
+    if (size > SIZE_MAX - 2 * HEAP_HUGE_PAGE_SIZE) {
+        return NULL;
+    }
+    size = (size + HEAP_CHUNK_SIZE - 1) & ~(size_t)(HEAP_CHUNK_SIZE - 1);
+
+    _heapChunk* chunk = NULL;
+#if HEAP_HUGE_PAGES
+    if (size >= HEAP_HUGE_PAGE_SIZE && heapPageMode != HEAP_PAGES_NORMAL) {
+        if (heapPageMode == HEAP_PAGES_EXPLICIT) {
+            chunk = mapHugeTlbChunk(&size);
+        }
+        if (chunk == NULL) {
+            chunk = mapAlignedChunk(size, HEAP_HUGE_PAGE_SIZE);
+            if (chunk != NULL) {
+                madvise(chunk, size, MADV_HUGEPAGE);
+            }
+        }
+    }
+#endif
+    if (chunk == NULL) {
+        chunk = mapAlignedChunk(size, HEAP_CHUNK_SIZE);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+    chunk->size = size;
+    chunk->sizeClass = sizeClass;
+    countSystemMemory((int64_t)size);
+    return chunk;
+}
+
+static void releaseChunk(_heapChunk* chunk)
+{
+    countSystemMemory(-(int64_t)chunk->size);
+#if HEAP_MMAP
+    munmap(chunk, chunk->size);
+#else
+    free(chunk->allocation);
+#endif
+}
+
+static void pushBlock(_heapList* list, void* memory)
+{
+    _heapBlock* block = memory;
+    block->next = list->head;
+    if (list->head == NULL) {
+        list->tail = block;
+    }
+    list->head = block;
+    list->count++;
+}
+
+#if HEAP_THREADS
+/*
+ * releaseThreadCache
  *
- * Return Value:
- *     int: 0 if the heap expansion was successful, -1 if it failed.
+ * Thread-specific storage destructor: hands the blocks of an ending
+ * thread, including what is left of its small chunks, to the depot.
+ */
+static void releaseThreadCache(void* argument)
+{
+    _heapCache* cache = argument;
+
+    for (int sizeClass = 0; sizeClass < SMALL_CLASSES; sizeClass++) {
+        for (char* block = cache->next[sizeClass]; block < cache->end[sizeClass]; block += getClassSize(sizeClass)) {
+            pushBlock(&cache->lists[sizeClass], block);
+        }
+    }
+
+    mtx_lock(&depotLock);
+    for (int sizeClass = 0; sizeClass < HEAP_CLASSES; sizeClass++) {
+        _heapList* list = &cache->lists[sizeClass];
+        if (list->head != NULL) {
+            list->tail->next = depot[sizeClass].head;
+            if (depot[sizeClass].head == NULL) {
+                depot[sizeClass].tail = list->tail;
+            }
+            depot[sizeClass].head = list->head;
+            depot[sizeClass].count += list->count;
+        }
+    }
+#if HEAP_STATISTICS
+    addHeapCounters(&depotCounters, &cache->counters);
+#endif
+    mtx_unlock(&depotLock);
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void initDepot(void)
+{
+    isDepotReady = (mtx_init(&depotLock, mtx_plain) == thrd_success &&
+        tss_create(&cacheKey, releaseThreadCache) == thrd_success);
+}
+#endif
+
+// Has the lists and counts of the thread handed to the depot when the thread ends
+static void registerThreadCache(_heapCache* cache)
+{
+#if HEAP_THREADS
+    if (!cache->isRegistered) {
+        call_once(&depotOnce, initDepot);
+        if (isDepotReady) {
+            tss_set(cacheKey, cache);
+        }
+        cache->isRegistered = true;
+    }
+#else
+    (void)cache;
+#endif
+}
+
+// Moves the blocks of a class in the depot to the empty list of the thread
+static bool takeFromDepot(_heapList* list, int sizeClass)
+{
+#if HEAP_THREADS
+    if (!isDepotReady) {
+        return false;
+    }
+    mtx_lock(&depotLock);
+    *list = depot[sizeClass];
+    depot[sizeClass].head = NULL;
+    depot[sizeClass].count = 0;
+    mtx_unlock(&depotLock);
+    return list->head != NULL;
+#else
+    (void)list;
+    (void)sizeClass;
+    return false;
+#endif
+}
+
+/*
+ * refillClass
  *
- * Remarks:
- *     - The function uses VirtualAlloc() to reserve a block of virtual memory.
- *     - If the reservation succeeds, the function calls allocateBufferForLargeNumbers()
- *       to commit (allocate) a portion of the reserved memory to the heap.
- *     - The `currentAllocationSize` variable keeps track of the current heap size.
- *     - If the initial allocation size (`currentAllocationSize`) is less than
- *       the minimum allocation size (`minimumAllocationSize`), the heap is
- *       doubled in size. Otherwise, it's expanded to fit the requested size.
- *     - If `VirtualAlloc()` fails, the function returns -1 to indicate an error.
+ * Allocates a block of a class whose free list is empty: from the depot,
+ * from the current chunk of a small class, or from a new chunk.
  */
-DWORD allocateAdditionalMemory(DWORD requestedSize)
+static void* refillClass(_heapCache* cache, int sizeClass)
 {
-    // Calculate aligned size based on page size (assuming 4KB pages)
-    uint alignedSize = (currentAllocationSize + 0xFFF) & 0xFFFFF000;
+    _heapList* list = &cache->lists[sizeClass];
 
-    // Double the allocation size if it's less than minimum
-    if (currentAllocationSize < minimumAllocationSize) {
-        currentAllocationSize *= 2;
+    registerThreadCache(cache);
+    if (takeFromDepot(list, sizeClass)) {
+        _heapBlock* block = list->head;
+        list->head = block->next;
+        list->count--;
+        return block;
     }
-    // If the aligned size is still less than requested, use requested size
-    if (alignedSize < requestedSize) {
-        alignedSize = requestedSize;
+
+    size_t size = getClassSize(sizeClass);
+    if (sizeClass >= SMALL_CLASSES) {
+        _heapChunk* chunk = allocateAdditionalMemory(CHUNK_HEADER_SIZE + size, sizeClass);
+        return (chunk != NULL) ? (char*)chunk + CHUNK_HEADER_SIZE : NULL;
     }
 
-    // Reserve virtual memory using VirtualAlloc()
-    LPVOID allocatedMemory = VirtualAlloc(NULL, alignedSize, MEM_RESERVE, PAGE_READWRITE);
+    if (cache->next[sizeClass] == cache->end[sizeClass]) {
+        _heapChunk* chunk = allocateAdditionalMemory(HEAP_CHUNK_SIZE, sizeClass);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        // The header takes the first block, or the first CHUNK_HEADER_SIZE bytes
+        cache->next[sizeClass] = (char*)chunk + ((size > CHUNK_HEADER_SIZE) ? size : CHUNK_HEADER_SIZE);
+        cache->end[sizeClass] = (char*)chunk + HEAP_CHUNK_SIZE;
+    }
+    void* block = cache->next[sizeClass];
+    cache->next[sizeClass] += size;
+    return block;
+}
 
-    if (allocatedMemory != NULL) {
-        // Memory reservation successful, commit a portion for the heap
-        int allocationResult = allocateBufferForLargeNumbers(0, requestedSize);
-        if (allocationResult == 0) {
-            // Committed memory successfully, return success 
-            return 0;
+// Allocates from the size classes, bypassing the arena of the thread
+static void* allocateFromClasses(size_t requestedSize)
+{
+    if (requestedSize > HEAP_MAX_LARGE_BLOCK) {
+        if (requestedSize > SIZE_MAX - CHUNK_HEADER_SIZE) {
+            return NULL;
+        }
+        _heapChunk* chunk = allocateAdditionalMemory(CHUNK_HEADER_SIZE + requestedSize, HUGE_CLASS);
+        if (chunk == NULL) {
+            return NULL;
         }
-        // If committing memory fails, free the reserved region
-        VirtualFree(allocatedMemory, 0, MEM_RELEASE);
+        registerThreadCache(&threadCache);
+        countAllocation(&threadCache, HUGE_CLASS, chunk->size - CHUNK_HEADER_SIZE);
+        return (char*)chunk + CHUNK_HEADER_SIZE;
     }
 
-    // Memory reservation failed or committing memory failed, return error
-    return -1;
+    int sizeClass = getSizeClass(requestedSize);
+    _heapCache* cache = &threadCache;
+    _heapList* list = &cache->lists[sizeClass];
+    _heapBlock* block = list->head;
+    if (block == NULL) {
+        block = refillClass(cache, sizeClass);
+        if (block == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        list->head = block->next;
+        list->count--;
+    }
+    countAllocation(cache, sizeClass, getClassSize(sizeClass));
+    return block;
 }
 
+/*
+ * allocateMemoryFromHeap
+ *
+ * Allocates a block of at least requestedSize bytes, aligned to
+ * HEAP_ALIGNMENT, from the arena the thread has selected if it is small
+ * enough. The contents are undefined.
+ *
+ * @return  The block, or NULL if the system has no memory left.
+ */
+void* allocateMemoryFromHeap(size_t requestedSize)
+{
+    _memoryArena* arena = currentArena;
+    if (arena != NULL && requestedSize <= HEAP_MAX_ARENA_BLOCK) {
+        void* block = allocateMemoryFromArena(arena, requestedSize);
+        if (block != NULL) {
+            return block;
+        }
+    }
+    return allocateFromClasses(requestedSize);
+}
 
 /*
- * allocateMemoryFromHeap()
+ * allocateAlignedMemoryFromHeap
  *
- * Purpose:
- *     Allocates a block of memory from the calculator's custom heap.
- *     This function manages a linked list of memory blocks and attempts to
- *     find a suitable free block. If no free block is large enough, it attempts
- *     to expand the heap.
+ * Allocates a block of at least requestedSize bytes aligned to alignment,
+ * a power of two up to HEAP_MAX_ALIGNMENT. Blocks of the size classes
+ * are aligned to their size up to a cache line, so this only rounds the
+ * size up; arena blocks only serve the default alignment.
  *
- * Parameters:
- *     requestedSize: The size in bytes of the memory block to allocate.
+ * @return  The block, or NULL.
+ */
+void* allocateAlignedMemoryFromHeap(size_t requestedSize, size_t alignment)
+{
+    if (alignment > HEAP_MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        return NULL;
+    }
+    if (alignment <= HEAP_ALIGNMENT) {
+        return allocateMemoryFromHeap(requestedSize);
+    }
+    return allocateFromClasses((requestedSize > alignment) ? requestedSize : alignment);
+}
+
+/*
+ * freeMemoryToHeap
  *
- * Return Value:
- *     int:  The address of the allocated memory block (which is an offset
- *           from the beginning of the custom heap), or 0 if the allocation fails.
+ * Returns a block from any of the allocation functions to the heap.
+ * memory may be NULL. Arena blocks stay until the arena is reset.
+ */
+void freeMemoryToHeap(void* memory)
+{
+    if (memory == NULL) {
+        return;
+    }
+
+    _heapChunk* chunk = getChunk(memory);
+    int sizeClass = chunk->sizeClass;
+    if (sizeClass == ARENA_CLASS) {
+        return;
+    }
+    _heapCache* cache = &threadCache;
+    if (sizeClass == HUGE_CLASS) {
+        countFree(cache, 1, chunk->size - CHUNK_HEADER_SIZE);
+        releaseChunk(chunk);
+        return;
+    }
+
+    countFree(cache, 1, getClassSize(sizeClass));
+    _heapList* list = &cache->lists[sizeClass];
+    if (sizeClass >= SMALL_CLASSES && list->count > 0 &&
+        (list->count + 1) * getClassSize(sizeClass) > MAX_CACHED_LARGE_BYTES) {
+        releaseChunk(chunk);
+        return;
+    }
+    if (list->head == NULL) {
+        registerThreadCache(cache);
+    }
+    pushBlock(list, memory);
+}
+
+/*
+ * getHeapBlockSize
  *
- * Remarks:
- *     - The function searches for a free block that is large enough to accommodate
- *       the requested size.
- *     - If a suitable block is found, it is marked as 'in use' and its address is returned.
- *     - If no suitable block is found, the function attempts to expand the heap
- *       by calling allocateAdditionalMemory().
- *     - If the heap expansion fails, the function calls handleMemoryAllocationError()
- *       to report the error.
+ * Bytes usable in a block, at least the size it was allocated with.
  */
-DWORD allocateMemoryFromHeap(DWORD requestedSize)
+size_t getHeapBlockSize(const void* memory)
 {
-    int** foundBlock;
-    int allocationResult;
+    const _heapChunk* chunk = getChunk(memory);
+    if (chunk->sizeClass == ARENA_CLASS) {
+        return *(const size_t*)((const char*)memory - ARENA_BLOCK_PREFIX);
+    }
+    if (chunk->sizeClass == HUGE_CLASS) {
+        return chunk->size - CHUNK_HEADER_SIZE;
+    }
+    return getClassSize(chunk->sizeClass);
+}
 
-    if (requestedSize < MAX_HEAP_ALLOCATION_SIZE) { // Use MAX_HEAP_ALLOCATION_SIZE
-        uint alignedSize = requestedSize + 3 & ALIGNMENT_MASK;  // Use ALIGNMENT_MASK
+/*
+ * reallocateMemoryFromHeap
+ *
+ * Resizes a block like realloc: a block that already holds requestedSize
+ * bytes is kept, otherwise the contents move to a larger one. memory may
+ * be NULL.
+ *
+ * @return  The block, or NULL (memory is then unchanged).
+ */
+void* reallocateMemoryFromHeap(void* memory, size_t requestedSize)
+{
+    if (memory == NULL) {
+        return allocateMemoryFromHeap(requestedSize);
+    }
 
-        do {
-            foundBlock = findAvailableMemoryBlock(alignedSize);
-            if (foundBlock != (int**)0x0) {
-                // Found a suitable block
-                if ((((*foundBlock)[1] & ALIGNMENT_MASK_UNSIGNED) -  // Use ALIGNMENT_MASK_UNSIGNED
-                    ((DWORD)foundBlock[1] & ALIGNMENT_MASK)) -
-                    alignedSize != 4)
-                {
-                    // Split the block if it's much larger than needed
-                    splitMemoryBlock(foundBlock, alignedSize);
-                }
-                foundBlock[1] = (int*)((uint)foundBlock[1] & ALIGNMENT_MASK); // Use ALIGNMENT_MASK
-                memoryBlockListHead = (void*)*foundBlock;
-                return ((DWORD)foundBlock[1] & ALIGNMENT_MASK) + 4; // Use ALIGNMENT_MASK
-            }
+    size_t blockSize = getHeapBlockSize(memory);
+    if (requestedSize <= blockSize) {
+        return memory;
+    }
+    void* block = allocateMemoryFromHeap(requestedSize);
+    if (block != NULL) {
+        memcpy(block, memory, blockSize);
+        freeMemoryToHeap(memory);
+    }
+    return block;
+}
 
-            // No suitable block found, try to allocate more memory
-            allocationResult = allocateAdditionalMemory(alignedSize);
-            if (allocationResult == -1) {
-                break;  // Allocation failed
-            }
+// Hands the pages of a cached large block after its first page back to the system
+static size_t adviseChunkAway(_heapChunk* chunk)
+{
+#if HEAP_MMAP
+    size_t pageSize = (chunk->pageSize != 0) ? chunk->pageSize : (size_t)sysconf(_SC_PAGESIZE);
+    if (chunk->size > pageSize && madvise((char*)chunk + pageSize, chunk->size - pageSize, MADV_DONTNEED) == 0) {
+        return chunk->size - pageSize;
+    }
+#else
+    (void)chunk;
+#endif
+    return 0;
+}
 
-            // Try to find a block again after allocation 
-            foundBlock = findAvailableMemoryBlock(alignedSize);
-            if (foundBlock == (int**)0x0) {
-                handleMemoryAllocationError();
-            }
+// Unmaps the blocks of a list, or advises their pages away; the first page holds the link
+static size_t trimList(_heapList* list, bool isUnmapped)
+{
+    size_t bytes = 0;
+    _heapBlock* block = list->head;
 
-        } while (allocationResult != -1); // Keep trying until allocation fails 
+    while (block != NULL) {
+        _heapBlock* next = block->next;
+        _heapChunk* chunk = getChunk(block);
+        if (isUnmapped) {
+            bytes += chunk->size;
+            releaseChunk(chunk);
+        }
+        else {
+            bytes += adviseChunkAway(chunk);
+        }
+        block = next;
+    }
+    if (isUnmapped) {
+        list->head = NULL;
+        list->tail = NULL;
+        list->count = 0;
+    }
+    return bytes;
+}
+
+// Trims the large blocks kept for reuse by this thread and in the depot
+static size_t trimCachedLargeBlocks(bool isUnmapped)
+{
+    size_t bytes = 0;
+    for (int sizeClass = SMALL_CLASSES; sizeClass < HEAP_CLASSES; sizeClass++) {
+        bytes += trimList(&threadCache.lists[sizeClass], isUnmapped);
+    }
+#if HEAP_THREADS
+    if (isDepotReady) {
+        mtx_lock(&depotLock);
+        for (int sizeClass = SMALL_CLASSES; sizeClass < HEAP_CLASSES; sizeClass++) {
+            bytes += trimList(&depot[sizeClass], isUnmapped);
+        }
+        mtx_unlock(&depotLock);
+    }
+#endif
+    return bytes;
+}
+
+/*
+ * setHeapPageMode
+ *
+ * Selects how chunks of HEAP_HUGE_PAGE_SIZE bytes or more are mapped;
+ * HEAP_PAGES_TRANSPARENT by default. The large blocks kept for reuse by
+ * this thread and in the depot are given back to the system, so that
+ * the blocks that follow are mapped in the new mode. Call it before
+ * other threads allocate. Without huge pages, only the mode is stored.
+ */
+void setHeapPageMode(_heapPageMode mode)
+{
+    if (mode != heapPageMode) {
+        heapPageMode = mode;
+        trimCachedLargeBlocks(true);
+    }
+}
+
+/*
+ * releaseHeapMemory
+ *
+ * Hands the pages of the large blocks kept for reuse, by this thread and
+ * in the depot, back to the system. The blocks keep their address
+ * ranges and alignment, and their pages are committed again as they are
+ * touched. Call it when the precision drops and the largest numbers are
+ * gone.
+ *
+ * @return  Bytes handed back, or 0 where the system has no madvise.
+ */
+size_t releaseHeapMemory(void)
+{
+    return trimCachedLargeBlocks(false);
+}
+
+/*
+ * initMemoryArena
+ *
+ * Sets up an empty arena. No memory is taken until the first allocation.
+ */
+void initMemoryArena(_memoryArena* arena, size_t chunkSize)
+{
+    memset(arena, 0, sizeof(*arena));
+    setMemoryArenaChunkSize(arena, chunkSize);
+}
+
+/*
+ * freeMemoryArena
+ *
+ * Gives every chunk of an arena back to the system and deselects it. The
+ * arena has to be initialized again before it is used.
+ */
+void freeMemoryArena(_memoryArena* arena)
+{
+    if (currentArena == arena) {
+        currentArena = NULL;
+    }
+    resetMemoryArena(arena);
+    while (arena->spareChunks != NULL) {
+        _heapChunk* chunk = arena->spareChunks;
+        arena->spareChunks = chunk->nextChunk;
+        releaseChunk(chunk);
+    }
+}
+
+/*
+ * resetMemoryArena
+ *
+ * Takes back every block of the arena at once, in constant time. The
+ * chunks are kept for the blocks that follow.
+ */
+void resetMemoryArena(_memoryArena* arena)
+{
+    countFree(&threadCache, arena->blockCount, arena->used);
+    if (arena->chunks != NULL) {
+        ((_heapChunk*)arena->lastChunk)->nextChunk = arena->spareChunks;
+        arena->spareChunks = arena->chunks;
+        arena->chunks = NULL;
+        arena->lastChunk = NULL;
+    }
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->used = 0;
+    arena->blockCount = 0;
+}
+
+/*
+ * setMemoryArenaChunkSize
+ *
+ * Selects the size of the chunks an arena takes when it runs out, rounded
+ * up to a multiple of HEAP_CHUNK_SIZE and at most HEAP_MAX_LARGE_BLOCK.
+ * Spare chunks of another size are given back to the system.
+ */
+void setMemoryArenaChunkSize(_memoryArena* arena, size_t chunkSize)
+{
+    if (chunkSize > HEAP_MAX_LARGE_BLOCK) {
+        chunkSize = HEAP_MAX_LARGE_BLOCK;
+    }
+    chunkSize = (chunkSize + HEAP_CHUNK_SIZE - 1) & ~(size_t)(HEAP_CHUNK_SIZE - 1);
+    if (chunkSize == 0) {
+        chunkSize = HEAP_CHUNK_SIZE;
+    }
+    if (chunkSize != arena->chunkSize) {
+        while (arena->spareChunks != NULL) {
+            _heapChunk* chunk = arena->spareChunks;
+            arena->spareChunks = chunk->nextChunk;
+            releaseChunk(chunk);
+        }
+        arena->chunkSize = chunkSize;
+    }
+}
+
+/*
+ * growArena
+ *
+ * Moves the arena on to the next segment of its chunk, to a spare chunk
+ * or to a new one.
+ */
+static bool growArena(_memoryArena* arena)
+{
+    _heapChunk* chunk = arena->chunks;
+    if (chunk != NULL && arena->end < (char*)chunk + chunk->size) {
+        arena->next = arena->end + CHUNK_HEADER_SIZE;
+        arena->end += HEAP_CHUNK_SIZE;
+        return true;
+    }
+
+    chunk = arena->spareChunks;
+    if (chunk != NULL) {
+        arena->spareChunks = chunk->nextChunk;
+    }
+    else {
+        chunk = allocateAdditionalMemory(arena->chunkSize, ARENA_CLASS);
+        if (chunk == NULL) {
+            return false;
+        }
+        registerThreadCache(&threadCache);
+        for (size_t offset = HEAP_CHUNK_SIZE; offset < chunk->size; offset += HEAP_CHUNK_SIZE) {
+            ((_heapChunk*)((char*)chunk + offset))->sizeClass = ARENA_CLASS;
+        }
+    }
+
+    chunk->nextChunk = arena->chunks;
+    if (arena->chunks == NULL) {
+        arena->lastChunk = chunk;
+    }
+    arena->chunks = chunk;
+    arena->next = (char*)chunk + CHUNK_HEADER_SIZE;
+    arena->end = (char*)chunk + HEAP_CHUNK_SIZE;
+    return true;
+}
+
+/*
+ * allocateMemoryFromArena
+ *
+ * Allocates a block of at least requestedSize bytes, aligned to
+ * HEAP_ALIGNMENT, from an arena.
+ *
+ * @return  The block, or NULL if requestedSize exceeds
+ *          HEAP_MAX_ARENA_BLOCK or the system has no memory left.
+ */
+void* allocateMemoryFromArena(_memoryArena* arena, size_t requestedSize)
+{
+    if (requestedSize > HEAP_MAX_ARENA_BLOCK) {
+        return NULL;
+    }
+    size_t size = (requestedSize + HEAP_ALIGNMENT - 1) & ~(size_t)(HEAP_ALIGNMENT - 1);
+    if (size == 0) {
+        // Even an empty block lies inside its segment, where masking finds the header
+        size = HEAP_ALIGNMENT;
+    }
+    if (ARENA_BLOCK_PREFIX + size > (size_t)(arena->end - arena->next) && !growArena(arena)) {
+        return NULL;
+    }
+
+    char* block = arena->next + ARENA_BLOCK_PREFIX;
+    *(size_t*)arena->next = size;
+    arena->next = block + size;
+    arena->used += ARENA_BLOCK_PREFIX + size;
+    arena->blockCount++;
+    countAllocation(&threadCache, ARENA_CLASS, ARENA_BLOCK_PREFIX + size);
+    return block;
+}
+
+/*
+ * selectMemoryArena
+ *
+ * Makes allocateMemoryFromHeap serve the small requests of this thread
+ * from arena, or from the size classes again if arena is NULL.
+ *
+ * @return  The arena selected before.
+ */
+_memoryArena* selectMemoryArena(_memoryArena* arena)
+{
+    _memoryArena* previous = currentArena;
+    currentArena = arena;
+    return previous;
+}
+
+/*
+ * isArenaMemory
+ *
+ * True if memory is a block of an arena, which a reset of the arena takes
+ * back.
+ */
+bool isArenaMemory(const void* memory)
+{
+    return memory != NULL && getChunk(memory)->sizeClass == ARENA_CLASS;
+}
+
+#if HEAP_STATISTICS
+// Counts of the calling thread and of the threads that ended; a signal handler must not block
+static void collectHeapStatistics(_heapStatistics* statistics, bool mayBlock)
+{
+    _heapCounters counters = threadCache.counters;
+#if HEAP_THREADS
+    if (isDepotReady && (mayBlock ? mtx_lock(&depotLock) : mtx_trylock(&depotLock)) == thrd_success) {
+        addHeapCounters(&counters, &depotCounters);
+        mtx_unlock(&depotLock);
+    }
+#else
+    (void)mayBlock;
+#endif
+
+    statistics->allocationCount = 0;
+    for (int i = 0; i < HEAP_HISTOGRAM_SIZE; i++) {
+        statistics->histogram[i] = counters.histogram[i];
+        statistics->allocationCount += counters.histogram[i];
+    }
+    statistics->freeCount = counters.freeCount;
+    statistics->bytesInUse = counters.allocatedBytes - counters.freedBytes;
+    statistics->peakBytesInUse = counters.peakBytesInUse;
+    statistics->systemBytes = counters.systemBytes;
+}
+
+// Writes the counts to dumpPath, with calls a signal handler may make where there are signals
+static void writeHeapStatisticsDump(bool mayBlock)
+{
+    _heapStatistics statistics;
+    static char text[MAX_DUMP_TEXT];
+
+    collectHeapStatistics(&statistics, mayBlock);
+    size_t length = formatHeapStatistics(&statistics, text, sizeof(text));
+    if (length == 0) {
+        return;
+    }
+    text[length++] = '\n';
+#ifdef HEAP_DUMP_SIGNAL
+    int file = open(dumpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file >= 0) {
+        ssize_t written = write(file, text, length);
+        (void)written;
+        close(file);
+    }
+#else
+    FILE* file = fopen(dumpPath, "wb");
+    if (file != NULL) {
+        fwrite(text, 1, length, file);
+        fclose(file);
+    }
+#endif
+}
+
+static void dumpHeapStatisticsAtExit(void)
+{
+    writeHeapStatisticsDump(true);
+}
+
+#ifdef HEAP_DUMP_SIGNAL
+static void dumpHeapStatisticsOnSignal(int signalNumber)
+{
+    (void)signalNumber;
+    int savedError = errno;
+    writeHeapStatisticsDump(false);
+    errno = savedError;
+}
+#endif
+#endif
+
+/*
+ * getHeapStatistics
+ *
+ * Fills statistics with the counts of the calling thread and of the
+ * threads that have ended. Blocks that one thread allocates and another
+ * frees make the bytes in use of each thread wrong, but not their sum.
+ *
+ * @return  false, with statistics zeroed, if HEAP_STATISTICS is 0.
+ */
+bool getHeapStatistics(_heapStatistics* statistics)
+{
+#if HEAP_STATISTICS
+    collectHeapStatistics(statistics, true);
+    return true;
+#else
+    memset(statistics, 0, sizeof(*statistics));
+    return false;
+#endif
+}
+
+/*
+ * getHeapFragmentation
+ *
+ * Share of the system memory the heap holds that is in no block handed
+ * out: free blocks, the unused ends of blocks and spare arena chunks.
+ *
+ * @return  A ratio from 0 to 1; 0 if the heap holds no memory.
+ */
+double getHeapFragmentation(const _heapStatistics* statistics)
+{
+    if (statistics->systemBytes <= 0 || statistics->bytesInUse >= statistics->systemBytes) {
+        return 0.0;
+    }
+    if (statistics->bytesInUse <= 0) {
+        return 1.0;
+    }
+    return 1.0 - (double)statistics->bytesInUse / (double)statistics->systemBytes;
+}
+
+// Appends text to buffer if it fits; returns the new length, or SIZE_MAX once out of room
+static size_t appendText(char* buffer, size_t bufferSize, size_t length, const char* text)
+{
+    size_t textLength = strlen(text);
+    if (length == SIZE_MAX || textLength >= bufferSize - length) {
+        return SIZE_MAX;
+    }
+    memcpy(buffer + length, text, textLength + 1);
+    return length + textLength;
+}
+
+static size_t appendNumber(char* buffer, size_t bufferSize, size_t length, int64_t value)
+{
+    char digits[24];
+    char* start = digits + sizeof(digits) - 1;
+    uint64_t magnitude = (value < 0) ? 0 - (uint64_t)value : (uint64_t)value;
+
+    *start = '\0';
+    do {
+        *--start = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--start = '-';
     }
+    return appendText(buffer, bufferSize, length, start);
+}
 
-    return NULL; // Allocation failed 
-}
\ No newline at end of file
+/*
+ * formatHeapStatistics
+ *
+ * Writes statistics to buffer as one JSON object. Only calls that a
+ * signal handler may make are used.
+ *
+ * @return  The length of the text, or 0 if it does not fit in buffer.
+ */
+size_t formatHeapStatistics(const _heapStatistics* statistics, char* buffer, size_t bufferSize)
+{
+    // Four decimals, from an integer, as a signal handler has no snprintf
+    int64_t fragmentation = (int64_t)(getHeapFragmentation(statistics) * 10000.0 + 0.5);
+    char fraction[] = "0.0000";
+    fraction[0] = (char)('0' + fragmentation / 10000);
+    for (int i = 5; i >= 2; i--) {
+        fraction[i] = (char)('0' + fragmentation % 10);
+        fragmentation /= 10;
+    }
+
+    size_t length = appendText(buffer, bufferSize, 0, "{\"allocations\":");
+    length = appendNumber(buffer, bufferSize, length, (int64_t)statistics->allocationCount);
+    length = appendText(buffer, bufferSize, length, ",\"frees\":");
+    length = appendNumber(buffer, bufferSize, length, (int64_t)statistics->freeCount);
+    length = appendText(buffer, bufferSize, length, ",\"bytesInUse\":");
+    length = appendNumber(buffer, bufferSize, length, statistics->bytesInUse);
+    length = appendText(buffer, bufferSize, length, ",\"peakBytesInUse\":");
+    length = appendNumber(buffer, bufferSize, length, statistics->peakBytesInUse);
+    length = appendText(buffer, bufferSize, length, ",\"systemBytes\":");
+    length = appendNumber(buffer, bufferSize, length, statistics->systemBytes);
+    length = appendText(buffer, bufferSize, length, ",\"fragmentation\":");
+    length = appendText(buffer, bufferSize, length, fraction);
+    length = appendText(buffer, bufferSize, length, ",\"classes\":[");
+    for (int i = 0; i < HEAP_SIZE_CLASSES; i++) {
+        length = appendText(buffer, bufferSize, length, (i == 0) ? "" : ",");
+        length = appendNumber(buffer, bufferSize, length, (int64_t)statistics->histogram[i]);
+    }
+    length = appendText(buffer, bufferSize, length, "],\"huge\":");
+    length = appendNumber(buffer, bufferSize, length, (int64_t)statistics->histogram[HEAP_HISTOGRAM_HUGE]);
+    length = appendText(buffer, bufferSize, length, ",\"arena\":");
+    length = appendNumber(buffer, bufferSize, length, (int64_t)statistics->histogram[HEAP_HISTOGRAM_ARENA]);
+    length = appendText(buffer, bufferSize, length, "}");
+    return (length == SIZE_MAX) ? 0 : length;
+}
+
+/*
+ * installHeapStatisticsDump
+ *
+ * Has the statistics written to the file at path as JSON when the
+ * program exits, and each time the process gets SIGUSR1 where there are
+ * POSIX signals. A second call only changes the path.
+ *
+ * @return  false if HEAP_STATISTICS is 0, the path is too long or the
+ *          exit handler cannot be registered.
+ */
+bool installHeapStatisticsDump(const char* path)
+{
+#if HEAP_STATISTICS
+    static bool isInstalled;
+
+    if (strlen(path) >= sizeof(dumpPath)) {
+        return false;
+    }
+    strcpy(dumpPath, path);
+    if (isInstalled) {
+        return true;
+    }
+    if (atexit(dumpHeapStatisticsAtExit) != 0) {
+        return false;
+    }
+#ifdef HEAP_DUMP_SIGNAL
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dumpHeapStatisticsOnSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(HEAP_DUMP_SIGNAL, &action, NULL);
+#endif
+    isInstalled = true;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
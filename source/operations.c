@@ -20,19 +20,39 @@
                - performAdvancedCalculation:  Performs arithmetic and
                                               logical operations on numbers
                                               in various bases and precisions.
-               - [Other arithmetic, logic, and transcendental functions]
+               - performBigCalculation: The same for _bigDecimal operands at
+                                        the engine's selected precision.
+               - performExtendedCalculation: The same for _extendedFloat80
+                                             operands.
+               - performValueCalculation: Dispatches typed _calcValue
+                                          operands to the functions above.
+               - formatNumberForDisplay, formatFloatAutomatically,
+                 formatScientificNotation, intToBaseString: Turn results
+                                              into display strings.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
 
   -----------------------------------------------------------------------------*/
 
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//format.h"
 #include ".//headers//operations.h"
-#include ".//headers//main.h"
+#include ".//headers//value.h"
+#include ".//headers//wideint.h"
 
-extern _calculatorState calcState;
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 /*
  * intToExtendedFloat80
  * 
- * This function converts a 64-bit signed integer (LONGLONG) to an ExtendedFloat80
+ * This function converts a 64-bit signed integer to an ExtendedFloat80
  * structure, representing an 80-bit extended precision floating-point number.
  * The function assumes a base-10 (decimal) representation of the integer. 
  * 
@@ -41,55 +61,52 @@ extern _calculatorState calcState;
  * 2. Zero Handling: Returns a zeroed ExtendedFloat80 for a zero input. 
  * 3. Finding the most significant bit (MSB).
  * 4. Normalizing the mantissa: Shifting the bits so the MSB is at the 63rd bit of 
- *    the mantissaHigh field. 
+ *    the mantissa (the top bit of mantissaHigh).
  * 5. Calculating the exponent: Determining the biased exponent based on the MSB position.
  *
+ * @param result The ExtendedFloat80 that receives the converted value.
  * @param value  The 64-bit signed integer to convert.
- * @return        None. Modifies the global calcState.scientificNumber. 
+ * @return        None.
  */
-void intToExtendedFloat80(LONGLONG value) {
+void intToExtendedFloat80(_extendedFloat80* result, int64_t value) {
+    uint64_t magnitude;
 
     // Handle sign 
     if (value < 0) {
-        calcState.scientificNumber.exponent = 0x8000; // Set sign bit
-        value = -value; 
+        result->exponent = 0x8000; // Set sign bit
+        magnitude = 0 - (uint64_t)value;
     } else {
-        calcState.scientificNumber.exponent = 0;
+        result->exponent = 0;
+        magnitude = (uint64_t)value;
     }
 
     // If value is 0, return a zeroed ExtendedFloat80
-    if (value == 0) {
-        calcState.scientificNumber.mantissaLow = 0;
-        calcState.scientificNumber.mantissaHigh = 0;
+    if (magnitude == 0) {
+        result->mantissaLow = 0;
+        result->mantissaHigh = 0;
         return;
     }
 
     // Find the most significant bit (MSB) 
     int msbPosition = 63; // Start at the highest bit for 64-bit
-    while ((value & (1LL << msbPosition)) == 0) { 
+    while ((magnitude & (1ULL << msbPosition)) == 0) { 
         msbPosition--;
     }
 
-    // Normalize the mantissa (shift so that MSB is at bit 63 of mantissaHigh) 
-    int shiftAmount = msbPosition - 63;
-    if (shiftAmount >= 0) {
-        calcState.scientificNumber.mantissaHigh = (uint)(value >> shiftAmount);
-        calcState.scientificNumber.mantissaLow = (uint)(value << (32 - shiftAmount)); 
-    } else {
-        calcState.scientificNumber.mantissaHigh = 0;
-        calcState.scientificNumber.mantissaLow = (uint)value;
-    }
+    // Normalize the mantissa (shift so that MSB is at bit 63) 
+    magnitude <<= 63 - msbPosition;
+    result->mantissaHigh = (uint32_t)(magnitude >> 32);
+    result->mantissaLow = (uint32_t)magnitude;
 
     // Calculate the exponent (biased) 
-    calcState.scientificNumber.exponent |= 0x3FFF + shiftAmount;
+    result->exponent |= 0x3FFF + msbPosition;
 }
 
 /*
  * isValueOverflowExtended
  * 
- * This function checks for potential overflow when a digit is added to the current 
- * value stored in the global calcState.scientificNumber, which is an 80-bit 
- * extended precision floating-point number. 
+ * This function checks for potential overflow when a digit is added to the 
+ * given 80-bit extended precision floating-point number. 
  *
  * The overflow check is primarily based on the exponent value:
  * 1. Maximum Exponent: If the exponent is already at its maximum value (0x7FFF),
@@ -102,33 +119,31 @@ void intToExtendedFloat80(LONGLONG value) {
  * 
  * The function handles the sign bit separately to ensure accurate overflow detection. 
  * 
- * @param  None. Uses the global calcState.scientificNumber. 
+ * @param value       The value the digit is being added to. Its exponent is
+ *                    advanced by the simulated multiplication.
+ * @param numberBase  The current number base.
  * @return True if an overflow condition is detected, false otherwise.
  */ 
-BOOL isValueOverflowExtended(void) {
+bool isValueOverflowExtended(_extendedFloat80* value, int numberBase) {
     // Check if exponent is already at the maximum
-    if (calcState.scientificNumber.exponent == 0x7FFF) {
+    if ((value->exponent & 0x7FFF) == 0x7FFF) {
         return true; // Overflow
     }
 
     // Handle sign separately
-    int sign = (calcState.scientificNumber.exponent & 0x8000) ? -1 : 1; 
-    calcState.scientificNumber.exponent &= 0x7FFF;  // Remove the sign bit
+    uint16_t sign = value->exponent & 0x8000;
+    uint32_t exponent = value->exponent & 0x7FFF;  // Remove the sign bit
 
     // Simulate multiplication by numberBase
-    calcState.scientificNumber.exponent += (short)log2(calcState.numberBase);  
-
-    // Simulate adding the digit (might need additional checks here for precision loss)
-    // For simplicity, assuming digit is small enough to be added without significant changes 
-    // to the mantissa. More sophisticated logic may be needed.
+    exponent += (uint32_t)ceil(log2(numberBase));
 
     // Check for exponent overflow
-    if (calcState.scientificNumber.exponent >= 0x7FFF) { 
+    if (exponent >= 0x7FFF) { 
         return true; // Overflow
     } 
 
     // Restore the sign bit
-    calcState.scientificNumber.exponent |= (sign == -1) ? 0x8000 : 0;
+    value->exponent = (uint16_t)(exponent | sign);
 
     return false; // No overflow
 }
@@ -137,137 +152,709 @@ BOOL isValueOverflowExtended(void) {
  * stringToExtendedFloat80
  *
  * This function converts a decimal string representation of a number to an
- * ExtendedFloat80 structure (representing an 80-bit extended precision 
- * floating-point number). The function assumes the input string represents a 
- * base-10 decimal number.
- *
- * The function handles:
- * 1. Sign: Determines the sign of the number from a leading '-' character.
- * 2. Separation: Splits the string into integer and fractional parts. 
- * 3. Integer Part Conversion: Converts the integer part to ExtendedFloat80.
- * 4. Fractional Part Conversion: Converts the fractional part, handling potential
- *    precision loss and normalization. 
- *
- * @param str  Pointer to the NULL-terminated string representing the decimal number.
- * @return     None. The function modifies the global calcState.scientificNumber.
+ * ExtendedFloat80 structure (representing an 80-bit extended precision
+ * floating-point number), rounded to the nearest value.
+ *
+ * The string may use either '.' or decimalSeparator as the decimal point
+ * and may carry an 'e' exponent, so both the typed entry and pasted text
+ * can be converted. The work is done by extendedFloat80FromString, which
+ * produces the full 64-bit mantissa directly.
+ *
+ * @param result            Receives the converted value.
+ * @param str               Pointer to the NULL-terminated decimal string.
+ * @param decimalSeparator  The user's decimal separator.
+ * @return                  STATUS_SUCCESS, STATUS_INVALID_INPUT,
+ *                          STATUS_OVERFLOW or STATUS_UNDERFLOW.
  */
-void stringToExtendedFloat80(const char* str) {
-    // Handle sign
-    if (*str == '-') {
-        calcState.scientificNumber.exponent = 0x8000; // Set sign bit
-        str++; 
-    } else {
-        calcState.scientificNumber.exponent = 0;
-    }
-
-    // Separate integer and fractional parts
-    char* decimalPoint = strchr(str, '.');
-    int integerPart = (decimalPoint != NULL) ? atoi(str) : atoi(str);
-    double fractionalPart = (decimalPoint != NULL) ? strtod(decimalPoint, NULL) : 0.0;
-
-    // Convert integer part to ExtendedFloat80, directly modifying calcState.scientificNumber
-    intToExtendedFloat80(integerPart); 
-
-    // Add fractional part to the mantissa
-    if (fractionalPart != 0.0) {
-        for (int i = 0; i < 64 && fractionalPart != 0.0; i++) {
-            fractionalPart *= 2;
-            if (fractionalPart >= 1.0) {
-                // Set the corresponding bit in the mantissa
-                if (i < 32) {
-                    calcState.scientificNumber.mantissaLow |= 1 << i;
-                } else {
-                    calcState.scientificNumber.mantissaHigh |= 1 << (i - 32);
-                }
-                fractionalPart -= 1.0;
-            }
-        }
-        // Normalize if necessary (if the fractional part added a leading 1 to the mantissa)
-        if (calcState.scientificNumber.mantissaHigh & 0x80000000) {
-            calcState.scientificNumber.exponent++;
-            shiftMultiWordInteger(&calcState.scientificNumber.mantissaHigh, -1); // Right shift
-        }
-    }
+int stringToExtendedFloat80(_extendedFloat80* result, const char* str, char decimalSeparator) {
+    return extendedFloat80FromString(result, str, decimalSeparator);
 }
 
 
 /*
  * shiftMultiWordInteger
  *
- * This function performs a bitwise shift on a 64-bit integer represented by 
- * two 32-bit unsigned integers (highWord and the lower 32 bits of
- * calcState.scientificNumber.mantissaLow). The function supports both left and
- * right shifts, with positive shiftAmount values indicating a right shift and 
- * negative values indicating a left shift. 
+ * This function performs a bitwise shift on the 64-bit mantissa of an
+ * ExtendedFloat80, which is stored as two 32-bit words (mantissaHigh and
+ * mantissaLow). The function supports both left and right shifts, with
+ * positive shiftAmount values indicating a right shift and negative values
+ * indicating a left shift. 
  *
  * The function handles cases where the shiftAmount is greater than or equal to 32
  * bits, ensuring correct carry bit propagation between the two words. 
  * 
- * @param highWord       Pointer to the upper 32 bits of the 64-bit integer.
+ * @param value          The ExtendedFloat80 whose mantissa is shifted.
  * @param shiftAmount     The number of bits to shift (positive for right, negative for left).
- * @return                None. The function modifies the value pointed to by highWord and
- *                        the calcState.scientificNumber.mantissaLow. 
+ * @return                None.
  */
-void shiftMultiWordInteger(DWORD* highWord, int shiftAmount) {
+void shiftMultiWordInteger(_extendedFloat80* value, int shiftAmount) {
+    uint64_t mantissa = ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+
     if (shiftAmount > 0) { // Right shift
-        if (shiftAmount >= 32) {
-            *highWord = 0;  // Shift is more than 32 bits, highWord becomes 0
-        } else {
-            *highWord >>= shiftAmount;        // Shift highWord right
-            *highWord |= calcState.scientificNumber.mantissaLow << (32 - shiftAmount); // Carry bits from lowWord
-        }
-        calcState.scientificNumber.mantissaLow >>= shiftAmount; // Shift lowWord right
+        mantissa = (shiftAmount >= 64) ? 0 : mantissa >> shiftAmount;
     } else if (shiftAmount < 0) { // Left shift 
-        shiftAmount = -shiftAmount; 
-        if (shiftAmount >= 32) {
-            calcState.scientificNumber.mantissaLow = 0; // Shift is more than 32 bits, lowWord becomes 0 
-        } else { 
-            calcState.scientificNumber.mantissaLow <<= shiftAmount;   // Shift lowWord left 
-            calcState.scientificNumber.mantissaLow |= *highWord >> (32 - shiftAmount); // Carry bits from highWord 
-        }
-        *highWord <<= shiftAmount;  // Shift highWord left 
+        mantissa = (-shiftAmount >= 64) ? 0 : mantissa << -shiftAmount;
     } // No shift if shiftAmount is 0
+
+    value->mantissaHigh = (uint32_t)(mantissa >> 32);
+    value->mantissaLow = (uint32_t)mantissa;
+}
+
+/*
+ * angleToRadians
+ *
+ * Converts an angle expressed in the engine's current angle mode
+ * (IDC_RADIO_DEG, IDC_RADIO_RAD or IDC_RADIO_GRAD) to radians.
+ */
+static double angleToRadians(const _calcEngine* engine, double angle) {
+    switch (engine->angleMode) {
+    case IDC_RADIO_DEG:  return angle * (M_PI / 180.0);
+    case IDC_RADIO_GRAD: return angle * (M_PI / 200.0);
+    default:             return angle;
+    }
+}
+
+/*
+ * radiansToAngle
+ *
+ * Converts an angle in radians back to the engine's current angle mode.
+ */
+static double radiansToAngle(const _calcEngine* engine, double radians) {
+    switch (engine->angleMode) {
+    case IDC_RADIO_DEG:  return radians * (180.0 / M_PI);
+    case IDC_RADIO_GRAD: return radians * (200.0 / M_PI);
+    default:             return radians;
+    }
+}
+
+/*
+ * setCalculationError
+ *
+ * Puts the engine into the error state with the given status code and
+ * returns 0.0 so callers can "return setCalculationError(...)".
+ */
+static double setCalculationError(_calcEngine* engine, int statusCode) {
+    engine->errorState = ERROR_STATE_ACTIVE;
+    engine->errorCodeBase = statusCode;
+    return 0.0;
+}
+
+/*
+ * calculateBits64
+ *
+ * Rsh, Rol, Ror, the bit counts and the bit reversal in 64 bits, for the
+ * values that are no fixed-width integers; Rsh copies the sign bit.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INVALID_INPUT for a shift or
+ *          rotation count outside 0..63.
+ */
+static int calculateBits64(uint32_t operatorKey, int64_t operand1, int64_t operand2, int64_t* result) {
+    uint64_t bits = (uint64_t)operand2;
+
+    switch (operatorKey) {
+    case IDC_BUTTON_POPCNT: *result = countBits64(bits); return STATUS_SUCCESS;
+    case IDC_BUTTON_CLZ:    *result = (bits == 0) ? 64 : countLeadingZeros64(bits); return STATUS_SUCCESS;
+    case IDC_BUTTON_CTZ:    *result = (bits == 0) ? 64 : countTrailingZeros64(bits); return STATUS_SUCCESS;
+    case IDC_BUTTON_BITREV: *result = (int64_t)reverseBits64(bits); return STATUS_SUCCESS;
+    default:                break;
+    }
+
+    if (operand2 < 0 || operand2 >= 64) {
+        return STATUS_INVALID_INPUT;
+    }
+    bits = (uint64_t)operand1;
+    int count = (int)operand2;
+    switch (operatorKey) {
+    case IDC_BUTTON_RSH:
+        *result = (int64_t)((operand1 < 0) ? ~(~bits >> count) : bits >> count);
+        break;
+    case IDC_BUTTON_ROL:
+        *result = (int64_t)((count == 0) ? bits : (bits << count) | (bits >> (64 - count)));
+        break;
+    default:
+        *result = (int64_t)((count == 0) ? bits : (bits >> count) | (bits << (64 - count)));
+        break;
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * hasInt64Operands
+ *
+ * False if a bitwise operator gets an operand whose integer part does not
+ * fit 64 bits (see isInt64Range); the unary ones only use operand2.
+ */
+static bool hasInt64Operands(uint32_t operatorKey, double operand1, double operand2) {
+    switch (operatorKey) {
+    case IDC_BUTTON_AND:
+    case IDC_BUTTON_OR:
+    case IDC_BUTTON_XOR:
+    case IDC_BUTTON_LSH:
+    case IDC_BUTTON_RSH:
+    case IDC_BUTTON_ROL:
+    case IDC_BUTTON_ROR:
+        return isInt64Range(operand1) && isInt64Range(operand2);
+    case IDC_BUTTON_NOT:
+    case IDC_BUTTON_POPCNT:
+    case IDC_BUTTON_CLZ:
+    case IDC_BUTTON_CTZ:
+    case IDC_BUTTON_BITREV:
+        return isInt64Range(operand2);
+    default:
+        return true;
+    }
+}
+
+/*
+ * performAdvancedCalculation
+ *
+ * This function applies one calculator operator. Binary operators combine
+ * operand1 (the value entered before the operator) with operand2 (the value
+ * entered after it). Unary operators such as sqrt, 1/x or sin only use
+ * operand2, except percentage, which takes operand2 percent of operand1.
+ *
+ * Bitwise operators (AND, OR, XOR, NOT, LSH, and RSH, ROL, ROR and the
+ * bit counts in 64 bits) work on the integer parts of their operands, and
+ * fail with STATUS_INVALID_INPUT for a NaN, an infinity or an operand of
+ * 2^63 or more in magnitude. Trigonometric functions honour the engine's
+ * angle mode.
+ *
+ * On failure the engine's errorState and errorCodeBase are set to one of the
+ * STATUS_* codes and 0.0 is returned.
+ *
+ * @param engine       The calculator session (angle mode, error state).
+ * @param operatorKey  The IDC_BUTTON_* ID of the operator.
+ * @param operand1     Left operand.
+ * @param operand2     Right operand, or the only operand of a unary operator.
+ * @return             The result of the operation.
+ */
+double performAdvancedCalculation(_calcEngine* engine, uint32_t operatorKey, double operand1, double operand2) {
+    double result;
+
+    if (!hasInt64Operands(operatorKey, operand1, operand2)) {
+        return setCalculationError(engine, STATUS_INVALID_INPUT);
+    }
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD:  result = operand1 + operand2; break;
+    case IDC_BUTTON_SUB:  result = operand1 - operand2; break;
+    case IDC_BUTTON_MUL:  result = operand1 * operand2; break;
+
+    case IDC_BUTTON_DIV:
+        if (operand2 == 0.0) {
+            return setCalculationError(engine, STATUS_DIVISION_BY_ZERO);
+        }
+        result = operand1 / operand2;
+        break;
+
+    case IDC_BUTTON_MOD:
+        if (operand2 == 0.0) {
+            return setCalculationError(engine, STATUS_DIVISION_BY_ZERO);
+        }
+        result = fmod(operand1, operand2);
+        break;
+
+    case IDC_BUTTON_XY:   result = pow(operand1, operand2); break;
+
+    case IDC_BUTTON_AND:  result = (double)((int64_t)operand1 & (int64_t)operand2); break;
+    case IDC_BUTTON_OR:   result = (double)((int64_t)operand1 | (int64_t)operand2); break;
+    case IDC_BUTTON_XOR:  result = (double)((int64_t)operand1 ^ (int64_t)operand2); break;
+    case IDC_BUTTON_NOT:  result = (double)(~(int64_t)operand2); break;
+
+    case IDC_BUTTON_LSH:
+        if (!(operand2 >= 0.0 && operand2 < 64.0)) {  // NaN is invalid too
+            return setCalculationError(engine, STATUS_INVALID_INPUT);
+        }
+        result = (double)(int64_t)((uint64_t)(int64_t)operand1 << (int)operand2);
+        break;
+
+    case IDC_BUTTON_RSH:
+    case IDC_BUTTON_ROL:
+    case IDC_BUTTON_ROR:
+        if (!(operand2 >= 0.0 && operand2 < 64.0)) {
+            return setCalculationError(engine, STATUS_INVALID_INPUT);
+        }
+        // Fall through
+    case IDC_BUTTON_POPCNT:
+    case IDC_BUTTON_CLZ:
+    case IDC_BUTTON_CTZ:
+    case IDC_BUTTON_BITREV: {
+        // The bit counts ignore operand1, which hasInt64Operands let through
+        int64_t bits = 0;
+        int64_t value = isInt64Range(operand1) ? (int64_t)operand1 : 0;
+        calculateBits64(operatorKey, value, (int64_t)operand2, &bits);
+        result = (double)bits;
+        break;
+    }
+
+    case IDC_BUTTON_SQRT:
+        if (operand2 < 0.0) {
+            return setCalculationError(engine, STATUS_INVALID_INPUT);
+        }
+        result = sqrt(operand2);
+        break;
+
+    case IDC_BUTTON_PERC: result = operand1 * operand2 / 100.0; break;
+
+    case IDC_BUTTON_INV:
+        if (operand2 == 0.0) {
+            return setCalculationError(engine, STATUS_DIVISION_BY_ZERO);
+        }
+        result = 1.0 / operand2;
+        break;
+
+    case IDC_BUTTON_NEG:  result = -operand2; break;
+    case IDC_BUTTON_SIN:  result = sin(angleToRadians(engine, operand2)); break;
+    case IDC_BUTTON_COS:  result = cos(angleToRadians(engine, operand2)); break;
+    case IDC_BUTTON_TAN:  result = tan(angleToRadians(engine, operand2)); break;
+
+    case IDC_BUTTON_ASIN:
+    case IDC_BUTTON_ACOS:
+        if (operand2 < -1.0 || operand2 > 1.0) {
+            return setCalculationError(engine, STATUS_INVALID_INPUT);
+        }
+        result = radiansToAngle(engine, (operatorKey == IDC_BUTTON_ASIN) ? asin(operand2) : acos(operand2));
+        break;
+
+    case IDC_BUTTON_ATAN: result = radiansToAngle(engine, atan(operand2)); break;
+
+    case IDC_BUTTON_LOG:
+    case IDC_BUTTON_LN:
+        if (operand2 <= 0.0) {
+            return setCalculationError(engine, STATUS_INVALID_INPUT);
+        }
+        result = (operatorKey == IDC_BUTTON_LOG) ? log10(operand2) : log(operand2);
+        break;
+
+    case IDC_BUTTON_EXP:  result = exp(operand2); break;
+    case IDC_BUTTON_SQR:  result = operand2 * operand2; break;
+    case IDC_BUTTON_CUBE: result = operand2 * operand2 * operand2; break;
+
+    case IDC_BUTTON_FACT:
+        if (operand2 < 0.0 && operand2 == floor(operand2)) {
+            return setCalculationError(engine, STATUS_UNDEFINED_RESULT);
+        }
+        result = tgamma(operand2 + 1.0);
+        break;
+
+    case IDC_BUTTON_INT:  result = trunc(operand2); break;
+
+    case IDC_BUTTON_EQ:
+    default:
+        result = operand2;
+        break;
+    }
+
+    if (isnan(result)) {
+        return setCalculationError(engine, STATUS_UNDEFINED_RESULT);
+    }
+    if (isinf(result)) {
+        return setCalculationError(engine, STATUS_OVERFLOW);
+    }
+    return result;
+}
+
+/*
+ * performBigCalculation
+ *
+ * The arbitrary-precision counterpart of performAdvancedCalculation for
+ * the operators that have an exact or correctly rounded decimal
+ * implementation: +, -, *, /, %, sqrt, x^2, x^3, 1/x and +/-. Other
+ * operators return STATUS_UNDEFINED_RESULT and have to be evaluated in
+ * double precision by the caller.
+ *
+ * @param engine       The calculator session; supplies precisionDigits.
+ * @param operatorKey  The IDC_BUTTON_* ID of the operator.
+ * @param result       Receives the result. May alias either operand.
+ * @param operand1     Left operand.
+ * @param operand2     Right operand, or the only operand of a unary operator.
+ * @return             STATUS_SUCCESS or one of the STATUS_* error codes.
+ */
+int performBigCalculation(const _calcEngine* engine, uint32_t operatorKey, _bigDecimal* result,
+    const _bigDecimal* operand1, const _bigDecimal* operand2) {
+    int precision = engine->precisionDigits;
+    _bigDecimal hundred;
+    int status;
+
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD:  return bigDecimalAdd(result, operand1, operand2, precision);
+    case IDC_BUTTON_SUB:  return bigDecimalSub(result, operand1, operand2, precision);
+    case IDC_BUTTON_MUL:  return bigDecimalMul(result, operand1, operand2, precision);
+    case IDC_BUTTON_DIV:  return bigDecimalDiv(result, operand1, operand2, precision);
+    case IDC_BUTTON_SQRT: return bigDecimalSqrt(result, operand2, precision);
+    case IDC_BUTTON_SQR:  return bigDecimalMul(result, operand2, operand2, precision);
+
+    case IDC_BUTTON_CUBE:
+        // Square exactly first so the result is rounded only once
+        status = bigDecimalMul(result, operand2, operand2, BIG_DECIMAL_EXACT);
+        return (status == STATUS_SUCCESS) ? bigDecimalMul(result, result, operand2, precision) : status;
+
+    case IDC_BUTTON_PERC:
+        bigDecimalInit(&hundred);
+        status = bigDecimalSetInt(&hundred, 100);
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalMul(result, operand1, operand2, BIG_DECIMAL_EXACT);
+        }
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalDiv(result, result, &hundred, precision);
+        }
+        bigDecimalFree(&hundred);
+        return status;
+
+    case IDC_BUTTON_INV:
+        bigDecimalInit(&hundred);
+        status = bigDecimalSetInt(&hundred, 1);
+        if (status == STATUS_SUCCESS) {
+            status = bigDecimalDiv(result, &hundred, operand2, precision);
+        }
+        bigDecimalFree(&hundred);
+        return status;
+
+    case IDC_BUTTON_NEG:
+        status = bigDecimalCopy(result, operand2);
+        bigDecimalNegate(result);
+        return status;
+
+    default:
+        return STATUS_UNDEFINED_RESULT;
+    }
+}
+
+/*
+ * performExtendedCalculation
+ *
+ * Applies +, -, *, /, sqrt, x^2, 1/x or +/- to 80-bit extended operands
+ * with the software kernel in extfloat.c, so SCIENTIFIC_NOTATION mode
+ * keeps its 64-bit mantissa whatever the host's long double is. Other
+ * operators return STATUS_UNDEFINED_RESULT and have to be evaluated in
+ * double precision by the caller.
+ *
+ * @param operatorKey  The IDC_BUTTON_* ID of the operator.
+ * @param result       Receives the result. May alias either operand.
+ * @param operand1     Left operand.
+ * @param operand2     Right operand, or the only operand of a unary operator.
+ * @return             STATUS_SUCCESS or one of the STATUS_* error codes.
+ */
+int performExtendedCalculation(uint32_t operatorKey, _extendedFloat80* result,
+    const _extendedFloat80* operand1, const _extendedFloat80* operand2) {
+    _extendedFloat80 one;
+
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD:  return extendedFloat80Add(result, operand1, operand2);
+    case IDC_BUTTON_SUB:  return extendedFloat80Sub(result, operand1, operand2);
+    case IDC_BUTTON_MUL:  return extendedFloat80Mul(result, operand1, operand2);
+    case IDC_BUTTON_DIV:  return extendedFloat80Div(result, operand1, operand2);
+    case IDC_BUTTON_SQRT: return extendedFloat80Sqrt(result, operand2);
+    case IDC_BUTTON_SQR:  return extendedFloat80Mul(result, operand2, operand2);
+
+    case IDC_BUTTON_INV:
+        intToExtendedFloat80(&one, 1);
+        return extendedFloat80Div(result, &one, operand2);
+
+    case IDC_BUTTON_NEG:
+        *result = *operand2;
+        result->exponent ^= EXTENDED_FLOAT_SIGN;
+        return STATUS_SUCCESS;
+
+    default:
+        return STATUS_UNDEFINED_RESULT;
+    }
+}
+
+/*
+ * multiplyInteger
+ *
+ * *result = a * b; returns false if the product does not fit an int64_t.
+ */
+static bool multiplyInteger(int64_t a, int64_t b, int64_t* result) {
+    uint64_t magnitudeA = (a < 0) ? 0 - (uint64_t)a : (uint64_t)a;
+    uint64_t magnitudeB = (b < 0) ? 0 - (uint64_t)b : (uint64_t)b;
+    bool isNegative = (a < 0) != (b < 0);
+    uint64_t high;
+    uint64_t low = multiply64(magnitudeA, magnitudeB, &high);
+
+    if (high != 0 || low > (uint64_t)INT64_MAX + (isNegative ? 1u : 0u)) {
+        return false;
+    }
+    *result = isNegative ? (int64_t)(0 - low) : (int64_t)low;
+    return true;
+}
+
+/*
+ * performIntegerCalculation
+ *
+ * Checked 64-bit integer arithmetic for the non-decimal bases: +, -, *,
+ * integer /, Mod, the bitwise operators, +/-, x^2, x^3 and Int. Other
+ * operators return STATUS_UNDEFINED_RESULT and have to be evaluated in
+ * double precision by the caller.
+ *
+ * @return  STATUS_SUCCESS, STATUS_OVERFLOW, STATUS_DIVISION_BY_ZERO,
+ *          STATUS_INVALID_INPUT or STATUS_UNDEFINED_RESULT.
+ */
+static int performIntegerCalculation(uint32_t operatorKey, int64_t* result, int64_t operand1, int64_t operand2) {
+    switch (operatorKey) {
+    case IDC_BUTTON_ADD:
+        if ((operand2 > 0 && operand1 > INT64_MAX - operand2) || (operand2 < 0 && operand1 < INT64_MIN - operand2)) {
+            return STATUS_OVERFLOW;
+        }
+        *result = operand1 + operand2;
+        return STATUS_SUCCESS;
+
+    case IDC_BUTTON_SUB:
+        if ((operand2 < 0 && operand1 > INT64_MAX + operand2) || (operand2 > 0 && operand1 < INT64_MIN + operand2)) {
+            return STATUS_OVERFLOW;
+        }
+        *result = operand1 - operand2;
+        return STATUS_SUCCESS;
+
+    case IDC_BUTTON_MUL:
+        return multiplyInteger(operand1, operand2, result) ? STATUS_SUCCESS : STATUS_OVERFLOW;
+
+    case IDC_BUTTON_DIV:
+    case IDC_BUTTON_MOD:
+        if (operand2 == 0) {
+            return STATUS_DIVISION_BY_ZERO;
+        }
+        if (operand2 == -1) {
+            if (operatorKey == IDC_BUTTON_MOD) {
+                *result = 0;
+                return STATUS_SUCCESS;
+            }
+            if (operand1 == INT64_MIN) {
+                return STATUS_OVERFLOW;
+            }
+        }
+        *result = (operatorKey == IDC_BUTTON_DIV) ? operand1 / operand2 : operand1 % operand2;
+        return STATUS_SUCCESS;
+
+    case IDC_BUTTON_AND:  *result = operand1 & operand2; return STATUS_SUCCESS;
+    case IDC_BUTTON_OR:   *result = operand1 | operand2; return STATUS_SUCCESS;
+    case IDC_BUTTON_XOR:  *result = operand1 ^ operand2; return STATUS_SUCCESS;
+    case IDC_BUTTON_NOT:  *result = ~operand2; return STATUS_SUCCESS;
+
+    case IDC_BUTTON_LSH:
+        if (operand2 < 0 || operand2 >= 64) {
+            return STATUS_INVALID_INPUT;
+        }
+        *result = (int64_t)((uint64_t)operand1 << operand2);
+        return STATUS_SUCCESS;
+
+    case IDC_BUTTON_RSH:
+    case IDC_BUTTON_ROL:
+    case IDC_BUTTON_ROR:
+    case IDC_BUTTON_POPCNT:
+    case IDC_BUTTON_CLZ:
+    case IDC_BUTTON_CTZ:
+    case IDC_BUTTON_BITREV:
+        return calculateBits64(operatorKey, operand1, operand2, result);
+
+    case IDC_BUTTON_NEG:
+        if (operand2 == INT64_MIN) {
+            return STATUS_OVERFLOW;
+        }
+        *result = -operand2;
+        return STATUS_SUCCESS;
+
+    case IDC_BUTTON_SQR:
+        return multiplyInteger(operand2, operand2, result) ? STATUS_SUCCESS : STATUS_OVERFLOW;
+
+    case IDC_BUTTON_CUBE:
+        return (multiplyInteger(operand2, operand2, result) && multiplyInteger(*result, operand2, result))
+            ? STATUS_SUCCESS : STATUS_OVERFLOW;
+
+    case IDC_BUTTON_INT:
+    case IDC_BUTTON_EQ:
+        *result = operand2;
+        return STATUS_SUCCESS;
+
+    default:
+        return STATUS_UNDEFINED_RESULT;
+    }
 }
 
 /*
- * toggleStatisticsWindow
+ * performValueCalculation
  *
- * This function toggles the visibility of the statistics window. If the statistics
- * window is currently closed, it creates and shows the window. If the window
- * is open, it closes the window. The function also updates the
- * calcState.statisticsWindowOpen flag to reflect the window's state.
+ * Applies one calculator operator to typed values. The result has the
+ * type of operand2 (and its word size, for a fixed-width integer);
+ * operand1 is converted to that first. Integers use
+ * performIntegerCalculation, fixed-width integers fixedIntCalculate,
+ * extended values performExtendedCalculation and _bigDecimal values
+ * performBigCalculation at the engine's precision. Operators a type has
+ * no implementation for are evaluated by performAdvancedCalculation in
+ * double precision and the result is converted back (truncated for
+ * integers).
  *
- * The function handles potential errors during dialog creation and displays
- * an error message if necessary.
+ * On failure the engine's errorState and errorCodeBase are set, as
+ * performAdvancedCalculation does, and result is unspecified.
  *
- * @param buttonID  The resource ID of the dialog template for the statistics window.
+ * @param engine       The calculator session.
+ * @param operatorKey  The IDC_BUTTON_* ID of the operator.
+ * @param result       Receives the result. May alias either operand.
+ * @param operand1     Left operand.
+ * @param operand2     Right operand, or the only operand of a unary operator.
+ * @return             STATUS_SUCCESS or one of the STATUS_* error codes.
  */
-void toggleStatisticsWindow(UINT buttonID) {
-    if (calcState.statisticsWindowOpen) {
-        // Close the statistics window
-        DestroyWindow(calcState.statisticsWindow);
-        calcState.statisticsWindow = NULL;
-        calcState.statisticsWindowOpen = FALSE;
+int performValueCalculation(_calcEngine* engine, uint32_t operatorKey, _calcValue* result,
+    const _calcValue* operand1, const _calcValue* operand2) {
+    _valueType type = operand2->type;
+    int precision = (type == VALUE_TYPE_FIXED) ? operand2->fixed.bits : engine->precisionDigits;
+    _calcValue converted;
+    _extendedFloat80 extended;
+    _fixedInt fixed;
+    int64_t integer;
+    int status = STATUS_SUCCESS;
+
+    valueInit(&converted);
+    if (operand1->type != type || (type == VALUE_TYPE_FIXED && operand1->fixed.bits != precision)) {
+        status = valueCopy(&converted, operand1);
+        if (status == STATUS_SUCCESS) {
+            status = valueConvert(&converted, type, precision);
+        }
+        operand1 = &converted;
     }
-    else {
-        // Create and show the statistics window
-        calcState.statisticsWindow = CreateDialogParamA(
-            calcState.appInstance,
-            MAKEINTRESOURCE(buttonID),
-            calcState.windowHandle,
-            statisticsWindowProc,
-            0);
-
-        if (calcState.statisticsWindow != NULL) {
-            ShowWindow(calcState.statisticsWindow, SW_SHOW);
-            calcState.statisticsWindowOpen = TRUE;
+
+    if (status == STATUS_SUCCESS) {
+        switch (type) {
+        case VALUE_TYPE_INTEGER:
+            status = performIntegerCalculation(operatorKey, &integer, operand1->integer, operand2->integer);
+            if (status == STATUS_SUCCESS) {
+                valueSetInteger(result, integer);
+            }
+            break;
+
+        case VALUE_TYPE_FIXED:
+            status = fixedIntCalculate(operatorKey, &fixed, &operand1->fixed, &operand2->fixed);
+            if (status == STATUS_SUCCESS) {
+                valueSetFixed(result, &fixed);
+            }
+            break;
+
+        case VALUE_TYPE_EXTENDED:
+            status = performExtendedCalculation(operatorKey, &extended, &operand1->extended, &operand2->extended);
+            if (status == STATUS_SUCCESS) {
+                valueSetExtended(result, &extended);
+            }
+            break;
+
+        case VALUE_TYPE_BIG:
+            if (result->type != VALUE_TYPE_BIG) {
+                valueFree(result);
+                result->type = VALUE_TYPE_BIG;
+                bigDecimalInit(&result->big);
+            }
+            status = performBigCalculation(engine, operatorKey, &result->big, &operand1->big, &operand2->big);
+            break;
+
+        default:
+            status = STATUS_UNDEFINED_RESULT;
+            break;
+        }
+    }
+
+    // No implementation for this type: compute in double precision
+    if (status == STATUS_UNDEFINED_RESULT) {
+        double value = performAdvancedCalculation(engine, operatorKey, valueToDouble(operand1), valueToDouble(operand2));
+        if (engine->errorState != ERROR_STATE_INACTIVE) {
+            valueFree(&converted);
+            return (int)engine->errorCodeBase;
+        }
+        valueSetDouble(result, value);
+        status = valueConvert(result, type, precision);
+    }
+
+    valueFree(&converted);
+    if (status != STATUS_SUCCESS) {
+        setCalculationError(engine, status);
+    }
+    return status;
+}
+
+/*
+ * formatNumberForDisplay
+ *
+ * Parses a result string (C locale, '.' as decimal point) and rewrites it
+ * with at most `precision` significant digits, in the "%g" layout.
+ *
+ * @param destination  Output buffer of at least MAX_DISPLAY_DIGITS bytes.
+ * @param source       Result string, as produced by the operator pipeline.
+ * @param precision    Number of significant digits to keep.
+ */
+void formatNumberForDisplay(char* destination, const char* source, int precision) {
+    double value = strtod(source, NULL);
+    formatDouble(destination, MAX_DISPLAY_DIGITS, value, NUMBER_LAYOUT_AUTOMATIC, precision, '.');
+}
+
+/*
+ * formatFloatAutomatically
+ *
+ * Lays out a number formatted by formatNumberForDisplay the way the
+ * calculator shows it: integers get a trailing decimal separator ("12."),
+ * and '.' is replaced by the user's decimal separator. Exponential results
+ * produced by "%g" are left in exponential form.
+ *
+ * destination and source may be the same buffer.
+ */
+void formatFloatAutomatically(char* destination, const char* source, char decimalSeparator) {
+    char buffer[MAX_DISPLAY_DIGITS];
+    size_t length = 0;
+    bool hasSeparator = false;
+
+    for (const char* p = source; *p != '\0' && length < sizeof(buffer) - 2; p++) {
+        if (*p == '.') {
+            buffer[length++] = decimalSeparator;
+            hasSeparator = true;
         }
         else {
-            // Handle error creating the statistics window 
-            DWORD errorCode = GetLastError();
-            TCHAR errorMessage[100];
-            wsprintf(errorMessage, TEXT("Error creating statistics window: %d"), errorCode);
-            MessageBox(calcState.windowHandle, errorMessage, calcState.className, MB_OK | MB_ICONERROR);
+            if (*p == 'e') {
+                hasSeparator = true; // Keep "%g" exponents as they are
+            }
+            buffer[length++] = *p;
         }
     }
+    if (!hasSeparator) {
+        buffer[length++] = decimalSeparator;
+    }
+    buffer[length] = '\0';
+    memcpy(destination, buffer, length + 1);
+}
+
+/*
+ * formatScientificNotation
+ *
+ * Formats a number as d.ddde+XX with MAX_DECIMAL_DIGITS significant
+ * digits, dropping trailing zeros of the mantissa and using the user's
+ * decimal separator.
+ *
+ * destination and source may be the same buffer.
+ */
+void formatScientificNotation(char* destination, const char* source, char decimalSeparator) {
+    double value = strtod(source, NULL);
+    formatDouble(destination, MAX_DISPLAY_DIGITS, value, NUMBER_LAYOUT_SCIENTIFIC, MAX_DECIMAL_DIGITS,
+        decimalSeparator);
+}
+
+/*
+ * intToBaseString
+ *
+ * Converts an unsigned 32-bit value to a string in base 2, 8, 10 or 16.
+ * Hexadecimal digits are produced in upper case.
+ *
+ * @param value   Value to convert.
+ * @param buffer  Output buffer; 33 bytes are enough for any base.
+ * @param base    Number base (2..16).
+ */
+void intToBaseString(uint32_t value, char* buffer, int base) {
+    static const char digits[] = "0123456789ABCDEF";
+    char reversed[33];
+    int length = 0;
+
+    do {
+        reversed[length++] = digits[value % (uint32_t)base];
+        value /= (uint32_t)base;
+    } while (value != 0);
+
+    for (int i = 0; i < length; i++) {
+        buffer[i] = reversed[length - 1 - i];
+    }
+    buffer[length] = '\0';
 }
@@ -0,0 +1,373 @@
+/*-----------------------------------------------------------------------------
+    optimize.c --  Constant folding and common subexpression elimination
+                   for compiled expressions (reconstructed code).
+
+               expressionOptimize replays the instructions of an
+               _expression on a stack of node numbers instead of values,
+               which turns them back into the formula's tree. Every node
+               goes through a hash table keyed on its opcode, operand and
+               child nodes before it is added ("hash-consing"), so two
+               identical subtrees become one node and the tree becomes a
+               DAG.
+
+               While the DAG is built, an operator whose operands are all
+               constants is evaluated on the spot and replaced by its
+               value. This folds pi, the angle mode factors, constant
+               function arguments and the truncations of the integer
+               bases. The folding runs the operator through
+               expressionEvaluate, so a folded value has the same bits as
+               the one computed at evaluation time. An operator that fails
+               (1/0, sqrt(-1)) or overflows is not folded, so the
+               evaluation still fails with the same status.
+
+               The DAG is then written back as instructions. A node used
+               more than once is computed the first time it is needed,
+               kept with EXPRESSION_OP_STORE and pushed again with
+               EXPRESSION_OP_LOAD. Both walks use explicit stacks, so
+               nesting depth is still limited only by memory.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//optimize.h"
+
+#define NO_NODE (-1)
+
+typedef struct {
+    _expressionOpcode opcode;  // EXPRESSION_OP_CONSTANT, _VARIABLE or an operator
+    uint32_t operand;          // Variable index
+    double value;              // Value of a constant
+    int operands[2];           // Operand nodes, NO_NODE when absent
+    int useCount;              // References from nodes the result depends on
+    int slot;                  // Constant or temporary index once emitted
+} _optimizerNode;
+
+typedef struct {
+    _optimizerNode* nodes;     // In order of creation: operands come first
+    int nodeCount;
+    int* table;                // Hash table of node indexes
+    size_t tableMask;
+} _nodeSet;
+
+typedef struct {
+    int node;
+    int nextOperand;           // Operand to emit next
+} _emitFrame;
+
+/*
+ * hashNode
+ */
+static size_t hashNode(const _optimizerNode* node)
+{
+    uint64_t bits;
+    uint64_t hash = (uint64_t)node->opcode;
+
+    memcpy(&bits, &node->value, sizeof(bits));
+    hash = hash * 0x9E3779B97F4A7C15ull + bits;
+    hash = hash * 0x9E3779B97F4A7C15ull + node->operand;
+    hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)node->operands[0];
+    hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)node->operands[1];
+    return (size_t)(hash ^ (hash >> 29));
+}
+
+/*
+ * isSameNode
+ *
+ * Constants are compared by their bits, so 0 and -0 stay apart.
+ */
+static bool isSameNode(const _optimizerNode* a, const _optimizerNode* b)
+{
+    return a->opcode == b->opcode && a->operand == b->operand && memcmp(&a->value, &b->value, sizeof(double)) == 0 &&
+           a->operands[0] == b->operands[0] && a->operands[1] == b->operands[1];
+}
+
+/*
+ * internNode
+ *
+ * @return  The index of the node equal to candidate, added if there was
+ *          none. The set has room for every instruction of the expression.
+ */
+static int internNode(_nodeSet* set, const _optimizerNode* candidate)
+{
+    size_t index = hashNode(candidate) & set->tableMask;
+
+    while (set->table[index] != NO_NODE) {
+        if (isSameNode(&set->nodes[set->table[index]], candidate)) {
+            return set->table[index];
+        }
+        index = (index + 1) & set->tableMask;
+    }
+    set->table[index] = set->nodeCount;
+    set->nodes[set->nodeCount] = *candidate;
+    return set->nodeCount++;
+}
+
+/*
+ * foldNode
+ *
+ * Evaluates an operator whose operands are all constants, with a
+ * two-instruction expression run by expressionEvaluate.
+ *
+ * @return  True if node could be folded into *value.
+ */
+static bool foldNode(const _nodeSet* set, const _optimizerNode* node, double* value)
+{
+    uint32_t code[4];
+    double constants[2], stack[2];
+    _expression expression;
+    int operandCount = expressionGetOperandCount(node->opcode);
+    int length = 0;
+
+    for (int i = 0; i < operandCount; i++) {
+        const _optimizerNode* operand = &set->nodes[node->operands[i]];
+        if (operand->opcode != EXPRESSION_OP_CONSTANT) {
+            return false;
+        }
+        constants[i] = operand->value;
+        code[length++] = ((uint32_t)i << EXPRESSION_OPERAND_SHIFT) | EXPRESSION_OP_CONSTANT;
+    }
+    code[length++] = (uint32_t)node->opcode;
+    code[length++] = EXPRESSION_OP_RETURN;
+
+    expressionInit(&expression);
+    expression.code = code;
+    expression.codeLength = length;
+    expression.constants = constants;
+    expression.stack = stack;
+    expression.stackSize = 2;
+    return expressionEvaluate(&expression, NULL, value) == STATUS_SUCCESS;
+}
+
+/*
+ * buildGraph
+ *
+ * Replays the instructions on a stack of node indexes.
+ *
+ * @param values       Scratch stack of expression->stackSize entries.
+ * @param temporaries  Node held by each temporary of an expression that
+ *                     was optimized before.
+ * @return             The node of the result.
+ */
+static int buildGraph(_nodeSet* set, const _expression* expression, int* values, int* temporaries)
+{
+    int depth = 0;
+
+    for (int i = 0; i < expression->codeLength; i++) {
+        _expressionOpcode opcode = EXPRESSION_OPCODE(expression->code[i]);
+        uint32_t operand = EXPRESSION_OPERAND(expression->code[i]);
+        _optimizerNode node = { opcode, 0, 0.0, { NO_NODE, NO_NODE }, 0, NO_NODE };
+        double value;
+
+        switch (opcode) {
+        case EXPRESSION_OP_RETURN:
+            return values[depth - 1];
+        case EXPRESSION_OP_STORE:
+            temporaries[operand] = values[depth - 1];
+            continue;
+        case EXPRESSION_OP_LOAD:
+            values[depth++] = temporaries[operand];
+            continue;
+        case EXPRESSION_OP_CONSTANT:
+            node.value = expression->constants[operand];
+            break;
+        case EXPRESSION_OP_VARIABLE:
+            node.operand = operand;
+            break;
+        default:
+            for (int k = expressionGetOperandCount(opcode) - 1; k >= 0; k--) {
+                node.operands[k] = values[--depth];
+            }
+            if (foldNode(set, &node, &value)) {
+                node.opcode = EXPRESSION_OP_CONSTANT;
+                node.value = value;
+                node.operands[0] = NO_NODE;
+                node.operands[1] = NO_NODE;
+            }
+            break;
+        }
+        values[depth++] = internNode(set, &node);
+    }
+    return NO_NODE;  // Not reached: the compiler always ends with EXPRESSION_OP_RETURN
+}
+
+/*
+ * countUses
+ *
+ * Counts the references to each node from the nodes the result depends
+ * on; nodes whose value was folded into a constant are no longer among
+ * them. Operands always precede their users, so one backward pass works.
+ */
+static void countUses(_nodeSet* set, int root)
+{
+    set->nodes[root].useCount = 1;
+    for (int i = set->nodeCount - 1; i >= 0; i--) {
+        const _optimizerNode* node = &set->nodes[i];
+        if (node->useCount > 0) {
+            for (int k = 0; k < 2 && node->operands[k] != NO_NODE; k++) {
+                set->nodes[node->operands[k]].useCount++;
+            }
+        }
+    }
+}
+
+/*
+ * emitGraph
+ *
+ * Writes the DAG under root back as instructions, in the original order
+ * of evaluation, and sets the new stack depth and temporary count.
+ *
+ * @param code       Room for 4 instructions per node, plus RETURN.
+ * @param constants  Room for one constant per node.
+ * @param frames     Room for one frame per node.
+ * @return           The number of instructions.
+ */
+static int emitGraph(_nodeSet* set, int root, uint32_t* code, double* constants, int* constantCount,
+    _emitFrame* frames, int* stackSize, int* temporaryCount)
+{
+    int length = 0, depth = 0, top = 0;
+
+    *constantCount = 0;
+    *temporaryCount = 0;
+    *stackSize = 0;
+    frames[top].node = root;
+    frames[top].nextOperand = 0;
+    top++;
+
+    while (top > 0) {
+        _emitFrame* frame = &frames[top - 1];
+        _optimizerNode* node = &set->nodes[frame->node];
+        uint32_t instruction;
+
+        if (node->opcode == EXPRESSION_OP_CONSTANT) {
+            if (node->slot == NO_NODE) {
+                node->slot = (*constantCount)++;
+                constants[node->slot] = node->value;
+            }
+            instruction = ((uint32_t)node->slot << EXPRESSION_OPERAND_SHIFT) | EXPRESSION_OP_CONSTANT;
+        }
+        else if (node->opcode == EXPRESSION_OP_VARIABLE) {
+            instruction = (node->operand << EXPRESSION_OPERAND_SHIFT) | EXPRESSION_OP_VARIABLE;
+        }
+        else if (frame->nextOperand == 0 && node->slot != NO_NODE) {
+            instruction = ((uint32_t)node->slot << EXPRESSION_OPERAND_SHIFT) | EXPRESSION_OP_LOAD;
+        }
+        else if (frame->nextOperand < expressionGetOperandCount(node->opcode)) {
+            frames[top].node = node->operands[frame->nextOperand++];
+            frames[top].nextOperand = 0;
+            top++;
+            continue;
+        }
+        else {
+            code[length++] = (uint32_t)node->opcode;
+            if (expressionGetOperandCount(node->opcode) == 2) {
+                depth--;
+            }
+            if (node->useCount > 1) {
+                node->slot = (*temporaryCount)++;
+                code[length++] = ((uint32_t)node->slot << EXPRESSION_OPERAND_SHIFT) | EXPRESSION_OP_STORE;
+            }
+            top--;
+            continue;
+        }
+
+        // A value pushed: a constant, a variable or a temporary
+        code[length++] = instruction;
+        if (++depth > *stackSize) {
+            *stackSize = depth;
+        }
+        top--;
+    }
+    code[length++] = EXPRESSION_OP_RETURN;
+    return length;
+}
+
+/*
+ * expressionOptimize
+ *
+ * Folds constants and shares repeated subexpressions of a compiled
+ * expression in place. The variables keep their indexes. Any _jitCode
+ * made from the expression must be compiled again.
+ *
+ * @param expression  A successfully compiled expression.
+ * @return            STATUS_SUCCESS, STATUS_INVALID_INPUT if the
+ *                    expression did not compile, or
+ *                    STATUS_INSUFFICIENT_MEMORY (the expression is then
+ *                    unchanged).
+ */
+int expressionOptimize(_expression* expression)
+{
+    _nodeSet set = { 0 };
+    size_t nodeLimit = (size_t)expression->codeLength;
+    size_t tableSize = 16;
+    int status = STATUS_SUCCESS;
+
+    if (expression->codeLength == 0) {
+        return STATUS_INVALID_INPUT;
+    }
+    while (tableSize < 2 * nodeLimit) {
+        tableSize *= 2;
+    }
+
+    set.nodes = malloc(nodeLimit * sizeof(_optimizerNode));
+    set.table = malloc(tableSize * sizeof(int));
+    set.tableMask = tableSize - 1;
+    int* values = malloc(((size_t)expression->stackSize + 1) * sizeof(int));
+    int* temporaries = malloc(((size_t)expression->temporaryCount + 1) * sizeof(int));
+    uint32_t* code = malloc((4 * nodeLimit + 1) * sizeof(uint32_t));
+    double* constants = malloc(nodeLimit * sizeof(double));
+    _emitFrame* frames = malloc(nodeLimit * sizeof(_emitFrame));
+
+    if (set.nodes == NULL || set.table == NULL || values == NULL || temporaries == NULL || code == NULL ||
+        constants == NULL || frames == NULL) {
+        status = STATUS_INSUFFICIENT_MEMORY;
+    }
+    else {
+        int constantCount, stackSize, temporaryCount;
+
+        for (size_t i = 0; i < tableSize; i++) {
+            set.table[i] = NO_NODE;
+        }
+        int root = buildGraph(&set, expression, values, temporaries);
+        countUses(&set, root);
+        int length = emitGraph(&set, root, code, constants, &constantCount, frames, &stackSize, &temporaryCount);
+
+        // The temporaries live after the evaluation stack
+        if ((size_t)expression->stackCapacity < (size_t)stackSize + (size_t)temporaryCount) {
+            double* stack = realloc(expression->stack, ((size_t)stackSize + (size_t)temporaryCount) * sizeof(double));
+            if (stack == NULL) {
+                status = STATUS_INSUFFICIENT_MEMORY;
+            }
+            else {
+                expression->stack = stack;
+                expression->stackCapacity = stackSize + temporaryCount;
+            }
+        }
+        if (status == STATUS_SUCCESS) {
+            free(expression->code);
+            free(expression->constants);
+            expression->code = code;
+            expression->codeLength = length;
+            expression->codeCapacity = (int)(4 * nodeLimit + 1);
+            expression->constants = constants;
+            expression->constantCount = constantCount;
+            expression->constantCapacity = (int)nodeLimit;
+            expression->stackSize = stackSize;
+            expression->temporaryCount = temporaryCount;
+            code = NULL;
+            constants = NULL;
+        }
+    }
+
+    free(set.nodes);
+    free(set.table);
+    free(values);
+    free(temporaries);
+    free(code);
+    free(constants);
+    free(frames);
+    return status;
+}
@@ -0,0 +1,445 @@
+/*-----------------------------------------------------------------------------
+    quantile.c --  Quantile sketch of the statistics box (reconstructed
+                   code).
+
+               The statistics box keeps every point, so an exact median is
+               a sort away, but a sort per query is too slow for data sets
+               of millions of points that grow one point at a time. The
+               sketch here answers median and percentile queries in time
+               and memory fixed by its compression (the t-digest of
+               Dunning and Ertl, merging variant):
+
+               - Points go into a buffer behind the merged centroids.
+               - When the buffer is full, it is sorted by mean and merged
+                 with the centroids from left to right. A centroid may
+                 grow while it spans at most one unit of the scale function
+                 k(q) = compression / (2 pi) * asin(2q - 1), which is steep
+                 near q = 0 and q = 1, so the tails stay in small
+                 centroids and the percentiles there stay accurate.
+               - A quantile is interpolated linearly between the
+                 centroid centers, and between the outer centroids and
+                 the exact minimum and maximum. The buffer is sorted
+                 (by insertion, after a query per point) and read
+                 alongside the centroids, so a query does not merge.
+
+               Small data sets (up to about compression / 2 points) are
+               never merged, and their quantiles are the usual
+               interpolation between the sorted points.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//quantile.h"
+#include ".//headers//engine.h"
+
+#define BUFFER_FACTOR 3  // Buffered points per unit of compression
+#define SORT_RUN 16       // Points sorted by insertion before merging
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/*
+ * getWeightLimit
+ *
+ * Fraction of the total weight that a centroid starting at fraction q may
+ * reach: k^-1(k(q) + 1).
+ */
+static double getWeightLimit(double compression, double q)
+{
+    double k = compression / (2.0 * M_PI) * asin(2.0 * q - 1.0) + 1.0;
+    if (k >= compression / 4.0) {
+        return 1.0;
+    }
+    return (sin(k * 2.0 * M_PI / compression) + 1.0) / 2.0;
+}
+
+/*
+ * allocateCentroids
+ *
+ * Allocates the centroids on first use: at most compression + 1 merged
+ * ones (each spans at least half a unit of k, which spans
+ * compression / 2) and the buffer, then as much scratch space.
+ */
+static int allocateCentroids(_quantileSketch* sketch)
+{
+    if (sketch->capacity != 0) {
+        return STATUS_SUCCESS;
+    }
+    if (sketch->compression == 0.0) {
+        sketch->compression = DEFAULT_QUANTILE_COMPRESSION;
+    }
+
+    size_t units = (size_t)ceil(sketch->compression);
+    size_t capacity = units + 2 + BUFFER_FACTOR * units;
+    sketch->centroids = malloc(2 * capacity * sizeof(_centroid));
+    if (sketch->centroids == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    sketch->scratch = sketch->centroids + capacity;
+    sketch->capacity = capacity;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * mergeRuns
+ *
+ * Merges two runs sorted by mean into destination, stably.
+ */
+static void mergeRuns(const _centroid* left, size_t leftCount, const _centroid* right, size_t rightCount,
+    _centroid* destination)
+{
+    size_t i = 0, j = 0;
+
+    // Without branches, which the random order of new points would mispredict
+    while (i < leftCount && j < rightCount) {
+        size_t isRight = right[j].mean < left[i].mean;
+        const _centroid* next = isRight ? &right[j] : &left[i];
+        *destination++ = *next;
+        j += isRight;
+        i += 1 - isRight;
+    }
+    memcpy(destination, left + i, (leftCount - i) * sizeof(_centroid));
+    memcpy(destination + (leftCount - i), right + j, (rightCount - j) * sizeof(_centroid));
+}
+
+/*
+ * insertPoints
+ *
+ * Sorts points[0 .. count) by mean by insertion, the first sorted of
+ * them being sorted already.
+ */
+static void insertPoints(_centroid* points, size_t sorted, size_t count)
+{
+    for (; sorted < count; sorted++) {
+        _centroid point = points[sorted];
+        size_t i = sorted;
+        while (i > 0 && points[i - 1].mean > point.mean) {
+            points[i] = points[i - 1];
+            i--;
+        }
+        points[i] = point;
+    }
+}
+
+/*
+ * sortBuffer
+ *
+ * Sorts the buffered points by mean. A few new points (one per query when
+ * the statistics box asks after every point) are inserted into the sorted
+ * part; otherwise runs of SORT_RUN points are sorted by insertion and
+ * merged bottom-up through scratch.
+ */
+static void sortBuffer(_quantileSketch* sketch)
+{
+    _centroid* buffer = sketch->centroids + sketch->mergedCount;
+    size_t count = sketch->count - sketch->mergedCount;
+
+    if (sketch->sortedCount == count) {
+        return;
+    }
+    if (count - sketch->sortedCount <= SORT_RUN) {
+        insertPoints(buffer, sketch->sortedCount, count);
+    }
+    else {
+        _centroid* source = buffer;
+        _centroid* destination = sketch->scratch;
+        for (size_t start = 0; start < count; start += SORT_RUN) {
+            insertPoints(buffer + start, 1, (count - start < SORT_RUN) ? count - start : SORT_RUN);
+        }
+        for (size_t width = SORT_RUN; width < count; width *= 2) {
+            for (size_t start = 0; start < count; start += 2 * width) {
+                size_t middle = (start + width < count) ? start + width : count;
+                size_t end = (start + 2 * width < count) ? start + 2 * width : count;
+                mergeRuns(source + start, middle - start, source + middle, end - middle, destination + start);
+            }
+            _centroid* swap = source;
+            source = destination;
+            destination = swap;
+        }
+        if (source != buffer) {
+            memcpy(buffer, source, count * sizeof(_centroid));
+        }
+    }
+    sketch->sortedCount = count;
+}
+
+/*
+ * mergeBuffer
+ *
+ * Merges the sorted buffer with the centroids, then compresses them from
+ * left to right, each centroid growing up to its weight limit.
+ */
+static void mergeBuffer(_quantileSketch* sketch)
+{
+    _centroid* centroids = sketch->centroids;
+    _centroid* all = sketch->scratch;
+    double total = sketch->totalWeight;
+
+    if (sketch->count == sketch->mergedCount) {
+        return;
+    }
+    sortBuffer(sketch);
+    mergeRuns(centroids, sketch->mergedCount, centroids + sketch->mergedCount, sketch->count - sketch->mergedCount,
+        all);
+
+    size_t merged = 0;
+    double before = 0.0;
+    double limit = total * getWeightLimit(sketch->compression, 0.0);
+    _centroid current = all[0];
+
+    for (size_t i = 1; i < sketch->count; i++) {
+        double weight = current.weight + all[i].weight;
+        if (before + weight <= limit) {
+            current.mean += (all[i].mean - current.mean) * (all[i].weight / weight);
+            current.weight = weight;
+        }
+        else {
+            centroids[merged++] = current;
+            before += current.weight;
+            limit = total * getWeightLimit(sketch->compression, before / total);
+            current = all[i];
+        }
+    }
+    centroids[merged++] = current;
+    sketch->mergedCount = merged;
+    sketch->sortedCount = 0;
+    sketch->count = merged;
+}
+
+/*
+ * addCentroid
+ */
+static void addCentroid(_quantileSketch* sketch, double mean, double weight, double minimum, double maximum)
+{
+    if (sketch->count == sketch->capacity) {
+        mergeBuffer(sketch);
+    }
+    if (sketch->totalWeight == 0.0) {
+        sketch->minimum = minimum;
+        sketch->maximum = maximum;
+    }
+    else {
+        sketch->minimum = (minimum < sketch->minimum) ? minimum : sketch->minimum;
+        sketch->maximum = (maximum > sketch->maximum) ? maximum : sketch->maximum;
+    }
+    sketch->centroids[sketch->count].mean = mean;
+    sketch->centroids[sketch->count].weight = weight;
+    sketch->count++;
+    sketch->totalWeight += weight;
+}
+
+/*
+ * quantileSketchInit
+ *
+ * Makes sketch empty with the given compression, clamped to
+ * MIN_QUANTILE_COMPRESSION .. MAX_QUANTILE_COMPRESSION; 0 selects
+ * DEFAULT_QUANTILE_COMPRESSION. Zero-filled memory is an empty sketch
+ * with the default. Memory is allocated with the first point.
+ */
+void quantileSketchInit(_quantileSketch* sketch, double compression)
+{
+    memset(sketch, 0, sizeof(*sketch));
+    if (compression != 0.0) {
+        sketch->compression = fmin(fmax(compression, MIN_QUANTILE_COMPRESSION), MAX_QUANTILE_COMPRESSION);
+    }
+}
+
+/*
+ * quantileSketchFree
+ *
+ * Releases the centroids; the compression is kept.
+ */
+void quantileSketchFree(_quantileSketch* sketch)
+{
+    double compression = sketch->compression;
+
+    free(sketch->centroids);
+    quantileSketchInit(sketch, compression);
+}
+
+/*
+ * quantileSketchClear
+ *
+ * Removes every point. The memory is kept.
+ */
+void quantileSketchClear(_quantileSketch* sketch)
+{
+    sketch->mergedCount = 0;
+    sketch->sortedCount = 0;
+    sketch->count = 0;
+    sketch->totalWeight = 0.0;
+    sketch->minimum = 0.0;
+    sketch->maximum = 0.0;
+}
+
+/*
+ * quantileSketchAdd
+ *
+ * Adds one point in amortized O(log compression).
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if point is not finite,
+ *          or STATUS_INSUFFICIENT_MEMORY.
+ */
+int quantileSketchAdd(_quantileSketch* sketch, double point)
+{
+    if (!isfinite(point)) {
+        return STATUS_INVALID_INPUT;
+    }
+    int status = allocateCentroids(sketch);
+    if (status == STATUS_SUCCESS) {
+        addCentroid(sketch, point, 1.0, point, point);
+    }
+    return status;
+}
+
+/*
+ * quantileSketchAddPoints
+ *
+ * quantileSketchAdd for count points; stops at the first that is not
+ * finite.
+ */
+int quantileSketchAddPoints(_quantileSketch* sketch, const double* points, size_t count)
+{
+    int status = STATUS_SUCCESS;
+
+    for (size_t i = 0; i < count && status == STATUS_SUCCESS; i++) {
+        status = quantileSketchAdd(sketch, points[i]);
+    }
+    return status;
+}
+
+/*
+ * quantileSketchMerge
+ *
+ * Adds the points of other to sketch, as its centroids. other is not
+ * changed and may have a different compression.
+ *
+ * @return  STATUS_SUCCESS or STATUS_INSUFFICIENT_MEMORY.
+ */
+int quantileSketchMerge(_quantileSketch* sketch, const _quantileSketch* other)
+{
+    if (other->totalWeight == 0.0) {
+        return STATUS_SUCCESS;
+    }
+    int status = allocateCentroids(sketch);
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    for (size_t i = 0; i < other->count; i++) {
+        addCentroid(sketch, other->centroids[i].mean, other->centroids[i].weight, other->minimum, other->maximum);
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * _cumulativeWeight
+ *
+ * Cursor over the piecewise linear cumulative weight of a run of
+ * centroids sorted by mean: 0 at the minimum, the weight before a
+ * centroid plus half its own at its mean, and all of it at the maximum.
+ */
+typedef struct {
+    const _centroid* centroids;
+    size_t count;
+    size_t index;                // First centroid with a mean above the last position
+    double before;               // Weight of the centroids before index
+    double total;
+    double minimum;
+    double maximum;
+} _cumulativeWeight;
+
+/*
+ * getCumulativeWeight
+ *
+ * Cumulative weight at position x; positions must not decrease from one
+ * call to the next.
+ */
+static double getCumulativeWeight(_cumulativeWeight* cursor, double x)
+{
+    const _centroid* centroids = cursor->centroids;
+
+    while (cursor->index < cursor->count && centroids[cursor->index].mean <= x) {
+        cursor->before += centroids[cursor->index].weight;
+        cursor->index++;
+    }
+
+    size_t index = cursor->index;
+    double lowX = (index == 0) ? cursor->minimum : centroids[index - 1].mean;
+    double lowWeight = (index == 0) ? 0.0 : cursor->before - centroids[index - 1].weight / 2.0;
+    double highX = (index == cursor->count) ? cursor->maximum : centroids[index].mean;
+    double highWeight = (index == cursor->count) ? cursor->total : cursor->before + centroids[index].weight / 2.0;
+
+    if (highX <= lowX) {
+        return highWeight;
+    }
+    return lowWeight + (highWeight - lowWeight) * ((x - lowX) / (highX - lowX));
+}
+
+/*
+ * quantileSketchGetQuantile
+ *
+ * Estimates the value below which the given fraction of the points lie
+ * (0.5 for the median, 0.99 for p99). Fractions 0 and 1 give the exact
+ * minimum and maximum. The merged centroids and the sorted buffer each
+ * give a piecewise linear cumulative weight; their sum is inverted by
+ * walking both in order of mean, in O(compression) and without merging.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if the sketch is
+ *          empty, or STATUS_INVALID_INPUT if fraction is not in [0, 1].
+ */
+int quantileSketchGetQuantile(_quantileSketch* sketch, double fraction, double* result)
+{
+    if (sketch->totalWeight == 0.0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (!(fraction >= 0.0 && fraction <= 1.0)) {
+        return STATUS_INVALID_INPUT;
+    }
+    sortBuffer(sketch);
+
+    size_t bufferCount = sketch->count - sketch->mergedCount;
+    _cumulativeWeight merged = { sketch->centroids, sketch->mergedCount, 0, 0.0,
+        sketch->totalWeight - (double)bufferCount, sketch->minimum, sketch->maximum };
+    _cumulativeWeight buffer = { sketch->centroids + sketch->mergedCount, bufferCount, 0, 0.0,
+        (double)bufferCount, sketch->minimum, sketch->maximum };
+    double target = fraction * sketch->totalWeight;
+    double lastX = sketch->minimum;
+    double lastWeight = getCumulativeWeight(&merged, lastX) + getCumulativeWeight(&buffer, lastX);
+
+    if (target <= lastWeight) {
+        *result = lastX;
+        return STATUS_SUCCESS;
+    }
+
+    // Both are linear between the means of either, and so is the sum
+    size_t i = merged.index, j = buffer.index;
+    while (i < merged.count || j < buffer.count) {
+        double x;
+        if (j == buffer.count || (i < merged.count && merged.centroids[i].mean <= buffer.centroids[j].mean)) {
+            x = merged.centroids[i++].mean;
+        }
+        else {
+            x = buffer.centroids[j++].mean;
+        }
+
+        double weight = getCumulativeWeight(&merged, x) + getCumulativeWeight(&buffer, x);
+        if (target <= weight) {
+            *result = lastX + (x - lastX) * ((target - lastWeight) / (weight - lastWeight));
+            return STATUS_SUCCESS;
+        }
+        lastX = x;
+        lastWeight = weight;
+    }
+
+    double rest = sketch->totalWeight - lastWeight;
+    double share = (rest > 0.0) ? (target - lastWeight) / rest : 1.0;
+    *result = lastX + (sketch->maximum - lastX) * share;
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*-----------------------------------------------------------------------------
+    radixsort.c --  Radix sort of statistics data points (reconstructed
+                    code).
+
+               Exact medians, quartiles and histograms need the points in
+               order. A comparison sort of millions of doubles mispredicts
+               about one branch in two; a radix sort makes a few passes
+               that never compare:
+
+               - Each double becomes a 64-bit key in numeric order (see
+                 radixKeyFromDouble), and the keys are sorted one byte at
+                 a time from the lowest, each pass stable, between the
+                 keys and a scratch copy.
+               - One pass over the keys counts every byte at once. A byte
+                 that all keys share (the sign and the high exponent bits
+                 of data in a narrow range) needs no pass of its own.
+               - Large counts are cut into one slice per thread. Each
+                 thread counts the bytes of its slice; the counts of all
+                 slices give each thread the places of its keys in every
+                 bucket, and the threads then move their keys at once.
+                 The order, and so the result, is the same for any
+                 number of threads.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//radixsort.h"
+#include ".//headers//engine.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define RADIX_THREADS 1
+#else
+#define RADIX_THREADS 0
+#endif
+
+#define RADIX_DIGITS 8               // Bytes of a key
+#define RADIX_BUCKETS 256
+#define ALL_DIGITS -1
+#define INSERTION_MAX_KEYS 64        // Fewer keys are sorted by insertion
+#define PARALLEL_MIN_KEYS (1u << 18) // Fewer keys are sorted on one thread
+#define MAX_RADIX_THREADS 64
+
+// One slice of the keys, sorted by one thread
+typedef struct {
+    const uint64_t* source;
+    uint64_t* destination;
+    size_t begin;
+    size_t end;
+    int digit;                                    // Byte of this pass, or ALL_DIGITS
+    size_t counts[RADIX_DIGITS][RADIX_BUCKETS];   // Keys per bucket, then the place of the next one
+} _radixWorker;
+
+/*
+ * sortByInsertion
+ */
+static void sortByInsertion(uint64_t* keys, size_t count)
+{
+    for (size_t sorted = 1; sorted < count; sorted++) {
+        uint64_t key = keys[sorted];
+        size_t i = sorted;
+        while (i > 0 && keys[i - 1] > key) {
+            keys[i] = keys[i - 1];
+            i--;
+        }
+        keys[i] = key;
+    }
+}
+
+/*
+ * countDigits
+ *
+ * Thread function: counts the keys of a slice per bucket of the digit of
+ * the pass, or of every digit.
+ */
+static int countDigits(void* argument)
+{
+    _radixWorker* worker = argument;
+    const uint64_t* source = worker->source;
+
+    if (worker->digit == ALL_DIGITS) {
+        memset(worker->counts, 0, sizeof(worker->counts));
+        for (size_t i = worker->begin; i < worker->end; i++) {
+            uint64_t key = source[i];
+            for (int digit = 0; digit < RADIX_DIGITS; digit++) {
+                worker->counts[digit][(key >> (8 * digit)) & 0xFF]++;
+            }
+        }
+        return 0;
+    }
+
+    size_t* counts = worker->counts[worker->digit];
+    int shift = 8 * worker->digit;
+    memset(counts, 0, RADIX_BUCKETS * sizeof(size_t));
+    for (size_t i = worker->begin; i < worker->end; i++) {
+        counts[(source[i] >> shift) & 0xFF]++;
+    }
+    return 0;
+}
+
+/*
+ * scatterKeys
+ *
+ * Thread function: moves the keys of a slice to their places for the
+ * digit of the pass.
+ */
+static int scatterKeys(void* argument)
+{
+    _radixWorker* worker = argument;
+    const uint64_t* source = worker->source;
+    uint64_t* destination = worker->destination;
+    size_t* places = worker->counts[worker->digit];
+    int shift = 8 * worker->digit;
+
+    for (size_t i = worker->begin; i < worker->end; i++) {
+        uint64_t key = source[i];
+        destination[places[(key >> shift) & 0xFF]++] = key;
+    }
+    return 0;
+}
+
+/*
+ * runWorkers
+ *
+ * Runs function for every worker, the first on this thread. A worker
+ * whose thread cannot be started runs here too.
+ */
+static void runWorkers(int (*function)(void*), _radixWorker* workers, unsigned threads)
+{
+#if RADIX_THREADS
+    thrd_t handles[MAX_RADIX_THREADS];
+    bool isStarted[MAX_RADIX_THREADS] = { false };
+
+    for (unsigned i = 1; i < threads; i++) {
+        isStarted[i] = (thrd_create(&handles[i], function, &workers[i]) == thrd_success);
+    }
+    function(&workers[0]);
+    for (unsigned i = 1; i < threads; i++) {
+        if (isStarted[i]) {
+            thrd_join(handles[i], NULL);
+        }
+        else {
+            function(&workers[i]);
+        }
+    }
+#else
+    for (unsigned i = 0; i < threads; i++) {
+        function(&workers[i]);
+    }
+#endif
+}
+
+/*
+ * radixSortKeys
+ *
+ * Sorts count keys in ascending order, on up to threads threads (0 or 1
+ * for one). Scratch space for a copy of the keys is allocated for the
+ * duration of the sort.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INSUFFICIENT_MEMORY (the keys are
+ *          then unchanged).
+ */
+int radixSortKeys(uint64_t* keys, size_t count, unsigned threads)
+{
+    if (count <= INSERTION_MAX_KEYS) {
+        sortByInsertion(keys, count);
+        return STATUS_SUCCESS;
+    }
+    if (threads == 0 || count < PARALLEL_MIN_KEYS || !RADIX_THREADS) {
+        threads = 1;
+    }
+    if (threads > MAX_RADIX_THREADS) {
+        threads = MAX_RADIX_THREADS;
+    }
+
+    uint64_t* scratch = malloc(count * sizeof(uint64_t));
+    _radixWorker* workers = malloc(threads * sizeof(_radixWorker));
+    if (scratch == NULL || workers == NULL) {
+        free(scratch);
+        free(workers);
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i].source = keys;
+        workers[i].begin = count * i / threads;
+        workers[i].end = count * (i + 1) / threads;
+        workers[i].digit = ALL_DIGITS;
+    }
+    runWorkers(countDigits, workers, threads);
+
+    uint64_t* source = keys;
+    uint64_t* destination = scratch;
+    bool isCounted = true;  // The counts of every digit describe the slices of source
+
+    for (int digit = 0; digit < RADIX_DIGITS; digit++) {
+        // The totals do not depend on the order of the keys
+        size_t bucket = (source[0] >> (8 * digit)) & 0xFF;
+        size_t shared = 0;
+        for (unsigned i = 0; i < threads; i++) {
+            shared += workers[i].counts[digit][bucket];
+        }
+        if (shared == count) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < threads; i++) {
+            workers[i].source = source;
+            workers[i].destination = destination;
+            workers[i].digit = digit;
+        }
+        if (!isCounted) {
+            runWorkers(countDigits, workers, threads);
+        }
+
+        // Bucket by bucket, and within a bucket slice by slice, which keeps the sort stable
+        size_t place = 0;
+        for (size_t b = 0; b < RADIX_BUCKETS; b++) {
+            for (unsigned i = 0; i < threads; i++) {
+                size_t keysInBucket = workers[i].counts[digit][b];
+                workers[i].counts[digit][b] = place;
+                place += keysInBucket;
+            }
+        }
+        runWorkers(scatterKeys, workers, threads);
+
+        uint64_t* swap = source;
+        source = destination;
+        destination = swap;
+        isCounted = false;
+    }
+
+    if (source != keys) {
+        memcpy(keys, source, count * sizeof(uint64_t));
+    }
+    free(scratch);
+    free(workers);
+    return STATUS_SUCCESS;
+}
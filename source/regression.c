@@ -0,0 +1,457 @@
+/*-----------------------------------------------------------------------------
+    regression.c --  Least-squares regression of the statistics box
+                     (reconstructed code).
+
+               Paired data fit y = a + b1 x1 + ... + bk xk by least
+               squares. Summing x*y, x^2 and the like and solving with
+               them cancels catastrophically for data with a large mean,
+               the way the textbook variance does, so the rows are kept as
+               Welford keeps single points:
+
+               - The means of the k + 1 columns and the co-moments
+                 C(a, b) = sum((a - mean a) * (b - mean b)) are updated
+                 with each row: adding a row with deviations d from the
+                 old means adds (n - 1) / n * d * d' to C, and removing
+                 one runs the update backwards. Both are O(k^2).
+               - The slopes solve the normal equations of the centered
+                 data, Cxx * b = Cxy, by Cholesky factorization of the
+                 k x k matrix Cxx; the intercept is mean y - b . mean x.
+                 The solution is kept until a row comes or goes.
+               - r^2 is b . Cxy / Cyy, and for one variable
+                 r = Cxy / sqrt(Cxx * Cyy) with its sign.
+               - Regressions of two parts of a data set merge with Chan's
+                 formula, C = Ca + Cb + na * nb / n * d * d' for the
+                 difference d of their means.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//regression.h"
+#include ".//headers//engine.h"
+
+#define INITIAL_ROW_CAPACITY 16
+
+/*
+ * resetMoments
+ *
+ * Recomputes the means and co-moments exactly from the (zero or one)
+ * rows left.
+ */
+static void resetMoments(_regression* regression)
+{
+    memset(regression->means, 0, sizeof(regression->means));
+    memset(regression->comoments, 0, sizeof(regression->comoments));
+    if (regression->count == 1) {
+        memcpy(regression->means, regression->rows, (regression->variables + 1) * sizeof(double));
+    }
+}
+
+/*
+ * updateMoments
+ *
+ * Adds weight * d * d' to the co-moments, d being the deviations of a
+ * row from the means.
+ */
+static void updateMoments(_regression* regression, const double* deviations, double weight)
+{
+    size_t columns = regression->variables + 1;
+
+    for (size_t i = 0; i < columns; i++) {
+        for (size_t j = i; j < columns; j++) {
+            regression->comoments[i][j] += weight * deviations[i] * deviations[j];
+            regression->comoments[j][i] = regression->comoments[i][j];
+        }
+        if (regression->comoments[i][i] < 0.0) {
+            regression->comoments[i][i] = 0.0;  // Rounding after a removal
+        }
+    }
+}
+
+/*
+ * reserveRows
+ *
+ * Makes room for capacity rows of the current width.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INSUFFICIENT_MEMORY (the rows are
+ *          then unchanged).
+ */
+static int reserveRows(_regression* regression, size_t capacity)
+{
+    size_t columns = regression->variables + 1;
+
+    if (capacity <= regression->capacity) {
+        return STATUS_SUCCESS;
+    }
+    if (capacity > SIZE_MAX / (columns * sizeof(double))) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+
+    double* rows = realloc(regression->rows, capacity * columns * sizeof(double));
+    if (rows == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    regression->rows = rows;
+    size_t* pointIndices = realloc(regression->pointIndices, capacity * sizeof(size_t));
+    if (pointIndices == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    regression->pointIndices = pointIndices;
+    regression->capacity = capacity;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * regressionInit
+ *
+ * Makes regression empty. Zero-filled memory is in the same state.
+ */
+void regressionInit(_regression* regression)
+{
+    memset(regression, 0, sizeof(*regression));
+}
+
+/*
+ * regressionFree
+ *
+ * Releases the rows and leaves regression empty.
+ */
+void regressionFree(_regression* regression)
+{
+    free(regression->rows);
+    free(regression->pointIndices);
+    regressionInit(regression);
+}
+
+/*
+ * regressionClear
+ *
+ * Removes every row. The memory is kept while the width stays the same.
+ */
+void regressionClear(_regression* regression)
+{
+    regression->count = 0;
+    regression->isSolved = false;
+    resetMoments(regression);
+}
+
+/*
+ * regressionAdd
+ *
+ * Appends a row of variables x values and y, in O(variables^2). The first
+ * row after the regression was empty sets the number of variables.
+ *
+ * @param pointIndex  Index of the statistics point holding y; larger than
+ *                    that of every row before.
+ * @return            STATUS_SUCCESS, STATUS_INVALID_INPUT if a value is
+ *                    not finite or the number of variables is 0, over
+ *                    MAX_REGRESSION_VARIABLES or not that of the other
+ *                    rows, or STATUS_INSUFFICIENT_MEMORY.
+ */
+int regressionAdd(_regression* regression, const double* x, size_t variables, double y, size_t pointIndex)
+{
+    if (variables == 0 || variables > MAX_REGRESSION_VARIABLES || !isfinite(y) ||
+        (regression->count > 0 && variables != regression->variables)) {
+        return STATUS_INVALID_INPUT;
+    }
+    for (size_t i = 0; i < variables; i++) {
+        if (!isfinite(x[i])) {
+            return STATUS_INVALID_INPUT;
+        }
+    }
+    if (regression->count == 0 && variables != regression->variables) {
+        free(regression->rows);
+        free(regression->pointIndices);
+        regression->rows = NULL;
+        regression->pointIndices = NULL;
+        regression->capacity = 0;
+        regression->variables = variables;
+    }
+    if (regression->count == regression->capacity) {
+        size_t capacity = (regression->capacity == 0) ? INITIAL_ROW_CAPACITY : 2 * regression->capacity;
+        int status = reserveRows(regression, capacity);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    double* row = regression->rows + regression->count * (variables + 1);
+    double deviations[REGRESSION_COLUMNS];
+    memcpy(row, x, variables * sizeof(double));
+    row[variables] = y;
+    regression->pointIndices[regression->count++] = pointIndex;
+    regression->isSolved = false;
+
+    double count = (double)regression->count;
+    for (size_t i = 0; i <= variables; i++) {
+        deviations[i] = row[i] - regression->means[i];
+        regression->means[i] += deviations[i] / count;
+    }
+    updateMoments(regression, deviations, (count - 1.0) / count);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * regressionRemovePoint
+ *
+ * The statistics point at pointIndex was removed: removes its row, if it
+ * has one, in O(variables^2), and moves the indices of the rows after it
+ * down by one (nothing to move when CE removes the last point).
+ */
+void regressionRemovePoint(_regression* regression, size_t pointIndex)
+{
+    size_t columns = regression->variables + 1;
+    size_t low = 0, high = regression->count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (regression->pointIndices[middle] < pointIndex) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    size_t first = low;
+    if (low < regression->count && regression->pointIndices[low] == pointIndex) {
+        double row[REGRESSION_COLUMNS], deviations[REGRESSION_COLUMNS];
+        memcpy(row, regression->rows + low * columns, columns * sizeof(double));
+        memmove(regression->rows + low * columns, regression->rows + (low + 1) * columns,
+            (regression->count - low - 1) * columns * sizeof(double));
+        memmove(&regression->pointIndices[low], &regression->pointIndices[low + 1],
+            (regression->count - low - 1) * sizeof(size_t));
+        regression->count--;
+        regression->isSolved = false;
+
+        if (regression->count <= 1) {
+            resetMoments(regression);
+        }
+        else {
+            // Welford's update run backwards
+            double count = (double)regression->count;
+            for (size_t i = 0; i < columns; i++) {
+                deviations[i] = row[i] - regression->means[i];
+                regression->means[i] -= deviations[i] / count;
+            }
+            updateMoments(regression, deviations, -(count + 1.0) / count);
+        }
+    }
+    for (size_t i = first; i < regression->count; i++) {
+        regression->pointIndices[i]--;
+    }
+}
+
+/*
+ * regressionMerge
+ *
+ * Appends the rows of other, their point indices moved up by pointOffset,
+ * and merges its means and co-moments. other is not changed.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if the numbers of
+ *          variables differ, or STATUS_INSUFFICIENT_MEMORY.
+ */
+int regressionMerge(_regression* regression, const _regression* other, size_t pointOffset)
+{
+    if (other->count == 0) {
+        return STATUS_SUCCESS;
+    }
+    if (regression->count > 0 && regression->variables != other->variables) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (regression->count == 0 && regression->variables != other->variables) {
+        regressionFree(regression);
+        regression->variables = other->variables;
+    }
+    if (other->count > SIZE_MAX - regression->count) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    size_t total = regression->count + other->count;
+    if (total > regression->capacity) {
+        size_t capacity = (regression->capacity > SIZE_MAX / 2 || 2 * regression->capacity < total)
+                              ? total
+                              : 2 * regression->capacity;
+        int status = reserveRows(regression, capacity);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    size_t columns = regression->variables + 1;
+    memcpy(regression->rows + regression->count * columns, other->rows, other->count * columns * sizeof(double));
+    for (size_t i = 0; i < other->count; i++) {
+        regression->pointIndices[regression->count + i] = other->pointIndices[i] + pointOffset;
+    }
+
+    double deviations[REGRESSION_COLUMNS];
+    double share = (double)other->count / (double)total;
+    for (size_t i = 0; i < columns; i++) {
+        deviations[i] = other->means[i] - regression->means[i];
+        regression->means[i] += deviations[i] * share;
+        for (size_t j = 0; j < columns; j++) {
+            regression->comoments[i][j] += other->comoments[i][j];
+        }
+    }
+    updateMoments(regression, deviations, (double)regression->count * share);
+    regression->count = total;
+    regression->isSolved = false;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * solve
+ *
+ * Solves Cxx * b = Cxy by Cholesky factorization and keeps the intercept
+ * and slopes in coefficients.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_UNDEFINED_RESULT if Cxx is singular
+ *          to working precision (a constant or collinear x, or no more
+ *          rows than variables).
+ */
+static int solve(_regression* regression)
+{
+    size_t variables = regression->variables;
+    double factor[MAX_REGRESSION_VARIABLES][MAX_REGRESSION_VARIABLES];
+    double* slopes = &regression->coefficients[1];
+
+    if (regression->count <= variables) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+
+    // Cxx = L * L'
+    for (size_t j = 0; j < variables; j++) {
+        double pivot = regression->comoments[j][j];
+        for (size_t k = 0; k < j; k++) {
+            pivot -= factor[j][k] * factor[j][k];
+        }
+        if (!(pivot > regression->comoments[j][j] * (double)variables * DBL_EPSILON)) {
+            return STATUS_UNDEFINED_RESULT;
+        }
+        factor[j][j] = sqrt(pivot);
+        for (size_t i = j + 1; i < variables; i++) {
+            double sum = regression->comoments[i][j];
+            for (size_t k = 0; k < j; k++) {
+                sum -= factor[i][k] * factor[j][k];
+            }
+            factor[i][j] = sum / factor[j][j];
+        }
+    }
+
+    // L * z = Cxy, then L' * b = z
+    for (size_t i = 0; i < variables; i++) {
+        double sum = regression->comoments[i][variables];
+        for (size_t k = 0; k < i; k++) {
+            sum -= factor[i][k] * slopes[k];
+        }
+        slopes[i] = sum / factor[i][i];
+    }
+    for (size_t i = variables; i-- > 0;) {
+        double sum = slopes[i];
+        for (size_t k = i + 1; k < variables; k++) {
+            sum -= factor[k][i] * slopes[k];
+        }
+        slopes[i] = sum / factor[i][i];
+    }
+
+    double intercept = regression->means[variables];
+    for (size_t i = 0; i < variables; i++) {
+        intercept -= slopes[i] * regression->means[i];
+    }
+    regression->coefficients[0] = intercept;
+    regression->isSolved = true;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * regressionGetCoefficients
+ *
+ * The intercept and then the slope of each variable of the least-squares
+ * fit, variables + 1 values in all. Solved once per change of the rows.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no more
+ *          rows than variables or the x values are constant or
+ *          collinear, or STATUS_OVERFLOW.
+ */
+int regressionGetCoefficients(_regression* regression, double* coefficients)
+{
+    if (regression->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (!regression->isSolved) {
+        int status = solve(regression);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    int status = STATUS_SUCCESS;
+    for (size_t i = 0; i <= regression->variables; i++) {
+        coefficients[i] = regression->coefficients[i];
+        status = isfinite(coefficients[i]) ? status : STATUS_OVERFLOW;
+    }
+    return status;
+}
+
+/*
+ * regressionGetDetermination
+ *
+ * r^2, the share of the variance of y that the fit explains.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there is no fit or
+ *          y is constant, or STATUS_OVERFLOW.
+ */
+int regressionGetDetermination(_regression* regression, double* result)
+{
+    double coefficients[REGRESSION_COLUMNS];
+    size_t variables = regression->variables;
+
+    int status = regressionGetCoefficients(regression, coefficients);
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+    if (regression->comoments[variables][variables] == 0.0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+
+    double explained = 0.0;
+    for (size_t i = 0; i < variables; i++) {
+        explained += coefficients[i + 1] * regression->comoments[i][variables];
+    }
+    *result = fmin(fmax(explained / regression->comoments[variables][variables], 0.0), 1.0);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * regressionGetCorrelation
+ *
+ * Pearson's r for one variable, with the sign of the slope; the multiple
+ * correlation coefficient sqrt(r^2) for several.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no rows
+ *          or x or y is constant, or STATUS_OVERFLOW.
+ */
+int regressionGetCorrelation(_regression* regression, double* result)
+{
+    if (regression->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (regression->variables > 1) {
+        int status = regressionGetDetermination(regression, result);
+        if (status == STATUS_SUCCESS) {
+            *result = sqrt(*result);
+        }
+        return status;
+    }
+
+    double spread = sqrt(regression->comoments[0][0]) * sqrt(regression->comoments[1][1]);
+    if (spread == 0.0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    *result = fmin(fmax(regression->comoments[0][1] / spread, -1.0), 1.0);
+    return isfinite(*result) ? STATUS_SUCCESS : STATUS_OVERFLOW;
+}
@@ -0,0 +1,1199 @@
+/*-----------------------------------------------------------------------------
+    statistics.c --  Data points of the statistics box (reconstructed
+                     code).
+
+               The statistics box used to keep its data points only as
+               list box strings. The engine now owns them: the box shows
+               what is in calcState.engine.statistics, and the Sum, Ave,
+               s and Dat keys work on it directly.
+
+               Every point updates the running sums as it comes and goes:
+
+               - sum and sumOfSquares are Neumaier sums. The rounding
+                 error of each addition is collected in a compensation
+                 term, so the result is as accurate as if it had been
+                 summed in twice the precision. Removing a point adds -x
+                 the same way.
+               - mean and squaredDeviations follow Welford's update, and
+                 its inverse when a point is removed. The variance is
+                 squaredDeviations / (n - 1), which stays accurate for
+                 data with a large mean and a small spread.
+
+               When the last points go, the sums are reset to exact zeros
+               (or to the single point left), so rounding errors of
+               removed points do not linger.
+
+               statisticsSummarize recomputes the statistics from the
+               column of points instead. The column is cut into blocks of
+               SUMMARY_BLOCK points that fit the L1 cache. Each block is
+               summed in 16 interleaved lanes, which an AVX2 kernel runs
+               as four 4-wide vectors (NEON as eight 2-wide ones); a
+               second pass over the still-cached block sums the squared
+               deviations from the block mean. The blocks are then merged
+               pairwise in a fixed tree with Chan's formula, so the
+               rounding error grows with the logarithm of the count, and
+               every kernel adds in the same order and gives the same
+               bits.
+
+               Large columns are summarized on statisticsThreads threads.
+               The top of the tree is cut into subtrees, at least four
+               per thread, that the threads summarize; the subtrees are
+               then merged in the order of the tree. Each node is computed
+               exactly as on one thread, so the result is the same bits
+               for any number of threads.
+
+               Exact quantiles and histograms use a sorted copy of the
+               points, kept as radix sort keys (see radixsort.c):
+
+               - The copy holds the first sortedCount points. Points
+                 appended since are sorted in at the next query: a few by
+                 binary search, many by radix sorting them on their own
+                 and merging the two runs.
+               - Removing one of the first sortedCount points (CE) removes
+                 its key by binary search; nothing needs sorting again.
+               - A quantile is then an index, and a histogram one pass
+                 over the keys.
+
+               Points entered with x values are also the rows of a
+               regression (regression.c), which follows the points as
+               they are removed.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // sysconf under a strict -std=c11
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//radixsort.h"
+#include ".//headers//statistics.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define STATISTICS_THREADS 1
+#else
+#define STATISTICS_THREADS 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define STATISTICS_AVX2 1   // Built with target("avx2"), used if the processor has it
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define STATISTICS_NEON 1   // Part of every AArch64 processor
+#endif
+
+#define INITIAL_POINT_CAPACITY 16
+#define CACHE_LINE_SIZE 64
+#define SUMMARY_BLOCK 2048  // Points per leaf of the summation tree (16 KB)
+#define SUMMARY_LANES 16    // Interleaved accumulators per block
+#define PARALLEL_MIN_POINTS (1u << 20)  // Fewer points are summarized on one thread
+#define TASKS_PER_THREAD 4
+#define MAX_SUMMARY_THREADS 64
+#define MAX_SUMMARY_TASKS (2 * TASKS_PER_THREAD * MAX_SUMMARY_THREADS)
+#define MAX_INSERTED_KEYS 32  // More new points are radix sorted and merged
+
+bool statisticsUseSimd = true;
+unsigned statisticsThreads = 0;
+
+// Sums of one block, per lane
+typedef struct {
+    double sums[SUMMARY_LANES];
+    double squares[SUMMARY_LANES];
+    double minimum;
+    double maximum;
+} _blockLanes;
+
+typedef void (*_blockKernel)(const double* points, size_t count, _blockLanes* lanes);
+typedef double (*_deviationKernel)(const double* points, size_t count, double mean);
+
+// A subtree of the summation tree, summarized by one thread
+typedef struct {
+    const double* points;
+    size_t count;
+    _statisticsSummary summary;
+} _summaryTask;
+
+// The tasks of one thread: every step-th from first
+typedef struct {
+    _summaryTask* tasks;
+    size_t taskCount;
+    size_t first;
+    size_t step;
+    _blockKernel sumBlock;
+    _deviationKernel sumDeviations;
+} _summaryWorker;
+
+/*
+ * addCompensated
+ *
+ * One step of Neumaier's summation: adds value to *sum and the rounding
+ * error of that addition to *compensation.
+ */
+static void addCompensated(double* sum, double* compensation, double value)
+{
+    double total = *sum + value;
+
+    if (fabs(*sum) >= fabs(value)) {
+        *compensation += (*sum - total) + value;
+    }
+    else {
+        *compensation += (value - total) + *sum;
+    }
+    *sum = total;
+}
+
+/*
+ * resetSums
+ *
+ * Recomputes the running sums exactly from the (zero or one) points left.
+ */
+static void resetSums(_statistics* statistics)
+{
+    double point = (statistics->count == 1) ? statistics->points[0] : 0.0;
+
+    statistics->mean = point;
+    statistics->squaredDeviations = 0.0;
+    statistics->sum = point;
+    statistics->sumCompensation = 0.0;
+    statistics->sumOfSquares = point * point;
+    statistics->sumOfSquaresCompensation = 0.0;
+}
+
+/*
+ * checkResult
+ *
+ * @return  STATUS_SUCCESS, or STATUS_OVERFLOW if result is not finite.
+ */
+static int checkResult(double result)
+{
+    return isfinite(result) ? STATUS_SUCCESS : STATUS_OVERFLOW;
+}
+
+/*
+ * findKey
+ *
+ * Index of the first of count ascending keys that is not below key
+ * (isAfter false), or above it (isAfter true).
+ */
+static size_t findKey(const uint64_t* keys, size_t count, uint64_t key, bool isAfter)
+{
+    size_t low = 0, high = count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (keys[middle] < key || (isAfter && keys[middle] == key)) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*
+ * removeSortedKey
+ *
+ * Takes one copy of key, which must be there, out of the sorted keys.
+ */
+static void removeSortedKey(_statistics* statistics, uint64_t key)
+{
+    uint64_t* keys = statistics->sortedKeys;
+    size_t place = findKey(keys, statistics->sortedCount, key, false);
+
+    memmove(&keys[place], &keys[place + 1], (statistics->sortedCount - place - 1) * sizeof(uint64_t));
+    statistics->sortedCount--;
+}
+
+/*
+ * statisticsInit
+ *
+ * Makes statistics empty. Zero-filled memory is in the same state.
+ */
+void statisticsInit(_statistics* statistics)
+{
+    memset(statistics, 0, sizeof(*statistics));
+}
+
+/*
+ * statisticsFree
+ *
+ * Releases the points and leaves statistics empty.
+ */
+void statisticsFree(_statistics* statistics)
+{
+    double compression = statistics->quantiles.compression;
+
+    free(statistics->pointStorage);
+    free(statistics->sortedKeys);
+    quantileSketchFree(&statistics->quantiles);
+    regressionFree(&statistics->regression);
+    statisticsInit(statistics);
+    quantileSketchInit(&statistics->quantiles, compression);
+}
+
+/*
+ * statisticsClear
+ *
+ * Removes every point (the CAD key). The memory is kept for the next ones.
+ */
+void statisticsClear(_statistics* statistics)
+{
+    statistics->count = 0;
+    statistics->sortedCount = 0;
+    statistics->regressorCount = 0;
+    resetSums(statistics);
+    regressionClear(&statistics->regression);
+    quantileSketchClear(&statistics->quantiles);
+    statistics->sketchedCount = 0;
+    statistics->isQuantilesStale = false;
+}
+
+/*
+ * statisticsAdd
+ *
+ * Appends a data point (the Dat key), in amortized O(1). The quantile
+ * sketch takes the point at the next statisticsGetQuantile, so entering a
+ * column of data does not pay for it on every key. If x values
+ * were entered for it, the point is also the y of a regression row, added
+ * in O(k^2) for k x values.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if point is not finite
+ *          or the number of x values differs from that of the rows
+ *          before (the x values are then dropped), or
+ *          STATUS_INSUFFICIENT_MEMORY.
+ */
+int statisticsAdd(_statistics* statistics, double point)
+{
+    size_t variables = statistics->regressorCount;
+
+    if (!isfinite(point)) {
+        return STATUS_INVALID_INPUT;
+    }
+    statistics->regressorCount = 0;
+    if (variables > 0 && statistics->regression.count > 0 && variables != statistics->regression.variables) {
+        return STATUS_INVALID_INPUT;
+    }
+    if (statistics->count == statistics->capacity) {
+        size_t capacity = (statistics->capacity == 0) ? INITIAL_POINT_CAPACITY : 2 * statistics->capacity;
+        int status = statisticsReserve(statistics, capacity);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    statistics->points[statistics->count++] = point;
+    double delta = point - statistics->mean;
+    statistics->mean += delta / (double)statistics->count;
+    statistics->squaredDeviations += delta * (point - statistics->mean);
+    addCompensated(&statistics->sum, &statistics->sumCompensation, point);
+    addCompensated(&statistics->sumOfSquares, &statistics->sumOfSquaresCompensation, point * point);
+
+    if (variables > 0) {
+        int status = regressionAdd(&statistics->regression, statistics->regressors, variables, point,
+            statistics->count - 1);
+        if (status != STATUS_SUCCESS) {
+            statisticsRemove(statistics, statistics->count - 1);
+            return status;
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsAddRegressor
+ *
+ * Enters an x value for the next point (Inv Dat): the next statisticsAdd
+ * makes the point the y of a regression row with the x values entered
+ * since the last one.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INVALID_INPUT if x is not finite or
+ *          MAX_REGRESSION_VARIABLES values are entered already.
+ */
+int statisticsAddRegressor(_statistics* statistics, double x)
+{
+    if (!isfinite(x) || statistics->regressorCount == MAX_REGRESSION_VARIABLES) {
+        return STATUS_INVALID_INPUT;
+    }
+    statistics->regressors[statistics->regressorCount++] = x;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsRemove
+ *
+ * Removes the point at index (the CE key removes the last one). The sums
+ * are updated in O(1); the points after index move down one place.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INVALID_INPUT if there is no such
+ *          point.
+ */
+int statisticsRemove(_statistics* statistics, size_t index)
+{
+    if (index >= statistics->count) {
+        return STATUS_INVALID_INPUT;
+    }
+
+    double point = statistics->points[index];
+    memmove(&statistics->points[index], &statistics->points[index + 1],
+        (statistics->count - index - 1) * sizeof(double));
+    statistics->count--;
+    statistics->isQuantilesStale = true;
+    if (index < statistics->sortedCount) {
+        removeSortedKey(statistics, radixKeyFromDouble(point));
+    }
+    regressionRemovePoint(&statistics->regression, index);
+
+    if (statistics->count <= 1) {
+        resetSums(statistics);
+        return STATUS_SUCCESS;
+    }
+
+    // Welford's update run backwards
+    double delta = point - statistics->mean;
+    statistics->mean -= delta / (double)statistics->count;
+    statistics->squaredDeviations -= delta * (point - statistics->mean);
+    if (statistics->squaredDeviations < 0.0) {
+        statistics->squaredDeviations = 0.0;
+    }
+    addCompensated(&statistics->sum, &statistics->sumCompensation, -point);
+    addCompensated(&statistics->sumOfSquares, &statistics->sumOfSquaresCompensation, -(point * point));
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsReserve
+ *
+ * Makes room for capacity points, so a bulk load does not reallocate.
+ * The column always starts at a cache line.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INSUFFICIENT_MEMORY (the points are
+ *          then unchanged).
+ */
+int statisticsReserve(_statistics* statistics, size_t capacity)
+{
+    if (capacity <= statistics->capacity) {
+        return STATUS_SUCCESS;
+    }
+    if (capacity > (SIZE_MAX - CACHE_LINE_SIZE) / sizeof(double)) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+
+    void* storage = malloc(capacity * sizeof(double) + CACHE_LINE_SIZE);
+    if (storage == NULL) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    double* points = (double*)(((uintptr_t)storage + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    if (statistics->count > 0) {
+        memcpy(points, statistics->points, statistics->count * sizeof(double));
+    }
+    free(statistics->pointStorage);
+    statistics->pointStorage = storage;
+    statistics->points = points;
+    statistics->capacity = capacity;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * sumBlockPortable
+ *
+ * Point i of a block goes to lane i % SUMMARY_LANES. Written lane by lane
+ * so the compiler may vectorize it without changing the order of the
+ * additions.
+ */
+static void sumBlockPortable(const double* points, size_t count, _blockLanes* lanes)
+{
+    double minimum = points[0], maximum = points[0];
+    size_t i;
+
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int lane = 0; lane < SUMMARY_LANES; lane++) {
+            double point = points[i + lane];
+            lanes->sums[lane] += point;
+            lanes->squares[lane] += point * point;
+            minimum = (point < minimum) ? point : minimum;
+            maximum = (point > maximum) ? point : maximum;
+        }
+    }
+    for (int lane = 0; i < count; i++, lane++) {
+        lanes->sums[lane] += points[i];
+        lanes->squares[lane] += points[i] * points[i];
+        minimum = (points[i] < minimum) ? points[i] : minimum;
+        maximum = (points[i] > maximum) ? points[i] : maximum;
+    }
+    lanes->minimum = minimum;
+    lanes->maximum = maximum;
+}
+
+/*
+ * sumDeviationsPortable
+ *
+ * Sum of (x - mean)^2 over a block, in the lanes of sumBlockPortable.
+ */
+static double sumDeviationsPortable(const double* points, size_t count, double mean)
+{
+    double lanes[SUMMARY_LANES] = { 0.0 };
+    size_t i;
+
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int lane = 0; lane < SUMMARY_LANES; lane++) {
+            double deviation = points[i + lane] - mean;
+            lanes[lane] += deviation * deviation;
+        }
+    }
+    for (int lane = 0; i < count; i++, lane++) {
+        double deviation = points[i] - mean;
+        lanes[lane] += deviation * deviation;
+    }
+    for (int width = SUMMARY_LANES / 2; width > 0; width /= 2) {
+        for (int lane = 0; lane < width; lane++) {
+            lanes[lane] += lanes[lane + width];
+        }
+    }
+    return lanes[0];
+}
+
+#if STATISTICS_AVX2
+/*
+ * sumBlockAvx2
+ *
+ * sumBlockPortable with lanes 0-3, 4-7, 8-11 and 12-15 in four AVX2
+ * registers. Separate multiplies and adds (no FMA) keep the roundings of
+ * the portable kernel.
+ */
+__attribute__((target("avx2")))
+static void sumBlockAvx2(const double* points, size_t count, _blockLanes* lanes)
+{
+    __m256d sums[4], squares[4];
+    __m256d minimum = _mm256_set1_pd(points[0]), maximum = minimum;
+    size_t i;
+
+    for (int v = 0; v < 4; v++) {
+        sums[v] = _mm256_setzero_pd();
+        squares[v] = _mm256_setzero_pd();
+    }
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int v = 0; v < 4; v++) {
+            __m256d point = _mm256_loadu_pd(points + i + 4 * v);
+            sums[v] = _mm256_add_pd(sums[v], point);
+            squares[v] = _mm256_add_pd(squares[v], _mm256_mul_pd(point, point));
+            minimum = _mm256_min_pd(point, minimum);
+            maximum = _mm256_max_pd(point, maximum);
+        }
+    }
+
+    double minimums[4], maximums[4];
+    for (int v = 0; v < 4; v++) {
+        _mm256_storeu_pd(lanes->sums + 4 * v, sums[v]);
+        _mm256_storeu_pd(lanes->squares + 4 * v, squares[v]);
+    }
+    _mm256_storeu_pd(minimums, minimum);
+    _mm256_storeu_pd(maximums, maximum);
+    lanes->minimum = minimums[0];
+    lanes->maximum = maximums[0];
+    for (int lane = 1; lane < 4; lane++) {
+        lanes->minimum = (minimums[lane] < lanes->minimum) ? minimums[lane] : lanes->minimum;
+        lanes->maximum = (maximums[lane] > lanes->maximum) ? maximums[lane] : lanes->maximum;
+    }
+    for (int lane = 0; i < count; i++, lane++) {
+        lanes->sums[lane] += points[i];
+        lanes->squares[lane] += points[i] * points[i];
+        lanes->minimum = (points[i] < lanes->minimum) ? points[i] : lanes->minimum;
+        lanes->maximum = (points[i] > lanes->maximum) ? points[i] : lanes->maximum;
+    }
+}
+
+/*
+ * sumDeviationsAvx2
+ */
+__attribute__((target("avx2")))
+static double sumDeviationsAvx2(const double* points, size_t count, double mean)
+{
+    __m256d sums[4];
+    __m256d center = _mm256_set1_pd(mean);
+    double lanes[SUMMARY_LANES];
+    size_t i;
+
+    for (int v = 0; v < 4; v++) {
+        sums[v] = _mm256_setzero_pd();
+    }
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int v = 0; v < 4; v++) {
+            __m256d deviation = _mm256_sub_pd(_mm256_loadu_pd(points + i + 4 * v), center);
+            sums[v] = _mm256_add_pd(sums[v], _mm256_mul_pd(deviation, deviation));
+        }
+    }
+    for (int v = 0; v < 4; v++) {
+        _mm256_storeu_pd(lanes + 4 * v, sums[v]);
+    }
+    for (int lane = 0; i < count; i++, lane++) {
+        double deviation = points[i] - mean;
+        lanes[lane] += deviation * deviation;
+    }
+    for (int width = SUMMARY_LANES / 2; width > 0; width /= 2) {
+        for (int lane = 0; lane < width; lane++) {
+            lanes[lane] += lanes[lane + width];
+        }
+    }
+    return lanes[0];
+}
+#endif
+
+#if STATISTICS_NEON
+/*
+ * sumBlockNeon
+ *
+ * sumBlockPortable with the 16 lanes in eight NEON registers.
+ */
+static void sumBlockNeon(const double* points, size_t count, _blockLanes* lanes)
+{
+    float64x2_t sums[8], squares[8];
+    float64x2_t minimum = vdupq_n_f64(points[0]), maximum = minimum;
+    size_t i;
+
+    for (int v = 0; v < 8; v++) {
+        sums[v] = vdupq_n_f64(0.0);
+        squares[v] = vdupq_n_f64(0.0);
+    }
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int v = 0; v < 8; v++) {
+            float64x2_t point = vld1q_f64(points + i + 2 * v);
+            sums[v] = vaddq_f64(sums[v], point);
+            squares[v] = vaddq_f64(squares[v], vmulq_f64(point, point));
+            minimum = vminq_f64(point, minimum);
+            maximum = vmaxq_f64(point, maximum);
+        }
+    }
+    for (int v = 0; v < 8; v++) {
+        vst1q_f64(lanes->sums + 2 * v, sums[v]);
+        vst1q_f64(lanes->squares + 2 * v, squares[v]);
+    }
+    lanes->minimum = vminvq_f64(minimum);
+    lanes->maximum = vmaxvq_f64(maximum);
+    for (int lane = 0; i < count; i++, lane++) {
+        lanes->sums[lane] += points[i];
+        lanes->squares[lane] += points[i] * points[i];
+        lanes->minimum = (points[i] < lanes->minimum) ? points[i] : lanes->minimum;
+        lanes->maximum = (points[i] > lanes->maximum) ? points[i] : lanes->maximum;
+    }
+}
+
+/*
+ * sumDeviationsNeon
+ */
+static double sumDeviationsNeon(const double* points, size_t count, double mean)
+{
+    float64x2_t sums[8];
+    float64x2_t center = vdupq_n_f64(mean);
+    double lanes[SUMMARY_LANES];
+    size_t i;
+
+    for (int v = 0; v < 8; v++) {
+        sums[v] = vdupq_n_f64(0.0);
+    }
+    for (i = 0; i + SUMMARY_LANES <= count; i += SUMMARY_LANES) {
+        for (int v = 0; v < 8; v++) {
+            float64x2_t deviation = vsubq_f64(vld1q_f64(points + i + 2 * v), center);
+            sums[v] = vaddq_f64(sums[v], vmulq_f64(deviation, deviation));
+        }
+    }
+    for (int v = 0; v < 8; v++) {
+        vst1q_f64(lanes + 2 * v, sums[v]);
+    }
+    for (int lane = 0; i < count; i++, lane++) {
+        double deviation = points[i] - mean;
+        lanes[lane] += deviation * deviation;
+    }
+    for (int width = SUMMARY_LANES / 2; width > 0; width /= 2) {
+        for (int lane = 0; lane < width; lane++) {
+            lanes[lane] += lanes[lane + width];
+        }
+    }
+    return lanes[0];
+}
+#endif
+
+/*
+ * summarizeBlock
+ *
+ * Summary of at most SUMMARY_BLOCK points: lane sums folded pairwise,
+ * then the squared deviations from the block mean while the block is
+ * still in the cache.
+ */
+static void summarizeBlock(const double* points, size_t count, _blockKernel sumBlock,
+    _deviationKernel sumDeviations, _statisticsSummary* summary)
+{
+    _blockLanes lanes = { { 0.0 }, { 0.0 }, 0.0, 0.0 };
+
+    sumBlock(points, count, &lanes);
+    for (int width = SUMMARY_LANES / 2; width > 0; width /= 2) {
+        for (int lane = 0; lane < width; lane++) {
+            lanes.sums[lane] += lanes.sums[lane + width];
+            lanes.squares[lane] += lanes.squares[lane + width];
+        }
+    }
+    summary->count = count;
+    summary->sum = lanes.sums[0];
+    summary->sumOfSquares = lanes.squares[0];
+    summary->mean = lanes.sums[0] / (double)count;
+    summary->squaredDeviations = sumDeviations(points, count, summary->mean);
+    summary->minimum = lanes.minimum;
+    summary->maximum = lanes.maximum;
+}
+
+/*
+ * mergeSummaries
+ *
+ * Folds right into left. The squared deviations combine with Chan's
+ * formula: M2 = M2a + M2b + delta^2 * na * nb / n.
+ */
+static void mergeSummaries(_statisticsSummary* left, const _statisticsSummary* right)
+{
+    size_t count = left->count + right->count;
+    double delta = right->mean - left->mean;
+
+    left->squaredDeviations += right->squaredDeviations +
+        delta * delta * ((double)left->count * (double)right->count / (double)count);
+    left->count = count;
+    left->sum += right->sum;
+    left->sumOfSquares += right->sumOfSquares;
+    left->mean = left->sum / (double)count;
+    left->minimum = (right->minimum < left->minimum) ? right->minimum : left->minimum;
+    left->maximum = (right->maximum > left->maximum) ? right->maximum : left->maximum;
+}
+
+/*
+ * splitCount
+ *
+ * Points in the left child of a node of count points: half of the blocks,
+ * rounded down. The tree depends only on count.
+ */
+static size_t splitCount(size_t count)
+{
+    size_t blocks = (count + SUMMARY_BLOCK - 1) / SUMMARY_BLOCK;
+    return (blocks / 2) * SUMMARY_BLOCK;
+}
+
+/*
+ * summarizeRange
+ *
+ * Splits count points at a block boundary near the middle and merges the
+ * two halves. The recursion is log2(count / SUMMARY_BLOCK) deep.
+ */
+static void summarizeRange(const double* points, size_t count, _blockKernel sumBlock,
+    _deviationKernel sumDeviations, _statisticsSummary* summary)
+{
+    if (count <= SUMMARY_BLOCK) {
+        summarizeBlock(points, count, sumBlock, sumDeviations, summary);
+        return;
+    }
+
+    size_t half = splitCount(count);
+    _statisticsSummary right;
+
+    summarizeRange(points, half, sumBlock, sumDeviations, summary);
+    summarizeRange(points + half, count - half, sumBlock, sumDeviations, &right);
+    mergeSummaries(summary, &right);
+}
+
+/*
+ * splitTasks
+ *
+ * Lists the subtrees depth levels below the root (or the leaves above
+ * that depth) from left to right.
+ */
+static void splitTasks(const double* points, size_t count, int depth, _summaryTask* tasks, size_t* taskCount)
+{
+    if (depth == 0 || count <= SUMMARY_BLOCK) {
+        tasks[*taskCount].points = points;
+        tasks[*taskCount].count = count;
+        (*taskCount)++;
+        return;
+    }
+
+    size_t half = splitCount(count);
+    splitTasks(points, half, depth - 1, tasks, taskCount);
+    splitTasks(points + half, count - half, depth - 1, tasks, taskCount);
+}
+
+/*
+ * mergeTasks
+ *
+ * The top of the tree over the summaries of splitTasks, merged in the
+ * order summarizeRange merges them.
+ */
+static void mergeTasks(size_t count, int depth, const _summaryTask* tasks, size_t* next,
+    _statisticsSummary* summary)
+{
+    if (depth == 0 || count <= SUMMARY_BLOCK) {
+        *summary = tasks[(*next)++].summary;
+        return;
+    }
+
+    size_t half = splitCount(count);
+    _statisticsSummary right;
+
+    mergeTasks(half, depth - 1, tasks, next, summary);
+    mergeTasks(count - half, depth - 1, tasks, next, &right);
+    mergeSummaries(summary, &right);
+}
+
+/*
+ * runSummaryWorker
+ *
+ * Thread function: summarizes the subtrees of one worker.
+ */
+static int runSummaryWorker(void* argument)
+{
+    _summaryWorker* worker = argument;
+
+    for (size_t i = worker->first; i < worker->taskCount; i += worker->step) {
+        summarizeRange(worker->tasks[i].points, worker->tasks[i].count, worker->sumBlock, worker->sumDeviations,
+            &worker->tasks[i].summary);
+    }
+    return 0;
+}
+
+/*
+ * statisticsGetThreadCount
+ *
+ * statisticsThreads, or the number of processors if it is 0. Systems
+ * without sysconf count as one processor unless statisticsThreads says
+ * otherwise; the Win32 front end sets it at startup.
+ */
+unsigned statisticsGetThreadCount(void)
+{
+    if (statisticsThreads != 0) {
+        return statisticsThreads;
+    }
+#if (defined(__unix__) || defined(__APPLE__)) && defined(_SC_NPROCESSORS_ONLN)
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return (processors > 0) ? (unsigned)processors : 1;
+#else
+    return 1;
+#endif
+}
+
+/*
+ * summarizePoints
+ *
+ * summarizeRange with the widest kernel the processor supports, on
+ * several threads for large counts.
+ */
+static void summarizePoints(const double* points, size_t count, _statisticsSummary* summary)
+{
+    _blockKernel sumBlock = sumBlockPortable;
+    _deviationKernel sumDeviations = sumDeviationsPortable;
+    unsigned threads = statisticsGetThreadCount();
+
+#if STATISTICS_AVX2
+    if (statisticsUseSimd && __builtin_cpu_supports("avx2")) {
+        sumBlock = sumBlockAvx2;
+        sumDeviations = sumDeviationsAvx2;
+    }
+#elif STATISTICS_NEON
+    if (statisticsUseSimd) {
+        sumBlock = sumBlockNeon;
+        sumDeviations = sumDeviationsNeon;
+    }
+#endif
+
+#if STATISTICS_THREADS
+    if (threads > MAX_SUMMARY_THREADS) {
+        threads = MAX_SUMMARY_THREADS;
+    }
+    if (threads > 1 && count >= PARALLEL_MIN_POINTS) {
+        _summaryTask tasks[MAX_SUMMARY_TASKS];
+        _summaryWorker workers[MAX_SUMMARY_THREADS];
+        thrd_t handles[MAX_SUMMARY_THREADS];
+        bool isStarted[MAX_SUMMARY_THREADS] = { false };
+        size_t taskCount = 0, next = 0;
+        int depth = 0;
+
+        while (((size_t)1 << depth) < (size_t)threads * TASKS_PER_THREAD) {
+            depth++;
+        }
+        splitTasks(points, count, depth, tasks, &taskCount);
+
+        for (unsigned i = 0; i < threads; i++) {
+            workers[i] = (_summaryWorker){ tasks, taskCount, i, threads, sumBlock, sumDeviations };
+        }
+        for (unsigned i = 1; i < threads; i++) {
+            isStarted[i] = (thrd_create(&handles[i], runSummaryWorker, &workers[i]) == thrd_success);
+        }
+        runSummaryWorker(&workers[0]);
+        for (unsigned i = 1; i < threads; i++) {
+            if (isStarted[i]) {
+                thrd_join(handles[i], NULL);
+            }
+            else {
+                runSummaryWorker(&workers[i]);
+            }
+        }
+
+        mergeTasks(count, depth, tasks, &next, summary);
+        return;
+    }
+#else
+    (void)threads;
+#endif
+
+    summarizeRange(points, count, sumBlock, sumDeviations, summary);
+}
+
+/*
+ * statisticsSummarize
+ *
+ * Recomputes count, sum, sum of squares, mean, squared deviations,
+ * minimum and maximum from the column of points, with the widest kernel
+ * the processor supports and statisticsGetThreadCount threads. The result
+ * depends on neither.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no
+ *          points, or STATUS_OVERFLOW.
+ */
+int statisticsSummarize(const _statistics* statistics, _statisticsSummary* summary)
+{
+    memset(summary, 0, sizeof(*summary));
+    if (statistics->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+
+    summarizePoints(statistics->points, statistics->count, summary);
+    return (isfinite(summary->sumOfSquares) && isfinite(summary->squaredDeviations)) ? STATUS_SUCCESS
+                                                                                     : STATUS_OVERFLOW;
+}
+
+/*
+ * statisticsAppend
+ *
+ * Appends count data points at once, for bulk loads. The new points are
+ * summarized with the block kernels and merged into the running sums, so
+ * the cost per point is a copy and a few vector operations instead of a
+ * statisticsAdd.
+ *
+ * @param sketch  A quantile sketch of exactly these points, built
+ *                alongside them (a bulk load builds one per thread), or
+ *                NULL to leave them for the next quantile query.
+ * @return        STATUS_SUCCESS, STATUS_INVALID_INPUT if a point is not
+ *                finite (nothing is appended), or
+ *                STATUS_INSUFFICIENT_MEMORY.
+ */
+int statisticsAppend(_statistics* statistics, const double* points, size_t count, const _quantileSketch* sketch)
+{
+    _statisticsSummary added;
+    size_t capacity = statistics->capacity;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(points[i])) {
+            return STATUS_INVALID_INPUT;
+        }
+    }
+    if (count == 0) {
+        return STATUS_SUCCESS;
+    }
+    if (count > SIZE_MAX - statistics->count) {
+        return STATUS_INSUFFICIENT_MEMORY;
+    }
+    if (statistics->count + count > capacity) {
+        capacity = (capacity > SIZE_MAX / 2 || 2 * capacity < statistics->count + count) ? statistics->count + count
+                                                                                           : 2 * capacity;
+        int status = statisticsReserve(statistics, capacity);
+        if (status != STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    double* destination = statistics->points + statistics->count;
+    memcpy(destination, points, count * sizeof(double));
+    summarizePoints(destination, count, &added);
+
+    size_t total = statistics->count + count;
+    double delta = added.mean - statistics->mean;
+    statistics->squaredDeviations += added.squaredDeviations +
+        delta * delta * ((double)statistics->count * (double)count / (double)total);
+    statistics->mean += delta * ((double)count / (double)total);
+    statistics->count = total;
+    addCompensated(&statistics->sum, &statistics->sumCompensation, added.sum);
+    addCompensated(&statistics->sumOfSquares, &statistics->sumOfSquaresCompensation, added.sumOfSquares);
+
+    if (sketch != NULL && !statistics->isQuantilesStale) {
+        int status = quantileSketchAddPoints(&statistics->quantiles, statistics->points + statistics->sketchedCount,
+            total - count - statistics->sketchedCount);
+        if (status == STATUS_SUCCESS) {
+            status = quantileSketchMerge(&statistics->quantiles, sketch);
+        }
+        statistics->sketchedCount = total;
+        statistics->isQuantilesStale = (status != STATUS_SUCCESS);
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsSetQuantileCompression
+ *
+ * Sets the accuracy of the median and percentiles: the rank error is
+ * roughly 1/compression, and the sketch takes about 6 * compression
+ * pairs of doubles. The sketch is rebuilt at the next query.
+ */
+void statisticsSetQuantileCompression(_statistics* statistics, double compression)
+{
+    quantileSketchFree(&statistics->quantiles);
+    quantileSketchInit(&statistics->quantiles, compression);
+    statistics->isQuantilesStale = true;
+}
+
+/*
+ * statisticsGetQuantile
+ *
+ * Estimated value below which fraction of the points lie, from the
+ * quantile sketch. Adds the points entered since the last query to the
+ * sketch first, or rebuilds it from all of them if one was removed.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no
+ *          points, STATUS_INVALID_INPUT if fraction is not in [0, 1], or
+ *          STATUS_INSUFFICIENT_MEMORY.
+ */
+int statisticsGetQuantile(_statistics* statistics, double fraction, double* result)
+{
+    if (statistics->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (statistics->isQuantilesStale) {
+        quantileSketchClear(&statistics->quantiles);
+        statistics->sketchedCount = 0;
+        statistics->isQuantilesStale = false;
+    }
+    if (statistics->sketchedCount < statistics->count) {
+        int status = quantileSketchAddPoints(&statistics->quantiles, statistics->points + statistics->sketchedCount,
+            statistics->count - statistics->sketchedCount);
+        statistics->sketchedCount = statistics->count;
+        if (status != STATUS_SUCCESS) {
+            statistics->isQuantilesStale = true;
+            return status;
+        }
+    }
+    return quantileSketchGetQuantile(&statistics->quantiles, fraction, result);
+}
+
+/*
+ * statisticsSortPoints
+ *
+ * Brings the sorted keys up to date with the points. Up to
+ * MAX_INSERTED_KEYS new points are inserted by binary search; more are
+ * radix sorted on statisticsGetThreadCount threads and merged with the
+ * keys sorted before.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_INSUFFICIENT_MEMORY (the sorted
+ *          keys are then as they were).
+ */
+int statisticsSortPoints(_statistics* statistics)
+{
+    size_t sorted = statistics->sortedCount;
+    size_t count = statistics->count;
+
+    if (sorted == count) {
+        return STATUS_SUCCESS;
+    }
+    if (statistics->sortedCapacity < count) {
+        uint64_t* keys = realloc(statistics->sortedKeys, statistics->capacity * sizeof(uint64_t));
+        if (keys == NULL) {
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        statistics->sortedKeys = keys;
+        statistics->sortedCapacity = statistics->capacity;
+    }
+
+    uint64_t* keys = statistics->sortedKeys;
+    if (count - sorted <= MAX_INSERTED_KEYS) {
+        for (; sorted < count; sorted++) {
+            uint64_t key = radixKeyFromDouble(statistics->points[sorted]);
+            size_t place = findKey(keys, sorted, key, true);
+            memmove(&keys[place + 1], &keys[place], (sorted - place) * sizeof(uint64_t));
+            keys[place] = key;
+        }
+        statistics->sortedCount = count;
+        return STATUS_SUCCESS;
+    }
+
+    for (size_t i = sorted; i < count; i++) {
+        keys[i] = radixKeyFromDouble(statistics->points[i]);
+    }
+    int status = radixSortKeys(&keys[sorted], count - sorted, statisticsGetThreadCount());
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    if (sorted > 0) {
+        uint64_t* merged = malloc(statistics->sortedCapacity * sizeof(uint64_t));
+        if (merged == NULL) {
+            // The new keys are in order among themselves, which is no harm
+            return STATUS_INSUFFICIENT_MEMORY;
+        }
+        size_t i = 0, j = sorted, k = 0;
+        while (i < sorted && j < count) {
+            merged[k++] = (keys[j] < keys[i]) ? keys[j++] : keys[i++];
+        }
+        memcpy(&merged[k], &keys[i], (sorted - i) * sizeof(uint64_t));
+        memcpy(&merged[k + sorted - i], &keys[j], (count - j) * sizeof(uint64_t));
+        free(keys);
+        statistics->sortedKeys = merged;
+    }
+    statistics->sortedCount = count;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsGetExactQuantile
+ *
+ * The value below which fraction of the points lie, from the sorted
+ * points: point i of n stands at fraction (i + 0.5) / n, values between
+ * are interpolated linearly, and fractions outside the first and last
+ * point give the minimum and maximum. This is the interpolation the
+ * quantile sketch uses, so the two agree on small data sets. O(1) once
+ * the points are sorted.
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no
+ *          points, STATUS_INVALID_INPUT if fraction is not in [0, 1], or
+ *          STATUS_INSUFFICIENT_MEMORY.
+ */
+int statisticsGetExactQuantile(_statistics* statistics, double fraction, double* result)
+{
+    if (statistics->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    if (!(fraction >= 0.0 && fraction <= 1.0)) {
+        return STATUS_INVALID_INPUT;
+    }
+    int status = statisticsSortPoints(statistics);
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    const uint64_t* keys = statistics->sortedKeys;
+    double position = fraction * (double)statistics->count - 0.5;
+    if (position <= 0.0) {
+        *result = radixDoubleFromKey(keys[0]);
+        return STATUS_SUCCESS;
+    }
+    if (position >= (double)(statistics->count - 1)) {
+        *result = radixDoubleFromKey(keys[statistics->count - 1]);
+        return STATUS_SUCCESS;
+    }
+
+    size_t index = (size_t)position;
+    double low = radixDoubleFromKey(keys[index]);
+    double high = radixDoubleFromKey(keys[index + 1]);
+    *result = low + (high - low) * (position - (double)index);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsGetHistogram
+ *
+ * Counts the points in binCount bins of equal width from minimum to
+ * maximum, each bin holding its lower edge and the last one maximum too,
+ * in one pass over the sorted points from the first in range. Points
+ * outside the range are not counted.
+ *
+ * @return  STATUS_SUCCESS, STATUS_INVALID_INPUT if there are no bins or
+ *          the range is empty or not finite, or
+ *          STATUS_INSUFFICIENT_MEMORY.
+ */
+int statisticsGetHistogram(_statistics* statistics, double minimum, double maximum, size_t binCount,
+    size_t* counts)
+{
+    if (binCount == 0 || !(minimum < maximum) || !isfinite(maximum - minimum)) {
+        return STATUS_INVALID_INPUT;
+    }
+    memset(counts, 0, binCount * sizeof(size_t));
+    int status = statisticsSortPoints(statistics);
+    if (status != STATUS_SUCCESS) {
+        return status;
+    }
+
+    const uint64_t* keys = statistics->sortedKeys;
+    double width = (maximum - minimum) / (double)binCount;
+    double edge = (binCount > 1) ? minimum + width : maximum;  // Upper edge of the bin
+    size_t bin = 0;
+
+    uint64_t lowest = radixKeyFromDouble((minimum == 0.0) ? -0.0 : minimum);  // -0.0 is in a bin from 0
+
+    for (size_t i = findKey(keys, statistics->count, lowest, false); i < statistics->count; i++) {
+        double point = radixDoubleFromKey(keys[i]);
+        if (point > maximum) {
+            break;
+        }
+        while (point >= edge && bin + 1 < binCount) {
+            bin++;
+            edge = (bin + 1 < binCount) ? minimum + width * (double)(bin + 1) : maximum;
+        }
+        counts[bin]++;
+    }
+    return STATUS_SUCCESS;
+}
+
+/*
+ * statisticsGetSum
+ *
+ * The sum of the points (Sum), or of their squares (Inv Sum). 0 when
+ * there are no points.
+ *
+ * @return  STATUS_SUCCESS, or STATUS_OVERFLOW.
+ */
+int statisticsGetSum(const _statistics* statistics, bool isSquared, double* result)
+{
+    *result = isSquared ? statistics->sumOfSquares + statistics->sumOfSquaresCompensation
+                        : statistics->sum + statistics->sumCompensation;
+    return checkResult(*result);
+}
+
+/*
+ * statisticsGetMean
+ *
+ * The mean of the points (Ave), or of their squares (Inv Ave).
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are no
+ *          points, or STATUS_OVERFLOW.
+ */
+int statisticsGetMean(const _statistics* statistics, bool isSquared, double* result)
+{
+    if (statistics->count == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    int status = statisticsGetSum(statistics, isSquared, result);
+    *result /= (double)statistics->count;
+    return (status == STATUS_SUCCESS) ? checkResult(*result) : status;
+}
+
+/*
+ * statisticsGetDeviation
+ *
+ * The standard deviation of the points: of a sample, divided by n - 1
+ * (s), or of the whole population, divided by n (Inv s).
+ *
+ * @return  STATUS_SUCCESS, STATUS_UNDEFINED_RESULT if there are too few
+ *          points (2 for a sample, 1 for a population), or
+ *          STATUS_OVERFLOW.
+ */
+int statisticsGetDeviation(const _statistics* statistics, bool isPopulation, double* result)
+{
+    size_t divisor = isPopulation ? statistics->count : statistics->count - 1;
+
+    if (statistics->count == 0 || divisor == 0) {
+        return STATUS_UNDEFINED_RESULT;
+    }
+    *result = sqrt(statistics->squaredDeviations / (double)divisor);
+    return checkResult(*result);
+}
@@ -0,0 +1,496 @@
+/*-----------------------------------------------------------------------------
+    value.c --  Typed operands for the calculator engine (reconstructed
+                code).
+
+               A _calcValue is an integer, a double, an 80-bit extended
+               value, a _bigDecimal or a fixed-width integer of the
+               programmer mode. The engine keeps results, the
+               pending left operand, the parenthesis stack and the memory
+               register in this form, so a keystroke no longer turns each
+               result into text and parses it back, and no precision is
+               lost between operators. Text is produced only for the
+               display (formatValue).
+
+               Key functions include:
+
+               - valueInit / valueFree / valueCopy / valueMove: Storage
+                                              management; only _bigDecimal
+                                              values own memory.
+               - valueConvert: Changes the representation in place.
+               - valueFromString: Parses typed digits or pasted text.
+               - formatValue: formatDouble for any _calcValue.
+
+               This module is part of the platform-neutral engine library
+               and must not include <windows.h>.
+
+  -----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include ".//headers//bigbase.h"
+#include ".//headers//operations.h"
+#include ".//headers//value.h"
+
+#define INTEGER_LIMIT 9223372036854775808.0  // 2^63: first double outside int64_t
+
+/*
+ * valueInit
+ *
+ * Makes value the integer 0. Zero-filled memory is in the same state.
+ */
+void valueInit(_calcValue* value)
+{
+    value->type = VALUE_TYPE_INTEGER;
+    value->integer = 0;
+}
+
+/*
+ * valueFree
+ *
+ * Releases the limbs of a _bigDecimal value and leaves integer 0 behind.
+ */
+void valueFree(_calcValue* value)
+{
+    if (value->type == VALUE_TYPE_BIG) {
+        bigDecimalFree(&value->big);
+    }
+    valueInit(value);
+}
+
+/*
+ * valueCopy
+ *
+ * Deep copy; result may already hold a value of any type.
+ *
+ * @return  STATUS_SUCCESS or STATUS_INSUFFICIENT_MEMORY.
+ */
+int valueCopy(_calcValue* result, const _calcValue* value)
+{
+    if (result == value) {
+        return STATUS_SUCCESS;
+    }
+    if (value->type != VALUE_TYPE_BIG) {
+        valueFree(result);
+        *result = *value;
+        return STATUS_SUCCESS;
+    }
+    if (result->type != VALUE_TYPE_BIG) {
+        result->type = VALUE_TYPE_BIG;
+        bigDecimalInit(&result->big);
+    }
+    return bigDecimalCopy(&result->big, &value->big);
+}
+
+/*
+ * valueMove
+ *
+ * Hands value over to result without copying limbs; value becomes 0.
+ */
+void valueMove(_calcValue* result, _calcValue* value)
+{
+    if (result != value) {
+        valueFree(result);
+        *result = *value;
+        valueInit(value);
+    }
+}
+
+void valueSetInteger(_calcValue* result, int64_t integer)
+{
+    valueFree(result);
+    result->integer = integer;
+}
+
+void valueSetDouble(_calcValue* result, double real)
+{
+    valueFree(result);
+    result->type = VALUE_TYPE_DOUBLE;
+    result->real = real;
+}
+
+void valueSetExtended(_calcValue* result, const _extendedFloat80* extended)
+{
+    valueFree(result);
+    result->type = VALUE_TYPE_EXTENDED;
+    result->extended = *extended;
+}
+
+void valueSetFixed(_calcValue* result, const _fixedInt* fixed)
+{
+    valueFree(result);
+    result->type = VALUE_TYPE_FIXED;
+    result->fixed = *fixed;
+}
+
+/*
+ * valueToDouble
+ *
+ * The value rounded to the nearest double; values outside the double
+ * range become +/-HUGE_VAL or 0.
+ */
+double valueToDouble(const _calcValue* value)
+{
+    switch (value->type) {
+    case VALUE_TYPE_DOUBLE:   return value->real;
+    case VALUE_TYPE_EXTENDED: return extendedFloat80ToDouble(&value->extended);
+    case VALUE_TYPE_BIG:      return bigDecimalToDouble(&value->big);
+    case VALUE_TYPE_FIXED:    return fixedIntToDouble(&value->fixed);
+    default:                  return (double)value->integer;
+    }
+}
+
+/*
+ * valueIsZero
+ */
+bool valueIsZero(const _calcValue* value)
+{
+    switch (value->type) {
+    case VALUE_TYPE_DOUBLE:
+        return value->real == 0.0;
+    case VALUE_TYPE_EXTENDED:
+        return (value->extended.exponent & EXTENDED_FLOAT_MAX_EXPONENT) == 0 &&
+               value->extended.mantissaHigh == 0 && value->extended.mantissaLow == 0;
+    case VALUE_TYPE_BIG:
+        return bigDecimalIsZero(&value->big);
+    case VALUE_TYPE_FIXED:
+        return fixedIntIsZero(&value->fixed);
+    default:
+        return value->integer == 0;
+    }
+}
+
+/*
+ * convertToBig
+ *
+ * Exact conversion of a non-_bigDecimal value, rounded to precision.
+ */
+static int convertToBig(_bigDecimal* result, const _calcValue* value, int precision)
+{
+    char text[FIXED_INT_MAX_TEXT];
+    int status;
+
+    switch (value->type) {
+    case VALUE_TYPE_DOUBLE:
+        status = bigDecimalFromDouble(result, value->real);
+        break;
+    case VALUE_TYPE_EXTENDED:
+        return bigDecimalFromExtendedFloat80(result, &value->extended, precision);
+    case VALUE_TYPE_FIXED:
+        fixedIntToString(&value->fixed, text, sizeof(text), 10);
+        return bigDecimalFromString(result, text, '.', precision);
+    default:
+        status = bigDecimalSetInt(result, value->integer);
+        break;
+    }
+    return (status == STATUS_SUCCESS) ? bigDecimalRound(result, precision) : status;
+}
+
+/*
+ * extendedToFixed
+ *
+ * The fixed-width value an _extendedFloat80 wraps to, truncated towards
+ * zero.
+ */
+static int extendedToFixed(_fixedInt* result, const _extendedFloat80* value, int bits)
+{
+    int exponent = value->exponent & EXTENDED_FLOAT_MAX_EXPONENT;
+    uint64_t mantissa = ((uint64_t)value->mantissaHigh << 32) | value->mantissaLow;
+
+    if (exponent == EXTENDED_FLOAT_MAX_EXPONENT) {
+        return ((mantissa << 1) != 0) ? STATUS_UNDEFINED_RESULT : STATUS_OVERFLOW;
+    }
+    fixedIntFromBinary(result, mantissa, (int64_t)exponent - EXTENDED_FLOAT_BIAS - 63,
+        (value->exponent & EXTENDED_FLOAT_SIGN) != 0, bits);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * bigToFixed
+ *
+ * The fixed-width value the integer part of a _bigDecimal wraps to. Each
+ * limb below the integer part multiplies by 10^9 = 2^9 * 5^9, so after
+ * FIXED_INT_MAX_BITS / 9 + 1 of them every bit of the word has gone;
+ * the limbs above that many only add bits above the word and are
+ * skipped, so a value of a million digits takes no longer than one of
+ * 513.
+ */
+static void bigToFixed(_fixedInt* result, const _bigDecimal* value, int bits)
+{
+    const uint32_t* limbs = BIG_DECIMAL_LIMBS(value);
+    int64_t top = (int64_t)value->length - 1;
+
+    if (top + value->exponent > FIXED_INT_MAX_BITS / 9) {
+        top = FIXED_INT_MAX_BITS / 9 - value->exponent;
+    }
+    fixedIntSet(result, 0, bits);
+    for (int64_t i = top; i >= 0 && i + value->exponent >= 0; i--) {
+        fixedIntMultiplyAdd(result, BIG_LIMB_BASE, limbs[i]);
+    }
+    for (int64_t i = 0; i < value->exponent && i <= FIXED_INT_MAX_BITS / 9; i++) {
+        fixedIntMultiplyAdd(result, BIG_LIMB_BASE, 0);
+    }
+    if (value->sign < 0) {
+        fixedIntNegate(result);
+    }
+}
+
+/*
+ * convertToFixed
+ *
+ * Converts value in place to the fixed-width integer of bits bits it
+ * wraps to. Fractions are truncated towards zero, and a fixed-width
+ * value of another size is truncated or sign-extended.
+ */
+static int convertToFixed(_calcValue* value, int bits)
+{
+    _fixedInt fixed;
+    int status = STATUS_SUCCESS;
+
+    if (!fixedIntIsValidWidth(bits)) {
+        return STATUS_INVALID_INPUT;
+    }
+    switch (value->type) {
+    case VALUE_TYPE_FIXED:
+        fixed = value->fixed;
+        fixedIntResize(&fixed, bits);
+        break;
+    case VALUE_TYPE_DOUBLE:
+        status = fixedIntFromDouble(&fixed, value->real, bits);
+        break;
+    case VALUE_TYPE_EXTENDED:
+        status = extendedToFixed(&fixed, &value->extended, bits);
+        break;
+    case VALUE_TYPE_BIG:
+        bigToFixed(&fixed, &value->big, bits);
+        break;
+    default:
+        fixedIntSet(&fixed, value->integer, bits);
+        break;
+    }
+    if (status == STATUS_SUCCESS) {
+        valueSetFixed(value, &fixed);
+    }
+    return status;
+}
+
+/*
+ * valueConvert
+ *
+ * Changes the representation of value in place. Conversions to integer
+ * truncate towards zero; conversions to _bigDecimal are rounded to
+ * precision significant digits, the others to the nearest value.
+ * Conversions to a fixed-width integer truncate too, and wrap at its
+ * word size instead of overflowing.
+ *
+ * @param value      The value to convert.
+ * @param type       The representation wanted.
+ * @param precision  Significant digits of a _bigDecimal result, or the
+ *                   word size in bits of a VALUE_TYPE_FIXED one.
+ * @return           STATUS_SUCCESS, STATUS_OVERFLOW if the value does not
+ *                   fit the new type, STATUS_UNDEFINED_RESULT for a NaN or
+ *                   STATUS_INSUFFICIENT_MEMORY. value is unchanged on
+ *                   failure.
+ */
+int valueConvert(_calcValue* value, _valueType type, int precision)
+{
+    _extendedFloat80 extended;
+    _bigDecimal big;
+    char text[FIXED_INT_MAX_TEXT];
+    int64_t integer;
+    double real;
+    int status = STATUS_SUCCESS;
+
+    if (value->type == type && (type != VALUE_TYPE_FIXED || value->fixed.bits == precision)) {
+        return STATUS_SUCCESS;
+    }
+
+    switch (type) {
+    case VALUE_TYPE_INTEGER:
+        if (value->type == VALUE_TYPE_FIXED) {
+            if (!fixedIntToInt(&value->fixed, &integer)) {
+                return STATUS_OVERFLOW;
+            }
+            valueSetInteger(value, integer);
+            return STATUS_SUCCESS;
+        }
+        real = trunc(valueToDouble(value));
+        if (isnan(real)) {
+            return STATUS_UNDEFINED_RESULT;
+        }
+        if (real >= INTEGER_LIMIT || real < -INTEGER_LIMIT) {
+            return STATUS_OVERFLOW;
+        }
+        valueSetInteger(value, (int64_t)real);
+        return STATUS_SUCCESS;
+
+    case VALUE_TYPE_DOUBLE:
+        real = valueToDouble(value);
+        if (isinf(real)) {
+            return STATUS_OVERFLOW;
+        }
+        valueSetDouble(value, real);
+        return STATUS_SUCCESS;
+
+    case VALUE_TYPE_EXTENDED:
+        if (value->type == VALUE_TYPE_INTEGER) {
+            intToExtendedFloat80(&extended, value->integer);
+        }
+        else if (value->type == VALUE_TYPE_DOUBLE) {
+            status = extendedFloat80FromDouble(&extended, value->real);
+        }
+        else if (value->type == VALUE_TYPE_FIXED) {
+            fixedIntToString(&value->fixed, text, sizeof(text), 10);
+            status = extendedFloat80FromString(&extended, text, '.');
+        }
+        else {
+            status = extendedFloat80FromBigDecimal(&extended, &value->big);
+        }
+        if (status == STATUS_SUCCESS) {
+            valueSetExtended(value, &extended);
+        }
+        return status;
+
+    case VALUE_TYPE_BIG:
+        bigDecimalInit(&big);
+        status = convertToBig(&big, value, precision);
+        if (status != STATUS_SUCCESS) {
+            bigDecimalFree(&big);
+            return status;
+        }
+        value->type = VALUE_TYPE_BIG;
+        value->big = big;
+        return STATUS_SUCCESS;
+
+    case VALUE_TYPE_FIXED:
+        return convertToFixed(value, precision);
+
+    default:
+        return STATUS_INVALID_INPUT;
+    }
+}
+
+/*
+ * valueFromString
+ *
+ * Parses text into a value of the given type. In base 10 the text may use
+ * '.' or decimalSeparator and an exponent; in other bases, and for a
+ * fixed-width integer in any base, it is an integer. An empty entry (or
+ * a lone minus sign) is zero. Non-decimal text for the other types is
+ * read exactly through bigBaseFromString, however long it is.
+ *
+ * @param result            Receives the value.
+ * @param type              The representation wanted.
+ * @param text              The NUL-terminated text.
+ * @param numberBase        2, 8, 10 or 16.
+ * @param decimalSeparator  The user's decimal separator.
+ * @param precision         Significant digits of a _bigDecimal result, or
+ *                          the word size of a VALUE_TYPE_FIXED one.
+ * @return                  STATUS_SUCCESS or one of the STATUS_* codes of
+ *                          the parser for that type.
+ */
+int valueFromString(_calcValue* result, _valueType type, const char* text, int numberBase,
+    char decimalSeparator, int precision)
+{
+    _extendedFloat80 extended;
+    int status;
+
+    if (text[0] == '\0' || strcmp(text, "-") == 0) {
+        valueSetInteger(result, 0);
+        return valueConvert(result, type, precision);
+    }
+    if (type == VALUE_TYPE_FIXED) {
+        _fixedInt fixed;
+        status = fixedIntFromString(&fixed, text, numberBase, precision);
+        if (status == STATUS_SUCCESS) {
+            valueSetFixed(result, &fixed);
+        }
+        return status;
+    }
+    if (numberBase != 10 && type != VALUE_TYPE_INTEGER) {
+        // Every digit, where strtoll would stop at 2^63
+        _bigDecimal big;
+        bigDecimalInit(&big);
+        status = bigBaseFromString(&big, text, numberBase);
+        if (status == STATUS_SUCCESS && type == VALUE_TYPE_BIG) {
+            status = bigDecimalRound(&big, precision);
+        }
+        if (status != STATUS_SUCCESS) {
+            bigDecimalFree(&big);
+            return status;
+        }
+        valueFree(result);
+        result->type = VALUE_TYPE_BIG;
+        result->big = big;
+        return valueConvert(result, type, precision);
+    }
+    if (type == VALUE_TYPE_INTEGER) {
+        valueSetInteger(result, strtoll(text, NULL, numberBase));
+        return STATUS_SUCCESS;
+    }
+
+    switch (type) {
+    case VALUE_TYPE_EXTENDED:
+        status = extendedFloat80FromString(&extended, text, decimalSeparator);
+        if (status == STATUS_SUCCESS) {
+            valueSetExtended(result, &extended);
+        }
+        return status;
+
+    case VALUE_TYPE_BIG:
+        if (result->type != VALUE_TYPE_BIG) {
+            valueFree(result);
+            result->type = VALUE_TYPE_BIG;
+            bigDecimalInit(&result->big);
+        }
+        return bigDecimalFromString(&result->big, text, decimalSeparator, precision);
+
+    default: {
+        // strtod only knows '.', so a typed entry with another separator is copied
+        char buffer[MAX_DISPLAY_DIGITS];
+        const char* separator = strchr(text, decimalSeparator);
+        if (decimalSeparator != '.' && separator != NULL) {
+            size_t length = strlen(text);
+            if (length >= sizeof(buffer)) {
+                return STATUS_INVALID_INPUT;
+            }
+            memcpy(buffer, text, length + 1);
+            buffer[separator - text] = '.';
+            text = buffer;
+        }
+        valueSetDouble(result, strtod(text, NULL));
+        return STATUS_SUCCESS;
+    }
+    }
+}
+
+/*
+ * formatValue
+ *
+ * formatDouble for any _calcValue. Integers are formatted exactly through
+ * the 64-bit extended mantissa; wider fixed-width integers are rounded
+ * to it.
+ */
+size_t formatValue(char* buffer, size_t bufferSize, const _calcValue* value, _numberLayout layout,
+    int significantDigits, char decimalSeparator)
+{
+    _extendedFloat80 extended;
+    char text[FIXED_INT_MAX_TEXT];
+
+    switch (value->type) {
+    case VALUE_TYPE_DOUBLE:
+        return formatDouble(buffer, bufferSize, value->real, layout, significantDigits, decimalSeparator);
+    case VALUE_TYPE_EXTENDED:
+        return formatExtendedFloat80(buffer, bufferSize, &value->extended, layout, significantDigits,
+            decimalSeparator);
+    case VALUE_TYPE_BIG:
+        return formatBigDecimal(buffer, bufferSize, &value->big, layout, significantDigits, decimalSeparator);
+    case VALUE_TYPE_FIXED:
+        fixedIntToString(&value->fixed, text, sizeof(text), 10);
+        extendedFloat80FromString(&extended, text, '.');
+        return formatExtendedFloat80(buffer, bufferSize, &extended, layout, significantDigits, decimalSeparator);
+    default:
+        intToExtendedFloat80(&extended, value->integer);
+        return formatExtendedFloat80(buffer, bufferSize, &extended, layout, significantDigits, decimalSeparator);
+    }
+}